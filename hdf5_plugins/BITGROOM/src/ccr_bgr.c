@@ -0,0 +1,714 @@
+/* Copyright (C) 2020--present Charlie Zender */
+
+ /*
+ * BitGroom quantization of buffers of single- and double-precision values.
+ * The HDF5 BitGroom filter plugin (H5Zbitgroom.c) and ccr_quantize() in libccr
+ * both build this file, so it calls neither HDF5 nor netCDF.
+ */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h" /* Autotools tokens */
+#endif
+#include <stdio.h>
+#ifdef HAVE_SYS_TYPES_H
+# include <sys/types.h>
+#endif
+#ifdef HAVE_SYS_STAT_H
+# include <sys/stat.h>
+#endif
+#ifdef STDC_HEADERS
+# include <stdlib.h>
+# include <stddef.h>
+#else
+# ifdef HAVE_STDLIB_H
+#  include <stdlib.h>
+# endif
+#endif
+#ifdef HAVE_STRING_H
+# if !defined STDC_HEADERS && defined HAVE_MEMORY_H
+#  include <memory.h>
+# endif
+# include <string.h>
+#endif
+#ifdef HAVE_STRINGS_H
+# include <strings.h>
+#endif
+#ifdef HAVE_INTTYPES_H
+# include <inttypes.h>
+#endif
+#ifdef HAVE_STDINT_H
+# include <stdint.h>
+#endif
+#ifdef HAVE_UNISTD_H
+# include <unistd.h>
+#endif
+#include <assert.h>
+
+#if defined(_WIN32)
+#include <Winsock2.h>
+#endif
+#ifdef HAVE_PTHREAD_H
+# include <pthread.h> /* pthread_once() selects kernels once, however many threads quantize */
+#endif
+
+/* Standard header files */
+#ifdef HAVE_FEATURES_H
+/* Needed to define __USE_BSD that recent GCC compilers use in math.h to define M_LN2... */
+# include <features.h> /* __USE_BSD */
+#endif
+#ifdef HAVE_MATH_H
+/* Needed for M_LN10, M_LN2 in ccr_bgr() */
+# include <math.h> /* sin cos cos sin 3.14159 */
+#endif
+
+/* SIMD kernels need x86 intrinsics plus GCC/Clang function-level target attributes and __builtin_cpu_supports()
+   Other compilers and architectures use the scalar kernel */
+#if defined(HAVE_IMMINTRIN_H) && (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+# define CCR_SIMD_X86 1
+# include <immintrin.h> /* AVX2, AVX-512 intrinsics */
+#endif /* !HAVE_IMMINTRIN_H */
+
+/* OpenMP lets large chunks be quantized in slices on a thread pool (opt-in, see ccr_thr_nbr_get()) */
+#ifdef _OPENMP
+# include <omp.h> /* omp_get_num_procs() */
+#endif /* !_OPENMP */
+
+/* Tokens and typedefs */
+#define CCR_FLT_DBG_INFO 0 /* [flg] Print non-fatal debugging information */
+#define CCR_FLT_NAME "BitGroom filter (Zender, 2016 GMD: http://www.geosci-model-dev.net/9/3199/2016)" /* [sng] Filter name in vernacular for HDF5 messages */
+#define CCR_THR_NBR_ENV "CCR_THR_NBR" /* [sng] Environment variable that sets number of quantization threads (default 1) */
+#define CCR_SLC_SZ_BYT 262144 /* [B] Slice size for multithreaded quantization, small enough to stay in L2 cache */
+
+/* Compatibility tokens and typedefs retain source-code compatibility between NCO and filter
+   These tokens mimic netCDF/NCO code but do not rely on or interfere with either */
+#ifndef NC_FLOAT
+# define NC_FLOAT 5
+#endif /* !NC_FLOAT */
+#ifndef NC_DOUBLE
+# define NC_DOUBLE 6
+#endif /* !NC_DOUBLE */
+#ifndef NC_FILL_FLOAT
+# define NC_FILL_FLOAT   (9.9692099683868690e+36f) /* near 15 * 2^119 */
+#endif /* !NC_FILL_FLOAT */
+#ifndef NC_FILL_DOUBLE
+# define NC_FILL_DOUBLE  (9.9692099683868690e+36)
+#endif /* !NC_FILL_DOUBLE */
+
+/* Minimum number of explicit significand bits to preserve when zeroing/bit-masking floating point values
+   Codes will preserve at least two explicit bits, IEEE significand representation contains one implicit bit
+   Thus preserve a least three bits which is approximately one sigificant decimal digit
+   Used in nco_ppc_bitmask() and nco_ppc_bitmask_scl() */
+#define NCO_PPC_BIT_XPL_NBR_MIN 2
+
+/* Absolute error mode builds one mask per biased exponent, see ccr_bgr_abs() */
+#define CCR_BGR_FLT_XPN_NBR 256 /* [nbr] Number of single-precision biased exponents */
+#define CCR_BGR_DBL_XPN_NBR 2048 /* [nbr] Number of double-precision biased exponents */
+
+/* Pointer union for floating point and bitmask types */
+typedef union{ /* ptr_unn */
+  float *fp;
+  double *dp;
+  unsigned int *ui32p;
+  unsigned long long *ui64p;
+  void *vp;
+} ptr_unn;
+
+/* BitGroom kernels shave even-indexed values and set odd-indexed values in a single sweep
+   Kernel choice (scalar, AVX2, AVX-512) is made once by ccr_bgr_cpu_dispatch() */
+typedef void /* O [nbr] Nothing */
+(*ccr_bgr_flt_knl_t) /* [fnc] BitGroom kernel for single-precision values */
+(const size_t sz, /* I [nbr] Size (in elements) of buffer to quantize */
+ const float mss_val_cmp_flt, /* I [val] Missing value for comparison */
+ const unsigned int msk_f32_u32_zro, /* I [msk] Bit Shave mask for AND */
+ const unsigned int msk_f32_u32_one, /* I [msk] Bit Set mask for OR */
+ ptr_unn op1); /* I/O [frc] Values to quantize */
+
+typedef void /* O [nbr] Nothing */
+(*ccr_bgr_dbl_knl_t) /* [fnc] BitGroom kernel for double-precision values */
+(const size_t sz, /* I [nbr] Size (in elements) of buffer to quantize */
+ const double mss_val_cmp_dbl, /* I [val] Missing value for comparison */
+ const unsigned long long int msk_f64_u64_zro, /* I [msk] Bit Shave mask for AND */
+ const unsigned long long int msk_f64_u64_one, /* I [msk] Bit Set mask for OR */
+ ptr_unn op1); /* I/O [frc] Values to quantize */
+
+void
+ccr_bgr /* [fnc] BitGroom buffer of float values */
+(const int nsd, /* I [nbr] Number of decimal significant digits to quantize to */
+ const int type, /* I [enm] netCDF type of operand */
+ const size_t sz, /* I [nbr] Size (in elements) of buffer to quantize */
+ const int has_mss_val, /* I [flg] Flag for missing values */
+ ptr_unn mss_val, /* I [val] Value of missing value */
+ ptr_unn op1); /* I/O [frc] Values to quantize */
+
+void
+ccr_bgr_abs /* [fnc] BitGroom buffer of float values to absolute error */
+(const double abs_err, /* I [frc] Maximum absolute error */
+ const int type, /* I [enm] netCDF type of operand */
+ const size_t sz, /* I [nbr] Size (in elements) of buffer to quantize */
+ const int has_mss_val, /* I [flg] Flag for missing values */
+ ptr_unn mss_val, /* I [val] Value of missing value */
+ ptr_unn op1); /* I/O [frc] Values to quantize */
+
+void
+ccr_bgr_cpu_dispatch /* [fnc] Select fastest BitGroom kernels supported by this CPU */
+(void);
+
+void
+ccr_bgr_knl_ini /* [fnc] Select BitGroom kernels once per process, from any thread */
+(void);
+
+int /* O [flg] Kernel is supported by this CPU and now selected */
+ccr_bgr_knl_set /* [fnc] Force BitGroom kernels, for testing only */
+(const char * const knl_nm); /* I [sng] Kernel name: "scalar", "AVX2", or "AVX-512" */
+
+static void ccr_bgr_flt_abs_scl(const size_t sz,const float mss_val_cmp_flt,const unsigned int * const msk_tbl,ptr_unn op1);
+static void ccr_bgr_dbl_abs_scl(const size_t sz,const double mss_val_cmp_dbl,const unsigned long long int * const msk_tbl,ptr_unn op1);
+
+/* Kernels selected by ccr_bgr_cpu_dispatch(), NULL until first dispatch */
+static ccr_bgr_flt_knl_t ccr_bgr_flt_knl=NULL; /* [fnc] Single-precision BitGroom kernel */
+static ccr_bgr_dbl_knl_t ccr_bgr_dbl_knl=NULL; /* [fnc] Double-precision BitGroom kernel */
+static const char *ccr_bgr_knl_nm="none"; /* [sng] Name of selected kernel, for debugging */
+#ifdef HAVE_PTHREAD_H
+static pthread_once_t ccr_bgr_knl_once=PTHREAD_ONCE_INIT; /* [flg] Guards one-time kernel selection */
+#endif
+
+/* Function definitions */
+static int /* O [nbr] Number of threads to quantize buffer with */
+ccr_thr_nbr_get /* [fnc] Number of threads requested for quantization */
+(const size_t bfr_sz) /* I [B] Size of buffer to quantize */
+{
+  /* Purpose: Read opt-in thread count from CCR_THR_NBR environment variable
+     Unset, empty, or 1 quantizes on calling thread, 0 uses one thread per processor
+     Buffers smaller than two slices always quantize on calling thread
+     Thread count describes the writer not the data, so it is an environment variable rather than a cd_values[] entry */
+#ifdef _OPENMP
+  const char *thr_sng; /* [sng] Value of CCR_THR_NBR */
+  char *sng_cnv_rcd=NULL; /* [sng] strtol() return code */
+  long slc_nbr; /* [nbr] Number of slices in buffer */
+  long thr_nbr; /* [nbr] Number of threads */
+
+  if(bfr_sz < 2*CCR_SLC_SZ_BYT) return 1;
+  thr_sng=getenv(CCR_THR_NBR_ENV);
+  if(!thr_sng || *thr_sng == '\0') return 1;
+  thr_nbr=strtol(thr_sng,&sng_cnv_rcd,10);
+  if(*sng_cnv_rcd != '\0' || thr_nbr < 0L){
+    (void)fprintf(stderr,"WARNING: \"%s\" filter ignores invalid %s = %s\n",CCR_FLT_NAME,CCR_THR_NBR_ENV,thr_sng);
+    return 1;
+  } /* !sng_cnv_rcd */
+  if(thr_nbr == 0L) thr_nbr=omp_get_num_procs();
+  /* Threads beyond one per slice would idle */
+  slc_nbr=(long)((bfr_sz+CCR_SLC_SZ_BYT-1)/CCR_SLC_SZ_BYT);
+  if(thr_nbr > slc_nbr) thr_nbr=slc_nbr;
+  return (int)thr_nbr;
+#else /* !_OPENMP */
+  (void)bfr_sz;
+  return 1;
+#endif /* !_OPENMP */
+} /* !ccr_thr_nbr_get() */
+
+void
+ccr_bgr /* [fnc] BitGroom buffer of float values */
+(const int nsd, /* I [nbr] Number of decimal significant digits to quantize to */
+ const int type, /* I [enm] netCDF type of operand */
+ const size_t sz, /* I [nbr] Size (in elements) of buffer to quantize */
+ const int has_mss_val, /* I [flg] Flag for missing values */
+ ptr_unn mss_val, /* I [val] Value of missing value */
+ ptr_unn op1) /* I/O [frc] Values to quantize */
+{
+  const char fnc_nm[]="ccr_bgr()"; /* [sng] Function name */
+
+  /* Prefer constants defined in math.h, however, ...
+     20201002 GCC environments can have hard time defining M_LN10/M_LN2 despite finding math.h */
+#ifndef M_LN10
+# define M_LN10         2.30258509299404568402  /* log_e 10 */
+#endif /* M_LN10 */
+#ifndef M_LN2
+# define M_LN2          0.69314718055994530942  /* log_e 2 */
+#endif /* M_LN2 */
+  const double bit_per_dgt=M_LN10/M_LN2; /* 3.32 [frc] Bits per decimal digit of precision = log2(10) */
+  
+  const int bit_xpl_nbr_sgn_flt=23; /* [nbr] Bits 0-22 of SP significands are explicit. Bit 23 is implicitly 1. */
+  const int bit_xpl_nbr_sgn_dbl=52; /* [nbr] Bits 0-51 of DP significands are explicit. Bit 52 is implicitly 1. */
+  
+  double prc_bnr_xct; /* [nbr] Binary digits of precision, exact */
+  double mss_val_cmp_dbl; /* Missing value for comparison to double precision values */
+
+  float mss_val_cmp_flt; /* Missing value for comparison to single precision values */
+  
+  int bit_xpl_nbr_sgn=-1; /* [nbr] Number of explicit bits in significand */
+  int bit_xpl_nbr_zro; /* [nbr] Number of explicit bits to zero */
+
+  int thr_nbr; /* [nbr] Number of threads to quantize with */
+
+  long slc_idx; /* [idx] Slice index */
+  long slc_nbr; /* [nbr] Number of slices */
+  size_t slc_sz; /* [nbr] Slice size (in elements) */
+
+  unsigned int msk_f32_u32_zro;
+  unsigned int msk_f32_u32_one;
+  //unsigned int msk_f32_u32_hshv;
+  unsigned long long int msk_f64_u64_zro;
+  unsigned long long int msk_f64_u64_one;
+  //unsigned long long int msk_f64_u64_hshv;
+  unsigned short prc_bnr_ceil; /* [nbr] Exact binary digits of precision rounded-up */
+  unsigned short prc_bnr_xpl_rqr; /* [nbr] Explicitly represented binary digits required to retain */
+
+  /* Disallow unreasonable quantization */
+  assert(nsd > 0);
+  assert(nsd <= 16);
+
+  /* How many bits to preserve? */
+  prc_bnr_xct=nsd*bit_per_dgt;
+  /* Be conservative, round upwards */
+  prc_bnr_ceil=(unsigned short)ceil(prc_bnr_xct);
+  /* First bit is implicit not explicit but corner cases prevent our taking advantage of this */
+  //prc_bnr_xpl_rqr=prc_bnr_ceil-1; /* 20201223 CSZ verified this fails for small integers with NSD=1 */
+  //prc_bnr_xpl_rqr=prc_bnr_ceil;
+  prc_bnr_xpl_rqr=prc_bnr_ceil+1;
+
+  if(type == NC_FLOAT  && prc_bnr_xpl_rqr >= bit_xpl_nbr_sgn_flt) return;
+  if(type == NC_DOUBLE && prc_bnr_xpl_rqr >= bit_xpl_nbr_sgn_dbl) return;
+
+  /* Filters registered with H5Zregister(), and ccr_quantize(), bypass H5PLget_plugin_info() so dispatch here */
+  ccr_bgr_knl_ini();
+
+  switch(type){
+  case NC_FLOAT:
+    /* Missing value for comparison is _FillValue (if any) otherwise default NC_FILL_FLOAT/DOUBLE */
+    if(has_mss_val) mss_val_cmp_flt=*mss_val.fp; else mss_val_cmp_flt=NC_FILL_FLOAT;
+    bit_xpl_nbr_sgn=bit_xpl_nbr_sgn_flt;
+    bit_xpl_nbr_zro=bit_xpl_nbr_sgn-prc_bnr_xpl_rqr;
+    assert(bit_xpl_nbr_zro <= bit_xpl_nbr_sgn-NCO_PPC_BIT_XPL_NBR_MIN);
+    /* Create mask */
+    msk_f32_u32_zro=0u; /* Zero all bits */
+    msk_f32_u32_zro=~msk_f32_u32_zro; /* Turn all bits to ones */
+    /* Bit Shave mask for AND: Left shift zeros into bits to be rounded, leave ones in untouched bits */
+    msk_f32_u32_zro <<= bit_xpl_nbr_zro;
+    /* Bit Set   mask for OR:  Put ones into bits to be set, zeros in untouched bits */
+    msk_f32_u32_one=~msk_f32_u32_zro;
+    //msk_f32_u32_hshv=msk_f32_u32_one & (msk_f32_u32_zro >> 1); /* Set one bit: the MSB of LSBs */
+
+    /* Bit-Groom: alternately shave and set LSBs */
+    thr_nbr=ccr_thr_nbr_get(sz*sizeof(float));
+    if(thr_nbr > 1){
+      slc_sz=CCR_SLC_SZ_BYT/sizeof(float); /* Even, so every slice starts on an even element */
+      slc_nbr=(long)((sz+slc_sz-1L)/slc_sz);
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic) num_threads(thr_nbr)
+#endif /* !_OPENMP */
+      for(slc_idx=0L;slc_idx<slc_nbr;slc_idx++){
+	ptr_unn op1_slc; /* [frc] Slice of values to quantize */
+	op1_slc.fp=op1.fp+slc_idx*slc_sz;
+	ccr_bgr_flt_knl(slc_idx < slc_nbr-1L ? slc_sz : sz-slc_idx*slc_sz,mss_val_cmp_flt,msk_f32_u32_zro,msk_f32_u32_one,op1_slc);
+      } /* !slc_idx */
+    }else{
+      ccr_bgr_flt_knl(sz,mss_val_cmp_flt,msk_f32_u32_zro,msk_f32_u32_one,op1);
+    } /* !thr_nbr */
+    break; /* !NC_FLOAT */
+  case NC_DOUBLE:
+    /* Missing value for comparison is _FillValue (if any) otherwise default NC_FILL_FLOAT/DOUBLE */
+    if(has_mss_val) mss_val_cmp_dbl=*mss_val.dp; else mss_val_cmp_dbl=NC_FILL_DOUBLE;
+    bit_xpl_nbr_sgn=bit_xpl_nbr_sgn_dbl;
+    bit_xpl_nbr_zro=bit_xpl_nbr_sgn-prc_bnr_xpl_rqr;
+    assert(bit_xpl_nbr_zro <= bit_xpl_nbr_sgn-NCO_PPC_BIT_XPL_NBR_MIN);
+    /* Create mask */
+    msk_f64_u64_zro=0ul; /* Zero all bits */
+    msk_f64_u64_zro=~msk_f64_u64_zro; /* Turn all bits to ones */
+    /* Bit Shave mask for AND: Left shift zeros into bits to be rounded, leave ones in untouched bits */
+    msk_f64_u64_zro <<= bit_xpl_nbr_zro;
+    /* Bit Set   mask for OR:  Put ones into bits to be set, zeros in untouched bits */
+    msk_f64_u64_one=~msk_f64_u64_zro;
+    //msk_f64_u64_hshv=msk_f64_u64_one & (msk_f64_u64_zro >> 1); /* Set one bit: the MSB of LSBs */
+    /* Bit-Groom: alternately shave and set LSBs */
+    thr_nbr=ccr_thr_nbr_get(sz*sizeof(double));
+    if(thr_nbr > 1){
+      slc_sz=CCR_SLC_SZ_BYT/sizeof(double); /* Even, so every slice starts on an even element */
+      slc_nbr=(long)((sz+slc_sz-1L)/slc_sz);
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic) num_threads(thr_nbr)
+#endif /* !_OPENMP */
+      for(slc_idx=0L;slc_idx<slc_nbr;slc_idx++){
+	ptr_unn op1_slc; /* [frc] Slice of values to quantize */
+	op1_slc.dp=op1.dp+slc_idx*slc_sz;
+	ccr_bgr_dbl_knl(slc_idx < slc_nbr-1L ? slc_sz : sz-slc_idx*slc_sz,mss_val_cmp_dbl,msk_f64_u64_zro,msk_f64_u64_one,op1_slc);
+      } /* !slc_idx */
+    }else{
+      ccr_bgr_dbl_knl(sz,mss_val_cmp_dbl,msk_f64_u64_zro,msk_f64_u64_one,op1);
+    } /* !thr_nbr */
+    break; /* !NC_DOUBLE */
+  default: 
+    (void)fprintf(stderr,"ERROR: %s reports datum size = %d B is invalid for %s filter\n",fnc_nm,type,CCR_FLT_NAME);
+    break;
+  } /* !type */
+  
+} /* ccr_bgr() */
+
+void
+ccr_bgr_abs /* [fnc] BitGroom buffer of float values to absolute error */
+(const double abs_err, /* I [frc] Maximum absolute error */
+ const int type, /* I [enm] netCDF type of operand */
+ const size_t sz, /* I [nbr] Size (in elements) of buffer to quantize */
+ const int has_mss_val, /* I [flg] Flag for missing values */
+ ptr_unn mss_val, /* I [val] Value of missing value */
+ ptr_unn op1) /* I/O [frc] Values to quantize */
+{
+  /* Purpose: BitGroom buffer so every value stays within abs_err of its input
+     Relative (NSD) mode keeps the same number of bits in every value
+     Absolute mode keeps only bits worth more than abs_err, so it keeps fewer bits in smaller values
+     Value with binary exponent xpn has explicit bits worth 2^(xpn-1), 2^(xpn-2), ...
+     Shaving or setting bits worth at most 2^qnt_pwr changes value by less than 2^qnt_pwr <= abs_err
+     Hence retain xpn-qnt_pwr explicit bits, clamped to [0,bit_xpl_nbr_sgn]
+     Required bits depend only on the exponent, so tabulate one mask per biased exponent
+     Zeros, subnormals, Inf, and NaN keep the all-ones mask and are untouched */
+  const char fnc_nm[]="ccr_bgr_abs()"; /* [sng] Function name */
+
+  const int bit_xpl_nbr_sgn_flt=23; /* [nbr] Bits 0-22 of SP significands are explicit. Bit 23 is implicitly 1. */
+  const int bit_xpl_nbr_sgn_dbl=52; /* [nbr] Bits 0-51 of DP significands are explicit. Bit 52 is implicitly 1. */
+
+  double mss_val_cmp_dbl; /* Missing value for comparison to double precision values */
+
+  float mss_val_cmp_flt; /* Missing value for comparison to single precision values */
+
+  int bit_xpl_nbr_rqr; /* [nbr] Explicit bits to retain */
+  int qnt_pwr; /* [nbr] Power of two of largest bit that may change: 2^qnt_pwr <= abs_err */
+  int thr_nbr; /* [nbr] Number of threads to quantize with */
+  int xpn_bsd; /* [nbr] Biased exponent */
+
+  long slc_idx; /* [idx] Slice index */
+  long slc_nbr; /* [nbr] Number of slices */
+  size_t slc_sz; /* [nbr] Slice size (in elements) */
+
+  unsigned int msk_tbl_flt[CCR_BGR_FLT_XPN_NBR]; /* [msk] Bit Shave masks indexed by biased exponent */
+  unsigned long long int msk_tbl_dbl[CCR_BGR_DBL_XPN_NBR]; /* [msk] Bit Shave masks indexed by biased exponent */
+
+  /* abs_err = mnt*2^qnt_pwr with 0.5 <= mnt < 1.0, so 2^(qnt_pwr-1) <= abs_err */
+  (void)frexp(abs_err,&qnt_pwr);
+  qnt_pwr--;
+
+  switch(type){
+  case NC_FLOAT:
+    /* Missing value for comparison is _FillValue (if any) otherwise default NC_FILL_FLOAT/DOUBLE */
+    if(has_mss_val) mss_val_cmp_flt=*mss_val.fp; else mss_val_cmp_flt=NC_FILL_FLOAT;
+    msk_tbl_flt[0]=msk_tbl_flt[CCR_BGR_FLT_XPN_NBR-1]=~0u;
+    for(xpn_bsd=1;xpn_bsd<CCR_BGR_FLT_XPN_NBR-1;xpn_bsd++){
+      bit_xpl_nbr_rqr=xpn_bsd-127-qnt_pwr;
+      if(bit_xpl_nbr_rqr < 0) bit_xpl_nbr_rqr=0;
+      msk_tbl_flt[xpn_bsd]= bit_xpl_nbr_rqr >= bit_xpl_nbr_sgn_flt ? ~0u : ~0u << (bit_xpl_nbr_sgn_flt-bit_xpl_nbr_rqr);
+    } /* !xpn_bsd */
+    thr_nbr=ccr_thr_nbr_get(sz*sizeof(float));
+    if(thr_nbr > 1){
+      slc_sz=CCR_SLC_SZ_BYT/sizeof(float); /* Even, so every slice starts on an even element */
+      slc_nbr=(long)((sz+slc_sz-1L)/slc_sz);
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic) num_threads(thr_nbr)
+#endif /* !_OPENMP */
+      for(slc_idx=0L;slc_idx<slc_nbr;slc_idx++){
+	ptr_unn op1_slc; /* [frc] Slice of values to quantize */
+	op1_slc.fp=op1.fp+slc_idx*slc_sz;
+	ccr_bgr_flt_abs_scl(slc_idx < slc_nbr-1L ? slc_sz : sz-slc_idx*slc_sz,mss_val_cmp_flt,msk_tbl_flt,op1_slc);
+      } /* !slc_idx */
+    }else{
+      ccr_bgr_flt_abs_scl(sz,mss_val_cmp_flt,msk_tbl_flt,op1);
+    } /* !thr_nbr */
+    break; /* !NC_FLOAT */
+  case NC_DOUBLE:
+    /* Missing value for comparison is _FillValue (if any) otherwise default NC_FILL_FLOAT/DOUBLE */
+    if(has_mss_val) mss_val_cmp_dbl=*mss_val.dp; else mss_val_cmp_dbl=NC_FILL_DOUBLE;
+    msk_tbl_dbl[0]=msk_tbl_dbl[CCR_BGR_DBL_XPN_NBR-1]=~0ULL;
+    for(xpn_bsd=1;xpn_bsd<CCR_BGR_DBL_XPN_NBR-1;xpn_bsd++){
+      bit_xpl_nbr_rqr=xpn_bsd-1023-qnt_pwr;
+      if(bit_xpl_nbr_rqr < 0) bit_xpl_nbr_rqr=0;
+      msk_tbl_dbl[xpn_bsd]= bit_xpl_nbr_rqr >= bit_xpl_nbr_sgn_dbl ? ~0ULL : ~0ULL << (bit_xpl_nbr_sgn_dbl-bit_xpl_nbr_rqr);
+    } /* !xpn_bsd */
+    thr_nbr=ccr_thr_nbr_get(sz*sizeof(double));
+    if(thr_nbr > 1){
+      slc_sz=CCR_SLC_SZ_BYT/sizeof(double); /* Even, so every slice starts on an even element */
+      slc_nbr=(long)((sz+slc_sz-1L)/slc_sz);
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic) num_threads(thr_nbr)
+#endif /* !_OPENMP */
+      for(slc_idx=0L;slc_idx<slc_nbr;slc_idx++){
+	ptr_unn op1_slc; /* [frc] Slice of values to quantize */
+	op1_slc.dp=op1.dp+slc_idx*slc_sz;
+	ccr_bgr_dbl_abs_scl(slc_idx < slc_nbr-1L ? slc_sz : sz-slc_idx*slc_sz,mss_val_cmp_dbl,msk_tbl_dbl,op1_slc);
+      } /* !slc_idx */
+    }else{
+      ccr_bgr_dbl_abs_scl(sz,mss_val_cmp_dbl,msk_tbl_dbl,op1);
+    } /* !thr_nbr */
+    break; /* !NC_DOUBLE */
+  default: 
+    (void)fprintf(stderr,"ERROR: %s reports datum size = %d B is invalid for %s filter\n",fnc_nm,type,CCR_FLT_NAME);
+    break;
+  } /* !type */
+  
+} /* ccr_bgr_abs() */
+
+static void
+ccr_bgr_flt_scl /* [fnc] BitGroom single-precision values with portable scalar code */
+(const size_t sz, /* I [nbr] Size (in elements) of buffer to quantize */
+ const float mss_val_cmp_flt, /* I [val] Missing value for comparison */
+ const unsigned int msk_f32_u32_zro, /* I [msk] Bit Shave mask for AND */
+ const unsigned int msk_f32_u32_one, /* I [msk] Bit Set mask for OR */
+ ptr_unn op1) /* I/O [frc] Values to quantize */
+{
+  /* Purpose: Shave even and set odd elements in one pass over the buffer
+     Caller must pass an op1 that starts on an even element */
+  unsigned int *u32_ptr=op1.ui32p;
+  size_t idx;
+
+  for(idx=0L;idx+1L<sz;idx+=2L){
+    if(op1.fp[idx] != mss_val_cmp_flt) u32_ptr[idx]&=msk_f32_u32_zro;
+    if(op1.fp[idx+1L] != mss_val_cmp_flt && u32_ptr[idx+1L] != 0U) /* Never quantize upwards floating point values of zero */
+      u32_ptr[idx+1L]|=msk_f32_u32_one;
+  } /* !idx */
+  if(idx < sz && op1.fp[idx] != mss_val_cmp_flt) u32_ptr[idx]&=msk_f32_u32_zro;
+} /* !ccr_bgr_flt_scl() */
+
+static void
+ccr_bgr_dbl_scl /* [fnc] BitGroom double-precision values with portable scalar code */
+(const size_t sz, /* I [nbr] Size (in elements) of buffer to quantize */
+ const double mss_val_cmp_dbl, /* I [val] Missing value for comparison */
+ const unsigned long long int msk_f64_u64_zro, /* I [msk] Bit Shave mask for AND */
+ const unsigned long long int msk_f64_u64_one, /* I [msk] Bit Set mask for OR */
+ ptr_unn op1) /* I/O [frc] Values to quantize */
+{
+  /* Purpose: Shave even and set odd elements in one pass over the buffer
+     Caller must pass an op1 that starts on an even element */
+  unsigned long long int *u64_ptr=op1.ui64p;
+  size_t idx;
+
+  for(idx=0L;idx+1L<sz;idx+=2L){
+    if(op1.dp[idx] != mss_val_cmp_dbl) u64_ptr[idx]&=msk_f64_u64_zro;
+    if(op1.dp[idx+1L] != mss_val_cmp_dbl && u64_ptr[idx+1L] != 0ULL) /* Never quantize upwards floating point values of zero */
+      u64_ptr[idx+1L]|=msk_f64_u64_one;
+  } /* !idx */
+  if(idx < sz && op1.dp[idx] != mss_val_cmp_dbl) u64_ptr[idx]&=msk_f64_u64_zro;
+} /* !ccr_bgr_dbl_scl() */
+
+static void
+ccr_bgr_flt_abs_scl /* [fnc] BitGroom single-precision values to absolute error with portable scalar code */
+(const size_t sz, /* I [nbr] Size (in elements) of buffer to quantize */
+ const float mss_val_cmp_flt, /* I [val] Missing value for comparison */
+ const unsigned int * const msk_tbl, /* I [msk] Bit Shave masks indexed by biased exponent */
+ ptr_unn op1) /* I/O [frc] Values to quantize */
+{
+  /* Purpose: Shave even and set odd elements, each with mask for its own exponent
+     Caller must pass an op1 that starts on an even element */
+  unsigned int *u32_ptr=op1.ui32p;
+  size_t idx;
+
+  for(idx=0L;idx<sz;idx++){
+    if(op1.fp[idx] == mss_val_cmp_flt) continue;
+    if(idx % 2L == 0L) u32_ptr[idx]&=msk_tbl[(u32_ptr[idx] >> 23) & 0xFFu];
+    else if(u32_ptr[idx] != 0U) u32_ptr[idx]|=~msk_tbl[(u32_ptr[idx] >> 23) & 0xFFu]; /* Never quantize upwards floating point values of zero */
+  } /* !idx */
+} /* !ccr_bgr_flt_abs_scl() */
+
+static void
+ccr_bgr_dbl_abs_scl /* [fnc] BitGroom double-precision values to absolute error with portable scalar code */
+(const size_t sz, /* I [nbr] Size (in elements) of buffer to quantize */
+ const double mss_val_cmp_dbl, /* I [val] Missing value for comparison */
+ const unsigned long long int * const msk_tbl, /* I [msk] Bit Shave masks indexed by biased exponent */
+ ptr_unn op1) /* I/O [frc] Values to quantize */
+{
+  /* Purpose: Shave even and set odd elements, each with mask for its own exponent
+     Caller must pass an op1 that starts on an even element */
+  unsigned long long int *u64_ptr=op1.ui64p;
+  size_t idx;
+
+  for(idx=0L;idx<sz;idx++){
+    if(op1.dp[idx] == mss_val_cmp_dbl) continue;
+    if(idx % 2L == 0L) u64_ptr[idx]&=msk_tbl[(u64_ptr[idx] >> 52) & 0x7FFu];
+    else if(u64_ptr[idx] != 0ULL) u64_ptr[idx]|=~msk_tbl[(u64_ptr[idx] >> 52) & 0x7FFu]; /* Never quantize upwards floating point values of zero */
+  } /* !idx */
+} /* !ccr_bgr_dbl_abs_scl() */
+
+#ifdef CCR_SIMD_X86
+/* Vector kernels handle even and odd lanes in the same register:
+   AND mask holds the shave mask in even lanes and all ones in odd lanes,
+   OR  mask holds zeros in even lanes and the set mask in odd lanes.
+   Vector widths are even, so every vector starts on an even element, and remainders go to the scalar kernel */
+
+__attribute__((target("avx2")))
+static void
+ccr_bgr_flt_avx2 /* [fnc] BitGroom single-precision values with AVX2 */
+(const size_t sz, /* I [nbr] Size (in elements) of buffer to quantize */
+ const float mss_val_cmp_flt, /* I [val] Missing value for comparison */
+ const unsigned int msk_f32_u32_zro, /* I [msk] Bit Shave mask for AND */
+ const unsigned int msk_f32_u32_one, /* I [msk] Bit Set mask for OR */
+ ptr_unn op1) /* I/O [frc] Values to quantize */
+{
+  const __m256 mss_val_vct=_mm256_set1_ps(mss_val_cmp_flt);
+  const __m256i msk_and_vct=_mm256_blend_epi32(_mm256_set1_epi32((int)msk_f32_u32_zro),_mm256_set1_epi32(-1),0xAA);
+  const __m256i msk_or_vct=_mm256_blend_epi32(_mm256_setzero_si256(),_mm256_set1_epi32((int)msk_f32_u32_one),0xAA);
+  const __m256i zro_vct=_mm256_setzero_si256();
+  ptr_unn op1_tail;
+  size_t idx;
+
+  for(idx=0L;idx+8L<=sz;idx+=8L){
+    const __m256 val_vct=_mm256_loadu_ps(op1.fp+idx);
+    const __m256i u32_vct=_mm256_castps_si256(val_vct);
+    /* Lanes to quantize: value differs from missing value (NaN compares unequal, as in scalar code) */
+    const __m256i qnt_vct=_mm256_castps_si256(_mm256_cmp_ps(val_vct,mss_val_vct,_CMP_NEQ_UQ));
+    /* Never quantize upwards floating point values of zero */
+    const __m256i set_vct=_mm256_andnot_si256(_mm256_cmpeq_epi32(u32_vct,zro_vct),msk_or_vct);
+    const __m256i grm_vct=_mm256_or_si256(_mm256_and_si256(u32_vct,msk_and_vct),set_vct);
+    _mm256_storeu_si256((__m256i *)(op1.ui32p+idx),_mm256_blendv_epi8(u32_vct,grm_vct,qnt_vct));
+  } /* !idx */
+  op1_tail.fp=op1.fp+idx;
+  ccr_bgr_flt_scl(sz-idx,mss_val_cmp_flt,msk_f32_u32_zro,msk_f32_u32_one,op1_tail);
+} /* !ccr_bgr_flt_avx2() */
+
+__attribute__((target("avx2")))
+static void
+ccr_bgr_dbl_avx2 /* [fnc] BitGroom double-precision values with AVX2 */
+(const size_t sz, /* I [nbr] Size (in elements) of buffer to quantize */
+ const double mss_val_cmp_dbl, /* I [val] Missing value for comparison */
+ const unsigned long long int msk_f64_u64_zro, /* I [msk] Bit Shave mask for AND */
+ const unsigned long long int msk_f64_u64_one, /* I [msk] Bit Set mask for OR */
+ ptr_unn op1) /* I/O [frc] Values to quantize */
+{
+  const __m256d mss_val_vct=_mm256_set1_pd(mss_val_cmp_dbl);
+  /* 0xCC selects 32-bit lanes 2,3,6,7, i.e., the odd 64-bit lanes */
+  const __m256i msk_and_vct=_mm256_blend_epi32(_mm256_set1_epi64x((long long)msk_f64_u64_zro),_mm256_set1_epi64x(-1LL),0xCC);
+  const __m256i msk_or_vct=_mm256_blend_epi32(_mm256_setzero_si256(),_mm256_set1_epi64x((long long)msk_f64_u64_one),0xCC);
+  const __m256i zro_vct=_mm256_setzero_si256();
+  ptr_unn op1_tail;
+  size_t idx;
+
+  for(idx=0L;idx+4L<=sz;idx+=4L){
+    const __m256d val_vct=_mm256_loadu_pd(op1.dp+idx);
+    const __m256i u64_vct=_mm256_castpd_si256(val_vct);
+    const __m256i qnt_vct=_mm256_castpd_si256(_mm256_cmp_pd(val_vct,mss_val_vct,_CMP_NEQ_UQ));
+    const __m256i set_vct=_mm256_andnot_si256(_mm256_cmpeq_epi64(u64_vct,zro_vct),msk_or_vct);
+    const __m256i grm_vct=_mm256_or_si256(_mm256_and_si256(u64_vct,msk_and_vct),set_vct);
+    _mm256_storeu_si256((__m256i *)(op1.ui64p+idx),_mm256_blendv_epi8(u64_vct,grm_vct,qnt_vct));
+  } /* !idx */
+  op1_tail.dp=op1.dp+idx;
+  ccr_bgr_dbl_scl(sz-idx,mss_val_cmp_dbl,msk_f64_u64_zro,msk_f64_u64_one,op1_tail);
+} /* !ccr_bgr_dbl_avx2() */
+
+__attribute__((target("avx512f")))
+static void
+ccr_bgr_flt_avx512 /* [fnc] BitGroom single-precision values with AVX-512 */
+(const size_t sz, /* I [nbr] Size (in elements) of buffer to quantize */
+ const float mss_val_cmp_flt, /* I [val] Missing value for comparison */
+ const unsigned int msk_f32_u32_zro, /* I [msk] Bit Shave mask for AND */
+ const unsigned int msk_f32_u32_one, /* I [msk] Bit Set mask for OR */
+ ptr_unn op1) /* I/O [frc] Values to quantize */
+{
+  const __m512 mss_val_vct=_mm512_set1_ps(mss_val_cmp_flt);
+  const __m512i msk_and_vct=_mm512_mask_blend_epi32((__mmask16)0xAAAA,_mm512_set1_epi32((int)msk_f32_u32_zro),_mm512_set1_epi32(-1));
+  const __m512i msk_or_vct=_mm512_mask_blend_epi32((__mmask16)0xAAAA,_mm512_setzero_si512(),_mm512_set1_epi32((int)msk_f32_u32_one));
+  ptr_unn op1_tail;
+  size_t idx;
+
+  for(idx=0L;idx+16L<=sz;idx+=16L){
+    const __m512 val_vct=_mm512_loadu_ps(op1.fp+idx);
+    const __m512i u32_vct=_mm512_castps_si512(val_vct);
+    const __mmask16 qnt_msk=_mm512_cmp_ps_mask(val_vct,mss_val_vct,_CMP_NEQ_UQ);
+    const __m512i set_vct=_mm512_maskz_mov_epi32(_mm512_test_epi32_mask(u32_vct,u32_vct),msk_or_vct);
+    const __m512i grm_vct=_mm512_or_si512(_mm512_and_si512(u32_vct,msk_and_vct),set_vct);
+    _mm512_storeu_si512((void *)(op1.ui32p+idx),_mm512_mask_mov_epi32(u32_vct,qnt_msk,grm_vct));
+  } /* !idx */
+  op1_tail.fp=op1.fp+idx;
+  ccr_bgr_flt_scl(sz-idx,mss_val_cmp_flt,msk_f32_u32_zro,msk_f32_u32_one,op1_tail);
+} /* !ccr_bgr_flt_avx512() */
+
+__attribute__((target("avx512f")))
+static void
+ccr_bgr_dbl_avx512 /* [fnc] BitGroom double-precision values with AVX-512 */
+(const size_t sz, /* I [nbr] Size (in elements) of buffer to quantize */
+ const double mss_val_cmp_dbl, /* I [val] Missing value for comparison */
+ const unsigned long long int msk_f64_u64_zro, /* I [msk] Bit Shave mask for AND */
+ const unsigned long long int msk_f64_u64_one, /* I [msk] Bit Set mask for OR */
+ ptr_unn op1) /* I/O [frc] Values to quantize */
+{
+  const __m512d mss_val_vct=_mm512_set1_pd(mss_val_cmp_dbl);
+  const __m512i msk_and_vct=_mm512_mask_blend_epi64((__mmask8)0xAA,_mm512_set1_epi64((long long)msk_f64_u64_zro),_mm512_set1_epi64(-1LL));
+  const __m512i msk_or_vct=_mm512_mask_blend_epi64((__mmask8)0xAA,_mm512_setzero_si512(),_mm512_set1_epi64((long long)msk_f64_u64_one));
+  ptr_unn op1_tail;
+  size_t idx;
+
+  for(idx=0L;idx+8L<=sz;idx+=8L){
+    const __m512d val_vct=_mm512_loadu_pd(op1.dp+idx);
+    const __m512i u64_vct=_mm512_castpd_si512(val_vct);
+    const __mmask8 qnt_msk=_mm512_cmp_pd_mask(val_vct,mss_val_vct,_CMP_NEQ_UQ);
+    const __m512i set_vct=_mm512_maskz_mov_epi64(_mm512_test_epi64_mask(u64_vct,u64_vct),msk_or_vct);
+    const __m512i grm_vct=_mm512_or_si512(_mm512_and_si512(u64_vct,msk_and_vct),set_vct);
+    _mm512_storeu_si512((void *)(op1.ui64p+idx),_mm512_mask_mov_epi64(u64_vct,qnt_msk,grm_vct));
+  } /* !idx */
+  op1_tail.dp=op1.dp+idx;
+  ccr_bgr_dbl_scl(sz-idx,mss_val_cmp_dbl,msk_f64_u64_zro,msk_f64_u64_one,op1_tail);
+} /* !ccr_bgr_dbl_avx512() */
+#endif /* !CCR_SIMD_X86 */
+
+void
+ccr_bgr_cpu_dispatch /* [fnc] Select fastest BitGroom kernels supported by this CPU */
+(void)
+{
+  /* Purpose: Query CPUID (through compiler builtins that also check OS register-state support) and point kernels at widest supported instruction set
+     Results are identical for all kernels, only speed differs */
+  ccr_bgr_flt_knl=ccr_bgr_flt_scl;
+  ccr_bgr_dbl_knl=ccr_bgr_dbl_scl;
+  ccr_bgr_knl_nm="scalar";
+#ifdef CCR_SIMD_X86
+  __builtin_cpu_init();
+  if(__builtin_cpu_supports("avx512f")){
+    ccr_bgr_flt_knl=ccr_bgr_flt_avx512;
+    ccr_bgr_dbl_knl=ccr_bgr_dbl_avx512;
+    ccr_bgr_knl_nm="AVX-512";
+  }else if(__builtin_cpu_supports("avx2")){
+    ccr_bgr_flt_knl=ccr_bgr_flt_avx2;
+    ccr_bgr_dbl_knl=ccr_bgr_dbl_avx2;
+    ccr_bgr_knl_nm="AVX2";
+  } /* !__builtin_cpu_supports() */
+#endif /* !CCR_SIMD_X86 */
+  if(CCR_FLT_DBG_INFO) (void)fprintf(stderr,"INFO: \"%s\" filter selected %s kernels\n",CCR_FLT_NAME,ccr_bgr_knl_nm);
+} /* !ccr_bgr_cpu_dispatch() */
+
+void
+ccr_bgr_knl_ini /* [fnc] Select BitGroom kernels once per process, from any thread */
+(void)
+{
+  /* Purpose: ccr_quantize() may reach ccr_bgr() from many OpenMP or MPI threads at once, so first dispatch must not race
+     Without POSIX threads, the first quantization must finish before other threads start quantizing */
+#ifdef HAVE_PTHREAD_H
+  (void)pthread_once(&ccr_bgr_knl_once,ccr_bgr_cpu_dispatch);
+#else /* !HAVE_PTHREAD_H */
+  if(!ccr_bgr_flt_knl) ccr_bgr_cpu_dispatch();
+#endif /* !HAVE_PTHREAD_H */
+} /* !ccr_bgr_knl_ini() */
+
+int /* O [flg] Kernel is supported by this CPU and now selected */
+ccr_bgr_knl_set /* [fnc] Force BitGroom kernels, for testing only */
+(const char * const knl_nm) /* I [sng] Kernel name: "scalar", "AVX2", or "AVX-512" */
+{
+  /* Purpose: Let tests run every kernel this CPU supports, since ccr_bgr_cpu_dispatch() only selects the widest
+     Leaves selection unchanged and returns 0 for kernels this build or CPU lacks
+     Call ccr_bgr_cpu_dispatch() to restore default selection */
+  /* Dispatch first, so a later first quantization does not undo the forced choice */
+  ccr_bgr_knl_ini();
+  if(!strcmp(knl_nm,"scalar")){
+    ccr_bgr_flt_knl=ccr_bgr_flt_scl;
+    ccr_bgr_dbl_knl=ccr_bgr_dbl_scl;
+    ccr_bgr_knl_nm="scalar";
+    return 1;
+  } /* !scalar */
+#ifdef CCR_SIMD_X86
+  __builtin_cpu_init();
+  if(!strcmp(knl_nm,"AVX2") && __builtin_cpu_supports("avx2")){
+    ccr_bgr_flt_knl=ccr_bgr_flt_avx2;
+    ccr_bgr_dbl_knl=ccr_bgr_dbl_avx2;
+    ccr_bgr_knl_nm="AVX2";
+    return 1;
+  } /* !AVX2 */
+  if(!strcmp(knl_nm,"AVX-512") && __builtin_cpu_supports("avx512f")){
+    ccr_bgr_flt_knl=ccr_bgr_flt_avx512;
+    ccr_bgr_dbl_knl=ccr_bgr_dbl_avx512;
+    ccr_bgr_knl_nm="AVX-512";
+    return 1;
+  } /* !AVX-512 */
+#endif /* !CCR_SIMD_X86 */
+  return 0;
+} /* !ccr_bgr_knl_set() */
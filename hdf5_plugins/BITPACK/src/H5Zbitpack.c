@@ -0,0 +1,1024 @@
+/* Copyright (C) 2026--present Charlie Zender */
+
+ /*
+ * This file is an example of an HDF5 filter plugin.
+ * The plugin can be used with the HDF5 library version 1.8.11+ to read and write
+ * HDF5 datasets whose values are packed to their retained bits, with vectorized kernels.
+ */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h" /* Autotools tokens */
+#endif
+#include <stdio.h>
+#ifdef HAVE_SYS_TYPES_H
+# include <sys/types.h>
+#endif
+#ifdef HAVE_SYS_STAT_H
+# include <sys/stat.h>
+#endif
+#ifdef STDC_HEADERS
+# include <stdlib.h>
+# include <stddef.h>
+#else
+# ifdef HAVE_STDLIB_H
+#  include <stdlib.h>
+# endif
+#endif
+#ifdef HAVE_STRING_H
+# if !defined STDC_HEADERS && defined HAVE_MEMORY_H
+#  include <memory.h>
+# endif
+# include <string.h>
+#endif
+#ifdef HAVE_STRINGS_H
+# include <strings.h>
+#endif
+#ifdef HAVE_INTTYPES_H
+# include <inttypes.h>
+#endif
+#ifdef HAVE_STDINT_H
+# include <stdint.h>
+#endif
+#ifdef HAVE_UNISTD_H
+# include <unistd.h>
+#endif
+#include <assert.h>
+
+#if defined(_WIN32)
+#include <Winsock2.h>
+#endif
+
+/* SIMD kernels need x86 intrinsics plus GCC/Clang function-level target attributes and __builtin_cpu_supports()
+   Other compilers and architectures use the scalar kernels */
+#if defined(HAVE_IMMINTRIN_H) && (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+# define CCR_SIMD_X86 1
+# include <immintrin.h> /* SSE2 and AVX2 intrinsics */
+#endif /* !HAVE_IMMINTRIN_H */
+
+
+/* 3rd party vendors */
+#include "H5PLextern.h" /* HDF5 Plugin Library: H5PLget_plugin_type(), H5PLget_plugin_info() */
+
+#define H5Z_FILTER_BITPACK 32774 /* NB: Not yet registered with HDF, see ccr.h */
+#define H5Z_FILTER_BITROUND 32768 /* [id] BitRound filter, whose NSB this filter adopts when its own NSB is automatic */
+#define CCR_FLT_DBG_INFO 0 /* [flg] Print non-fatal debugging information */
+#define CCR_FLT_NAME "BitPack filter (trailing-zero bit packing)" /* [sng] Filter name in vernacular for HDF5 messages */
+#define CCR_FLT_NSB_AUTO 0 /* [nbr] NSB that requests trailing bits be chosen from each chunk */
+#define CCR_FLT_PRM_NBR 2 /* [nbr] Number of parameters sent to filter (in cd_params array). NB: keep identical with ccr.h:BITPACK_FLT_PRM_NBR */
+#define CCR_FLT_PRM_PSN_NSB 0 /* [nbr] Ordinal position of NSB in parameter list (cd_params array) */
+#define CCR_FLT_PRM_PSN_DATUM_SIZE 1 /* [nbr] Ordinal position of datum_size in parameter list (cd_params array) */
+#define CCR_BPK_HDR_SZ 24 /* [B] Bytes in header of packed chunk */
+#define CCR_BPK_VRS 1 /* [nbr] Version of packed chunk layout */
+#define CCR_BPK_GRP_NBR 256 /* [nbr] Values per group of interleaved bit streams */
+#define CCR_BPK_GRP_BYT 32 /* [B] Bytes per group per retained bit, i.e., one word of every stream */
+#define CCR_BPK_XCP_IDX_SZ 4 /* [B] Bytes per exception index */
+
+/* Packed chunks start with a CCR_BPK_HDR_SZ byte header:
+   "CBP", version, datum size, number of dropped bits (drp_nbr), byte order of words and values (1, little-endian), 0, then size of unpacked chunk and number of exceptions, both 64-bit big-endian
+   Each value of w=8*datum_size-drp_nbr retained bits is stored as its top w bits (value >> drp_nbr)
+   Values are packed in groups of CCR_BPK_GRP_NBR, each group being 8*datum_size values in each of CCR_BPK_GRP_BYT/datum_size lanes, value i of group in lane i%lanes
+   Lanes are bit streams of words of datum_size bytes, filled from the least significant bit, and interleaved word by word, so a group takes CCR_BPK_GRP_BYT*w bytes, and one lane fits one 32-bit or 64-bit element of a 256-bit vector
+   The at most CCR_BPK_GRP_NBR-1 values left over form one more stream, padded to a whole word
+   Exceptions are values with any non-zero dropped bit, e.g., the _FillValue, which quantizers leave intact
+   Their indices (32-bit big-endian) follow the streams, then their full values, then, unchanged, any trailing bytes that do not fill a whole value
+   Words and exception values are stored little-endian, so chunks read the same on hosts of either byte order, and big-endian hosts swap bytes after packing and before unpacking */
+
+/* Kernels pack grp_nbr groups of values into bit streams (forward), or unpack streams into values with zeroed dropped bits (reverse)
+   Kernel choice (scalar, SSE2, AVX2) is made once by ccr_bpk_cpu_dispatch() */
+typedef void
+(*ccr_bpk_knl_t) /* [fnc] Pack or unpack kernel */
+(const size_t grp_nbr, /* I [nbr] Number of groups of CCR_BPK_GRP_NBR values */
+ const size_t datum_size, /* I [B] Bytes per value, 4 or 8 */
+ const int drp_nbr, /* I [nbr] Number of trailing bits dropped from each value */
+ const unsigned char *src, /* I [val] Values or bit streams */
+ unsigned char *dst); /* O [val] Bit streams or values */
+
+/* Forward-declare functions before their names appear in H5Z_class2_t filter structure */
+size_t /* O [B] Number of bytes resulting after forward/reverse filter applied */
+H5Z_filter_bitpack /* [fnc] HDF5 BitPack Filter */
+(unsigned int flags, /* I [flg] Bitfield that encodes filter direction */
+ size_t cd_nelmts, /* I [nbr] Number of elements in filter parameter (cd_values[]) array */
+ const unsigned int cd_values[], /* I [enm] Filter parameters */
+ size_t bfr_sz_in, /* I [B] Number of bytes in input buffer (before forward/reverse filter) */
+ size_t *bfr_sz_out, /* O [B] Number of bytes in output buffer (after forward/reverse filter) */
+ void **bfr_inout); /* I/O [val] Values to pack or unpack */
+
+htri_t /* O [flg] Data meet criteria to apply filter */
+ccr_can_apply_bitpack /* [fnc] Callback to determine if current variable meets filter criteria */
+(hid_t dcpl, /* I [id] Dataset creation property list ID */
+ hid_t type, /* I [id] Dataset type ID */
+ hid_t space); /* I [id] Dataset space ID */
+
+htri_t /* O [flg] Filter parameters successfully modified for this variable */
+ccr_set_local_bitpack /* [fnc] Callback to determine and set per-variable filter parameters */
+(hid_t dcpl, /* I [id] Dataset creation property list ID */
+ hid_t type, /* I [id] Dataset type ID */
+ hid_t space); /* I [id] Dataset space ID */
+
+const H5Z_class2_t H5Z_BITPACK[1]={{
+    H5Z_CLASS_T_VERS, /* H5Z_class_t version */
+    (H5Z_filter_t)H5Z_FILTER_BITPACK, /* Filter ID number */
+#ifdef FILTER_DECODE_ONLY
+    0, /* [flg] Encoder availability flag */
+#else
+    1, /* [flg] Encoder availability flag */
+#endif
+    1, /* [flg] Decoder availability flag */
+    CCR_FLT_NAME, /* [sng] Filter name for debugging */
+    ccr_can_apply_bitpack, /* [fnc] Callback to determine if current variable meets filter criteria */
+    ccr_set_local_bitpack, /* [fnc] Callback to determine and set per-variable filter parameters */
+    (H5Z_func_t)H5Z_filter_bitpack, /* [fnc] Function to implement filter */
+  }}; /* !H5Z_BITPACK */
+
+void
+ccr_bpk_cpu_dispatch /* [fnc] Select fastest bit packing kernels supported by this CPU */
+(void);
+
+static int /* O [nbr] Trailing bits to drop, with fewest bytes in total */
+ccr_bpk_drp_get /* [fnc] Choose number of trailing bits to drop from values of chunk */
+(const size_t elm_nbr, /* I [nbr] Number of values */
+ const size_t datum_size, /* I [B] Bytes per value, 4 or 8 */
+ const unsigned char *src, /* I [val] Values */
+ size_t *xcp_nbr); /* O [nbr] Number of exceptions */
+
+static size_t /* O [nbr] Number of exceptions */
+ccr_bpk_xcp_cnt /* [fnc] Count values with any non-zero dropped bit */
+(const size_t elm_nbr, /* I [nbr] Number of values */
+ const size_t datum_size, /* I [B] Bytes per value, 4 or 8 */
+ const int drp_nbr, /* I [nbr] Number of trailing bits dropped from each value */
+ const unsigned char *src); /* I [val] Values */
+
+static void
+ccr_bpk_pck /* [fnc] Pack values into one bit stream */
+(const size_t val_nbr, /* I [nbr] Number of values */
+ const size_t stride, /* I [nbr] Distance between consecutive values, and between consecutive words */
+ const size_t datum_size, /* I [B] Bytes per value, 4 or 8 */
+ const int drp_nbr, /* I [nbr] Number of trailing bits dropped from each value */
+ const unsigned char *src, /* I [val] First value */
+ unsigned char *dst); /* O [val] First word of stream */
+
+static void
+ccr_bpk_unp /* [fnc] Unpack values from one bit stream */
+(const size_t val_nbr, /* I [nbr] Number of values */
+ const size_t stride, /* I [nbr] Distance between consecutive values, and between consecutive words */
+ const size_t datum_size, /* I [B] Bytes per value, 4 or 8 */
+ const int drp_nbr, /* I [nbr] Number of trailing bits dropped from each value */
+ const unsigned char *src, /* I [val] First word of stream */
+ unsigned char *dst); /* O [val] First value */
+
+/* Kernels selected by ccr_bpk_cpu_dispatch(), NULL until first dispatch */
+static ccr_bpk_knl_t ccr_bpk_fwd_knl=NULL; /* [fnc] Pack kernel */
+static ccr_bpk_knl_t ccr_bpk_rev_knl=NULL; /* [fnc] Unpack kernel */
+static const char *ccr_bpk_knl_nm="none"; /* [sng] Name of selected kernels, for debugging */
+
+/* Function definitions */
+H5PL_type_t /* O [enm] Plugin type */
+H5PLget_plugin_type /* [fnc] Provide plug-in type provided by this shared library */
+(void)
+{ /* Purpose: Describe plug-in type provided by this shared library
+     The HDF5 plugin mechanism usually calls this function after an application calls H5Pset_filter(), or when the data to which this filter will be applied are first read */
+  return H5PL_TYPE_FILTER;
+} /* !H5PLget_plugin_type() */
+
+const void * /* O [enm] */
+H5PLget_plugin_info /* [fnc] Return structure */
+(void)
+{ /* Purpose: Provide structure that defines BitPack filter so the filter may be dynamically registered with the plugin mechanism
+     The HDF5 plugin mechanism usually calls this function after an application calls H5Pset_filter(), or when the data to which this filter will be applied are first read */
+  ccr_bpk_cpu_dispatch();
+  return H5Z_BITPACK;
+} /* !H5PLget_plugin_info() */
+
+static void
+ccr_bpk_put_be64 /* [fnc] Store 64-bit big-endian integer */
+(unsigned char *dst, /* O [B] Eight bytes */
+ uint64_t val) /* I [nbr] Integer to store */
+{
+  int byt_idx; /* [idx] Byte within integer */
+  for(byt_idx=7;byt_idx>=0;byt_idx--){
+    dst[byt_idx]=(unsigned char)(val & 0xFF);
+    val>>=8;
+  } /* !byt_idx */
+} /* !ccr_bpk_put_be64() */
+
+static uint64_t /* O [nbr] Integer read */
+ccr_bpk_get_be64 /* [fnc] Read 64-bit big-endian integer */
+(const unsigned char *src) /* I [B] Eight bytes */
+{
+  uint64_t val=0; /* [nbr] Integer read */
+  int byt_idx; /* [idx] Byte within integer */
+  for(byt_idx=0;byt_idx<8;byt_idx++) val=(val << 8) | src[byt_idx];
+  return val;
+} /* !ccr_bpk_get_be64() */
+
+static unsigned char /* O [enm] Byte order of this host, 1 little-endian, 2 big-endian */
+ccr_bpk_byt_ord /* [fnc] Byte order of this host */
+(void)
+{
+  const uint16_t one=1; /* [nbr] Integer whose first byte tells byte order */
+  unsigned char byt; /* [B] First byte of one */
+  memcpy(&byt,&one,1);
+  return byt ? 1 : 2;
+} /* !ccr_bpk_byt_ord() */
+
+static void
+ccr_bpk_byt_swp /* [fnc] Reverse bytes of each word between host and stored (little-endian) order */
+(const size_t wrd_nbr, /* I [nbr] Number of words */
+ const size_t datum_size, /* I [B] Bytes per word, 4 or 8 */
+ unsigned char *wrd) /* I/O [val] First word */
+{
+  /* Purpose: Convert words of streams and exception values on big-endian hosts, where kernels work in native order */
+  unsigned char byt; /* [B] Byte being swapped */
+  size_t byt_idx; /* [idx] Byte within word */
+  size_t wrd_idx; /* [idx] Word */
+
+  for(wrd_idx=0;wrd_idx<wrd_nbr;wrd_idx++,wrd+=datum_size){
+    for(byt_idx=0;byt_idx<datum_size/2;byt_idx++){
+      byt=wrd[byt_idx];
+      wrd[byt_idx]=wrd[datum_size-1-byt_idx];
+      wrd[datum_size-1-byt_idx]=byt;
+    } /* !byt_idx */
+  } /* !wrd_idx */
+} /* !ccr_bpk_byt_swp() */
+
+size_t /* O [B] Number of bytes resulting after forward/reverse filter applied */
+H5Z_filter_bitpack /* [fnc] HDF5 BitPack Filter */
+(unsigned int flags, /* I [flg] Bitfield that encodes filter direction */
+ size_t cd_nelmts, /* I [nbr] Number of elements in filter parameter (cd_values[]) array */
+ const unsigned int cd_values[], /* I [enm] Filter parameters */
+ size_t bfr_sz_in, /* I [B] Number of bytes in input buffer (before forward/reverse filter) */
+ size_t *bfr_sz_out, /* O [B] Number of bytes in output buffer (after forward/reverse filter) */
+ void **bfr_inout) /* I/O [val] Values to pack or unpack */
+{
+  /* Purpose: Dynamic filter invoked by HDF5 to drop the trailing mantissa bits that a quantizer zeroed, and pack the retained bits of each value into a dense bit stream
+     The stream is smaller than the input by the fraction of bits dropped, with no entropy coder at all, so writes are fast and their size is known in advance
+     Filter is lossless: values with non-zero dropped bits are stored in full as exceptions */
+
+  const char fnc_nm[]="H5Z_filter_bitpack()"; /* [sng] Function name */
+
+  size_t datum_size; /* [B] Bytes per unfiltered data value */
+  size_t elm_nbr; /* [nbr] Number of values in unpacked chunk */
+  size_t grp_nbr; /* [nbr] Number of whole groups */
+  size_t idx;
+  size_t pck_sz; /* [B] Bytes in bit streams */
+  size_t rmn_nbr; /* [nbr] Values after last whole group */
+  size_t tail_sz; /* [B] Trailing bytes that do not fill a whole value */
+  size_t bfr_sz_new; /* [B] Bytes in new buffer */
+  size_t unp_sz; /* [B] Bytes in unpacked chunk */
+  size_t xcp_idx; /* [idx] Exception */
+  size_t xcp_nbr; /* [nbr] Number of exceptions */
+  int bit_nbr; /* [nbr] Bits retained per value */
+  int drp_nbr; /* [nbr] Trailing bits dropped from each value */
+  int wrd_bit_nbr; /* [nbr] Bits per value and per word of stream */
+  unsigned char *bfr_new=NULL; /* [ptr] New buffer */
+  const unsigned char *bfr_old=(const unsigned char *)(*bfr_inout); /* [ptr] Input buffer */
+  unsigned char *xcp_val; /* [ptr] First exception value */
+  unsigned char *xcp_ptr; /* [ptr] First exception index */
+
+  if(!ccr_bpk_fwd_knl) ccr_bpk_cpu_dispatch();
+
+  if(cd_nelmts < CCR_FLT_PRM_NBR){
+    (void)fprintf(stderr,"ERROR: \"%s\" filter function %s reports %lu parameters, needs %d\n",CCR_FLT_NAME,fnc_nm,(unsigned long)cd_nelmts,CCR_FLT_PRM_NBR);
+    return 0;
+  } /* !cd_nelmts */
+  datum_size=cd_values[CCR_FLT_PRM_PSN_DATUM_SIZE];
+  if(datum_size != 4 && datum_size != 8){
+    (void)fprintf(stderr,"ERROR: \"%s\" filter function %s reports datum size = %lu B is invalid, must be 4 or 8\n",CCR_FLT_NAME,fnc_nm,(unsigned long)datum_size);
+    return 0;
+  } /* !datum_size */
+  wrd_bit_nbr=(int)(8*datum_size);
+
+  if(flags & H5Z_FLAG_REVERSE){
+
+    /* Unpack, after reading */
+    if(bfr_sz_in < CCR_BPK_HDR_SZ || memcmp(bfr_old,"CBP",3)){
+      (void)fprintf(stderr,"ERROR: \"%s\" filter function %s reports chunk of %lu B has no BitPack header\n",CCR_FLT_NAME,fnc_nm,(unsigned long)bfr_sz_in);
+      return 0;
+    } /* !bfr_sz_in */
+    if(bfr_old[3] != CCR_BPK_VRS){
+      (void)fprintf(stderr,"ERROR: \"%s\" filter function %s reports chunk header version %d is not supported\n",CCR_FLT_NAME,fnc_nm,(int)bfr_old[3]);
+      return 0;
+    } /* !CCR_BPK_VRS */
+    drp_nbr=bfr_old[5];
+    if(bfr_old[4] != datum_size || drp_nbr >= wrd_bit_nbr){
+      (void)fprintf(stderr,"ERROR: \"%s\" filter function %s reports chunk header datum size = %d B and dropped bits = %d do not match datum size = %lu B\n",CCR_FLT_NAME,fnc_nm,(int)bfr_old[4],drp_nbr,(unsigned long)datum_size);
+      return 0;
+    } /* !drp_nbr */
+    unp_sz=(size_t)ccr_bpk_get_be64(bfr_old+8);
+    xcp_nbr=(size_t)ccr_bpk_get_be64(bfr_old+16);
+    bit_nbr=wrd_bit_nbr-drp_nbr;
+    elm_nbr=unp_sz/datum_size;
+    tail_sz=unp_sz%datum_size;
+    grp_nbr=elm_nbr/CCR_BPK_GRP_NBR;
+    rmn_nbr=elm_nbr%CCR_BPK_GRP_NBR;
+    pck_sz=grp_nbr*CCR_BPK_GRP_BYT*bit_nbr+(rmn_nbr*bit_nbr+wrd_bit_nbr-1)/wrd_bit_nbr*datum_size;
+    if(xcp_nbr > elm_nbr || CCR_BPK_HDR_SZ+pck_sz+xcp_nbr*(CCR_BPK_XCP_IDX_SZ+datum_size)+tail_sz != bfr_sz_in){
+      (void)fprintf(stderr,"ERROR: \"%s\" filter function %s reports chunk of %lu B does not match its header\n",CCR_FLT_NAME,fnc_nm,(unsigned long)bfr_sz_in);
+      return 0;
+    } /* !bfr_sz_in */
+
+    if(!(bfr_new=(unsigned char *)malloc(unp_sz > 0 ? unp_sz : 1))){
+      (void)fprintf(stderr,"ERROR: \"%s\" filter function %s unable to allocate %lu B for unpacked data\n",CCR_FLT_NAME,fnc_nm,(unsigned long)unp_sz);
+      return 0;
+    } /* !bfr_new */
+
+    if(CCR_FLT_DBG_INFO) (void)fprintf(stderr,"INFO: %s unpacks %lu values of %d bits with %lu exceptions with %s kernel\n",fnc_nm,(unsigned long)elm_nbr,bit_nbr,(unsigned long)xcp_nbr,ccr_bpk_knl_nm);
+
+    /* Input buffer is freed below, so convert stored words and exception values to host order in place */
+    if(ccr_bpk_byt_ord() != 1){
+      ccr_bpk_byt_swp(pck_sz/datum_size,datum_size,(unsigned char *)*bfr_inout+CCR_BPK_HDR_SZ);
+      ccr_bpk_byt_swp(xcp_nbr,datum_size,(unsigned char *)*bfr_inout+CCR_BPK_HDR_SZ+pck_sz+xcp_nbr*CCR_BPK_XCP_IDX_SZ);
+    } /* !ccr_bpk_byt_ord() */
+
+    bfr_old+=CCR_BPK_HDR_SZ;
+    ccr_bpk_rev_knl(grp_nbr,datum_size,drp_nbr,bfr_old,bfr_new);
+    ccr_bpk_unp(rmn_nbr,1,datum_size,drp_nbr,bfr_old+grp_nbr*CCR_BPK_GRP_BYT*bit_nbr,bfr_new+grp_nbr*CCR_BPK_GRP_NBR*datum_size);
+    bfr_old+=pck_sz;
+    for(xcp_idx=0;xcp_idx<xcp_nbr;xcp_idx++){
+      const unsigned char *idx_ptr=bfr_old+xcp_idx*CCR_BPK_XCP_IDX_SZ; /* [ptr] Big-endian index of exception */
+      idx=((size_t)idx_ptr[0] << 24) | ((size_t)idx_ptr[1] << 16) | ((size_t)idx_ptr[2] << 8) | (size_t)idx_ptr[3];
+      if(idx >= elm_nbr){
+	(void)fprintf(stderr,"ERROR: \"%s\" filter function %s reports exception index %lu exceeds %lu values\n",CCR_FLT_NAME,fnc_nm,(unsigned long)idx,(unsigned long)elm_nbr);
+	free(bfr_new);
+	return 0;
+      } /* !idx */
+      memcpy(bfr_new+idx*datum_size,bfr_old+xcp_nbr*CCR_BPK_XCP_IDX_SZ+xcp_idx*datum_size,datum_size);
+    } /* !xcp_idx */
+    bfr_old+=xcp_nbr*(CCR_BPK_XCP_IDX_SZ+datum_size);
+    if(tail_sz > 0) memcpy(bfr_new+elm_nbr*datum_size,bfr_old,tail_sz);
+    bfr_sz_new=unp_sz;
+
+  }else{
+
+    /* Pack, before writing */
+    unp_sz=bfr_sz_in;
+    elm_nbr=unp_sz/datum_size;
+    tail_sz=unp_sz%datum_size;
+    if(elm_nbr > 0xFFFFFFFFUL){
+      (void)fprintf(stderr,"ERROR: \"%s\" filter function %s reports chunk of %lu values exceeds 32-bit exception indices\n",CCR_FLT_NAME,fnc_nm,(unsigned long)elm_nbr);
+      return 0;
+    } /* !elm_nbr */
+
+    /* User or quantizer sets NSB, otherwise chunk values do */
+    if(cd_values[CCR_FLT_PRM_PSN_NSB] != CCR_FLT_NSB_AUTO){
+      const int mnt_nbr=datum_size == 4 ? 23 : 52; /* [nbr] Explicit mantissa bits */
+      drp_nbr=(int)cd_values[CCR_FLT_PRM_PSN_NSB] >= mnt_nbr ? 0 : mnt_nbr-(int)cd_values[CCR_FLT_PRM_PSN_NSB];
+      xcp_nbr=ccr_bpk_xcp_cnt(elm_nbr,datum_size,drp_nbr,bfr_old);
+    }else{
+      drp_nbr=ccr_bpk_drp_get(elm_nbr,datum_size,bfr_old,&xcp_nbr);
+    } /* !CCR_FLT_NSB_AUTO */
+    bit_nbr=wrd_bit_nbr-drp_nbr;
+    grp_nbr=elm_nbr/CCR_BPK_GRP_NBR;
+    rmn_nbr=elm_nbr%CCR_BPK_GRP_NBR;
+    pck_sz=grp_nbr*CCR_BPK_GRP_BYT*bit_nbr+(rmn_nbr*bit_nbr+wrd_bit_nbr-1)/wrd_bit_nbr*datum_size;
+    bfr_sz_new=CCR_BPK_HDR_SZ+pck_sz+xcp_nbr*(CCR_BPK_XCP_IDX_SZ+datum_size)+tail_sz;
+
+    if(!(bfr_new=(unsigned char *)malloc(bfr_sz_new))){
+      (void)fprintf(stderr,"ERROR: \"%s\" filter function %s unable to allocate %lu B for packed data\n",CCR_FLT_NAME,fnc_nm,(unsigned long)bfr_sz_new);
+      return 0;
+    } /* !bfr_new */
+
+    if(CCR_FLT_DBG_INFO) (void)fprintf(stderr,"INFO: %s packs %lu values of %d bits with %lu exceptions with %s kernel\n",fnc_nm,(unsigned long)elm_nbr,bit_nbr,(unsigned long)xcp_nbr,ccr_bpk_knl_nm);
+
+    memcpy(bfr_new,"CBP",3);
+    bfr_new[3]=CCR_BPK_VRS;
+    bfr_new[4]=(unsigned char)datum_size;
+    bfr_new[5]=(unsigned char)drp_nbr;
+    bfr_new[6]=1;
+    bfr_new[7]=0;
+    ccr_bpk_put_be64(bfr_new+8,(uint64_t)unp_sz);
+    ccr_bpk_put_be64(bfr_new+16,(uint64_t)xcp_nbr);
+
+    ccr_bpk_fwd_knl(grp_nbr,datum_size,drp_nbr,bfr_old,bfr_new+CCR_BPK_HDR_SZ);
+    ccr_bpk_pck(rmn_nbr,1,datum_size,drp_nbr,bfr_old+grp_nbr*CCR_BPK_GRP_NBR*datum_size,bfr_new+CCR_BPK_HDR_SZ+grp_nbr*CCR_BPK_GRP_BYT*bit_nbr);
+    xcp_ptr=bfr_new+CCR_BPK_HDR_SZ+pck_sz;
+    xcp_val=xcp_ptr+xcp_nbr*CCR_BPK_XCP_IDX_SZ;
+    if(xcp_nbr > 0){
+      const uint64_t drp_msk=(((uint64_t)1) << drp_nbr)-1; /* [msk] Dropped bits */
+      uint32_t u32; /* [val] Single-precision value */
+      uint64_t val; /* [val] Value */
+      for(idx=0;idx<elm_nbr;idx++){
+	if(datum_size == 4){
+	  memcpy(&u32,bfr_old+idx*4,4);
+	  val=u32;
+	}else{
+	  memcpy(&val,bfr_old+idx*8,8);
+	} /* !datum_size */
+	if(!(val & drp_msk)) continue;
+	xcp_ptr[0]=(unsigned char)(idx >> 24);
+	xcp_ptr[1]=(unsigned char)(idx >> 16);
+	xcp_ptr[2]=(unsigned char)(idx >> 8);
+	xcp_ptr[3]=(unsigned char)idx;
+	xcp_ptr+=CCR_BPK_XCP_IDX_SZ;
+	memcpy(xcp_val,bfr_old+idx*datum_size,datum_size);
+	xcp_val+=datum_size;
+      } /* !idx */
+    } /* !xcp_nbr */
+    if(tail_sz > 0) memcpy(xcp_val,bfr_old+elm_nbr*datum_size,tail_sz);
+
+    /* Store words and exception values little-endian */
+    if(ccr_bpk_byt_ord() != 1){
+      ccr_bpk_byt_swp(pck_sz/datum_size,datum_size,bfr_new+CCR_BPK_HDR_SZ);
+      ccr_bpk_byt_swp(xcp_nbr,datum_size,bfr_new+CCR_BPK_HDR_SZ+pck_sz+xcp_nbr*CCR_BPK_XCP_IDX_SZ);
+    } /* !ccr_bpk_byt_ord() */
+
+  } /* !flags */
+
+  free(*bfr_inout);
+  *bfr_inout=bfr_new;
+  *bfr_sz_out=bfr_sz_new;
+  return bfr_sz_new;
+
+} /* !H5Z_filter_bitpack() */
+
+htri_t /* O [flg] Data meet criteria to apply filter */
+ccr_can_apply_bitpack /* [fnc] Callback to determine if current variable meets filter criteria */
+(hid_t dcpl, /* I [id] Dataset creation property list ID */
+ hid_t type, /* I [id] Dataset type ID */
+ hid_t space) /* I [id] Dataset space ID */
+{
+  /* Data space must be simple, i.e., a multi-dimensional array */
+  if(H5Sis_simple(space) <= 0){
+    fprintf(stderr,"WARNING: Cannot apply filter \"%s\" filter because data space is not simple.\n",CCR_FLT_NAME);
+    return 0;
+  } /* !H5Sis_simple(space) */
+
+  /* Filter can be applied */
+  return 1;
+} /* !ccr_can_apply_bitpack() */
+
+htri_t /* O [flg] Filter parameters successfully modified for this variable */
+ccr_set_local_bitpack /* [fnc] Callback to determine and set per-variable filter parameters */
+(hid_t dcpl, /* I [id] Dataset creation property list ID */
+ hid_t type, /* I [id] Dataset type ID */
+ hid_t space) /* I [id] Dataset space ID */
+{
+  const char fnc_nm[]="ccr_set_local_bitpack()"; /* [sng] Function name */
+
+  herr_t rcd; /* [flg] Return code */
+
+  /* Initialize filter parameters with default values */
+  unsigned int ccr_flt_prm[CCR_FLT_PRM_NBR]={CCR_FLT_NSB_AUTO,0};
+
+  /* Initialize output variables for call to H5Pget_filter_by_id() */
+  unsigned int flags=0;
+  size_t cd_nelmts=CCR_FLT_PRM_NBR;
+  unsigned int *cd_values=ccr_flt_prm;
+
+  /* Retrieve parameters specified by user
+     https://support.hdfgroup.org/HDF5/doc/RM/RM_H5P.html#FunctionIndex
+     Ignore name and filter_config by setting last three arguments to 0/NULL */
+  rcd=H5Pget_filter_by_id(dcpl,H5Z_FILTER_BITPACK,&flags,&cd_nelmts,cd_values,0,NULL,NULL);
+  if(rcd < 0){
+    (void)fprintf(stderr,"ERROR: %s filter callback function %s reports H5Pget_filter_by_id() failed to get filter flags and parameters for current variable\n",CCR_FLT_NAME,fnc_nm);
+    return 0;
+  } /* !rcd */
+
+  /* Packing is only for floating-point data, whose trailing mantissa bits quantizers zero */
+  H5T_class_t data_class; /* [enm] Data type class identifier (H5T_FLOAT, H5T_INT, H5T_STRING, ...) */
+  data_class=H5Tget_class(type);
+  if(data_class < 0){
+    (void)fprintf(stderr,"ERROR: %s filter callback function %s reports H5Tget_class() returned invalid data type class identifier = %d for current variable\n",CCR_FLT_NAME,fnc_nm,(int)data_class);
+    return 0;
+  } /* !data_class */
+
+  /* Datum size is determined by variable type */
+  size_t datum_size; /* [B] Bytes per data value */
+  datum_size=H5Tget_size(type);
+  if(datum_size <= 0){
+    (void)fprintf(stderr,"ERROR: %s filter callback function %s reports H5Tget_size() returned invalid datum size = %lu B\n",CCR_FLT_NAME,fnc_nm,datum_size);
+    return 0;
+  } /* !datum_size */
+
+  if(data_class != H5T_FLOAT || (datum_size != 4 && datum_size != 8)){
+    if(CCR_FLT_DBG_INFO) (void)fprintf(stdout,"INFO: \"%s\" filter callback function %s reports variable is not single- or double-precision floating-point. Removing packing filter...\n",CCR_FLT_NAME,fnc_nm);
+    rcd=H5Premove_filter(dcpl,H5Z_FILTER_BITPACK);
+    if(rcd < 0) return 0;
+    return 1;
+  } /* !data_class */
+  ccr_flt_prm[CCR_FLT_PRM_PSN_DATUM_SIZE]=(unsigned int)datum_size;
+
+  /* Automatic NSB adopts NSB of a BitRound filter earlier in the pipeline, if that NSB is fixed
+     Other quantizers (Granular BitRound, BitRound with automatic NSB) vary the zeroed bits, so each chunk chooses */
+  if(ccr_flt_prm[CCR_FLT_PRM_PSN_NSB] == CCR_FLT_NSB_AUTO){
+    unsigned int btr_prm[1]; /* [nbr] First parameter of BitRound filter, its NSB */
+    unsigned int btr_flags; /* [flg] Flags of filter at this position */
+    size_t btr_nelmts; /* [nbr] Number of BitRound parameters */
+    H5Z_filter_t flt_id; /* [id] Filter at this position in pipeline */
+    int flt_idx; /* [idx] Position of filter in pipeline */
+    int flt_nbr; /* [nbr] Number of filters in pipeline */
+
+    flt_nbr=H5Pget_nfilters(dcpl);
+    for(flt_idx=0;flt_idx<flt_nbr;flt_idx++){
+      btr_nelmts=1;
+      btr_prm[0]=0;
+      flt_id=H5Pget_filter2(dcpl,(unsigned int)flt_idx,&btr_flags,&btr_nelmts,btr_prm,0,NULL,NULL);
+      if(flt_id < 0 || flt_id == H5Z_FILTER_BITPACK) break;
+      if(flt_id == H5Z_FILTER_BITROUND && btr_nelmts >= 1) ccr_flt_prm[CCR_FLT_PRM_PSN_NSB]=btr_prm[0];
+    } /* !flt_idx */
+  } /* !CCR_FLT_NSB_AUTO */
+
+  /* Update invoked filter with generic parameters as invoked with variable-specific values */
+  rcd=H5Pmodify_filter(dcpl,H5Z_FILTER_BITPACK,flags,CCR_FLT_PRM_NBR,cd_values);
+  if(rcd < 0){
+    (void)fprintf(stderr,"ERROR: \"%s\" filter callback function %s reports H5Pmodify_filter() unable to modify filter parameters\n",CCR_FLT_NAME,fnc_nm);
+    return 0;
+  } /* !rcd */
+
+  return 1;
+} /* !ccr_set_local_bitpack() */
+
+static int /* O [nbr] Trailing zero bits of value, at most cap */
+ccr_bpk_ctz /* [fnc] Count trailing zero bits */
+(uint64_t val, /* I [val] Value */
+ const int cap) /* I [nbr] Result for zero, and maximum result */
+{
+  int ctz=0; /* [nbr] Trailing zero bits */
+
+  if(!val) return cap;
+#if defined(__GNUC__) || defined(__clang__)
+  ctz=__builtin_ctzll(val);
+#else /* !__GNUC__ */
+  while(!(val & 1)){
+    val>>=1;
+    ctz++;
+  } /* !val */
+#endif /* !__GNUC__ */
+  return ctz < cap ? ctz : cap;
+} /* !ccr_bpk_ctz() */
+
+static int /* O [nbr] Trailing bits to drop, with fewest bytes in total */
+ccr_bpk_drp_get /* [fnc] Choose number of trailing bits to drop from values of chunk */
+(const size_t elm_nbr, /* I [nbr] Number of values */
+ const size_t datum_size, /* I [B] Bytes per value, 4 or 8 */
+ const unsigned char *src, /* I [val] Values */
+ size_t *xcp_nbr) /* O [nbr] Number of exceptions */
+{
+  /* Purpose: Histogram trailing zero bits of all values, then drop the number of bits that minimizes packed bits plus exceptions
+     Quantized values share most trailing zeros, while _FillValue and other unquantized values become exceptions
+     At least one bit per value is retained, so that zero values need no special case */
+  const int wrd_bit_nbr=(int)(8*datum_size); /* [nbr] Bits per value */
+  size_t ctz_cnt[4][64]; /* [nbr] Number of values with each count of trailing zeros, in four copies so that runs of equal counts do not wait on one another */
+  size_t ge_nbr=0; /* [nbr] Number of values with at least drp_nbr trailing zeros */
+  size_t idx;
+  uint64_t cst; /* [bit] Size of packed values and exceptions */
+  uint64_t cst_min=0; /* [bit] Smallest size so far */
+  uint32_t u32; /* [val] Single-precision value */
+  uint64_t u64; /* [val] Double-precision value */
+  int drp_nbr; /* [nbr] Trailing bits dropped */
+  int drp_bst=0; /* [nbr] Trailing bits dropped for smallest size */
+
+  memset(ctz_cnt,0,sizeof(ctz_cnt));
+  if(datum_size == 4){
+    for(idx=0;idx<elm_nbr;idx++){
+      memcpy(&u32,src+idx*4,4);
+      ctz_cnt[idx%4][ccr_bpk_ctz(u32,31)]++;
+    } /* !idx */
+  }else{
+    for(idx=0;idx<elm_nbr;idx++){
+      memcpy(&u64,src+idx*8,8);
+      ctz_cnt[idx%4][ccr_bpk_ctz(u64,63)]++;
+    } /* !idx */
+  } /* !datum_size */
+
+  *xcp_nbr=0;
+  for(drp_nbr=wrd_bit_nbr-1;drp_nbr>=0;drp_nbr--){
+    ge_nbr+=ctz_cnt[0][drp_nbr]+ctz_cnt[1][drp_nbr]+ctz_cnt[2][drp_nbr]+ctz_cnt[3][drp_nbr];
+    cst=(uint64_t)elm_nbr*(uint64_t)(wrd_bit_nbr-drp_nbr)+(uint64_t)(elm_nbr-ge_nbr)*8*(CCR_BPK_XCP_IDX_SZ+datum_size);
+    if(drp_nbr == wrd_bit_nbr-1 || cst < cst_min){
+      cst_min=cst;
+      drp_bst=drp_nbr;
+      *xcp_nbr=elm_nbr-ge_nbr;
+    } /* !cst */
+  } /* !drp_nbr */
+  return drp_bst;
+} /* !ccr_bpk_drp_get() */
+
+static size_t /* O [nbr] Number of exceptions */
+ccr_bpk_xcp_cnt /* [fnc] Count values with any non-zero dropped bit */
+(const size_t elm_nbr, /* I [nbr] Number of values */
+ const size_t datum_size, /* I [B] Bytes per value, 4 or 8 */
+ const int drp_nbr, /* I [nbr] Number of trailing bits dropped from each value */
+ const unsigned char *src) /* I [val] Values */
+{
+  size_t xcp_nbr=0; /* [nbr] Number of exceptions */
+  size_t idx;
+
+  if(datum_size == 4){
+    const uint32_t drp_msk=(uint32_t)((((uint64_t)1) << drp_nbr)-1); /* [msk] Dropped bits */
+    uint32_t u32; /* [val] Single-precision value */
+    for(idx=0;idx<elm_nbr;idx++){
+      memcpy(&u32,src+idx*4,4);
+      xcp_nbr+=(u32 & drp_msk) != 0;
+    } /* !idx */
+  }else{
+    const uint64_t drp_msk=(((uint64_t)1) << drp_nbr)-1; /* [msk] Dropped bits */
+    uint64_t u64; /* [val] Double-precision value */
+    for(idx=0;idx<elm_nbr;idx++){
+      memcpy(&u64,src+idx*8,8);
+      xcp_nbr+=(u64 & drp_msk) != 0;
+    } /* !idx */
+  } /* !datum_size */
+  return xcp_nbr;
+} /* !ccr_bpk_xcp_cnt() */
+
+/* Scalar stream functions define the layout, SIMD kernels reproduce it bit-for-bit
+   Packing ORs each value, shifted by the bits already in the current word, into the word, and stores the word once full
+   Bits of the value that did not fit start the next word */
+
+static void
+ccr_bpk_pck /* [fnc] Pack values into one bit stream */
+(const size_t val_nbr, /* I [nbr] Number of values */
+ const size_t stride, /* I [nbr] Distance between consecutive values, and between consecutive words */
+ const size_t datum_size, /* I [B] Bytes per value, 4 or 8 */
+ const int drp_nbr, /* I [nbr] Number of trailing bits dropped from each value */
+ const unsigned char *src, /* I [val] First value */
+ unsigned char *dst) /* O [val] First word of stream */
+{
+  const int wrd_bit_nbr=(int)(8*datum_size); /* [nbr] Bits per value and per word */
+  const int bit_nbr=wrd_bit_nbr-drp_nbr; /* [nbr] Bits retained per value */
+  const size_t stp=stride*datum_size; /* [B] Distance between consecutive values */
+  size_t idx;
+  unsigned char *wrd=dst; /* [ptr] Next word to store */
+  int fll=0; /* [nbr] Bits in current word */
+
+  if(datum_size == 4){
+    uint32_t acc=0,val; /* [val] Current word, value */
+    for(idx=0;idx<val_nbr;idx++){
+      memcpy(&val,src+idx*stp,4);
+      val>>=drp_nbr;
+      acc|=val << fll;
+      fll+=bit_nbr;
+      if(fll >= wrd_bit_nbr){
+	memcpy(wrd,&acc,4);
+	wrd+=stp;
+	fll-=wrd_bit_nbr;
+	acc=fll ? val >> (bit_nbr-fll) : 0;
+      } /* !fll */
+    } /* !idx */
+    if(fll) memcpy(wrd,&acc,4);
+  }else{
+    uint64_t acc=0,val; /* [val] Current word, value */
+    for(idx=0;idx<val_nbr;idx++){
+      memcpy(&val,src+idx*stp,8);
+      val>>=drp_nbr;
+      acc|=val << fll;
+      fll+=bit_nbr;
+      if(fll >= wrd_bit_nbr){
+	memcpy(wrd,&acc,8);
+	wrd+=stp;
+	fll-=wrd_bit_nbr;
+	acc=fll ? val >> (bit_nbr-fll) : 0;
+      } /* !fll */
+    } /* !idx */
+    if(fll) memcpy(wrd,&acc,8);
+  } /* !datum_size */
+} /* !ccr_bpk_pck() */
+
+static void
+ccr_bpk_unp /* [fnc] Unpack values from one bit stream */
+(const size_t val_nbr, /* I [nbr] Number of values */
+ const size_t stride, /* I [nbr] Distance between consecutive values, and between consecutive words */
+ const size_t datum_size, /* I [B] Bytes per value, 4 or 8 */
+ const int drp_nbr, /* I [nbr] Number of trailing bits dropped from each value */
+ const unsigned char *src, /* I [val] First word of stream */
+ unsigned char *dst) /* O [val] First value */
+{
+  const int wrd_bit_nbr=(int)(8*datum_size); /* [nbr] Bits per value and per word */
+  const int bit_nbr=wrd_bit_nbr-drp_nbr; /* [nbr] Bits retained per value */
+  const size_t stp=stride*datum_size; /* [B] Distance between consecutive values */
+  size_t idx;
+  const unsigned char *wrd=src; /* [ptr] Current word */
+  int pos=0; /* [nbr] Bits of current word already unpacked */
+
+  if(val_nbr == 0) return;
+  if(datum_size == 4){
+    const uint32_t msk=bit_nbr == 32 ? ~(uint32_t)0 : (((uint32_t)1) << bit_nbr)-1; /* [msk] Retained bits */
+    uint32_t cur,val; /* [val] Current word, value */
+    memcpy(&cur,wrd,4);
+    for(idx=0;idx<val_nbr;idx++){
+      val=cur >> pos;
+      pos+=bit_nbr;
+      if(pos >= wrd_bit_nbr){
+	pos-=wrd_bit_nbr;
+	wrd+=stp;
+	if(pos || idx+1 < val_nbr) memcpy(&cur,wrd,4);
+	if(pos) val|=cur << (bit_nbr-pos);
+      } /* !pos */
+      val=(val & msk) << drp_nbr;
+      memcpy(dst+idx*stp,&val,4);
+    } /* !idx */
+  }else{
+    const uint64_t msk=bit_nbr == 64 ? ~(uint64_t)0 : (((uint64_t)1) << bit_nbr)-1; /* [msk] Retained bits */
+    uint64_t cur,val; /* [val] Current word, value */
+    memcpy(&cur,wrd,8);
+    for(idx=0;idx<val_nbr;idx++){
+      val=cur >> pos;
+      pos+=bit_nbr;
+      if(pos >= wrd_bit_nbr){
+	pos-=wrd_bit_nbr;
+	wrd+=stp;
+	if(pos || idx+1 < val_nbr) memcpy(&cur,wrd,8);
+	if(pos) val|=cur << (bit_nbr-pos);
+      } /* !pos */
+      val=(val & msk) << drp_nbr;
+      memcpy(dst+idx*stp,&val,8);
+    } /* !idx */
+  } /* !datum_size */
+} /* !ccr_bpk_unp() */
+
+static void
+ccr_bpk_fwd_scl /* [fnc] Pack groups of values */
+(const size_t grp_nbr, /* I [nbr] Number of groups of CCR_BPK_GRP_NBR values */
+ const size_t datum_size, /* I [B] Bytes per value, 4 or 8 */
+ const int drp_nbr, /* I [nbr] Number of trailing bits dropped from each value */
+ const unsigned char *src, /* I [val] Values */
+ unsigned char *dst) /* O [val] Bit streams */
+{
+  const size_t lan_nbr=CCR_BPK_GRP_BYT/datum_size; /* [nbr] Lanes per group */
+  const size_t grp_sz=CCR_BPK_GRP_BYT*(8*datum_size-drp_nbr); /* [B] Bytes per packed group */
+  size_t grp_idx;
+  size_t lan_idx;
+
+  for(grp_idx=0;grp_idx<grp_nbr;grp_idx++)
+    for(lan_idx=0;lan_idx<lan_nbr;lan_idx++)
+      ccr_bpk_pck(8*datum_size,lan_nbr,datum_size,drp_nbr,src+(grp_idx*CCR_BPK_GRP_NBR+lan_idx)*datum_size,dst+grp_idx*grp_sz+lan_idx*datum_size);
+} /* !ccr_bpk_fwd_scl() */
+
+static void
+ccr_bpk_rev_scl /* [fnc] Unpack groups of values */
+(const size_t grp_nbr, /* I [nbr] Number of groups of CCR_BPK_GRP_NBR values */
+ const size_t datum_size, /* I [B] Bytes per value, 4 or 8 */
+ const int drp_nbr, /* I [nbr] Number of trailing bits dropped from each value */
+ const unsigned char *src, /* I [val] Bit streams */
+ unsigned char *dst) /* O [val] Values */
+{
+  const size_t lan_nbr=CCR_BPK_GRP_BYT/datum_size; /* [nbr] Lanes per group */
+  const size_t grp_sz=CCR_BPK_GRP_BYT*(8*datum_size-drp_nbr); /* [B] Bytes per packed group */
+  size_t grp_idx;
+  size_t lan_idx;
+
+  for(grp_idx=0;grp_idx<grp_nbr;grp_idx++)
+    for(lan_idx=0;lan_idx<lan_nbr;lan_idx++)
+      ccr_bpk_unp(8*datum_size,lan_nbr,datum_size,drp_nbr,src+grp_idx*grp_sz+lan_idx*datum_size,dst+(grp_idx*CCR_BPK_GRP_NBR+lan_idx)*datum_size);
+} /* !ccr_bpk_rev_scl() */
+
+#ifdef CCR_SIMD_X86
+/* Vector kernels hold one word of every lane in 256 bits (two SSE2 registers, or one AVX2 register), and load the next value of every lane at once
+   Every lane retains the same number of bits, so one shift count, kept in a register, serves all lanes, and the word-full test is the same for all lanes */
+
+__attribute__((target("sse2")))
+static void
+ccr_bpk_fwd_sse2 /* [fnc] Pack groups of values with SSE2 */
+(const size_t grp_nbr, /* I [nbr] Number of groups of CCR_BPK_GRP_NBR values */
+ const size_t datum_size, /* I [B] Bytes per value, 4 or 8 */
+ const int drp_nbr, /* I [nbr] Number of trailing bits dropped from each value */
+ const unsigned char *src, /* I [val] Values */
+ unsigned char *dst) /* O [val] Bit streams */
+{
+  const int wrd_bit_nbr=(int)(8*datum_size); /* [nbr] Bits per value and per word */
+  const int bit_nbr=wrd_bit_nbr-drp_nbr; /* [nbr] Bits retained per value */
+  const __m128i drp_cnt=_mm_cvtsi32_si128(drp_nbr); /* [nbr] Shift count that drops trailing bits */
+  __m128i acc_lo,acc_hi; /* [val] Current words of lanes */
+  __m128i lo,hi; /* [val] Next value of lanes */
+  size_t grp_idx;
+  size_t idx;
+  int fll; /* [nbr] Bits in current words */
+
+  for(grp_idx=0;grp_idx<grp_nbr;grp_idx++){
+    const unsigned char *val=src+grp_idx*CCR_BPK_GRP_NBR*datum_size; /* [ptr] Values of group */
+    unsigned char *wrd=dst+grp_idx*CCR_BPK_GRP_BYT*bit_nbr; /* [ptr] Next words to store */
+    acc_lo=acc_hi=_mm_setzero_si128();
+    fll=0;
+    for(idx=0;idx<(size_t)wrd_bit_nbr;idx++){
+      const __m128i fll_cnt=_mm_cvtsi32_si128(fll); /* [nbr] Shift count past bits in current words */
+      lo=_mm_loadu_si128((const __m128i *)(val+CCR_BPK_GRP_BYT*idx));
+      hi=_mm_loadu_si128((const __m128i *)(val+CCR_BPK_GRP_BYT*idx+16));
+      if(datum_size == 4){
+	lo=_mm_srl_epi32(lo,drp_cnt);
+	hi=_mm_srl_epi32(hi,drp_cnt);
+	acc_lo=_mm_or_si128(acc_lo,_mm_sll_epi32(lo,fll_cnt));
+	acc_hi=_mm_or_si128(acc_hi,_mm_sll_epi32(hi,fll_cnt));
+      }else{
+	lo=_mm_srl_epi64(lo,drp_cnt);
+	hi=_mm_srl_epi64(hi,drp_cnt);
+	acc_lo=_mm_or_si128(acc_lo,_mm_sll_epi64(lo,fll_cnt));
+	acc_hi=_mm_or_si128(acc_hi,_mm_sll_epi64(hi,fll_cnt));
+      } /* !datum_size */
+      fll+=bit_nbr;
+      if(fll >= wrd_bit_nbr){
+	_mm_storeu_si128((__m128i *)wrd,acc_lo);
+	_mm_storeu_si128((__m128i *)(wrd+16),acc_hi);
+	wrd+=CCR_BPK_GRP_BYT;
+	fll-=wrd_bit_nbr;
+	/* Shifts by the full word width give zero, so no bits carry when the value filled the words exactly */
+	if(datum_size == 4){
+	  acc_lo=_mm_srl_epi32(lo,_mm_cvtsi32_si128(fll ? bit_nbr-fll : 32));
+	  acc_hi=_mm_srl_epi32(hi,_mm_cvtsi32_si128(fll ? bit_nbr-fll : 32));
+	}else{
+	  acc_lo=_mm_srl_epi64(lo,_mm_cvtsi32_si128(fll ? bit_nbr-fll : 64));
+	  acc_hi=_mm_srl_epi64(hi,_mm_cvtsi32_si128(fll ? bit_nbr-fll : 64));
+	} /* !datum_size */
+      } /* !fll */
+    } /* !idx */
+  } /* !grp_idx */
+} /* !ccr_bpk_fwd_sse2() */
+
+__attribute__((target("sse2")))
+static void
+ccr_bpk_rev_sse2 /* [fnc] Unpack groups of values with SSE2 */
+(const size_t grp_nbr, /* I [nbr] Number of groups of CCR_BPK_GRP_NBR values */
+ const size_t datum_size, /* I [B] Bytes per value, 4 or 8 */
+ const int drp_nbr, /* I [nbr] Number of trailing bits dropped from each value */
+ const unsigned char *src, /* I [val] Bit streams */
+ unsigned char *dst) /* O [val] Values */
+{
+  const int wrd_bit_nbr=(int)(8*datum_size); /* [nbr] Bits per value and per word */
+  const int bit_nbr=wrd_bit_nbr-drp_nbr; /* [nbr] Bits retained per value */
+  const __m128i drp_cnt=_mm_cvtsi32_si128(drp_nbr); /* [nbr] Shift count that restores trailing bits */
+  /* Shift all-ones right by dropped bits to get retained bits */
+  const __m128i msk=datum_size == 4 ? _mm_srl_epi32(_mm_set1_epi32(-1),drp_cnt) : _mm_srl_epi64(_mm_set1_epi32(-1),drp_cnt); /* [msk] Retained bits */
+  __m128i cur_lo,cur_hi; /* [val] Current words of lanes */
+  __m128i lo,hi; /* [val] Next value of lanes */
+  size_t grp_idx;
+  size_t idx;
+  size_t wrd_idx; /* [idx] Current word of lanes */
+  int pos; /* [nbr] Bits of current words already unpacked */
+
+  for(grp_idx=0;grp_idx<grp_nbr;grp_idx++){
+    const unsigned char *wrd=src+grp_idx*CCR_BPK_GRP_BYT*bit_nbr; /* [ptr] Words of group */
+    unsigned char *val=dst+grp_idx*CCR_BPK_GRP_NBR*datum_size; /* [ptr] Values of group */
+    cur_lo=_mm_loadu_si128((const __m128i *)wrd);
+    cur_hi=_mm_loadu_si128((const __m128i *)(wrd+16));
+    wrd_idx=0;
+    pos=0;
+    for(idx=0;idx<(size_t)wrd_bit_nbr;idx++){
+      const __m128i pos_cnt=_mm_cvtsi32_si128(pos); /* [nbr] Shift count past bits already unpacked */
+      if(datum_size == 4){
+	lo=_mm_srl_epi32(cur_lo,pos_cnt);
+	hi=_mm_srl_epi32(cur_hi,pos_cnt);
+      }else{
+	lo=_mm_srl_epi64(cur_lo,pos_cnt);
+	hi=_mm_srl_epi64(cur_hi,pos_cnt);
+      } /* !datum_size */
+      pos+=bit_nbr;
+      if(pos >= wrd_bit_nbr){
+	pos-=wrd_bit_nbr;
+	if(++wrd_idx < (size_t)bit_nbr){
+	  cur_lo=_mm_loadu_si128((const __m128i *)(wrd+CCR_BPK_GRP_BYT*wrd_idx));
+	  cur_hi=_mm_loadu_si128((const __m128i *)(wrd+CCR_BPK_GRP_BYT*wrd_idx+16));
+	} /* !wrd_idx */
+	if(pos){
+	  const __m128i spl_cnt=_mm_cvtsi32_si128(bit_nbr-pos); /* [nbr] Shift count of bits from next words */
+	  if(datum_size == 4){
+	    lo=_mm_or_si128(lo,_mm_sll_epi32(cur_lo,spl_cnt));
+	    hi=_mm_or_si128(hi,_mm_sll_epi32(cur_hi,spl_cnt));
+	  }else{
+	    lo=_mm_or_si128(lo,_mm_sll_epi64(cur_lo,spl_cnt));
+	    hi=_mm_or_si128(hi,_mm_sll_epi64(cur_hi,spl_cnt));
+	  } /* !datum_size */
+	} /* !pos */
+      } /* !pos */
+      lo=_mm_and_si128(lo,msk);
+      hi=_mm_and_si128(hi,msk);
+      if(datum_size == 4){
+	lo=_mm_sll_epi32(lo,drp_cnt);
+	hi=_mm_sll_epi32(hi,drp_cnt);
+      }else{
+	lo=_mm_sll_epi64(lo,drp_cnt);
+	hi=_mm_sll_epi64(hi,drp_cnt);
+      } /* !datum_size */
+      _mm_storeu_si128((__m128i *)(val+CCR_BPK_GRP_BYT*idx),lo);
+      _mm_storeu_si128((__m128i *)(val+CCR_BPK_GRP_BYT*idx+16),hi);
+    } /* !idx */
+  } /* !grp_idx */
+} /* !ccr_bpk_rev_sse2() */
+
+__attribute__((target("avx2")))
+static void
+ccr_bpk_fwd_avx2 /* [fnc] Pack groups of values with AVX2 */
+(const size_t grp_nbr, /* I [nbr] Number of groups of CCR_BPK_GRP_NBR values */
+ const size_t datum_size, /* I [B] Bytes per value, 4 or 8 */
+ const int drp_nbr, /* I [nbr] Number of trailing bits dropped from each value */
+ const unsigned char *src, /* I [val] Values */
+ unsigned char *dst) /* O [val] Bit streams */
+{
+  const int wrd_bit_nbr=(int)(8*datum_size); /* [nbr] Bits per value and per word */
+  const int bit_nbr=wrd_bit_nbr-drp_nbr; /* [nbr] Bits retained per value */
+  const __m128i drp_cnt=_mm_cvtsi32_si128(drp_nbr); /* [nbr] Shift count that drops trailing bits */
+  __m256i acc; /* [val] Current words of lanes */
+  __m256i v; /* [val] Next value of lanes */
+  size_t grp_idx;
+  size_t idx;
+  int fll; /* [nbr] Bits in current words */
+
+  for(grp_idx=0;grp_idx<grp_nbr;grp_idx++){
+    const unsigned char *val=src+grp_idx*CCR_BPK_GRP_NBR*datum_size; /* [ptr] Values of group */
+    unsigned char *wrd=dst+grp_idx*CCR_BPK_GRP_BYT*bit_nbr; /* [ptr] Next words to store */
+    acc=_mm256_setzero_si256();
+    fll=0;
+    if(datum_size == 4){
+      for(idx=0;idx<32;idx++){
+	v=_mm256_srl_epi32(_mm256_loadu_si256((const __m256i *)(val+CCR_BPK_GRP_BYT*idx)),drp_cnt);
+	acc=_mm256_or_si256(acc,_mm256_sll_epi32(v,_mm_cvtsi32_si128(fll)));
+	fll+=bit_nbr;
+	if(fll >= 32){
+	  _mm256_storeu_si256((__m256i *)wrd,acc);
+	  wrd+=CCR_BPK_GRP_BYT;
+	  fll-=32;
+	  acc=_mm256_srl_epi32(v,_mm_cvtsi32_si128(fll ? bit_nbr-fll : 32));
+	} /* !fll */
+      } /* !idx */
+    }else{
+      for(idx=0;idx<64;idx++){
+	v=_mm256_srl_epi64(_mm256_loadu_si256((const __m256i *)(val+CCR_BPK_GRP_BYT*idx)),drp_cnt);
+	acc=_mm256_or_si256(acc,_mm256_sll_epi64(v,_mm_cvtsi32_si128(fll)));
+	fll+=bit_nbr;
+	if(fll >= 64){
+	  _mm256_storeu_si256((__m256i *)wrd,acc);
+	  wrd+=CCR_BPK_GRP_BYT;
+	  fll-=64;
+	  acc=_mm256_srl_epi64(v,_mm_cvtsi32_si128(fll ? bit_nbr-fll : 64));
+	} /* !fll */
+      } /* !idx */
+    } /* !datum_size */
+  } /* !grp_idx */
+} /* !ccr_bpk_fwd_avx2() */
+
+__attribute__((target("avx2")))
+static void
+ccr_bpk_rev_avx2 /* [fnc] Unpack groups of values with AVX2 */
+(const size_t grp_nbr, /* I [nbr] Number of groups of CCR_BPK_GRP_NBR values */
+ const size_t datum_size, /* I [B] Bytes per value, 4 or 8 */
+ const int drp_nbr, /* I [nbr] Number of trailing bits dropped from each value */
+ const unsigned char *src, /* I [val] Bit streams */
+ unsigned char *dst) /* O [val] Values */
+{
+  const int wrd_bit_nbr=(int)(8*datum_size); /* [nbr] Bits per value and per word */
+  const int bit_nbr=wrd_bit_nbr-drp_nbr; /* [nbr] Bits retained per value */
+  const __m128i drp_cnt=_mm_cvtsi32_si128(drp_nbr); /* [nbr] Shift count that restores trailing bits */
+  const __m256i msk=datum_size == 4 ? _mm256_srl_epi32(_mm256_set1_epi32(-1),drp_cnt) : _mm256_srl_epi64(_mm256_set1_epi32(-1),drp_cnt); /* [msk] Retained bits */
+  __m256i cur; /* [val] Current words of lanes */
+  __m256i v; /* [val] Next value of lanes */
+  size_t grp_idx;
+  size_t idx;
+  size_t wrd_idx; /* [idx] Current word of lanes */
+  int pos; /* [nbr] Bits of current words already unpacked */
+
+  for(grp_idx=0;grp_idx<grp_nbr;grp_idx++){
+    const unsigned char *wrd=src+grp_idx*CCR_BPK_GRP_BYT*bit_nbr; /* [ptr] Words of group */
+    unsigned char *val=dst+grp_idx*CCR_BPK_GRP_NBR*datum_size; /* [ptr] Values of group */
+    cur=_mm256_loadu_si256((const __m256i *)wrd);
+    wrd_idx=0;
+    pos=0;
+    if(datum_size == 4){
+      for(idx=0;idx<32;idx++){
+	v=_mm256_srl_epi32(cur,_mm_cvtsi32_si128(pos));
+	pos+=bit_nbr;
+	if(pos >= 32){
+	  pos-=32;
+	  if(++wrd_idx < (size_t)bit_nbr) cur=_mm256_loadu_si256((const __m256i *)(wrd+CCR_BPK_GRP_BYT*wrd_idx));
+	  if(pos) v=_mm256_or_si256(v,_mm256_sll_epi32(cur,_mm_cvtsi32_si128(bit_nbr-pos)));
+	} /* !pos */
+	_mm256_storeu_si256((__m256i *)(val+CCR_BPK_GRP_BYT*idx),_mm256_sll_epi32(_mm256_and_si256(v,msk),drp_cnt));
+      } /* !idx */
+    }else{
+      for(idx=0;idx<64;idx++){
+	v=_mm256_srl_epi64(cur,_mm_cvtsi32_si128(pos));
+	pos+=bit_nbr;
+	if(pos >= 64){
+	  pos-=64;
+	  if(++wrd_idx < (size_t)bit_nbr) cur=_mm256_loadu_si256((const __m256i *)(wrd+CCR_BPK_GRP_BYT*wrd_idx));
+	  if(pos) v=_mm256_or_si256(v,_mm256_sll_epi64(cur,_mm_cvtsi32_si128(bit_nbr-pos)));
+	} /* !pos */
+	_mm256_storeu_si256((__m256i *)(val+CCR_BPK_GRP_BYT*idx),_mm256_sll_epi64(_mm256_and_si256(v,msk),drp_cnt));
+      } /* !idx */
+    } /* !datum_size */
+  } /* !grp_idx */
+} /* !ccr_bpk_rev_avx2() */
+#endif /* !CCR_SIMD_X86 */
+
+void
+ccr_bpk_cpu_dispatch /* [fnc] Select fastest bit packing kernels supported by this CPU */
+(void)
+{
+  /* Purpose: Query CPUID (through compiler builtins that also check OS register-state support) and point kernels at widest supported instruction set
+     Streams are interleaved for 256-bit vectors, so AVX-512 offers no wider lanes, and AVX2 is the widest kernel
+     Results are identical for all kernels, only speed differs */
+  ccr_bpk_fwd_knl=ccr_bpk_fwd_scl;
+  ccr_bpk_rev_knl=ccr_bpk_rev_scl;
+  ccr_bpk_knl_nm="scalar";
+#ifdef CCR_SIMD_X86
+  __builtin_cpu_init();
+  if(__builtin_cpu_supports("avx2")){
+    ccr_bpk_fwd_knl=ccr_bpk_fwd_avx2;
+    ccr_bpk_rev_knl=ccr_bpk_rev_avx2;
+    ccr_bpk_knl_nm="AVX2";
+  }else if(__builtin_cpu_supports("sse2")){
+    ccr_bpk_fwd_knl=ccr_bpk_fwd_sse2;
+    ccr_bpk_rev_knl=ccr_bpk_rev_sse2;
+    ccr_bpk_knl_nm="SSE2";
+  } /* !__builtin_cpu_supports() */
+#endif /* !CCR_SIMD_X86 */
+  if(CCR_FLT_DBG_INFO) (void)fprintf(stderr,"INFO: \"%s\" filter selected %s kernels\n",CCR_FLT_NAME,ccr_bpk_knl_nm);
+} /* !ccr_bpk_cpu_dispatch() */
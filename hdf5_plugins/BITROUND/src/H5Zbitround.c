@@ -62,15 +62,18 @@
 #include "H5PLextern.h" /* HDF5 Plugin Library: H5PLget_plugin_type(), H5PLget_plugin_info() */
 
 /* Tokens and typedefs */
-#define H5Z_FILTER_BITROUND 32022 /* NB: ID assigned by HDF Group 20201223 */
+#define H5Z_FILTER_BITROUND 32768 /* NB: Not yet registered with HDF, see ccr.h */
 #define CCR_FLT_DBG_INFO 0 /* [flg] Print non-fatal debugging information */
-#define CCR_FLT_NAME "BitRound filter (Zender, 2016 GMD: http://www.geosci-model-dev.net/9/3199/2016)" /* [sng] Filter name in vernacular for HDF5 messages */
+#define CCR_FLT_NAME "BitRound filter (Klower et al., 2021 NCS: https://doi.org/10.1038/s43588-021-00156-2)" /* [sng] Filter name in vernacular for HDF5 messages */
 #define CCR_FLT_NSB_DFL 10 /* [nbr] Default number of significant bits for quantization */
+#define CCR_FLT_NSB_AUTO 0 /* [nbr] NSB that requests keepbits be chosen from information content of each chunk */
 #define CCR_FLT_PRM_NBR 5 /* [nbr] Number of parameters sent to filter (in cd_params array). NB: keep identical with ccr.h:BITROUND_FLT_PRM_NBR */
+#define CCR_FLT_PRM_NBR_AUTO 6 /* [nbr] Number of parameters with automatic NSB, which alone stores the information level. NB: keep identical with ccr.h:BITROUND_AUTO_FLT_PRM_NBR */
 #define CCR_FLT_PRM_PSN_NSB 0 /* [nbr] Ordinal position of NSB in parameter list (cd_params array) */
 #define CCR_FLT_PRM_PSN_DATUM_SIZE 1 /* [nbr] Ordinal position of datum_size in parameter list (cd_params array) */
 #define CCR_FLT_PRM_PSN_HAS_MSS_VAL 2 /* [nbr] Ordinal position of missing value flag in parameter list (cd_params array) */
-#define CCR_FLT_PRM_PSN_MSS_VAL 3 /* [nbr] Ordinal position of missing value in parameter list (cd_params array) NB: Missing value (_FillValue) uses two cd_params slots so it can be single or double-precision. Single-precision values are read as first 4-bytes starting at cd_params[4] (and cd_params[5] is ignored), while double-precision values are read as first 8-bytes starting at cd_params[4] and ending with cd_params[5]. */
+#define CCR_FLT_PRM_PSN_MSS_VAL 3 /* [nbr] Ordinal position of missing value in parameter list (cd_params array) NB: Missing value (_FillValue) uses two cd_params slots so it can be single or double-precision. Single-precision values are read as first 4-bytes starting at cd_params[3] (and cd_params[4] is ignored), while double-precision values are read as first 8-bytes starting at cd_params[3] and ending with cd_params[4]. */
+#define CCR_FLT_PRM_PSN_INF_LVL 5 /* [nbr] Ordinal position of information level (ppm) used when NSB is automatic in parameter list (cd_params array) */
 
 /* Compatibility tokens and typedefs retain source-code compatibility between NCO and filter
    These tokens mimic netCDF/NCO code but do not rely on or interfere with either */
@@ -87,12 +90,6 @@
 # define NC_FILL_DOUBLE  (9.9692099683868690e+36)
 #endif /* !NC_FILL_DOUBLE */
 
-/* Minimum number of explicit significand bits to preserve when zeroing/bit-masking floating point values
-   Codes will preserve at least two explicit bits, IEEE significand representation contains one implicit bit
-   Thus preserve a least three bits which is approximately one sigificant decimal digit
-   Used in nco_ppc_bitmask() and nco_ppc_bitmask_scl() */
-#define NCO_PPC_BIT_XPL_NBR_MIN 2
-
 /* Pointer union for floating point and bitmask types */
 typedef union{ /* ptr_unn */
   float *fp;
@@ -148,6 +145,15 @@ ccr_btr /* [fnc] BitRound buffer of float values */
  ptr_unn mss_val, /* I [val] Value of missing value */
  ptr_unn op1); /* I/O [frc] Values to quantize */
 
+int /* O [nbr] Number of significant bits that retain requested information, or 0 to leave data unquantized */
+ccr_btr_nsb_get /* [fnc] Choose keepbits from bitwise real information content */
+(const int type, /* I [enm] netCDF type of operand */
+ const size_t sz, /* I [nbr] Size (in elements) of buffer to analyze */
+ const int has_mss_val, /* I [flg] Flag for missing values */
+ ptr_unn mss_val, /* I [val] Value of missing value */
+ unsigned int inf_lvl, /* I [ppm] Fraction of real information to retain */
+ ptr_unn op1); /* I [frc] Values to analyze */
+
 /* Function definitions */
 H5PL_type_t /* O [enm] Plugin type */
 H5PLget_plugin_type /* [fnc] Provide plug-in type provided by this shared library */
@@ -189,6 +195,8 @@ H5Z_filter_bitround /* [fnc] HDF5 BitRound Filter */
 
     /* Set parameters needed by quantization library filter */
     int nsb=cd_values[CCR_FLT_PRM_PSN_NSB];
+    /* Files written before information level was a parameter have one fewer element */
+    unsigned int inf_lvl=cd_nelmts > CCR_FLT_PRM_PSN_INF_LVL ? cd_values[CCR_FLT_PRM_PSN_INF_LVL] : 0U; /* [ppm] Information level */
     size_t datum_size=cd_values[CCR_FLT_PRM_PSN_DATUM_SIZE];
     int has_mss_val=cd_values[CCR_FLT_PRM_PSN_HAS_MSS_VAL]; /* [flg] Flag for missing values */
     ptr_unn mss_val; /* [val] Value of missing value */
@@ -210,7 +218,10 @@ H5Z_filter_bitround /* [fnc] HDF5 BitRound Filter */
 	if(CCR_FLT_DBG_INFO) (void)fprintf(stderr,"INFO: \"%s\" filter function %s reports missing value = %g\n",CCR_FLT_NAME,fnc_nm,*mss_val.fp);
       } /* !has_mss_val */
       op1.fp=(float *)(*bfr_inout);
-      ccr_btr(nsb,NC_FLOAT,bfr_sz_in/sizeof(float),has_mss_val,mss_val,op1);
+      if(nsb == CCR_FLT_NSB_AUTO) nsb=ccr_btr_nsb_get(NC_FLOAT,bfr_sz_in/sizeof(float),has_mss_val,mss_val,inf_lvl,op1);
+      if(CCR_FLT_DBG_INFO) (void)fprintf(stderr,"INFO: \"%s\" filter function %s reports NSB = %d\n",CCR_FLT_NAME,fnc_nm,nsb);
+      /* Data without real information (e.g., constant chunks) stay unquantized */
+      if(nsb > 0) ccr_btr(nsb,NC_FLOAT,bfr_sz_in/sizeof(float),has_mss_val,mss_val,op1);
       break;
     case 8:
       /* Double-precision floating-point data */
@@ -219,7 +230,9 @@ H5Z_filter_bitround /* [fnc] HDF5 BitRound Filter */
 	if(CCR_FLT_DBG_INFO) (void)fprintf(stderr,"INFO: \"%s\" filter function %s reports missing value = %g\n",CCR_FLT_NAME,fnc_nm,*mss_val.dp);
       } /* !has_mss_val */
       op1.dp=(double *)(*bfr_inout);
-      ccr_btr(nsb,NC_DOUBLE,bfr_sz_in/sizeof(double),has_mss_val,mss_val,op1);
+      if(nsb == CCR_FLT_NSB_AUTO) nsb=ccr_btr_nsb_get(NC_DOUBLE,bfr_sz_in/sizeof(double),has_mss_val,mss_val,inf_lvl,op1);
+      if(CCR_FLT_DBG_INFO) (void)fprintf(stderr,"INFO: \"%s\" filter function %s reports NSB = %d\n",CCR_FLT_NAME,fnc_nm,nsb);
+      if(nsb > 0) ccr_btr(nsb,NC_DOUBLE,bfr_sz_in/sizeof(double),has_mss_val,mss_val,op1);
       break;
     default:
       (void)fprintf(stderr,"ERROR: \"%s\" filter function %s reports datum size = %lu B is invalid\n",CCR_FLT_NAME,fnc_nm,datum_size);
@@ -266,11 +279,11 @@ ccr_set_local_bitround /* [fnc] Callback to determine and set per-variable filte
   herr_t rcd; /* [flg] Return code */
   
   /* Initialize filter parameters with default values */
-  unsigned int ccr_flt_prm[CCR_FLT_PRM_NBR]={CCR_FLT_NSB_DFL,0,0,0,0};
+  unsigned int ccr_flt_prm[CCR_FLT_PRM_NBR_AUTO]={CCR_FLT_NSB_DFL,0,0,0,0,0};
 
   /* Initialize output variables for call to H5Pget_filter_by_id() */
   unsigned int flags=0;
-  size_t cd_nelmts=CCR_FLT_PRM_NBR;
+  size_t cd_nelmts=CCR_FLT_PRM_NBR_AUTO;
   unsigned int *cd_values=ccr_flt_prm;
 
   /* Retrieve parameters specified by user
@@ -369,8 +382,9 @@ ccr_set_local_bitround /* [fnc] Callback to determine and set per-variable filte
   /* Set missing value flag in filter parameter list */
   ccr_flt_prm[CCR_FLT_PRM_PSN_HAS_MSS_VAL]=has_mss_val;
 
-  /* Update invoked filter with generic parameters as invoked with variable-specific values */
-  rcd=H5Pmodify_filter(dcpl,H5Z_FILTER_BITROUND,flags,CCR_FLT_PRM_NBR,cd_values);
+  /* Update invoked filter with generic parameters as invoked with variable-specific values
+     Fixed NSB keeps the five parameters that readers before automatic NSB accept */
+  rcd=H5Pmodify_filter(dcpl,H5Z_FILTER_BITROUND,flags,cd_values[CCR_FLT_PRM_PSN_NSB] == CCR_FLT_NSB_AUTO ? CCR_FLT_PRM_NBR_AUTO : CCR_FLT_PRM_NBR,cd_values);
   if(rcd < 0){
     (void)fprintf(stderr,"ERROR: \"%s\" filter callback function %s reports H5Pmodify_filter() unable to modify filter parameters\n",CCR_FLT_NAME,fnc_nm);
     return 0;
@@ -378,100 +392,3 @@ ccr_set_local_bitround /* [fnc] Callback to determine and set per-variable filte
 
   return 1;
 } /* !ccr_set_local_bitround() */
-
-void
-ccr_btr /* [fnc] BitRound buffer of float values */
-(const int nsb, /* I [nbr] Number of significant bits, i.e., "keepbits" */
- const int type, /* I [enm] netCDF type of operand */
- const size_t sz, /* I [nbr] Size (in elements) of buffer to quantize */
- const int has_mss_val, /* I [flg] Flag for missing values */
- ptr_unn mss_val, /* I [val] Value of missing value */
- ptr_unn op1) /* I/O [frc] Values to quantize */
-{
-  const char fnc_nm[]="ccr_btr()"; /* [sng] Function name */
-
-  const int bit_xpl_nbr_sgn_flt=23; /* [nbr] Bits 0-22 of SP significands are explicit. Bit 23 is implicitly 1. */
-  const int bit_xpl_nbr_sgn_dbl=52; /* [nbr] Bits 0-51 of DP significands are explicit. Bit 52 is implicitly 1. */
-  
-  double mss_val_cmp_dbl; /* Missing value for comparison to double precision values */
-
-  float mss_val_cmp_flt; /* Missing value for comparison to single precision values */
-  
-  int bit_xpl_nbr_sgn=-1; /* [nbr] Number of explicit bits in significand */
-  int bit_xpl_nbr_zro; /* [nbr] Number of explicit bits to zero */
-
-  size_t idx;
-
-  unsigned int *u32_ptr;
-  unsigned int msk_f32_u32_zro;
-  unsigned int msk_f32_u32_one;
-  //unsigned int msk_f32_u32_hshv;
-  unsigned long long int *u64_ptr;
-  unsigned long long int msk_f64_u64_zro;
-  unsigned long long int msk_f64_u64_one;
-  //unsigned long long int msk_f64_u64_hshv;
-  unsigned short prc_bnr_ceil; /* [nbr] Exact binary digits of precision rounded-up */
-  unsigned short prc_bnr_xpl_rqr; /* [nbr] Explicitly represented binary digits required to retain */
-
-  /* Disallow unreasonable quantization */
-  assert(nsb > 0);
-  assert(nsb <= 52);
-
-  /* How many bits to preserve? */
-  prc_bnr_xpl_rqr=nsb;
-
-  if(type == NC_FLOAT  && prc_bnr_xpl_rqr >= bit_xpl_nbr_sgn_flt) return;
-  if(type == NC_DOUBLE && prc_bnr_xpl_rqr >= bit_xpl_nbr_sgn_dbl) return;
-
-  switch(type){
-  case NC_FLOAT:
-    /* Missing value for comparison is _FillValue (if any) otherwise default NC_FILL_FLOAT/DOUBLE */
-    if(has_mss_val) mss_val_cmp_flt=*mss_val.fp; else mss_val_cmp_flt=NC_FILL_FLOAT;
-    bit_xpl_nbr_sgn=bit_xpl_nbr_sgn_flt;
-    bit_xpl_nbr_zro=bit_xpl_nbr_sgn-prc_bnr_xpl_rqr;
-    u32_ptr=op1.ui32p;
-    /* Create mask */
-    msk_f32_u32_zro=0u; /* Zero all bits */
-    msk_f32_u32_zro=~msk_f32_u32_zro; /* Turn all bits to ones */
-    /* Bit Shave mask for AND: Left shift zeros into bits to be rounded, leave ones in untouched bits */
-    msk_f32_u32_zro <<= bit_xpl_nbr_zro;
-    /* Bit Set   mask for OR:  Put ones into bits to be set, zeros in untouched bits */
-    msk_f32_u32_one=~msk_f32_u32_zro;
-    //msk_f32_u32_hshv=msk_f32_u32_one & (msk_f32_u32_zro >> 1); /* Set one bit: the MSB of LSBs */
-
-    /* Bit-Round: alternately shave and set LSBs */
-    for(idx=0L;idx<sz;idx+=2L)
-      if(op1.fp[idx] != mss_val_cmp_flt) u32_ptr[idx]&=msk_f32_u32_zro;
-    for(idx=1L;idx<sz;idx+=2L)
-      if(op1.fp[idx] != mss_val_cmp_flt && u32_ptr[idx] != 0U) /* Never quantize upwards floating point values of zero */
-	u32_ptr[idx]|=msk_f32_u32_one;
-    break; /* !NC_FLOAT */
-  case NC_DOUBLE:
-    /* Missing value for comparison is _FillValue (if any) otherwise default NC_FILL_FLOAT/DOUBLE */
-    if(has_mss_val) mss_val_cmp_dbl=*mss_val.dp; else mss_val_cmp_dbl=NC_FILL_DOUBLE;
-    bit_xpl_nbr_sgn=bit_xpl_nbr_sgn_dbl;
-    bit_xpl_nbr_zro=bit_xpl_nbr_sgn-prc_bnr_xpl_rqr;
-    assert(bit_xpl_nbr_zro <= bit_xpl_nbr_sgn-NCO_PPC_BIT_XPL_NBR_MIN);
-    u64_ptr=(unsigned long long int *)op1.ui64p;
-    /* Create mask */
-    msk_f64_u64_zro=0ul; /* Zero all bits */
-    msk_f64_u64_zro=~msk_f64_u64_zro; /* Turn all bits to ones */
-    /* Bit Shave mask for AND: Left shift zeros into bits to be rounded, leave ones in untouched bits */
-    msk_f64_u64_zro <<= bit_xpl_nbr_zro;
-    /* Bit Set   mask for OR:  Put ones into bits to be set, zeros in untouched bits */
-    msk_f64_u64_one=~msk_f64_u64_zro;
-    //msk_f64_u64_hshv=msk_f64_u64_one & (msk_f64_u64_zro >> 1); /* Set one bit: the MSB of LSBs */
-    /* Bit-Round: alternately shave and set LSBs */
-    for(idx=0L;idx<sz;idx+=2L)
-      if(op1.dp[idx] != mss_val_cmp_dbl)
-	u64_ptr[idx]&=msk_f64_u64_zro;
-    for(idx=1L;idx<sz;idx+=2L)
-      if(op1.dp[idx] != mss_val_cmp_dbl && u64_ptr[idx] != 0ULL) /* Never quantize upwards floating point values of zero */
-	u64_ptr[idx]|=msk_f64_u64_one;
-    break; /* !NC_DOUBLE */
-  default: 
-    (void)fprintf(stderr,"ERROR: %s reports datum size = %d B is invalid for %s filter\n",fnc_nm,type,CCR_FLT_NAME);
-    break;
-  } /* !type */
-  
-} /* ccr_btr() */
@@ -0,0 +1,447 @@
+/* Copyright (C) 2026--present Charlie Zender */
+
+ /*
+ * BitRound quantization of buffers of single- and double-precision values.
+ * The HDF5 BitRound filter plugin (H5Zbitround.c) and ccr_quantize() in libccr
+ * both build this file, so it calls neither HDF5 nor netCDF.
+ */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h" /* Autotools tokens */
+#endif
+#include <stdio.h>
+#ifdef HAVE_SYS_TYPES_H
+# include <sys/types.h>
+#endif
+#ifdef HAVE_SYS_STAT_H
+# include <sys/stat.h>
+#endif
+#ifdef STDC_HEADERS
+# include <stdlib.h>
+# include <stddef.h>
+#else
+# ifdef HAVE_STDLIB_H
+#  include <stdlib.h>
+# endif
+#endif
+#ifdef HAVE_STRING_H
+# if !defined STDC_HEADERS && defined HAVE_MEMORY_H
+#  include <memory.h>
+# endif
+# include <string.h>
+#endif
+#ifdef HAVE_STRINGS_H
+# include <strings.h>
+#endif
+#ifdef HAVE_INTTYPES_H
+# include <inttypes.h>
+#endif
+#ifdef HAVE_STDINT_H
+# include <stdint.h>
+#endif
+#ifdef HAVE_UNISTD_H
+# include <unistd.h>
+#endif
+#include <assert.h>
+
+#if defined(_WIN32)
+#include <Winsock2.h>
+#endif
+
+/* Standard header files */
+#ifdef HAVE_FEATURES_H
+/* Needed to define __USE_BSD that recent GCC compilers use in math.h to define M_LN2... */
+# include <features.h> /* __USE_BSD */
+#endif
+#ifdef HAVE_MATH_H
+/* Needed for M_LN10, M_LN2 in ccr_btr() */
+# include <math.h> /* sin cos cos sin 3.14159 */
+#endif
+
+/* OpenMP lets large chunks be quantized in slices on a thread pool (opt-in, see ccr_thr_nbr_get()) */
+#ifdef _OPENMP
+# include <omp.h> /* omp_get_num_procs() */
+#endif /* !_OPENMP */
+
+/* Tokens and typedefs */
+#define CCR_FLT_DBG_INFO 0 /* [flg] Print non-fatal debugging information */
+#define CCR_FLT_NAME "BitRound filter (Klower et al., 2021 NCS: https://doi.org/10.1038/s43588-021-00156-2)" /* [sng] Filter name in vernacular for HDF5 messages */
+#define CCR_FLT_INF_LVL_DFL 990000U /* [ppm] Default fraction of real information to retain when NSB is automatic */
+#define CCR_FLT_INF_LVL_MAX 1000000U /* [ppm] Retain all real information */
+#define CCR_FLT_INF_CNF 2.5758293035489004 /* [frc] Normal quantile for 99% confidence that mutual information is not due to chance */
+#define CCR_FLT_INF_PAIR_MIN 1024 /* [nbr] Fewest adjacent pairs that estimate information reliably, smaller chunks stay unquantized */
+#define CCR_THR_NBR_ENV "CCR_THR_NBR" /* [sng] Environment variable that sets number of quantization threads (default 1) */
+#define CCR_SLC_SZ_BYT 262144 /* [B] Slice size for multithreaded quantization, small enough to stay in L2 cache */
+
+/* Compatibility tokens and typedefs retain source-code compatibility between NCO and filter
+   These tokens mimic netCDF/NCO code but do not rely on or interfere with either */
+#ifndef NC_FLOAT
+# define NC_FLOAT 5
+#endif /* !NC_FLOAT */
+#ifndef NC_DOUBLE
+# define NC_DOUBLE 6
+#endif /* !NC_DOUBLE */
+#ifndef NC_FILL_FLOAT
+# define NC_FILL_FLOAT   (9.9692099683868690e+36f) /* near 15 * 2^119 */
+#endif /* !NC_FILL_FLOAT */
+#ifndef NC_FILL_DOUBLE
+# define NC_FILL_DOUBLE  (9.9692099683868690e+36)
+#endif /* !NC_FILL_DOUBLE */
+
+/* Minimum number of explicit significand bits to preserve when zeroing/bit-masking floating point values
+   Codes will preserve at least two explicit bits, IEEE significand representation contains one implicit bit
+   Thus preserve a least three bits which is approximately one sigificant decimal digit
+   Used in nco_ppc_bitmask() and nco_ppc_bitmask_scl() */
+#define NCO_PPC_BIT_XPL_NBR_MIN 2
+
+/* Pointer union for floating point and bitmask types */
+typedef union{ /* ptr_unn */
+  float *fp;
+  double *dp;
+  unsigned int *ui32p;
+  unsigned long long *ui64p;
+  void *vp;
+} ptr_unn;
+
+void
+ccr_btr /* [fnc] BitRound buffer of float values */
+(const int nsb, /* I [nbr] Number of significant bits, i.e., "keepbits" */
+ const int type, /* I [enm] netCDF type of operand */
+ const size_t sz, /* I [nbr] Size (in elements) of buffer to quantize */
+ const int has_mss_val, /* I [flg] Flag for missing values */
+ ptr_unn mss_val, /* I [val] Value of missing value */
+ ptr_unn op1); /* I/O [frc] Values to quantize */
+
+int /* O [nbr] Number of significant bits that retain requested information, or 0 to leave data unquantized */
+ccr_btr_nsb_get /* [fnc] Choose keepbits from bitwise real information content */
+(const int type, /* I [enm] netCDF type of operand */
+ const size_t sz, /* I [nbr] Size (in elements) of buffer to analyze */
+ const int has_mss_val, /* I [flg] Flag for missing values */
+ ptr_unn mss_val, /* I [val] Value of missing value */
+ unsigned int inf_lvl, /* I [ppm] Fraction of real information to retain */
+ ptr_unn op1); /* I [frc] Values to analyze */
+
+static void
+ccr_btr_flt /* [fnc] BitRound single-precision values */
+(const size_t sz, /* I [nbr] Size (in elements) of buffer to quantize */
+ const float mss_val_cmp_flt, /* I [val] Missing value for comparison */
+ const unsigned int msk_f32_u32_zro, /* I [msk] Bit Shave mask for AND */
+ const unsigned int msk_f32_u32_hshv, /* I [msk] Half-Shave mask: MSB of LSBs */
+ ptr_unn op1); /* I/O [frc] Values to quantize */
+
+static void
+ccr_btr_dbl /* [fnc] BitRound double-precision values */
+(const size_t sz, /* I [nbr] Size (in elements) of buffer to quantize */
+ const double mss_val_cmp_dbl, /* I [val] Missing value for comparison */
+ const unsigned long long int msk_f64_u64_zro, /* I [msk] Bit Shave mask for AND */
+ const unsigned long long int msk_f64_u64_hshv, /* I [msk] Half-Shave mask: MSB of LSBs */
+ ptr_unn op1); /* I/O [frc] Values to quantize */
+
+/* Function definitions */
+static int /* O [nbr] Number of threads to quantize buffer with */
+ccr_thr_nbr_get /* [fnc] Number of threads requested for quantization */
+(const size_t bfr_sz) /* I [B] Size of buffer to quantize */
+{
+  /* Purpose: Read opt-in thread count from CCR_THR_NBR environment variable
+     Unset, empty, or 1 quantizes on calling thread, 0 uses one thread per processor
+     Buffers smaller than two slices always quantize on calling thread
+     Thread count describes the writer not the data, so it is an environment variable rather than a cd_values[] entry */
+#ifdef _OPENMP
+  const char *thr_sng; /* [sng] Value of CCR_THR_NBR */
+  char *sng_cnv_rcd=NULL; /* [sng] strtol() return code */
+  long slc_nbr; /* [nbr] Number of slices in buffer */
+  long thr_nbr; /* [nbr] Number of threads */
+
+  if(bfr_sz < 2*CCR_SLC_SZ_BYT) return 1;
+  thr_sng=getenv(CCR_THR_NBR_ENV);
+  if(!thr_sng || *thr_sng == '\0') return 1;
+  thr_nbr=strtol(thr_sng,&sng_cnv_rcd,10);
+  if(*sng_cnv_rcd != '\0' || thr_nbr < 0L){
+    (void)fprintf(stderr,"WARNING: \"%s\" filter ignores invalid %s = %s\n",CCR_FLT_NAME,CCR_THR_NBR_ENV,thr_sng);
+    return 1;
+  } /* !sng_cnv_rcd */
+  if(thr_nbr == 0L) thr_nbr=omp_get_num_procs();
+  /* Threads beyond one per slice would idle */
+  slc_nbr=(long)((bfr_sz+CCR_SLC_SZ_BYT-1)/CCR_SLC_SZ_BYT);
+  if(thr_nbr > slc_nbr) thr_nbr=slc_nbr;
+  return (int)thr_nbr;
+#else /* !_OPENMP */
+  (void)bfr_sz;
+  return 1;
+#endif /* !_OPENMP */
+} /* !ccr_thr_nbr_get() */
+
+void
+ccr_btr /* [fnc] BitRound buffer of float values */
+(const int nsb, /* I [nbr] Number of significant bits, i.e., "keepbits" */
+ const int type, /* I [enm] netCDF type of operand */
+ const size_t sz, /* I [nbr] Size (in elements) of buffer to quantize */
+ const int has_mss_val, /* I [flg] Flag for missing values */
+ ptr_unn mss_val, /* I [val] Value of missing value */
+ ptr_unn op1) /* I/O [frc] Values to quantize */
+{
+  const char fnc_nm[]="ccr_btr()"; /* [sng] Function name */
+
+  const int bit_xpl_nbr_sgn_flt=23; /* [nbr] Bits 0-22 of SP significands are explicit. Bit 23 is implicitly 1. */
+  const int bit_xpl_nbr_sgn_dbl=52; /* [nbr] Bits 0-51 of DP significands are explicit. Bit 52 is implicitly 1. */
+  
+  double mss_val_cmp_dbl; /* Missing value for comparison to double precision values */
+
+  float mss_val_cmp_flt; /* Missing value for comparison to single precision values */
+  
+  int bit_xpl_nbr_sgn=-1; /* [nbr] Number of explicit bits in significand */
+  int bit_xpl_nbr_zro; /* [nbr] Number of explicit bits to zero */
+
+  int thr_nbr; /* [nbr] Number of threads to quantize with */
+
+  long slc_idx; /* [idx] Slice index */
+  long slc_nbr; /* [nbr] Number of slices */
+  size_t slc_sz; /* [nbr] Slice size (in elements) */
+
+  unsigned int msk_f32_u32_zro;
+  unsigned int msk_f32_u32_one;
+  unsigned int msk_f32_u32_hshv;
+  unsigned long long int msk_f64_u64_zro;
+  unsigned long long int msk_f64_u64_one;
+  unsigned long long int msk_f64_u64_hshv;
+  unsigned short prc_bnr_xpl_rqr; /* [nbr] Explicitly represented binary digits required to retain */
+
+  /* Disallow unreasonable quantization */
+  assert(nsb > 0);
+  assert(nsb <= 52);
+
+  /* How many bits to preserve? */
+  prc_bnr_xpl_rqr=nsb;
+
+  if(type == NC_FLOAT  && prc_bnr_xpl_rqr >= bit_xpl_nbr_sgn_flt) return;
+  if(type == NC_DOUBLE && prc_bnr_xpl_rqr >= bit_xpl_nbr_sgn_dbl) return;
+
+  switch(type){
+  case NC_FLOAT:
+    /* Missing value for comparison is _FillValue (if any) otherwise default NC_FILL_FLOAT/DOUBLE */
+    if(has_mss_val) mss_val_cmp_flt=*mss_val.fp; else mss_val_cmp_flt=NC_FILL_FLOAT;
+    bit_xpl_nbr_sgn=bit_xpl_nbr_sgn_flt;
+    bit_xpl_nbr_zro=bit_xpl_nbr_sgn-prc_bnr_xpl_rqr;
+    /* Create mask */
+    msk_f32_u32_zro=0u; /* Zero all bits */
+    msk_f32_u32_zro=~msk_f32_u32_zro; /* Turn all bits to ones */
+    /* Bit Shave mask for AND: Left shift zeros into bits to be rounded, leave ones in untouched bits */
+    msk_f32_u32_zro <<= bit_xpl_nbr_zro;
+    /* Bit Set   mask for OR:  Put ones into bits to be set, zeros in untouched bits */
+    msk_f32_u32_one=~msk_f32_u32_zro;
+    /* Half-Shave mask for ADD: Set one bit: the MSB of LSBs */
+    msk_f32_u32_hshv=msk_f32_u32_one & (msk_f32_u32_zro >> 1);
+
+    /* Bit-Round: add half-ULP then shave LSBs */
+    thr_nbr=ccr_thr_nbr_get(sz*sizeof(float));
+    if(thr_nbr > 1){
+      slc_sz=CCR_SLC_SZ_BYT/sizeof(float);
+      slc_nbr=(long)((sz+slc_sz-1L)/slc_sz);
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic) num_threads(thr_nbr)
+#endif /* !_OPENMP */
+      for(slc_idx=0L;slc_idx<slc_nbr;slc_idx++){
+	ptr_unn op1_slc; /* [frc] Slice of values to quantize */
+	op1_slc.fp=op1.fp+slc_idx*slc_sz;
+	ccr_btr_flt(slc_idx < slc_nbr-1L ? slc_sz : sz-slc_idx*slc_sz,mss_val_cmp_flt,msk_f32_u32_zro,msk_f32_u32_hshv,op1_slc);
+      } /* !slc_idx */
+    }else{
+      ccr_btr_flt(sz,mss_val_cmp_flt,msk_f32_u32_zro,msk_f32_u32_hshv,op1);
+    } /* !thr_nbr */
+    break; /* !NC_FLOAT */
+  case NC_DOUBLE:
+    /* Missing value for comparison is _FillValue (if any) otherwise default NC_FILL_FLOAT/DOUBLE */
+    if(has_mss_val) mss_val_cmp_dbl=*mss_val.dp; else mss_val_cmp_dbl=NC_FILL_DOUBLE;
+    bit_xpl_nbr_sgn=bit_xpl_nbr_sgn_dbl;
+    bit_xpl_nbr_zro=bit_xpl_nbr_sgn-prc_bnr_xpl_rqr;
+    /* Create mask */
+    msk_f64_u64_zro=0ul; /* Zero all bits */
+    msk_f64_u64_zro=~msk_f64_u64_zro; /* Turn all bits to ones */
+    /* Bit Shave mask for AND: Left shift zeros into bits to be rounded, leave ones in untouched bits */
+    msk_f64_u64_zro <<= bit_xpl_nbr_zro;
+    /* Bit Set   mask for OR:  Put ones into bits to be set, zeros in untouched bits */
+    msk_f64_u64_one=~msk_f64_u64_zro;
+    /* Half-Shave mask for ADD: Set one bit: the MSB of LSBs */
+    msk_f64_u64_hshv=msk_f64_u64_one & (msk_f64_u64_zro >> 1);
+    /* Bit-Round: add half-ULP then shave LSBs */
+    thr_nbr=ccr_thr_nbr_get(sz*sizeof(double));
+    if(thr_nbr > 1){
+      slc_sz=CCR_SLC_SZ_BYT/sizeof(double);
+      slc_nbr=(long)((sz+slc_sz-1L)/slc_sz);
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic) num_threads(thr_nbr)
+#endif /* !_OPENMP */
+      for(slc_idx=0L;slc_idx<slc_nbr;slc_idx++){
+	ptr_unn op1_slc; /* [frc] Slice of values to quantize */
+	op1_slc.dp=op1.dp+slc_idx*slc_sz;
+	ccr_btr_dbl(slc_idx < slc_nbr-1L ? slc_sz : sz-slc_idx*slc_sz,mss_val_cmp_dbl,msk_f64_u64_zro,msk_f64_u64_hshv,op1_slc);
+      } /* !slc_idx */
+    }else{
+      ccr_btr_dbl(sz,mss_val_cmp_dbl,msk_f64_u64_zro,msk_f64_u64_hshv,op1);
+    } /* !thr_nbr */
+    break; /* !NC_DOUBLE */
+  default: 
+    (void)fprintf(stderr,"ERROR: %s reports datum size = %d B is invalid for %s filter\n",fnc_nm,type,CCR_FLT_NAME);
+    break;
+  } /* !type */
+  
+} /* ccr_btr() */
+
+int /* O [nbr] Number of significant bits that retain requested information, or 0 to leave data unquantized */
+ccr_btr_nsb_get /* [fnc] Choose keepbits from bitwise real information content */
+(const int type, /* I [enm] netCDF type of operand */
+ const size_t sz, /* I [nbr] Size (in elements) of buffer to analyze */
+ const int has_mss_val, /* I [flg] Flag for missing values */
+ ptr_unn mss_val, /* I [val] Value of missing value */
+ unsigned int inf_lvl, /* I [ppm] Fraction of real information to retain */
+ ptr_unn op1) /* I [frc] Values to analyze */
+{
+  /* Purpose: Find fewest explicit mantissa bits that retain inf_lvl of the real information in buffer
+     Real information of each bit position is the mutual information between that bit in adjacent
+     elements, with information indistinguishable from chance (99% confidence) set to zero
+     Klower, M., M. Razinger, J. J. Dominguez, P. D. Duben, and T. N. Palmer (2021), Compressing
+     atmospheric data into its real information content, Nat. Comput. Sci., 1, 713-724,
+     https://doi.org/10.1038/s43588-021-00156-2
+     Bits are ranked sign, exponent, then mantissa, so keepbits count mantissa bits down to the
+     last bit whose cumulative information reaches inf_lvl
+     Adjacent elements are adjacent in the chunk, i.e., along the fastest-varying dimension
+     Pairs that include a missing value are skipped
+     Varying data without real information (noise) keep one bit, as in Klower et al.
+     Constant data, and buffers too small to estimate information, are left unquantized */
+  const int bit_xpl_nbr_sgn=(type == NC_FLOAT) ? 23 : 52; /* [nbr] Explicit bits in significand */
+  const int bit_nbr=(type == NC_FLOAT) ? 32 : 64; /* [nbr] Bits per value */
+
+  double mss_val_cmp_dbl; /* Missing value for comparison to double precision values */
+  double inf[64]; /* [bit] Real information of each bit position */
+  double inf_ttl=0.0; /* [bit] Real information summed over bit positions */
+  double inf_cml=0.0; /* [bit] Cumulative real information from sign bit down */
+  double inf_frc; /* [frc] Fraction of real information to retain */
+  double inf_fre; /* [bit] Information indistinguishable from chance */
+  double pr_cnf; /* [frc] Largest probability of a set bit consistent with chance */
+
+  float mss_val_cmp_flt; /* Missing value for comparison to single precision values */
+
+  int bit_idx; /* [idx] Bit position */
+  int flg_vry=0; /* [flg] Some bit position varies */
+  int nsb; /* [nbr] Number of significant bits */
+
+  size_t cnt_a[64]={0}; /* [nbr] Pairs whose first element has bit set */
+  size_t cnt_b[64]={0}; /* [nbr] Pairs whose second element has bit set */
+  size_t cnt_ab[64]={0}; /* [nbr] Pairs whose elements both have bit set */
+  size_t idx;
+  size_t pair_nbr=0; /* [nbr] Number of pairs without missing values */
+
+  if(inf_lvl == 0U || inf_lvl > CCR_FLT_INF_LVL_MAX) inf_lvl=CCR_FLT_INF_LVL_DFL;
+  inf_frc=inf_lvl/(double)CCR_FLT_INF_LVL_MAX;
+
+  /* Count bit pairs */
+  if(type == NC_FLOAT){
+    const unsigned int *u32_ptr=op1.ui32p;
+    unsigned int val_a,val_b;
+    if(has_mss_val) mss_val_cmp_flt=*mss_val.fp; else mss_val_cmp_flt=NC_FILL_FLOAT;
+    for(idx=1L;idx<sz;idx++){
+      if(op1.fp[idx-1L] == mss_val_cmp_flt || op1.fp[idx] == mss_val_cmp_flt) continue;
+      val_a=u32_ptr[idx-1L];
+      val_b=u32_ptr[idx];
+      for(bit_idx=0;bit_idx<32;bit_idx++){
+	cnt_a[bit_idx]+=(val_a >> bit_idx) & 1U;
+	cnt_b[bit_idx]+=(val_b >> bit_idx) & 1U;
+	cnt_ab[bit_idx]+=((val_a & val_b) >> bit_idx) & 1U;
+      } /* !bit_idx */
+      pair_nbr++;
+    } /* !idx */
+  }else{
+    const unsigned long long int *u64_ptr=op1.ui64p;
+    unsigned long long int val_a,val_b;
+    if(has_mss_val) mss_val_cmp_dbl=*mss_val.dp; else mss_val_cmp_dbl=NC_FILL_DOUBLE;
+    for(idx=1L;idx<sz;idx++){
+      if(op1.dp[idx-1L] == mss_val_cmp_dbl || op1.dp[idx] == mss_val_cmp_dbl) continue;
+      val_a=u64_ptr[idx-1L];
+      val_b=u64_ptr[idx];
+      for(bit_idx=0;bit_idx<64;bit_idx++){
+	cnt_a[bit_idx]+=(val_a >> bit_idx) & 1ULL;
+	cnt_b[bit_idx]+=(val_b >> bit_idx) & 1ULL;
+	cnt_ab[bit_idx]+=((val_a & val_b) >> bit_idx) & 1ULL;
+      } /* !bit_idx */
+      pair_nbr++;
+    } /* !idx */
+  } /* !type */
+  if(pair_nbr < CCR_FLT_INF_PAIR_MIN) return 0;
+
+  /* Mutual information that a pair of independent random bits exceeds only 1% of the time */
+  pr_cnf=0.5+CCR_FLT_INF_CNF/(2.0*sqrt((double)pair_nbr));
+  if(pr_cnf >= 1.0) inf_fre=1.0; else inf_fre=1.0+pr_cnf*log2(pr_cnf)+(1.0-pr_cnf)*log2(1.0-pr_cnf);
+
+  /* Mutual information of each bit position from its 2x2 joint distribution, summed from sign bit down */
+  for(bit_idx=bit_nbr-1;bit_idx>=0;bit_idx--){
+    double pr_jnt[2][2]; /* [frc] Joint probability of (first,second) bit values */
+    double pr_fst[2],pr_scn[2]; /* [frc] Marginal probabilities of first and second bit values */
+    int i,j;
+    /* Derive joint counts in integers so probabilities are never negative */
+    pr_jnt[1][1]=cnt_ab[bit_idx]/(double)pair_nbr;
+    pr_jnt[1][0]=(cnt_a[bit_idx]-cnt_ab[bit_idx])/(double)pair_nbr;
+    pr_jnt[0][1]=(cnt_b[bit_idx]-cnt_ab[bit_idx])/(double)pair_nbr;
+    pr_jnt[0][0]=(pair_nbr-cnt_a[bit_idx]-cnt_b[bit_idx]+cnt_ab[bit_idx])/(double)pair_nbr;
+    pr_fst[1]=cnt_a[bit_idx]/(double)pair_nbr; pr_fst[0]=(pair_nbr-cnt_a[bit_idx])/(double)pair_nbr;
+    pr_scn[1]=cnt_b[bit_idx]/(double)pair_nbr; pr_scn[0]=(pair_nbr-cnt_b[bit_idx])/(double)pair_nbr;
+    inf[bit_idx]=0.0;
+    for(i=0;i<2;i++)
+      for(j=0;j<2;j++)
+	if(pr_jnt[i][j] > 0.0) inf[bit_idx]+=pr_jnt[i][j]*log2(pr_jnt[i][j]/(pr_fst[i]*pr_scn[j]));
+    if(inf[bit_idx] <= inf_fre) inf[bit_idx]=0.0;
+    inf_ttl+=inf[bit_idx];
+    if(cnt_a[bit_idx] > 0 && cnt_a[bit_idx] < pair_nbr) flg_vry=1;
+  } /* !bit_idx */
+  if(inf_ttl <= 0.0) return flg_vry ? 1 : 0;
+
+  /* Same summation order as inf_ttl, so inf_frc == 1 stops exactly at last informative bit */
+  for(bit_idx=bit_nbr-1;bit_idx>0;bit_idx--){
+    inf_cml+=inf[bit_idx];
+    if(inf_cml >= inf_frc*inf_ttl) break;
+  } /* !bit_idx */
+
+  /* Keep mantissa bits from MSB down to bit_idx, and always keep at least one */
+  nsb=bit_xpl_nbr_sgn-bit_idx;
+  if(nsb < 1) nsb=1;
+  return nsb;
+} /* !ccr_btr_nsb_get() */
+
+static void
+ccr_btr_flt /* [fnc] BitRound single-precision values */
+(const size_t sz, /* I [nbr] Size (in elements) of buffer to quantize */
+ const float mss_val_cmp_flt, /* I [val] Missing value for comparison */
+ const unsigned int msk_f32_u32_zro, /* I [msk] Bit Shave mask for AND */
+ const unsigned int msk_f32_u32_hshv, /* I [msk] Half-Shave mask: MSB of LSBs */
+ ptr_unn op1) /* I/O [frc] Values to quantize */
+{
+  /* Purpose: Round to nearest kept bit by adding half-ULP then shaving LSBs
+     Zero stays zero because half-ULP lies entirely within the shaved LSBs */
+  unsigned int *u32_ptr=op1.ui32p;
+  size_t idx;
+
+  for(idx=0L;idx<sz;idx++)
+    if(op1.fp[idx] != mss_val_cmp_flt){
+      u32_ptr[idx]+=msk_f32_u32_hshv; /* Add 1 to the MSB of LSBs, carry 1 to mantissa or even exponent */
+      u32_ptr[idx]&=msk_f32_u32_zro; /* Shave it */
+    } /* !mss_val_cmp_flt */
+} /* !ccr_btr_flt() */
+
+static void
+ccr_btr_dbl /* [fnc] BitRound double-precision values */
+(const size_t sz, /* I [nbr] Size (in elements) of buffer to quantize */
+ const double mss_val_cmp_dbl, /* I [val] Missing value for comparison */
+ const unsigned long long int msk_f64_u64_zro, /* I [msk] Bit Shave mask for AND */
+ const unsigned long long int msk_f64_u64_hshv, /* I [msk] Half-Shave mask: MSB of LSBs */
+ ptr_unn op1) /* I/O [frc] Values to quantize */
+{
+  /* Purpose: Round to nearest kept bit by adding half-ULP then shaving LSBs
+     Zero stays zero because half-ULP lies entirely within the shaved LSBs */
+  unsigned long long int *u64_ptr=op1.ui64p;
+  size_t idx;
+
+  for(idx=0L;idx<sz;idx++)
+    if(op1.dp[idx] != mss_val_cmp_dbl){
+      u64_ptr[idx]+=msk_f64_u64_hshv; /* Add 1 to the MSB of LSBs, carry 1 to mantissa or even exponent */
+      u64_ptr[idx]&=msk_f64_u64_zro; /* Shave it */
+    } /* !mss_val_cmp_dbl */
+} /* !ccr_btr_dbl() */
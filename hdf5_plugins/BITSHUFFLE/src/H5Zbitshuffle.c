@@ -0,0 +1,693 @@
+/* Copyright (C) 2026--present Charlie Zender */
+
+ /*
+ * This file is an example of an HDF5 filter plugin.
+ * The plugin can be used with the HDF5 library version 1.8.11+ to read and write
+ * HDF5 datasets whose values are bit-transposed before compression, with vectorized kernels.
+ */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h" /* Autotools tokens */
+#endif
+#include <stdio.h>
+#ifdef HAVE_SYS_TYPES_H
+# include <sys/types.h>
+#endif
+#ifdef HAVE_SYS_STAT_H
+# include <sys/stat.h>
+#endif
+#ifdef STDC_HEADERS
+# include <stdlib.h>
+# include <stddef.h>
+#else
+# ifdef HAVE_STDLIB_H
+#  include <stdlib.h>
+# endif
+#endif
+#ifdef HAVE_STRING_H
+# if !defined STDC_HEADERS && defined HAVE_MEMORY_H
+#  include <memory.h>
+# endif
+# include <string.h>
+#endif
+#ifdef HAVE_STRINGS_H
+# include <strings.h>
+#endif
+#ifdef HAVE_INTTYPES_H
+# include <inttypes.h>
+#endif
+#ifdef HAVE_STDINT_H
+# include <stdint.h>
+#endif
+#ifdef HAVE_UNISTD_H
+# include <unistd.h>
+#endif
+#include <assert.h>
+
+#if defined(_WIN32)
+#include <Winsock2.h>
+#endif
+
+/* SIMD kernels need x86 intrinsics plus GCC/Clang function-level target attributes and __builtin_cpu_supports()
+   Other compilers and architectures use the scalar kernels */
+#if defined(HAVE_IMMINTRIN_H) && (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+# define CCR_SIMD_X86 1
+# include <immintrin.h> /* SSE2, AVX2, and AVX-512 intrinsics */
+#endif /* !HAVE_IMMINTRIN_H */
+
+/* 3rd party vendors */
+#include "H5PLextern.h" /* HDF5 Plugin Library: H5PLget_plugin_type(), H5PLget_plugin_info() */
+
+#define H5Z_FILTER_BITSHUFFLE 32773 /* NB: Not yet registered with HDF, see ccr.h */
+#define CCR_FLT_DBG_INFO 0 /* [flg] Print non-fatal debugging information */
+#define CCR_FLT_NAME "Bitshuffle filter (blocked bit transpose)" /* [sng] Filter name in vernacular for HDF5 messages */
+#define CCR_FLT_PRM_NBR 2 /* [nbr] Number of parameters sent to filter (in cd_params array). NB: keep identical with ccr.h:BITSHUFFLE_FLT_PRM_NBR */
+#define CCR_FLT_PRM_PSN_DATUM_SIZE 0 /* [nbr] Ordinal position of datum_size in parameter list (cd_params array) */
+#define CCR_FLT_PRM_PSN_BLK_NBR 1 /* [nbr] Ordinal position of block size in parameter list (cd_params array) */
+#define CCR_BSH_BLK_BYT_DFL 8192 /* [B] Default block size, small enough that source and destination blocks stay in L1 cache */
+#define CCR_BSH_BLK_NBR_MIN 128 /* [nbr] Minimum default block size in values */
+
+/* Bitshuffled chunks are a sequence of blocks, each of blk_nbr values (cd_values[1], or about CCR_BSH_BLK_BYT_DFL bytes if 0)
+   Block size is always a multiple of 8 values, the last block holds the largest multiple of 8 values remaining
+   A block of n values of datum_size bytes is stored as 8*datum_size bit planes of n/8 bytes each
+   Plane 8*b+k holds bit k of byte b of every value in the block, with value i at bit i%8 of byte i/8
+   After the last block come, unchanged, the at most 7 values that do not fill a group of 8, and any trailing bytes that do not fill a whole value
+   Quantized values (BitRound, Granular BitRound) share their zeroed trailing mantissa bits, which become planes of zeros */
+
+/* Kernels transpose one block of elm_nbr values (a multiple of 8) of datum_size bytes between value order (src of forward kernel) and bit-plane order (src of reverse kernel)
+   Kernel choice (scalar, SSE2, AVX2, AVX-512) is made once by ccr_bsh_cpu_dispatch() */
+typedef void
+(*ccr_bsh_knl_t) /* [fnc] Bitshuffle or unbitshuffle kernel */
+(const size_t elm_nbr, /* I [nbr] Number of values in block */
+ const size_t datum_size, /* I [B] Bytes per value */
+ const unsigned char *src, /* I [val] Values to transpose */
+ unsigned char *dst); /* O [val] Transposed values, elm_nbr*datum_size bytes */
+
+/* Forward-declare functions before their names appear in H5Z_class2_t filter structure */
+size_t /* O [B] Number of bytes resulting after forward/reverse filter applied */
+H5Z_filter_bitshuffle /* [fnc] HDF5 Bitshuffle Filter */
+(unsigned int flags, /* I [flg] Bitfield that encodes filter direction */
+ size_t cd_nelmts, /* I [nbr] Number of elements in filter parameter (cd_values[]) array */
+ const unsigned int cd_values[], /* I [enm] Filter parameters */
+ size_t bfr_sz_in, /* I [B] Number of bytes in input buffer (before forward/reverse filter) */
+ size_t *bfr_sz_out, /* O [B] Number of bytes in output buffer (after forward/reverse filter) */
+ void **bfr_inout); /* I/O [val] Values to bitshuffle or unbitshuffle */
+
+htri_t /* O [flg] Data meet criteria to apply filter */
+ccr_can_apply_bitshuffle /* [fnc] Callback to determine if current variable meets filter criteria */
+(hid_t dcpl, /* I [id] Dataset creation property list ID */
+ hid_t type, /* I [id] Dataset type ID */
+ hid_t space); /* I [id] Dataset space ID */
+
+htri_t /* O [flg] Filter parameters successfully modified for this variable */
+ccr_set_local_bitshuffle /* [fnc] Callback to determine and set per-variable filter parameters */
+(hid_t dcpl, /* I [id] Dataset creation property list ID */
+ hid_t type, /* I [id] Dataset type ID */
+ hid_t space); /* I [id] Dataset space ID */
+
+const H5Z_class2_t H5Z_BITSHUFFLE[1]={{
+    H5Z_CLASS_T_VERS, /* H5Z_class_t version */
+    (H5Z_filter_t)H5Z_FILTER_BITSHUFFLE, /* Filter ID number */
+#ifdef FILTER_DECODE_ONLY
+    0, /* [flg] Encoder availability flag */
+#else
+    1, /* [flg] Encoder availability flag */
+#endif
+    1, /* [flg] Decoder availability flag */
+    CCR_FLT_NAME, /* [sng] Filter name for debugging */
+    ccr_can_apply_bitshuffle, /* [fnc] Callback to determine if current variable meets filter criteria */
+    ccr_set_local_bitshuffle, /* [fnc] Callback to determine and set per-variable filter parameters */
+    (H5Z_func_t)H5Z_filter_bitshuffle, /* [fnc] Function to implement filter */
+  }}; /* !H5Z_BITSHUFFLE */
+
+void
+ccr_bsh_cpu_dispatch /* [fnc] Select fastest bit transpose kernels supported by this CPU */
+(void);
+
+/* Kernels selected by ccr_bsh_cpu_dispatch(), NULL until first dispatch */
+static ccr_bsh_knl_t ccr_bsh_fwd_knl=NULL; /* [fnc] Bitshuffle kernel */
+static ccr_bsh_knl_t ccr_bsh_rev_knl=NULL; /* [fnc] Unbitshuffle kernel */
+static const char *ccr_bsh_knl_nm="none"; /* [sng] Name of selected kernels, for debugging */
+
+/* Function definitions */
+H5PL_type_t /* O [enm] Plugin type */
+H5PLget_plugin_type /* [fnc] Provide plug-in type provided by this shared library */
+(void)
+{ /* Purpose: Describe plug-in type provided by this shared library
+     The HDF5 plugin mechanism usually calls this function after an application calls H5Pset_filter(), or when the data to which this filter will be applied are first read */
+  return H5PL_TYPE_FILTER;
+} /* !H5PLget_plugin_type() */
+
+const void * /* O [enm] */
+H5PLget_plugin_info /* [fnc] Return structure */
+(void)
+{ /* Purpose: Provide structure that defines Bitshuffle filter so the filter may be dynamically registered with the plugin mechanism
+     The HDF5 plugin mechanism usually calls this function after an application calls H5Pset_filter(), or when the data to which this filter will be applied are first read */
+  ccr_bsh_cpu_dispatch();
+  return H5Z_BITSHUFFLE;
+} /* !H5PLget_plugin_info() */
+
+size_t /* O [B] Number of bytes resulting after forward/reverse filter applied */
+H5Z_filter_bitshuffle /* [fnc] HDF5 Bitshuffle Filter */
+(unsigned int flags, /* I [flg] Bitfield that encodes filter direction */
+ size_t cd_nelmts, /* I [nbr] Number of elements in filter parameter (cd_values[]) array */
+ const unsigned int cd_values[], /* I [enm] Filter parameters */
+ size_t bfr_sz_in, /* I [B] Number of bytes in input buffer (before forward/reverse filter) */
+ size_t *bfr_sz_out, /* O [B] Number of bytes in output buffer (after forward/reverse filter) */
+ void **bfr_inout) /* I/O [val] Values to bitshuffle or unbitshuffle */
+{
+  /* Purpose: Dynamic filter invoked by HDF5 to gather each bit of every value into contiguous bit planes before compression, and to restore values on read
+     Blocks of a few kB are transposed one at a time so that source and destination stay in cache
+     Filter is lossless and applies to values of any size */
+
+  const char fnc_nm[]="H5Z_filter_bitshuffle()"; /* [sng] Function name */
+
+  ccr_bsh_knl_t knl; /* [fnc] Kernel for this direction */
+  size_t blk_nbr; /* [nbr] Values per block */
+  size_t blk_srt; /* [idx] First value of current block */
+  size_t datum_size; /* [B] Bytes per unfiltered data value */
+  size_t elm_nbr; /* [nbr] Number of values in buffer */
+  size_t lst_nbr; /* [nbr] Values in last, shorter, block */
+  size_t tail_srt; /* [B] Offset of bytes copied unchanged */
+  unsigned char *bfr_new=NULL; /* [ptr] New buffer */
+  const unsigned char *bfr_old=(const unsigned char *)(*bfr_inout); /* [ptr] Input buffer */
+
+  if(!ccr_bsh_fwd_knl) ccr_bsh_cpu_dispatch();
+
+  if(cd_nelmts < CCR_FLT_PRM_NBR){
+    (void)fprintf(stderr,"ERROR: \"%s\" filter function %s reports %lu parameters, needs %d\n",CCR_FLT_NAME,fnc_nm,(unsigned long)cd_nelmts,CCR_FLT_PRM_NBR);
+    return 0;
+  } /* !cd_nelmts */
+  datum_size=cd_values[CCR_FLT_PRM_PSN_DATUM_SIZE];
+  if(datum_size == 0){
+    (void)fprintf(stderr,"ERROR: \"%s\" filter function %s reports datum size = 0 B is invalid\n",CCR_FLT_NAME,fnc_nm);
+    return 0;
+  } /* !datum_size */
+  blk_nbr=cd_values[CCR_FLT_PRM_PSN_BLK_NBR];
+  if(blk_nbr == 0){
+    blk_nbr=CCR_BSH_BLK_BYT_DFL/datum_size;
+    blk_nbr-=blk_nbr%8;
+    if(blk_nbr < CCR_BSH_BLK_NBR_MIN) blk_nbr=CCR_BSH_BLK_NBR_MIN;
+  } /* !blk_nbr */
+  if(blk_nbr%8 != 0){
+    (void)fprintf(stderr,"ERROR: \"%s\" filter function %s reports block size = %lu values is not a multiple of 8\n",CCR_FLT_NAME,fnc_nm,(unsigned long)blk_nbr);
+    return 0;
+  } /* !blk_nbr */
+
+  /* Fewer than one group of 8 values, so nothing to transpose */
+  elm_nbr=bfr_sz_in/datum_size;
+  if(elm_nbr < 8){
+    *bfr_sz_out=bfr_sz_in;
+    return bfr_sz_in;
+  } /* !elm_nbr */
+
+  if(!(bfr_new=(unsigned char *)malloc(bfr_sz_in))){
+    (void)fprintf(stderr,"ERROR: \"%s\" filter function %s unable to allocate %lu B for %s data\n",CCR_FLT_NAME,fnc_nm,(unsigned long)bfr_sz_in,(flags & H5Z_FLAG_REVERSE) ? "unbitshuffled" : "bitshuffled");
+    return 0;
+  } /* !bfr_new */
+
+  if(CCR_FLT_DBG_INFO) (void)fprintf(stderr,"INFO: %s %s %lu values of datum size = %lu B in blocks of %lu values with %s kernel\n",fnc_nm,(flags & H5Z_FLAG_REVERSE) ? "unbitshuffles" : "bitshuffles",(unsigned long)elm_nbr,(unsigned long)datum_size,(unsigned long)blk_nbr,ccr_bsh_knl_nm);
+
+  knl=(flags & H5Z_FLAG_REVERSE) ? ccr_bsh_rev_knl : ccr_bsh_fwd_knl;
+  for(blk_srt=0;blk_srt+blk_nbr<=elm_nbr;blk_srt+=blk_nbr)
+    knl(blk_nbr,datum_size,bfr_old+blk_srt*datum_size,bfr_new+blk_srt*datum_size);
+  lst_nbr=(elm_nbr-blk_srt)-(elm_nbr-blk_srt)%8;
+  if(lst_nbr > 0) knl(lst_nbr,datum_size,bfr_old+blk_srt*datum_size,bfr_new+blk_srt*datum_size);
+  tail_srt=(blk_srt+lst_nbr)*datum_size;
+  if(tail_srt < bfr_sz_in) memcpy(bfr_new+tail_srt,bfr_old+tail_srt,bfr_sz_in-tail_srt);
+
+  free(*bfr_inout);
+  *bfr_inout=bfr_new;
+  *bfr_sz_out=bfr_sz_in;
+  return bfr_sz_in;
+
+} /* !H5Z_filter_bitshuffle() */
+
+htri_t /* O [flg] Data meet criteria to apply filter */
+ccr_can_apply_bitshuffle /* [fnc] Callback to determine if current variable meets filter criteria */
+(hid_t dcpl, /* I [id] Dataset creation property list ID */
+ hid_t type, /* I [id] Dataset type ID */
+ hid_t space) /* I [id] Dataset space ID */
+{
+  /* Data space must be simple, i.e., a multi-dimensional array */
+  if(H5Sis_simple(space) <= 0){
+    fprintf(stderr,"WARNING: Cannot apply filter \"%s\" filter because data space is not simple.\n",CCR_FLT_NAME);
+    return 0;
+  } /* !H5Sis_simple(space) */
+
+  /* Filter can be applied */
+  return 1;
+} /* !ccr_can_apply_bitshuffle() */
+
+htri_t /* O [flg] Filter parameters successfully modified for this variable */
+ccr_set_local_bitshuffle /* [fnc] Callback to determine and set per-variable filter parameters */
+(hid_t dcpl, /* I [id] Dataset creation property list ID */
+ hid_t type, /* I [id] Dataset type ID */
+ hid_t space) /* I [id] Dataset space ID */
+{
+  const char fnc_nm[]="ccr_set_local_bitshuffle()"; /* [sng] Function name */
+
+  herr_t rcd; /* [flg] Return code */
+
+  /* Initialize filter parameters with default values */
+  unsigned int ccr_flt_prm[CCR_FLT_PRM_NBR]={0,0};
+
+  /* Initialize output variables for call to H5Pget_filter_by_id() */
+  unsigned int flags=0;
+  size_t cd_nelmts=CCR_FLT_PRM_NBR;
+  unsigned int *cd_values=ccr_flt_prm;
+
+  /* Retrieve parameters specified by user
+     https://support.hdfgroup.org/HDF5/doc/RM/RM_H5P.html#FunctionIndex
+     Ignore name and filter_config by setting last three arguments to 0/NULL */
+  rcd=H5Pget_filter_by_id(dcpl,H5Z_FILTER_BITSHUFFLE,&flags,&cd_nelmts,cd_values,0,NULL,NULL);
+  if(rcd < 0){
+    (void)fprintf(stderr,"ERROR: %s filter callback function %s reports H5Pget_filter_by_id() failed to get filter flags and parameters for current variable\n",CCR_FLT_NAME,fnc_nm);
+    return 0;
+  } /* !rcd */
+
+  /* Block size is user-specified (or 0 for default) and must be a whole number of bytes of each bit plane */
+  if(ccr_flt_prm[CCR_FLT_PRM_PSN_BLK_NBR]%8 != 0){
+    (void)fprintf(stderr,"ERROR: %s filter callback function %s reports block size = %u values is not a multiple of 8\n",CCR_FLT_NAME,fnc_nm,ccr_flt_prm[CCR_FLT_PRM_PSN_BLK_NBR]);
+    return 0;
+  } /* !blk_nbr */
+
+  /* Datum size is determined by variable type */
+  size_t datum_size; /* [B] Bytes per data value */
+  datum_size=H5Tget_size(type);
+  if(datum_size <= 0){
+    (void)fprintf(stderr,"ERROR: %s filter callback function %s reports H5Tget_size() returned invalid datum size = %lu B\n",CCR_FLT_NAME,fnc_nm,datum_size);
+    return 0;
+  } /* !datum_size */
+  ccr_flt_prm[CCR_FLT_PRM_PSN_DATUM_SIZE]=(unsigned int)datum_size;
+
+  /* Update invoked filter with generic parameters as invoked with variable-specific values */
+  rcd=H5Pmodify_filter(dcpl,H5Z_FILTER_BITSHUFFLE,flags,CCR_FLT_PRM_NBR,cd_values);
+  if(rcd < 0){
+    (void)fprintf(stderr,"ERROR: \"%s\" filter callback function %s reports H5Pmodify_filter() unable to modify filter parameters\n",CCR_FLT_NAME,fnc_nm);
+    return 0;
+  } /* !rcd */
+
+  return 1;
+} /* !ccr_set_local_bitshuffle() */
+
+/* Scalar kernels define the layout, SIMD kernels reproduce it bit-for-bit
+   SIMD kernels transpose whole vector widths of values and pass the remaining groups of 8, from elm_srt on, to the scalar loops */
+
+static uint64_t /* O [val] Transposed 8x8 bit matrix */
+ccr_bsh_trn_8x8 /* [fnc] Transpose 8x8 bit matrix */
+(uint64_t x) /* I [val] Bit k of byte b is matrix element (b,k) */
+{
+  /* Swap 1x1, then 2x2, then 4x4 sub-blocks across the diagonal, so bit k of byte b moves to bit b of byte k
+     Transpose is its own inverse, so it serves both directions */
+  uint64_t t; /* [val] Bits that change place */
+
+  t=(x^(x >> 7))&0x00AA00AA00AA00AAULL;
+  x=x^t^(t << 7);
+  t=(x^(x >> 14))&0x0000CCCC0000CCCCULL;
+  x=x^t^(t << 14);
+  t=(x^(x >> 28))&0x00000000F0F0F0F0ULL;
+  x=x^t^(t << 28);
+  return x;
+} /* !ccr_bsh_trn_8x8() */
+
+static void
+ccr_bsh_fwd_rng /* [fnc] Bitshuffle values elm_srt to elm_nbr-1 of a block */
+(const size_t elm_srt, /* I [idx] First value to bitshuffle, a multiple of 8 */
+ const size_t elm_nbr, /* I [nbr] Number of values in block */
+ const size_t datum_size, /* I [B] Bytes per value */
+ const unsigned char *src, /* I [val] Values */
+ unsigned char *dst) /* O [val] Bit planes */
+{
+  const size_t pln_sz=elm_nbr/8; /* [B] Bytes per bit plane */
+  size_t byt_idx; /* [idx] Byte within value */
+  size_t bit_idx; /* [idx] Bit within byte */
+  size_t idx;
+  size_t grp_idx; /* [idx] Value within group of 8 */
+  uint64_t x; /* [val] Byte byt_idx of 8 values */
+
+  for(idx=elm_srt;idx<elm_nbr;idx+=8){
+    for(byt_idx=0;byt_idx<datum_size;byt_idx++){
+      for(x=0,grp_idx=0;grp_idx<8;grp_idx++) x|=(uint64_t)src[(idx+grp_idx)*datum_size+byt_idx] << (8*grp_idx);
+      x=ccr_bsh_trn_8x8(x);
+      for(bit_idx=0;bit_idx<8;bit_idx++) dst[(8*byt_idx+bit_idx)*pln_sz+idx/8]=(unsigned char)(x >> (8*bit_idx));
+    } /* !byt_idx */
+  } /* !idx */
+} /* !ccr_bsh_fwd_rng() */
+
+static void
+ccr_bsh_rev_rng /* [fnc] Unbitshuffle values elm_srt to elm_nbr-1 of a block */
+(const size_t elm_srt, /* I [idx] First value to unbitshuffle, a multiple of 8 */
+ const size_t elm_nbr, /* I [nbr] Number of values in block */
+ const size_t datum_size, /* I [B] Bytes per value */
+ const unsigned char *src, /* I [val] Bit planes */
+ unsigned char *dst) /* O [val] Values */
+{
+  const size_t pln_sz=elm_nbr/8; /* [B] Bytes per bit plane */
+  size_t byt_idx; /* [idx] Byte within value */
+  size_t bit_idx; /* [idx] Bit within byte */
+  size_t idx;
+  size_t grp_idx; /* [idx] Value within group of 8 */
+  uint64_t x; /* [val] Bits of byte byt_idx of 8 values */
+
+  for(idx=elm_srt;idx<elm_nbr;idx+=8){
+    for(byt_idx=0;byt_idx<datum_size;byt_idx++){
+      for(x=0,bit_idx=0;bit_idx<8;bit_idx++) x|=(uint64_t)src[(8*byt_idx+bit_idx)*pln_sz+idx/8] << (8*bit_idx);
+      x=ccr_bsh_trn_8x8(x);
+      for(grp_idx=0;grp_idx<8;grp_idx++) dst[(idx+grp_idx)*datum_size+byt_idx]=(unsigned char)(x >> (8*grp_idx));
+    } /* !byt_idx */
+  } /* !idx */
+} /* !ccr_bsh_rev_rng() */
+
+static void
+ccr_bsh_fwd_scl /* [fnc] Bitshuffle block */
+(const size_t elm_nbr, /* I [nbr] Number of values in block */
+ const size_t datum_size, /* I [B] Bytes per value */
+ const unsigned char *src, /* I [val] Values */
+ unsigned char *dst) /* O [val] Bit planes */
+{
+  ccr_bsh_fwd_rng(0,elm_nbr,datum_size,src,dst);
+} /* !ccr_bsh_fwd_scl() */
+
+static void
+ccr_bsh_rev_scl /* [fnc] Unbitshuffle block */
+(const size_t elm_nbr, /* I [nbr] Number of values in block */
+ const size_t datum_size, /* I [B] Bytes per value */
+ const unsigned char *src, /* I [val] Bit planes */
+ unsigned char *dst) /* O [val] Values */
+{
+  ccr_bsh_rev_rng(0,elm_nbr,datum_size,src,dst);
+} /* !ccr_bsh_rev_scl() */
+
+#ifdef CCR_SIMD_X86
+/* Vector kernels load one vector width of values (datum_size vectors) and byte-transpose them in registers
+   Byte transpose splits the vectors into even bytes followed by odd bytes, log2(datum_size) times, as in the Byte Shuffle filter, which leaves byte b of every value in vector b
+   Bitshuffle then takes bit planes from the top down: a byte movemask collects bit 7 of every byte, and a 16-bit left shift brings the next bit up
+   Unbitshuffle expands each bit plane back to bytes (0x00 or 0xFF), keeps one bit of each, and interleaves bytes with unpacks to restore values
+   Values of other than 1, 2, 4, or 8 bytes go to scalar kernels */
+
+__attribute__((target("sse2")))
+static void
+ccr_bsh_fwd_sse2 /* [fnc] Bitshuffle block with SSE2 */
+(const size_t elm_nbr, /* I [nbr] Number of values in block */
+ const size_t datum_size, /* I [B] Bytes per value */
+ const unsigned char *src, /* I [val] Values */
+ unsigned char *dst) /* O [val] Bit planes */
+{
+  const size_t pln_sz=elm_nbr/8; /* [B] Bytes per bit plane */
+  const size_t hlf=datum_size/2; /* [nbr] Vectors in each half of stream */
+  const __m128i lo_msk=_mm_set1_epi16(0x00FF); /* [msk] Low byte of 16-bit lanes */
+  __m128i vct[8],tmp[8]; /* [val] Values, and values after a split */
+  uint16_t msk; /* [val] Bit plane of 16 values */
+  size_t stp; /* [nbr] Splits done, as power of two */
+  size_t bit_idx; /* [idx] Bit within byte */
+  size_t idx;
+  size_t vct_idx;
+
+  if(datum_size != 1 && datum_size != 2 && datum_size != 4 && datum_size != 8){
+    ccr_bsh_fwd_scl(elm_nbr,datum_size,src,dst);
+    return;
+  } /* !datum_size */
+  for(idx=0;idx+16<=elm_nbr;idx+=16){
+    for(vct_idx=0;vct_idx<datum_size;vct_idx++) vct[vct_idx]=_mm_loadu_si128((const __m128i *)(src+idx*datum_size+16*vct_idx));
+    for(stp=1;stp<datum_size;stp*=2){
+      for(vct_idx=0;vct_idx<hlf;vct_idx++){
+	const __m128i a=vct[2*vct_idx],b=vct[2*vct_idx+1];
+	tmp[vct_idx]=_mm_packus_epi16(_mm_and_si128(a,lo_msk),_mm_and_si128(b,lo_msk));
+	tmp[vct_idx+hlf]=_mm_packus_epi16(_mm_srli_epi16(a,8),_mm_srli_epi16(b,8));
+      } /* !vct_idx */
+      memcpy(vct,tmp,datum_size*sizeof(__m128i));
+    } /* !stp */
+    for(vct_idx=0;vct_idx<datum_size;vct_idx++){
+      __m128i v=vct[vct_idx];
+      for(bit_idx=8;bit_idx-- > 0;){
+	msk=(uint16_t)_mm_movemask_epi8(v);
+	memcpy(dst+(8*vct_idx+bit_idx)*pln_sz+idx/8,&msk,sizeof(msk));
+	v=_mm_slli_epi16(v,1);
+      } /* !bit_idx */
+    } /* !vct_idx */
+  } /* !idx */
+  ccr_bsh_fwd_rng(idx,elm_nbr,datum_size,src,dst);
+} /* !ccr_bsh_fwd_sse2() */
+
+__attribute__((target("sse2")))
+static void
+ccr_bsh_rev_sse2 /* [fnc] Unbitshuffle block with SSE2 */
+(const size_t elm_nbr, /* I [nbr] Number of values in block */
+ const size_t datum_size, /* I [B] Bytes per value */
+ const unsigned char *src, /* I [val] Bit planes */
+ unsigned char *dst) /* O [val] Values */
+{
+  const size_t pln_sz=elm_nbr/8; /* [B] Bytes per bit plane */
+  const size_t hlf=datum_size/2; /* [nbr] Vectors in each half of stream */
+  const __m128i bit_sel=_mm_set1_epi64x(0x8040201008040201LL); /* [msk] Bit i%8 in byte i */
+  __m128i vct[8],tmp[8]; /* [val] Byte planes, and byte planes after an interleave */
+  uint16_t msk; /* [val] Bit plane of 16 values */
+  size_t stp; /* [nbr] Interleaves done, as power of two */
+  size_t bit_idx; /* [idx] Bit within byte */
+  size_t idx;
+  size_t vct_idx;
+
+  if(datum_size != 1 && datum_size != 2 && datum_size != 4 && datum_size != 8){
+    ccr_bsh_rev_scl(elm_nbr,datum_size,src,dst);
+    return;
+  } /* !datum_size */
+  for(idx=0;idx+16<=elm_nbr;idx+=16){
+    for(vct_idx=0;vct_idx<datum_size;vct_idx++){
+      __m128i v=_mm_setzero_si128();
+      for(bit_idx=0;bit_idx<8;bit_idx++){
+	__m128i x;
+	memcpy(&msk,src+(8*vct_idx+bit_idx)*pln_sz+idx/8,sizeof(msk));
+	/* Broadcast byte i/8 of plane to byte i, then test bit i%8 */
+	x=_mm_cvtsi32_si128(msk);
+	x=_mm_unpacklo_epi8(x,x);
+	x=_mm_unpacklo_epi16(x,x);
+	x=_mm_unpacklo_epi32(x,x);
+	x=_mm_cmpeq_epi8(_mm_and_si128(x,bit_sel),bit_sel);
+	v=_mm_or_si128(v,_mm_and_si128(x,_mm_set1_epi8((char)(1 << bit_idx))));
+      } /* !bit_idx */
+      vct[vct_idx]=v;
+    } /* !vct_idx */
+    for(stp=1;stp<datum_size;stp*=2){
+      for(vct_idx=0;vct_idx<hlf;vct_idx++){
+	tmp[2*vct_idx]=_mm_unpacklo_epi8(vct[vct_idx],vct[vct_idx+hlf]);
+	tmp[2*vct_idx+1]=_mm_unpackhi_epi8(vct[vct_idx],vct[vct_idx+hlf]);
+      } /* !vct_idx */
+      memcpy(vct,tmp,datum_size*sizeof(__m128i));
+    } /* !stp */
+    for(vct_idx=0;vct_idx<datum_size;vct_idx++) _mm_storeu_si128((__m128i *)(dst+idx*datum_size+16*vct_idx),vct[vct_idx]);
+  } /* !idx */
+  ccr_bsh_rev_rng(idx,elm_nbr,datum_size,src,dst);
+} /* !ccr_bsh_rev_sse2() */
+
+__attribute__((target("avx2")))
+static void
+ccr_bsh_fwd_avx2 /* [fnc] Bitshuffle block with AVX2 */
+(const size_t elm_nbr, /* I [nbr] Number of values in block */
+ const size_t datum_size, /* I [B] Bytes per value */
+ const unsigned char *src, /* I [val] Values */
+ unsigned char *dst) /* O [val] Bit planes */
+{
+  const size_t pln_sz=elm_nbr/8; /* [B] Bytes per bit plane */
+  const size_t hlf=datum_size/2; /* [nbr] Vectors in each half of stream */
+  const __m256i lo_msk=_mm256_set1_epi16(0x00FF); /* [msk] Low byte of 16-bit lanes */
+  __m256i vct[8],tmp[8]; /* [val] Values, and values after a split */
+  uint32_t msk; /* [val] Bit plane of 32 values */
+  size_t stp; /* [nbr] Splits done, as power of two */
+  size_t bit_idx; /* [idx] Bit within byte */
+  size_t idx;
+  size_t vct_idx;
+
+  if(datum_size != 1 && datum_size != 2 && datum_size != 4 && datum_size != 8){
+    ccr_bsh_fwd_scl(elm_nbr,datum_size,src,dst);
+    return;
+  } /* !datum_size */
+  for(idx=0;idx+32<=elm_nbr;idx+=32){
+    for(vct_idx=0;vct_idx<datum_size;vct_idx++) vct[vct_idx]=_mm256_loadu_si256((const __m256i *)(src+idx*datum_size+32*vct_idx));
+    for(stp=1;stp<datum_size;stp*=2){
+      for(vct_idx=0;vct_idx<hlf;vct_idx++){
+	const __m256i a=vct[2*vct_idx],b=vct[2*vct_idx+1];
+	tmp[vct_idx]=_mm256_permute4x64_epi64(_mm256_packus_epi16(_mm256_and_si256(a,lo_msk),_mm256_and_si256(b,lo_msk)),0xD8);
+	tmp[vct_idx+hlf]=_mm256_permute4x64_epi64(_mm256_packus_epi16(_mm256_srli_epi16(a,8),_mm256_srli_epi16(b,8)),0xD8);
+      } /* !vct_idx */
+      memcpy(vct,tmp,datum_size*sizeof(__m256i));
+    } /* !stp */
+    for(vct_idx=0;vct_idx<datum_size;vct_idx++){
+      __m256i v=vct[vct_idx];
+      for(bit_idx=8;bit_idx-- > 0;){
+	msk=(uint32_t)_mm256_movemask_epi8(v);
+	memcpy(dst+(8*vct_idx+bit_idx)*pln_sz+idx/8,&msk,sizeof(msk));
+	v=_mm256_slli_epi16(v,1);
+      } /* !bit_idx */
+    } /* !vct_idx */
+  } /* !idx */
+  ccr_bsh_fwd_rng(idx,elm_nbr,datum_size,src,dst);
+} /* !ccr_bsh_fwd_avx2() */
+
+__attribute__((target("avx2")))
+static void
+ccr_bsh_rev_avx2 /* [fnc] Unbitshuffle block with AVX2 */
+(const size_t elm_nbr, /* I [nbr] Number of values in block */
+ const size_t datum_size, /* I [B] Bytes per value */
+ const unsigned char *src, /* I [val] Bit planes */
+ unsigned char *dst) /* O [val] Values */
+{
+  const size_t pln_sz=elm_nbr/8; /* [B] Bytes per bit plane */
+  const size_t hlf=datum_size/2; /* [nbr] Vectors in each half of stream */
+  const __m256i bit_sel=_mm256_set1_epi64x(0x8040201008040201LL); /* [msk] Bit i%8 in byte i */
+  const __m256i byt_bcs=_mm256_set_epi64x(0x0303030303030303LL,0x0202020202020202LL,0x0101010101010101LL,0x0000000000000000LL); /* [idx] Byte i/8 of plane to byte i */
+  __m256i vct[8],tmp[8]; /* [val] Byte planes, and byte planes after an interleave */
+  uint32_t msk; /* [val] Bit plane of 32 values */
+  size_t stp; /* [nbr] Interleaves done, as power of two */
+  size_t bit_idx; /* [idx] Bit within byte */
+  size_t idx;
+  size_t vct_idx;
+
+  if(datum_size != 1 && datum_size != 2 && datum_size != 4 && datum_size != 8){
+    ccr_bsh_rev_scl(elm_nbr,datum_size,src,dst);
+    return;
+  } /* !datum_size */
+  for(idx=0;idx+32<=elm_nbr;idx+=32){
+    for(vct_idx=0;vct_idx<datum_size;vct_idx++){
+      __m256i v=_mm256_setzero_si256();
+      for(bit_idx=0;bit_idx<8;bit_idx++){
+	__m256i x;
+	memcpy(&msk,src+(8*vct_idx+bit_idx)*pln_sz+idx/8,sizeof(msk));
+	x=_mm256_shuffle_epi8(_mm256_set1_epi32((int)msk),byt_bcs);
+	x=_mm256_cmpeq_epi8(_mm256_and_si256(x,bit_sel),bit_sel);
+	v=_mm256_or_si256(v,_mm256_and_si256(x,_mm256_set1_epi8((char)(1 << bit_idx))));
+      } /* !bit_idx */
+      vct[vct_idx]=v;
+    } /* !vct_idx */
+    for(stp=1;stp<datum_size;stp*=2){
+      for(vct_idx=0;vct_idx<hlf;vct_idx++){
+	const __m256i evn=_mm256_permute4x64_epi64(vct[vct_idx],0xD8);
+	const __m256i odd=_mm256_permute4x64_epi64(vct[vct_idx+hlf],0xD8);
+	tmp[2*vct_idx]=_mm256_unpacklo_epi8(evn,odd);
+	tmp[2*vct_idx+1]=_mm256_unpackhi_epi8(evn,odd);
+      } /* !vct_idx */
+      memcpy(vct,tmp,datum_size*sizeof(__m256i));
+    } /* !stp */
+    for(vct_idx=0;vct_idx<datum_size;vct_idx++) _mm256_storeu_si256((__m256i *)(dst+idx*datum_size+32*vct_idx),vct[vct_idx]);
+  } /* !idx */
+  ccr_bsh_rev_rng(idx,elm_nbr,datum_size,src,dst);
+} /* !ccr_bsh_rev_avx2() */
+
+__attribute__((target("avx512bw")))
+static void
+ccr_bsh_fwd_avx512 /* [fnc] Bitshuffle block with AVX-512 */
+(const size_t elm_nbr, /* I [nbr] Number of values in block */
+ const size_t datum_size, /* I [B] Bytes per value */
+ const unsigned char *src, /* I [val] Values */
+ unsigned char *dst) /* O [val] Bit planes */
+{
+  const size_t pln_sz=elm_nbr/8; /* [B] Bytes per bit plane */
+  const size_t hlf=datum_size/2; /* [nbr] Vectors in each half of stream */
+  const __m512i lo_msk=_mm512_set1_epi16(0x00FF); /* [msk] Low byte of 16-bit lanes */
+  const __m512i prm=_mm512_set_epi64(7,5,3,1,6,4,2,0); /* [idx] 64-bit words of first vector, then of second */
+  __m512i vct[8],tmp[8]; /* [val] Values, and values after a split */
+  uint64_t msk; /* [val] Bit plane of 64 values */
+  size_t stp; /* [nbr] Splits done, as power of two */
+  size_t bit_idx; /* [idx] Bit within byte */
+  size_t idx;
+  size_t vct_idx;
+
+  if(datum_size != 1 && datum_size != 2 && datum_size != 4 && datum_size != 8){
+    ccr_bsh_fwd_scl(elm_nbr,datum_size,src,dst);
+    return;
+  } /* !datum_size */
+  for(idx=0;idx+64<=elm_nbr;idx+=64){
+    for(vct_idx=0;vct_idx<datum_size;vct_idx++) vct[vct_idx]=_mm512_loadu_si512((const void *)(src+idx*datum_size+64*vct_idx));
+    for(stp=1;stp<datum_size;stp*=2){
+      for(vct_idx=0;vct_idx<hlf;vct_idx++){
+	const __m512i a=vct[2*vct_idx],b=vct[2*vct_idx+1];
+	tmp[vct_idx]=_mm512_permutexvar_epi64(prm,_mm512_packus_epi16(_mm512_and_si512(a,lo_msk),_mm512_and_si512(b,lo_msk)));
+	tmp[vct_idx+hlf]=_mm512_permutexvar_epi64(prm,_mm512_packus_epi16(_mm512_srli_epi16(a,8),_mm512_srli_epi16(b,8)));
+      } /* !vct_idx */
+      memcpy(vct,tmp,datum_size*sizeof(__m512i));
+    } /* !stp */
+    for(vct_idx=0;vct_idx<datum_size;vct_idx++){
+      __m512i v=vct[vct_idx];
+      for(bit_idx=8;bit_idx-- > 0;){
+	msk=(uint64_t)_mm512_movepi8_mask(v);
+	memcpy(dst+(8*vct_idx+bit_idx)*pln_sz+idx/8,&msk,sizeof(msk));
+	v=_mm512_slli_epi16(v,1);
+      } /* !bit_idx */
+    } /* !vct_idx */
+  } /* !idx */
+  ccr_bsh_fwd_rng(idx,elm_nbr,datum_size,src,dst);
+} /* !ccr_bsh_fwd_avx512() */
+
+__attribute__((target("avx512bw")))
+static void
+ccr_bsh_rev_avx512 /* [fnc] Unbitshuffle block with AVX-512 */
+(const size_t elm_nbr, /* I [nbr] Number of values in block */
+ const size_t datum_size, /* I [B] Bytes per value */
+ const unsigned char *src, /* I [val] Bit planes */
+ unsigned char *dst) /* O [val] Values */
+{
+  const size_t pln_sz=elm_nbr/8; /* [B] Bytes per bit plane */
+  const size_t hlf=datum_size/2; /* [nbr] Vectors in each half of stream */
+  const __m512i prm=_mm512_set_epi64(7,3,6,2,5,1,4,0); /* [idx] 64-bit words i and i+4 into 128-bit lane i */
+  __m512i vct[8],tmp[8]; /* [val] Byte planes, and byte planes after an interleave */
+  uint64_t msk; /* [val] Bit plane of 64 values */
+  size_t stp; /* [nbr] Interleaves done, as power of two */
+  size_t bit_idx; /* [idx] Bit within byte */
+  size_t idx;
+  size_t vct_idx;
+
+  if(datum_size != 1 && datum_size != 2 && datum_size != 4 && datum_size != 8){
+    ccr_bsh_rev_scl(elm_nbr,datum_size,src,dst);
+    return;
+  } /* !datum_size */
+  for(idx=0;idx+64<=elm_nbr;idx+=64){
+    for(vct_idx=0;vct_idx<datum_size;vct_idx++){
+      __m512i v=_mm512_setzero_si512();
+      for(bit_idx=0;bit_idx<8;bit_idx++){
+	memcpy(&msk,src+(8*vct_idx+bit_idx)*pln_sz+idx/8,sizeof(msk));
+	v=_mm512_or_si512(v,_mm512_maskz_mov_epi8((__mmask64)msk,_mm512_set1_epi8((char)(1 << bit_idx))));
+      } /* !bit_idx */
+      vct[vct_idx]=v;
+    } /* !vct_idx */
+    for(stp=1;stp<datum_size;stp*=2){
+      for(vct_idx=0;vct_idx<hlf;vct_idx++){
+	const __m512i evn=_mm512_permutexvar_epi64(prm,vct[vct_idx]);
+	const __m512i odd=_mm512_permutexvar_epi64(prm,vct[vct_idx+hlf]);
+	tmp[2*vct_idx]=_mm512_unpacklo_epi8(evn,odd);
+	tmp[2*vct_idx+1]=_mm512_unpackhi_epi8(evn,odd);
+      } /* !vct_idx */
+      memcpy(vct,tmp,datum_size*sizeof(__m512i));
+    } /* !stp */
+    for(vct_idx=0;vct_idx<datum_size;vct_idx++) _mm512_storeu_si512((void *)(dst+idx*datum_size+64*vct_idx),vct[vct_idx]);
+  } /* !idx */
+  ccr_bsh_rev_rng(idx,elm_nbr,datum_size,src,dst);
+} /* !ccr_bsh_rev_avx512() */
+#endif /* !CCR_SIMD_X86 */
+
+void
+ccr_bsh_cpu_dispatch /* [fnc] Select fastest bit transpose kernels supported by this CPU */
+(void)
+{
+  /* Purpose: Query CPUID (through compiler builtins that also check OS register-state support) and point kernels at widest supported instruction set
+     Results are identical for all kernels, only speed differs */
+  ccr_bsh_fwd_knl=ccr_bsh_fwd_scl;
+  ccr_bsh_rev_knl=ccr_bsh_rev_scl;
+  ccr_bsh_knl_nm="scalar";
+#ifdef CCR_SIMD_X86
+  __builtin_cpu_init();
+  if(__builtin_cpu_supports("avx512bw")){
+    ccr_bsh_fwd_knl=ccr_bsh_fwd_avx512;
+    ccr_bsh_rev_knl=ccr_bsh_rev_avx512;
+    ccr_bsh_knl_nm="AVX-512";
+  }else if(__builtin_cpu_supports("avx2")){
+    ccr_bsh_fwd_knl=ccr_bsh_fwd_avx2;
+    ccr_bsh_rev_knl=ccr_bsh_rev_avx2;
+    ccr_bsh_knl_nm="AVX2";
+  }else if(__builtin_cpu_supports("sse2")){
+    ccr_bsh_fwd_knl=ccr_bsh_fwd_sse2;
+    ccr_bsh_rev_knl=ccr_bsh_rev_sse2;
+    ccr_bsh_knl_nm="SSE2";
+  } /* !__builtin_cpu_supports() */
+#endif /* !CCR_SIMD_X86 */
+  if(CCR_FLT_DBG_INFO) (void)fprintf(stderr,"INFO: \"%s\" filter selected %s kernels\n",CCR_FLT_NAME,ccr_bsh_knl_nm);
+} /* !ccr_bsh_cpu_dispatch() */
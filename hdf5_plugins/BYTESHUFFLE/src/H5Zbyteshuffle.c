@@ -0,0 +1,562 @@
+/* Copyright (C) 2026--present Charlie Zender */
+
+ /*
+ * This file is an example of an HDF5 filter plugin.
+ * The plugin can be used with the HDF5 library version 1.8.11+ to read and write
+ * HDF5 datasets whose values are byte-shuffled before compression, with vectorized kernels.
+ */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h" /* Autotools tokens */
+#endif
+#include <stdio.h>
+#ifdef HAVE_SYS_TYPES_H
+# include <sys/types.h>
+#endif
+#ifdef HAVE_SYS_STAT_H
+# include <sys/stat.h>
+#endif
+#ifdef STDC_HEADERS
+# include <stdlib.h>
+# include <stddef.h>
+#else
+# ifdef HAVE_STDLIB_H
+#  include <stdlib.h>
+# endif
+#endif
+#ifdef HAVE_STRING_H
+# if !defined STDC_HEADERS && defined HAVE_MEMORY_H
+#  include <memory.h>
+# endif
+# include <string.h>
+#endif
+#ifdef HAVE_STRINGS_H
+# include <strings.h>
+#endif
+#ifdef HAVE_INTTYPES_H
+# include <inttypes.h>
+#endif
+#ifdef HAVE_STDINT_H
+# include <stdint.h>
+#endif
+#ifdef HAVE_UNISTD_H
+# include <unistd.h>
+#endif
+#include <assert.h>
+
+#if defined(_WIN32)
+#include <Winsock2.h>
+#endif
+
+/* SIMD kernels need x86 intrinsics plus GCC/Clang function-level target attributes and __builtin_cpu_supports()
+   Other compilers and architectures use the scalar kernels */
+#if defined(HAVE_IMMINTRIN_H) && (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+# define CCR_SIMD_X86 1
+# include <immintrin.h> /* SSE2, AVX2, and AVX-512 intrinsics */
+#endif /* !HAVE_IMMINTRIN_H */
+
+/* 3rd party vendors */
+#include "H5PLextern.h" /* HDF5 Plugin Library: H5PLget_plugin_type(), H5PLget_plugin_info() */
+
+/* Tokens and typedefs */
+#define H5Z_FILTER_BYTESHUFFLE 32772 /* NB: Not yet registered with HDF, see ccr.h */
+#define CCR_FLT_DBG_INFO 0 /* [flg] Print non-fatal debugging information */
+#define CCR_FLT_NAME "Byte Shuffle filter (vectorized HDF5 shuffle)" /* [sng] Filter name in vernacular for HDF5 messages */
+#define CCR_FLT_PRM_NBR 1 /* [nbr] Number of parameters sent to filter (in cd_params array). NB: keep identical with ccr.h:BYTESHUFFLE_FLT_PRM_NBR */
+#define CCR_FLT_PRM_PSN_DATUM_SIZE 0 /* [nbr] Ordinal position of datum_size in parameter list (cd_params array) */
+
+/* Shuffled chunks have the layout of the HDF5 shuffle filter (H5Z_FILTER_SHUFFLE):
+   First byte of every value, then second byte of every value, and so on, followed by any trailing bytes that do not fill a whole value
+   Chunks of one value, or of one-byte values, are stored unchanged
+   Unlike the HDF5 shuffle, the chunk is transposed by SSE2, AVX2, or AVX-512 kernels for 2, 4, and 8 byte values */
+
+/* Kernels transpose elm_nbr values of datum_size bytes between value order (src of forward kernel) and byte-plane order (src of reverse kernel)
+   Kernel choice (scalar, SSE2, AVX2, AVX-512) is made once by ccr_shf_cpu_dispatch() */
+typedef void
+(*ccr_shf_knl_t) /* [fnc] Shuffle or unshuffle kernel */
+(const size_t elm_nbr, /* I [nbr] Number of values */
+ const size_t datum_size, /* I [B] Bytes per value */
+ const unsigned char *src, /* I [val] Values to transpose */
+ unsigned char *dst); /* O [val] Transposed values, elm_nbr*datum_size bytes */
+
+/* Forward-declare functions before their names appear in H5Z_class2_t filter structure */
+size_t /* O [B] Number of bytes resulting after forward/reverse filter applied */
+H5Z_filter_byteshuffle /* [fnc] HDF5 Byte Shuffle Filter */
+(unsigned int flags, /* I [flg] Bitfield that encodes filter direction */
+ size_t cd_nelmts, /* I [nbr] Number of elements in filter parameter (cd_values[]) array */
+ const unsigned int cd_values[], /* I [enm] Filter parameters */
+ size_t bfr_sz_in, /* I [B] Number of bytes in input buffer (before forward/reverse filter) */
+ size_t *bfr_sz_out, /* O [B] Number of bytes in output buffer (after forward/reverse filter) */
+ void **bfr_inout); /* I/O [val] Values to shuffle or unshuffle */
+
+htri_t /* O [flg] Data meet criteria to apply filter */
+ccr_can_apply_byteshuffle /* [fnc] Callback to determine if current variable meets filter criteria */
+(hid_t dcpl, /* I [id] Dataset creation property list ID */
+ hid_t type, /* I [id] Dataset type ID */
+ hid_t space); /* I [id] Dataset space ID */
+
+htri_t /* O [flg] Filter parameters successfully modified for this variable */
+ccr_set_local_byteshuffle /* [fnc] Callback to determine and set per-variable filter parameters */
+(hid_t dcpl, /* I [id] Dataset creation property list ID */
+ hid_t type, /* I [id] Dataset type ID */
+ hid_t space); /* I [id] Dataset space ID */
+
+const H5Z_class2_t H5Z_BYTESHUFFLE[1]={{
+    H5Z_CLASS_T_VERS, /* H5Z_class_t version */
+    (H5Z_filter_t)H5Z_FILTER_BYTESHUFFLE, /* Filter ID number */
+#ifdef FILTER_DECODE_ONLY
+    0, /* [flg] Encoder availability flag */
+#else
+    1, /* [flg] Encoder availability flag */
+#endif
+    1, /* [flg] Decoder availability flag */
+    CCR_FLT_NAME, /* [sng] Filter name for debugging */
+    ccr_can_apply_byteshuffle, /* [fnc] Callback to determine if current variable meets filter criteria */
+    ccr_set_local_byteshuffle, /* [fnc] Callback to determine and set per-variable filter parameters */
+    (H5Z_func_t)H5Z_filter_byteshuffle, /* [fnc] Function to implement filter */
+  }}; /* !H5Z_BYTESHUFFLE */
+
+void
+ccr_shf_cpu_dispatch /* [fnc] Select fastest shuffle kernels supported by this CPU */
+(void);
+
+/* Kernels selected by ccr_shf_cpu_dispatch(), NULL until first dispatch */
+static ccr_shf_knl_t ccr_shf_fwd_knl=NULL; /* [fnc] Shuffle kernel */
+static ccr_shf_knl_t ccr_shf_rev_knl=NULL; /* [fnc] Unshuffle kernel */
+static const char *ccr_shf_knl_nm="none"; /* [sng] Name of selected kernels, for debugging */
+
+/* Function definitions */
+H5PL_type_t /* O [enm] Plugin type */
+H5PLget_plugin_type /* [fnc] Provide plug-in type provided by this shared library */
+(void)
+{ /* Purpose: Describe plug-in type provided by this shared library
+     The HDF5 plugin mechanism usually calls this function after an application calls H5Pset_filter(), or when the data to which this filter will be applied are first read */
+  return H5PL_TYPE_FILTER;
+} /* !H5PLget_plugin_type() */
+
+const void * /* O [enm] */
+H5PLget_plugin_info /* [fnc] Return structure */
+(void)
+{ /* Purpose: Provide structure that defines Byte Shuffle filter so the filter may be dynamically registered with the plugin mechanism
+     The HDF5 plugin mechanism usually calls this function after an application calls H5Pset_filter(), or when the data to which this filter will be applied are first read */
+  ccr_shf_cpu_dispatch();
+  return H5Z_BYTESHUFFLE;
+} /* !H5PLget_plugin_info() */
+
+size_t /* O [B] Number of bytes resulting after forward/reverse filter applied */
+H5Z_filter_byteshuffle /* [fnc] HDF5 Byte Shuffle Filter */
+(unsigned int flags, /* I [flg] Bitfield that encodes filter direction */
+ size_t cd_nelmts, /* I [nbr] Number of elements in filter parameter (cd_values[]) array */
+ const unsigned int cd_values[], /* I [enm] Filter parameters */
+ size_t bfr_sz_in, /* I [B] Number of bytes in input buffer (before forward/reverse filter) */
+ size_t *bfr_sz_out, /* O [B] Number of bytes in output buffer (after forward/reverse filter) */
+ void **bfr_inout) /* I/O [val] Values to shuffle or unshuffle */
+{
+  /* Purpose: Dynamic filter invoked by HDF5 to gather the bytes of each significance into contiguous planes before compression, and to restore values on read
+     Shuffled chunks are byte-for-byte identical to those of the HDF5 shuffle filter, so a compressor that follows sees the same data at a fraction of the cost
+     Filter is lossless and applies to values of any size */
+
+  const char fnc_nm[]="H5Z_filter_byteshuffle()"; /* [sng] Function name */
+
+  size_t datum_size; /* [B] Bytes per unfiltered data value */
+  size_t elm_nbr; /* [nbr] Number of values in buffer */
+  size_t lft_nbr; /* [B] Trailing bytes that do not fill a whole value */
+  unsigned char *bfr_new=NULL; /* [ptr] New buffer */
+
+  if(!ccr_shf_fwd_knl) ccr_shf_cpu_dispatch();
+
+  if(cd_nelmts < CCR_FLT_PRM_NBR){
+    (void)fprintf(stderr,"ERROR: \"%s\" filter function %s reports %lu parameters, needs %d\n",CCR_FLT_NAME,fnc_nm,(unsigned long)cd_nelmts,CCR_FLT_PRM_NBR);
+    return 0;
+  } /* !cd_nelmts */
+  datum_size=cd_values[CCR_FLT_PRM_PSN_DATUM_SIZE];
+  if(datum_size == 0){
+    (void)fprintf(stderr,"ERROR: \"%s\" filter function %s reports datum size = 0 B is invalid\n",CCR_FLT_NAME,fnc_nm);
+    return 0;
+  } /* !datum_size */
+
+  /* Nothing to transpose, so leave buffer alone, as HDF5 shuffle does */
+  elm_nbr=bfr_sz_in/datum_size;
+  if(datum_size == 1 || elm_nbr <= 1){
+    *bfr_sz_out=bfr_sz_in;
+    return bfr_sz_in;
+  } /* !elm_nbr */
+  lft_nbr=bfr_sz_in-elm_nbr*datum_size;
+
+  if(!(bfr_new=(unsigned char *)malloc(bfr_sz_in))){
+    (void)fprintf(stderr,"ERROR: \"%s\" filter function %s unable to allocate %lu B for %s data\n",CCR_FLT_NAME,fnc_nm,(unsigned long)bfr_sz_in,(flags & H5Z_FLAG_REVERSE) ? "unshuffled" : "shuffled");
+    return 0;
+  } /* !bfr_new */
+
+  if(CCR_FLT_DBG_INFO) (void)fprintf(stderr,"INFO: %s %s %lu values of datum size = %lu B with %s kernel\n",fnc_nm,(flags & H5Z_FLAG_REVERSE) ? "unshuffles" : "shuffles",(unsigned long)elm_nbr,(unsigned long)datum_size,ccr_shf_knl_nm);
+
+  if(flags & H5Z_FLAG_REVERSE) ccr_shf_rev_knl(elm_nbr,datum_size,(const unsigned char *)(*bfr_inout),bfr_new);
+  else ccr_shf_fwd_knl(elm_nbr,datum_size,(const unsigned char *)(*bfr_inout),bfr_new);
+  if(lft_nbr > 0) memcpy(bfr_new+elm_nbr*datum_size,(const unsigned char *)(*bfr_inout)+elm_nbr*datum_size,lft_nbr);
+
+  free(*bfr_inout);
+  *bfr_inout=bfr_new;
+  *bfr_sz_out=bfr_sz_in;
+  return bfr_sz_in;
+
+} /* !H5Z_filter_byteshuffle() */
+
+htri_t /* O [flg] Data meet criteria to apply filter */
+ccr_can_apply_byteshuffle /* [fnc] Callback to determine if current variable meets filter criteria */
+(hid_t dcpl, /* I [id] Dataset creation property list ID */
+ hid_t type, /* I [id] Dataset type ID */
+ hid_t space) /* I [id] Dataset space ID */
+{
+  /* Data space must be simple, i.e., a multi-dimensional array */
+  if(H5Sis_simple(space) <= 0){
+    fprintf(stderr,"WARNING: Cannot apply filter \"%s\" filter because data space is not simple.\n",CCR_FLT_NAME);
+    return 0;
+  } /* !H5Sis_simple(space) */
+
+  /* Filter can be applied */
+  return 1;
+} /* !ccr_can_apply_byteshuffle() */
+
+htri_t /* O [flg] Filter parameters successfully modified for this variable */
+ccr_set_local_byteshuffle /* [fnc] Callback to determine and set per-variable filter parameters */
+(hid_t dcpl, /* I [id] Dataset creation property list ID */
+ hid_t type, /* I [id] Dataset type ID */
+ hid_t space) /* I [id] Dataset space ID */
+{
+  const char fnc_nm[]="ccr_set_local_byteshuffle()"; /* [sng] Function name */
+
+  herr_t rcd; /* [flg] Return code */
+
+  /* Initialize filter parameters with default values */
+  unsigned int ccr_flt_prm[CCR_FLT_PRM_NBR]={0};
+
+  /* Initialize output variables for call to H5Pget_filter_by_id() */
+  unsigned int flags=0;
+  size_t cd_nelmts=CCR_FLT_PRM_NBR;
+  unsigned int *cd_values=ccr_flt_prm;
+
+  /* Retrieve parameters specified by user
+     https://support.hdfgroup.org/HDF5/doc/RM/RM_H5P.html#FunctionIndex
+     Ignore name and filter_config by setting last three arguments to 0/NULL */
+  rcd=H5Pget_filter_by_id(dcpl,H5Z_FILTER_BYTESHUFFLE,&flags,&cd_nelmts,cd_values,0,NULL,NULL);
+  if(rcd < 0){
+    (void)fprintf(stderr,"ERROR: %s filter callback function %s reports H5Pget_filter_by_id() failed to get filter flags and parameters for current variable\n",CCR_FLT_NAME,fnc_nm);
+    return 0;
+  } /* !rcd */
+
+  /* Datum size is the only parameter, as for HDF5 shuffle */
+  size_t datum_size; /* [B] Bytes per data value */
+  datum_size=H5Tget_size(type);
+  if(datum_size <= 0){
+    (void)fprintf(stderr,"ERROR: %s filter callback function %s reports H5Tget_size() returned invalid datum size = %lu B\n",CCR_FLT_NAME,fnc_nm,datum_size);
+    return 0;
+  } /* !datum_size */
+  ccr_flt_prm[CCR_FLT_PRM_PSN_DATUM_SIZE]=(unsigned int)datum_size;
+
+  /* Update invoked filter with generic parameters as invoked with variable-specific values */
+  rcd=H5Pmodify_filter(dcpl,H5Z_FILTER_BYTESHUFFLE,flags,CCR_FLT_PRM_NBR,cd_values);
+  if(rcd < 0){
+    (void)fprintf(stderr,"ERROR: \"%s\" filter callback function %s reports H5Pmodify_filter() unable to modify filter parameters\n",CCR_FLT_NAME,fnc_nm);
+    return 0;
+  } /* !rcd */
+
+  return 1;
+} /* !ccr_set_local_byteshuffle() */
+
+/* Scalar kernels define the layout, SIMD kernels reproduce it byte-for-byte
+   SIMD kernels transpose whole blocks and pass the remaining values, from elm_srt on, to the scalar loops */
+
+static void
+ccr_shf_fwd_rng /* [fnc] Shuffle values elm_srt to elm_nbr-1 */
+(const size_t elm_srt, /* I [idx] First value to shuffle */
+ const size_t elm_nbr, /* I [nbr] Number of values */
+ const size_t datum_size, /* I [B] Bytes per value */
+ const unsigned char *src, /* I [val] Values */
+ unsigned char *dst) /* O [val] Byte planes */
+{
+  size_t byt_idx; /* [idx] Byte within value */
+  size_t idx;
+
+  for(byt_idx=0;byt_idx<datum_size;byt_idx++){
+    unsigned char *pln=dst+byt_idx*elm_nbr; /* [ptr] Byte plane */
+    for(idx=elm_srt;idx<elm_nbr;idx++) pln[idx]=src[idx*datum_size+byt_idx];
+  } /* !byt_idx */
+} /* !ccr_shf_fwd_rng() */
+
+static void
+ccr_shf_rev_rng /* [fnc] Unshuffle values elm_srt to elm_nbr-1 */
+(const size_t elm_srt, /* I [idx] First value to unshuffle */
+ const size_t elm_nbr, /* I [nbr] Number of values */
+ const size_t datum_size, /* I [B] Bytes per value */
+ const unsigned char *src, /* I [val] Byte planes */
+ unsigned char *dst) /* O [val] Values */
+{
+  size_t byt_idx; /* [idx] Byte within value */
+  size_t idx;
+
+  for(byt_idx=0;byt_idx<datum_size;byt_idx++){
+    const unsigned char *pln=src+byt_idx*elm_nbr; /* [ptr] Byte plane */
+    for(idx=elm_srt;idx<elm_nbr;idx++) dst[idx*datum_size+byt_idx]=pln[idx];
+  } /* !byt_idx */
+} /* !ccr_shf_rev_rng() */
+
+static void
+ccr_shf_fwd_scl /* [fnc] Shuffle values */
+(const size_t elm_nbr, /* I [nbr] Number of values */
+ const size_t datum_size, /* I [B] Bytes per value */
+ const unsigned char *src, /* I [val] Values */
+ unsigned char *dst) /* O [val] Byte planes */
+{
+  ccr_shf_fwd_rng(0,elm_nbr,datum_size,src,dst);
+} /* !ccr_shf_fwd_scl() */
+
+static void
+ccr_shf_rev_scl /* [fnc] Unshuffle values */
+(const size_t elm_nbr, /* I [nbr] Number of values */
+ const size_t datum_size, /* I [B] Bytes per value */
+ const unsigned char *src, /* I [val] Byte planes */
+ unsigned char *dst) /* O [val] Values */
+{
+  ccr_shf_rev_rng(0,elm_nbr,datum_size,src,dst);
+} /* !ccr_shf_rev_scl() */
+
+#ifdef CCR_SIMD_X86
+/* Vector kernels treat a block of datum_size vectors (one vector width of values) as a byte stream
+   Shuffle splits the stream into its even bytes followed by its odd bytes, log2(datum_size) times, which leaves byte b of value e at b*width+e
+   Even and odd bytes of a vector pair come from one saturating pack each, of the masked low bytes and of the shifted high bytes of 16-bit lanes
+   Unshuffle interleaves the two halves of the stream with byte unpacks, log2(datum_size) times
+   AVX2 and AVX-512 packs and unpacks work within 128-bit lanes, so a 64-bit permute puts lanes in stream order
+   Other datum sizes go to scalar kernels */
+
+__attribute__((target("sse2")))
+static void
+ccr_shf_fwd_sse2 /* [fnc] Shuffle values with SSE2 */
+(const size_t elm_nbr, /* I [nbr] Number of values */
+ const size_t datum_size, /* I [B] Bytes per value */
+ const unsigned char *src, /* I [val] Values */
+ unsigned char *dst) /* O [val] Byte planes */
+{
+  const size_t hlf=datum_size/2; /* [nbr] Vectors in each half of stream */
+  const __m128i lo_msk=_mm_set1_epi16(0x00FF); /* [msk] Low byte of 16-bit lanes */
+  __m128i vct[8],tmp[8]; /* [val] Block, and block after a split */
+  size_t stp; /* [nbr] Splits done, as power of two */
+  size_t idx;
+  size_t vct_idx;
+
+  if(datum_size != 2 && datum_size != 4 && datum_size != 8){
+    ccr_shf_fwd_scl(elm_nbr,datum_size,src,dst);
+    return;
+  } /* !datum_size */
+  for(idx=0;idx+16<=elm_nbr;idx+=16){
+    for(vct_idx=0;vct_idx<datum_size;vct_idx++) vct[vct_idx]=_mm_loadu_si128((const __m128i *)(src+idx*datum_size+16*vct_idx));
+    for(stp=1;stp<datum_size;stp*=2){
+      for(vct_idx=0;vct_idx<hlf;vct_idx++){
+	const __m128i a=vct[2*vct_idx],b=vct[2*vct_idx+1];
+	tmp[vct_idx]=_mm_packus_epi16(_mm_and_si128(a,lo_msk),_mm_and_si128(b,lo_msk));
+	tmp[vct_idx+hlf]=_mm_packus_epi16(_mm_srli_epi16(a,8),_mm_srli_epi16(b,8));
+      } /* !vct_idx */
+      memcpy(vct,tmp,datum_size*sizeof(__m128i));
+    } /* !stp */
+    for(vct_idx=0;vct_idx<datum_size;vct_idx++) _mm_storeu_si128((__m128i *)(dst+vct_idx*elm_nbr+idx),vct[vct_idx]);
+  } /* !idx */
+  ccr_shf_fwd_rng(idx,elm_nbr,datum_size,src,dst);
+} /* !ccr_shf_fwd_sse2() */
+
+__attribute__((target("sse2")))
+static void
+ccr_shf_rev_sse2 /* [fnc] Unshuffle values with SSE2 */
+(const size_t elm_nbr, /* I [nbr] Number of values */
+ const size_t datum_size, /* I [B] Bytes per value */
+ const unsigned char *src, /* I [val] Byte planes */
+ unsigned char *dst) /* O [val] Values */
+{
+  const size_t hlf=datum_size/2; /* [nbr] Vectors in each half of stream */
+  __m128i vct[8],tmp[8]; /* [val] Block, and block after an interleave */
+  size_t stp; /* [nbr] Interleaves done, as power of two */
+  size_t idx;
+  size_t vct_idx;
+
+  if(datum_size != 2 && datum_size != 4 && datum_size != 8){
+    ccr_shf_rev_scl(elm_nbr,datum_size,src,dst);
+    return;
+  } /* !datum_size */
+  for(idx=0;idx+16<=elm_nbr;idx+=16){
+    for(vct_idx=0;vct_idx<datum_size;vct_idx++) vct[vct_idx]=_mm_loadu_si128((const __m128i *)(src+vct_idx*elm_nbr+idx));
+    for(stp=1;stp<datum_size;stp*=2){
+      for(vct_idx=0;vct_idx<hlf;vct_idx++){
+	tmp[2*vct_idx]=_mm_unpacklo_epi8(vct[vct_idx],vct[vct_idx+hlf]);
+	tmp[2*vct_idx+1]=_mm_unpackhi_epi8(vct[vct_idx],vct[vct_idx+hlf]);
+      } /* !vct_idx */
+      memcpy(vct,tmp,datum_size*sizeof(__m128i));
+    } /* !stp */
+    for(vct_idx=0;vct_idx<datum_size;vct_idx++) _mm_storeu_si128((__m128i *)(dst+idx*datum_size+16*vct_idx),vct[vct_idx]);
+  } /* !idx */
+  ccr_shf_rev_rng(idx,elm_nbr,datum_size,src,dst);
+} /* !ccr_shf_rev_sse2() */
+
+__attribute__((target("avx2")))
+static void
+ccr_shf_fwd_avx2 /* [fnc] Shuffle values with AVX2 */
+(const size_t elm_nbr, /* I [nbr] Number of values */
+ const size_t datum_size, /* I [B] Bytes per value */
+ const unsigned char *src, /* I [val] Values */
+ unsigned char *dst) /* O [val] Byte planes */
+{
+  const size_t hlf=datum_size/2; /* [nbr] Vectors in each half of stream */
+  const __m256i lo_msk=_mm256_set1_epi16(0x00FF); /* [msk] Low byte of 16-bit lanes */
+  __m256i vct[8],tmp[8]; /* [val] Block, and block after a split */
+  size_t stp; /* [nbr] Splits done, as power of two */
+  size_t idx;
+  size_t vct_idx;
+
+  if(datum_size != 2 && datum_size != 4 && datum_size != 8){
+    ccr_shf_fwd_scl(elm_nbr,datum_size,src,dst);
+    return;
+  } /* !datum_size */
+  for(idx=0;idx+32<=elm_nbr;idx+=32){
+    for(vct_idx=0;vct_idx<datum_size;vct_idx++) vct[vct_idx]=_mm256_loadu_si256((const __m256i *)(src+idx*datum_size+32*vct_idx));
+    for(stp=1;stp<datum_size;stp*=2){
+      for(vct_idx=0;vct_idx<hlf;vct_idx++){
+	const __m256i a=vct[2*vct_idx],b=vct[2*vct_idx+1];
+	tmp[vct_idx]=_mm256_permute4x64_epi64(_mm256_packus_epi16(_mm256_and_si256(a,lo_msk),_mm256_and_si256(b,lo_msk)),0xD8);
+	tmp[vct_idx+hlf]=_mm256_permute4x64_epi64(_mm256_packus_epi16(_mm256_srli_epi16(a,8),_mm256_srli_epi16(b,8)),0xD8);
+      } /* !vct_idx */
+      memcpy(vct,tmp,datum_size*sizeof(__m256i));
+    } /* !stp */
+    for(vct_idx=0;vct_idx<datum_size;vct_idx++) _mm256_storeu_si256((__m256i *)(dst+vct_idx*elm_nbr+idx),vct[vct_idx]);
+  } /* !idx */
+  ccr_shf_fwd_rng(idx,elm_nbr,datum_size,src,dst);
+} /* !ccr_shf_fwd_avx2() */
+
+__attribute__((target("avx2")))
+static void
+ccr_shf_rev_avx2 /* [fnc] Unshuffle values with AVX2 */
+(const size_t elm_nbr, /* I [nbr] Number of values */
+ const size_t datum_size, /* I [B] Bytes per value */
+ const unsigned char *src, /* I [val] Byte planes */
+ unsigned char *dst) /* O [val] Values */
+{
+  const size_t hlf=datum_size/2; /* [nbr] Vectors in each half of stream */
+  __m256i vct[8],tmp[8]; /* [val] Block, and block after an interleave */
+  size_t stp; /* [nbr] Interleaves done, as power of two */
+  size_t idx;
+  size_t vct_idx;
+
+  if(datum_size != 2 && datum_size != 4 && datum_size != 8){
+    ccr_shf_rev_scl(elm_nbr,datum_size,src,dst);
+    return;
+  } /* !datum_size */
+  for(idx=0;idx+32<=elm_nbr;idx+=32){
+    for(vct_idx=0;vct_idx<datum_size;vct_idx++) vct[vct_idx]=_mm256_loadu_si256((const __m256i *)(src+vct_idx*elm_nbr+idx));
+    for(stp=1;stp<datum_size;stp*=2){
+      for(vct_idx=0;vct_idx<hlf;vct_idx++){
+	const __m256i evn=_mm256_permute4x64_epi64(vct[vct_idx],0xD8);
+	const __m256i odd=_mm256_permute4x64_epi64(vct[vct_idx+hlf],0xD8);
+	tmp[2*vct_idx]=_mm256_unpacklo_epi8(evn,odd);
+	tmp[2*vct_idx+1]=_mm256_unpackhi_epi8(evn,odd);
+      } /* !vct_idx */
+      memcpy(vct,tmp,datum_size*sizeof(__m256i));
+    } /* !stp */
+    for(vct_idx=0;vct_idx<datum_size;vct_idx++) _mm256_storeu_si256((__m256i *)(dst+idx*datum_size+32*vct_idx),vct[vct_idx]);
+  } /* !idx */
+  ccr_shf_rev_rng(idx,elm_nbr,datum_size,src,dst);
+} /* !ccr_shf_rev_avx2() */
+
+__attribute__((target("avx512bw")))
+static void
+ccr_shf_fwd_avx512 /* [fnc] Shuffle values with AVX-512 */
+(const size_t elm_nbr, /* I [nbr] Number of values */
+ const size_t datum_size, /* I [B] Bytes per value */
+ const unsigned char *src, /* I [val] Values */
+ unsigned char *dst) /* O [val] Byte planes */
+{
+  const size_t hlf=datum_size/2; /* [nbr] Vectors in each half of stream */
+  const __m512i lo_msk=_mm512_set1_epi16(0x00FF); /* [msk] Low byte of 16-bit lanes */
+  const __m512i prm=_mm512_set_epi64(7,5,3,1,6,4,2,0); /* [idx] 64-bit words of first vector, then of second */
+  __m512i vct[8],tmp[8]; /* [val] Block, and block after a split */
+  size_t stp; /* [nbr] Splits done, as power of two */
+  size_t idx;
+  size_t vct_idx;
+
+  if(datum_size != 2 && datum_size != 4 && datum_size != 8){
+    ccr_shf_fwd_scl(elm_nbr,datum_size,src,dst);
+    return;
+  } /* !datum_size */
+  for(idx=0;idx+64<=elm_nbr;idx+=64){
+    for(vct_idx=0;vct_idx<datum_size;vct_idx++) vct[vct_idx]=_mm512_loadu_si512((const void *)(src+idx*datum_size+64*vct_idx));
+    for(stp=1;stp<datum_size;stp*=2){
+      for(vct_idx=0;vct_idx<hlf;vct_idx++){
+	const __m512i a=vct[2*vct_idx],b=vct[2*vct_idx+1];
+	tmp[vct_idx]=_mm512_permutexvar_epi64(prm,_mm512_packus_epi16(_mm512_and_si512(a,lo_msk),_mm512_and_si512(b,lo_msk)));
+	tmp[vct_idx+hlf]=_mm512_permutexvar_epi64(prm,_mm512_packus_epi16(_mm512_srli_epi16(a,8),_mm512_srli_epi16(b,8)));
+      } /* !vct_idx */
+      memcpy(vct,tmp,datum_size*sizeof(__m512i));
+    } /* !stp */
+    for(vct_idx=0;vct_idx<datum_size;vct_idx++) _mm512_storeu_si512((void *)(dst+vct_idx*elm_nbr+idx),vct[vct_idx]);
+  } /* !idx */
+  ccr_shf_fwd_rng(idx,elm_nbr,datum_size,src,dst);
+} /* !ccr_shf_fwd_avx512() */
+
+__attribute__((target("avx512bw")))
+static void
+ccr_shf_rev_avx512 /* [fnc] Unshuffle values with AVX-512 */
+(const size_t elm_nbr, /* I [nbr] Number of values */
+ const size_t datum_size, /* I [B] Bytes per value */
+ const unsigned char *src, /* I [val] Byte planes */
+ unsigned char *dst) /* O [val] Values */
+{
+  const size_t hlf=datum_size/2; /* [nbr] Vectors in each half of stream */
+  const __m512i prm=_mm512_set_epi64(7,3,6,2,5,1,4,0); /* [idx] 64-bit words i and i+4 into 128-bit lane i */
+  __m512i vct[8],tmp[8]; /* [val] Block, and block after an interleave */
+  size_t stp; /* [nbr] Interleaves done, as power of two */
+  size_t idx;
+  size_t vct_idx;
+
+  if(datum_size != 2 && datum_size != 4 && datum_size != 8){
+    ccr_shf_rev_scl(elm_nbr,datum_size,src,dst);
+    return;
+  } /* !datum_size */
+  for(idx=0;idx+64<=elm_nbr;idx+=64){
+    for(vct_idx=0;vct_idx<datum_size;vct_idx++) vct[vct_idx]=_mm512_loadu_si512((const void *)(src+vct_idx*elm_nbr+idx));
+    for(stp=1;stp<datum_size;stp*=2){
+      for(vct_idx=0;vct_idx<hlf;vct_idx++){
+	const __m512i evn=_mm512_permutexvar_epi64(prm,vct[vct_idx]);
+	const __m512i odd=_mm512_permutexvar_epi64(prm,vct[vct_idx+hlf]);
+	tmp[2*vct_idx]=_mm512_unpacklo_epi8(evn,odd);
+	tmp[2*vct_idx+1]=_mm512_unpackhi_epi8(evn,odd);
+      } /* !vct_idx */
+      memcpy(vct,tmp,datum_size*sizeof(__m512i));
+    } /* !stp */
+    for(vct_idx=0;vct_idx<datum_size;vct_idx++) _mm512_storeu_si512((void *)(dst+idx*datum_size+64*vct_idx),vct[vct_idx]);
+  } /* !idx */
+  ccr_shf_rev_rng(idx,elm_nbr,datum_size,src,dst);
+} /* !ccr_shf_rev_avx512() */
+#endif /* !CCR_SIMD_X86 */
+
+void
+ccr_shf_cpu_dispatch /* [fnc] Select fastest shuffle kernels supported by this CPU */
+(void)
+{
+  /* Purpose: Query CPUID (through compiler builtins that also check OS register-state support) and point kernels at widest supported instruction set
+     Results are identical for all kernels, only speed differs */
+  ccr_shf_fwd_knl=ccr_shf_fwd_scl;
+  ccr_shf_rev_knl=ccr_shf_rev_scl;
+  ccr_shf_knl_nm="scalar";
+#ifdef CCR_SIMD_X86
+  __builtin_cpu_init();
+  if(__builtin_cpu_supports("avx512bw")){
+    ccr_shf_fwd_knl=ccr_shf_fwd_avx512;
+    ccr_shf_rev_knl=ccr_shf_rev_avx512;
+    ccr_shf_knl_nm="AVX-512";
+  }else if(__builtin_cpu_supports("avx2")){
+    ccr_shf_fwd_knl=ccr_shf_fwd_avx2;
+    ccr_shf_rev_knl=ccr_shf_rev_avx2;
+    ccr_shf_knl_nm="AVX2";
+  }else if(__builtin_cpu_supports("sse2")){
+    ccr_shf_fwd_knl=ccr_shf_fwd_sse2;
+    ccr_shf_rev_knl=ccr_shf_rev_sse2;
+    ccr_shf_knl_nm="SSE2";
+  } /* !__builtin_cpu_supports() */
+#endif /* !CCR_SIMD_X86 */
+  if(CCR_FLT_DBG_INFO) (void)fprintf(stderr,"INFO: \"%s\" filter selected %s kernels\n",CCR_FLT_NAME,ccr_shf_knl_nm);
+} /* !ccr_shf_cpu_dispatch() */
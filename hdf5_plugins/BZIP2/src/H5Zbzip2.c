@@ -84,6 +84,15 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "bzlib.h"
 
+/* OpenMP compresses and decompresses the streams of a multi-stream
+   chunk on a thread pool (opt-in, see bzip2_thread_count()). */
+#ifdef _OPENMP
+# include <omp.h>
+#endif
+#ifdef HAVE_PTHREAD_H
+# include <pthread.h> /* thread-specific keys that own the per-thread arena */
+#endif
+
 size_t H5Z_filter_bzip2(unsigned int flags, size_t cd_nelmts,
                      const unsigned int cd_values[], size_t nbytes,
                      size_t *buf_size, void **buf);
@@ -98,6 +107,28 @@ size_t H5Z_filter_bzip2(unsigned int flags, size_t cd_nelmts,
  */
 #define H5Z_FILTER_BZIP2 307
 
+/* cd_values[1] selects the chunk format. Files written by other
+   bzip2 filters have no cd_values[1], and use a single stream. */
+#define BZIP2_FORMAT_SINGLE 0      /* one bzip2 stream per chunk */
+#define BZIP2_FORMAT_MULTISTREAM 1 /* independent streams of level*100k bytes */
+#define BZIP2_FORMAT_SIZED 2       /* versioned header with the size, one stream */
+
+/* A multi-stream chunk starts with its uncompressed size, the
+   uncompressed size of every stream but the last, and then the
+   compressed size of each stream, all big-endian 32-bit integers.
+   The streams follow in order. The header does not start with "BZh",
+   so a single-stream reader fails cleanly on it. */
+#define BZIP2_MS_HDR_SIZE 8
+
+/* A sized chunk starts with "CBZ", a version byte, and its
+   uncompressed size as a big-endian 32-bit integer, so readers
+   allocate the output once. Readers reject versions they do not
+   know. */
+#define BZIP2_SZ_HDR_SIZE 8
+#define BZIP2_SZ_VERSION 1
+
+#define BZIP2_THREAD_COUNT_ENV "CCR_THR_NBR" /* number of threads, default 1 */
+
 const H5Z_class2_t H5Z_BZIP2[1] = {{
     H5Z_CLASS_T_VERS,       /* H5Z_class_t version */
     (H5Z_filter_t)H5Z_FILTER_BZIP2,         /* Filter id number             */
@@ -117,15 +148,490 @@ const H5Z_class2_t H5Z_BZIP2[1] = {{
 H5PL_type_t   H5PLget_plugin_type(void) {return H5PL_TYPE_FILTER;}
 const void *H5PLget_plugin_info(void) {return H5Z_BZIP2;}
 
+/* Per-thread arena for libbz2 state
+   Each compression allocates about 7.5 MB of state at level 9, and each
+   decompression about 3.7 MB, which libbz2 would otherwise malloc()
+   and free() for every chunk (and every stream). The arena hands the
+   same blocks back to the next call on the same thread. It is owned
+   by a thread-specific key, so it is freed when its thread exits, and
+   kept on a mutex-protected list of live arenas, so unloading the
+   plugin frees the arenas of threads that are still running.
+   Without POSIX threads libbz2 uses malloc() and free(). */
+#ifdef HAVE_PTHREAD_H
+#define BZIP2_ARENA_SLOTS 4 /* libbz2 holds at most 4 blocks at once */
+
+typedef struct bzip2_arena {
+  void *ptr[BZIP2_ARENA_SLOTS];
+  size_t size[BZIP2_ARENA_SLOTS];
+  int used[BZIP2_ARENA_SLOTS];
+  struct bzip2_arena *next; /* next live arena in bzip2_arena_list */
+} bzip2_arena;
+
+static pthread_key_t bzip2_arena_key;
+static pthread_once_t bzip2_arena_once = PTHREAD_ONCE_INIT;
+static int bzip2_arena_key_ok = 0;
+static pthread_mutex_t bzip2_arena_mutex = PTHREAD_MUTEX_INITIALIZER;
+static bzip2_arena *bzip2_arena_list = NULL; /* every live arena */
+
+/* Free an arena already removed from bzip2_arena_list. */
+static void bzip2_arena_free(bzip2_arena *arena)
+{
+  int i;
+
+  if (arena == NULL)
+    return;
+  for (i = 0; i < BZIP2_ARENA_SLOTS; i++)
+    free(arena->ptr[i]);
+  free(arena);
+}
+
+/* Destructor of bzip2_arena_key, called as each thread that used the
+   filter exits. Frees the arena only if still listed, since
+   bzip2_arena_fin() may have freed it already. */
+static void bzip2_arena_destroy(void *arenap)
+{
+  bzip2_arena **link;
+  int found = 0;
+
+  (void)pthread_mutex_lock(&bzip2_arena_mutex);
+  for (link = &bzip2_arena_list; *link != NULL; link = &(*link)->next)
+    if (*link == arenap) {
+      *link = (*link)->next;
+      found = 1;
+      break;
+    }
+  (void)pthread_mutex_unlock(&bzip2_arena_mutex);
+  if (found)
+    bzip2_arena_free(arenap);
+}
+
+static void bzip2_arena_key_make(void)
+{
+  if (!pthread_key_create(&bzip2_arena_key, bzip2_arena_destroy))
+    bzip2_arena_key_ok = 1;
+}
+
+/* Return the calling thread's arena, creating it if needed, or NULL
+   to use malloc() and free(). */
+static bzip2_arena *bzip2_arena_get(void)
+{
+  bzip2_arena *arena;
+
+  (void)pthread_once(&bzip2_arena_once, bzip2_arena_key_make);
+  if (!bzip2_arena_key_ok)
+    return NULL;
+  arena = pthread_getspecific(bzip2_arena_key);
+  if (arena != NULL)
+    return arena;
+  if ((arena = calloc(1, sizeof(*arena))) == NULL)
+    return NULL;
+  if (pthread_setspecific(bzip2_arena_key, arena)) {
+    free(arena);
+    return NULL;
+  }
+  (void)pthread_mutex_lock(&bzip2_arena_mutex);
+  arena->next = bzip2_arena_list;
+  bzip2_arena_list = arena;
+  (void)pthread_mutex_unlock(&bzip2_arena_mutex);
+  return arena;
+}
+
+/* bzalloc(): the smallest free block that fits, else a free slot
+   (re)filled to this size, else plain malloc(). */
+static void *bzip2_arena_alloc(void *opaque, int items, int size)
+{
+  bzip2_arena *arena = opaque;
+  size_t len = (size_t)items * (size_t)size;
+  int i, pick = -1;
+
+  for (i = 0; i < BZIP2_ARENA_SLOTS; i++)
+    if (!arena->used[i] && arena->ptr[i] != NULL && arena->size[i] >= len &&
+        (pick < 0 || arena->size[i] < arena->size[pick]))
+      pick = i;
+  if (pick < 0) {
+    for (i = 0; i < BZIP2_ARENA_SLOTS; i++)
+      if (!arena->used[i] && (pick < 0 || arena->ptr[i] == NULL))
+        pick = i;
+    if (pick < 0)
+      return malloc(len);
+    free(arena->ptr[pick]);
+    arena->size[pick] = 0;
+    if ((arena->ptr[pick] = malloc(len)) == NULL)
+      return NULL;
+    arena->size[pick] = len;
+  }
+  arena->used[pick] = 1;
+  return arena->ptr[pick];
+}
+
+/* bzfree(): keep arena blocks for the next call. */
+static void bzip2_arena_release(void *opaque, void *ptr)
+{
+  bzip2_arena *arena = opaque;
+  int i;
+
+  for (i = 0; i < BZIP2_ARENA_SLOTS; i++)
+    if (arena->ptr[i] == ptr) {
+      arena->used[i] = 0;
+      return;
+    }
+  free(ptr);
+}
+
+#if defined(__GNUC__) || defined(__clang__)
+static void bzip2_arena_fin(void) __attribute__((destructor));
+#endif
+/* Delete the key, so threads that outlive the plugin do not call
+   bzip2_arena_destroy() after its code is unmapped, then free the
+   arenas of all threads. */
+static void bzip2_arena_fin(void)
+{
+  bzip2_arena *arena;
+
+  if (!bzip2_arena_key_ok)
+    return;
+  (void)pthread_key_delete(bzip2_arena_key);
+  bzip2_arena_key_ok = 0;
+  (void)pthread_mutex_lock(&bzip2_arena_mutex);
+  while ((arena = bzip2_arena_list) != NULL) {
+    bzip2_arena_list = arena->next;
+    bzip2_arena_free(arena);
+  }
+  (void)pthread_mutex_unlock(&bzip2_arena_mutex);
+}
+#endif /* HAVE_PTHREAD_H */
+
+/* Point a stream at the calling thread's arena, if any. */
+static void bzip2_stream_init(bz_stream *stream)
+{
+  memset(stream, 0, sizeof(*stream));
+#ifdef HAVE_PTHREAD_H
+  stream->opaque = bzip2_arena_get();
+  if (stream->opaque != NULL) {
+    stream->bzalloc = bzip2_arena_alloc;
+    stream->bzfree = bzip2_arena_release;
+  }
+#endif
+}
+
+/* Compress inlen bytes at in as one bzip2 stream into out, which has
+   room for *outlen bytes. Returns a BZ_ code, and the compressed size
+   in *outlen. */
+static int bzip2_compress_stream(char *out, unsigned int *outlen,
+                                 const char *in, unsigned int inlen,
+                                 int blockSize100k)
+{
+  bz_stream stream;
+  int ret;
+
+  bzip2_stream_init(&stream);
+  ret = BZ2_bzCompressInit(&stream, blockSize100k, 0, 0);
+  if (ret != BZ_OK)
+    return ret;
+  stream.next_in = (char *)in;
+  stream.avail_in = inlen;
+  stream.next_out = out;
+  stream.avail_out = *outlen;
+  ret = BZ2_bzCompress(&stream, BZ_FINISH);
+  if (ret == BZ_STREAM_END) {
+    *outlen -= stream.avail_out;
+    ret = BZ_OK;
+  } else if (ret == BZ_FINISH_OK) {
+    ret = BZ_OUTBUFF_FULL;
+  }
+  BZ2_bzCompressEnd(&stream);
+  return ret;
+}
+
+/* Decompress the bzip2 stream of inlen bytes at in into exactly
+   outlen bytes at out. Returns a BZ_ code. */
+static int bzip2_decompress_stream(char *out, unsigned int outlen,
+                                   const char *in, unsigned int inlen)
+{
+  bz_stream stream;
+  int ret;
+
+  bzip2_stream_init(&stream);
+  ret = BZ2_bzDecompressInit(&stream, 0, 0);
+  if (ret != BZ_OK)
+    return ret;
+  stream.next_in = (char *)in;
+  stream.avail_in = inlen;
+  stream.next_out = out;
+  stream.avail_out = outlen;
+  ret = BZ2_bzDecompress(&stream);
+  if (ret == BZ_STREAM_END)
+    ret = stream.avail_out == 0 ? BZ_OK : BZ_DATA_ERROR;
+  else if (ret == BZ_OK)
+    ret = stream.avail_out == 0 ? BZ_OUTBUFF_FULL : BZ_UNEXPECTED_EOF;
+  BZ2_bzDecompressEnd(&stream);
+  return ret;
+}
+
+static void bzip2_put_be32(char *p, unsigned int v)
+{
+  unsigned char *u = (unsigned char *)p;
+  u[0] = (unsigned char)(v >> 24);
+  u[1] = (unsigned char)(v >> 16);
+  u[2] = (unsigned char)(v >> 8);
+  u[3] = (unsigned char)v;
+}
+
+static unsigned int bzip2_get_be32(const char *p)
+{
+  const unsigned char *u = (const unsigned char *)p;
+  return ((unsigned int)u[0] << 24) | ((unsigned int)u[1] << 16) |
+    ((unsigned int)u[2] << 8) | (unsigned int)u[3];
+}
+
+/* Number of threads to work on nstreams streams with. Threading is
+   opt-in, as for the CCR quantization filters: set CCR_THR_NBR to the
+   number of threads, or to 0 for one per processor. */
+static int bzip2_thread_count(size_t nstreams)
+{
+#ifdef _OPENMP
+  const char *thrstr;
+  char *end = NULL;
+  long nthreads;
+
+  if (nstreams < 2)
+    return 1;
+  thrstr = getenv(BZIP2_THREAD_COUNT_ENV);
+  if (thrstr == NULL || *thrstr == '\0')
+    return 1;
+  nthreads = strtol(thrstr, &end, 10);
+  if (*end != '\0' || nthreads < 0) {
+    fprintf(stderr, "bzip2 filter ignores invalid %s = %s\n", BZIP2_THREAD_COUNT_ENV, thrstr);
+    return 1;
+  }
+  if (nthreads == 0)
+    nthreads = omp_get_num_procs();
+  /* threads beyond one per stream would idle */
+  if ((size_t)nthreads > nstreams)
+    nthreads = (long)nstreams;
+  return (int)nthreads;
+#else
+  (void)nstreams;
+  return 1;
+#endif
+}
+
+/* Compress nbytes at inbuf into multi-stream format. Returns the
+   compressed size, and the buffer and its size in outbufp and
+   outbuflenp, or 0 on failure. */
+static size_t bzip2_compress_multistream(const char *inbuf, size_t nbytes,
+                                         int blockSize100k,
+                                         char **outbufp, size_t *outbuflenp)
+{
+  size_t streamlen = (size_t)blockSize100k * 100000;
+  size_t slotlen = streamlen + streamlen / 100 + 600;  /* worst case (bzip2 docs) */
+  size_t nstreams, hdrlen, outdatalen;
+  unsigned int *complens = NULL;
+  char *outbuf = NULL;
+  long s;
+  int nthreads, nbad = 0;
+
+  if (nbytes > 0xFFFFFFFFUL) {
+    fprintf(stderr, "bzip2 chunk of %lu bytes is too large\n", (unsigned long)nbytes);
+    return 0;
+  }
+  nstreams = nbytes > 0 ? (nbytes - 1) / streamlen + 1 : 0;
+  hdrlen = BZIP2_MS_HDR_SIZE + nstreams * 4;
+
+  /* Each stream is first compressed into its own worst-case slot, so
+     threads never overlap, then the streams are packed in order. */
+  *outbuflenp = hdrlen + nstreams * slotlen;
+  outbuf = malloc(*outbuflenp);
+  if (nstreams > 0)
+    complens = malloc(nstreams * sizeof(*complens));
+  if (outbuf == NULL || (nstreams > 0 && complens == NULL)) {
+    fprintf(stderr, "memory allocation failed for bzip2 compression\n");
+    goto cleanupAndFail;
+  }
+  bzip2_put_be32(outbuf, (unsigned int)nbytes);
+  bzip2_put_be32(outbuf + 4, (unsigned int)streamlen);
+
+  nthreads = bzip2_thread_count(nstreams);
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic) num_threads(nthreads) if(nthreads > 1) reduction(+:nbad)
+#endif
+  for (s = 0; s < (long)nstreams; s++) {
+    size_t inoff = (size_t)s * streamlen;
+    unsigned int inlen = (unsigned int)(nbytes - inoff < streamlen ? nbytes - inoff : streamlen);
+    unsigned int odatalen = (unsigned int)slotlen;
+    int ret;
+
+    ret = bzip2_compress_stream(outbuf + hdrlen + (size_t)s * slotlen, &odatalen,
+                                inbuf + inoff, inlen, blockSize100k);
+    if (ret != BZ_OK) {
+      fprintf(stderr, "bzip2 compression of stream %ld failed with error %d\n", s, ret);
+      nbad++;
+    }
+    complens[s] = odatalen;
+  }
+  (void)nthreads;
+  if (nbad)
+    goto cleanupAndFail;
+
+  /* Streams only move towards the start of the buffer, in order, so
+     none is overwritten before it moves. */
+  outdatalen = hdrlen;
+  for (s = 0; s < (long)nstreams; s++) {
+    bzip2_put_be32(outbuf + BZIP2_MS_HDR_SIZE + (size_t)s * 4, complens[s]);
+    memmove(outbuf + outdatalen, outbuf + hdrlen + (size_t)s * slotlen, complens[s]);
+    outdatalen += complens[s];
+  }
+  free(complens);
+  *outbufp = outbuf;
+  return outdatalen;
+
+ cleanupAndFail:
+  free(complens);
+  free(outbuf);
+  return 0;
+}
+
+/* Decompress a multi-stream chunk of nbytes at inbuf. Returns the
+   uncompressed size, and the buffer and its size in outbufp and
+   outbuflenp, or 0 on failure. */
+static size_t bzip2_decompress_multistream(const char *inbuf, size_t nbytes,
+                                           char **outbufp, size_t *outbuflenp)
+{
+  size_t origlen, streamlen, nstreams, hdrlen, off;
+  size_t *inoffs = NULL;
+  unsigned int *complens = NULL;
+  char *outbuf = NULL;
+  long s;
+  int nthreads, nbad = 0;
+
+  if (nbytes < BZIP2_MS_HDR_SIZE) {
+    fprintf(stderr, "bzip2 chunk of %lu bytes is smaller than its header\n", (unsigned long)nbytes);
+    return 0;
+  }
+  origlen = bzip2_get_be32(inbuf);
+  streamlen = bzip2_get_be32(inbuf + 4);
+  if (origlen > 0 && streamlen == 0) {
+    fprintf(stderr, "bzip2 chunk header has zero stream size\n");
+    return 0;
+  }
+  nstreams = origlen > 0 ? (origlen - 1) / streamlen + 1 : 0;
+  if (nstreams > (nbytes - BZIP2_MS_HDR_SIZE) / 4) {
+    fprintf(stderr, "bzip2 chunk of %lu bytes cannot hold %lu streams\n",
+            (unsigned long)nbytes, (unsigned long)nstreams);
+    return 0;
+  }
+  hdrlen = BZIP2_MS_HDR_SIZE + nstreams * 4;
+
+  /* Sizes are all in the header, so a running sum gives the start of
+     each stream. */
+  *outbuflenp = origlen > 0 ? origlen : 1;
+  outbuf = malloc(*outbuflenp);
+  if (nstreams > 0) {
+    inoffs = malloc(nstreams * sizeof(*inoffs));
+    complens = malloc(nstreams * sizeof(*complens));
+  }
+  if (outbuf == NULL || (nstreams > 0 && (inoffs == NULL || complens == NULL))) {
+    fprintf(stderr, "memory allocation failed for bzip2 decompression\n");
+    goto cleanupAndFail;
+  }
+  off = hdrlen;
+  for (s = 0; s < (long)nstreams; s++) {
+    complens[s] = bzip2_get_be32(inbuf + BZIP2_MS_HDR_SIZE + (size_t)s * 4);
+    if (complens[s] > nbytes - off) {
+      fprintf(stderr, "bzip2 stream %ld of %u bytes overruns chunk\n", s, complens[s]);
+      goto cleanupAndFail;
+    }
+    inoffs[s] = off;
+    off += complens[s];
+  }
+
+  nthreads = bzip2_thread_count(nstreams);
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic) num_threads(nthreads) if(nthreads > 1) reduction(+:nbad)
+#endif
+  for (s = 0; s < (long)nstreams; s++) {
+    size_t outoff = (size_t)s * streamlen;
+    unsigned int outlen = (unsigned int)(origlen - outoff < streamlen ? origlen - outoff : streamlen);
+    int ret;
+
+    ret = bzip2_decompress_stream(outbuf + outoff, outlen, inbuf + inoffs[s], complens[s]);
+    if (ret != BZ_OK) {
+      fprintf(stderr, "bzip2 decompression of stream %ld failed with error %d\n", s, ret);
+      nbad++;
+    }
+  }
+  (void)nthreads;
+  if (nbad)
+    goto cleanupAndFail;
+
+  free(inoffs);
+  free(complens);
+  *outbufp = outbuf;
+  return origlen;
+
+ cleanupAndFail:
+  free(inoffs);
+  free(complens);
+  free(outbuf);
+  return 0;
+}
+
 size_t H5Z_filter_bzip2(unsigned int flags, size_t cd_nelmts,
                      const unsigned int cd_values[], size_t nbytes,
                      size_t *buf_size, void **buf)
 {
   char *outbuf = NULL;
   size_t outbuflen, outdatalen;
+  int format = BZIP2_FORMAT_SINGLE;
   int ret;
 
-  if (flags & H5Z_FLAG_REVERSE) {
+  /* Get chunk format if present. */
+  if (cd_nelmts > 1) {
+    format = cd_values[1];
+    if (format != BZIP2_FORMAT_SINGLE && format != BZIP2_FORMAT_MULTISTREAM &&
+        format != BZIP2_FORMAT_SIZED) {
+      fprintf(stderr, "invalid bzip2 chunk format: %d\n", format);
+      goto cleanupAndFail;
+    }
+  }
+
+  if ((flags & H5Z_FLAG_REVERSE) && format == BZIP2_FORMAT_MULTISTREAM) {
+
+    /** Decompress independent streams, in parallel if asked. **/
+
+    outdatalen = bzip2_decompress_multistream(*buf, nbytes, &outbuf, &outbuflen);
+    if (outdatalen == 0)
+      goto cleanupAndFail;
+
+  } else if ((flags & H5Z_FLAG_REVERSE) && format == BZIP2_FORMAT_SIZED) {
+
+    /** Decompress into a buffer of the size stored in the header. **/
+
+    const char *hdr = *buf;
+
+    if (nbytes < BZIP2_SZ_HDR_SIZE || memcmp(hdr, "CBZ", 3)) {
+      fprintf(stderr, "bzip2 chunk has no size header\n");
+      goto cleanupAndFail;
+    }
+    if ((unsigned char)hdr[3] != BZIP2_SZ_VERSION) {
+      fprintf(stderr, "bzip2 chunk header version %d is not supported\n", (unsigned char)hdr[3]);
+      goto cleanupAndFail;
+    }
+    outdatalen = bzip2_get_be32(hdr + 4);
+    outbuflen = outdatalen > 0 ? outdatalen : 1;
+    outbuf = malloc(outbuflen);
+    if (outbuf == NULL) {
+      fprintf(stderr, "memory allocation failed for bzip2 decompression\n");
+      goto cleanupAndFail;
+    }
+    ret = bzip2_decompress_stream(outbuf, (unsigned int)outdatalen, hdr + BZIP2_SZ_HDR_SIZE,
+                                  (unsigned int)(nbytes - BZIP2_SZ_HDR_SIZE));
+    if (ret != BZ_OK) {
+      fprintf(stderr, "bzip2 decompression failed with error %d\n", ret);
+      goto cleanupAndFail;
+    }
+
+  } else if (flags & H5Z_FLAG_REVERSE) {
 
     /** Decompress data.
      **
@@ -149,10 +655,8 @@ size_t H5Z_filter_bzip2(unsigned int flags, size_t cd_nelmts,
       goto cleanupAndFail;
     }
 
-    /* Use standard malloc()/free() for internal memory handling. */
-    stream.bzalloc = NULL;
-    stream.bzfree = NULL;
-    stream.opaque = NULL;
+    /* Use the thread's arena for internal memory handling. */
+    bzip2_stream_init(&stream);
 
     /* Start decompression. */
     ret = BZ2_bzDecompressInit(&stream, 0, 0);
@@ -170,6 +674,7 @@ size_t H5Z_filter_bzip2(unsigned int flags, size_t cd_nelmts,
       ret = BZ2_bzDecompress(&stream);
       if (ret < 0) {
   fprintf(stderr, "BUG: bzip2 decompression failed with error %d\n", ret);
+  BZ2_bzDecompressEnd(&stream);
   goto cleanupAndFail;
       }
 
@@ -179,6 +684,7 @@ size_t H5Z_filter_bzip2(unsigned int flags, size_t cd_nelmts,
         newbuf = realloc(outbuf, newbuflen);
         if (newbuf == NULL) {
           fprintf(stderr, "memory allocation failed for bzip2 decompression\n");
+          BZ2_bzDecompressEnd(&stream);
           goto cleanupAndFail;
         }
         stream.next_out = newbuf + outbuflen;  /* half the new buffer behind */
@@ -196,6 +702,22 @@ size_t H5Z_filter_bzip2(unsigned int flags, size_t cd_nelmts,
       goto cleanupAndFail;
     }
 
+  } else if (format == BZIP2_FORMAT_MULTISTREAM) {
+
+    /** Compress the chunk as independent streams of level*100k
+     ** bytes, in parallel if asked.
+     **/
+
+    int blockSize100k = cd_values[0];
+
+    if (blockSize100k < 1 || blockSize100k > 9) {
+      fprintf(stderr, "invalid compression block size: %d\n", blockSize100k);
+      goto cleanupAndFail;
+    }
+    outdatalen = bzip2_compress_multistream(*buf, nbytes, blockSize100k, &outbuf, &outbuflen);
+    if (outdatalen == 0)
+      goto cleanupAndFail;
+
   } else {
 
     /** Compress data.
@@ -207,6 +729,7 @@ size_t H5Z_filter_bzip2(unsigned int flags, size_t cd_nelmts,
      **/
 
     unsigned int odatalen;  /* maybe not the same size as outdatalen */
+    size_t hdrlen = format == BZIP2_FORMAT_SIZED ? BZIP2_SZ_HDR_SIZE : 0;
     int blockSize100k = 9;
 
     /* Get compression block size if present. */
@@ -218,25 +741,45 @@ size_t H5Z_filter_bzip2(unsigned int flags, size_t cd_nelmts,
       }
     }
 
+    if (hdrlen > 0 && nbytes > 0xFFFFFFFFUL) {
+      fprintf(stderr, "bzip2 chunk of %lu bytes is too large\n", (unsigned long)nbytes);
+      goto cleanupAndFail;
+    }
+
     /* Prepare the output buffer. */
-    outbuflen = nbytes + nbytes / 100 + 600;  /* worst case (bzip2 docs) */
+    outbuflen = hdrlen + nbytes + nbytes / 100 + 600;  /* worst case (bzip2 docs) */
     outbuf = malloc(outbuflen);
     if (outbuf == NULL) {
       fprintf(stderr, "memory allocation failed for bzip2 compression\n");
       goto cleanupAndFail;
     }
+    if (hdrlen > 0) {
+      memcpy(outbuf, "CBZ", 3);
+      outbuf[3] = BZIP2_SZ_VERSION;
+      bzip2_put_be32(outbuf + 4, (unsigned int)nbytes);
+    }
 
     /* Compress data. */
-    odatalen = outbuflen;
-    ret = BZ2_bzBuffToBuffCompress(outbuf, &odatalen, *buf, nbytes,
-                                   blockSize100k, 0, 0);
-    outdatalen = odatalen;
+    odatalen = outbuflen - hdrlen;
+    ret = bzip2_compress_stream(outbuf + hdrlen, &odatalen, *buf, nbytes,
+                                blockSize100k);
+    outdatalen = hdrlen + odatalen;
     if (ret != BZ_OK) {
       fprintf(stderr, "bzip2 compression failed with error %d\n", ret);
       goto cleanupAndFail;
     }
   }
 
+  /* Shrink the output buffer to the data it holds, keeping the
+     larger one if realloc fails. */
+  if (outdatalen > 0 && outdatalen < outbuflen) {
+    char *fitbuf = realloc(outbuf, outdatalen);
+    if (fitbuf != NULL) {
+      outbuf = fitbuf;
+      outbuflen = outdatalen;
+    }
+  }
+
   /* Always replace the input buffer with the output buffer. */
   free(*buf);
   *buf = outbuf;
@@ -0,0 +1,9 @@
+# This script runs the Fill Mask examples in the CCR project.
+#
+# agent 10/17/26
+
+# Set the plugin path to find plugin
+export HDF5_PLUGIN_PATH=../src/.libs
+
+# Run the example
+./h5ex_d_fillmask
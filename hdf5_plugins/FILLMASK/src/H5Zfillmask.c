@@ -0,0 +1,749 @@
+/* Copyright (C) 2026--present Charlie Zender */
+
+ /*
+ * This file is an example of an HDF5 filter plugin.
+ * The plugin can be used with the HDF5 library version 1.8.11+ to read and write
+ * HDF5 datasets whose chunks are mostly or entirely _FillValue, e.g., land- or ocean-masked fields.
+ */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h" /* Autotools tokens */
+#endif
+#include <stdio.h>
+#ifdef HAVE_SYS_TYPES_H
+# include <sys/types.h>
+#endif
+#ifdef HAVE_SYS_STAT_H
+# include <sys/stat.h>
+#endif
+#ifdef STDC_HEADERS
+# include <stdlib.h>
+# include <stddef.h>
+#else
+# ifdef HAVE_STDLIB_H
+#  include <stdlib.h>
+# endif
+#endif
+#ifdef HAVE_STRING_H
+# if !defined STDC_HEADERS && defined HAVE_MEMORY_H
+#  include <memory.h>
+# endif
+# include <string.h>
+#endif
+#ifdef HAVE_STRINGS_H
+# include <strings.h>
+#endif
+#ifdef HAVE_INTTYPES_H
+# include <inttypes.h>
+#endif
+#ifdef HAVE_STDINT_H
+# include <stdint.h>
+#endif
+#ifdef HAVE_UNISTD_H
+# include <unistd.h>
+#endif
+#include <assert.h>
+
+#if defined(_WIN32)
+#include <Winsock2.h>
+#endif
+
+/* SIMD kernels need x86 intrinsics plus GCC/Clang function-level target attributes and __builtin_cpu_supports()
+   Other compilers and architectures use the scalar kernels */
+#if defined(HAVE_IMMINTRIN_H) && (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+# define CCR_SIMD_X86 1
+# include <immintrin.h> /* AVX2 intrinsics */
+#endif /* !HAVE_IMMINTRIN_H */
+
+/* 3rd party vendors */
+#include "H5PLextern.h" /* HDF5 Plugin Library: H5PLget_plugin_type(), H5PLget_plugin_info() */
+
+/* Tokens and typedefs */
+#define H5Z_FILTER_FILLMASK 32771 /* NB: Not yet registered with HDF, see ccr.h */
+#define CCR_FLT_DBG_INFO 0 /* [flg] Print non-fatal debugging information */
+#define CCR_FLT_NAME "Fill Mask filter (stores _FillValue runs as a validity bitmap)" /* [sng] Filter name in vernacular for HDF5 messages */
+#define CCR_FLT_PRM_NBR 4 /* [nbr] Number of parameters sent to filter (in cd_params array). NB: keep identical with ccr.h:FILLMASK_FLT_PRM_NBR */
+#define CCR_FLT_PRM_PSN_DATUM_SIZE 0 /* [nbr] Ordinal position of datum_size in parameter list (cd_params array) */
+#define CCR_FLT_PRM_PSN_HAS_MSS_VAL 1 /* [nbr] Ordinal position of missing value flag in parameter list (cd_params array) */
+#define CCR_FLT_PRM_PSN_MSS_VAL 2 /* [nbr] Ordinal position of missing value in parameter list (cd_params array) NB: Missing value (_FillValue) uses two cd_params slots so it can be any type up to eight bytes. Values are read as first datum_size bytes starting at cd_params[2]. */
+
+/* Each chunk starts with a little-endian header that lets the decoder rebuild values without filter parameters:
+   Byte  0     Header version
+   Byte  1     Mode: 0 (raw, values stored unchanged), 1 (every value is missing), or 2 (masked)
+   Byte  2     Datum size in bytes
+   Byte  3     Reserved, zero
+   Bytes 4-7   Number of values in chunk
+   Bytes 8-15  Missing value, in datum byte order, zero-padded to eight bytes
+   Masked chunks follow the header with a validity bitmap, one bit per value (1 = valid), least significant bit first, then the valid values in order */
+#define CCR_FMK_HDR_SZ 16 /* [B] Chunk header size */
+#define CCR_FMK_VRS 1 /* [nbr] Chunk header version */
+#define CCR_FMK_MOD_RAW 0 /* [nbr] Mode of unmasked chunk */
+#define CCR_FMK_MOD_FLL 1 /* [nbr] Mode of chunk that is entirely missing values */
+#define CCR_FMK_MOD_MSK 2 /* [nbr] Mode of masked chunk */
+
+/* Compatibility tokens and typedefs retain source-code compatibility between NCO and filter
+   These tokens mimic netCDF/NCO code but do not rely on or interfere with either */
+#ifndef NC_FILL_BYTE
+# define NC_FILL_BYTE    ((signed char)-127)
+#endif /* !NC_FILL_BYTE */
+#ifndef NC_FILL_SHORT
+# define NC_FILL_SHORT   ((short)-32767)
+#endif /* !NC_FILL_SHORT */
+#ifndef NC_FILL_INT
+# define NC_FILL_INT     (-2147483647)
+#endif /* !NC_FILL_INT */
+#ifndef NC_FILL_FLOAT
+# define NC_FILL_FLOAT   (9.9692099683868690e+36f) /* near 15 * 2^119 */
+#endif /* !NC_FILL_FLOAT */
+#ifndef NC_FILL_DOUBLE
+# define NC_FILL_DOUBLE  (9.9692099683868690e+36)
+#endif /* !NC_FILL_DOUBLE */
+#ifndef NC_FILL_UBYTE
+# define NC_FILL_UBYTE   (255)
+#endif /* !NC_FILL_UBYTE */
+#ifndef NC_FILL_USHORT
+# define NC_FILL_USHORT  (65535)
+#endif /* !NC_FILL_USHORT */
+#ifndef NC_FILL_UINT
+# define NC_FILL_UINT    (4294967295U)
+#endif /* !NC_FILL_UINT */
+#ifndef NC_FILL_INT64
+# define NC_FILL_INT64   ((long long)-9223372036854775806LL)
+#endif /* !NC_FILL_INT64 */
+#ifndef NC_FILL_UINT64
+# define NC_FILL_UINT64  ((unsigned long long)18446744073709551614ULL)
+#endif /* !NC_FILL_UINT64 */
+
+/* Mask kernel compares every value in a chunk to the missing value in one sweep
+   Kernel choice (scalar, AVX2) is made once by ccr_fmk_cpu_dispatch() */
+typedef size_t /* O [nbr] Number of valid (non-missing) values */
+(*ccr_fmk_msk_knl_t) /* [fnc] Validity bitmap kernel */
+(const size_t sz, /* I [nbr] Number of values */
+ const size_t datum_size, /* I [B] Bytes per value (1, 2, 4, or 8) */
+ const void *op1, /* I [val] Values to scan */
+ const void *mss_val, /* I [val] Missing value */
+ unsigned char *msk); /* O [flg] Validity bitmap, (sz+7)/8 bytes */
+
+/* Forward-declare functions before their names appear in H5Z_class2_t filter structure */
+size_t /* O [B] Number of bytes resulting after forward/reverse filter applied */
+H5Z_filter_fillmask /* [fnc] HDF5 Fill Mask Filter */
+(unsigned int flags, /* I [flg] Bitfield that encodes filter direction */
+ size_t cd_nelmts, /* I [nbr] Number of elements in filter parameter (cd_values[]) array */
+ const unsigned int cd_values[], /* I [enm] Filter parameters */
+ size_t bfr_sz_in, /* I [B] Number of bytes in input buffer (before forward/reverse filter) */
+ size_t *bfr_sz_out, /* O [B] Number of bytes in output buffer (after forward/reverse filter) */
+ void **bfr_inout); /* I/O [val] Values to mask or unmask */
+
+htri_t /* O [flg] Data meet criteria to apply filter */
+ccr_can_apply_fillmask /* [fnc] Callback to determine if current variable meets filter criteria */
+(hid_t dcpl, /* I [id] Dataset creation property list ID */
+ hid_t type, /* I [id] Dataset type ID */
+ hid_t space); /* I [id] Dataset space ID */
+
+htri_t /* O [flg] Filter parameters successfully modified for this variable */
+ccr_set_local_fillmask /* [fnc] Callback to determine and set per-variable filter parameters */
+(hid_t dcpl, /* I [id] Dataset creation property list ID */
+ hid_t type, /* I [id] Dataset type ID */
+ hid_t space); /* I [id] Dataset space ID */
+
+const H5Z_class2_t H5Z_FILLMASK[1]={{
+    H5Z_CLASS_T_VERS, /* H5Z_class_t version */
+    (H5Z_filter_t)H5Z_FILTER_FILLMASK, /* Filter ID number */
+#ifdef FILTER_DECODE_ONLY
+    0, /* [flg] Encoder availability flag */
+#else
+    1, /* [flg] Encoder availability flag */
+#endif
+    1, /* [flg] Decoder availability flag */
+    CCR_FLT_NAME, /* [sng] Filter name for debugging */
+    ccr_can_apply_fillmask, /* [fnc] Callback to determine if current variable meets filter criteria */
+    ccr_set_local_fillmask, /* [fnc] Callback to determine and set per-variable filter parameters */
+    (H5Z_func_t)H5Z_filter_fillmask, /* [fnc] Function to implement filter */
+  }}; /* !H5Z_FILLMASK */
+
+void
+ccr_fmk_cpu_dispatch /* [fnc] Select fastest mask kernel supported by this CPU */
+(void);
+
+/* Kernel selected by ccr_fmk_cpu_dispatch(), NULL until first dispatch */
+static ccr_fmk_msk_knl_t ccr_fmk_msk_knl=NULL; /* [fnc] Validity bitmap kernel */
+static const char *ccr_fmk_knl_nm="none"; /* [sng] Name of selected kernel, for debugging */
+
+/* Function definitions */
+H5PL_type_t /* O [enm] Plugin type */
+H5PLget_plugin_type /* [fnc] Provide plug-in type provided by this shared library */
+(void)
+{ /* Purpose: Describe plug-in type provided by this shared library
+     The HDF5 plugin mechanism usually calls this function after an application calls H5Pset_filter(), or when the data to which this filter will be applied are first read */
+  return H5PL_TYPE_FILTER;
+} /* !H5PLget_plugin_type() */
+
+const void * /* O [enm] */
+H5PLget_plugin_info /* [fnc] Return structure */
+(void)
+{ /* Purpose: Provide structure that defines Fill Mask filter so the filter may be dynamically registered with the plugin mechanism
+     The HDF5 plugin mechanism usually calls this function after an application calls H5Pset_filter(), or when the data to which this filter will be applied are first read */
+  ccr_fmk_cpu_dispatch();
+  return H5Z_FILLMASK;
+} /* !H5PLget_plugin_info() */
+
+static void
+ccr_fmk_hdr_put /* [fnc] Write chunk header */
+(unsigned char *hdr, /* O [B] Header */
+ const int mod, /* I [nbr] Mode */
+ const size_t datum_size, /* I [B] Bytes per value */
+ const size_t sz, /* I [nbr] Number of values */
+ const void *mss_val) /* I [val] Missing value */
+{
+  int idx;
+
+  memset(hdr,0,CCR_FMK_HDR_SZ);
+  hdr[0]=CCR_FMK_VRS;
+  hdr[1]=(unsigned char)mod;
+  hdr[2]=(unsigned char)datum_size;
+  for(idx=0;idx<4;idx++) hdr[4+idx]=(unsigned char)((sz >> (8*idx)) & 0xFFU);
+  memcpy(hdr+8,mss_val,datum_size);
+} /* !ccr_fmk_hdr_put() */
+
+static void
+ccr_fmk_hdr_get /* [fnc] Read chunk header */
+(const unsigned char *hdr, /* I [B] Header */
+ int *vrs, /* O [nbr] Header version */
+ int *mod, /* O [nbr] Mode */
+ size_t *datum_size, /* O [B] Bytes per value */
+ size_t *sz) /* O [nbr] Number of values */
+{
+  unsigned long u32; /* [nbr] Count */
+  int idx;
+
+  *vrs=hdr[0];
+  *mod=hdr[1];
+  *datum_size=hdr[2];
+  for(u32=0,idx=3;idx>=0;idx--) u32=(u32 << 8) | hdr[4+idx];
+  *sz=(size_t)u32;
+} /* !ccr_fmk_hdr_get() */
+
+static size_t /* O [nbr] Number of set bits */
+ccr_fmk_bit_cnt /* [fnc] Count valid values in bitmap */
+(const size_t msk_sz, /* I [B] Bitmap size */
+ const unsigned char *msk) /* I [flg] Validity bitmap */
+{
+  size_t cnt=0; /* [nbr] Set bits */
+  size_t idx;
+  unsigned int byt; /* [flg] Current bitmap byte */
+
+  for(idx=0;idx<msk_sz;idx++)
+    for(byt=msk[idx];byt;byt&=byt-1U) cnt++;
+  return cnt;
+} /* !ccr_fmk_bit_cnt() */
+
+static void
+ccr_fmk_gth /* [fnc] Gather valid values into contiguous buffer */
+(const size_t sz, /* I [nbr] Number of values */
+ const size_t datum_size, /* I [B] Bytes per value */
+ const unsigned char *op1, /* I [val] Values */
+ const unsigned char *msk, /* I [flg] Validity bitmap */
+ unsigned char *vld) /* O [val] Valid values */
+{
+  /* Runs of fully valid bitmap bytes copy in one call, so masked chunks with long valid runs gather at memcpy() speed */
+  const size_t byt_nbr=sz/8; /* [nbr] Full bitmap bytes */
+  size_t idx=0; /* [idx] Bitmap byte */
+  size_t run; /* [nbr] Bitmap bytes in current run */
+  size_t val_idx; /* [idx] Value index */
+  int bit;
+
+  while(idx < byt_nbr){
+    if(msk[idx] == 0xFFU){
+      for(run=1;idx+run < byt_nbr && msk[idx+run] == 0xFFU;run++);
+      memcpy(vld,op1+idx*8*datum_size,run*8*datum_size);
+      vld+=run*8*datum_size;
+      idx+=run;
+    }else{
+      if(msk[idx])
+	for(bit=0;bit<8;bit++)
+	  if(msk[idx] & (1U << bit)){
+	    memcpy(vld,op1+(idx*8+bit)*datum_size,datum_size);
+	    vld+=datum_size;
+	  } /* !msk */
+      idx++;
+    } /* !msk */
+  } /* !idx */
+  for(val_idx=byt_nbr*8;val_idx<sz;val_idx++)
+    if(msk[byt_nbr] & (1U << (val_idx%8))){
+      memcpy(vld,op1+val_idx*datum_size,datum_size);
+      vld+=datum_size;
+    } /* !msk */
+} /* !ccr_fmk_gth() */
+
+static void
+ccr_fmk_sct /* [fnc] Scatter valid values into buffer of missing values */
+(const size_t sz, /* I [nbr] Number of values */
+ const size_t datum_size, /* I [B] Bytes per value */
+ const unsigned char *vld, /* I [val] Valid values */
+ const unsigned char *msk, /* I [flg] Validity bitmap */
+ unsigned char *op1) /* I/O [val] Missing values on input, all values on output */
+{
+  const size_t byt_nbr=sz/8; /* [nbr] Full bitmap bytes */
+  size_t idx=0; /* [idx] Bitmap byte */
+  size_t run; /* [nbr] Bitmap bytes in current run */
+  size_t val_idx; /* [idx] Value index */
+  int bit;
+
+  while(idx < byt_nbr){
+    if(msk[idx] == 0xFFU){
+      for(run=1;idx+run < byt_nbr && msk[idx+run] == 0xFFU;run++);
+      memcpy(op1+idx*8*datum_size,vld,run*8*datum_size);
+      vld+=run*8*datum_size;
+      idx+=run;
+    }else{
+      if(msk[idx])
+	for(bit=0;bit<8;bit++)
+	  if(msk[idx] & (1U << bit)){
+	    memcpy(op1+(idx*8+bit)*datum_size,vld,datum_size);
+	    vld+=datum_size;
+	  } /* !msk */
+      idx++;
+    } /* !msk */
+  } /* !idx */
+  for(val_idx=byt_nbr*8;val_idx<sz;val_idx++)
+    if(msk[byt_nbr] & (1U << (val_idx%8))){
+      memcpy(op1+val_idx*datum_size,vld,datum_size);
+      vld+=datum_size;
+    } /* !msk */
+} /* !ccr_fmk_sct() */
+
+static void
+ccr_fmk_fll /* [fnc] Set every value in buffer to missing value */
+(const size_t sz, /* I [nbr] Number of values */
+ const size_t datum_size, /* I [B] Bytes per value */
+ const void *mss_val, /* I [val] Missing value */
+ unsigned char *op1) /* O [val] Missing values */
+{
+  /* Double the filled prefix each pass, so filling takes log2(sz) memcpy() calls */
+  const size_t bfr_sz=sz*datum_size; /* [B] Buffer size */
+  size_t fll_sz; /* [B] Bytes filled so far */
+
+  if(!sz) return;
+  memcpy(op1,mss_val,datum_size);
+  for(fll_sz=datum_size;fll_sz < bfr_sz;fll_sz*=2)
+    memcpy(op1+fll_sz,op1,(2*fll_sz <= bfr_sz) ? fll_sz : bfr_sz-fll_sz);
+} /* !ccr_fmk_fll() */
+
+size_t /* O [B] Number of bytes resulting after forward/reverse filter applied */
+H5Z_filter_fillmask /* [fnc] HDF5 Fill Mask Filter */
+(unsigned int flags, /* I [flg] Bitfield that encodes filter direction */
+ size_t cd_nelmts, /* I [nbr] Number of elements in filter parameter (cd_values[]) array */
+ const unsigned int cd_values[], /* I [enm] Filter parameters */
+ size_t bfr_sz_in, /* I [B] Number of bytes in input buffer (before forward/reverse filter) */
+ size_t *bfr_sz_out, /* O [B] Number of bytes in output buffer (after forward/reverse filter) */
+ void **bfr_inout) /* I/O [val] Values to mask or unmask */
+{
+  /* Purpose: Dynamic filter invoked by HDF5 to store chunks that are mostly or entirely missing values compactly, and to rebuild them on read
+     Forward filter builds a validity bitmap in one vectorized sweep, then stores chunks of only missing values as a header, and mostly missing chunks as header, bitmap, and valid values
+     Chunks that masking would not shrink are stored unchanged after the header
+     Filter is lossless and applies to integer and floating-point values of 1, 2, 4, or 8 bytes
+     Values are compared bitwise with the missing value, so NaN missing values and negative zeros are handled exactly */
+
+  const char fnc_nm[]="H5Z_filter_fillmask()"; /* [sng] Function name */
+
+  int mod; /* [nbr] Mode */
+  int vrs; /* [nbr] Header version */
+  size_t datum_size; /* [B] Bytes per unfiltered data value */
+  size_t elm_nbr; /* [nbr] Number of values in buffer */
+  size_t msk_sz; /* [B] Bitmap size */
+  size_t vld_nbr; /* [nbr] Number of valid (non-missing) values */
+  size_t bfr_sz_new; /* [B] Size of new buffer */
+  unsigned char *bfr_new=NULL; /* [ptr] New buffer */
+  unsigned char *msk=NULL; /* [ptr] Validity bitmap */
+  unsigned char mss_val[8]={0}; /* [val] Missing value */
+
+  if(!ccr_fmk_msk_knl) ccr_fmk_cpu_dispatch();
+
+  if(flags & H5Z_FLAG_REVERSE){
+
+    /* Unmask using only the chunk header, so data read back even where filter parameters differ */
+    const unsigned char *hdr=(const unsigned char *)(*bfr_inout); /* [ptr] Chunk header */
+    size_t datum_size_hdr; /* [B] Bytes per value according to header */
+
+    if(bfr_sz_in < CCR_FMK_HDR_SZ){
+      (void)fprintf(stderr,"ERROR: \"%s\" filter function %s reports %lu B chunk is smaller than its header\n",CCR_FLT_NAME,fnc_nm,(unsigned long)bfr_sz_in);
+      goto error;
+    } /* !bfr_sz_in */
+    ccr_fmk_hdr_get(hdr,&vrs,&mod,&datum_size_hdr,&elm_nbr);
+    if(vrs != CCR_FMK_VRS){
+      (void)fprintf(stderr,"ERROR: \"%s\" filter function %s reports chunk header version = %d, expected %d\n",CCR_FLT_NAME,fnc_nm,vrs,CCR_FMK_VRS);
+      goto error;
+    } /* !vrs */
+    datum_size=datum_size_hdr;
+    if(datum_size != 1 && datum_size != 2 && datum_size != 4 && datum_size != 8){
+      (void)fprintf(stderr,"ERROR: \"%s\" filter function %s reports chunk header datum size = %lu B is invalid\n",CCR_FLT_NAME,fnc_nm,(unsigned long)datum_size);
+      goto error;
+    } /* !datum_size */
+    memcpy(mss_val,hdr+8,datum_size);
+    msk_sz=(elm_nbr+7)/8;
+    msk=(unsigned char *)hdr+CCR_FMK_HDR_SZ;
+    vld_nbr=0;
+    if(mod == CCR_FMK_MOD_MSK && bfr_sz_in >= CCR_FMK_HDR_SZ+msk_sz) vld_nbr=ccr_fmk_bit_cnt(msk_sz,msk);
+    if((mod == CCR_FMK_MOD_RAW && bfr_sz_in != CCR_FMK_HDR_SZ+elm_nbr*datum_size) ||
+       (mod == CCR_FMK_MOD_FLL && bfr_sz_in != CCR_FMK_HDR_SZ) ||
+       (mod == CCR_FMK_MOD_MSK && bfr_sz_in != CCR_FMK_HDR_SZ+msk_sz+vld_nbr*datum_size) ||
+       (mod != CCR_FMK_MOD_RAW && mod != CCR_FMK_MOD_FLL && mod != CCR_FMK_MOD_MSK)){
+      (void)fprintf(stderr,"ERROR: \"%s\" filter function %s reports %lu B chunk is inconsistent with header mode = %d for %lu values\n",CCR_FLT_NAME,fnc_nm,(unsigned long)bfr_sz_in,mod,(unsigned long)elm_nbr);
+      goto error;
+    } /* !mod */
+
+    bfr_sz_new=elm_nbr*datum_size;
+    if(!(bfr_new=(unsigned char *)malloc(bfr_sz_new > 0 ? bfr_sz_new : 1))){
+      (void)fprintf(stderr,"ERROR: \"%s\" filter function %s unable to allocate %lu B for unmasked data\n",CCR_FLT_NAME,fnc_nm,(unsigned long)bfr_sz_new);
+      goto error;
+    } /* !bfr_new */
+
+    if(mod == CCR_FMK_MOD_RAW){
+      memcpy(bfr_new,hdr+CCR_FMK_HDR_SZ,bfr_sz_new);
+    }else{
+      ccr_fmk_fll(elm_nbr,datum_size,mss_val,bfr_new);
+      if(mod == CCR_FMK_MOD_MSK) ccr_fmk_sct(elm_nbr,datum_size,msk+msk_sz,msk,bfr_new);
+    } /* !mod */
+    msk=NULL;
+
+  }else{ /* !flags */
+
+    /* Mask */
+    int has_mss_val; /* [flg] Flag for missing values */
+
+    if(cd_nelmts < CCR_FLT_PRM_NBR){
+      (void)fprintf(stderr,"ERROR: \"%s\" filter function %s reports %lu parameters, needs %d\n",CCR_FLT_NAME,fnc_nm,(unsigned long)cd_nelmts,CCR_FLT_PRM_NBR);
+      goto error;
+    } /* !cd_nelmts */
+
+    datum_size=cd_values[CCR_FLT_PRM_PSN_DATUM_SIZE];
+    has_mss_val=cd_values[CCR_FLT_PRM_PSN_HAS_MSS_VAL];
+    if(datum_size != 1 && datum_size != 2 && datum_size != 4 && datum_size != 8){
+      (void)fprintf(stderr,"ERROR: \"%s\" filter function %s reports datum size = %lu B is invalid, only 1, 2, 4, and 8 B values are supported\n",CCR_FLT_NAME,fnc_nm,(unsigned long)datum_size);
+      goto error;
+    } /* !datum_size */
+    memcpy(mss_val,cd_values+CCR_FLT_PRM_PSN_MSS_VAL,datum_size);
+    if(bfr_sz_in % datum_size){
+      (void)fprintf(stderr,"ERROR: \"%s\" filter function %s reports %lu B chunk is not a whole number of %lu B values\n",CCR_FLT_NAME,fnc_nm,(unsigned long)bfr_sz_in,(unsigned long)datum_size);
+      goto error;
+    } /* !bfr_sz_in */
+    elm_nbr=bfr_sz_in/datum_size;
+    if(elm_nbr > 0xFFFFFFFFUL){
+      (void)fprintf(stderr,"ERROR: \"%s\" filter function %s reports %lu values exceed header limit of 2^32-1\n",CCR_FLT_NAME,fnc_nm,(unsigned long)elm_nbr);
+      goto error;
+    } /* !elm_nbr */
+
+    msk_sz=(elm_nbr+7)/8;
+    if(!(msk=(unsigned char *)malloc(msk_sz > 0 ? msk_sz : 1))){
+      (void)fprintf(stderr,"ERROR: \"%s\" filter function %s unable to allocate %lu B for validity bitmap\n",CCR_FLT_NAME,fnc_nm,(unsigned long)msk_sz);
+      goto error;
+    } /* !msk */
+    vld_nbr=ccr_fmk_msk_knl(elm_nbr,datum_size,*bfr_inout,mss_val,msk);
+
+    /* Choose mode */
+    if(vld_nbr == 0 && elm_nbr > 0) mod=CCR_FMK_MOD_FLL;
+    else if(msk_sz+vld_nbr*datum_size < elm_nbr*datum_size) mod=CCR_FMK_MOD_MSK;
+    else mod=CCR_FMK_MOD_RAW;
+
+    if(CCR_FLT_DBG_INFO) (void)fprintf(stderr,"INFO: %s masks %lu values (%lu valid) of datum size = %lu B, has_mss_val = %d, with mode = %d\n",fnc_nm,(unsigned long)elm_nbr,(unsigned long)vld_nbr,(unsigned long)datum_size,has_mss_val,mod);
+
+    if(mod == CCR_FMK_MOD_RAW) bfr_sz_new=CCR_FMK_HDR_SZ+elm_nbr*datum_size;
+    else if(mod == CCR_FMK_MOD_FLL) bfr_sz_new=CCR_FMK_HDR_SZ;
+    else bfr_sz_new=CCR_FMK_HDR_SZ+msk_sz+vld_nbr*datum_size;
+    if(!(bfr_new=(unsigned char *)malloc(bfr_sz_new))){
+      (void)fprintf(stderr,"ERROR: \"%s\" filter function %s unable to allocate %lu B for masked data\n",CCR_FLT_NAME,fnc_nm,(unsigned long)bfr_sz_new);
+      goto error;
+    } /* !bfr_new */
+    ccr_fmk_hdr_put(bfr_new,mod,datum_size,elm_nbr,mss_val);
+
+    if(mod == CCR_FMK_MOD_RAW){
+      memcpy(bfr_new+CCR_FMK_HDR_SZ,*bfr_inout,elm_nbr*datum_size);
+    }else if(mod == CCR_FMK_MOD_MSK){
+      memcpy(bfr_new+CCR_FMK_HDR_SZ,msk,msk_sz);
+      ccr_fmk_gth(elm_nbr,datum_size,(const unsigned char *)(*bfr_inout),msk,bfr_new+CCR_FMK_HDR_SZ+msk_sz);
+    } /* !mod */
+
+  } /* !flags */
+
+  if(msk) free(msk);
+  free(*bfr_inout);
+  *bfr_inout=bfr_new;
+  *bfr_sz_out=bfr_sz_new;
+  return bfr_sz_new;
+
+ error:
+  if(msk && !(flags & H5Z_FLAG_REVERSE)) free(msk);
+  if(bfr_new) free(bfr_new);
+  return 0;
+
+} /* !H5Z_filter_fillmask() */
+
+htri_t /* O [flg] Data meet criteria to apply filter */
+ccr_can_apply_fillmask /* [fnc] Callback to determine if current variable meets filter criteria */
+(hid_t dcpl, /* I [id] Dataset creation property list ID */
+ hid_t type, /* I [id] Dataset type ID */
+ hid_t space) /* I [id] Dataset space ID */
+{
+  /* Data space must be simple, i.e., a multi-dimensional array */
+  if(H5Sis_simple(space) <= 0){
+    fprintf(stderr,"WARNING: Cannot apply filter \"%s\" filter because data space is not simple.\n",CCR_FLT_NAME);
+    return 0;
+  } /* !H5Sis_simple(space) */
+
+  /* Filter can be applied */
+  return 1;
+} /* !ccr_can_apply_fillmask() */
+
+htri_t /* O [flg] Filter parameters successfully modified for this variable */
+ccr_set_local_fillmask /* [fnc] Callback to determine and set per-variable filter parameters */
+(hid_t dcpl, /* I [id] Dataset creation property list ID */
+ hid_t type, /* I [id] Dataset type ID */
+ hid_t space) /* I [id] Dataset space ID */
+{
+  const char fnc_nm[]="ccr_set_local_fillmask()"; /* [sng] Function name */
+
+  herr_t rcd; /* [flg] Return code */
+
+  /* Initialize filter parameters with default values */
+  unsigned int ccr_flt_prm[CCR_FLT_PRM_NBR]={0,0,0,0};
+
+  /* Initialize output variables for call to H5Pget_filter_by_id() */
+  unsigned int flags=0;
+  size_t cd_nelmts=CCR_FLT_PRM_NBR;
+  unsigned int *cd_values=ccr_flt_prm;
+
+  /* Retrieve parameters specified by user
+     https://support.hdfgroup.org/HDF5/doc/RM/RM_H5P.html#FunctionIndex
+     Ignore name and filter_config by setting last three arguments to 0/NULL */
+  rcd=H5Pget_filter_by_id(dcpl,H5Z_FILTER_FILLMASK,&flags,&cd_nelmts,cd_values,0,NULL,NULL);
+  if(rcd < 0){
+    (void)fprintf(stderr,"ERROR: %s filter callback function %s reports H5Pget_filter_by_id() failed to get filter flags and parameters for current variable\n",CCR_FLT_NAME,fnc_nm);
+    return 0;
+  } /* !rcd */
+
+  /* Data class and datum size for this variable
+     Only fixed-size integers and floats are masked, so remove filter from other types, as quantization filters do for integers */
+  H5T_class_t data_class; /* [enm] Data type class identifier (H5T_FLOAT, H5T_INT, H5T_STRING, ...) */
+  size_t datum_size; /* [B] Bytes per data value */
+  data_class=H5Tget_class(type);
+  if(data_class < 0){
+    (void)fprintf(stderr,"ERROR: %s filter callback function %s reports H5Tget_class() returned invalid data type class identifier = %d for current variable\n",CCR_FLT_NAME,fnc_nm,(int)data_class);
+    return 0;
+  } /* !data_class */
+  datum_size=H5Tget_size(type);
+  if(datum_size <= 0){
+    (void)fprintf(stderr,"ERROR: %s filter callback function %s reports H5Tget_size() returned invalid datum size = %lu B\n",CCR_FLT_NAME,fnc_nm,datum_size);
+    return 0;
+  } /* !datum_size */
+  if(!(data_class == H5T_INTEGER && (datum_size == 1 || datum_size == 2 || datum_size == 4 || datum_size == 8)) &&
+     !(data_class == H5T_FLOAT && (datum_size == sizeof(float) || datum_size == sizeof(double)))){
+    if(CCR_FLT_DBG_INFO){
+      (void)fprintf(stdout,"INFO: \"%s\" filter callback function %s reports data type class identifier = %d, datum size = %lu B is not a 1, 2, 4, or 8 B integer or a float or double. Attempting to remove filter using H5Premove_filter()...",CCR_FLT_NAME,fnc_nm,(int)data_class,datum_size);
+    } /* !CCR_FLT_DBG_INFO */
+    rcd=H5Premove_filter(dcpl,H5Z_FILTER_FILLMASK);
+    if(rcd < 0){
+      if(CCR_FLT_DBG_INFO) (void)fprintf(stdout,"failure :(\n");
+      return 0;
+    } /* !rcd */
+    if(CCR_FLT_DBG_INFO) (void)fprintf(stdout,"success!\n");
+    return 1;
+  } /* !data_class */
+
+  /* Set datum size in filter parameter list */
+  ccr_flt_prm[CCR_FLT_PRM_PSN_DATUM_SIZE]=(unsigned int)datum_size;
+
+  /* Find, set, and pass per-variable has_mss_val and mss_val arguments
+     https://support.hdfgroup.org/HDF5/doc_resource/H5Fill_Values.html */
+  int has_mss_val=0; /* [flg] Flag for missing values */
+  unsigned char mss_val[8]={0}; /* [val] Value of missing value, large enough for any type */
+
+  H5D_fill_value_t status;
+  rcd=H5Pfill_value_defined(dcpl,&status);
+  if(rcd < 0){
+    (void)fprintf(stdout,"ERROR: \"%s\" filter callback function %s reports H5Pfill_value_defined() returns error code = %d\n",CCR_FLT_NAME,fnc_nm,rcd);
+    return 0;
+  } /* !rcd */
+
+  if(status == H5D_FILL_VALUE_USER_DEFINED){
+    has_mss_val=1;
+    /* Fill value is converted to dataset type, so its bytes match chunk data */
+    rcd=H5Pget_fill_value(dcpl,type,mss_val);
+    if(rcd < 0){
+      (void)fprintf(stdout,"ERROR: \"%s\" filter callback function %s reports H5Pget_fill_value() returns error code = %d\n",CCR_FLT_NAME,fnc_nm,rcd);
+      return 0;
+    } /* !rcd */
+  }else{
+    /* Without a user-defined fill value, mask the netCDF default fill value of this type, as quantization filters do */
+    H5T_sign_t sgn=(data_class == H5T_INTEGER) ? H5Tget_sign(type) : H5T_SGN_NONE; /* [enm] Integer signedness */
+    hid_t mem_typ=-1; /* [id] Native type of default fill value */
+    union{signed char b;unsigned char ub;short s;unsigned short us;int i;unsigned int ui;long long i64;unsigned long long ui64;float f;double d;} fll; /* [val] Default fill value in native type */
+
+    if(data_class == H5T_FLOAT){
+      if(datum_size == sizeof(float)){fll.f=NC_FILL_FLOAT; mem_typ=H5T_NATIVE_FLOAT;}
+      else{fll.d=NC_FILL_DOUBLE; mem_typ=H5T_NATIVE_DOUBLE;}
+    }else if(sgn == H5T_SGN_NONE){
+      if(datum_size == 1){fll.ub=NC_FILL_UBYTE; mem_typ=H5T_NATIVE_UCHAR;}
+      else if(datum_size == 2){fll.us=NC_FILL_USHORT; mem_typ=H5T_NATIVE_USHORT;}
+      else if(datum_size == 4){fll.ui=NC_FILL_UINT; mem_typ=H5T_NATIVE_UINT;}
+      else{fll.ui64=NC_FILL_UINT64; mem_typ=H5T_NATIVE_ULLONG;}
+    }else{
+      if(datum_size == 1){fll.b=NC_FILL_BYTE; mem_typ=H5T_NATIVE_SCHAR;}
+      else if(datum_size == 2){fll.s=NC_FILL_SHORT; mem_typ=H5T_NATIVE_SHORT;}
+      else if(datum_size == 4){fll.i=NC_FILL_INT; mem_typ=H5T_NATIVE_INT;}
+      else{fll.i64=NC_FILL_INT64; mem_typ=H5T_NATIVE_LLONG;}
+    } /* !data_class */
+    /* Convert to dataset type, which may differ from native byte order */
+    rcd=H5Tconvert(mem_typ,type,1,&fll,NULL,H5P_DEFAULT);
+    if(rcd < 0){
+      (void)fprintf(stdout,"ERROR: \"%s\" filter callback function %s reports H5Tconvert() returns error code = %d\n",CCR_FLT_NAME,fnc_nm,rcd);
+      return 0;
+    } /* !rcd */
+    memcpy(mss_val,&fll,datum_size);
+  } /* !status */
+
+  /* Set missing value in filter parameter list */
+  memcpy(cd_values+CCR_FLT_PRM_PSN_MSS_VAL,mss_val,datum_size);
+
+  /* Set missing value flag in filter parameter list */
+  ccr_flt_prm[CCR_FLT_PRM_PSN_HAS_MSS_VAL]=has_mss_val;
+
+  /* Update invoked filter with generic parameters as invoked with variable-specific values */
+  rcd=H5Pmodify_filter(dcpl,H5Z_FILTER_FILLMASK,flags,CCR_FLT_PRM_NBR,cd_values);
+  if(rcd < 0){
+    (void)fprintf(stderr,"ERROR: \"%s\" filter callback function %s reports H5Pmodify_filter() unable to modify filter parameters\n",CCR_FLT_NAME,fnc_nm);
+    return 0;
+  } /* !rcd */
+
+  return 1;
+} /* !ccr_set_local_fillmask() */
+
+/* Scalar kernel defines the bitmap, SIMD kernel reproduces it bit-for-bit
+   Values are compared bitwise, so a NaN missing value matches itself and -0.0 does not match 0.0 */
+
+static size_t /* O [nbr] Number of valid (non-missing) values */
+ccr_fmk_msk_scl /* [fnc] Validity bitmap of values */
+(const size_t sz, /* I [nbr] Number of values */
+ const size_t datum_size, /* I [B] Bytes per value (1, 2, 4, or 8) */
+ const void *op1, /* I [val] Values to scan */
+ const void *mss_val, /* I [val] Missing value */
+ unsigned char *msk) /* O [flg] Validity bitmap, (sz+7)/8 bytes */
+{
+  size_t vld_nbr=0; /* [nbr] Valid values */
+  size_t idx;
+  unsigned int byt=0U; /* [flg] Bitmap byte being built */
+  int vld; /* [flg] Current value is valid */
+  uint8_t mss_val_u8=0; /* [val] Missing value as 1-byte integer */
+  uint16_t mss_val_u16=0; /* [val] Missing value as 2-byte integer */
+  uint32_t mss_val_u32=0; /* [val] Missing value as 4-byte integer */
+  uint64_t mss_val_u64=0; /* [val] Missing value as 8-byte integer */
+
+  /* Missing value may be unaligned, so copy it into an integer of the same size */
+  memcpy(&mss_val_u8,mss_val,1);
+  if(datum_size >= 2) memcpy(&mss_val_u16,mss_val,2);
+  if(datum_size >= 4) memcpy(&mss_val_u32,mss_val,4);
+  if(datum_size >= 8) memcpy(&mss_val_u64,mss_val,8);
+
+  for(idx=0;idx<sz;idx++){
+    switch(datum_size){
+    case 1: vld=((const uint8_t *)op1)[idx] != mss_val_u8; break;
+    case 2: vld=((const uint16_t *)op1)[idx] != mss_val_u16; break;
+    case 4: vld=((const uint32_t *)op1)[idx] != mss_val_u32; break;
+    default: vld=((const uint64_t *)op1)[idx] != mss_val_u64; break;
+    } /* !datum_size */
+    if(vld){
+      byt|=1U << (idx%8);
+      vld_nbr++;
+    } /* !vld */
+    if(idx%8 == 7){
+      msk[idx/8]=(unsigned char)byt;
+      byt=0U;
+    } /* !idx */
+  } /* !idx */
+  if(sz%8) msk[sz/8]=(unsigned char)byt;
+  return vld_nbr;
+} /* !ccr_fmk_msk_scl() */
+
+#ifdef CCR_SIMD_X86
+/* Vector kernel compares 32 bytes per step and turns comparison lanes into bitmap bits with movemask
+   Each step covers a multiple of eight values, so remainders start on a bitmap byte and go to scalar kernel */
+
+__attribute__((target("avx2")))
+static size_t /* O [nbr] Number of valid (non-missing) values */
+ccr_fmk_msk_avx2 /* [fnc] Validity bitmap of values with AVX2 */
+(const size_t sz, /* I [nbr] Number of values */
+ const size_t datum_size, /* I [B] Bytes per value (1, 2, 4, or 8) */
+ const void *op1, /* I [val] Values to scan */
+ const void *mss_val, /* I [val] Missing value */
+ unsigned char *msk) /* O [flg] Validity bitmap, (sz+7)/8 bytes */
+{
+  const unsigned char *bp=(const unsigned char *)op1; /* [ptr] Values as bytes */
+  size_t vld_nbr=0; /* [nbr] Valid values */
+  size_t idx=0;
+  unsigned int vld; /* [flg] Validity bits of one step */
+  char mss_val_i8; /* [val] Missing value as 1-byte integer */
+  short mss_val_i16; /* [val] Missing value as 2-byte integer */
+  int mss_val_i32; /* [val] Missing value as 4-byte integer */
+  long long mss_val_i64; /* [val] Missing value as 8-byte integer */
+
+  if(datum_size == 1){
+    memcpy(&mss_val_i8,mss_val,1);
+    const __m256i mss_val_vct=_mm256_set1_epi8(mss_val_i8);
+    for(idx=0;idx+32<=sz;idx+=32){
+      const __m256i val_vct=_mm256_loadu_si256((const __m256i *)(bp+idx));
+      vld=~(unsigned int)_mm256_movemask_epi8(_mm256_cmpeq_epi8(val_vct,mss_val_vct));
+      vld_nbr+=(size_t)__builtin_popcount(vld);
+      memcpy(msk+idx/8,&vld,4);
+    } /* !idx */
+  }else if(datum_size == 2){
+    memcpy(&mss_val_i16,mss_val,2);
+    const __m256i mss_val_vct=_mm256_set1_epi16(mss_val_i16);
+    for(idx=0;idx+32<=sz;idx+=32){
+      const __m256i eq1=_mm256_cmpeq_epi16(_mm256_loadu_si256((const __m256i *)(bp+2*idx)),mss_val_vct);
+      const __m256i eq2=_mm256_cmpeq_epi16(_mm256_loadu_si256((const __m256i *)(bp+2*idx+32)),mss_val_vct);
+      /* Saturating pack interleaves 128-bit halves, permute restores value order */
+      const __m256i eq=_mm256_permute4x64_epi64(_mm256_packs_epi16(eq1,eq2),0xD8);
+      vld=~(unsigned int)_mm256_movemask_epi8(eq);
+      vld_nbr+=(size_t)__builtin_popcount(vld);
+      memcpy(msk+idx/8,&vld,4);
+    } /* !idx */
+  }else if(datum_size == 4){
+    memcpy(&mss_val_i32,mss_val,4);
+    const __m256i mss_val_vct=_mm256_set1_epi32(mss_val_i32);
+    for(idx=0;idx+8<=sz;idx+=8){
+      const __m256i eq=_mm256_cmpeq_epi32(_mm256_loadu_si256((const __m256i *)(bp+4*idx)),mss_val_vct);
+      vld=~(unsigned int)_mm256_movemask_ps(_mm256_castsi256_ps(eq)) & 0xFFU;
+      vld_nbr+=(size_t)__builtin_popcount(vld);
+      msk[idx/8]=(unsigned char)vld;
+    } /* !idx */
+  }else{
+    memcpy(&mss_val_i64,mss_val,8);
+    const __m256i mss_val_vct=_mm256_set1_epi64x(mss_val_i64);
+    for(idx=0;idx+8<=sz;idx+=8){
+      const __m256i eq1=_mm256_cmpeq_epi64(_mm256_loadu_si256((const __m256i *)(bp+8*idx)),mss_val_vct);
+      const __m256i eq2=_mm256_cmpeq_epi64(_mm256_loadu_si256((const __m256i *)(bp+8*idx+32)),mss_val_vct);
+      vld=~(unsigned int)(_mm256_movemask_pd(_mm256_castsi256_pd(eq1)) | (_mm256_movemask_pd(_mm256_castsi256_pd(eq2)) << 4)) & 0xFFU;
+      vld_nbr+=(size_t)__builtin_popcount(vld);
+      msk[idx/8]=(unsigned char)vld;
+    } /* !idx */
+  } /* !datum_size */
+  return vld_nbr+ccr_fmk_msk_scl(sz-idx,datum_size,bp+idx*datum_size,mss_val,msk+idx/8);
+} /* !ccr_fmk_msk_avx2() */
+#endif /* !CCR_SIMD_X86 */
+
+void
+ccr_fmk_cpu_dispatch /* [fnc] Select fastest mask kernel supported by this CPU */
+(void)
+{
+  /* Purpose: Query CPUID (through compiler builtins that also check OS register-state support) and point kernel at widest supported instruction set
+     Results are identical for all kernels, only speed differs */
+  ccr_fmk_msk_knl=ccr_fmk_msk_scl;
+  ccr_fmk_knl_nm="scalar";
+#ifdef CCR_SIMD_X86
+  __builtin_cpu_init();
+  if(__builtin_cpu_supports("avx2")){
+    ccr_fmk_msk_knl=ccr_fmk_msk_avx2;
+    ccr_fmk_knl_nm="AVX2";
+  } /* !__builtin_cpu_supports() */
+#endif /* !CCR_SIMD_X86 */
+  if(CCR_FLT_DBG_INFO) (void)fprintf(stderr,"INFO: \"%s\" filter selected %s kernel\n",CCR_FLT_NAME,ccr_fmk_knl_nm);
+} /* !ccr_fmk_cpu_dispatch() */
@@ -0,0 +1,442 @@
+/* Copyright (C) 2026--present Charlie Zender */
+
+ /*
+ * This file is an example of an HDF5 filter plugin.
+ * The plugin can be used with the HDF5 library version 1.8.11+ to read and write
+ * single-precision HDF5 datasets stored as 16-bit IEEE half-precision or bfloat16 values.
+ */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h" /* Autotools tokens */
+#endif
+#include <stdio.h>
+#ifdef HAVE_SYS_TYPES_H
+# include <sys/types.h>
+#endif
+#ifdef HAVE_SYS_STAT_H
+# include <sys/stat.h>
+#endif
+#ifdef STDC_HEADERS
+# include <stdlib.h>
+# include <stddef.h>
+#else
+# ifdef HAVE_STDLIB_H
+#  include <stdlib.h>
+# endif
+#endif
+#ifdef HAVE_STRING_H
+# if !defined STDC_HEADERS && defined HAVE_MEMORY_H
+#  include <memory.h>
+# endif
+# include <string.h>
+#endif
+#ifdef HAVE_STRINGS_H
+# include <strings.h>
+#endif
+#ifdef HAVE_INTTYPES_H
+# include <inttypes.h>
+#endif
+#ifdef HAVE_STDINT_H
+# include <stdint.h>
+#endif
+#ifdef HAVE_UNISTD_H
+# include <unistd.h>
+#endif
+#include <assert.h>
+
+#if defined(_WIN32)
+#include <Winsock2.h>
+#endif
+
+/* 3rd party vendors */
+#include "H5PLextern.h" /* HDF5 Plugin Library: H5PLget_plugin_type(), H5PLget_plugin_info() */
+
+/* Tokens and typedefs */
+#define H5Z_FILTER_FLOAT16 32769 /* NB: Not yet registered with HDF, see ccr.h */
+#define CCR_FLT_DBG_INFO 0 /* [flg] Print non-fatal debugging information */
+#define CCR_FLT_NAME "Float16 filter (IEEE 754 binary16 or bfloat16 storage of float32)" /* [sng] Filter name in vernacular for HDF5 messages */
+#define CCR_FLT_FMT_IEEE 0 /* [enm] IEEE 754 binary16: 10 explicit mantissa bits, largest finite value 65504 */
+#define CCR_FLT_FMT_BF16 1 /* [enm] bfloat16: 7 explicit mantissa bits, same exponent range as float32 */
+#define CCR_FLT_FMT_DFL CCR_FLT_FMT_IEEE /* [enm] Default storage format */
+#define CCR_FLT_PRM_NBR 5 /* [nbr] Number of parameters sent to filter (in cd_params array). NB: keep identical with ccr.h:FLOAT16_FLT_PRM_NBR */
+#define CCR_FLT_PRM_PSN_FMT 0 /* [nbr] Ordinal position of storage format in parameter list (cd_params array) */
+#define CCR_FLT_PRM_PSN_DATUM_SIZE 1 /* [nbr] Ordinal position of datum_size in parameter list (cd_params array) */
+#define CCR_FLT_PRM_PSN_HAS_MSS_VAL 2 /* [nbr] Ordinal position of missing value flag in parameter list (cd_params array) */
+#define CCR_FLT_PRM_PSN_MSS_VAL 3 /* [nbr] Ordinal position of missing value in parameter list (cd_params array) NB: Missing value (_FillValue) uses two cd_params slots for compatibility with the quantization filters. Single-precision values are read as first 4-bytes starting at cd_params[3] (and cd_params[4] is ignored). */
+/* Missing values rarely fit in 16 bits (NC_FILL_FLOAT overflows binary16), so each format reserves one NaN payload that decodes to the missing value exactly
+   Encoded NaNs are canonicalized to quiet NaNs without payload so they never collide with the reserved code */
+#define CCR_F16_MSS_VAL 0x7E01U /* [bit] Reserved binary16 code for missing value */
+#define CCR_F16_NAN 0x7E00U /* [bit] Canonical binary16 quiet NaN */
+#define CCR_BF16_MSS_VAL 0x7FC1U /* [bit] Reserved bfloat16 code for missing value */
+#define CCR_BF16_NAN 0x7FC0U /* [bit] Canonical bfloat16 quiet NaN */
+
+/* Compatibility tokens and typedefs retain source-code compatibility between NCO and filter
+   These tokens mimic netCDF/NCO code but do not rely on or interfere with either */
+#ifndef NC_FILL_FLOAT
+# define NC_FILL_FLOAT   (9.9692099683868690e+36f) /* near 15 * 2^119 */
+#endif /* !NC_FILL_FLOAT */
+
+/* Forward-declare functions before their names appear in H5Z_class2_t filter structure */
+size_t /* O [B] Number of bytes resulting after forward/reverse filter applied */
+H5Z_filter_float16 /* [fnc] HDF5 Float16 Filter */
+(unsigned int flags, /* I [flg] Bitfield that encodes filter direction */
+ size_t cd_nelmts, /* I [nbr] Number of elements in filter parameter (cd_values[]) array */
+ const unsigned int cd_values[], /* I [enm] Filter parameters */
+ size_t bfr_sz_in, /* I [B] Number of bytes in input buffer (before forward/reverse filter) */
+ size_t *bfr_sz_out, /* O [B] Number of bytes in output buffer (after forward/reverse filter) */
+ void **bfr_inout); /* I/O [frc] Values to encode or decode */
+
+htri_t /* O [flg] Data meet criteria to apply filter */
+ccr_can_apply_float16 /* [fnc] Callback to determine if current variable meets filter criteria */
+(hid_t dcpl, /* I [id] Dataset creation property list ID */
+ hid_t type, /* I [id] Dataset type ID */
+ hid_t space); /* I [id] Dataset space ID */
+
+htri_t /* O [flg] Filter parameters successfully modified for this variable */
+ccr_set_local_float16 /* [fnc] Callback to determine and set per-variable filter parameters */
+(hid_t dcpl, /* I [id] Dataset creation property list ID */
+ hid_t type, /* I [id] Dataset type ID */
+ hid_t space); /* I [id] Dataset space ID */
+
+const H5Z_class2_t H5Z_FLOAT16[1]={{
+    H5Z_CLASS_T_VERS, /* H5Z_class_t version */
+    (H5Z_filter_t)H5Z_FILTER_FLOAT16, /* Filter ID number */
+#ifdef FILTER_DECODE_ONLY
+    0, /* [flg] Encoder availability flag */
+#else
+    1, /* [flg] Encoder availability flag */
+#endif
+    1, /* [flg] Decoder availability flag */
+    CCR_FLT_NAME, /* [sng] Filter name for debugging */
+    ccr_can_apply_float16, /* [fnc] Callback to determine if current variable meets filter criteria */
+    ccr_set_local_float16, /* [fnc] Callback to determine and set per-variable filter parameters */
+    (H5Z_func_t)H5Z_filter_float16, /* [fnc] Function to implement filter */
+  }}; /* !H5Z_FLOAT16 */
+
+unsigned short /* O [bit] binary16 value */
+ccr_f32_f16 /* [fnc] Round float32 to nearest binary16, ties to even */
+(const unsigned int u32); /* I [bit] float32 value */
+
+float /* O [frc] float32 value */
+ccr_f16_f32 /* [fnc] Expand binary16 to float32 exactly */
+(const unsigned short u16); /* I [bit] binary16 value */
+
+unsigned short /* O [bit] bfloat16 value */
+ccr_f32_bf16 /* [fnc] Round float32 to nearest bfloat16, ties to even */
+(const unsigned int u32); /* I [bit] float32 value */
+
+/* Function definitions */
+H5PL_type_t /* O [enm] Plugin type */
+H5PLget_plugin_type /* [fnc] Provide plug-in type provided by this shared library */
+(void)
+{ /* Purpose: Describe plug-in type provided by this shared library
+     The HDF5 plugin mechanism usually calls this function after an application calls H5Pset_filter(), or when the data to which this filter will be applied are first read */
+  return H5PL_TYPE_FILTER;
+} /* !H5PLget_plugin_type() */
+
+const void * /* O [enm] */
+H5PLget_plugin_info /* [fnc] Return structure */
+(void)
+{ /* Purpose: Provide structure that defines Float16 filter so the filter may be dynamically registered with the plugin mechanism
+     The HDF5 plugin mechanism usually calls this function after an application calls H5Pset_filter(), or when the data to which this filter will be applied are first read */
+  return H5Z_FLOAT16;
+} /* !H5PLget_plugin_info() */
+
+size_t /* O [B] Number of bytes resulting after forward/reverse filter applied */
+H5Z_filter_float16 /* [fnc] HDF5 Float16 Filter */
+(unsigned int flags, /* I [flg] Bitfield that encodes filter direction */
+ size_t cd_nelmts, /* I [nbr] Number of elements in filter parameter (cd_values[]) array */
+ const unsigned int cd_values[], /* I [enm] Filter parameters */
+ size_t bfr_sz_in, /* I [B] Number of bytes in input buffer (before forward/reverse filter) */
+ size_t *bfr_sz_out, /* O [B] Number of bytes in output buffer (after forward/reverse filter) */
+ void **bfr_inout) /* I/O [frc] Values to encode or decode */
+{
+  /* Purpose: Dynamic filter invoked by HDF5 to store float32 values in 16 bits, and expand them on read
+     Forward filter rounds each value to nearest 16-bit value in place and halves the buffer
+     Reverse filter grows the buffer and expands each 16-bit value back to float32 */
+
+  const char fnc_nm[]="H5Z_filter_float16()"; /* [sng] Function name */
+
+  int fmt; /* [enm] Storage format */
+  int has_mss_val; /* [flg] Flag for missing values */
+  size_t datum_size; /* [B] Bytes per unfiltered data value */
+  size_t elm_nbr; /* [nbr] Number of values in buffer */
+  size_t idx; /* [idx] Counting index */
+  float mss_val; /* [val] Value of missing value */
+  unsigned int mss_val_u32; /* [bit] Missing value as bits */
+  unsigned int *u32_ptr; /* [ptr] Buffer as float32 bits */
+  unsigned short *u16_ptr; /* [ptr] Buffer as 16-bit values */
+  unsigned short mss_val_cd; /* [bit] Reserved code for missing value */
+
+  if(cd_nelmts < CCR_FLT_PRM_NBR){
+    (void)fprintf(stderr,"ERROR: \"%s\" filter function %s reports %lu parameters, needs %d\n",CCR_FLT_NAME,fnc_nm,(unsigned long)cd_nelmts,CCR_FLT_PRM_NBR);
+    goto error;
+  } /* !cd_nelmts */
+
+  fmt=cd_values[CCR_FLT_PRM_PSN_FMT];
+  datum_size=cd_values[CCR_FLT_PRM_PSN_DATUM_SIZE];
+  has_mss_val=cd_values[CCR_FLT_PRM_PSN_HAS_MSS_VAL];
+  if(has_mss_val) memcpy(&mss_val,cd_values+CCR_FLT_PRM_PSN_MSS_VAL,sizeof(float)); else mss_val=NC_FILL_FLOAT;
+  memcpy(&mss_val_u32,&mss_val,sizeof(float));
+
+  if(CCR_FLT_DBG_INFO) (void)fprintf(stderr,"INFO: %s reports format = %d, datum size = %lu B, has_mss_val = %d, missing value = %g\n",fnc_nm,fmt,(unsigned long)datum_size,has_mss_val,mss_val);
+
+  if(datum_size != sizeof(float)){
+    (void)fprintf(stderr,"ERROR: \"%s\" filter function %s reports datum size = %lu B is invalid, only 4 B float32 is supported\n",CCR_FLT_NAME,fnc_nm,(unsigned long)datum_size);
+    goto error;
+  } /* !datum_size */
+  if(fmt != CCR_FLT_FMT_IEEE && fmt != CCR_FLT_FMT_BF16){
+    (void)fprintf(stderr,"ERROR: \"%s\" filter function %s reports format = %d is invalid\n",CCR_FLT_NAME,fnc_nm,fmt);
+    goto error;
+  } /* !fmt */
+  mss_val_cd=(fmt == CCR_FLT_FMT_IEEE) ? CCR_F16_MSS_VAL : CCR_BF16_MSS_VAL;
+
+  if(flags & H5Z_FLAG_REVERSE){
+
+    /* Expand to float32. Grow buffer first, then convert from last value to first so no 16-bit value is overwritten before it is read */
+    elm_nbr=bfr_sz_in/sizeof(unsigned short);
+    if(*bfr_sz_out < elm_nbr*sizeof(float)){
+      void *bfr_new; /* [ptr] Grown buffer */
+      if(!(bfr_new=realloc(*bfr_inout,elm_nbr*sizeof(float)))){
+	(void)fprintf(stderr,"ERROR: \"%s\" filter function %s unable to allocate %lu B for decoded data\n",CCR_FLT_NAME,fnc_nm,(unsigned long)(elm_nbr*sizeof(float)));
+	goto error;
+      } /* !bfr_new */
+      *bfr_inout=bfr_new;
+      *bfr_sz_out=elm_nbr*sizeof(float);
+    } /* !bfr_sz_out */
+    u16_ptr=(unsigned short *)(*bfr_inout);
+    u32_ptr=(unsigned int *)(*bfr_inout);
+    if(fmt == CCR_FLT_FMT_IEEE){
+      for(idx=elm_nbr;idx-- > 0;){
+	unsigned short u16=u16_ptr[idx];
+	float f32; /* [frc] Expanded value */
+	if(u16 == mss_val_cd){
+	  u32_ptr[idx]=mss_val_u32;
+	}else{
+	  f32=ccr_f16_f32(u16);
+	  memcpy(u32_ptr+idx,&f32,sizeof(float));
+	} /* !u16 */
+      } /* !idx */
+    }else{
+      for(idx=elm_nbr;idx-- > 0;){
+	unsigned short u16=u16_ptr[idx];
+	u32_ptr[idx]=(u16 == mss_val_cd) ? mss_val_u32 : ((unsigned int)u16 << 16);
+      } /* !idx */
+    } /* !fmt */
+    return elm_nbr*sizeof(float);
+
+  }else{ /* !flags */
+
+    /* Round to 16 bits in place. Output value idx occupies bytes that input values before idx held, so no float32 is overwritten before it is read */
+    elm_nbr=bfr_sz_in/sizeof(float);
+    u16_ptr=(unsigned short *)(*bfr_inout);
+    u32_ptr=(unsigned int *)(*bfr_inout);
+    if(fmt == CCR_FLT_FMT_IEEE){
+      for(idx=0;idx<elm_nbr;idx++){
+	unsigned int u32=u32_ptr[idx];
+	u16_ptr[idx]=(u32 == mss_val_u32) ? mss_val_cd : ccr_f32_f16(u32);
+      } /* !idx */
+    }else{
+      for(idx=0;idx<elm_nbr;idx++){
+	unsigned int u32=u32_ptr[idx];
+	u16_ptr[idx]=(u32 == mss_val_u32) ? mss_val_cd : ccr_f32_bf16(u32);
+      } /* !idx */
+    } /* !fmt */
+    /* Return upper half of buffer that 16-bit values no longer use, keep whole buffer if realloc() fails */
+    if(elm_nbr > 0 && *bfr_sz_out > elm_nbr*sizeof(unsigned short)){
+      void *bfr_new; /* [ptr] Shrunk buffer */
+      if((bfr_new=realloc(*bfr_inout,elm_nbr*sizeof(unsigned short)))){
+	*bfr_inout=bfr_new;
+	*bfr_sz_out=elm_nbr*sizeof(unsigned short);
+      } /* !bfr_new */
+    } /* !bfr_sz_out */
+    return elm_nbr*sizeof(unsigned short);
+
+  } /* !flags */
+
+ error:
+  return 0;
+
+} /* !H5Z_filter_float16() */
+
+htri_t /* O [flg] Data meet criteria to apply filter */
+ccr_can_apply_float16 /* [fnc] Callback to determine if current variable meets filter criteria */
+(hid_t dcpl, /* I [id] Dataset creation property list ID */
+ hid_t type, /* I [id] Dataset type ID */
+ hid_t space) /* I [id] Dataset space ID */
+{
+  /* Data space must be simple, i.e., a multi-dimensional array */
+  if(H5Sis_simple(space) <= 0){
+    fprintf(stderr,"WARNING: Cannot apply filter \"%s\" filter because data space is not simple.\n",CCR_FLT_NAME);
+    return 0;
+  } /* !H5Sis_simple(space) */
+
+  /* Filter can be applied */
+  return 1;
+} /* !ccr_can_apply_float16() */
+
+htri_t /* O [flg] Filter parameters successfully modified for this variable */
+ccr_set_local_float16 /* [fnc] Callback to determine and set per-variable filter parameters */
+(hid_t dcpl, /* I [id] Dataset creation property list ID */
+ hid_t type, /* I [id] Dataset type ID */
+ hid_t space) /* I [id] Dataset space ID */
+{
+  const char fnc_nm[]="ccr_set_local_float16()"; /* [sng] Function name */
+
+  herr_t rcd; /* [flg] Return code */
+
+  /* Initialize filter parameters with default values */
+  unsigned int ccr_flt_prm[CCR_FLT_PRM_NBR]={CCR_FLT_FMT_DFL,0,0,0,0};
+
+  /* Initialize output variables for call to H5Pget_filter_by_id() */
+  unsigned int flags=0;
+  size_t cd_nelmts=CCR_FLT_PRM_NBR;
+  unsigned int *cd_values=ccr_flt_prm;
+
+  /* Retrieve parameters specified by user
+     https://support.hdfgroup.org/HDF5/doc/RM/RM_H5P.html#FunctionIndex
+     Ignore name and filter_config by setting last three arguments to 0/NULL */
+  rcd=H5Pget_filter_by_id(dcpl,H5Z_FILTER_FLOAT16,&flags,&cd_nelmts,cd_values,0,NULL,NULL);
+  if(rcd < 0){
+    (void)fprintf(stderr,"ERROR: %s filter callback function %s reports H5Pget_filter_by_id() failed to get filter flags and parameters for current variable\n",CCR_FLT_NAME,fnc_nm);
+    return 0;
+  } /* !rcd */
+
+  /* Data class and datum size for this variable
+     Only float32 has a 16-bit form, so remove filter from other types, as quantization filters do for integers */
+  H5T_class_t data_class; /* [enm] Data type class identifier (H5T_FLOAT, H5T_INT, H5T_STRING, ...) */
+  size_t datum_size; /* [B] Bytes per data value */
+  data_class=H5Tget_class(type);
+  if(data_class < 0){
+    (void)fprintf(stderr,"ERROR: %s filter callback function %s reports H5Tget_class() returned invalid data type class identifier = %d for current variable\n",CCR_FLT_NAME,fnc_nm,(int)data_class);
+    return 0;
+  } /* !data_class */
+  datum_size=H5Tget_size(type);
+  if(datum_size <= 0){
+    (void)fprintf(stderr,"ERROR: %s filter callback function %s reports H5Tget_size() returned invalid datum size = %lu B\n",CCR_FLT_NAME,fnc_nm,datum_size);
+    return 0;
+  } /* !datum_size */
+  if(data_class != H5T_FLOAT || datum_size != sizeof(float)){
+    if(CCR_FLT_DBG_INFO){
+      (void)fprintf(stdout,"INFO: \"%s\" filter callback function %s reports data type class identifier = %d, datum size = %lu B is not float32. Attempting to remove filter using H5Premove_filter()...",CCR_FLT_NAME,fnc_nm,(int)data_class,datum_size);
+    } /* !CCR_FLT_DBG_INFO */
+    rcd=H5Premove_filter(dcpl,H5Z_FILTER_FLOAT16);
+    if(rcd < 0){
+      if(CCR_FLT_DBG_INFO) (void)fprintf(stdout,"failure :(\n");
+      return 0;
+    } /* !rcd */
+    if(CCR_FLT_DBG_INFO) (void)fprintf(stdout,"success!\n");
+    return 1;
+  } /* !data_class */
+
+  /* Set datum size in filter parameter list */
+  ccr_flt_prm[CCR_FLT_PRM_PSN_DATUM_SIZE]=(unsigned int)datum_size;
+
+  /* Find, set, and pass per-variable has_mss_val and mss_val arguments
+     https://support.hdfgroup.org/HDF5/doc_resource/H5Fill_Values.html */
+  int has_mss_val=0; /* [flg] Flag for missing values */
+
+  H5D_fill_value_t status;
+  rcd=H5Pfill_value_defined(dcpl,&status);
+  if(rcd < 0){
+    (void)fprintf(stdout,"ERROR: \"%s\" filter callback function %s reports H5Pfill_value_defined() returns error code = %d\n",CCR_FLT_NAME,fnc_nm,rcd);
+    return 0;
+  } /* !rcd */
+
+  if(status == H5D_FILL_VALUE_USER_DEFINED){
+    float mss_val; /* [val] Value of missing value */
+
+    has_mss_val=1;
+    rcd=H5Pget_fill_value(dcpl,type,&mss_val);
+    if(rcd < 0){
+      (void)fprintf(stdout,"ERROR: \"%s\" filter callback function %s reports H5Pget_fill_value() returns error code = %d\n",CCR_FLT_NAME,fnc_nm,rcd);
+      return 0;
+    } /* !rcd */
+    if(CCR_FLT_DBG_INFO) (void)fprintf(stderr,"INFO: \"%s\" filter callback function %s reports missing value = %g\n",CCR_FLT_NAME,fnc_nm,mss_val);
+
+    /* Set missing value in filter parameter list */
+    memcpy(cd_values+CCR_FLT_PRM_PSN_MSS_VAL,&mss_val,sizeof(float));
+  } /* !status */
+
+  /* Set missing value flag in filter parameter list */
+  ccr_flt_prm[CCR_FLT_PRM_PSN_HAS_MSS_VAL]=has_mss_val;
+
+  /* Update invoked filter with generic parameters as invoked with variable-specific values */
+  rcd=H5Pmodify_filter(dcpl,H5Z_FILTER_FLOAT16,flags,CCR_FLT_PRM_NBR,cd_values);
+  if(rcd < 0){
+    (void)fprintf(stderr,"ERROR: \"%s\" filter callback function %s reports H5Pmodify_filter() unable to modify filter parameters\n",CCR_FLT_NAME,fnc_nm);
+    return 0;
+  } /* !rcd */
+
+  return 1;
+} /* !ccr_set_local_float16() */
+
+unsigned short /* O [bit] binary16 value */
+ccr_f32_f16 /* [fnc] Round float32 to nearest binary16, ties to even */
+(const unsigned int u32) /* I [bit] float32 value */
+{
+  /* Purpose: Convert float32 bits to binary16 bits as IEEE 754 roundTiesToEven does
+     Magnitudes of 65520 and greater overflow to infinity, magnitudes below 2^-14 become subnormal */
+  const unsigned short sgn=(unsigned short)((u32 >> 16) & 0x8000U); /* [bit] Sign bit */
+  const unsigned int mag=u32 & 0x7FFFFFFFU; /* [bit] Magnitude */
+  unsigned int f16; /* [bit] Magnitude of result */
+  unsigned int rmd; /* [bit] Discarded bits */
+  unsigned int hlf; /* [bit] Half of last kept bit */
+
+  if(mag >= 0x7F800000U) return sgn | (mag > 0x7F800000U ? CCR_F16_NAN : 0x7C00U);
+  /* 65520 is halfway between 65504 (largest binary16) and 65536, and ties away from odd 65504 */
+  if(mag >= 0x477FF000U) return sgn | 0x7C00U;
+  if(mag >= 0x38800000U){
+    /* Normal: rebias exponent from 127 to 15, keep 10 of 23 mantissa bits */
+    f16=(mag-0x38000000U) >> 13;
+    rmd=mag & 0x1FFFU;
+    hlf=0x1000U;
+  }else{
+    /* Subnormal or zero: value is k*2^-24, so shift implicit-bit mantissa right by 126-exponent */
+    unsigned int shf; /* [nbr] Bits to discard */
+    unsigned int mnt; /* [bit] Mantissa with implicit bit */
+    if(mag <= 0x33000000U) return sgn; /* At most 2^-25, rounds to zero */
+    shf=126U-(mag >> 23);
+    mnt=(mag & 0x7FFFFFU) | 0x800000U;
+    f16=mnt >> shf;
+    rmd=mnt & ((1U << shf)-1U);
+    hlf=1U << (shf-1U);
+  } /* !mag */
+  /* Carry out of mantissa correctly increments exponent */
+  if(rmd > hlf || (rmd == hlf && (f16 & 1U))) f16++;
+  return sgn | (unsigned short)f16;
+} /* !ccr_f32_f16() */
+
+float /* O [frc] float32 value */
+ccr_f16_f32 /* [fnc] Expand binary16 to float32 exactly */
+(const unsigned short u16) /* I [bit] binary16 value */
+{
+  /* Purpose: Convert binary16 bits to float32, which represents every binary16 value exactly */
+  const unsigned int sgn=((unsigned int)u16 & 0x8000U) << 16; /* [bit] Sign bit */
+  const unsigned int xpn=((unsigned int)u16 >> 10) & 0x1FU; /* [bit] Biased exponent */
+  const unsigned int mnt=(unsigned int)u16 & 0x3FFU; /* [bit] Mantissa */
+  unsigned int u32; /* [bit] Result */
+  float f32; /* [frc] Result */
+
+  if(xpn == 0x1FU){
+    u32=sgn | 0x7F800000U | (mnt << 13);
+  }else if(xpn == 0U){
+    /* Zero or subnormal, mnt*2^-24 is exact in float32 */
+    f32=(float)mnt*5.9604644775390625e-8f;
+    return sgn ? -f32 : f32;
+  }else{
+    u32=sgn | ((xpn+112U) << 23) | (mnt << 13);
+  } /* !xpn */
+  memcpy(&f32,&u32,sizeof(float));
+  return f32;
+} /* !ccr_f16_f32() */
+
+unsigned short /* O [bit] bfloat16 value */
+ccr_f32_bf16 /* [fnc] Round float32 to nearest bfloat16, ties to even */
+(const unsigned int u32) /* I [bit] float32 value */
+{
+  /* Purpose: Convert float32 bits to bfloat16 bits, i.e., round away low 16 bits
+     bfloat16 shares float32 exponent, so only values within half a bfloat16 ulp of FLT_MAX overflow */
+  if((u32 & 0x7FFFFFFFU) > 0x7F800000U) return (unsigned short)((u32 >> 16) & 0x8000U) | CCR_BF16_NAN;
+  return (unsigned short)((u32+0x7FFFU+((u32 >> 16) & 1U)) >> 16);
+} /* !ccr_f32_bf16() */
@@ -67,10 +67,12 @@
 #define CCR_FLT_NAME "Granular BitRound filter" /* [sng] Filter name in vernacular for HDF5 messages */
 #define CCR_FLT_NSD_DFL 3 /* [nbr] Default number of significant digits for quantization */
 #define CCR_FLT_PRM_NBR 5 /* [nbr] Number of parameters sent to filter (in cd_params array). NB: keep identical with ccr.h:GRANULARBR_FLT_PRM_NBR */
-#define CCR_FLT_PRM_PSN_NSD 0 /* [nbr] Ordinal position of NSD in parameter list (cd_params array) */
+#define CCR_FLT_PRM_NBR_ABS 7 /* [nbr] Number of parameters in absolute error mode, which alone stores the error bound. NB: keep identical with ccr.h:GRANULARBR_ABS_FLT_PRM_NBR */
+#define CCR_FLT_PRM_PSN_NSD 0 /* [nbr] Ordinal position of NSD in parameter list (cd_params array). NSD of 0 selects absolute error mode. */
 #define CCR_FLT_PRM_PSN_DATUM_SIZE 1 /* [nbr] Ordinal position of datum_size in parameter list (cd_params array) */
 #define CCR_FLT_PRM_PSN_HAS_MSS_VAL 2 /* [nbr] Ordinal position of missing value flag in parameter list (cd_params array) */
 #define CCR_FLT_PRM_PSN_MSS_VAL 3 /* [nbr] Ordinal position of missing value in parameter list (cd_params array) NB: Missing value (_FillValue) uses two cd_params slots so it can be single or double-precision. Single-precision values are read as first 4-bytes starting at cd_params[4] (and cd_params[5] is ignored), while double-precision values are read as first 8-bytes starting at cd_params[4] and ending with cd_params[5]. */
+#define CCR_FLT_PRM_PSN_ABS_ERR 5 /* [nbr] Ordinal position of absolute error used when NSD is 0 in parameter list (cd_params array) NB: Absolute error is a double and uses two cd_params slots. NSD mode stores only the first five parameters. */
 
 /* Compatibility tokens and typedefs retain source-code compatibility between NCO and filter
    These tokens mimic netCDF/NCO code but do not rely on or interfere with either */
@@ -87,12 +89,6 @@
 # define NC_FILL_DOUBLE  (9.9692099683868690e+36)
 #endif /* !NC_FILL_DOUBLE */
 
-/* Minimum number of explicit significand bits to preserve when zeroing/bit-masking floating point values
-   Codes will preserve at least two explicit bits, IEEE significand representation contains one implicit bit
-   Thus preserve a least three bits which is approximately one sigificant decimal digit
-   Used in nco_ppc_bitmask() and nco_ppc_bitmask_scl() */
-#define NCO_PPC_BIT_XPL_NBR_MIN 2
-
 /* Pointer union for floating point and bitmask types */
 typedef union{ /* ptr_unn */
   float *fp;
@@ -148,6 +144,19 @@ ccr_gbr /* [fnc] Granular BitRound buffer of float values */
  ptr_unn mss_val, /* I [val] Value of missing value */
  ptr_unn op1); /* I/O [frc] Values to quantize */
 
+void
+ccr_gbr_abs /* [fnc] Granular BitRound buffer of float values to absolute error */
+(const double abs_err, /* I [frc] Maximum absolute error */
+ const int type, /* I [enm] netCDF type of operand */
+ const size_t sz, /* I [nbr] Size (in elements) of buffer to quantize */
+ const int has_mss_val, /* I [flg] Flag for missing values */
+ ptr_unn mss_val, /* I [val] Value of missing value */
+ ptr_unn op1); /* I/O [frc] Values to quantize */
+
+void
+ccr_gbr_knl_ini /* [fnc] Select Granular BitRound kernels once per process, from any thread */
+(void);
+
 /* Function definitions */
 H5PL_type_t /* O [enm] Plugin type */
 H5PLget_plugin_type /* [fnc] Provide plug-in type provided by this shared library */
@@ -162,6 +171,8 @@ H5PLget_plugin_info /* [fnc] Return structure */
 (void)
 { /* Purpose: Provide structure that defines Granular BitRound filter so the filter may be dynamically registered with the plugin mechanism
      The HDF5 plugin mechanism usually calls this function after an application calls H5Pset_filter(), or when the data to which this filter will be applied are first read */
+  /* Plugin is being loaded, so this is the time to choose SIMD kernels */
+  ccr_gbr_knl_ini();
   return H5Z_GRANULARBR;
 } /* !H5PLget_plugin_info() */
 
@@ -189,6 +200,7 @@ H5Z_filter_granularbr /* [fnc] HDF5 Granular BitRound Filter */
 
     /* Set parameters needed by quantization library filter */
     int nsd=cd_values[CCR_FLT_PRM_PSN_NSD];
+    double abs_err=0.0; /* [frc] Maximum absolute error, used when NSD is 0 */
     size_t datum_size=cd_values[CCR_FLT_PRM_PSN_DATUM_SIZE];
     int has_mss_val=cd_values[CCR_FLT_PRM_PSN_HAS_MSS_VAL]; /* [flg] Flag for missing values */
     ptr_unn mss_val; /* [val] Value of missing value */
@@ -199,6 +211,17 @@ H5Z_filter_granularbr /* [fnc] HDF5 Granular BitRound Filter */
     
     if(CCR_FLT_DBG_INFO) (void)fprintf(stderr,"INFO: %s reports datum size = %lu B, has_mss_val = %d\n",fnc_nm,datum_size,has_mss_val);
 
+    /* NSD of 0 selects absolute error mode, whose error bound follows missing value */
+    if(nsd == 0){
+      if(cd_nelmts < CCR_FLT_PRM_PSN_ABS_ERR+2) goto error;
+      memcpy(&abs_err,cd_values+CCR_FLT_PRM_PSN_ABS_ERR,sizeof(double));
+      /* Negated test also rejects NaN */
+      if(!(abs_err > 0.0)){
+	(void)fprintf(stderr,"ERROR: \"%s\" filter function %s reports absolute error = %g is invalid\n",CCR_FLT_NAME,fnc_nm,abs_err);
+	goto error;
+      } /* !abs_err */
+    } /* !nsd */
+
     /* Quantization is only for floating-point data (data_class == H5T_FLOAT)
        Following block assumes all bfr_inout values are either 4-byte or 8-byte floating point */
     switch(datum_size){
@@ -210,7 +233,8 @@ H5Z_filter_granularbr /* [fnc] HDF5 Granular BitRound Filter */
 	if(CCR_FLT_DBG_INFO) (void)fprintf(stderr,"INFO: \"%s\" filter function %s reports missing value = %g\n",CCR_FLT_NAME,fnc_nm,*mss_val.fp);
       } /* !has_mss_val */
       op1.fp=(float *)(*bfr_inout);
-      ccr_gbr(nsd,NC_FLOAT,bfr_sz_in/sizeof(float),has_mss_val,mss_val,op1);
+      if(nsd == 0) ccr_gbr_abs(abs_err,NC_FLOAT,bfr_sz_in/sizeof(float),has_mss_val,mss_val,op1);
+      else ccr_gbr(nsd,NC_FLOAT,bfr_sz_in/sizeof(float),has_mss_val,mss_val,op1);
       break;
     case 8:
       /* Double-precision floating-point data */
@@ -219,7 +243,8 @@ H5Z_filter_granularbr /* [fnc] HDF5 Granular BitRound Filter */
 	if(CCR_FLT_DBG_INFO) (void)fprintf(stderr,"INFO: \"%s\" filter function %s reports missing value = %g\n",CCR_FLT_NAME,fnc_nm,*mss_val.dp);
       } /* !has_mss_val */
       op1.dp=(double *)(*bfr_inout);
-      ccr_gbr(nsd,NC_DOUBLE,bfr_sz_in/sizeof(double),has_mss_val,mss_val,op1);
+      if(nsd == 0) ccr_gbr_abs(abs_err,NC_DOUBLE,bfr_sz_in/sizeof(double),has_mss_val,mss_val,op1);
+      else ccr_gbr(nsd,NC_DOUBLE,bfr_sz_in/sizeof(double),has_mss_val,mss_val,op1);
       break;
     default:
       (void)fprintf(stderr,"ERROR: \"%s\" filter function %s reports datum size = %lu B is invalid\n",CCR_FLT_NAME,fnc_nm,datum_size);
@@ -266,11 +291,11 @@ ccr_set_local_granularbr /* [fnc] Callback to determine and set per-variable fil
   herr_t rcd; /* [flg] Return code */
   
   /* Initialize filter parameters with default values */
-  unsigned int ccr_flt_prm[CCR_FLT_PRM_NBR]={CCR_FLT_NSD_DFL,0,0,0,0};
+  unsigned int ccr_flt_prm[CCR_FLT_PRM_NBR_ABS]={CCR_FLT_NSD_DFL,0,0,0,0,0,0};
 
   /* Initialize output variables for call to H5Pget_filter_by_id() */
   unsigned int flags=0;
-  size_t cd_nelmts=CCR_FLT_PRM_NBR;
+  size_t cd_nelmts=CCR_FLT_PRM_NBR_ABS;
   unsigned int *cd_values=ccr_flt_prm;
 
   /* Retrieve parameters specified by user
@@ -369,8 +394,9 @@ ccr_set_local_granularbr /* [fnc] Callback to determine and set per-variable fil
   /* Set missing value flag in filter parameter list */
   ccr_flt_prm[CCR_FLT_PRM_PSN_HAS_MSS_VAL]=has_mss_val;
 
-  /* Update invoked filter with generic parameters as invoked with variable-specific values */
-  rcd=H5Pmodify_filter(dcpl,H5Z_FILTER_GRANULARBR,flags,CCR_FLT_PRM_NBR,cd_values);
+  /* Update invoked filter with generic parameters as invoked with variable-specific values
+     NSD mode keeps the five parameters that readers before absolute error mode accept */
+  rcd=H5Pmodify_filter(dcpl,H5Z_FILTER_GRANULARBR,flags,cd_values[CCR_FLT_PRM_PSN_NSD] == 0 ? CCR_FLT_PRM_NBR_ABS : CCR_FLT_PRM_NBR,cd_values);
   if(rcd < 0){
     (void)fprintf(stderr,"ERROR: \"%s\" filter callback function %s reports H5Pmodify_filter() unable to modify filter parameters\n",CCR_FLT_NAME,fnc_nm);
     return 0;
@@ -378,133 +404,3 @@ ccr_set_local_granularbr /* [fnc] Callback to determine and set per-variable fil
 
   return 1;
 } /* !ccr_set_local_granularbr() */
-
-void
-ccr_gbr /* [fnc] Granular BitRound buffer of float values */
-(const int nsd, /* I [nbr] Number of decimal significant digits to quantize to */
- const int type, /* I [enm] netCDF type of operand */
- const size_t sz, /* I [nbr] Size (in elements) of buffer to quantize */
- const int has_mss_val, /* I [flg] Flag for missing values */
- ptr_unn mss_val, /* I [val] Value of missing value */
- ptr_unn op1) /* I/O [frc] Values to quantize */
-{
-  const char fnc_nm[]="ccr_gbr()"; /* [sng] Function name */
-
-  /* Prefer constants defined in math.h, however, ...
-     20201002 GCC environments can have hard time defining M_LN10/M_LN2 despite finding math.h */
-#ifndef M_LN10
-# define M_LN10         2.30258509299404568402  /* log_e 10 */
-#endif /* M_LN10 */
-#ifndef M_LN2
-# define M_LN2          0.69314718055994530942  /* log_e 2 */
-#endif /* M_LN2 */
-  const double bit_per_dgt=M_LN10/M_LN2; /* 3.32 [frc] Bits per decimal digit of precision = log2(10) */
-  const double dgt_per_bit=M_LN2/M_LN10; /* 0.301 [frc] Decimal digits per bit of precision = log10(2) */
-  
-  const int bit_xpl_nbr_sgn_flt=23; /* [nbr] Bits 0-22 of SP significands are explicit. Bit 23 is implicitly 1. */
-  const int bit_xpl_nbr_sgn_dbl=52; /* [nbr] Bits 0-51 of DP significands are explicit. Bit 52 is implicitly 1. */
-  
-  double mnt; /* [frc] Mantissa, 0.5 <= mnt < 1.0 */
-  double mnt_fabs; /* [frc] fabs(mantissa) */
-  double mnt_log10_fabs; /* [frc] log10(fabs(mantissa))) */
-  double val; /* [frc] Copy of input value to avoid indirection */
-  
-  double prc_bnr_xct; /* [nbr] Binary digits of precision, exact */
-  double mss_val_cmp_dbl; /* Missing value for comparison to double precision values */
-
-  float mss_val_cmp_flt; /* Missing value for comparison to single precision values */
-  
-  int bit_xpl_nbr_sgn=-1; /* [nbr] Number of explicit bits in significand */
-  int bit_xpl_nbr_zro; /* [nbr] Number of explicit bits to zero */
-
-  int dgt_nbr; /* [nbr] Number of digits before decimal point */
-  int qnt_pwr; /* [nbr] Power of two in quantization mask: qnt_msk = 2^qnt_pwr */
-  int xpn_bs2; /* [nbr] Binary exponent xpn_bs2 in val = sign(val) * 2^xpn_bs2 * mnt, 0.5 < mnt <= 1.0 */
-
-  size_t idx;
-
-  unsigned int *u32_ptr;
-  unsigned int msk_f32_u32_zro;
-  unsigned int msk_f32_u32_one;
-  unsigned int msk_f32_u32_hshv;
-  unsigned long long int *u64_ptr;
-  unsigned long long int msk_f64_u64_zro;
-  unsigned long long int msk_f64_u64_one;
-  unsigned long long int msk_f64_u64_hshv;
-  unsigned short prc_bnr_ceil; /* [nbr] Exact binary digits of precision rounded-up */
-  unsigned short prc_bnr_xpl_rqr; /* [nbr] Explicitly represented binary digits required to retain */
-
-  /* Disallow unreasonable quantization */
-  assert(nsd > 0);
-  assert(nsd <= 16);
-
-  if(type == NC_FLOAT  && prc_bnr_xpl_rqr >= bit_xpl_nbr_sgn_flt) return;
-  if(type == NC_DOUBLE && prc_bnr_xpl_rqr >= bit_xpl_nbr_sgn_dbl) return;
-
-  switch(type){
-  case NC_FLOAT:
-    /* Missing value for comparison is _FillValue (if any) otherwise default NC_FILL_FLOAT/DOUBLE */
-    if(has_mss_val) mss_val_cmp_flt=*mss_val.fp; else mss_val_cmp_flt=NC_FILL_FLOAT;
-    bit_xpl_nbr_sgn=bit_xpl_nbr_sgn_flt;
-    u32_ptr=op1.ui32p;
-
-    for(idx=0L;idx<sz;idx++){
-      if((val=op1.fp[idx]) != mss_val_cmp_flt && u32_ptr[idx] != 0U){
-	mnt=frexp(val,&xpn_bs2); /* DGG19 p. 4102 (8) */
-	mnt_fabs=fabs(mnt);
-	mnt_log10_fabs=log10(mnt_fabs);
-	/* 20211003 Continuous determination of dgt_nbr improves CR by ~10% */
-	dgt_nbr=(int)floor(xpn_bs2*dgt_per_bit+mnt_log10_fabs)+1; /* DGG19 p. 4102 (8.67) */
-	qnt_pwr=(int)floor(bit_per_dgt*(dgt_nbr-nsd)); /* DGG19 p. 4101 (7) */
-	prc_bnr_xpl_rqr= mnt_fabs == 0.0 ? 0 : abs((int)floor(xpn_bs2-bit_per_dgt*mnt_log10_fabs)-qnt_pwr); /* Protect against mnt = -0.0 */
-	prc_bnr_xpl_rqr--; /* 20211003 Reduce formula result by 1 bit: Passes all tests, improves CR by ~10% */
-
-	bit_xpl_nbr_zro=bit_xpl_nbr_sgn-prc_bnr_xpl_rqr;
-	msk_f32_u32_zro=0u; /* Zero all bits */
-	msk_f32_u32_zro=~msk_f32_u32_zro; /* Turn all bits to ones */
-	/* Bit Shave mask for AND: Left shift zeros into bits to be rounded, leave ones in untouched bits */
-	msk_f32_u32_zro <<= bit_xpl_nbr_zro;
-	/* Bit Set   mask for OR:  Put ones into bits to be set, zeros in untouched bits */
-	msk_f32_u32_one=~msk_f32_u32_zro;
-	msk_f32_u32_hshv=msk_f32_u32_one & (msk_f32_u32_zro >> 1); /* Set one bit: the MSB of LSBs */
-	u32_ptr[idx]+=msk_f32_u32_hshv; /* Add 1 to the MSB of LSBs, carry 1 to mantissa or even exponent */
-	u32_ptr[idx]&=msk_f32_u32_zro; /* Shave it */
-      } /* !mss_val_cmp_flt */
-    } /* !idx */
-    break; /* !NC_FLOAT */
-  case NC_DOUBLE:
-    /* Missing value for comparison is _FillValue (if any) otherwise default NC_FILL_FLOAT/DOUBLE */
-    if(has_mss_val) mss_val_cmp_dbl=*mss_val.dp; else mss_val_cmp_dbl=NC_FILL_FLOAT;
-    bit_xpl_nbr_sgn=bit_xpl_nbr_sgn_dbl;
-    u64_ptr=op1.ui64p;
-
-    for(idx=0L;idx<sz;idx++){
-      if((val=op1.dp[idx]) != mss_val_cmp_dbl && u64_ptr[idx] != 0U){
-	mnt=frexp(val,&xpn_bs2); /* DGG19 p. 4102 (8) */
-	mnt_fabs=fabs(mnt);
-	mnt_log10_fabs=log10(mnt_fabs);
-	/* 20211003 Continuous determination of dgt_nbr improves CR by ~10% */
-	dgt_nbr=(int)floor(xpn_bs2*dgt_per_bit+mnt_log10_fabs)+1; /* DGG19 p. 4102 (8.67) */
-	qnt_pwr=(int)floor(bit_per_dgt*(dgt_nbr-nsd)); /* DGG19 p. 4101 (7) */
-	prc_bnr_xpl_rqr= mnt_fabs == 0.0 ? 0 : abs((int)floor(xpn_bs2-bit_per_dgt*mnt_log10_fabs)-qnt_pwr); /* Protect against mnt = -0.0 */
-	prc_bnr_xpl_rqr--; /* 20211003 Reduce formula result by 1 bit: Passes all tests, improves CR by ~10% */
-
-	bit_xpl_nbr_zro=bit_xpl_nbr_sgn-prc_bnr_xpl_rqr;
-	msk_f64_u64_zro=0u; /* Zero all bits */
-	msk_f64_u64_zro=~msk_f64_u64_zro; /* Turn all bits to ones */
-	/* Bit Shave mask for AND: Left shift zeros into bits to be rounded, leave ones in untouched bits */
-	msk_f64_u64_zro <<= bit_xpl_nbr_zro;
-	/* Bit Set   mask for OR:  Put ones into bits to be set, zeros in untouched bits */
-	msk_f64_u64_one=~msk_f64_u64_zro;
-	msk_f64_u64_hshv=msk_f64_u64_one & (msk_f64_u64_zro >> 1); /* Set one bit: the MSB of LSBs */
-	u64_ptr[idx]+=msk_f64_u64_hshv; /* Add 1 to the MSB of LSBs, carry 1 to mantissa or even exponent */
-	u64_ptr[idx]&=msk_f64_u64_zro; /* Shave it */
-      } /* !mss_val_cmp_dbl */
-    } /* !idx */
-    break; /* !NC_DOUBLE */
-  default: 
-    (void)fprintf(stderr,"ERROR: %s reports datum size = %d B is invalid for %s filter\n",fnc_nm,type,CCR_FLT_NAME);
-    break;
-  } /* !type */
-  
-} /* ccr_gbr() */
@@ -0,0 +1,1050 @@
+/* Copyright (C) 2021--present Charlie Zender */
+
+ /*
+ * Granular BitRound quantization of buffers of single- and double-precision values.
+ * The HDF5 Granular BitRound filter plugin (H5Zgranularbr.c) and ccr_quantize()
+ * in libccr both build this file, so it calls neither HDF5 nor netCDF.
+ */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h" /* Autotools tokens */
+#endif
+#include <stdio.h>
+#ifdef HAVE_SYS_TYPES_H
+# include <sys/types.h>
+#endif
+#ifdef HAVE_SYS_STAT_H
+# include <sys/stat.h>
+#endif
+#ifdef STDC_HEADERS
+# include <stdlib.h>
+# include <stddef.h>
+#else
+# ifdef HAVE_STDLIB_H
+#  include <stdlib.h>
+# endif
+#endif
+#ifdef HAVE_STRING_H
+# if !defined STDC_HEADERS && defined HAVE_MEMORY_H
+#  include <memory.h>
+# endif
+# include <string.h>
+#endif
+#ifdef HAVE_STRINGS_H
+# include <strings.h>
+#endif
+#ifdef HAVE_INTTYPES_H
+# include <inttypes.h>
+#endif
+#ifdef HAVE_STDINT_H
+# include <stdint.h>
+#endif
+#ifdef HAVE_UNISTD_H
+# include <unistd.h>
+#endif
+#include <assert.h>
+
+#if defined(_WIN32)
+#include <Winsock2.h>
+#endif
+#ifdef HAVE_PTHREAD_H
+# include <pthread.h> /* pthread_once() selects kernels and fills tables once, however many threads quantize */
+#endif
+
+/* Standard header files */
+#ifdef HAVE_FEATURES_H
+/* Needed to define __USE_BSD that recent GCC compilers use in math.h to define M_LN2... */
+# include <features.h> /* __USE_BSD */
+#endif
+#ifdef HAVE_MATH_H
+/* Needed for M_LN10, M_LN2 in ccr_gbr() */
+# include <math.h> /* sin cos cos sin 3.14159 */
+#endif
+
+/* Prefer constants defined in math.h, however, ...
+   20201002 GCC environments can have hard time defining M_LN10/M_LN2 despite finding math.h */
+#ifndef M_LN10
+# define M_LN10         2.30258509299404568402  /* log_e 10 */
+#endif /* M_LN10 */
+#ifndef M_LN2
+# define M_LN2          0.69314718055994530942  /* log_e 2 */
+#endif /* M_LN2 */
+
+/* SIMD kernels need x86 intrinsics plus GCC/Clang function-level target attributes and __builtin_cpu_supports()
+   Other compilers and architectures use the scalar kernel */
+#if defined(HAVE_IMMINTRIN_H) && (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+# define CCR_SIMD_X86 1
+# include <immintrin.h> /* AVX2, AVX-512 gathers */
+#endif /* !HAVE_IMMINTRIN_H */
+
+/* OpenMP lets large chunks be quantized in slices on a thread pool (opt-in, see ccr_thr_nbr_get()) */
+#ifdef _OPENMP
+# include <omp.h> /* omp_get_num_procs() */
+#endif /* !_OPENMP */
+
+/* Tokens and typedefs */
+#define CCR_FLT_DBG_INFO 0 /* [flg] Print non-fatal debugging information */
+#define CCR_FLT_NAME "Granular BitRound filter" /* [sng] Filter name in vernacular for HDF5 messages */
+#define CCR_THR_NBR_ENV "CCR_THR_NBR" /* [sng] Environment variable that sets number of quantization threads (default 1) */
+#define CCR_SLC_SZ_BYT 262144 /* [B] Slice size for multithreaded quantization, small enough to stay in L2 cache */
+
+/* Compatibility tokens and typedefs retain source-code compatibility between NCO and filter
+   These tokens mimic netCDF/NCO code but do not rely on or interfere with either */
+#ifndef NC_FLOAT
+# define NC_FLOAT 5
+#endif /* !NC_FLOAT */
+#ifndef NC_DOUBLE
+# define NC_DOUBLE 6
+#endif /* !NC_DOUBLE */
+#ifndef NC_FILL_FLOAT
+# define NC_FILL_FLOAT   (9.9692099683868690e+36f) /* near 15 * 2^119 */
+#endif /* !NC_FILL_FLOAT */
+#ifndef NC_FILL_DOUBLE
+# define NC_FILL_DOUBLE  (9.9692099683868690e+36)
+#endif /* !NC_FILL_DOUBLE */
+
+/* Minimum number of explicit significand bits to preserve when zeroing/bit-masking floating point values
+   Codes will preserve at least two explicit bits, IEEE significand representation contains one implicit bit
+   Thus preserve a least three bits which is approximately one sigificant decimal digit
+   Used in nco_ppc_bitmask() and nco_ppc_bitmask_scl() */
+#define NCO_PPC_BIT_XPL_NBR_MIN 2
+
+/* Pointer union for floating point and bitmask types */
+typedef union{ /* ptr_unn */
+  float *fp;
+  double *dp;
+  unsigned int *ui32p;
+  unsigned long long *ui64p;
+  void *vp;
+} ptr_unn;
+
+/* Exponent-indexed tables replace per-value frexp()/log10() (see ccr_gbr())
+   Mask tables hold four entries per biased exponent, one per combination of the two step flags */
+#define CCR_GBR_FLT_XPN_NBR 256 /* [nbr] Number of single-precision biased exponents */
+#define CCR_GBR_DBL_XPN_NBR 2048 /* [nbr] Number of double-precision biased exponents */
+#define CCR_GBR_FLT_TBL_NBR (4*CCR_GBR_FLT_XPN_NBR) /* [nbr] Entries in single-precision mask table */
+#define CCR_GBR_DBL_TBL_NBR (4*CCR_GBR_DBL_XPN_NBR) /* [nbr] Entries in double-precision mask table */
+
+/* Granular BitRound kernels apply mask tables built by ccr_gbr_flt_msk_mk()/ccr_gbr_dbl_msk_mk()
+   Kernel choice (scalar, AVX2, AVX-512) is made once by ccr_gbr_cpu_dispatch() */
+typedef void /* O [nbr] Nothing */
+(*ccr_gbr_flt_knl_t) /* [fnc] Granular BitRound kernel for single-precision values */
+(const int nsd, /* I [nbr] Number of decimal significant digits to quantize to */
+ const size_t sz, /* I [nbr] Size (in elements) of buffer to quantize */
+ const float mss_val_cmp_flt, /* I [val] Missing value for comparison */
+ const unsigned int * const msk_tbl, /* I [msk] Bit Shave masks indexed by exponent and step flags */
+ ptr_unn op1); /* I/O [frc] Values to quantize */
+
+typedef void /* O [nbr] Nothing */
+(*ccr_gbr_dbl_knl_t) /* [fnc] Granular BitRound kernel for double-precision values */
+(const int nsd, /* I [nbr] Number of decimal significant digits to quantize to */
+ const size_t sz, /* I [nbr] Size (in elements) of buffer to quantize */
+ const double mss_val_cmp_dbl, /* I [val] Missing value for comparison */
+ const unsigned long long int * const msk_tbl, /* I [msk] Bit Shave masks indexed by exponent and step flags */
+ ptr_unn op1); /* I/O [frc] Values to quantize */
+
+void
+ccr_gbr /* [fnc] Granular BitRound buffer of float values */
+(const int nsd, /* I [nbr] Number of decimal significant digits to quantize to */
+ const int type, /* I [enm] netCDF type of operand */
+ const size_t sz, /* I [nbr] Size (in elements) of buffer to quantize */
+ const int has_mss_val, /* I [flg] Flag for missing values */
+ ptr_unn mss_val, /* I [val] Value of missing value */
+ ptr_unn op1); /* I/O [frc] Values to quantize */
+
+void
+ccr_gbr_abs /* [fnc] Granular BitRound buffer of float values to absolute error */
+(const double abs_err, /* I [frc] Maximum absolute error */
+ const int type, /* I [enm] netCDF type of operand */
+ const size_t sz, /* I [nbr] Size (in elements) of buffer to quantize */
+ const int has_mss_val, /* I [flg] Flag for missing values */
+ ptr_unn mss_val, /* I [val] Value of missing value */
+ ptr_unn op1); /* I/O [frc] Values to quantize */
+
+void
+ccr_gbr_cpu_dispatch /* [fnc] Select fastest Granular BitRound kernels supported by this CPU */
+(void);
+
+void
+ccr_gbr_knl_ini /* [fnc] Select Granular BitRound kernels once per process, from any thread */
+(void);
+
+void
+ccr_gbr_xpn_tbl_mk /* [fnc] Tabulate digit-count and exponent steps for every normal binade */
+(void);
+
+static void ccr_gbr_xpn_tbl_ini(void);
+
+static void ccr_gbr_flt_xct(const int nsd,const size_t sz,const float mss_val_cmp_flt,ptr_unn op1);
+static void ccr_gbr_dbl_xct(const int nsd,const size_t sz,const double mss_val_cmp_dbl,ptr_unn op1);
+static void ccr_gbr_flt_msk_mk(const int nsd,unsigned int * const msk_tbl);
+static void ccr_gbr_dbl_msk_mk(const int nsd,unsigned long long int * const msk_tbl);
+static void ccr_gbr_flt_abs_msk_mk(const double abs_err,unsigned int * const msk_tbl);
+static void ccr_gbr_dbl_abs_msk_mk(const double abs_err,unsigned long long int * const msk_tbl);
+
+/* Kernels selected by ccr_gbr_cpu_dispatch(), NULL until first dispatch */
+static ccr_gbr_flt_knl_t ccr_gbr_flt_knl=NULL; /* [fnc] Single-precision Granular BitRound kernel */
+static ccr_gbr_dbl_knl_t ccr_gbr_dbl_knl=NULL; /* [fnc] Double-precision Granular BitRound kernel */
+static const char *ccr_gbr_knl_nm="none"; /* [sng] Name of selected kernel, for debugging */
+#ifdef HAVE_PTHREAD_H
+static pthread_once_t ccr_gbr_knl_once=PTHREAD_ONCE_INIT; /* [flg] Guards one-time kernel selection */
+static pthread_once_t ccr_gbr_xpn_tbl_once=PTHREAD_ONCE_INIT; /* [flg] Guards one-time filling of exponent tables */
+#endif
+
+/* Per-binade steps filled by ccr_gbr_xpn_tbl_mk(), independent of NSD
+   Within binade xpn_bsd, a normal value with explicit significand bits mnt has
+   dgt_nbr = *_dgt_nbr[xpn_bsd] + (mnt >= *_dgt_thr[xpn_bsd]) and xpn_flr = *_xpn_flr[xpn_bsd] + (mnt < *_xpn_thr[xpn_bsd]) */
+static int ccr_gbr_xpn_tbl_flg=0; /* [flg] Exponent tables are filled */
+static unsigned int ccr_gbr_flt_dgt_thr[CCR_GBR_FLT_XPN_NBR]; /* [nbr] Significand where digit count steps up */
+static int ccr_gbr_flt_dgt_nbr[CCR_GBR_FLT_XPN_NBR]; /* [nbr] Digit count at bottom of binade */
+static unsigned int ccr_gbr_flt_xpn_thr[CCR_GBR_FLT_XPN_NBR]; /* [nbr] Significand where exponent steps down */
+static int ccr_gbr_flt_xpn_flr[CCR_GBR_FLT_XPN_NBR]; /* [nbr] Exponent at top of binade */
+static unsigned long long int ccr_gbr_dbl_dgt_thr[CCR_GBR_DBL_XPN_NBR]; /* [nbr] Significand where digit count steps up */
+static int ccr_gbr_dbl_dgt_nbr[CCR_GBR_DBL_XPN_NBR]; /* [nbr] Digit count at bottom of binade */
+static unsigned long long int ccr_gbr_dbl_xpn_thr[CCR_GBR_DBL_XPN_NBR]; /* [nbr] Significand where exponent steps down */
+static int ccr_gbr_dbl_xpn_flr[CCR_GBR_DBL_XPN_NBR]; /* [nbr] Exponent at top of binade */
+
+/* Function definitions */
+static int /* O [nbr] Number of threads to quantize buffer with */
+ccr_thr_nbr_get /* [fnc] Number of threads requested for quantization */
+(const size_t bfr_sz) /* I [B] Size of buffer to quantize */
+{
+  /* Purpose: Read opt-in thread count from CCR_THR_NBR environment variable
+     Unset, empty, or 1 quantizes on calling thread, 0 uses one thread per processor
+     Buffers smaller than two slices always quantize on calling thread
+     Thread count describes the writer not the data, so it is an environment variable rather than a cd_values[] entry */
+#ifdef _OPENMP
+  const char *thr_sng; /* [sng] Value of CCR_THR_NBR */
+  char *sng_cnv_rcd=NULL; /* [sng] strtol() return code */
+  long slc_nbr; /* [nbr] Number of slices in buffer */
+  long thr_nbr; /* [nbr] Number of threads */
+
+  if(bfr_sz < 2*CCR_SLC_SZ_BYT) return 1;
+  thr_sng=getenv(CCR_THR_NBR_ENV);
+  if(!thr_sng || *thr_sng == '\0') return 1;
+  thr_nbr=strtol(thr_sng,&sng_cnv_rcd,10);
+  if(*sng_cnv_rcd != '\0' || thr_nbr < 0L){
+    (void)fprintf(stderr,"WARNING: \"%s\" filter ignores invalid %s = %s\n",CCR_FLT_NAME,CCR_THR_NBR_ENV,thr_sng);
+    return 1;
+  } /* !sng_cnv_rcd */
+  if(thr_nbr == 0L) thr_nbr=omp_get_num_procs();
+  /* Threads beyond one per slice would idle */
+  slc_nbr=(long)((bfr_sz+CCR_SLC_SZ_BYT-1)/CCR_SLC_SZ_BYT);
+  if(thr_nbr > slc_nbr) thr_nbr=slc_nbr;
+  return (int)thr_nbr;
+#else /* !_OPENMP */
+  (void)bfr_sz;
+  return 1;
+#endif /* !_OPENMP */
+} /* !ccr_thr_nbr_get() */
+
+void
+ccr_gbr /* [fnc] Granular BitRound buffer of float values */
+(const int nsd, /* I [nbr] Number of decimal significant digits to quantize to */
+ const int type, /* I [enm] netCDF type of operand */
+ const size_t sz, /* I [nbr] Size (in elements) of buffer to quantize */
+ const int has_mss_val, /* I [flg] Flag for missing values */
+ ptr_unn mss_val, /* I [val] Value of missing value */
+ ptr_unn op1) /* I/O [frc] Values to quantize */
+{
+  /* Purpose: Granular BitRound buffer without per-value calls to frexp(), log10(), or floor()
+     Digit count and binary exponent of a normal value change at most once within each binade
+     ccr_gbr_xpn_tbl_mk() locates these steps once per process with the exact DGG19 formula
+     Each call then builds a mask table indexed by IEEE exponent and the two step flags
+     Zeros, subnormals, infinities and NaNs take the exact per-value path, so results are identical to DGG19 formula bit-for-bit */
+  const char fnc_nm[]="ccr_gbr()"; /* [sng] Function name */
+  
+  double mss_val_cmp_dbl; /* Missing value for comparison to double precision values */
+
+  float mss_val_cmp_flt; /* Missing value for comparison to single precision values */
+
+  int thr_nbr; /* [nbr] Number of threads to quantize with */
+
+  long slc_idx; /* [idx] Slice index */
+  long slc_nbr; /* [nbr] Number of slices */
+  size_t slc_sz; /* [nbr] Slice size (in elements) */
+
+  unsigned int msk_tbl_flt[CCR_GBR_FLT_TBL_NBR]; /* [msk] Bit Shave masks indexed by exponent and step flags */
+  unsigned long long int *msk_tbl_dbl; /* [msk] Bit Shave masks indexed by exponent and step flags (64 kB, so heap) */
+
+  /* Disallow unreasonable quantization */
+  assert(nsd > 0);
+  assert(nsd <= 16);
+
+  ccr_gbr_knl_ini();
+  ccr_gbr_xpn_tbl_ini();
+
+  switch(type){
+  case NC_FLOAT:
+    /* Missing value for comparison is _FillValue (if any) otherwise default NC_FILL_FLOAT/DOUBLE */
+    if(has_mss_val) mss_val_cmp_flt=*mss_val.fp; else mss_val_cmp_flt=NC_FILL_FLOAT;
+    ccr_gbr_flt_msk_mk(nsd,msk_tbl_flt);
+    thr_nbr=ccr_thr_nbr_get(sz*sizeof(float));
+    if(thr_nbr > 1){
+      slc_sz=CCR_SLC_SZ_BYT/sizeof(float);
+      slc_nbr=(long)((sz+slc_sz-1L)/slc_sz);
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic) num_threads(thr_nbr)
+#endif /* !_OPENMP */
+      for(slc_idx=0L;slc_idx<slc_nbr;slc_idx++){
+	ptr_unn op1_slc; /* [frc] Slice of values to quantize */
+	op1_slc.fp=op1.fp+slc_idx*slc_sz;
+	ccr_gbr_flt_knl(nsd,slc_idx < slc_nbr-1L ? slc_sz : sz-slc_idx*slc_sz,mss_val_cmp_flt,msk_tbl_flt,op1_slc);
+      } /* !slc_idx */
+    }else{
+      ccr_gbr_flt_knl(nsd,sz,mss_val_cmp_flt,msk_tbl_flt,op1);
+    } /* !thr_nbr */
+    break; /* !NC_FLOAT */
+  case NC_DOUBLE:
+    /* Missing value for comparison is _FillValue (if any) otherwise default NC_FILL_FLOAT/DOUBLE */
+    if(has_mss_val) mss_val_cmp_dbl=*mss_val.dp; else mss_val_cmp_dbl=NC_FILL_DOUBLE;
+    msk_tbl_dbl=(unsigned long long int *)malloc(CCR_GBR_DBL_TBL_NBR*sizeof(unsigned long long int));
+    if(!msk_tbl_dbl){
+      /* Out of memory is no reason to fail, quantize slowly instead */
+      (void)fprintf(stderr,"WARNING: %s unable to allocate mask table, using exact per-value path\n",fnc_nm);
+      ccr_gbr_dbl_xct(nsd,sz,mss_val_cmp_dbl,op1);
+      break;
+    } /* !msk_tbl_dbl */
+    ccr_gbr_dbl_msk_mk(nsd,msk_tbl_dbl);
+    thr_nbr=ccr_thr_nbr_get(sz*sizeof(double));
+    if(thr_nbr > 1){
+      slc_sz=CCR_SLC_SZ_BYT/sizeof(double);
+      slc_nbr=(long)((sz+slc_sz-1L)/slc_sz);
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic) num_threads(thr_nbr)
+#endif /* !_OPENMP */
+      for(slc_idx=0L;slc_idx<slc_nbr;slc_idx++){
+	ptr_unn op1_slc; /* [frc] Slice of values to quantize */
+	op1_slc.dp=op1.dp+slc_idx*slc_sz;
+	ccr_gbr_dbl_knl(nsd,slc_idx < slc_nbr-1L ? slc_sz : sz-slc_idx*slc_sz,mss_val_cmp_dbl,msk_tbl_dbl,op1_slc);
+      } /* !slc_idx */
+    }else{
+      ccr_gbr_dbl_knl(nsd,sz,mss_val_cmp_dbl,msk_tbl_dbl,op1);
+    } /* !thr_nbr */
+    free(msk_tbl_dbl);
+    break; /* !NC_DOUBLE */
+  default: 
+    (void)fprintf(stderr,"ERROR: %s reports datum size = %d B is invalid for %s filter\n",fnc_nm,type,CCR_FLT_NAME);
+    break;
+  } /* !type */
+  
+} /* ccr_gbr() */
+
+void
+ccr_gbr_abs /* [fnc] Granular BitRound buffer of float values to absolute error */
+(const double abs_err, /* I [frc] Maximum absolute error */
+ const int type, /* I [enm] netCDF type of operand */
+ const size_t sz, /* I [nbr] Size (in elements) of buffer to quantize */
+ const int has_mss_val, /* I [flg] Flag for missing values */
+ ptr_unn mss_val, /* I [val] Value of missing value */
+ ptr_unn op1) /* I/O [frc] Values to quantize */
+{
+  /* Purpose: Granular BitRound buffer so every value stays within abs_err of its input
+     Bits to keep depend only on the binary exponent, so mask tables from ccr_gbr_flt_abs_msk_mk()/ccr_gbr_dbl_abs_msk_mk() drive the same kernels as NSD mode
+     Kernels receive NSD of 0, which tells the exact per-value path to leave -0.0, subnormals, Inf, and NaN untouched */
+  const char fnc_nm[]="ccr_gbr_abs()"; /* [sng] Function name */
+  
+  double mss_val_cmp_dbl; /* Missing value for comparison to double precision values */
+
+  float mss_val_cmp_flt; /* Missing value for comparison to single precision values */
+
+  int thr_nbr; /* [nbr] Number of threads to quantize with */
+
+  long slc_idx; /* [idx] Slice index */
+  long slc_nbr; /* [nbr] Number of slices */
+  size_t slc_sz; /* [nbr] Slice size (in elements) */
+
+  unsigned int msk_tbl_flt[CCR_GBR_FLT_TBL_NBR]; /* [msk] Bit Shave masks indexed by exponent and step flags */
+  unsigned long long int *msk_tbl_dbl; /* [msk] Bit Shave masks indexed by exponent and step flags (64 kB, so heap) */
+
+  assert(abs_err > 0.0);
+
+  /* Kernels gather step thresholds even though absolute masks ignore them */
+  ccr_gbr_knl_ini();
+  ccr_gbr_xpn_tbl_ini();
+
+  switch(type){
+  case NC_FLOAT:
+    /* Missing value for comparison is _FillValue (if any) otherwise default NC_FILL_FLOAT/DOUBLE */
+    if(has_mss_val) mss_val_cmp_flt=*mss_val.fp; else mss_val_cmp_flt=NC_FILL_FLOAT;
+    ccr_gbr_flt_abs_msk_mk(abs_err,msk_tbl_flt);
+    thr_nbr=ccr_thr_nbr_get(sz*sizeof(float));
+    if(thr_nbr > 1){
+      slc_sz=CCR_SLC_SZ_BYT/sizeof(float);
+      slc_nbr=(long)((sz+slc_sz-1L)/slc_sz);
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic) num_threads(thr_nbr)
+#endif /* !_OPENMP */
+      for(slc_idx=0L;slc_idx<slc_nbr;slc_idx++){
+	ptr_unn op1_slc; /* [frc] Slice of values to quantize */
+	op1_slc.fp=op1.fp+slc_idx*slc_sz;
+	ccr_gbr_flt_knl(0,slc_idx < slc_nbr-1L ? slc_sz : sz-slc_idx*slc_sz,mss_val_cmp_flt,msk_tbl_flt,op1_slc);
+      } /* !slc_idx */
+    }else{
+      ccr_gbr_flt_knl(0,sz,mss_val_cmp_flt,msk_tbl_flt,op1);
+    } /* !thr_nbr */
+    break; /* !NC_FLOAT */
+  case NC_DOUBLE:
+    /* Missing value for comparison is _FillValue (if any) otherwise default NC_FILL_FLOAT/DOUBLE */
+    if(has_mss_val) mss_val_cmp_dbl=*mss_val.dp; else mss_val_cmp_dbl=NC_FILL_DOUBLE;
+    msk_tbl_dbl=(unsigned long long int *)malloc(CCR_GBR_DBL_TBL_NBR*sizeof(unsigned long long int));
+    if(!msk_tbl_dbl){
+      /* Exact path has no absolute error mode, so leave values unquantized */
+      (void)fprintf(stderr,"WARNING: %s unable to allocate mask table, leaving values unquantized\n",fnc_nm);
+      break;
+    } /* !msk_tbl_dbl */
+    ccr_gbr_dbl_abs_msk_mk(abs_err,msk_tbl_dbl);
+    thr_nbr=ccr_thr_nbr_get(sz*sizeof(double));
+    if(thr_nbr > 1){
+      slc_sz=CCR_SLC_SZ_BYT/sizeof(double);
+      slc_nbr=(long)((sz+slc_sz-1L)/slc_sz);
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic) num_threads(thr_nbr)
+#endif /* !_OPENMP */
+      for(slc_idx=0L;slc_idx<slc_nbr;slc_idx++){
+	ptr_unn op1_slc; /* [frc] Slice of values to quantize */
+	op1_slc.dp=op1.dp+slc_idx*slc_sz;
+	ccr_gbr_dbl_knl(0,slc_idx < slc_nbr-1L ? slc_sz : sz-slc_idx*slc_sz,mss_val_cmp_dbl,msk_tbl_dbl,op1_slc);
+      } /* !slc_idx */
+    }else{
+      ccr_gbr_dbl_knl(0,sz,mss_val_cmp_dbl,msk_tbl_dbl,op1);
+    } /* !thr_nbr */
+    free(msk_tbl_dbl);
+    break; /* !NC_DOUBLE */
+  default: 
+    (void)fprintf(stderr,"ERROR: %s reports datum size = %d B is invalid for %s filter\n",fnc_nm,type,CCR_FLT_NAME);
+    break;
+  } /* !type */
+  
+} /* ccr_gbr_abs() */
+
+static void
+ccr_gbr_dgt_xpn /* [fnc] Decimal digit count and binary exponent of value per DGG19 */
+(const double val, /* I [frc] Value to quantize */
+ int * const dgt_nbr, /* O [nbr] Number of digits before decimal point */
+ int * const xpn_flr, /* O [nbr] Binary exponent of value, rounded down */
+ int * const flg_mnt_zro) /* O [flg] Mantissa is zero (val is -0.0) */
+{
+  /* Purpose: Evaluate per-value DGG19 formulae exactly as original per-value Granular BitRound loop did
+     This is the only place log10() appears, it defines the results all faster kernels must reproduce */
+  const double bit_per_dgt=M_LN10/M_LN2; /* 3.32 [frc] Bits per decimal digit of precision = log2(10) */
+  const double dgt_per_bit=M_LN2/M_LN10; /* 0.301 [frc] Decimal digits per bit of precision = log10(2) */
+
+  double mnt; /* [frc] Mantissa, 0.5 <= mnt < 1.0 */
+  double mnt_fabs; /* [frc] fabs(mantissa) */
+  double mnt_log10_fabs; /* [frc] log10(fabs(mantissa))) */
+
+  int xpn_bs2; /* [nbr] Binary exponent xpn_bs2 in val = sign(val) * 2^xpn_bs2 * mnt, 0.5 < mnt <= 1.0 */
+
+  mnt=frexp(val,&xpn_bs2); /* DGG19 p. 4102 (8) */
+  mnt_fabs=fabs(mnt);
+  mnt_log10_fabs=log10(mnt_fabs);
+  /* 20211003 Continuous determination of dgt_nbr improves CR by ~10% */
+  *dgt_nbr=(int)floor(xpn_bs2*dgt_per_bit+mnt_log10_fabs)+1; /* DGG19 p. 4102 (8.67) */
+  *flg_mnt_zro= mnt_fabs == 0.0; /* Protect against mnt = -0.0 */
+  *xpn_flr= *flg_mnt_zro ? 0 : (int)floor(xpn_bs2-bit_per_dgt*mnt_log10_fabs);
+} /* !ccr_gbr_dgt_xpn() */
+
+static unsigned short /* O [nbr] Explicitly represented binary digits required to retain */
+ccr_gbr_prc_bnr /* [fnc] Explicit binary digits to retain per DGG19 */
+(const int nsd, /* I [nbr] Number of decimal significant digits to quantize to */
+ const int dgt_nbr, /* I [nbr] Number of digits before decimal point */
+ const int xpn_flr, /* I [nbr] Binary exponent of value, rounded down */
+ const int flg_mnt_zro) /* I [flg] Mantissa is zero (val is -0.0) */
+{
+  const double bit_per_dgt=M_LN10/M_LN2; /* 3.32 [frc] Bits per decimal digit of precision = log2(10) */
+
+  int qnt_pwr; /* [nbr] Power of two in quantization mask: qnt_msk = 2^qnt_pwr */
+
+  unsigned short prc_bnr_xpl_rqr; /* [nbr] Explicitly represented binary digits required to retain */
+
+  qnt_pwr=(int)floor(bit_per_dgt*(dgt_nbr-nsd)); /* DGG19 p. 4101 (7) */
+  prc_bnr_xpl_rqr= flg_mnt_zro ? 0 : abs(xpn_flr-qnt_pwr);
+  prc_bnr_xpl_rqr--; /* 20211003 Reduce formula result by 1 bit: Passes all tests, improves CR by ~10% */
+  return prc_bnr_xpl_rqr;
+} /* !ccr_gbr_prc_bnr() */
+
+static void
+ccr_gbr_flt_xct /* [fnc] Granular BitRound single-precision values with exact per-value formula */
+(const int nsd, /* I [nbr] Number of decimal significant digits to quantize to */
+ const size_t sz, /* I [nbr] Size (in elements) of buffer to quantize */
+ const float mss_val_cmp_flt, /* I [val] Missing value for comparison */
+ ptr_unn op1) /* I/O [frc] Values to quantize */
+{
+  /* Purpose: Reference path for values whose exponent field is all zeros or all ones (-0.0, subnormals, Inf, NaN) */
+  const int bit_xpl_nbr_sgn=23; /* [nbr] Bits 0-22 of SP significands are explicit. Bit 23 is implicitly 1. */
+
+  double val; /* [frc] Copy of input value to avoid indirection */
+
+  int bit_xpl_nbr_zro; /* [nbr] Number of explicit bits to zero */
+  int dgt_nbr; /* [nbr] Number of digits before decimal point */
+  int flg_mnt_zro; /* [flg] Mantissa is zero */
+  int xpn_flr; /* [nbr] Binary exponent of value, rounded down */
+
+  size_t idx;
+
+  unsigned int *u32_ptr=op1.ui32p;
+  unsigned int msk_f32_u32_zro;
+  unsigned int msk_f32_u32_one;
+  unsigned int msk_f32_u32_hshv;
+  unsigned short prc_bnr_xpl_rqr; /* [nbr] Explicitly represented binary digits required to retain */
+
+  /* Absolute error mode (NSD of 0) keeps these values intact */
+  if(nsd == 0) return;
+
+  for(idx=0L;idx<sz;idx++){
+    if((val=op1.fp[idx]) != mss_val_cmp_flt && u32_ptr[idx] != 0U){
+      ccr_gbr_dgt_xpn(val,&dgt_nbr,&xpn_flr,&flg_mnt_zro);
+      prc_bnr_xpl_rqr=ccr_gbr_prc_bnr(nsd,dgt_nbr,xpn_flr,flg_mnt_zro);
+
+      bit_xpl_nbr_zro=bit_xpl_nbr_sgn-prc_bnr_xpl_rqr;
+      msk_f32_u32_zro=0u; /* Zero all bits */
+      msk_f32_u32_zro=~msk_f32_u32_zro; /* Turn all bits to ones */
+      /* Bit Shave mask for AND: Left shift zeros into bits to be rounded, leave ones in untouched bits */
+      msk_f32_u32_zro <<= bit_xpl_nbr_zro;
+      /* Bit Set   mask for OR:  Put ones into bits to be set, zeros in untouched bits */
+      msk_f32_u32_one=~msk_f32_u32_zro;
+      msk_f32_u32_hshv=msk_f32_u32_one & (msk_f32_u32_zro >> 1); /* Set one bit: the MSB of LSBs */
+      u32_ptr[idx]+=msk_f32_u32_hshv; /* Add 1 to the MSB of LSBs, carry 1 to mantissa or even exponent */
+      u32_ptr[idx]&=msk_f32_u32_zro; /* Shave it */
+    } /* !mss_val_cmp_flt */
+  } /* !idx */
+} /* !ccr_gbr_flt_xct() */
+
+static void
+ccr_gbr_dbl_xct /* [fnc] Granular BitRound double-precision values with exact per-value formula */
+(const int nsd, /* I [nbr] Number of decimal significant digits to quantize to */
+ const size_t sz, /* I [nbr] Size (in elements) of buffer to quantize */
+ const double mss_val_cmp_dbl, /* I [val] Missing value for comparison */
+ ptr_unn op1) /* I/O [frc] Values to quantize */
+{
+  /* Purpose: Reference path for values whose exponent field is all zeros or all ones (-0.0, subnormals, Inf, NaN) */
+  const int bit_xpl_nbr_sgn=52; /* [nbr] Bits 0-51 of DP significands are explicit. Bit 52 is implicitly 1. */
+
+  double val; /* [frc] Copy of input value to avoid indirection */
+
+  int bit_xpl_nbr_zro; /* [nbr] Number of explicit bits to zero */
+  int dgt_nbr; /* [nbr] Number of digits before decimal point */
+  int flg_mnt_zro; /* [flg] Mantissa is zero */
+  int xpn_flr; /* [nbr] Binary exponent of value, rounded down */
+
+  size_t idx;
+
+  unsigned long long int *u64_ptr=op1.ui64p;
+  unsigned long long int msk_f64_u64_zro;
+  unsigned long long int msk_f64_u64_one;
+  unsigned long long int msk_f64_u64_hshv;
+  unsigned short prc_bnr_xpl_rqr; /* [nbr] Explicitly represented binary digits required to retain */
+
+  /* Absolute error mode (NSD of 0) keeps these values intact */
+  if(nsd == 0) return;
+
+  for(idx=0L;idx<sz;idx++){
+    if((val=op1.dp[idx]) != mss_val_cmp_dbl && u64_ptr[idx] != 0U){
+      ccr_gbr_dgt_xpn(val,&dgt_nbr,&xpn_flr,&flg_mnt_zro);
+      prc_bnr_xpl_rqr=ccr_gbr_prc_bnr(nsd,dgt_nbr,xpn_flr,flg_mnt_zro);
+
+      bit_xpl_nbr_zro=bit_xpl_nbr_sgn-prc_bnr_xpl_rqr;
+      msk_f64_u64_zro=0u; /* Zero all bits */
+      msk_f64_u64_zro=~msk_f64_u64_zro; /* Turn all bits to ones */
+      /* Bit Shave mask for AND: Left shift zeros into bits to be rounded, leave ones in untouched bits */
+      msk_f64_u64_zro <<= bit_xpl_nbr_zro;
+      /* Bit Set   mask for OR:  Put ones into bits to be set, zeros in untouched bits */
+      msk_f64_u64_one=~msk_f64_u64_zro;
+      msk_f64_u64_hshv=msk_f64_u64_one & (msk_f64_u64_zro >> 1); /* Set one bit: the MSB of LSBs */
+      u64_ptr[idx]+=msk_f64_u64_hshv; /* Add 1 to the MSB of LSBs, carry 1 to mantissa or even exponent */
+      u64_ptr[idx]&=msk_f64_u64_zro; /* Shave it */
+    } /* !mss_val_cmp_dbl */
+  } /* !idx */
+} /* !ccr_gbr_dbl_xct() */
+
+static void
+ccr_gbr_xpn_stp /* [fnc] Locate digit-count and exponent steps within one binade */
+(const int bit_xpl_nbr_sgn, /* I [nbr] Number of explicit bits in significand */
+ const int xpn_bias, /* I [nbr] IEEE exponent bias */
+ const int xpn_bsd, /* I [nbr] Biased exponent of binade, i.e., IEEE exponent field */
+ unsigned long long int * const dgt_thr, /* O [nbr] Smallest significand with one more digit, 2^bit_xpl_nbr_sgn if none */
+ int * const dgt_nbr, /* O [nbr] Number of digits before decimal point at bottom of binade */
+ unsigned long long int * const xpn_thr, /* O [nbr] Smallest significand where exponent reaches its value at top of binade */
+ int * const xpn_flr) /* O [nbr] Binary exponent, rounded down, at top of binade */
+{
+  /* Purpose: Binary search significands of one binade for the steps in DGG19 quantities
+     Within a binade log10(mnt) spans log10(2) < 1 so dgt_nbr increases at most once,
+     and xpn_bs2-log2(mnt) lies in (xpn_bs2,xpn_bs2+1] so xpn_flr decreases at most once (near mnt = 0.5)
+     Both quantities are monotonic in significand, so bisection finds steps exactly */
+  const unsigned long long int mnt_nbr=1ULL << bit_xpl_nbr_sgn; /* [nbr] Number of significands in binade */
+
+  int dgt_btm; /* [nbr] Digits at bottom of binade */
+  int dgt_mid; /* [nbr] Digits at bisection point */
+  int dgt_top; /* [nbr] Digits at top of binade */
+  int flg_mnt_zro; /* [flg] Mantissa is zero, never true for normal values */
+  int xpn_btm; /* [nbr] Exponent at bottom of binade */
+  int xpn_mid; /* [nbr] Exponent at bisection point */
+  int xpn_top; /* [nbr] Exponent at top of binade */
+
+  unsigned long long int mnt_lo; /* [nbr] Bisection lower bound */
+  unsigned long long int mnt_hi; /* [nbr] Bisection upper bound */
+  unsigned long long int mnt_mid; /* [nbr] Bisection point */
+
+#define CCR_GBR_VAL(mnt) ldexp(1.0+ldexp((double)(mnt),-bit_xpl_nbr_sgn),xpn_bsd-xpn_bias)
+  ccr_gbr_dgt_xpn(CCR_GBR_VAL(0ULL),&dgt_btm,&xpn_btm,&flg_mnt_zro);
+  ccr_gbr_dgt_xpn(CCR_GBR_VAL(mnt_nbr-1ULL),&dgt_top,&xpn_top,&flg_mnt_zro);
+  assert(dgt_top == dgt_btm || dgt_top == dgt_btm+1);
+  assert(xpn_btm == xpn_top || xpn_btm == xpn_top+1);
+
+  *dgt_nbr=dgt_btm;
+  *dgt_thr=mnt_nbr;
+  if(dgt_top != dgt_btm){
+    /* Invariant: dgt(mnt_lo) == dgt_btm, dgt(mnt_hi) == dgt_top */
+    mnt_lo=0ULL;
+    mnt_hi=mnt_nbr-1ULL;
+    while(mnt_hi-mnt_lo > 1ULL){
+      mnt_mid=mnt_lo+(mnt_hi-mnt_lo)/2ULL;
+      ccr_gbr_dgt_xpn(CCR_GBR_VAL(mnt_mid),&dgt_mid,&xpn_mid,&flg_mnt_zro);
+      if(dgt_mid == dgt_btm) mnt_lo=mnt_mid; else mnt_hi=mnt_mid;
+    } /* !mnt_hi */
+    *dgt_thr=mnt_hi;
+  } /* !dgt_top */
+
+  *xpn_flr=xpn_top;
+  *xpn_thr=0ULL;
+  if(xpn_btm != xpn_top){
+    /* Invariant: xpn(mnt_lo) == xpn_btm, xpn(mnt_hi) == xpn_top */
+    mnt_lo=0ULL;
+    mnt_hi=mnt_nbr-1ULL;
+    while(mnt_hi-mnt_lo > 1ULL){
+      mnt_mid=mnt_lo+(mnt_hi-mnt_lo)/2ULL;
+      ccr_gbr_dgt_xpn(CCR_GBR_VAL(mnt_mid),&dgt_mid,&xpn_mid,&flg_mnt_zro);
+      if(xpn_mid == xpn_btm) mnt_lo=mnt_mid; else mnt_hi=mnt_mid;
+    } /* !mnt_hi */
+    *xpn_thr=mnt_hi;
+  } /* !xpn_btm */
+#undef CCR_GBR_VAL
+} /* !ccr_gbr_xpn_stp() */
+
+void
+ccr_gbr_xpn_tbl_mk /* [fnc] Tabulate digit-count and exponent steps for every normal binade */
+(void)
+{
+  /* Purpose: Fill nsd-independent exponent tables once per process
+     Roughly 2x2048 bisections of 52 steps each, a few milliseconds, so defer until first quantization rather than plugin load */
+  unsigned long long int dgt_thr; /* [nbr] Smallest significand with one more digit */
+  unsigned long long int xpn_thr; /* [nbr] Smallest significand with exponent at top-of-binade value */
+
+  int xpn_bsd; /* [nbr] Biased exponent */
+
+  for(xpn_bsd=1;xpn_bsd<CCR_GBR_FLT_XPN_NBR-1;xpn_bsd++){
+    ccr_gbr_xpn_stp(23,127,xpn_bsd,&dgt_thr,ccr_gbr_flt_dgt_nbr+xpn_bsd,&xpn_thr,ccr_gbr_flt_xpn_flr+xpn_bsd);
+    ccr_gbr_flt_dgt_thr[xpn_bsd]=(unsigned int)dgt_thr;
+    ccr_gbr_flt_xpn_thr[xpn_bsd]=(unsigned int)xpn_thr;
+  } /* !xpn_bsd */
+  for(xpn_bsd=1;xpn_bsd<CCR_GBR_DBL_XPN_NBR-1;xpn_bsd++)
+    ccr_gbr_xpn_stp(52,1023,xpn_bsd,ccr_gbr_dbl_dgt_thr+xpn_bsd,ccr_gbr_dbl_dgt_nbr+xpn_bsd,ccr_gbr_dbl_xpn_thr+xpn_bsd,ccr_gbr_dbl_xpn_flr+xpn_bsd);
+  ccr_gbr_xpn_tbl_flg=1;
+} /* !ccr_gbr_xpn_tbl_mk() */
+
+static void
+ccr_gbr_xpn_tbl_ini /* [fnc] Fill exponent tables once per process, from any thread */
+(void)
+{
+  /* Purpose: ccr_quantize() may reach ccr_gbr() from many OpenMP or MPI threads at once, so tables must be filled exactly once
+     Without POSIX threads, the first quantization must finish before other threads start quantizing */
+#ifdef HAVE_PTHREAD_H
+  (void)pthread_once(&ccr_gbr_xpn_tbl_once,ccr_gbr_xpn_tbl_mk);
+#else /* !HAVE_PTHREAD_H */
+  if(!ccr_gbr_xpn_tbl_flg) ccr_gbr_xpn_tbl_mk();
+#endif /* !HAVE_PTHREAD_H */
+} /* !ccr_gbr_xpn_tbl_ini() */
+
+static void
+ccr_gbr_flt_msk_mk /* [fnc] Build single-precision Bit Shave mask table for given NSD */
+(const int nsd, /* I [nbr] Number of decimal significant digits to quantize to */
+ unsigned int * const msk_tbl) /* O [msk] Masks indexed by (exponent << 2) | (mnt >= dgt_thr) | (mnt < xpn_thr) << 1 */
+{
+  const int bit_xpl_nbr_sgn=23; /* [nbr] Bits 0-22 of SP significands are explicit. Bit 23 is implicitly 1. */
+  int bit_xpl_nbr_zro; /* [nbr] Number of explicit bits to zero */
+  int cmb; /* [idx] Combination of step flags */
+  int xpn_bsd; /* [nbr] Biased exponent */
+  unsigned int msk_f32_u32_zro;
+
+  for(xpn_bsd=0;xpn_bsd<CCR_GBR_FLT_XPN_NBR;xpn_bsd++){
+    for(cmb=0;cmb<4;cmb++){
+      msk_f32_u32_zro=0u; /* Zero all bits */
+      msk_f32_u32_zro=~msk_f32_u32_zro; /* Turn all bits to ones */
+      /* Zeros, subnormals, Inf and NaN never use table, leave them untouched */
+      if(xpn_bsd != 0 && xpn_bsd != CCR_GBR_FLT_XPN_NBR-1){
+	bit_xpl_nbr_zro=bit_xpl_nbr_sgn-ccr_gbr_prc_bnr(nsd,ccr_gbr_flt_dgt_nbr[xpn_bsd]+(cmb & 1),ccr_gbr_flt_xpn_flr[xpn_bsd]+(cmb >> 1),0);
+	msk_f32_u32_zro <<= bit_xpl_nbr_zro;
+      } /* !xpn_bsd */
+      msk_tbl[(xpn_bsd << 2)|cmb]=msk_f32_u32_zro;
+    } /* !cmb */
+  } /* !xpn_bsd */
+} /* !ccr_gbr_flt_msk_mk() */
+
+static void
+ccr_gbr_dbl_msk_mk /* [fnc] Build double-precision Bit Shave mask table for given NSD */
+(const int nsd, /* I [nbr] Number of decimal significant digits to quantize to */
+ unsigned long long int * const msk_tbl) /* O [msk] Masks indexed by (exponent << 2) | (mnt >= dgt_thr) | (mnt < xpn_thr) << 1 */
+{
+  const int bit_xpl_nbr_sgn=52; /* [nbr] Bits 0-51 of DP significands are explicit. Bit 52 is implicitly 1. */
+  int bit_xpl_nbr_zro; /* [nbr] Number of explicit bits to zero */
+  int cmb; /* [idx] Combination of step flags */
+  int xpn_bsd; /* [nbr] Biased exponent */
+  unsigned long long int msk_f64_u64_zro;
+
+  for(xpn_bsd=0;xpn_bsd<CCR_GBR_DBL_XPN_NBR;xpn_bsd++){
+    for(cmb=0;cmb<4;cmb++){
+      msk_f64_u64_zro=0u; /* Zero all bits */
+      msk_f64_u64_zro=~msk_f64_u64_zro; /* Turn all bits to ones */
+      /* Zeros, subnormals, Inf and NaN never use table, leave them untouched */
+      if(xpn_bsd != 0 && xpn_bsd != CCR_GBR_DBL_XPN_NBR-1){
+	bit_xpl_nbr_zro=bit_xpl_nbr_sgn-ccr_gbr_prc_bnr(nsd,ccr_gbr_dbl_dgt_nbr[xpn_bsd]+(cmb & 1),ccr_gbr_dbl_xpn_flr[xpn_bsd]+(cmb >> 1),0);
+	msk_f64_u64_zro <<= bit_xpl_nbr_zro;
+      } /* !xpn_bsd */
+      msk_tbl[(xpn_bsd << 2)|cmb]=msk_f64_u64_zro;
+    } /* !cmb */
+  } /* !xpn_bsd */
+} /* !ccr_gbr_dbl_msk_mk() */
+
+static void
+ccr_gbr_flt_abs_msk_mk /* [fnc] Build single-precision Bit Shave mask table for given absolute error */
+(const double abs_err, /* I [frc] Maximum absolute error */
+ unsigned int * const msk_tbl) /* O [msk] Masks indexed by (exponent << 2) | step flags, identical for all step flags */
+{
+  /* Purpose: Keep explicit bits down to the one worth 2^(qnt_pwr+1), the largest power of two not exceeding twice abs_err
+     Value with unbiased exponent xpn has explicit bits worth 2^(xpn-1), 2^(xpn-2), ...
+     Rounding at bit worth 2^(qnt_pwr+1) changes value by at most 2^qnt_pwr <= abs_err
+     Hence retain xpn-qnt_pwr-1 explicit bits, clamped to [0,bit_xpl_nbr_sgn] */
+  const int bit_xpl_nbr_sgn=23; /* [nbr] Bits 0-22 of SP significands are explicit. Bit 23 is implicitly 1. */
+  int bit_xpl_nbr_rqr; /* [nbr] Explicit bits to retain */
+  int cmb; /* [idx] Combination of step flags */
+  int qnt_pwr; /* [nbr] Power of two of largest rounding error: 2^qnt_pwr <= abs_err */
+  int xpn_bsd; /* [nbr] Biased exponent */
+  unsigned int msk_f32_u32_zro;
+
+  /* abs_err = mnt*2^qnt_pwr with 0.5 <= mnt < 1.0, so 2^(qnt_pwr-1) <= abs_err */
+  (void)frexp(abs_err,&qnt_pwr);
+  qnt_pwr--;
+  for(xpn_bsd=0;xpn_bsd<CCR_GBR_FLT_XPN_NBR;xpn_bsd++){
+    msk_f32_u32_zro=~0u;
+    /* Zeros, subnormals, Inf and NaN never use table, leave them untouched */
+    if(xpn_bsd != 0 && xpn_bsd != CCR_GBR_FLT_XPN_NBR-1){
+      bit_xpl_nbr_rqr=xpn_bsd-127-qnt_pwr-1;
+      if(bit_xpl_nbr_rqr < 0) bit_xpl_nbr_rqr=0;
+      if(bit_xpl_nbr_rqr < bit_xpl_nbr_sgn) msk_f32_u32_zro <<= bit_xpl_nbr_sgn-bit_xpl_nbr_rqr;
+    } /* !xpn_bsd */
+    for(cmb=0;cmb<4;cmb++) msk_tbl[(xpn_bsd << 2)|cmb]=msk_f32_u32_zro;
+  } /* !xpn_bsd */
+} /* !ccr_gbr_flt_abs_msk_mk() */
+
+static void
+ccr_gbr_dbl_abs_msk_mk /* [fnc] Build double-precision Bit Shave mask table for given absolute error */
+(const double abs_err, /* I [frc] Maximum absolute error */
+ unsigned long long int * const msk_tbl) /* O [msk] Masks indexed by (exponent << 2) | step flags, identical for all step flags */
+{
+  /* Purpose: Double-precision counterpart of ccr_gbr_flt_abs_msk_mk() */
+  const int bit_xpl_nbr_sgn=52; /* [nbr] Bits 0-51 of DP significands are explicit. Bit 52 is implicitly 1. */
+  int bit_xpl_nbr_rqr; /* [nbr] Explicit bits to retain */
+  int cmb; /* [idx] Combination of step flags */
+  int qnt_pwr; /* [nbr] Power of two of largest rounding error: 2^qnt_pwr <= abs_err */
+  int xpn_bsd; /* [nbr] Biased exponent */
+  unsigned long long int msk_f64_u64_zro;
+
+  (void)frexp(abs_err,&qnt_pwr);
+  qnt_pwr--;
+  for(xpn_bsd=0;xpn_bsd<CCR_GBR_DBL_XPN_NBR;xpn_bsd++){
+    msk_f64_u64_zro=~0ULL;
+    /* Zeros, subnormals, Inf and NaN never use table, leave them untouched */
+    if(xpn_bsd != 0 && xpn_bsd != CCR_GBR_DBL_XPN_NBR-1){
+      bit_xpl_nbr_rqr=xpn_bsd-1023-qnt_pwr-1;
+      if(bit_xpl_nbr_rqr < 0) bit_xpl_nbr_rqr=0;
+      if(bit_xpl_nbr_rqr < bit_xpl_nbr_sgn) msk_f64_u64_zro <<= bit_xpl_nbr_sgn-bit_xpl_nbr_rqr;
+    } /* !xpn_bsd */
+    for(cmb=0;cmb<4;cmb++) msk_tbl[(xpn_bsd << 2)|cmb]=msk_f64_u64_zro;
+  } /* !xpn_bsd */
+} /* !ccr_gbr_dbl_abs_msk_mk() */
+
+static void
+ccr_gbr_flt_scl /* [fnc] Granular BitRound single-precision values with portable scalar code */
+(const int nsd, /* I [nbr] Number of decimal significant digits to quantize to */
+ const size_t sz, /* I [nbr] Size (in elements) of buffer to quantize */
+ const float mss_val_cmp_flt, /* I [val] Missing value for comparison */
+ const unsigned int * const msk_tbl, /* I [msk] Bit Shave masks from ccr_gbr_flt_msk_mk() */
+ ptr_unn op1) /* I/O [frc] Values to quantize */
+{
+  unsigned int *u32_ptr=op1.ui32p;
+  unsigned int mnt; /* [nbr] Explicit significand bits */
+  unsigned int msk_f32_u32_zro;
+  unsigned int xpn_bsd; /* [nbr] Biased exponent */
+  ptr_unn op1_xct;
+  size_t idx;
+
+  for(idx=0L;idx<sz;idx++){
+    if(op1.fp[idx] != mss_val_cmp_flt && u32_ptr[idx] != 0U){
+      xpn_bsd=(u32_ptr[idx] >> 23) & 0xFFu;
+      if(xpn_bsd == 0u || xpn_bsd == 0xFFu){
+	op1_xct.fp=op1.fp+idx;
+	ccr_gbr_flt_xct(nsd,1L,mss_val_cmp_flt,op1_xct);
+	continue;
+      } /* !xpn_bsd */
+      mnt=u32_ptr[idx] & 0x7FFFFFu;
+      msk_f32_u32_zro=msk_tbl[(xpn_bsd << 2)|(mnt >= ccr_gbr_flt_dgt_thr[xpn_bsd])|((mnt < ccr_gbr_flt_xpn_thr[xpn_bsd]) << 1)];
+      u32_ptr[idx]+=~msk_f32_u32_zro & (msk_f32_u32_zro >> 1); /* Add 1 to the MSB of LSBs, carry 1 to mantissa or even exponent */
+      u32_ptr[idx]&=msk_f32_u32_zro; /* Shave it */
+    } /* !mss_val_cmp_flt */
+  } /* !idx */
+} /* !ccr_gbr_flt_scl() */
+
+static void
+ccr_gbr_dbl_scl /* [fnc] Granular BitRound double-precision values with portable scalar code */
+(const int nsd, /* I [nbr] Number of decimal significant digits to quantize to */
+ const size_t sz, /* I [nbr] Size (in elements) of buffer to quantize */
+ const double mss_val_cmp_dbl, /* I [val] Missing value for comparison */
+ const unsigned long long int * const msk_tbl, /* I [msk] Bit Shave masks from ccr_gbr_dbl_msk_mk() */
+ ptr_unn op1) /* I/O [frc] Values to quantize */
+{
+  unsigned long long int *u64_ptr=op1.ui64p;
+  unsigned long long int mnt; /* [nbr] Explicit significand bits */
+  unsigned long long int msk_f64_u64_zro;
+  unsigned int xpn_bsd; /* [nbr] Biased exponent */
+  ptr_unn op1_xct;
+  size_t idx;
+
+  for(idx=0L;idx<sz;idx++){
+    if(op1.dp[idx] != mss_val_cmp_dbl && u64_ptr[idx] != 0ULL){
+      xpn_bsd=(unsigned int)(u64_ptr[idx] >> 52) & 0x7FFu;
+      if(xpn_bsd == 0u || xpn_bsd == 0x7FFu){
+	op1_xct.dp=op1.dp+idx;
+	ccr_gbr_dbl_xct(nsd,1L,mss_val_cmp_dbl,op1_xct);
+	continue;
+      } /* !xpn_bsd */
+      mnt=u64_ptr[idx] & 0xFFFFFFFFFFFFFULL;
+      msk_f64_u64_zro=msk_tbl[(xpn_bsd << 2)|(mnt >= ccr_gbr_dbl_dgt_thr[xpn_bsd])|((mnt < ccr_gbr_dbl_xpn_thr[xpn_bsd]) << 1)];
+      u64_ptr[idx]+=~msk_f64_u64_zro & (msk_f64_u64_zro >> 1); /* Add 1 to the MSB of LSBs, carry 1 to mantissa or even exponent */
+      u64_ptr[idx]&=msk_f64_u64_zro; /* Shave it */
+    } /* !mss_val_cmp_dbl */
+  } /* !idx */
+} /* !ccr_gbr_dbl_scl() */
+
+#ifdef CCR_SIMD_X86
+/* Vector kernels gather step thresholds and masks by exponent
+   A vector containing any quantizable zero-exponent or all-ones-exponent lane goes to the scalar kernel
+   Remainders go to the scalar kernel */
+
+__attribute__((target("avx2")))
+static void
+ccr_gbr_flt_avx2 /* [fnc] Granular BitRound single-precision values with AVX2 */
+(const int nsd, /* I [nbr] Number of decimal significant digits to quantize to */
+ const size_t sz, /* I [nbr] Size (in elements) of buffer to quantize */
+ const float mss_val_cmp_flt, /* I [val] Missing value for comparison */
+ const unsigned int * const msk_tbl, /* I [msk] Bit Shave masks from ccr_gbr_flt_msk_mk() */
+ ptr_unn op1) /* I/O [frc] Values to quantize */
+{
+  const __m256 mss_val_vct=_mm256_set1_ps(mss_val_cmp_flt);
+  const __m256i xpn_msk_vct=_mm256_set1_epi32(0xFF);
+  const __m256i mnt_msk_vct=_mm256_set1_epi32(0x7FFFFF);
+  const __m256i one_vct=_mm256_set1_epi32(1);
+  const __m256i two_vct=_mm256_set1_epi32(2);
+  const __m256i zro_vct=_mm256_setzero_si256();
+  ptr_unn op1_tail;
+  size_t idx;
+
+  for(idx=0L;idx+8L<=sz;idx+=8L){
+    const __m256 val_vct=_mm256_loadu_ps(op1.fp+idx);
+    const __m256i u32_vct=_mm256_castps_si256(val_vct);
+    const __m256i xpn_vct=_mm256_and_si256(_mm256_srli_epi32(u32_vct,23),xpn_msk_vct);
+    const __m256i xct_vct=_mm256_or_si256(_mm256_cmpeq_epi32(xpn_vct,zro_vct),_mm256_cmpeq_epi32(xpn_vct,xpn_msk_vct));
+    /* Lanes to quantize: value differs from missing value (NaN compares unequal, as in scalar code) and is not +0.0 */
+    const __m256i qnt_vct=_mm256_andnot_si256(_mm256_cmpeq_epi32(u32_vct,zro_vct),_mm256_castps_si256(_mm256_cmp_ps(val_vct,mss_val_vct,_CMP_NEQ_UQ)));
+    __m256i mnt_vct,cmb_vct,msk_vct,rnd_vct;
+
+    if(!_mm256_testz_si256(xct_vct,qnt_vct)){
+      op1_tail.fp=op1.fp+idx;
+      ccr_gbr_flt_scl(nsd,8L,mss_val_cmp_flt,msk_tbl,op1_tail);
+      continue;
+    } /* !xct_vct */
+    if(_mm256_testz_si256(qnt_vct,qnt_vct)) continue;
+
+    mnt_vct=_mm256_and_si256(u32_vct,mnt_msk_vct);
+    /* Step flags: (mnt >= dgt_thr) contributes 1, (mnt < xpn_thr) contributes 2. Thresholds < 2^24, so signed compares suffice */
+    cmb_vct=_mm256_or_si256(_mm256_andnot_si256(_mm256_cmpgt_epi32(_mm256_i32gather_epi32((const int *)ccr_gbr_flt_dgt_thr,xpn_vct,4),mnt_vct),one_vct),
+			    _mm256_and_si256(_mm256_cmpgt_epi32(_mm256_i32gather_epi32((const int *)ccr_gbr_flt_xpn_thr,xpn_vct,4),mnt_vct),two_vct));
+    msk_vct=_mm256_i32gather_epi32((const int *)msk_tbl,_mm256_or_si256(_mm256_slli_epi32(xpn_vct,2),cmb_vct),4);
+    rnd_vct=_mm256_and_si256(_mm256_add_epi32(u32_vct,_mm256_andnot_si256(msk_vct,_mm256_srli_epi32(msk_vct,1))),msk_vct);
+    _mm256_storeu_si256((__m256i *)(op1.ui32p+idx),_mm256_blendv_epi8(u32_vct,rnd_vct,qnt_vct));
+  } /* !idx */
+  op1_tail.fp=op1.fp+idx;
+  ccr_gbr_flt_scl(nsd,sz-idx,mss_val_cmp_flt,msk_tbl,op1_tail);
+} /* !ccr_gbr_flt_avx2() */
+
+__attribute__((target("avx2")))
+static void
+ccr_gbr_dbl_avx2 /* [fnc] Granular BitRound double-precision values with AVX2 */
+(const int nsd, /* I [nbr] Number of decimal significant digits to quantize to */
+ const size_t sz, /* I [nbr] Size (in elements) of buffer to quantize */
+ const double mss_val_cmp_dbl, /* I [val] Missing value for comparison */
+ const unsigned long long int * const msk_tbl, /* I [msk] Bit Shave masks from ccr_gbr_dbl_msk_mk() */
+ ptr_unn op1) /* I/O [frc] Values to quantize */
+{
+  const __m256d mss_val_vct=_mm256_set1_pd(mss_val_cmp_dbl);
+  const __m256i xpn_msk_vct=_mm256_set1_epi64x(0x7FFLL);
+  const __m256i mnt_msk_vct=_mm256_set1_epi64x(0xFFFFFFFFFFFFFLL);
+  const __m256i one_vct=_mm256_set1_epi64x(1LL);
+  const __m256i two_vct=_mm256_set1_epi64x(2LL);
+  const __m256i zro_vct=_mm256_setzero_si256();
+  ptr_unn op1_tail;
+  size_t idx;
+
+  for(idx=0L;idx+4L<=sz;idx+=4L){
+    const __m256d val_vct=_mm256_loadu_pd(op1.dp+idx);
+    const __m256i u64_vct=_mm256_castpd_si256(val_vct);
+    const __m256i xpn_vct=_mm256_and_si256(_mm256_srli_epi64(u64_vct,52),xpn_msk_vct);
+    const __m256i xct_vct=_mm256_or_si256(_mm256_cmpeq_epi64(xpn_vct,zro_vct),_mm256_cmpeq_epi64(xpn_vct,xpn_msk_vct));
+    const __m256i qnt_vct=_mm256_andnot_si256(_mm256_cmpeq_epi64(u64_vct,zro_vct),_mm256_castpd_si256(_mm256_cmp_pd(val_vct,mss_val_vct,_CMP_NEQ_UQ)));
+    __m256i mnt_vct,cmb_vct,msk_vct,rnd_vct;
+
+    if(!_mm256_testz_si256(xct_vct,qnt_vct)){
+      op1_tail.dp=op1.dp+idx;
+      ccr_gbr_dbl_scl(nsd,4L,mss_val_cmp_dbl,msk_tbl,op1_tail);
+      continue;
+    } /* !xct_vct */
+    if(_mm256_testz_si256(qnt_vct,qnt_vct)) continue;
+
+    mnt_vct=_mm256_and_si256(u64_vct,mnt_msk_vct);
+    /* Thresholds <= 2^52, so signed compares suffice */
+    cmb_vct=_mm256_or_si256(_mm256_andnot_si256(_mm256_cmpgt_epi64(_mm256_i64gather_epi64((const long long *)ccr_gbr_dbl_dgt_thr,xpn_vct,8),mnt_vct),one_vct),
+			    _mm256_and_si256(_mm256_cmpgt_epi64(_mm256_i64gather_epi64((const long long *)ccr_gbr_dbl_xpn_thr,xpn_vct,8),mnt_vct),two_vct));
+    msk_vct=_mm256_i64gather_epi64((const long long *)msk_tbl,_mm256_or_si256(_mm256_slli_epi64(xpn_vct,2),cmb_vct),8);
+    rnd_vct=_mm256_and_si256(_mm256_add_epi64(u64_vct,_mm256_andnot_si256(msk_vct,_mm256_srli_epi64(msk_vct,1))),msk_vct);
+    _mm256_storeu_si256((__m256i *)(op1.ui64p+idx),_mm256_blendv_epi8(u64_vct,rnd_vct,qnt_vct));
+  } /* !idx */
+  op1_tail.dp=op1.dp+idx;
+  ccr_gbr_dbl_scl(nsd,sz-idx,mss_val_cmp_dbl,msk_tbl,op1_tail);
+} /* !ccr_gbr_dbl_avx2() */
+
+__attribute__((target("avx512f")))
+static void
+ccr_gbr_flt_avx512 /* [fnc] Granular BitRound single-precision values with AVX-512 */
+(const int nsd, /* I [nbr] Number of decimal significant digits to quantize to */
+ const size_t sz, /* I [nbr] Size (in elements) of buffer to quantize */
+ const float mss_val_cmp_flt, /* I [val] Missing value for comparison */
+ const unsigned int * const msk_tbl, /* I [msk] Bit Shave masks from ccr_gbr_flt_msk_mk() */
+ ptr_unn op1) /* I/O [frc] Values to quantize */
+{
+  const __m512 mss_val_vct=_mm512_set1_ps(mss_val_cmp_flt);
+  const __m512i xpn_msk_vct=_mm512_set1_epi32(0xFF);
+  const __m512i mnt_msk_vct=_mm512_set1_epi32(0x7FFFFF);
+  const __m512i one_vct=_mm512_set1_epi32(1);
+  const __m512i two_vct=_mm512_set1_epi32(2);
+  const __m512i zro_vct=_mm512_setzero_si512();
+  ptr_unn op1_tail;
+  size_t idx;
+
+  for(idx=0L;idx+16L<=sz;idx+=16L){
+    const __m512 val_vct=_mm512_loadu_ps(op1.fp+idx);
+    const __m512i u32_vct=_mm512_castps_si512(val_vct);
+    const __m512i xpn_vct=_mm512_and_si512(_mm512_srli_epi32(u32_vct,23),xpn_msk_vct);
+    const __mmask16 xct_msk=_mm512_cmpeq_epi32_mask(xpn_vct,zro_vct) | _mm512_cmpeq_epi32_mask(xpn_vct,xpn_msk_vct);
+    const __mmask16 qnt_msk=_mm512_cmp_ps_mask(val_vct,mss_val_vct,_CMP_NEQ_UQ) & _mm512_test_epi32_mask(u32_vct,u32_vct);
+    __m512i mnt_vct,idx_vct,msk_vct,rnd_vct;
+
+    if(xct_msk & qnt_msk){
+      op1_tail.fp=op1.fp+idx;
+      ccr_gbr_flt_scl(nsd,16L,mss_val_cmp_flt,msk_tbl,op1_tail);
+      continue;
+    } /* !xct_msk */
+    if(!qnt_msk) continue;
+
+    mnt_vct=_mm512_and_si512(u32_vct,mnt_msk_vct);
+    idx_vct=_mm512_slli_epi32(xpn_vct,2);
+    idx_vct=_mm512_mask_or_epi32(idx_vct,_mm512_cmpge_epu32_mask(mnt_vct,_mm512_i32gather_epi32(xpn_vct,(const void *)ccr_gbr_flt_dgt_thr,4)),idx_vct,one_vct);
+    idx_vct=_mm512_mask_or_epi32(idx_vct,_mm512_cmplt_epu32_mask(mnt_vct,_mm512_i32gather_epi32(xpn_vct,(const void *)ccr_gbr_flt_xpn_thr,4)),idx_vct,two_vct);
+    msk_vct=_mm512_i32gather_epi32(idx_vct,(const void *)msk_tbl,4);
+    rnd_vct=_mm512_and_si512(_mm512_add_epi32(u32_vct,_mm512_andnot_si512(msk_vct,_mm512_srli_epi32(msk_vct,1))),msk_vct);
+    _mm512_storeu_si512((void *)(op1.ui32p+idx),_mm512_mask_mov_epi32(u32_vct,qnt_msk,rnd_vct));
+  } /* !idx */
+  op1_tail.fp=op1.fp+idx;
+  ccr_gbr_flt_scl(nsd,sz-idx,mss_val_cmp_flt,msk_tbl,op1_tail);
+} /* !ccr_gbr_flt_avx512() */
+
+__attribute__((target("avx512f")))
+static void
+ccr_gbr_dbl_avx512 /* [fnc] Granular BitRound double-precision values with AVX-512 */
+(const int nsd, /* I [nbr] Number of decimal significant digits to quantize to */
+ const size_t sz, /* I [nbr] Size (in elements) of buffer to quantize */
+ const double mss_val_cmp_dbl, /* I [val] Missing value for comparison */
+ const unsigned long long int * const msk_tbl, /* I [msk] Bit Shave masks from ccr_gbr_dbl_msk_mk() */
+ ptr_unn op1) /* I/O [frc] Values to quantize */
+{
+  const __m512d mss_val_vct=_mm512_set1_pd(mss_val_cmp_dbl);
+  const __m512i xpn_msk_vct=_mm512_set1_epi64(0x7FFLL);
+  const __m512i mnt_msk_vct=_mm512_set1_epi64(0xFFFFFFFFFFFFFLL);
+  const __m512i one_vct=_mm512_set1_epi64(1LL);
+  const __m512i two_vct=_mm512_set1_epi64(2LL);
+  const __m512i zro_vct=_mm512_setzero_si512();
+  ptr_unn op1_tail;
+  size_t idx;
+
+  for(idx=0L;idx+8L<=sz;idx+=8L){
+    const __m512d val_vct=_mm512_loadu_pd(op1.dp+idx);
+    const __m512i u64_vct=_mm512_castpd_si512(val_vct);
+    const __m512i xpn_vct=_mm512_and_si512(_mm512_srli_epi64(u64_vct,52),xpn_msk_vct);
+    const __mmask8 xct_msk=_mm512_cmpeq_epi64_mask(xpn_vct,zro_vct) | _mm512_cmpeq_epi64_mask(xpn_vct,xpn_msk_vct);
+    const __mmask8 qnt_msk=_mm512_cmp_pd_mask(val_vct,mss_val_vct,_CMP_NEQ_UQ) & _mm512_test_epi64_mask(u64_vct,u64_vct);
+    __m512i mnt_vct,idx_vct,msk_vct,rnd_vct;
+
+    if(xct_msk & qnt_msk){
+      op1_tail.dp=op1.dp+idx;
+      ccr_gbr_dbl_scl(nsd,8L,mss_val_cmp_dbl,msk_tbl,op1_tail);
+      continue;
+    } /* !xct_msk */
+    if(!qnt_msk) continue;
+
+    mnt_vct=_mm512_and_si512(u64_vct,mnt_msk_vct);
+    idx_vct=_mm512_slli_epi64(xpn_vct,2);
+    idx_vct=_mm512_mask_or_epi64(idx_vct,_mm512_cmpge_epu64_mask(mnt_vct,_mm512_i64gather_epi64(xpn_vct,(const void *)ccr_gbr_dbl_dgt_thr,8)),idx_vct,one_vct);
+    idx_vct=_mm512_mask_or_epi64(idx_vct,_mm512_cmplt_epu64_mask(mnt_vct,_mm512_i64gather_epi64(xpn_vct,(const void *)ccr_gbr_dbl_xpn_thr,8)),idx_vct,two_vct);
+    msk_vct=_mm512_i64gather_epi64(idx_vct,(const void *)msk_tbl,8);
+    rnd_vct=_mm512_and_si512(_mm512_add_epi64(u64_vct,_mm512_andnot_si512(msk_vct,_mm512_srli_epi64(msk_vct,1))),msk_vct);
+    _mm512_storeu_si512((void *)(op1.ui64p+idx),_mm512_mask_mov_epi64(u64_vct,qnt_msk,rnd_vct));
+  } /* !idx */
+  op1_tail.dp=op1.dp+idx;
+  ccr_gbr_dbl_scl(nsd,sz-idx,mss_val_cmp_dbl,msk_tbl,op1_tail);
+} /* !ccr_gbr_dbl_avx512() */
+#endif /* !CCR_SIMD_X86 */
+
+void
+ccr_gbr_cpu_dispatch /* [fnc] Select fastest Granular BitRound kernels supported by this CPU */
+(void)
+{
+  /* Purpose: Query CPUID (through compiler builtins that also check OS register-state support) and point kernels at widest supported instruction set
+     Results are identical for all kernels, only speed differs */
+  ccr_gbr_flt_knl=ccr_gbr_flt_scl;
+  ccr_gbr_dbl_knl=ccr_gbr_dbl_scl;
+  ccr_gbr_knl_nm="scalar";
+#ifdef CCR_SIMD_X86
+  __builtin_cpu_init();
+  if(__builtin_cpu_supports("avx512f")){
+    ccr_gbr_flt_knl=ccr_gbr_flt_avx512;
+    ccr_gbr_dbl_knl=ccr_gbr_dbl_avx512;
+    ccr_gbr_knl_nm="AVX-512";
+  }else if(__builtin_cpu_supports("avx2")){
+    ccr_gbr_flt_knl=ccr_gbr_flt_avx2;
+    ccr_gbr_dbl_knl=ccr_gbr_dbl_avx2;
+    ccr_gbr_knl_nm="AVX2";
+  } /* !__builtin_cpu_supports() */
+#endif /* !CCR_SIMD_X86 */
+  if(CCR_FLT_DBG_INFO) (void)fprintf(stderr,"INFO: \"%s\" filter selected %s kernels\n",CCR_FLT_NAME,ccr_gbr_knl_nm);
+} /* !ccr_gbr_cpu_dispatch() */
+
+void
+ccr_gbr_knl_ini /* [fnc] Select Granular BitRound kernels once per process, from any thread */
+(void)
+{
+  /* Purpose: Dispatch exactly once, whether first reached from plugin load or from concurrent ccr_quantize() calls */
+#ifdef HAVE_PTHREAD_H
+  (void)pthread_once(&ccr_gbr_knl_once,ccr_gbr_cpu_dispatch);
+#else /* !HAVE_PTHREAD_H */
+  if(!ccr_gbr_flt_knl) ccr_gbr_cpu_dispatch();
+#endif /* !HAVE_PTHREAD_H */
+} /* !ccr_gbr_knl_ini() */
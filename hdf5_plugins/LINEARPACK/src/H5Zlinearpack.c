@@ -0,0 +1,1083 @@
+/* Copyright (C) 2026--present Charlie Zender */
+
+ /*
+ * This file is an example of an HDF5 filter plugin.
+ * The plugin can be used with the HDF5 library version 1.8.11+ to read and write
+ * floating-point HDF5 datasets packed into 8, 16, or 32-bit integers within an absolute error bound.
+ */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h" /* Autotools tokens */
+#endif
+#include <stdio.h>
+#ifdef HAVE_SYS_TYPES_H
+# include <sys/types.h>
+#endif
+#ifdef HAVE_SYS_STAT_H
+# include <sys/stat.h>
+#endif
+#ifdef STDC_HEADERS
+# include <stdlib.h>
+# include <stddef.h>
+#else
+# ifdef HAVE_STDLIB_H
+#  include <stdlib.h>
+# endif
+#endif
+#ifdef HAVE_STRING_H
+# if !defined STDC_HEADERS && defined HAVE_MEMORY_H
+#  include <memory.h>
+# endif
+# include <string.h>
+#endif
+#ifdef HAVE_STRINGS_H
+# include <strings.h>
+#endif
+#ifdef HAVE_INTTYPES_H
+# include <inttypes.h>
+#endif
+#ifdef HAVE_STDINT_H
+# include <stdint.h>
+#endif
+#ifdef HAVE_UNISTD_H
+# include <unistd.h>
+#endif
+#include <assert.h>
+
+#if defined(_WIN32)
+#include <Winsock2.h>
+#endif
+
+/* SIMD kernels need x86 intrinsics plus GCC/Clang function-level target attributes and __builtin_cpu_supports()
+   Other compilers and architectures use the scalar kernels */
+#if defined(HAVE_IMMINTRIN_H) && (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+# define CCR_SIMD_X86 1
+# include <immintrin.h> /* AVX2 intrinsics */
+#endif /* !HAVE_IMMINTRIN_H */
+
+/* 3rd party vendors */
+#include "H5PLextern.h" /* HDF5 Plugin Library: H5PLget_plugin_type(), H5PLget_plugin_info() */
+
+/* Tokens and typedefs */
+#define H5Z_FILTER_LINEARPACK 32770 /* NB: Not yet registered with HDF, see ccr.h */
+#define CCR_FLT_DBG_INFO 0 /* [flg] Print non-fatal debugging information */
+#define CCR_FLT_NAME "Linear Packing filter (error-bounded scale and offset packing into 8, 16, or 32-bit integers)" /* [sng] Filter name in vernacular for HDF5 messages */
+#define CCR_FLT_PRM_NBR 6 /* [nbr] Number of parameters sent to filter (in cd_params array). NB: keep identical with ccr.h:LINEARPACK_FLT_PRM_NBR */
+#define CCR_FLT_PRM_PSN_ERR 0 /* [nbr] Ordinal position of maximum absolute error in parameter list (cd_params array) NB: Error bound is double-precision and uses cd_params[0] and cd_params[1] */
+#define CCR_FLT_PRM_PSN_DATUM_SIZE 2 /* [nbr] Ordinal position of datum_size in parameter list (cd_params array) */
+#define CCR_FLT_PRM_PSN_HAS_MSS_VAL 3 /* [nbr] Ordinal position of missing value flag in parameter list (cd_params array) */
+#define CCR_FLT_PRM_PSN_MSS_VAL 4 /* [nbr] Ordinal position of missing value in parameter list (cd_params array) NB: Missing value (_FillValue) uses two cd_params slots so it can be single or double-precision. Single-precision values are read as first 4-bytes starting at cd_params[4] (and cd_params[5] is ignored), while double-precision values are read as first 8-bytes starting at cd_params[4] and ending with cd_params[5]. */
+
+/* Each chunk starts with a little-endian header that lets the decoder rebuild values without filter parameters other than datum size and missing value:
+   Byte  0     Header version
+   Byte  1     Packed width in bits: 0 (constant chunk, every value equals offset), 8, 16, 32, or 255 (raw, values stored unpacked)
+   Bytes 2-3   Reserved, zero
+   Bytes 4-7   Number of values in chunk
+   Bytes 8-15  Offset (double), i.e., chunk minimum
+   Bytes 16-23 Step (double), i.e., twice the error bound
+   Packed codes follow in little-endian order, and the largest code of each width (e.g., 255) is reserved for missing values */
+#define CCR_LPK_HDR_SZ 24 /* [B] Chunk header size */
+#define CCR_LPK_VRS 1 /* [nbr] Chunk header version */
+#define CCR_LPK_WDT_CNS 0 /* [nbr] Width code for constant chunk */
+#define CCR_LPK_WDT_RAW 255 /* [nbr] Width code for unpacked chunk */
+/* Codes must stay below the reserved missing-value code of 32-bit width */
+#define CCR_LPK_CD_MAX_DBL 4294967294.0 /* [nbr] Largest packable code */
+
+/* Compatibility tokens and typedefs retain source-code compatibility between NCO and filter
+   These tokens mimic netCDF/NCO code but do not rely on or interfere with either */
+#ifndef NC_FILL_FLOAT
+# define NC_FILL_FLOAT   (9.9692099683868690e+36f) /* near 15 * 2^119 */
+#endif /* !NC_FILL_FLOAT */
+#ifndef NC_FILL_DOUBLE
+# define NC_FILL_DOUBLE  (9.9692099683868690e+36)
+#endif /* !NC_FILL_DOUBLE */
+
+/* Packing kernels scan, pack, and unpack a whole chunk in one sweep each
+   Kernel choice (scalar, AVX2) is made once by ccr_lpk_cpu_dispatch() */
+typedef size_t /* O [nbr] Number of valid (non-missing) values */
+(*ccr_lpk_mnm_flt_knl_t) /* [fnc] Minimum/maximum kernel for single-precision values */
+(const size_t sz, /* I [nbr] Number of values */
+ const float *op1, /* I [frc] Values to scan */
+ const float mss_val, /* I [val] Missing value */
+ float *min, /* O [frc] Minimum valid value */
+ float *max, /* O [frc] Maximum valid value */
+ int *flg_nfn); /* O [flg] Some valid value is infinite or NaN */
+
+typedef size_t /* O [nbr] Number of valid (non-missing) values */
+(*ccr_lpk_mnm_dbl_knl_t) /* [fnc] Minimum/maximum kernel for double-precision values */
+(const size_t sz, /* I [nbr] Number of values */
+ const double *op1, /* I [frc] Values to scan */
+ const double mss_val, /* I [val] Missing value */
+ double *min, /* O [frc] Minimum valid value */
+ double *max, /* O [frc] Maximum valid value */
+ int *flg_nfn); /* O [flg] Some valid value is infinite or NaN */
+
+typedef void /* O [nbr] Nothing */
+(*ccr_lpk_enc_flt_knl_t) /* [fnc] Packing kernel for single-precision values */
+(const size_t sz, /* I [nbr] Number of values */
+ const float *op1, /* I [frc] Values to pack */
+ const float mss_val, /* I [val] Missing value */
+ const double ofs, /* I [frc] Offset */
+ const double stp_rcp, /* I [frc] Reciprocal of step */
+ const unsigned int cd_max, /* I [nbr] Largest code of valid values */
+ const unsigned int cd_mss, /* I [nbr] Code of missing value */
+ unsigned int *cd); /* O [nbr] Codes */
+
+typedef void /* O [nbr] Nothing */
+(*ccr_lpk_enc_dbl_knl_t) /* [fnc] Packing kernel for double-precision values */
+(const size_t sz, /* I [nbr] Number of values */
+ const double *op1, /* I [frc] Values to pack */
+ const double mss_val, /* I [val] Missing value */
+ const double ofs, /* I [frc] Offset */
+ const double stp_rcp, /* I [frc] Reciprocal of step */
+ const unsigned int cd_max, /* I [nbr] Largest code of valid values */
+ const unsigned int cd_mss, /* I [nbr] Code of missing value */
+ unsigned int *cd); /* O [nbr] Codes */
+
+typedef void /* O [nbr] Nothing */
+(*ccr_lpk_dec_flt_knl_t) /* [fnc] Unpacking kernel for single-precision values */
+(const size_t sz, /* I [nbr] Number of values */
+ const int wdt, /* I [nbr] Packed width in bits (8, 16, or 32) */
+ const void *cd, /* I [nbr] Codes in host byte order */
+ const unsigned int cd_mss, /* I [nbr] Code of missing value */
+ const float mss_val, /* I [val] Missing value */
+ const double ofs, /* I [frc] Offset */
+ const double stp, /* I [frc] Step */
+ float *op1); /* O [frc] Unpacked values */
+
+typedef void /* O [nbr] Nothing */
+(*ccr_lpk_dec_dbl_knl_t) /* [fnc] Unpacking kernel for double-precision values */
+(const size_t sz, /* I [nbr] Number of values */
+ const int wdt, /* I [nbr] Packed width in bits (8, 16, or 32) */
+ const void *cd, /* I [nbr] Codes in host byte order */
+ const unsigned int cd_mss, /* I [nbr] Code of missing value */
+ const double mss_val, /* I [val] Missing value */
+ const double ofs, /* I [frc] Offset */
+ const double stp, /* I [frc] Step */
+ double *op1); /* O [frc] Unpacked values */
+
+/* Forward-declare functions before their names appear in H5Z_class2_t filter structure */
+size_t /* O [B] Number of bytes resulting after forward/reverse filter applied */
+H5Z_filter_linearpack /* [fnc] HDF5 Linear Packing Filter */
+(unsigned int flags, /* I [flg] Bitfield that encodes filter direction */
+ size_t cd_nelmts, /* I [nbr] Number of elements in filter parameter (cd_values[]) array */
+ const unsigned int cd_values[], /* I [enm] Filter parameters */
+ size_t bfr_sz_in, /* I [B] Number of bytes in input buffer (before forward/reverse filter) */
+ size_t *bfr_sz_out, /* O [B] Number of bytes in output buffer (after forward/reverse filter) */
+ void **bfr_inout); /* I/O [frc] Values to pack or unpack */
+
+htri_t /* O [flg] Data meet criteria to apply filter */
+ccr_can_apply_linearpack /* [fnc] Callback to determine if current variable meets filter criteria */
+(hid_t dcpl, /* I [id] Dataset creation property list ID */
+ hid_t type, /* I [id] Dataset type ID */
+ hid_t space); /* I [id] Dataset space ID */
+
+htri_t /* O [flg] Filter parameters successfully modified for this variable */
+ccr_set_local_linearpack /* [fnc] Callback to determine and set per-variable filter parameters */
+(hid_t dcpl, /* I [id] Dataset creation property list ID */
+ hid_t type, /* I [id] Dataset type ID */
+ hid_t space); /* I [id] Dataset space ID */
+
+const H5Z_class2_t H5Z_LINEARPACK[1]={{
+    H5Z_CLASS_T_VERS, /* H5Z_class_t version */
+    (H5Z_filter_t)H5Z_FILTER_LINEARPACK, /* Filter ID number */
+#ifdef FILTER_DECODE_ONLY
+    0, /* [flg] Encoder availability flag */
+#else
+    1, /* [flg] Encoder availability flag */
+#endif
+    1, /* [flg] Decoder availability flag */
+    CCR_FLT_NAME, /* [sng] Filter name for debugging */
+    ccr_can_apply_linearpack, /* [fnc] Callback to determine if current variable meets filter criteria */
+    ccr_set_local_linearpack, /* [fnc] Callback to determine and set per-variable filter parameters */
+    (H5Z_func_t)H5Z_filter_linearpack, /* [fnc] Function to implement filter */
+  }}; /* !H5Z_LINEARPACK */
+
+void
+ccr_lpk_cpu_dispatch /* [fnc] Select fastest packing kernels supported by this CPU */
+(void);
+
+/* Kernels selected by ccr_lpk_cpu_dispatch(), NULL until first dispatch */
+static ccr_lpk_mnm_flt_knl_t ccr_lpk_mnm_flt_knl=NULL; /* [fnc] Single-precision minimum/maximum kernel */
+static ccr_lpk_mnm_dbl_knl_t ccr_lpk_mnm_dbl_knl=NULL; /* [fnc] Double-precision minimum/maximum kernel */
+static ccr_lpk_enc_flt_knl_t ccr_lpk_enc_flt_knl=NULL; /* [fnc] Single-precision packing kernel */
+static ccr_lpk_enc_dbl_knl_t ccr_lpk_enc_dbl_knl=NULL; /* [fnc] Double-precision packing kernel */
+static ccr_lpk_dec_flt_knl_t ccr_lpk_dec_flt_knl=NULL; /* [fnc] Single-precision unpacking kernel */
+static ccr_lpk_dec_dbl_knl_t ccr_lpk_dec_dbl_knl=NULL; /* [fnc] Double-precision unpacking kernel */
+static const char *ccr_lpk_knl_nm="none"; /* [sng] Name of selected kernels, for debugging */
+
+/* Function definitions */
+H5PL_type_t /* O [enm] Plugin type */
+H5PLget_plugin_type /* [fnc] Provide plug-in type provided by this shared library */
+(void)
+{ /* Purpose: Describe plug-in type provided by this shared library
+     The HDF5 plugin mechanism usually calls this function after an application calls H5Pset_filter(), or when the data to which this filter will be applied are first read */
+  return H5PL_TYPE_FILTER;
+} /* !H5PLget_plugin_type() */
+
+const void * /* O [enm] */
+H5PLget_plugin_info /* [fnc] Return structure */
+(void)
+{ /* Purpose: Provide structure that defines Linear Packing filter so the filter may be dynamically registered with the plugin mechanism
+     The HDF5 plugin mechanism usually calls this function after an application calls H5Pset_filter(), or when the data to which this filter will be applied are first read */
+  ccr_lpk_cpu_dispatch();
+  return H5Z_LINEARPACK;
+} /* !H5PLget_plugin_info() */
+
+static int /* O [flg] Host is big-endian */
+ccr_lpk_is_big_endian /* [fnc] Determine host byte order */
+(void)
+{
+  const unsigned int one=1U; /* [nbr] Probe */
+  return *(const unsigned char *)&one == 0;
+} /* !ccr_lpk_is_big_endian() */
+
+static void
+ccr_lpk_bswap /* [fnc] Reverse byte order of each value in buffer */
+(const size_t sz, /* I [nbr] Number of values */
+ const int wdt, /* I [nbr] Width of each value in bits (16 or 32) */
+ void *bfr) /* I/O [nbr] Values */
+{
+  unsigned char *cp=(unsigned char *)bfr; /* [ptr] Buffer as bytes */
+  unsigned char tmp; /* [nbr] Byte being swapped */
+  size_t idx;
+
+  if(wdt == 16){
+    for(idx=0;idx<sz;idx++,cp+=2){
+      tmp=cp[0]; cp[0]=cp[1]; cp[1]=tmp;
+    } /* !idx */
+  }else if(wdt == 32){
+    for(idx=0;idx<sz;idx++,cp+=4){
+      tmp=cp[0]; cp[0]=cp[3]; cp[3]=tmp;
+      tmp=cp[1]; cp[1]=cp[2]; cp[2]=tmp;
+    } /* !idx */
+  } /* !wdt */
+} /* !ccr_lpk_bswap() */
+
+static void
+ccr_lpk_hdr_put /* [fnc] Write chunk header */
+(unsigned char *hdr, /* O [B] Header */
+ const int wdt, /* I [nbr] Width code */
+ const size_t sz, /* I [nbr] Number of values */
+ const double ofs, /* I [frc] Offset */
+ const double stp) /* I [frc] Step */
+{
+  unsigned long long u64; /* [bit] Double as bits */
+  int idx;
+
+  memset(hdr,0,CCR_LPK_HDR_SZ);
+  hdr[0]=CCR_LPK_VRS;
+  hdr[1]=(unsigned char)wdt;
+  for(idx=0;idx<4;idx++) hdr[4+idx]=(unsigned char)((sz >> (8*idx)) & 0xFFU);
+  memcpy(&u64,&ofs,sizeof(double));
+  for(idx=0;idx<8;idx++) hdr[8+idx]=(unsigned char)((u64 >> (8*idx)) & 0xFFU);
+  memcpy(&u64,&stp,sizeof(double));
+  for(idx=0;idx<8;idx++) hdr[16+idx]=(unsigned char)((u64 >> (8*idx)) & 0xFFU);
+} /* !ccr_lpk_hdr_put() */
+
+static void
+ccr_lpk_hdr_get /* [fnc] Read chunk header */
+(const unsigned char *hdr, /* I [B] Header */
+ int *vrs, /* O [nbr] Header version */
+ int *wdt, /* O [nbr] Width code */
+ size_t *sz, /* O [nbr] Number of values */
+ double *ofs, /* O [frc] Offset */
+ double *stp) /* O [frc] Step */
+{
+  unsigned long long u64; /* [bit] Double as bits */
+  unsigned long u32; /* [nbr] Count */
+  int idx;
+
+  *vrs=hdr[0];
+  *wdt=hdr[1];
+  for(u32=0,idx=3;idx>=0;idx--) u32=(u32 << 8) | hdr[4+idx];
+  *sz=(size_t)u32;
+  for(u64=0,idx=7;idx>=0;idx--) u64=(u64 << 8) | hdr[8+idx];
+  memcpy(ofs,&u64,sizeof(double));
+  for(u64=0,idx=7;idx>=0;idx--) u64=(u64 << 8) | hdr[16+idx];
+  memcpy(stp,&u64,sizeof(double));
+} /* !ccr_lpk_hdr_get() */
+
+size_t /* O [B] Number of bytes resulting after forward/reverse filter applied */
+H5Z_filter_linearpack /* [fnc] HDF5 Linear Packing Filter */
+(unsigned int flags, /* I [flg] Bitfield that encodes filter direction */
+ size_t cd_nelmts, /* I [nbr] Number of elements in filter parameter (cd_values[]) array */
+ const unsigned int cd_values[], /* I [enm] Filter parameters */
+ size_t bfr_sz_in, /* I [B] Number of bytes in input buffer (before forward/reverse filter) */
+ size_t *bfr_sz_out, /* O [B] Number of bytes in output buffer (after forward/reverse filter) */
+ void **bfr_inout) /* I/O [frc] Values to pack or unpack */
+{
+  /* Purpose: Dynamic filter invoked by HDF5 to pack floating-point values into integers, and unpack them on read
+     Forward filter finds chunk minimum and maximum, picks narrowest width whose codes span the range in steps of twice the error bound, and packs each value to its nearest code
+     Reverse filter rebuilds each value as offset plus code times step, which lies within error bound of the original value (plus rounding to datum precision)
+     Chunks that hold infinities or NaNs, or whose range needs more codes than 32 bits hold, are stored unpacked */
+
+  const char fnc_nm[]="H5Z_filter_linearpack()"; /* [sng] Function name */
+
+  double err; /* [frc] Maximum absolute error */
+  double mss_val_dbl; /* [val] Missing value (double-precision) */
+  double ofs=0.0; /* [frc] Offset */
+  double stp=0.0; /* [frc] Step */
+  float mss_val_flt; /* [val] Missing value (single-precision) */
+  int has_mss_val; /* [flg] Flag for missing values */
+  int vrs; /* [nbr] Header version */
+  int wdt; /* [nbr] Width code */
+  size_t datum_size; /* [B] Bytes per unfiltered data value */
+  size_t elm_nbr; /* [nbr] Number of values in buffer */
+  size_t bfr_sz_new; /* [B] Size of new buffer */
+  size_t bfr_sz_alc; /* [B] Size allocated for new buffer */
+  unsigned char *bfr_new=NULL; /* [ptr] New buffer */
+  unsigned int cd_mss; /* [nbr] Code of missing value */
+
+  if(!ccr_lpk_mnm_flt_knl) ccr_lpk_cpu_dispatch();
+
+  if(cd_nelmts < CCR_FLT_PRM_NBR){
+    (void)fprintf(stderr,"ERROR: \"%s\" filter function %s reports %lu parameters, needs %d\n",CCR_FLT_NAME,fnc_nm,(unsigned long)cd_nelmts,CCR_FLT_PRM_NBR);
+    goto error;
+  } /* !cd_nelmts */
+
+  memcpy(&err,cd_values+CCR_FLT_PRM_PSN_ERR,sizeof(double));
+  datum_size=cd_values[CCR_FLT_PRM_PSN_DATUM_SIZE];
+  has_mss_val=cd_values[CCR_FLT_PRM_PSN_HAS_MSS_VAL];
+  if(datum_size == sizeof(float)){
+    if(has_mss_val) memcpy(&mss_val_flt,cd_values+CCR_FLT_PRM_PSN_MSS_VAL,sizeof(float)); else mss_val_flt=NC_FILL_FLOAT;
+    mss_val_dbl=mss_val_flt;
+  }else if(datum_size == sizeof(double)){
+    if(has_mss_val) memcpy(&mss_val_dbl,cd_values+CCR_FLT_PRM_PSN_MSS_VAL,sizeof(double)); else mss_val_dbl=NC_FILL_DOUBLE;
+    mss_val_flt=0.0f;
+  }else{
+    (void)fprintf(stderr,"ERROR: \"%s\" filter function %s reports datum size = %lu B is invalid, only 4 B float and 8 B double are supported\n",CCR_FLT_NAME,fnc_nm,(unsigned long)datum_size);
+    goto error;
+  } /* !datum_size */
+
+  if(CCR_FLT_DBG_INFO) (void)fprintf(stderr,"INFO: %s reports error bound = %g, datum size = %lu B, has_mss_val = %d, missing value = %g\n",fnc_nm,err,(unsigned long)datum_size,has_mss_val,mss_val_dbl);
+
+  if(flags & H5Z_FLAG_REVERSE){
+
+    /* Unpack */
+    if(bfr_sz_in < CCR_LPK_HDR_SZ){
+      (void)fprintf(stderr,"ERROR: \"%s\" filter function %s reports %lu B chunk is smaller than its header\n",CCR_FLT_NAME,fnc_nm,(unsigned long)bfr_sz_in);
+      goto error;
+    } /* !bfr_sz_in */
+    ccr_lpk_hdr_get((const unsigned char *)(*bfr_inout),&vrs,&wdt,&elm_nbr,&ofs,&stp);
+    if(vrs != CCR_LPK_VRS){
+      (void)fprintf(stderr,"ERROR: \"%s\" filter function %s reports chunk header version = %d, expected %d\n",CCR_FLT_NAME,fnc_nm,vrs,CCR_LPK_VRS);
+      goto error;
+    } /* !vrs */
+    if((wdt == CCR_LPK_WDT_RAW && bfr_sz_in != CCR_LPK_HDR_SZ+elm_nbr*datum_size) ||
+       ((wdt == 8 || wdt == 16 || wdt == 32) && bfr_sz_in != CCR_LPK_HDR_SZ+elm_nbr*(wdt/8)) ||
+       (wdt == CCR_LPK_WDT_CNS && bfr_sz_in != CCR_LPK_HDR_SZ) ||
+       (wdt != CCR_LPK_WDT_RAW && wdt != CCR_LPK_WDT_CNS && wdt != 8 && wdt != 16 && wdt != 32)){
+      (void)fprintf(stderr,"ERROR: \"%s\" filter function %s reports %lu B chunk is inconsistent with header width = %d for %lu values\n",CCR_FLT_NAME,fnc_nm,(unsigned long)bfr_sz_in,wdt,(unsigned long)elm_nbr);
+      goto error;
+    } /* !wdt */
+
+    bfr_sz_new=elm_nbr*datum_size;
+    if(!(bfr_new=(unsigned char *)malloc(bfr_sz_new > 0 ? bfr_sz_new : 1))){
+      (void)fprintf(stderr,"ERROR: \"%s\" filter function %s unable to allocate %lu B for unpacked data\n",CCR_FLT_NAME,fnc_nm,(unsigned long)bfr_sz_new);
+      goto error;
+    } /* !bfr_new */
+    bfr_sz_alc=bfr_sz_new;
+
+    if(wdt == CCR_LPK_WDT_RAW){
+      memcpy(bfr_new,(unsigned char *)(*bfr_inout)+CCR_LPK_HDR_SZ,bfr_sz_new);
+    }else if(wdt == CCR_LPK_WDT_CNS){
+      size_t idx;
+      if(datum_size == sizeof(float)){
+	float *op1=(float *)bfr_new;
+	const float ofs_flt=(float)ofs;
+	for(idx=0;idx<elm_nbr;idx++) op1[idx]=ofs_flt;
+      }else{
+	double *op1=(double *)bfr_new;
+	for(idx=0;idx<elm_nbr;idx++) op1[idx]=ofs;
+      } /* !datum_size */
+    }else{
+      void *cd=(unsigned char *)(*bfr_inout)+CCR_LPK_HDR_SZ; /* [ptr] Codes */
+      cd_mss=(wdt == 32) ? 0xFFFFFFFFU : (1U << wdt)-1U;
+      if(ccr_lpk_is_big_endian()) ccr_lpk_bswap(elm_nbr,wdt,cd);
+      if(datum_size == sizeof(float)) ccr_lpk_dec_flt_knl(elm_nbr,wdt,cd,cd_mss,mss_val_flt,ofs,stp,(float *)bfr_new);
+      else ccr_lpk_dec_dbl_knl(elm_nbr,wdt,cd,cd_mss,mss_val_dbl,ofs,stp,(double *)bfr_new);
+    } /* !wdt */
+
+  }else{ /* !flags */
+
+    /* Pack */
+    size_t vld_nbr; /* [nbr] Number of valid (non-missing) values */
+    double min; /* [frc] Minimum valid value */
+    double max; /* [frc] Maximum valid value */
+    double stp_rcp=0.0; /* [frc] Reciprocal of step */
+    double cd_max_dbl; /* [nbr] Largest code of valid values */
+    unsigned int cd_max=0U; /* [nbr] Largest code of valid values */
+    int flg_nfn; /* [flg] Some valid value is infinite or NaN */
+
+    if(!(err > 0.0 && err < 1.0e300)){
+      (void)fprintf(stderr,"ERROR: \"%s\" filter function %s reports error bound = %g is invalid, must be positive and finite\n",CCR_FLT_NAME,fnc_nm,err);
+      goto error;
+    } /* !err */
+
+    elm_nbr=bfr_sz_in/datum_size;
+    if(datum_size == sizeof(float)){
+      float min_flt,max_flt;
+      vld_nbr=ccr_lpk_mnm_flt_knl(elm_nbr,(const float *)(*bfr_inout),mss_val_flt,&min_flt,&max_flt,&flg_nfn);
+      min=min_flt;
+      max=max_flt;
+    }else{
+      vld_nbr=ccr_lpk_mnm_dbl_knl(elm_nbr,(const double *)(*bfr_inout),mss_val_dbl,&min,&max,&flg_nfn);
+    } /* !datum_size */
+
+    /* Choose width */
+    if(vld_nbr == 0){
+      /* Every value is missing */
+      wdt=CCR_LPK_WDT_CNS;
+      ofs=mss_val_dbl;
+    }else if(flg_nfn){
+      wdt=CCR_LPK_WDT_RAW;
+    }else{
+      ofs=min;
+      stp=2.0*err;
+      stp_rcp=1.0/stp;
+      /* Same arithmetic as packing kernels, so the maximum packs to exactly cd_max */
+      cd_max_dbl=(max-ofs)*stp_rcp+0.5;
+      if(!(cd_max_dbl <= CCR_LPK_CD_MAX_DBL)){
+	wdt=CCR_LPK_WDT_RAW;
+      }else{
+	cd_max=(unsigned int)cd_max_dbl;
+	if(cd_max == 0U && vld_nbr == elm_nbr) wdt=CCR_LPK_WDT_CNS;
+	else if(cd_max < 0xFFU) wdt=8;
+	else if(cd_max < 0xFFFFU) wdt=16;
+	else wdt=32;
+	/* Packing that saves no space is not worth its error */
+	if(wdt != CCR_LPK_WDT_CNS && (size_t)(wdt/8) >= datum_size) wdt=CCR_LPK_WDT_RAW;
+      } /* !cd_max_dbl */
+    } /* !vld_nbr */
+    if(wdt == CCR_LPK_WDT_RAW){
+      ofs=0.0;
+      stp=0.0;
+    } /* !wdt */
+
+    if(CCR_FLT_DBG_INFO) (void)fprintf(stderr,"INFO: %s packs %lu values (%lu valid) with width = %d, offset = %g, step = %g\n",fnc_nm,(unsigned long)elm_nbr,(unsigned long)vld_nbr,wdt,ofs,stp);
+
+    /* Codes are built as 32-bit values then narrowed in place, so allocate room for 32-bit codes */
+    if(wdt == CCR_LPK_WDT_RAW) bfr_sz_new=CCR_LPK_HDR_SZ+elm_nbr*datum_size;
+    else if(wdt == CCR_LPK_WDT_CNS) bfr_sz_new=CCR_LPK_HDR_SZ;
+    else bfr_sz_new=CCR_LPK_HDR_SZ+elm_nbr*sizeof(unsigned int);
+    if(!(bfr_new=(unsigned char *)malloc(bfr_sz_new))){
+      (void)fprintf(stderr,"ERROR: \"%s\" filter function %s unable to allocate %lu B for packed data\n",CCR_FLT_NAME,fnc_nm,(unsigned long)bfr_sz_new);
+      goto error;
+    } /* !bfr_new */
+    bfr_sz_alc=bfr_sz_new;
+    ccr_lpk_hdr_put(bfr_new,wdt,elm_nbr,ofs,stp);
+
+    if(wdt == CCR_LPK_WDT_RAW){
+      memcpy(bfr_new+CCR_LPK_HDR_SZ,*bfr_inout,elm_nbr*datum_size);
+    }else if(wdt != CCR_LPK_WDT_CNS){
+      unsigned int *cd=(unsigned int *)(bfr_new+CCR_LPK_HDR_SZ); /* [ptr] Codes */
+      size_t idx;
+      cd_mss=(wdt == 32) ? 0xFFFFFFFFU : (1U << wdt)-1U;
+      if(datum_size == sizeof(float)) ccr_lpk_enc_flt_knl(elm_nbr,(const float *)(*bfr_inout),mss_val_flt,ofs,stp_rcp,cd_max,cd_mss,cd);
+      else ccr_lpk_enc_dbl_knl(elm_nbr,(const double *)(*bfr_inout),mss_val_dbl,ofs,stp_rcp,cd_max,cd_mss,cd);
+      /* Narrow in place: output value idx lies at or before input value idx */
+      if(wdt == 8){
+	unsigned char *cd8=(unsigned char *)cd;
+	for(idx=0;idx<elm_nbr;idx++) cd8[idx]=(unsigned char)cd[idx];
+      }else if(wdt == 16){
+	unsigned short *cd16=(unsigned short *)cd;
+	for(idx=0;idx<elm_nbr;idx++) cd16[idx]=(unsigned short)cd[idx];
+      } /* !wdt */
+      if(ccr_lpk_is_big_endian()) ccr_lpk_bswap(elm_nbr,wdt,cd);
+      bfr_sz_new=CCR_LPK_HDR_SZ+elm_nbr*(wdt/8);
+      /* Return tail left unused by narrow codes, keep whole buffer if realloc() fails */
+      if(bfr_sz_new < bfr_sz_alc){
+	unsigned char *bfr_fit; /* [ptr] Shrunk buffer */
+	if((bfr_fit=(unsigned char *)realloc(bfr_new,bfr_sz_new))){
+	  bfr_new=bfr_fit;
+	  bfr_sz_alc=bfr_sz_new;
+	} /* !bfr_fit */
+      } /* !bfr_sz_new */
+    } /* !wdt */
+
+  } /* !flags */
+
+  free(*bfr_inout);
+  *bfr_inout=bfr_new;
+  *bfr_sz_out=bfr_sz_alc;
+  return bfr_sz_new;
+
+ error:
+  if(bfr_new) free(bfr_new);
+  return 0;
+
+} /* !H5Z_filter_linearpack() */
+
+htri_t /* O [flg] Data meet criteria to apply filter */
+ccr_can_apply_linearpack /* [fnc] Callback to determine if current variable meets filter criteria */
+(hid_t dcpl, /* I [id] Dataset creation property list ID */
+ hid_t type, /* I [id] Dataset type ID */
+ hid_t space) /* I [id] Dataset space ID */
+{
+  /* Data space must be simple, i.e., a multi-dimensional array */
+  if(H5Sis_simple(space) <= 0){
+    fprintf(stderr,"WARNING: Cannot apply filter \"%s\" filter because data space is not simple.\n",CCR_FLT_NAME);
+    return 0;
+  } /* !H5Sis_simple(space) */
+
+  /* Filter can be applied */
+  return 1;
+} /* !ccr_can_apply_linearpack() */
+
+htri_t /* O [flg] Filter parameters successfully modified for this variable */
+ccr_set_local_linearpack /* [fnc] Callback to determine and set per-variable filter parameters */
+(hid_t dcpl, /* I [id] Dataset creation property list ID */
+ hid_t type, /* I [id] Dataset type ID */
+ hid_t space) /* I [id] Dataset space ID */
+{
+  const char fnc_nm[]="ccr_set_local_linearpack()"; /* [sng] Function name */
+
+  herr_t rcd; /* [flg] Return code */
+
+  /* Initialize filter parameters with default values */
+  unsigned int ccr_flt_prm[CCR_FLT_PRM_NBR]={0,0,0,0,0,0};
+
+  /* Initialize output variables for call to H5Pget_filter_by_id() */
+  unsigned int flags=0;
+  size_t cd_nelmts=CCR_FLT_PRM_NBR;
+  unsigned int *cd_values=ccr_flt_prm;
+
+  /* Retrieve parameters specified by user
+     https://support.hdfgroup.org/HDF5/doc/RM/RM_H5P.html#FunctionIndex
+     Ignore name and filter_config by setting last three arguments to 0/NULL */
+  rcd=H5Pget_filter_by_id(dcpl,H5Z_FILTER_LINEARPACK,&flags,&cd_nelmts,cd_values,0,NULL,NULL);
+  if(rcd < 0){
+    (void)fprintf(stderr,"ERROR: %s filter callback function %s reports H5Pget_filter_by_id() failed to get filter flags and parameters for current variable\n",CCR_FLT_NAME,fnc_nm);
+    return 0;
+  } /* !rcd */
+
+  /* Data class and datum size for this variable
+     Only float and double are packed, so remove filter from other types, as quantization filters do for integers */
+  H5T_class_t data_class; /* [enm] Data type class identifier (H5T_FLOAT, H5T_INT, H5T_STRING, ...) */
+  size_t datum_size; /* [B] Bytes per data value */
+  data_class=H5Tget_class(type);
+  if(data_class < 0){
+    (void)fprintf(stderr,"ERROR: %s filter callback function %s reports H5Tget_class() returned invalid data type class identifier = %d for current variable\n",CCR_FLT_NAME,fnc_nm,(int)data_class);
+    return 0;
+  } /* !data_class */
+  datum_size=H5Tget_size(type);
+  if(datum_size <= 0){
+    (void)fprintf(stderr,"ERROR: %s filter callback function %s reports H5Tget_size() returned invalid datum size = %lu B\n",CCR_FLT_NAME,fnc_nm,datum_size);
+    return 0;
+  } /* !datum_size */
+  if(data_class != H5T_FLOAT || (datum_size != sizeof(float) && datum_size != sizeof(double))){
+    if(CCR_FLT_DBG_INFO){
+      (void)fprintf(stdout,"INFO: \"%s\" filter callback function %s reports data type class identifier = %d, datum size = %lu B is not float or double. Attempting to remove filter using H5Premove_filter()...",CCR_FLT_NAME,fnc_nm,(int)data_class,datum_size);
+    } /* !CCR_FLT_DBG_INFO */
+    rcd=H5Premove_filter(dcpl,H5Z_FILTER_LINEARPACK);
+    if(rcd < 0){
+      if(CCR_FLT_DBG_INFO) (void)fprintf(stdout,"failure :(\n");
+      return 0;
+    } /* !rcd */
+    if(CCR_FLT_DBG_INFO) (void)fprintf(stdout,"success!\n");
+    return 1;
+  } /* !data_class */
+
+  /* Set datum size in filter parameter list */
+  ccr_flt_prm[CCR_FLT_PRM_PSN_DATUM_SIZE]=(unsigned int)datum_size;
+
+  /* Find, set, and pass per-variable has_mss_val and mss_val arguments
+     https://support.hdfgroup.org/HDF5/doc_resource/H5Fill_Values.html */
+  int has_mss_val=0; /* [flg] Flag for missing values */
+
+  H5D_fill_value_t status;
+  rcd=H5Pfill_value_defined(dcpl,&status);
+  if(rcd < 0){
+    (void)fprintf(stdout,"ERROR: \"%s\" filter callback function %s reports H5Pfill_value_defined() returns error code = %d\n",CCR_FLT_NAME,fnc_nm,rcd);
+    return 0;
+  } /* !rcd */
+
+  if(status == H5D_FILL_VALUE_USER_DEFINED){
+    double mss_val; /* [val] Value of missing value, large enough for either type */
+
+    has_mss_val=1;
+    rcd=H5Pget_fill_value(dcpl,type,&mss_val);
+    if(rcd < 0){
+      (void)fprintf(stdout,"ERROR: \"%s\" filter callback function %s reports H5Pget_fill_value() returns error code = %d\n",CCR_FLT_NAME,fnc_nm,rcd);
+      return 0;
+    } /* !rcd */
+
+    /* Set missing value in filter parameter list */
+    memcpy(cd_values+CCR_FLT_PRM_PSN_MSS_VAL,&mss_val,datum_size);
+  } /* !status */
+
+  /* Set missing value flag in filter parameter list */
+  ccr_flt_prm[CCR_FLT_PRM_PSN_HAS_MSS_VAL]=has_mss_val;
+
+  /* Update invoked filter with generic parameters as invoked with variable-specific values */
+  rcd=H5Pmodify_filter(dcpl,H5Z_FILTER_LINEARPACK,flags,CCR_FLT_PRM_NBR,cd_values);
+  if(rcd < 0){
+    (void)fprintf(stderr,"ERROR: \"%s\" filter callback function %s reports H5Pmodify_filter() unable to modify filter parameters\n",CCR_FLT_NAME,fnc_nm);
+    return 0;
+  } /* !rcd */
+
+  return 1;
+} /* !ccr_set_local_linearpack() */
+
+/* Scalar kernels define the results, SIMD kernels reproduce them bit-for-bit
+   Missing values compare equal to mss_val, NaNs never do, so NaNs count as valid and non-finite */
+
+static size_t /* O [nbr] Number of valid (non-missing) values */
+ccr_lpk_mnm_flt_scl /* [fnc] Minimum/maximum of single-precision values */
+(const size_t sz, /* I [nbr] Number of values */
+ const float *op1, /* I [frc] Values to scan */
+ const float mss_val, /* I [val] Missing value */
+ float *min, /* O [frc] Minimum valid value */
+ float *max, /* O [frc] Maximum valid value */
+ int *flg_nfn) /* O [flg] Some valid value is infinite or NaN */
+{
+  float min_crr=0.0f; /* [frc] Running minimum */
+  float max_crr=0.0f; /* [frc] Running maximum */
+  size_t vld_nbr=0; /* [nbr] Valid values */
+  size_t idx;
+
+  *flg_nfn=0;
+  for(idx=0;idx<sz;idx++){
+    const float val=op1[idx];
+    if(val == mss_val) continue;
+    if(!vld_nbr) min_crr=max_crr=val;
+    vld_nbr++;
+    /* Finite values differ from themselves by exactly zero */
+    if(!(val-val == 0.0f)) *flg_nfn=1;
+    if(val < min_crr) min_crr=val;
+    if(val > max_crr) max_crr=val;
+  } /* !idx */
+  *min=min_crr;
+  *max=max_crr;
+  return vld_nbr;
+} /* !ccr_lpk_mnm_flt_scl() */
+
+static size_t /* O [nbr] Number of valid (non-missing) values */
+ccr_lpk_mnm_dbl_scl /* [fnc] Minimum/maximum of double-precision values */
+(const size_t sz, /* I [nbr] Number of values */
+ const double *op1, /* I [frc] Values to scan */
+ const double mss_val, /* I [val] Missing value */
+ double *min, /* O [frc] Minimum valid value */
+ double *max, /* O [frc] Maximum valid value */
+ int *flg_nfn) /* O [flg] Some valid value is infinite or NaN */
+{
+  double min_crr=0.0; /* [frc] Running minimum */
+  double max_crr=0.0; /* [frc] Running maximum */
+  size_t vld_nbr=0; /* [nbr] Valid values */
+  size_t idx;
+
+  *flg_nfn=0;
+  for(idx=0;idx<sz;idx++){
+    const double val=op1[idx];
+    if(val == mss_val) continue;
+    if(!vld_nbr) min_crr=max_crr=val;
+    vld_nbr++;
+    if(!(val-val == 0.0)) *flg_nfn=1;
+    if(val < min_crr) min_crr=val;
+    if(val > max_crr) max_crr=val;
+  } /* !idx */
+  *min=min_crr;
+  *max=max_crr;
+  return vld_nbr;
+} /* !ccr_lpk_mnm_dbl_scl() */
+
+static void
+ccr_lpk_enc_flt_scl /* [fnc] Pack single-precision values */
+(const size_t sz, /* I [nbr] Number of values */
+ const float *op1, /* I [frc] Values to pack */
+ const float mss_val, /* I [val] Missing value */
+ const double ofs, /* I [frc] Offset */
+ const double stp_rcp, /* I [frc] Reciprocal of step */
+ const unsigned int cd_max, /* I [nbr] Largest code of valid values */
+ const unsigned int cd_mss, /* I [nbr] Code of missing value */
+ unsigned int *cd) /* O [nbr] Codes */
+{
+  const double cd_max_dbl=(double)cd_max; /* [nbr] Largest code of valid values */
+  size_t idx;
+
+  for(idx=0;idx<sz;idx++){
+    double val=((double)op1[idx]-ofs)*stp_rcp+0.5;
+    /* Truncation of clamped non-negative value rounds half up */
+    if(val < 0.0) val=0.0; else if(val > cd_max_dbl) val=cd_max_dbl;
+    cd[idx]=(op1[idx] == mss_val) ? cd_mss : (unsigned int)val;
+  } /* !idx */
+} /* !ccr_lpk_enc_flt_scl() */
+
+static void
+ccr_lpk_enc_dbl_scl /* [fnc] Pack double-precision values */
+(const size_t sz, /* I [nbr] Number of values */
+ const double *op1, /* I [frc] Values to pack */
+ const double mss_val, /* I [val] Missing value */
+ const double ofs, /* I [frc] Offset */
+ const double stp_rcp, /* I [frc] Reciprocal of step */
+ const unsigned int cd_max, /* I [nbr] Largest code of valid values */
+ const unsigned int cd_mss, /* I [nbr] Code of missing value */
+ unsigned int *cd) /* O [nbr] Codes */
+{
+  const double cd_max_dbl=(double)cd_max; /* [nbr] Largest code of valid values */
+  size_t idx;
+
+  for(idx=0;idx<sz;idx++){
+    double val=(op1[idx]-ofs)*stp_rcp+0.5;
+    if(val < 0.0) val=0.0; else if(val > cd_max_dbl) val=cd_max_dbl;
+    cd[idx]=(op1[idx] == mss_val) ? cd_mss : (unsigned int)val;
+  } /* !idx */
+} /* !ccr_lpk_enc_dbl_scl() */
+
+static unsigned int /* O [nbr] Code */
+ccr_lpk_cd_get /* [fnc] Read one code of given width */
+(const void *cd, /* I [nbr] Codes */
+ const int wdt, /* I [nbr] Packed width in bits (8, 16, or 32) */
+ const size_t idx) /* I [idx] Index of code */
+{
+  if(wdt == 8) return ((const unsigned char *)cd)[idx];
+  if(wdt == 16) return ((const unsigned short *)cd)[idx];
+  return ((const unsigned int *)cd)[idx];
+} /* !ccr_lpk_cd_get() */
+
+static void
+ccr_lpk_dec_flt_scl /* [fnc] Unpack single-precision values */
+(const size_t sz, /* I [nbr] Number of values */
+ const int wdt, /* I [nbr] Packed width in bits (8, 16, or 32) */
+ const void *cd, /* I [nbr] Codes in host byte order */
+ const unsigned int cd_mss, /* I [nbr] Code of missing value */
+ const float mss_val, /* I [val] Missing value */
+ const double ofs, /* I [frc] Offset */
+ const double stp, /* I [frc] Step */
+ float *op1) /* O [frc] Unpacked values */
+{
+  size_t idx;
+
+  for(idx=0;idx<sz;idx++){
+    const unsigned int cd_crr=ccr_lpk_cd_get(cd,wdt,idx);
+    op1[idx]=(cd_crr == cd_mss) ? mss_val : (float)(ofs+(double)cd_crr*stp);
+  } /* !idx */
+} /* !ccr_lpk_dec_flt_scl() */
+
+static void
+ccr_lpk_dec_dbl_scl /* [fnc] Unpack double-precision values */
+(const size_t sz, /* I [nbr] Number of values */
+ const int wdt, /* I [nbr] Packed width in bits (8, 16, or 32) */
+ const void *cd, /* I [nbr] Codes in host byte order */
+ const unsigned int cd_mss, /* I [nbr] Code of missing value */
+ const double mss_val, /* I [val] Missing value */
+ const double ofs, /* I [frc] Offset */
+ const double stp, /* I [frc] Step */
+ double *op1) /* O [frc] Unpacked values */
+{
+  size_t idx;
+
+  for(idx=0;idx<sz;idx++){
+    const unsigned int cd_crr=ccr_lpk_cd_get(cd,wdt,idx);
+    op1[idx]=(cd_crr == cd_mss) ? mss_val : ofs+(double)cd_crr*stp;
+  } /* !idx */
+} /* !ccr_lpk_dec_dbl_scl() */
+
+#ifdef CCR_SIMD_X86
+/* Vector kernels compute codes in double precision four lanes at a time, with separate multiply and add (no FMA) to match scalar kernels exactly
+   Codes reach 2^32-2, beyond signed 32-bit conversions, so conversions are biased by 2^31
+   Remainders go to scalar kernels */
+
+__attribute__((target("avx2")))
+static size_t /* O [nbr] Number of valid (non-missing) values */
+ccr_lpk_mnm_flt_avx2 /* [fnc] Minimum/maximum of single-precision values with AVX2 */
+(const size_t sz, /* I [nbr] Number of values */
+ const float *op1, /* I [frc] Values to scan */
+ const float mss_val, /* I [val] Missing value */
+ float *min, /* O [frc] Minimum valid value */
+ float *max, /* O [frc] Maximum valid value */
+ int *flg_nfn) /* O [flg] Some valid value is infinite or NaN */
+{
+  const __m256 mss_val_vct=_mm256_set1_ps(mss_val);
+  const __m256 inf_vct=_mm256_set1_ps(__builtin_inff());
+  const __m256 ninf_vct=_mm256_set1_ps(-__builtin_inff());
+  __m256 min_vct=inf_vct;
+  __m256 max_vct=ninf_vct;
+  __m256 nfn_vct=_mm256_setzero_ps();
+  float min_lne[8],max_lne[8]; /* [frc] Per-lane extrema */
+  float min_tl,max_tl; /* [frc] Extrema of remainder */
+  int nfn_tl; /* [flg] Remainder has non-finite value */
+  size_t vld_nbr=0; /* [nbr] Valid values */
+  size_t vld_tl; /* [nbr] Valid values in remainder */
+  size_t idx;
+  int lne;
+
+  for(idx=0;idx+8<=sz;idx+=8){
+    const __m256 val_vct=_mm256_loadu_ps(op1+idx);
+    const __m256 vld_vct=_mm256_cmp_ps(val_vct,mss_val_vct,_CMP_NEQ_UQ);
+    const __m256 dff_vct=_mm256_sub_ps(val_vct,val_vct);
+    vld_nbr+=(size_t)__builtin_popcount(_mm256_movemask_ps(vld_vct));
+    /* Non-finite lanes give NaN differences, which compare unordered */
+    nfn_vct=_mm256_or_ps(nfn_vct,_mm256_and_ps(vld_vct,_mm256_cmp_ps(dff_vct,dff_vct,_CMP_UNORD_Q)));
+    min_vct=_mm256_min_ps(min_vct,_mm256_blendv_ps(inf_vct,val_vct,vld_vct));
+    max_vct=_mm256_max_ps(max_vct,_mm256_blendv_ps(ninf_vct,val_vct,vld_vct));
+  } /* !idx */
+  _mm256_storeu_ps(min_lne,min_vct);
+  _mm256_storeu_ps(max_lne,max_vct);
+  *flg_nfn=_mm256_movemask_ps(nfn_vct) != 0;
+  *min=min_lne[0];
+  *max=max_lne[0];
+  for(lne=1;lne<8;lne++){
+    if(min_lne[lne] < *min) *min=min_lne[lne];
+    if(max_lne[lne] > *max) *max=max_lne[lne];
+  } /* !lne */
+  vld_tl=ccr_lpk_mnm_flt_scl(sz-idx,op1+idx,mss_val,&min_tl,&max_tl,&nfn_tl);
+  if(vld_tl){
+    if(!vld_nbr || min_tl < *min) *min=min_tl;
+    if(!vld_nbr || max_tl > *max) *max=max_tl;
+    *flg_nfn|=nfn_tl;
+  } /* !vld_tl */
+  return vld_nbr+vld_tl;
+} /* !ccr_lpk_mnm_flt_avx2() */
+
+__attribute__((target("avx2")))
+static size_t /* O [nbr] Number of valid (non-missing) values */
+ccr_lpk_mnm_dbl_avx2 /* [fnc] Minimum/maximum of double-precision values with AVX2 */
+(const size_t sz, /* I [nbr] Number of values */
+ const double *op1, /* I [frc] Values to scan */
+ const double mss_val, /* I [val] Missing value */
+ double *min, /* O [frc] Minimum valid value */
+ double *max, /* O [frc] Maximum valid value */
+ int *flg_nfn) /* O [flg] Some valid value is infinite or NaN */
+{
+  const __m256d mss_val_vct=_mm256_set1_pd(mss_val);
+  const __m256d inf_vct=_mm256_set1_pd(__builtin_inf());
+  const __m256d ninf_vct=_mm256_set1_pd(-__builtin_inf());
+  __m256d min_vct=inf_vct;
+  __m256d max_vct=ninf_vct;
+  __m256d nfn_vct=_mm256_setzero_pd();
+  double min_lne[4],max_lne[4]; /* [frc] Per-lane extrema */
+  double min_tl,max_tl; /* [frc] Extrema of remainder */
+  int nfn_tl; /* [flg] Remainder has non-finite value */
+  size_t vld_nbr=0; /* [nbr] Valid values */
+  size_t vld_tl; /* [nbr] Valid values in remainder */
+  size_t idx;
+  int lne;
+
+  for(idx=0;idx+4<=sz;idx+=4){
+    const __m256d val_vct=_mm256_loadu_pd(op1+idx);
+    const __m256d vld_vct=_mm256_cmp_pd(val_vct,mss_val_vct,_CMP_NEQ_UQ);
+    const __m256d dff_vct=_mm256_sub_pd(val_vct,val_vct);
+    vld_nbr+=(size_t)__builtin_popcount(_mm256_movemask_pd(vld_vct));
+    nfn_vct=_mm256_or_pd(nfn_vct,_mm256_and_pd(vld_vct,_mm256_cmp_pd(dff_vct,dff_vct,_CMP_UNORD_Q)));
+    min_vct=_mm256_min_pd(min_vct,_mm256_blendv_pd(inf_vct,val_vct,vld_vct));
+    max_vct=_mm256_max_pd(max_vct,_mm256_blendv_pd(ninf_vct,val_vct,vld_vct));
+  } /* !idx */
+  _mm256_storeu_pd(min_lne,min_vct);
+  _mm256_storeu_pd(max_lne,max_vct);
+  *flg_nfn=_mm256_movemask_pd(nfn_vct) != 0;
+  *min=min_lne[0];
+  *max=max_lne[0];
+  for(lne=1;lne<4;lne++){
+    if(min_lne[lne] < *min) *min=min_lne[lne];
+    if(max_lne[lne] > *max) *max=max_lne[lne];
+  } /* !lne */
+  vld_tl=ccr_lpk_mnm_dbl_scl(sz-idx,op1+idx,mss_val,&min_tl,&max_tl,&nfn_tl);
+  if(vld_tl){
+    if(!vld_nbr || min_tl < *min) *min=min_tl;
+    if(!vld_nbr || max_tl > *max) *max=max_tl;
+    *flg_nfn|=nfn_tl;
+  } /* !vld_tl */
+  return vld_nbr+vld_tl;
+} /* !ccr_lpk_mnm_dbl_avx2() */
+
+__attribute__((target("avx2")))
+static inline __m128i /* O [nbr] Four codes */
+ccr_lpk_cd_avx2 /* [fnc] Convert four biased values to codes with AVX2 */
+(const __m256d val_vct, /* I [frc] Values, i.e., (op1-ofs)*stp_rcp+0.5 */
+ const __m256d cd_max_vct) /* I [nbr] Largest code of valid values */
+{
+  const __m256d bias_vct=_mm256_set1_pd(2147483648.0);
+  __m256d cd_vct;
+
+  /* Clamp, then floor, which equals scalar truncation for non-negative values */
+  cd_vct=_mm256_min_pd(_mm256_max_pd(val_vct,_mm256_setzero_pd()),cd_max_vct);
+  cd_vct=_mm256_floor_pd(cd_vct);
+  return _mm_xor_si128(_mm256_cvttpd_epi32(_mm256_sub_pd(cd_vct,bias_vct)),_mm_set1_epi32((int)0x80000000U));
+} /* !ccr_lpk_cd_avx2() */
+
+__attribute__((target("avx2")))
+static void
+ccr_lpk_enc_flt_avx2 /* [fnc] Pack single-precision values with AVX2 */
+(const size_t sz, /* I [nbr] Number of values */
+ const float *op1, /* I [frc] Values to pack */
+ const float mss_val, /* I [val] Missing value */
+ const double ofs, /* I [frc] Offset */
+ const double stp_rcp, /* I [frc] Reciprocal of step */
+ const unsigned int cd_max, /* I [nbr] Largest code of valid values */
+ const unsigned int cd_mss, /* I [nbr] Code of missing value */
+ unsigned int *cd) /* O [nbr] Codes */
+{
+  const __m256 mss_val_vct=_mm256_set1_ps(mss_val);
+  const __m256d ofs_vct=_mm256_set1_pd(ofs);
+  const __m256d stp_rcp_vct=_mm256_set1_pd(stp_rcp);
+  const __m256d hlf_vct=_mm256_set1_pd(0.5);
+  const __m256d cd_max_vct=_mm256_set1_pd((double)cd_max);
+  const __m256i cd_mss_vct=_mm256_set1_epi32((int)cd_mss);
+  size_t idx;
+
+  for(idx=0;idx+8<=sz;idx+=8){
+    const __m256 val_vct=_mm256_loadu_ps(op1+idx);
+    const __m256d lo_vct=_mm256_cvtps_pd(_mm256_castps256_ps128(val_vct));
+    const __m256d hi_vct=_mm256_cvtps_pd(_mm256_extractf128_ps(val_vct,1));
+    const __m128i cd_lo=ccr_lpk_cd_avx2(_mm256_add_pd(_mm256_mul_pd(_mm256_sub_pd(lo_vct,ofs_vct),stp_rcp_vct),hlf_vct),cd_max_vct);
+    const __m128i cd_hi=ccr_lpk_cd_avx2(_mm256_add_pd(_mm256_mul_pd(_mm256_sub_pd(hi_vct,ofs_vct),stp_rcp_vct),hlf_vct),cd_max_vct);
+    const __m256i cd_vct=_mm256_inserti128_si256(_mm256_castsi128_si256(cd_lo),cd_hi,1);
+    const __m256i mss_vct=_mm256_castps_si256(_mm256_cmp_ps(val_vct,mss_val_vct,_CMP_EQ_OQ));
+    _mm256_storeu_si256((__m256i *)(cd+idx),_mm256_blendv_epi8(cd_vct,cd_mss_vct,mss_vct));
+  } /* !idx */
+  ccr_lpk_enc_flt_scl(sz-idx,op1+idx,mss_val,ofs,stp_rcp,cd_max,cd_mss,cd+idx);
+} /* !ccr_lpk_enc_flt_avx2() */
+
+__attribute__((target("avx2")))
+static void
+ccr_lpk_enc_dbl_avx2 /* [fnc] Pack double-precision values with AVX2 */
+(const size_t sz, /* I [nbr] Number of values */
+ const double *op1, /* I [frc] Values to pack */
+ const double mss_val, /* I [val] Missing value */
+ const double ofs, /* I [frc] Offset */
+ const double stp_rcp, /* I [frc] Reciprocal of step */
+ const unsigned int cd_max, /* I [nbr] Largest code of valid values */
+ const unsigned int cd_mss, /* I [nbr] Code of missing value */
+ unsigned int *cd) /* O [nbr] Codes */
+{
+  const __m256d mss_val_vct=_mm256_set1_pd(mss_val);
+  const __m256d ofs_vct=_mm256_set1_pd(ofs);
+  const __m256d stp_rcp_vct=_mm256_set1_pd(stp_rcp);
+  const __m256d hlf_vct=_mm256_set1_pd(0.5);
+  const __m256d cd_max_vct=_mm256_set1_pd((double)cd_max);
+  const __m128i cd_mss_vct=_mm_set1_epi32((int)cd_mss);
+  size_t idx;
+
+  for(idx=0;idx+4<=sz;idx+=4){
+    const __m256d val_vct=_mm256_loadu_pd(op1+idx);
+    const __m128i cd_vct=ccr_lpk_cd_avx2(_mm256_add_pd(_mm256_mul_pd(_mm256_sub_pd(val_vct,ofs_vct),stp_rcp_vct),hlf_vct),cd_max_vct);
+    /* Narrow 64-bit comparison lanes to 32 bits: odd 32-bit halves duplicate even ones */
+    const __m256i mss_64=_mm256_castpd_si256(_mm256_cmp_pd(val_vct,mss_val_vct,_CMP_EQ_OQ));
+    const __m128i mss_vct=_mm256_castsi256_si128(_mm256_permutevar8x32_epi32(mss_64,_mm256_setr_epi32(0,2,4,6,0,2,4,6)));
+    _mm_storeu_si128((__m128i *)(cd+idx),_mm_blendv_epi8(cd_vct,cd_mss_vct,mss_vct));
+  } /* !idx */
+  ccr_lpk_enc_dbl_scl(sz-idx,op1+idx,mss_val,ofs,stp_rcp,cd_max,cd_mss,cd+idx);
+} /* !ccr_lpk_enc_dbl_avx2() */
+
+__attribute__((target("avx2")))
+static inline __m256i /* O [nbr] Eight codes widened to 32 bits */
+ccr_lpk_cd_ld_avx2 /* [fnc] Load eight codes of given width with AVX2 */
+(const void *cd, /* I [nbr] Codes */
+ const int wdt, /* I [nbr] Packed width in bits (8, 16, or 32) */
+ const size_t idx) /* I [idx] Index of first code */
+{
+  if(wdt == 8) return _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i *)((const unsigned char *)cd+idx)));
+  if(wdt == 16) return _mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i *)((const unsigned short *)cd+idx)));
+  return _mm256_loadu_si256((const __m256i *)((const unsigned int *)cd+idx));
+} /* !ccr_lpk_cd_ld_avx2() */
+
+__attribute__((target("avx2")))
+static inline __m256d /* O [frc] Four unpacked values */
+ccr_lpk_val_avx2 /* [fnc] Convert four codes to values with AVX2 */
+(const __m128i cd_vct, /* I [nbr] Codes */
+ const __m256d ofs_vct, /* I [frc] Offset */
+ const __m256d stp_vct) /* I [frc] Step */
+{
+  const __m256d bias_vct=_mm256_set1_pd(2147483648.0);
+  const __m256d cd_dbl=_mm256_add_pd(_mm256_cvtepi32_pd(_mm_xor_si128(cd_vct,_mm_set1_epi32((int)0x80000000U))),bias_vct);
+  return _mm256_add_pd(ofs_vct,_mm256_mul_pd(cd_dbl,stp_vct));
+} /* !ccr_lpk_val_avx2() */
+
+__attribute__((target("avx2")))
+static void
+ccr_lpk_dec_flt_avx2 /* [fnc] Unpack single-precision values with AVX2 */
+(const size_t sz, /* I [nbr] Number of values */
+ const int wdt, /* I [nbr] Packed width in bits (8, 16, or 32) */
+ const void *cd, /* I [nbr] Codes in host byte order */
+ const unsigned int cd_mss, /* I [nbr] Code of missing value */
+ const float mss_val, /* I [val] Missing value */
+ const double ofs, /* I [frc] Offset */
+ const double stp, /* I [frc] Step */
+ float *op1) /* O [frc] Unpacked values */
+{
+  const __m256 mss_val_vct=_mm256_set1_ps(mss_val);
+  const __m256d ofs_vct=_mm256_set1_pd(ofs);
+  const __m256d stp_vct=_mm256_set1_pd(stp);
+  const __m256i cd_mss_vct=_mm256_set1_epi32((int)cd_mss);
+  size_t idx;
+
+  for(idx=0;idx+8<=sz;idx+=8){
+    const __m256i cd_vct=ccr_lpk_cd_ld_avx2(cd,wdt,idx);
+    const __m128 lo_vct=_mm256_cvtpd_ps(ccr_lpk_val_avx2(_mm256_castsi256_si128(cd_vct),ofs_vct,stp_vct));
+    const __m128 hi_vct=_mm256_cvtpd_ps(ccr_lpk_val_avx2(_mm256_extracti128_si256(cd_vct,1),ofs_vct,stp_vct));
+    const __m256 val_vct=_mm256_insertf128_ps(_mm256_castps128_ps256(lo_vct),hi_vct,1);
+    const __m256 mss_vct=_mm256_castsi256_ps(_mm256_cmpeq_epi32(cd_vct,cd_mss_vct));
+    _mm256_storeu_ps(op1+idx,_mm256_blendv_ps(val_vct,mss_val_vct,mss_vct));
+  } /* !idx */
+  if(idx < sz){
+    /* Remainder codes start at element idx, whatever the width */
+    const void *cd_tl=(const unsigned char *)cd+idx*(wdt/8);
+    ccr_lpk_dec_flt_scl(sz-idx,wdt,cd_tl,cd_mss,mss_val,ofs,stp,op1+idx);
+  } /* !idx */
+} /* !ccr_lpk_dec_flt_avx2() */
+
+__attribute__((target("avx2")))
+static void
+ccr_lpk_dec_dbl_avx2 /* [fnc] Unpack double-precision values with AVX2 */
+(const size_t sz, /* I [nbr] Number of values */
+ const int wdt, /* I [nbr] Packed width in bits (8, 16, or 32) */
+ const void *cd, /* I [nbr] Codes in host byte order */
+ const unsigned int cd_mss, /* I [nbr] Code of missing value */
+ const double mss_val, /* I [val] Missing value */
+ const double ofs, /* I [frc] Offset */
+ const double stp, /* I [frc] Step */
+ double *op1) /* O [frc] Unpacked values */
+{
+  const __m256d mss_val_vct=_mm256_set1_pd(mss_val);
+  const __m256d ofs_vct=_mm256_set1_pd(ofs);
+  const __m256d stp_vct=_mm256_set1_pd(stp);
+  const __m256i cd_mss_vct=_mm256_set1_epi32((int)cd_mss);
+  size_t idx;
+
+  for(idx=0;idx+8<=sz;idx+=8){
+    const __m256i cd_vct=ccr_lpk_cd_ld_avx2(cd,wdt,idx);
+    const __m256i mss_vct=_mm256_cmpeq_epi32(cd_vct,cd_mss_vct);
+    const __m256d lo_vct=ccr_lpk_val_avx2(_mm256_castsi256_si128(cd_vct),ofs_vct,stp_vct);
+    const __m256d hi_vct=ccr_lpk_val_avx2(_mm256_extracti128_si256(cd_vct,1),ofs_vct,stp_vct);
+    /* Widen 32-bit comparison lanes to 64 bits by sign extension */
+    const __m256d mss_lo=_mm256_castsi256_pd(_mm256_cvtepi32_epi64(_mm256_castsi256_si128(mss_vct)));
+    const __m256d mss_hi=_mm256_castsi256_pd(_mm256_cvtepi32_epi64(_mm256_extracti128_si256(mss_vct,1)));
+    _mm256_storeu_pd(op1+idx,_mm256_blendv_pd(lo_vct,mss_val_vct,mss_lo));
+    _mm256_storeu_pd(op1+idx+4,_mm256_blendv_pd(hi_vct,mss_val_vct,mss_hi));
+  } /* !idx */
+  if(idx < sz){
+    const void *cd_tl=(const unsigned char *)cd+idx*(wdt/8);
+    ccr_lpk_dec_dbl_scl(sz-idx,wdt,cd_tl,cd_mss,mss_val,ofs,stp,op1+idx);
+  } /* !idx */
+} /* !ccr_lpk_dec_dbl_avx2() */
+#endif /* !CCR_SIMD_X86 */
+
+void
+ccr_lpk_cpu_dispatch /* [fnc] Select fastest packing kernels supported by this CPU */
+(void)
+{
+  /* Purpose: Query CPUID (through compiler builtins that also check OS register-state support) and point kernels at widest supported instruction set
+     Results are identical for all kernels, only speed differs */
+  ccr_lpk_mnm_flt_knl=ccr_lpk_mnm_flt_scl;
+  ccr_lpk_mnm_dbl_knl=ccr_lpk_mnm_dbl_scl;
+  ccr_lpk_enc_flt_knl=ccr_lpk_enc_flt_scl;
+  ccr_lpk_enc_dbl_knl=ccr_lpk_enc_dbl_scl;
+  ccr_lpk_dec_flt_knl=ccr_lpk_dec_flt_scl;
+  ccr_lpk_dec_dbl_knl=ccr_lpk_dec_dbl_scl;
+  ccr_lpk_knl_nm="scalar";
+#ifdef CCR_SIMD_X86
+  __builtin_cpu_init();
+  if(__builtin_cpu_supports("avx2")){
+    ccr_lpk_mnm_flt_knl=ccr_lpk_mnm_flt_avx2;
+    ccr_lpk_mnm_dbl_knl=ccr_lpk_mnm_dbl_avx2;
+    ccr_lpk_enc_flt_knl=ccr_lpk_enc_flt_avx2;
+    ccr_lpk_enc_dbl_knl=ccr_lpk_enc_dbl_avx2;
+    ccr_lpk_dec_flt_knl=ccr_lpk_dec_flt_avx2;
+    ccr_lpk_dec_dbl_knl=ccr_lpk_dec_dbl_avx2;
+    ccr_lpk_knl_nm="AVX2";
+  } /* !__builtin_cpu_supports() */
+#endif /* !CCR_SIMD_X86 */
+  if(CCR_FLT_DBG_INFO) (void)fprintf(stderr,"INFO: \"%s\" filter selected %s kernels\n",CCR_FLT_NAME,ccr_lpk_knl_nm);
+} /* !ccr_lpk_cpu_dispatch() */
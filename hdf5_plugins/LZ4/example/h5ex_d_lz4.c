@@ -49,7 +49,7 @@ main (void)
     size_t          nelmts = 1;                /* number of elements in cd_values */
     unsigned int    flags;
     unsigned        filter_config;
-    const unsigned int    cd_values[1] = {3};     /* lz4 default is 3 */
+    const unsigned int    cd_values[1] = {0};     /* block size, 0 for default */
     unsigned int    values_out[1] = {99};
     int             wdata[DIM0][DIM1],          /* Write buffer */
                     rdata[DIM0][DIM1],          /* Read buffer */
@@ -43,10 +43,22 @@
 
 #if defined(_WIN32)
 #include <Winsock2.h>
+#else
+#include <arpa/inet.h>
 #endif
 
 #include "H5PLextern.h"
 #include "lz4.h"
+/* OpenMP compresses and decompresses the blocks of a chunk on a
+ * thread pool (opt-in, see H5Z_lz4_thread_count()). */
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+/* LZ4HC with caller-allocated state needs lz4 1.7.0 or later. */
+#if defined(HAVE_LZ4HC_H) && LZ4_VERSION_NUMBER >= 10700
+#include "lz4hc.h"
+#define USE_LZ4HC 1
+#endif
 
 size_t H5Z_filter_lz4(unsigned int flags, size_t cd_nelmts,
                       const unsigned int cd_values[], size_t nbytes,
@@ -64,8 +76,22 @@ size_t H5Z_filter_lz4(unsigned int flags, size_t cd_nelmts,
 #define be32toht(x) ntohl(x)
 #define be64toht(x) ntohll(x)
 
+/* Filter parameters, all optional. Other HDF5 LZ4 filters only read
+ * the block size, and decode any block written with acceleration or
+ * with LZ4HC, since both produce ordinary LZ4 blocks. */
+#define PARAM_BLOCK_SIZE 0   /* block size in bytes, 0 for default */
+#define PARAM_ACCELERATION 1 /* LZ4 acceleration, 0 or 1 for default */
+#define PARAM_HC_LEVEL 2     /* LZ4HC level, 0 for fast LZ4 */
+
+/* LZ4 only looks back 64 kB for matches, so blocks much larger than
+ * that gain little ratio. 256 kB blocks stay in L2 cache and give
+ * threads enough blocks to share in chunks of a few MB. */
+#define DEFAULT_BLOCK_SIZE (1<<18)
+#define MAX_BLOCK_SIZE 0x7E000000  /* LZ4_MAX_INPUT_SIZE */
+#define MAX_ACCELERATION 65537     /* LZ4 clamps larger values */
+#define MAX_HC_LEVEL 12            /* LZ4HC_CLEVEL_MAX */
 
-#define DEFAULT_BLOCK_SIZE 1<<30; /* 1GB. LZ4 needs blocks < 1.9GB. */
+#define THREAD_COUNT_ENV "CCR_THR_NBR" /* number of threads, default 1 */
 
 const H5Z_class2_t H5Z_LZ4[1] = {{
         H5Z_CLASS_T_VERS,       /* H5Z_class_t version */
@@ -86,22 +112,137 @@ const H5Z_class2_t H5Z_LZ4[1] = {{
 H5PL_type_t   H5PLget_plugin_type(void) {return H5PL_TYPE_FILTER;}
 const void *H5PLget_plugin_info(void) {return H5Z_LZ4;}
 
+/* Number of threads to work on nBlocks blocks with. Threading is
+ * opt-in, as for the CCR quantization filters: set CCR_THR_NBR to the
+ * number of threads, or to 0 for one per processor. */
+static int H5Z_lz4_thread_count(size_t nBlocks)
+{
+#ifdef _OPENMP
+    const char *threadString;
+    char *end = NULL;
+    long threads;
+
+    if (nBlocks < 2)
+        return 1;
+    threadString = getenv(THREAD_COUNT_ENV);
+    if (!threadString || *threadString == '\0')
+        return 1;
+    threads = strtol(threadString, &end, 10);
+    if (*end != '\0' || threads < 0)
+    {
+        printf("lz4 filter ignores invalid %s = %s\n", THREAD_COUNT_ENV, threadString);
+        return 1;
+    }
+    if (threads == 0)
+        threads = omp_get_num_procs();
+    /* threads beyond one per block would idle */
+    if ((size_t)threads > nBlocks)
+        threads = (long)nBlocks;
+    return (int)threads;
+#else
+    (void)nBlocks;
+    return 1;
+#endif
+}
+
+/* Compress one block of size bytes into dst, which has room for size
+ * bytes. Returns the number of bytes written to dst, which is size
+ * when the block is stored raw. */
+static int H5Z_lz4_compress_block(const char *src, char *dst, int size,
+                                  int acceleration, void *hcState, int hcLevel)
+{
+    int compSize;
+
+    /* Room for one byte less than the block, so LZ4 gives up
+     * (returns 0) as soon as compression cannot save space. */
+#if LZ4_VERSION_NUMBER >= 10700
+#ifdef USE_LZ4HC
+    if(hcLevel > 0)
+        compSize = LZ4_compress_HC_extStateHC(hcState, src, dst, size, size-1, hcLevel);
+    else
+#endif
+    compSize = LZ4_compress_fast(src, dst, size, size-1, acceleration);
+#else
+    compSize = LZ4_compress_limitedOutput(src, dst, size, size-1);
+#endif
+#ifndef USE_LZ4HC
+    (void)hcState;
+    (void)hcLevel;
+#endif
+#if LZ4_VERSION_NUMBER < 10700
+    (void)acceleration;
+#endif
+    if(compSize <= 0) /* compression did not save any space, do a memcpy instead */
+    {
+        compSize = size;
+        memcpy(dst, src, size);
+    }
+    return compSize;
+}
+
+/* Decompress one block of compSize bytes into exactly size bytes at
+ * dst. Returns 0 on success. */
+static int H5Z_lz4_decompress_block(const char *src, char *dst,
+                                    uint32_t compSize, uint32_t size)
+{
+    if(compSize == size) /* there was no compression */
+    {
+        memcpy(dst, src, size);
+    }
+    else /* do the decompression */
+    {
+#if LZ4_VERSION_NUMBER > 10300
+        /* Blocks are compressed independently, so each is decoded
+         * with its exact compressed size into room for exactly size
+         * bytes. */
+        int decompressedBytes = LZ4_decompress_safe(src, dst, (int)compSize, (int)size);
+        if(decompressedBytes != (int)size)
+        {
+            printf("decompressed size not the same: %d, != %u\n", decompressedBytes, size);
+            return -1;
+        }
+#else
+        int compressedBytes = LZ4_uncompress(src, dst, size);
+        if(compressedBytes != (int)compSize)
+        {
+            printf("decompressed size not the same: %d, != %u\n", compressedBytes, compSize);
+            return -1;
+        }
+#endif
+    }
+    return 0;
+}
+
 size_t H5Z_filter_lz4(unsigned int flags, size_t cd_nelmts,
         const unsigned int cd_values[], size_t nbytes,
         size_t *buf_size, void **buf)
 {
     void * outBuf = NULL;
+    uint32_t *compSizes = NULL;      /* compressed size of each block */
+    const char **blockStarts = NULL; /* compressed data of each block */
+    void **hcStates = NULL;          /* LZ4HC state of each thread, reused for its blocks */
+    int threads = 1;
+    int thread;
     size_t ret_value;
 
     if (flags & H5Z_FLAG_REVERSE)
     {
         uint32_t *i32Buf;
         uint32_t blockSize;
-        char *roBuf;   /* pointer to current write position */
-        uint64_t decompSize;
         const char* rpos = (char*)*buf; /* pointer to current read position */
+        const char* const rend = rpos + nbytes; /* end of compressed data */
         const uint64_t * const i64Buf = (uint64_t *) rpos;
-        const uint64_t origSize = (uint64_t)(be64toht(*i64Buf));/* is saved in be format */
+        uint64_t origSize;
+        uint64_t nBlocks;
+        long block;
+        int badBlocks = 0;
+
+        if (nbytes < 12)
+        {
+            printf("lz4 chunk of %lu bytes is smaller than its header\n", (unsigned long)nbytes);
+            goto error;
+        }
+        origSize = (uint64_t)(be64toht(*i64Buf));/* is saved in be format */
         rpos += 8; /* advance the pointer */
 
         i32Buf = (uint32_t*)rpos;
@@ -109,58 +250,76 @@ size_t H5Z_filter_lz4(unsigned int flags, size_t cd_nelmts,
         rpos += 4;
         if(blockSize>origSize)
             blockSize = origSize;
+        if(blockSize == 0 && origSize > 0)
+        {
+            printf("lz4 chunk header has zero block size\n");
+            goto error;
+        }
+        nBlocks = origSize > 0 ? (origSize-1)/blockSize +1 : 0;
+        /* every block needs at least its 4-byte size */
+        if(nBlocks > (uint64_t)(rend - rpos)/4)
+        {
+            printf("lz4 chunk of %lu bytes cannot hold %lu blocks\n", (unsigned long)nbytes, (unsigned long)nBlocks);
+            goto error;
+        }
 
-        if (NULL==(outBuf = malloc(origSize)))
+        if (NULL==(outBuf = malloc(origSize > 0 ? origSize : 1)))
+        {
+            printf("cannot malloc\n");
+            goto error;
+        }
+        if (nBlocks > 0 &&
+            (NULL==(blockStarts = malloc(nBlocks*sizeof(*blockStarts))) ||
+             NULL==(compSizes = malloc(nBlocks*sizeof(*compSizes)))))
         {
             printf("cannot malloc\n");
             goto error;
         }
-        roBuf = (char*)outBuf;   /* pointer to current write position */
-        decompSize     = 0;
-        /// start with the first block ///
-        while(decompSize < origSize)
+
+        /* Block sizes are interleaved with the blocks, so find where
+         * each block starts before decoding them in any order. */
+        for(block = 0; block < (long)nBlocks; ++block)
         {
             uint32_t compressedBlockSize;  /// is saved in be format
 
-            if(origSize-decompSize < blockSize) /* the last block can be smaller than blockSize. */
-                blockSize = origSize-decompSize;
-            i32Buf = (uint32_t*)rpos;
-            compressedBlockSize =  be32toht(*i32Buf);  /// is saved in be format
-            rpos += 4;
-            if(compressedBlockSize == blockSize) /* there was no compression */
+            if(rend - rpos < 4)
             {
-                memcpy(roBuf, rpos, blockSize);
+                printf("lz4 chunk ends before block %ld\n", block);
+                goto error;
             }
-            else /* do the decompression */
+            /* Blocks follow one another unaligned, so copy sizes in and out */
+            memcpy(&compressedBlockSize, rpos, 4);
+            compressedBlockSize =  be32toht(compressedBlockSize);  /// is saved in be format
+            rpos += 4;
+            if(compressedBlockSize > (uint64_t)(rend - rpos))
             {
-#if LZ4_VERSION_NUMBER > 10300
-	      /* 20200906 csz++
-	       LZ4_decompress_fast() is now deprecated in favor of LZ4_decompress_safe()
-	       LZ4LIB_API int LZ4_decompress_safe (const char* src, char* dst, int compressedSize, int dstCapacity);
-	       LZ4LIB_API int LZ4_decompress_fast (const char* src, char* dst, int originalSize);
-	       Examining prototypes shows blockSize == originalSize
-	       Need arguments for compressedSize and dstCapacity:
-	       compressedSize is the exact complete size of the compressed block.
-	       dstCapacity is the size of destination buffer (which must be already allocated), presumed an upper bound of decompressed size 
-	       20200906 csz-- */ 
-	      //int compressedBytes = LZ4_decompress_fast(rpos, roBuf, blockSize);
-	      int compressedBytes = LZ4_decompress_safe(rpos, roBuf, blockSize, compressedBlockSize);
-#else
-                int compressedBytes = LZ4_uncompress(rpos, roBuf, blockSize);
-#endif
-                if(compressedBytes != compressedBlockSize)
-                {
-                    printf("decompressed size not the same: %d, != %d\n", compressedBytes, compressedBlockSize);
-                    goto error;
-                }
+                printf("lz4 block of %u bytes overruns chunk\n", compressedBlockSize);
+                goto error;
             }
-
+            blockStarts[block] = rpos;
+            compSizes[block] = compressedBlockSize;
             rpos += compressedBlockSize;   /* advance the read pointer to the next block */
-            roBuf += blockSize;            /* advance the write pointer */
-            decompSize += blockSize;
         }
+
+        threads = H5Z_lz4_thread_count(nBlocks);
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic) num_threads(threads) if(threads > 1) reduction(+:badBlocks)
+#endif
+        for(block = 0; block < (long)nBlocks; ++block)
+        {
+            uint64_t decompSize = (uint64_t)block*blockSize;
+            /* the last block can be smaller than blockSize. */
+            uint32_t size = origSize-decompSize < blockSize ? (uint32_t)(origSize-decompSize) : blockSize;
+
+            if(H5Z_lz4_decompress_block(blockStarts[block], (char*)outBuf + decompSize, compSizes[block], size))
+                badBlocks++;
+        }
+        if(badBlocks)
+            goto error;
+
         free(*buf);
         *buf = outBuf;
+        *buf_size = (size_t)(origSize > 0 ? origSize : 1);
         outBuf = NULL;
         ret_value = (size_t)origSize;  // should always work, as orig_size cannot be > 2GB (sizeof(size_t) < 4GB)
     }
@@ -169,11 +328,12 @@ size_t H5Z_filter_lz4(unsigned int flags, size_t cd_nelmts,
         size_t blockSize;
         size_t nBlocks;
         size_t outSize; /* size of the output buffer. Header size (12 bytes) is included */
-        size_t block;
+        long block;
         uint64_t *i64Buf;
         uint32_t *i32Buf;
-        char *rpos;      /* pointer to current read position */
         char *roBuf;    /* pointer to current write position */
+        int acceleration = 1;
+        int hcLevel = 0;
 
         if (nbytes > INT32_MAX)
         {
@@ -181,26 +341,58 @@ size_t H5Z_filter_lz4(unsigned int flags, size_t cd_nelmts,
             goto error;
         }
 
-        if(cd_nelmts > 0 && cd_values[0] > 0)
+        if(cd_nelmts > PARAM_BLOCK_SIZE && cd_values[PARAM_BLOCK_SIZE] > 0)
         {
-            blockSize = cd_values[0];
+            blockSize = cd_values[PARAM_BLOCK_SIZE];
         }
         else
         {
             blockSize = DEFAULT_BLOCK_SIZE;
         }
+        if(blockSize > MAX_BLOCK_SIZE)
+        {
+            blockSize = MAX_BLOCK_SIZE;
+        }
         if(blockSize > nbytes)
         {
             blockSize = nbytes;
         }
-        nBlocks = (nbytes-1)/blockSize +1;
-        if (NULL==(outBuf = malloc(LZ4_COMPRESSBOUND(nbytes)
-                + 4+8 + nBlocks*4)))
+        if(cd_nelmts > PARAM_ACCELERATION && cd_values[PARAM_ACCELERATION] > 0)
+        {
+            acceleration = cd_values[PARAM_ACCELERATION] < MAX_ACCELERATION ? (int)cd_values[PARAM_ACCELERATION] : MAX_ACCELERATION;
+        }
+        if(cd_nelmts > PARAM_HC_LEVEL && cd_values[PARAM_HC_LEVEL] > 0)
+        {
+#ifdef USE_LZ4HC
+            hcLevel = cd_values[PARAM_HC_LEVEL] < MAX_HC_LEVEL ? (int)cd_values[PARAM_HC_LEVEL] : MAX_HC_LEVEL;
+#else
+            printf("lz4hc not available, using fast lz4\n");
+#endif
+        }
+        nBlocks = nbytes > 0 ? (nbytes-1)/blockSize +1 : 0;
+        threads = H5Z_lz4_thread_count(nBlocks);
+
+        /* Blocks that do not shrink are stored as is, so the output
+         * never exceeds the input plus the headers. */
+        if (NULL==(outBuf = malloc(nbytes + 4+8 + nBlocks*4)))
+        {
+            goto error;
+        }
+        if (nBlocks > 0 && NULL==(compSizes = malloc(nBlocks*sizeof(*compSizes))))
         {
             goto error;
         }
+#ifdef USE_LZ4HC
+        if (hcLevel > 0)
+        {
+            if (NULL==(hcStates = calloc(threads, sizeof(*hcStates))))
+                goto error;
+            for(thread = 0; thread < threads; ++thread)
+                if (NULL==(hcStates[thread] = malloc(LZ4_sizeofStateHC())))
+                    goto error;
+        }
+#endif
 
-        rpos  = (char*)*buf;      /* pointer to current read position */
         roBuf = (char*)outBuf;    /* pointer to current write position */
         /* header */
         i64Buf = (uint64_t *) (roBuf);
@@ -211,53 +403,78 @@ size_t H5Z_filter_lz4(unsigned int flags, size_t cd_nelmts,
         i32Buf[0] = htobe32t((uint32_t)blockSize); /* Store the block size in be format */
         roBuf += 4;
 
-        outSize = 12; /* size of the output buffer. Header size (12 bytes) is included */
-
-        for(block = 0; block < nBlocks; ++block)
+        /* Each block is first compressed into the place it would take
+         * if every block were stored raw, so threads never overlap. */
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic) num_threads(threads) if(threads > 1)
+#endif
+        for(block = 0; block < (long)nBlocks; ++block)
         {
-            uint32_t compBlockSize; /// reserve space for compBlockSize
-            size_t origWritten = block*blockSize;
-            if(nbytes - origWritten < blockSize) /* the last block may be < blockSize */
-                blockSize = nbytes - origWritten;
+            size_t origWritten = (size_t)block*blockSize;
+            /* the last block may be < blockSize */
+            size_t size = nbytes - origWritten < blockSize ? nbytes - origWritten : blockSize;
+            void *hcState = NULL;
 
-#if LZ4_VERSION_NUMBER > 10300
-            compBlockSize = LZ4_compress_default(rpos, roBuf+4,blockSize,nBlocks*4); /// reserve space for compBlockSize
+#ifdef _OPENMP
+            if(hcStates)
+                hcState = hcStates[omp_get_thread_num()];
 #else
-            compBlockSize = LZ4_compress(rpos, roBuf+4, blockSize); /// reserve space for compBlockSize
+            if(hcStates)
+                hcState = hcStates[0];
 #endif
-            if(!compBlockSize)
-                goto error;
-            if(compBlockSize >= blockSize) /* compression did not save any space, do a memcpy instead */
-            {
-                compBlockSize = blockSize;
-                memcpy(roBuf+4, rpos, blockSize);
-            }
+            compSizes[block] = (uint32_t)H5Z_lz4_compress_block((char*)*buf + origWritten, roBuf + origWritten + (size_t)block*4 + 4,
+                                                      (int)size, acceleration, hcState, hcLevel);
+        }
 
-            i32Buf =  (uint32_t *) (roBuf);
-            i32Buf[0] = htobe32t((uint32_t)compBlockSize);  /* write blocksize */
-            roBuf += 4;
+        /* Then pack the blocks, each with its size, from the running
+         * sum of the sizes before it. Blocks only move towards the
+         * start of the buffer, and in order, so none is overwritten
+         * before it moves. */
+        outSize = 12; /* size of the output buffer. Header size (12 bytes) is included */
+        for(block = 0; block < (long)nBlocks; ++block)
+        {
+            uint32_t beBlockSize = htobe32t(compSizes[block]);  /* write blocksize */
+            char *slot = roBuf + (size_t)block*(blockSize+4) + 4;
 
-            rpos += blockSize;         /* advance read pointer */
-            roBuf += compBlockSize;       /* advance write pointer */
-            outSize += compBlockSize + 4;
+            memcpy((char*)outBuf + outSize, &beBlockSize, 4);
+            memmove((char*)outBuf + outSize + 4, slot, compSizes[block]);
+            outSize += compSizes[block] + 4;
+        }
+
+        /* Return the room that compression saved, keeping the whole
+         * buffer if realloc fails. */
+        *buf_size = nbytes + 4+8 + nBlocks*4;
+        if(outSize < *buf_size)
+        {
+            void *fitBuf = realloc(outBuf, outSize);
+            if(fitBuf)
+            {
+                outBuf = fitBuf;
+                *buf_size = outSize;
+            }
         }
 
         free(*buf);
         *buf = outBuf;
-        *buf_size = outSize;
         outBuf = NULL;
         ret_value = outSize;
-
     }
+
     done:
+    free(compSizes);
+    free(blockStarts);
+    if(hcStates)
+    {
+        for(thread = 0; thread < threads; ++thread)
+            free(hcStates[thread]);
+        free(hcStates);
+    }
     if(outBuf)
         free(outBuf);
+    outBuf = NULL;
     return ret_value;
 
-
     error:
-    if(outBuf)
-        free(outBuf);
-    outBuf = NULL;
-    return 0;
+    ret_value = 0;
+    goto done;
 }
@@ -0,0 +1,690 @@
+/* Copyright (C) 2026--present Charlie Zender */
+
+ /*
+ * This file is an example of an HDF5 filter plugin.
+ * The plugin can be used with the HDF5 library version 1.8.11+ to read and write
+ * HDF5 datasets whose floating-point values are coded as the XOR with their predecessors.
+ */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h" /* Autotools tokens */
+#endif
+#include <stdio.h>
+#ifdef HAVE_SYS_TYPES_H
+# include <sys/types.h>
+#endif
+#ifdef HAVE_SYS_STAT_H
+# include <sys/stat.h>
+#endif
+#ifdef STDC_HEADERS
+# include <stdlib.h>
+# include <stddef.h>
+#else
+# ifdef HAVE_STDLIB_H
+#  include <stdlib.h>
+# endif
+#endif
+#ifdef HAVE_STRING_H
+# if !defined STDC_HEADERS && defined HAVE_MEMORY_H
+#  include <memory.h>
+# endif
+# include <string.h>
+#endif
+#ifdef HAVE_STRINGS_H
+# include <strings.h>
+#endif
+#ifdef HAVE_INTTYPES_H
+# include <inttypes.h>
+#endif
+#ifdef HAVE_STDINT_H
+# include <stdint.h>
+#endif
+#ifdef HAVE_UNISTD_H
+# include <unistd.h>
+#endif
+#include <assert.h>
+
+#if defined(_WIN32)
+#include <Winsock2.h>
+#endif
+
+/* 3rd party vendors */
+#include "H5PLextern.h" /* HDF5 Plugin Library: H5PLget_plugin_type(), H5PLget_plugin_info() */
+
+#define H5Z_FILTER_XORDELTA 32775 /* NB: Not yet registered with HDF, see ccr.h */
+#define CCR_FLT_DBG_INFO 0 /* [flg] Print non-fatal debugging information */
+#define CCR_FLT_NAME "XOR Delta filter (lossless floating-point predictor)" /* [sng] Filter name in vernacular for HDF5 messages */
+#define CCR_FLT_PRM_NBR 2 /* [nbr] Number of parameters sent to filter (in cd_params array). NB: keep identical with ccr.h:XORDELTA_FLT_PRM_NBR */
+#define CCR_FLT_PRM_PSN_DATUM_SIZE 0 /* [nbr] Ordinal position of datum_size in parameter list (cd_params array) */
+#define CCR_FLT_PRM_PSN_ROW_NBR 1 /* [nbr] Ordinal position of values per row (fastest-varying chunk dimension) in parameter list (cd_params array) */
+#define CCR_XDL_HDR_SZ 24 /* [B] Bytes in header of coded chunk */
+#define CCR_XDL_VRS 1 /* [nbr] Version of coded chunk layout */
+#define CCR_XDL_MOD_XOR 0 /* [enm] Values are coded as XOR residuals */
+#define CCR_XDL_MOD_RAW 1 /* [enm] Values are stored unchanged, because coding would not shrink them */
+#define CCR_XDL_LDZ_INV 8 /* [enm] No previous leading-zero code */
+
+/* Coded chunks start with a CCR_XDL_HDR_SZ byte header:
+   "CXD", version, datum size, mode (CCR_XDL_MOD_XOR or CCR_XDL_MOD_RAW), 0, 0, then size of uncoded chunk and values per row, both 64-bit big-endian
+   Then, unchanged, any trailing bytes that do not fill a whole value, then the bit stream (CCR_XDL_MOD_XOR) or the values (CCR_XDL_MOD_RAW)
+   Each value is predicted by its predecessor in the row, and the first value of a row by the first value of the row before (by zero in the first row)
+   The residual, value XOR prediction, of w=8*datum_size bits is coded after Chimp (Liakos et al., 2022), with fields written most significant bit first:
+   00                                   Residual is zero
+   01 ldz[3] len[5|6] bits[len]         Residual has more than 5 (float) or 6 (double) trailing zeros: len significant bits start ldz_tbl[ldz] bits from the top
+   10 bits[w-ldz_tbl[prv]]              Residual has the same leading-zero code, prv, as the last residual coded with 10 or 11
+   11 ldz[3] bits[w-ldz_tbl[ldz]]       Residual has a new leading-zero code
+   Leading zeros are rounded down to the table entry below them, so smooth fields, whose neighbors share sign, exponent, and leading mantissa bits, take a few flag bits plus the bits that differ
+   The stream ends padded to a whole byte with zeros, and is independent of the byte order of writer and reader */
+
+/* Leading zeros represented by each 3-bit leading-zero code */
+static const int ccr_xdl_ldz_tbl_flt[8]={0,6,8,10,12,14,16,18}; /* [nbr] Single precision */
+static const int ccr_xdl_ldz_tbl_dbl[8]={0,8,12,16,18,20,22,24}; /* [nbr] Double precision, as in Chimp */
+
+/* Bit stream written or read most significant bit first, through a 64-bit accumulator */
+typedef struct{
+  unsigned char *ptr; /* [ptr] Next byte to write */
+  uint64_t acc; /* [bit] Bits not yet written, right-aligned */
+  int nbr; /* [nbr] Number of bits in accumulator, less than 64 */
+} ccr_xdl_wrt_t;
+
+typedef struct{
+  const unsigned char *ptr; /* [ptr] Next byte to read */
+  const unsigned char *end; /* [ptr] End of stream */
+  uint64_t acc; /* [bit] Bits not yet read, left-aligned */
+  int nbr; /* [nbr] Number of bits in accumulator */
+} ccr_xdl_rd_t;
+
+/* Forward-declare functions before their names appear in H5Z_class2_t filter structure */
+size_t /* O [B] Number of bytes resulting after forward/reverse filter applied */
+H5Z_filter_xordelta /* [fnc] HDF5 XOR Delta Filter */
+(unsigned int flags, /* I [flg] Bitfield that encodes filter direction */
+ size_t cd_nelmts, /* I [nbr] Number of elements in filter parameter (cd_values[]) array */
+ const unsigned int cd_values[], /* I [enm] Filter parameters */
+ size_t bfr_sz_in, /* I [B] Number of bytes in input buffer (before forward/reverse filter) */
+ size_t *bfr_sz_out, /* O [B] Number of bytes in output buffer (after forward/reverse filter) */
+ void **bfr_inout); /* I/O [val] Values to code or decode */
+
+htri_t /* O [flg] Data meet criteria to apply filter */
+ccr_can_apply_xordelta /* [fnc] Callback to determine if current variable meets filter criteria */
+(hid_t dcpl, /* I [id] Dataset creation property list ID */
+ hid_t type, /* I [id] Dataset type ID */
+ hid_t space); /* I [id] Dataset space ID */
+
+htri_t /* O [flg] Filter parameters successfully modified for this variable */
+ccr_set_local_xordelta /* [fnc] Callback to determine and set per-variable filter parameters */
+(hid_t dcpl, /* I [id] Dataset creation property list ID */
+ hid_t type, /* I [id] Dataset type ID */
+ hid_t space); /* I [id] Dataset space ID */
+
+const H5Z_class2_t H5Z_XORDELTA[1]={{
+    H5Z_CLASS_T_VERS, /* H5Z_class_t version */
+    (H5Z_filter_t)H5Z_FILTER_XORDELTA, /* Filter ID number */
+#ifdef FILTER_DECODE_ONLY
+    0, /* [flg] Encoder availability flag */
+#else
+    1, /* [flg] Encoder availability flag */
+#endif
+    1, /* [flg] Decoder availability flag */
+    CCR_FLT_NAME, /* [sng] Filter name for debugging */
+    ccr_can_apply_xordelta, /* [fnc] Callback to determine if current variable meets filter criteria */
+    ccr_set_local_xordelta, /* [fnc] Callback to determine and set per-variable filter parameters */
+    (H5Z_func_t)H5Z_filter_xordelta, /* [fnc] Function to implement filter */
+  }}; /* !H5Z_XORDELTA */
+
+static size_t /* O [B] Bytes in bit stream */
+ccr_xdl_enc /* [fnc] Code values as XOR residuals */
+(const size_t elm_nbr, /* I [nbr] Number of values */
+ const size_t row_nbr, /* I [nbr] Values per row */
+ const size_t datum_size, /* I [B] Bytes per value, 4 or 8 */
+ const unsigned char *src, /* I [val] Values */
+ unsigned char *dst); /* O [B] Bit stream */
+
+static int /* O [flg] 1 for success, 0 if stream is corrupt */
+ccr_xdl_dec /* [fnc] Decode values from XOR residuals */
+(const size_t elm_nbr, /* I [nbr] Number of values */
+ const size_t row_nbr, /* I [nbr] Values per row */
+ const size_t datum_size, /* I [B] Bytes per value, 4 or 8 */
+ const unsigned char *src, /* I [B] Bit stream */
+ const size_t src_sz, /* I [B] Bytes in bit stream */
+ unsigned char *dst); /* O [val] Values */
+
+/* Function definitions */
+H5PL_type_t /* O [enm] Plugin type */
+H5PLget_plugin_type /* [fnc] Provide plug-in type provided by this shared library */
+(void)
+{ /* Purpose: Describe plug-in type provided by this shared library
+     The HDF5 plugin mechanism usually calls this function after an application calls H5Pset_filter(), or when the data to which this filter will be applied are first read */
+  return H5PL_TYPE_FILTER;
+} /* !H5PLget_plugin_type() */
+
+const void * /* O [enm] */
+H5PLget_plugin_info /* [fnc] Return structure */
+(void)
+{ /* Purpose: Provide structure that defines XOR Delta filter so the filter may be dynamically registered with the plugin mechanism
+     The HDF5 plugin mechanism usually calls this function after an application calls H5Pset_filter(), or when the data to which this filter will be applied are first read */
+  return H5Z_XORDELTA;
+} /* !H5PLget_plugin_info() */
+
+static void
+ccr_xdl_put_be64 /* [fnc] Store 64-bit big-endian integer */
+(unsigned char *dst, /* O [B] Eight bytes */
+ uint64_t val) /* I [nbr] Integer to store */
+{
+  int byt_idx; /* [idx] Byte within integer */
+  for(byt_idx=7;byt_idx>=0;byt_idx--){
+    dst[byt_idx]=(unsigned char)(val & 0xFF);
+    val>>=8;
+  } /* !byt_idx */
+} /* !ccr_xdl_put_be64() */
+
+static uint64_t /* O [nbr] Integer read */
+ccr_xdl_get_be64 /* [fnc] Read 64-bit big-endian integer */
+(const unsigned char *src) /* I [B] Eight bytes */
+{
+  uint64_t val=0; /* [nbr] Integer read */
+  int byt_idx; /* [idx] Byte within integer */
+  for(byt_idx=0;byt_idx<8;byt_idx++) val=(val << 8) | src[byt_idx];
+  return val;
+} /* !ccr_xdl_get_be64() */
+
+size_t /* O [B] Number of bytes resulting after forward/reverse filter applied */
+H5Z_filter_xordelta /* [fnc] HDF5 XOR Delta Filter */
+(unsigned int flags, /* I [flg] Bitfield that encodes filter direction */
+ size_t cd_nelmts, /* I [nbr] Number of elements in filter parameter (cd_values[]) array */
+ const unsigned int cd_values[], /* I [enm] Filter parameters */
+ size_t bfr_sz_in, /* I [B] Number of bytes in input buffer (before forward/reverse filter) */
+ size_t *bfr_sz_out, /* O [B] Number of bytes in output buffer (after forward/reverse filter) */
+ void **bfr_inout) /* I/O [val] Values to code or decode */
+{
+  /* Purpose: Dynamic filter invoked by HDF5 to replace each floating-point value by its XOR with the value before it, and store only the bits of the XOR that are not leading or trailing zeros
+     Neighbors in smooth fields share sign, exponent, and leading mantissa bits, so full-precision data shrink with no loss, and much faster than with shuffle and DEFLATE
+     Filter is lossless: chunks that coding would not shrink are stored unchanged */
+
+  const char fnc_nm[]="H5Z_filter_xordelta()"; /* [sng] Function name */
+
+  size_t datum_size; /* [B] Bytes per unfiltered data value */
+  size_t elm_nbr; /* [nbr] Number of values in uncoded chunk */
+  size_t row_nbr; /* [nbr] Values per row */
+  size_t stm_sz; /* [B] Bytes in bit stream */
+  size_t stm_sz_max; /* [B] Bytes in longest possible bit stream */
+  size_t tail_sz; /* [B] Trailing bytes that do not fill a whole value */
+  size_t bfr_sz_new; /* [B] Bytes in new buffer */
+  size_t bfr_sz_alc; /* [B] Size allocated for new buffer */
+  size_t unp_sz; /* [B] Bytes in uncoded chunk */
+
+  const unsigned char *bfr_old=(const unsigned char *)(*bfr_inout); /* [ptr] Old buffer */
+  unsigned char *bfr_new=NULL; /* [ptr] New buffer */
+
+  if(cd_nelmts < CCR_FLT_PRM_NBR){
+    (void)fprintf(stderr,"ERROR: \"%s\" filter function %s reports %lu parameters, needs %d\n",CCR_FLT_NAME,fnc_nm,(unsigned long)cd_nelmts,CCR_FLT_PRM_NBR);
+    return 0;
+  } /* !cd_nelmts */
+  datum_size=cd_values[CCR_FLT_PRM_PSN_DATUM_SIZE];
+  if(datum_size != 4 && datum_size != 8){
+    (void)fprintf(stderr,"ERROR: \"%s\" filter function %s reports datum size = %lu B is invalid, must be 4 or 8\n",CCR_FLT_NAME,fnc_nm,(unsigned long)datum_size);
+    return 0;
+  } /* !datum_size */
+
+  if(flags & H5Z_FLAG_REVERSE){
+
+    /* Decode, after reading */
+    if(bfr_sz_in < CCR_XDL_HDR_SZ || memcmp(bfr_old,"CXD",3)){
+      (void)fprintf(stderr,"ERROR: \"%s\" filter function %s reports chunk of %lu B has no XOR Delta header\n",CCR_FLT_NAME,fnc_nm,(unsigned long)bfr_sz_in);
+      return 0;
+    } /* !bfr_sz_in */
+    if(bfr_old[3] != CCR_XDL_VRS){
+      (void)fprintf(stderr,"ERROR: \"%s\" filter function %s reports chunk header version %d is not supported\n",CCR_FLT_NAME,fnc_nm,(int)bfr_old[3]);
+      return 0;
+    } /* !CCR_XDL_VRS */
+    if(bfr_old[4] != datum_size || (bfr_old[5] != CCR_XDL_MOD_XOR && bfr_old[5] != CCR_XDL_MOD_RAW)){
+      (void)fprintf(stderr,"ERROR: \"%s\" filter function %s reports chunk header datum size = %d B and mode = %d do not match datum size = %lu B\n",CCR_FLT_NAME,fnc_nm,(int)bfr_old[4],(int)bfr_old[5],(unsigned long)datum_size);
+      return 0;
+    } /* !bfr_old */
+    unp_sz=(size_t)ccr_xdl_get_be64(bfr_old+8);
+    row_nbr=(size_t)ccr_xdl_get_be64(bfr_old+16);
+    elm_nbr=unp_sz/datum_size;
+    tail_sz=unp_sz%datum_size;
+    /* Every value takes at least two bits of stream */
+    stm_sz=bfr_sz_in-CCR_XDL_HDR_SZ;
+    if(tail_sz > stm_sz || (bfr_old[5] == CCR_XDL_MOD_RAW && unp_sz != stm_sz) || elm_nbr/4 > stm_sz-tail_sz){
+      (void)fprintf(stderr,"ERROR: \"%s\" filter function %s reports chunk of %lu B does not match its header\n",CCR_FLT_NAME,fnc_nm,(unsigned long)bfr_sz_in);
+      return 0;
+    } /* !bfr_sz_in */
+    stm_sz-=tail_sz;
+
+    bfr_sz_alc=unp_sz > 0 ? unp_sz : 1;
+    if(!(bfr_new=(unsigned char *)malloc(bfr_sz_alc))){
+      (void)fprintf(stderr,"ERROR: \"%s\" filter function %s unable to allocate %lu B for decoded data\n",CCR_FLT_NAME,fnc_nm,(unsigned long)unp_sz);
+      return 0;
+    } /* !bfr_new */
+
+    if(CCR_FLT_DBG_INFO) (void)fprintf(stderr,"INFO: %s decodes %lu values in rows of %lu from %lu B\n",fnc_nm,(unsigned long)elm_nbr,(unsigned long)row_nbr,(unsigned long)stm_sz);
+
+    if(bfr_old[5] == CCR_XDL_MOD_RAW){
+      memcpy(bfr_new,bfr_old+CCR_XDL_HDR_SZ+tail_sz,elm_nbr*datum_size);
+    }else if(!ccr_xdl_dec(elm_nbr,row_nbr,datum_size,bfr_old+CCR_XDL_HDR_SZ+tail_sz,stm_sz,bfr_new)){
+      (void)fprintf(stderr,"ERROR: \"%s\" filter function %s reports bit stream of %lu B does not decode to %lu values\n",CCR_FLT_NAME,fnc_nm,(unsigned long)stm_sz,(unsigned long)elm_nbr);
+      free(bfr_new);
+      return 0;
+    } /* !ccr_xdl_dec() */
+    if(tail_sz > 0) memcpy(bfr_new+elm_nbr*datum_size,bfr_old+CCR_XDL_HDR_SZ,tail_sz);
+    bfr_sz_new=unp_sz;
+
+  }else{
+
+    /* Code, before writing */
+    unp_sz=bfr_sz_in;
+    elm_nbr=unp_sz/datum_size;
+    tail_sz=unp_sz%datum_size;
+    row_nbr=cd_values[CCR_FLT_PRM_PSN_ROW_NBR];
+    if(row_nbr == 0 || row_nbr > elm_nbr) row_nbr=elm_nbr;
+
+    /* Longest residual takes 5 bits of flag and code on top of its value, and the writer stores whole 64-bit words */
+    stm_sz_max=(elm_nbr*(8*datum_size+5)+63)/64*8;
+    if(stm_sz_max < elm_nbr*datum_size) stm_sz_max=elm_nbr*datum_size;
+    bfr_sz_alc=CCR_XDL_HDR_SZ+tail_sz+stm_sz_max+8;
+    if(!(bfr_new=(unsigned char *)malloc(bfr_sz_alc))){
+      (void)fprintf(stderr,"ERROR: \"%s\" filter function %s unable to allocate %lu B for coded data\n",CCR_FLT_NAME,fnc_nm,(unsigned long)bfr_sz_alc);
+      return 0;
+    } /* !bfr_new */
+
+    memcpy(bfr_new,"CXD",3);
+    bfr_new[3]=CCR_XDL_VRS;
+    bfr_new[4]=(unsigned char)datum_size;
+    bfr_new[5]=CCR_XDL_MOD_XOR;
+    bfr_new[6]=0;
+    bfr_new[7]=0;
+    ccr_xdl_put_be64(bfr_new+8,(uint64_t)unp_sz);
+    ccr_xdl_put_be64(bfr_new+16,(uint64_t)row_nbr);
+    if(tail_sz > 0) memcpy(bfr_new+CCR_XDL_HDR_SZ,bfr_old+elm_nbr*datum_size,tail_sz);
+
+    stm_sz=ccr_xdl_enc(elm_nbr,row_nbr,datum_size,bfr_old,bfr_new+CCR_XDL_HDR_SZ+tail_sz);
+
+    /* Noisy data, whose neighbors share few bits, are stored unchanged rather than grown */
+    if(stm_sz >= elm_nbr*datum_size){
+      bfr_new[5]=CCR_XDL_MOD_RAW;
+      memcpy(bfr_new+CCR_XDL_HDR_SZ+tail_sz,bfr_old,elm_nbr*datum_size);
+      stm_sz=elm_nbr*datum_size;
+    } /* !stm_sz */
+    bfr_sz_new=CCR_XDL_HDR_SZ+tail_sz+stm_sz;
+    /* Return worst-case room left unused, keep whole buffer if realloc() fails */
+    if(bfr_sz_new < bfr_sz_alc){
+      unsigned char *bfr_fit; /* [ptr] Shrunk buffer */
+      if((bfr_fit=(unsigned char *)realloc(bfr_new,bfr_sz_new))){
+	bfr_new=bfr_fit;
+	bfr_sz_alc=bfr_sz_new;
+      } /* !bfr_fit */
+    } /* !bfr_sz_new */
+
+    if(CCR_FLT_DBG_INFO) (void)fprintf(stderr,"INFO: %s codes %lu values in rows of %lu into %lu B\n",fnc_nm,(unsigned long)elm_nbr,(unsigned long)row_nbr,(unsigned long)stm_sz);
+
+  } /* !flags */
+
+  free(*bfr_inout);
+  *bfr_inout=bfr_new;
+  *bfr_sz_out=bfr_sz_alc;
+  return bfr_sz_new;
+
+} /* !H5Z_filter_xordelta() */
+
+htri_t /* O [flg] Data meet criteria to apply filter */
+ccr_can_apply_xordelta /* [fnc] Callback to determine if current variable meets filter criteria */
+(hid_t dcpl, /* I [id] Dataset creation property list ID */
+ hid_t type, /* I [id] Dataset type ID */
+ hid_t space) /* I [id] Dataset space ID */
+{
+  /* Data space must be simple, i.e., a multi-dimensional array */
+  if(H5Sis_simple(space) <= 0){
+    fprintf(stderr,"WARNING: Cannot apply filter \"%s\" filter because data space is not simple.\n",CCR_FLT_NAME);
+    return 0;
+  } /* !H5Sis_simple(space) */
+
+  /* Filter can be applied */
+  return 1;
+} /* !ccr_can_apply_xordelta() */
+
+htri_t /* O [flg] Filter parameters successfully modified for this variable */
+ccr_set_local_xordelta /* [fnc] Callback to determine and set per-variable filter parameters */
+(hid_t dcpl, /* I [id] Dataset creation property list ID */
+ hid_t type, /* I [id] Dataset type ID */
+ hid_t space) /* I [id] Dataset space ID */
+{
+  const char fnc_nm[]="ccr_set_local_xordelta()"; /* [sng] Function name */
+
+  herr_t rcd; /* [flg] Return code */
+
+  /* Initialize filter parameters with default values */
+  unsigned int ccr_flt_prm[CCR_FLT_PRM_NBR]={0,0};
+
+  /* Initialize output variables for call to H5Pget_filter_by_id() */
+  unsigned int flags=0;
+  size_t cd_nelmts=CCR_FLT_PRM_NBR;
+  unsigned int *cd_values=ccr_flt_prm;
+
+  /* Retrieve parameters specified by user
+     https://support.hdfgroup.org/HDF5/doc/RM/RM_H5P.html#FunctionIndex
+     Ignore name and filter_config by setting last three arguments to 0/NULL */
+  rcd=H5Pget_filter_by_id(dcpl,H5Z_FILTER_XORDELTA,&flags,&cd_nelmts,cd_values,0,NULL,NULL);
+  if(rcd < 0){
+    (void)fprintf(stderr,"ERROR: %s filter callback function %s reports H5Pget_filter_by_id() failed to get filter flags and parameters for current variable\n",CCR_FLT_NAME,fnc_nm);
+    return 0;
+  } /* !rcd */
+
+  /* Leading- and trailing-zero codes suit IEEE floating-point data */
+  H5T_class_t data_class; /* [enm] Data type class identifier (H5T_FLOAT, H5T_INT, H5T_STRING, ...) */
+  data_class=H5Tget_class(type);
+  if(data_class < 0){
+    (void)fprintf(stderr,"ERROR: %s filter callback function %s reports H5Tget_class() returned invalid data type class identifier = %d for current variable\n",CCR_FLT_NAME,fnc_nm,(int)data_class);
+    return 0;
+  } /* !data_class */
+
+  /* Datum size is determined by variable type */
+  size_t datum_size; /* [B] Bytes per data value */
+  datum_size=H5Tget_size(type);
+  if(datum_size <= 0){
+    (void)fprintf(stderr,"ERROR: %s filter callback function %s reports H5Tget_size() returned invalid datum size = %lu B\n",CCR_FLT_NAME,fnc_nm,datum_size);
+    return 0;
+  } /* !datum_size */
+
+  if(data_class != H5T_FLOAT || (datum_size != 4 && datum_size != 8)){
+    if(CCR_FLT_DBG_INFO) (void)fprintf(stdout,"INFO: \"%s\" filter callback function %s reports variable is not single- or double-precision floating-point. Removing XOR Delta filter...\n",CCR_FLT_NAME,fnc_nm);
+    rcd=H5Premove_filter(dcpl,H5Z_FILTER_XORDELTA);
+    if(rcd < 0) return 0;
+    return 1;
+  } /* !data_class */
+  ccr_flt_prm[CCR_FLT_PRM_PSN_DATUM_SIZE]=(unsigned int)datum_size;
+
+  /* Rows run along the fastest-varying dimension of the dataspace, and chunks store that dimension contiguously
+     Values per row is the chunk size in that dimension, 0 (whole chunk) for scalars or contiguous storage */
+  int rnk; /* [nbr] Rank of dataspace */
+  hsize_t cnk_sz[H5S_MAX_RANK]; /* [nbr] Chunk size in each dimension */
+  rnk=H5Sget_simple_extent_ndims(space);
+  ccr_flt_prm[CCR_FLT_PRM_PSN_ROW_NBR]=0;
+  if(rnk > 0 && H5Pget_layout(dcpl) == H5D_CHUNKED && H5Pget_chunk(dcpl,rnk,cnk_sz) == rnk && cnk_sz[rnk-1] <= 0xFFFFFFFFUL)
+    ccr_flt_prm[CCR_FLT_PRM_PSN_ROW_NBR]=(unsigned int)cnk_sz[rnk-1];
+
+  /* Update invoked filter with generic parameters as invoked with variable-specific values */
+  rcd=H5Pmodify_filter(dcpl,H5Z_FILTER_XORDELTA,flags,CCR_FLT_PRM_NBR,cd_values);
+  if(rcd < 0){
+    (void)fprintf(stderr,"ERROR: \"%s\" filter callback function %s reports H5Pmodify_filter() unable to modify filter parameters\n",CCR_FLT_NAME,fnc_nm);
+    return 0;
+  } /* !rcd */
+
+  return 1;
+} /* !ccr_set_local_xordelta() */
+
+static inline int /* O [nbr] Leading zero bits of value */
+ccr_xdl_clz /* [fnc] Count leading zero bits of non-zero 64-bit value */
+(uint64_t val) /* I [val] Value, not zero */
+{
+#if defined(__GNUC__) || defined(__clang__)
+  return __builtin_clzll(val);
+#else /* !__GNUC__ */
+  int clz=0; /* [nbr] Leading zero bits */
+  while(!(val & 0x8000000000000000ULL)){
+    val<<=1;
+    clz++;
+  } /* !val */
+  return clz;
+#endif /* !__GNUC__ */
+} /* !ccr_xdl_clz() */
+
+static inline int /* O [nbr] Trailing zero bits of value */
+ccr_xdl_ctz /* [fnc] Count trailing zero bits of non-zero 64-bit value */
+(uint64_t val) /* I [val] Value, not zero */
+{
+#if defined(__GNUC__) || defined(__clang__)
+  return __builtin_ctzll(val);
+#else /* !__GNUC__ */
+  int ctz=0; /* [nbr] Trailing zero bits */
+  while(!(val & 1)){
+    val>>=1;
+    ctz++;
+  } /* !val */
+  return ctz;
+#endif /* !__GNUC__ */
+} /* !ccr_xdl_ctz() */
+
+static inline void
+ccr_xdl_put /* [fnc] Write bits to stream */
+(ccr_xdl_wrt_t *wrt, /* I/O [sct] Stream */
+ const uint64_t val, /* I [bit] Bits, right-aligned, with no bits set above bit_nbr */
+ const int bit_nbr) /* I [nbr] Number of bits, at most 64 */
+{
+  const int fre_nbr=64-wrt->nbr; /* [nbr] Free bits in accumulator */
+  int rmn_nbr; /* [nbr] Bits that do not fit in accumulator */
+
+  if(bit_nbr < fre_nbr){
+    wrt->acc=(wrt->acc << bit_nbr) | val;
+    wrt->nbr+=bit_nbr;
+    return;
+  } /* !bit_nbr */
+
+  /* Fill accumulator with leading bits of val, store it, and keep the rest */
+  rmn_nbr=bit_nbr-fre_nbr;
+  wrt->acc=(fre_nbr == 64 ? 0 : wrt->acc << fre_nbr) | (val >> rmn_nbr);
+  ccr_xdl_put_be64(wrt->ptr,wrt->acc);
+  wrt->ptr+=8;
+  wrt->acc=rmn_nbr ? val & ((((uint64_t)1) << rmn_nbr)-1) : 0;
+  wrt->nbr=rmn_nbr;
+} /* !ccr_xdl_put() */
+
+static inline int /* O [flg] 1 for success, 0 if stream ends first */
+ccr_xdl_get /* [fnc] Read bits from stream */
+(ccr_xdl_rd_t *rd, /* I/O [sct] Stream */
+ const int bit_nbr, /* I [nbr] Number of bits, at most 56 */
+ uint64_t *val) /* O [bit] Bits, right-aligned */
+{
+  if(rd->nbr < bit_nbr){
+    /* Away from end of stream, load eight bytes at once and keep whole bytes of them
+       Bits of the next, partly kept, byte may sit below the valid bits, and are the same bits the next load sets */
+    if(rd->end-rd->ptr >= 8){
+      rd->acc|=ccr_xdl_get_be64(rd->ptr) >> rd->nbr;
+      rd->ptr+=(63-rd->nbr) >> 3;
+      rd->nbr|=56;
+    }else{
+      while(rd->nbr <= 56 && rd->ptr < rd->end){
+	rd->acc|=((uint64_t)*rd->ptr++) << (56-rd->nbr);
+	rd->nbr+=8;
+      } /* !rd */
+      if(rd->nbr < bit_nbr) return 0;
+    } /* !rd */
+  } /* !rd */
+  *val=bit_nbr ? rd->acc >> (64-bit_nbr) : 0;
+  rd->acc=bit_nbr ? rd->acc << bit_nbr : rd->acc;
+  rd->nbr-=bit_nbr;
+  return 1;
+} /* !ccr_xdl_get() */
+
+static inline int /* O [flg] 1 for success, 0 if stream ends first */
+ccr_xdl_get_wide /* [fnc] Read up to 64 bits from stream */
+(ccr_xdl_rd_t *rd, /* I/O [sct] Stream */
+ const int bit_nbr, /* I [nbr] Number of bits, at most 64 */
+ uint64_t *val) /* O [bit] Bits, right-aligned */
+{
+  uint64_t lo; /* [bit] Trailing 32 bits */
+
+  if(bit_nbr <= 32) return ccr_xdl_get(rd,bit_nbr,val);
+  if(!ccr_xdl_get(rd,bit_nbr-32,val) || !ccr_xdl_get(rd,32,&lo)) return 0;
+  *val=(*val << 32) | lo;
+  return 1;
+} /* !ccr_xdl_get_wide() */
+
+static size_t /* O [B] Bytes in bit stream */
+ccr_xdl_enc /* [fnc] Code values as XOR residuals */
+(const size_t elm_nbr, /* I [nbr] Number of values */
+ const size_t row_nbr, /* I [nbr] Values per row */
+ const size_t datum_size, /* I [B] Bytes per value, 4 or 8 */
+ const unsigned char *src, /* I [val] Values */
+ unsigned char *dst) /* O [B] Bit stream */
+{
+  /* Purpose: Write residual of each value with the shortest of the four codes that apply to it
+     Residual bits are written as integers, so the stream does not depend on host byte order */
+  const int wrd_bit_nbr=(int)(8*datum_size); /* [nbr] Bits per value */
+  const int ctz_min=datum_size == 4 ? 5 : 6; /* [nbr] Trailing zeros above which residual is coded with its length */
+  const int len_bit_nbr=datum_size == 4 ? 5 : 6; /* [nbr] Bits of length field */
+  const int *ldz_tbl=datum_size == 4 ? ccr_xdl_ldz_tbl_flt : ccr_xdl_ldz_tbl_dbl; /* [nbr] Leading zeros of each code */
+  ccr_xdl_wrt_t wrt; /* [sct] Stream */
+  unsigned char ldz_cod[65]; /* [enm] Code for each number of leading zeros */
+  size_t idx;
+  size_t row_srt; /* [idx] First value of row */
+  size_t row_end; /* [idx] Value after last value of row */
+  uint32_t u32; /* [val] Single-precision value */
+  uint64_t val; /* [val] Value */
+  uint64_t prd; /* [val] Prediction, i.e., previous value */
+  uint64_t xr; /* [bit] Residual */
+  uint64_t hdr; /* [bit] Flag and fields before residual bits */
+  int cod; /* [enm] Leading-zero code */
+  int cod_prv=CCR_XDL_LDZ_INV; /* [enm] Leading-zero code of last residual coded with 10 or 11 */
+  int ctz; /* [nbr] Trailing zeros of residual */
+  int hdr_nbr; /* [nbr] Bits of flag and fields */
+  int ldz; /* [nbr] Leading zeros of residual */
+  int len; /* [nbr] Significant bits of residual */
+  int pld_nbr; /* [nbr] Residual bits written */
+  int sel_len; /* [flg] Residual is coded with its length (01) */
+  int sel_prv; /* [flg] Residual has leading-zero code of previous residual (10) */
+  int sel_zro; /* [flg] Residual is zero (00) */
+
+  for(ldz=0,cod=0;ldz<=64;ldz++){
+    while(cod < 7 && ldz_tbl[cod+1] <= ldz) cod++;
+    ldz_cod[ldz]=(unsigned char)cod;
+  } /* !ldz */
+
+  wrt.ptr=dst;
+  wrt.acc=0;
+  wrt.nbr=0;
+  for(row_srt=0;row_srt<elm_nbr;row_srt+=row_nbr){
+    row_end=row_srt+row_nbr < elm_nbr ? row_srt+row_nbr : elm_nbr;
+    prd=0;
+    if(row_srt > 0){
+      if(datum_size == 4){
+	memcpy(&u32,src+(row_srt-row_nbr)*4,4);
+	prd=u32;
+      }else{
+	memcpy(&prd,src+(row_srt-row_nbr)*8,8);
+      } /* !datum_size */
+    } /* !row_srt */
+    for(idx=row_srt;idx<row_end;idx++){
+      if(datum_size == 4){
+	memcpy(&u32,src+idx*4,4);
+	val=u32;
+      }else{
+	memcpy(&val,src+idx*8,8);
+      } /* !datum_size */
+      xr=val^prd;
+      prd=val;
+
+      /* Find fields of every code, then select one with conditional moves, as the choice varies too often to branch on */
+      sel_zro=!xr;
+      ldz=sel_zro ? wrd_bit_nbr : ccr_xdl_clz(xr)-(64-wrd_bit_nbr);
+      ctz=sel_zro ? 0 : ccr_xdl_ctz(xr);
+      cod=ldz_cod[ldz];
+      len=wrd_bit_nbr-ldz_tbl[cod]-ctz;
+      sel_len=ctz > ctz_min;
+      sel_prv=cod == cod_prv;
+      hdr=sel_len ? (((uint64_t)(8+cod)) << len_bit_nbr) | (uint64_t)len : (sel_prv ? 2 : (uint64_t)(24+cod));
+      hdr_nbr=sel_len ? 5+len_bit_nbr : (sel_prv ? 2 : 5);
+      pld_nbr=sel_len ? len : wrd_bit_nbr-ldz_tbl[cod];
+      xr=sel_len ? xr >> ctz : xr;
+      cod=sel_len ? CCR_XDL_LDZ_INV : cod;
+      hdr=sel_zro ? 0 : hdr;
+      hdr_nbr=sel_zro ? 2 : hdr_nbr;
+      pld_nbr=sel_zro ? 0 : pld_nbr;
+      cod=sel_zro ? CCR_XDL_LDZ_INV : cod;
+      cod_prv=cod;
+      ccr_xdl_put(&wrt,hdr,hdr_nbr);
+      ccr_xdl_put(&wrt,xr,pld_nbr);
+    } /* !idx */
+  } /* !row_srt */
+
+  /* Pad last byte with zeros */
+  if(wrt.nbr > 0){
+    int byt_idx; /* [idx] Byte of accumulator */
+    wrt.acc<<=64-wrt.nbr;
+    for(byt_idx=0;byt_idx<(wrt.nbr+7)/8;byt_idx++) *wrt.ptr++=(unsigned char)(wrt.acc >> (56-8*byt_idx));
+  } /* !wrt.nbr */
+
+  return (size_t)(wrt.ptr-dst);
+} /* !ccr_xdl_enc() */
+
+static int /* O [flg] 1 for success, 0 if stream is corrupt */
+ccr_xdl_dec /* [fnc] Decode values from XOR residuals */
+(const size_t elm_nbr, /* I [nbr] Number of values */
+ const size_t row_nbr, /* I [nbr] Values per row */
+ const size_t datum_size, /* I [B] Bytes per value, 4 or 8 */
+ const unsigned char *src, /* I [B] Bit stream */
+ const size_t src_sz, /* I [B] Bytes in bit stream */
+ unsigned char *dst) /* O [val] Values */
+{
+  /* Purpose: Read residual of each value and XOR it with prediction
+     Streams that end early, hold impossible fields, or have bytes left over are corrupt */
+  const int wrd_bit_nbr=(int)(8*datum_size); /* [nbr] Bits per value */
+  const int len_bit_nbr=datum_size == 4 ? 5 : 6; /* [nbr] Bits of length field */
+  const int *ldz_tbl=datum_size == 4 ? ccr_xdl_ldz_tbl_flt : ccr_xdl_ldz_tbl_dbl; /* [nbr] Leading zeros of each code */
+  ccr_xdl_rd_t rd; /* [sct] Stream */
+  size_t idx;
+  size_t row_srt; /* [idx] First value of row */
+  size_t row_end; /* [idx] Value after last value of row */
+  uint32_t u32; /* [val] Single-precision value */
+  uint64_t fld; /* [bit] Flag, code, or length field */
+  uint64_t prd; /* [val] Prediction, i.e., previous value */
+  uint64_t xr; /* [bit] Residual */
+  int cod_prv=CCR_XDL_LDZ_INV; /* [enm] Leading-zero code of last residual coded with 10 or 11 */
+  int len; /* [nbr] Significant bits of residual */
+
+  /* Coder never writes empty rows */
+  if(row_nbr == 0 && elm_nbr > 0) return 0;
+
+  rd.ptr=src;
+  rd.end=src+src_sz;
+  rd.acc=0;
+  rd.nbr=0;
+  for(row_srt=0;row_srt<elm_nbr;row_srt+=row_nbr){
+    row_end=row_nbr < elm_nbr-row_srt ? row_srt+row_nbr : elm_nbr;
+    prd=0;
+    if(row_srt > 0){
+      if(datum_size == 4){
+	memcpy(&u32,dst+(row_srt-row_nbr)*4,4);
+	prd=u32;
+      }else{
+	memcpy(&prd,dst+(row_srt-row_nbr)*8,8);
+      } /* !datum_size */
+    } /* !row_srt */
+    for(idx=row_srt;idx<row_end;idx++){
+      if(!ccr_xdl_get(&rd,2,&fld)) return 0;
+      switch(fld){
+      case 0:
+	xr=0;
+	cod_prv=CCR_XDL_LDZ_INV;
+	break;
+      case 1:
+	if(!ccr_xdl_get(&rd,3+len_bit_nbr,&fld)) return 0;
+	len=(int)(fld & ((1U << len_bit_nbr)-1));
+	fld>>=len_bit_nbr;
+	if(len == 0 || ldz_tbl[fld]+len > wrd_bit_nbr) return 0;
+	if(!ccr_xdl_get_wide(&rd,len,&xr)) return 0;
+	xr<<=wrd_bit_nbr-ldz_tbl[fld]-len;
+	cod_prv=CCR_XDL_LDZ_INV;
+	break;
+      case 2:
+	if(cod_prv == CCR_XDL_LDZ_INV) return 0;
+	if(!ccr_xdl_get_wide(&rd,wrd_bit_nbr-ldz_tbl[cod_prv],&xr)) return 0;
+	break;
+      default:
+	if(!ccr_xdl_get(&rd,3,&fld)) return 0;
+	cod_prv=(int)fld;
+	if(!ccr_xdl_get_wide(&rd,wrd_bit_nbr-ldz_tbl[cod_prv],&xr)) return 0;
+	break;
+      } /* !fld */
+      prd^=xr;
+      if(datum_size == 4){
+	u32=(uint32_t)prd;
+	memcpy(dst+idx*4,&u32,4);
+      }else{
+	memcpy(dst+idx*8,&prd,8);
+      } /* !datum_size */
+    } /* !idx */
+  } /* !row_srt */
+
+  /* Only padding of last byte may remain */
+  return rd.ptr == rd.end && rd.nbr < 8;
+} /* !ccr_xdl_dec() */
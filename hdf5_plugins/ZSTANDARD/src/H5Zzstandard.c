@@ -45,6 +45,12 @@
 #if defined(_WIN32)
 #include <Winsock2.h>
 #endif
+#ifdef HAVE_PTHREAD_H
+# include <pthread.h> /* Thread-specific keys that own the per-thread context cache */
+#endif
+#ifdef HAVE_CLOCK_GETTIME
+# include <time.h> /* clock_gettime() times chunks for adaptive compression level */
+#endif
 
 /* 3rd party vendors */
 #include "H5PLextern.h" /* HDF5 Plugin Library: H5PLget_plugin_type(), H5PLget_plugin_info() */
@@ -55,8 +61,23 @@
 #define CCR_FLT_DBG_INFO 0 /* [flg] Print non-fatal debugging information */
 #define CCR_FLT_HELP "HINT: Read the description of Zstandard compression levels and their speed vs. compression-ratio tradeoffs at http://zstd.net"
 #define CCR_FLT_NAME "Zstandard filter for HDF5; http://www.zstd.net" /* [sng] Filter name in vernacular for HDF5 messages */
-#define CCR_FLT_PRM_NBR 1 /* [nbr] Number of parameters sent to filter (in cd_params array) */
+#define CCR_FLT_PRM_NBR 7 /* [nbr] Maximum number of scalar parameters sent to filter (in cd_params array), trailing parameters are optional, dictionary (if any) follows */
 #define CCR_FLT_PRM_PSN_CMP_LVL 0 /* [nbr] Ordinal position of CMP_LVL in parameter list (cd_params array) */
+#define CCR_FLT_PRM_PSN_WRK_NBR 1 /* [nbr] Ordinal position of WRK_NBR (ZSTD_c_nbWorkers) in parameter list (cd_params array) */
+#define CCR_FLT_PRM_PSN_DCT_SZ 2 /* [nbr] Ordinal position of DCT_SZ (dictionary size in bytes, 0 for none) in parameter list (cd_params array), dictionary occupies last (DCT_SZ+3)/4 parameters, packed four bytes per parameter, least significant byte first */
+#define CCR_FLT_PRM_PSN_WND_LOG 3 /* [nbr] Ordinal position of WND_LOG (ZSTD_c_windowLog, 0 for level default) in parameter list (cd_params array) */
+#define CCR_FLT_PRM_PSN_LDM_FLG 4 /* [nbr] Ordinal position of LDM_FLG (ZSTD_c_enableLongDistanceMatching) in parameter list (cd_params array) */
+#define CCR_FLT_PRM_PSN_STG 5 /* [nbr] Ordinal position of STG (ZSTD_c_strategy, 0 for level default) in parameter list (cd_params array) */
+#define CCR_FLT_PRM_PSN_TPT_TRG 6 /* [nbr] Ordinal position of TPT_TRG (target compression throughput in MB/s, 0 for fixed CMP_LVL) in parameter list (cd_params array) */
+#define CCR_FLT_DCT_SZ_MAX 32768 /* [B] Maximum dictionary size, keeps filter pipeline message well below 64 kB HDF5 object header message limit */
+#define CCR_FLT_ADP_LVL_MIN -64 /* [enm] Lowest (fastest) level adaptive mode may choose, more negative levels gain little speed and much ratio */
+#define CCR_FLT_ADP_LVL_MAX 19 /* [enm] Highest level adaptive mode may choose, "ultra" levels need far more memory */
+#define CCR_FLT_ADP_TM_MIN 0.01 /* [s] Minimum time measured before adaptive mode changes level, smooths timer noise on small chunks */
+#define CCR_FLT_ADP_HYS 1.25 /* [frc] Adaptive mode raises level only when throughput exceeds target by this factor, damps oscillation */
+#define CCR_FLT_ADP_MGC 0x184D2A5CU /* [enm] Magic number of skippable frame that records level used for each chunk (ZSTD_MAGIC_SKIPPABLE_START+0xC) */
+#define CCR_FLT_ADP_FRM_SZ 16 /* [B] Size of skippable frame: magic, payload size, level, measured throughput in MB/s */
+#define CCR_FLT_STM_SZ_MIN 1048576 /* [B] Chunks at least this large compress as a stream into a growing buffer */
+#define CCR_FLT_STM_BFR_SZ 131072 /* [B] Minimum growth of streaming output buffers, about ZSTD_CStreamOutSize() */
 
 /* Forward-declare functions before their names appear in H5Z_class2_t filter structure */
 size_t /* O [B] Number of bytes processed from input buffer (?) */
@@ -83,6 +104,374 @@ const H5Z_class2_t H5Z_ZSTANDARD[1]={{
     (H5Z_func_t)H5Z_filter_zstandard, /* [fnc] Function to implement filter */
   }}; /* !H5Z_ZSTANDARD */
 
+/* Per-thread cache of Zstandard contexts
+   ZSTD_compress() and ZSTD_decompress() allocate and free a full context on every chunk, which dominates the time to filter many small chunks, especially at high compression levels
+   Each thread instead keeps one ZSTD_CCtx and one ZSTD_DCtx, created on first use and reset before each chunk
+   Contexts are owned by a thread-specific key, so they are freed when their thread exits
+   A mutex-protected list also holds every live cache, so unloading the plugin frees the caches of threads that are still running
+   Digested dictionaries are cached alongside the contexts and rebuilt only when a chunk brings a different dictionary (or, for compression, level)
+   Without POSIX threads the filter falls back to one-shot (context-per-chunk) calls */
+#ifdef HAVE_PTHREAD_H
+typedef struct ccr_zst_ctx_sct_tag{ /* ccr_zst_ctx_sct */
+  ZSTD_CCtx *cctx; /* [ptr] Compression context */
+  ZSTD_DCtx *dctx; /* [ptr] Decompression context */
+  unsigned int *dct_prm; /* [ptr] Packed dictionary that cdct and ddct were digested from */
+  size_t dct_sz; /* [B] Size of dictionary in dct_prm */
+  ZSTD_CDict *cdct; /* [ptr] Digested compression dictionary */
+  int cdct_lvl; /* [enm] Compression level cdct was digested for */
+  ZSTD_DDict *ddct; /* [ptr] Digested decompression dictionary */
+  unsigned int adp_tpt_trg; /* [MB/s] Target throughput adaptive level is tracking, 0 before first adaptive chunk */
+  int adp_lvl_srt; /* [enm] Level adaptive mode started from */
+  int adp_lvl; /* [enm] Level adaptive mode uses for next chunk */
+  double adp_byt; /* [B] Bytes compressed since level last changed or was confirmed */
+  double adp_tm; /* [s] Time spent compressing adp_byt */
+  struct ccr_zst_ctx_sct_tag *nxt; /* [ptr] Next live cache in ccr_zst_lst */
+} ccr_zst_ctx_sct;
+
+static pthread_key_t ccr_zst_key; /* [key] Thread-specific key that owns each thread's ccr_zst_ctx_sct */
+static pthread_once_t ccr_zst_once=PTHREAD_ONCE_INIT; /* [flg] Guards one-time creation of ccr_zst_key */
+static int ccr_zst_key_ok=0; /* [flg] ccr_zst_key was successfully created */
+static pthread_mutex_t ccr_zst_mtx=PTHREAD_MUTEX_INITIALIZER; /* [mtx] Guards ccr_zst_lst */
+static ccr_zst_ctx_sct *ccr_zst_lst=NULL; /* [ptr] Every live context cache, of all threads */
+
+static void
+ccr_zst_ctx_free /* [fnc] Free one context cache */
+(ccr_zst_ctx_sct *ctx) /* I [ptr] Context cache, already removed from ccr_zst_lst */
+{
+  if(!ctx) return;
+  if(ctx->cctx) (void)ZSTD_freeCCtx(ctx->cctx);
+  if(ctx->dctx) (void)ZSTD_freeDCtx(ctx->dctx);
+  if(ctx->cdct) (void)ZSTD_freeCDict(ctx->cdct);
+  if(ctx->ddct) (void)ZSTD_freeDDict(ctx->ddct);
+  if(ctx->dct_prm) free(ctx->dct_prm);
+  free(ctx);
+} /* !ccr_zst_ctx_free() */
+
+static void
+ccr_zst_ctx_dtr /* [fnc] Unlist and free exiting thread's context cache */
+(void *ctx_vd) /* I [ptr] Context cache (ccr_zst_ctx_sct *) */
+{
+  /* Purpose: Destructor of ccr_zst_key, called as each thread that used the filter exits
+     Free cache only if still listed, since ccr_zst_fin() may have freed it already */
+  ccr_zst_ctx_sct **lnk; /* [ptr] Link that points at ctx */
+  int fnd=0; /* [flg] ctx was listed */
+
+  (void)pthread_mutex_lock(&ccr_zst_mtx);
+  for(lnk=&ccr_zst_lst;*lnk;lnk=&(*lnk)->nxt){
+    if(*lnk == (ccr_zst_ctx_sct *)ctx_vd){
+      *lnk=(*lnk)->nxt;
+      fnd=1;
+      break;
+    } /* !ctx_vd */
+  } /* !lnk */
+  (void)pthread_mutex_unlock(&ccr_zst_mtx);
+  if(fnd) ccr_zst_ctx_free((ccr_zst_ctx_sct *)ctx_vd);
+} /* !ccr_zst_ctx_dtr() */
+
+static void
+ccr_zst_key_mk /* [fnc] Create thread-specific key for context cache */
+(void)
+{
+  /* Purpose: Run once per process by pthread_once() */
+  if(!pthread_key_create(&ccr_zst_key,ccr_zst_ctx_dtr)) ccr_zst_key_ok=1;
+} /* !ccr_zst_key_mk() */
+
+static ccr_zst_ctx_sct * /* O [ptr] Calling thread's context cache, or NULL if unavailable */
+ccr_zst_ctx_get /* [fnc] Return calling thread's context cache, creating it if needed */
+(void)
+{
+  /* Purpose: Find (or create) the context cache owned by the calling thread
+     NULL tells caller to use one-shot API instead */
+  ccr_zst_ctx_sct *ctx;
+
+  (void)pthread_once(&ccr_zst_once,ccr_zst_key_mk);
+  if(!ccr_zst_key_ok) return NULL;
+  ctx=(ccr_zst_ctx_sct *)pthread_getspecific(ccr_zst_key);
+  if(ctx) return ctx;
+  if(!(ctx=(ccr_zst_ctx_sct *)calloc(1,sizeof(ccr_zst_ctx_sct)))) return NULL;
+  if(pthread_setspecific(ccr_zst_key,ctx)){
+    free(ctx);
+    return NULL;
+  } /* !pthread_setspecific() */
+  (void)pthread_mutex_lock(&ccr_zst_mtx);
+  ctx->nxt=ccr_zst_lst;
+  ccr_zst_lst=ctx;
+  (void)pthread_mutex_unlock(&ccr_zst_mtx);
+  return ctx;
+} /* !ccr_zst_ctx_get() */
+
+static int /* O [rcd] Return code, 0 on success */
+ccr_zst_dct_sync /* [fnc] Point context cache at dictionary, dropping digests of any other dictionary */
+(ccr_zst_ctx_sct *ctx, /* I/O [ptr] Calling thread's context cache */
+ const unsigned int *dct_prm, /* I [ptr] Packed dictionary from filter parameters */
+ size_t dct_sz) /* I [B] Dictionary size */
+{
+  /* Purpose: Invalidate cached digests unless they were made from this exact dictionary
+     Comparing packed dictionaries costs far less than digesting one */
+  const size_t dct_prm_sz=((dct_sz+3)/4)*sizeof(unsigned int); /* [B] Size of packed dictionary */
+
+  if(ctx->dct_prm && ctx->dct_sz == dct_sz && !memcmp(ctx->dct_prm,dct_prm,dct_prm_sz)) return 0;
+  if(ctx->cdct) (void)ZSTD_freeCDict(ctx->cdct);
+  if(ctx->ddct) (void)ZSTD_freeDDict(ctx->ddct);
+  if(ctx->dct_prm) free(ctx->dct_prm);
+  ctx->cdct=NULL;
+  ctx->ddct=NULL;
+  ctx->dct_sz=0;
+  if(!(ctx->dct_prm=(unsigned int *)malloc(dct_prm_sz))) return 1;
+  memcpy(ctx->dct_prm,dct_prm,dct_prm_sz);
+  ctx->dct_sz=dct_sz;
+  return 0;
+} /* !ccr_zst_dct_sync() */
+#endif /* !HAVE_PTHREAD_H */
+
+static void *
+ccr_zst_dct_unpack /* [fnc] Unpack dictionary from filter parameters */
+(const unsigned int *dct_prm, /* I [ptr] Packed dictionary from filter parameters */
+ size_t dct_sz) /* I [B] Dictionary size */
+{
+  /* Purpose: Return malloc()'d dictionary bytes, or NULL on failure
+     Bytes are packed least significant first, so dictionaries survive files moving between hosts of different endianness */
+  unsigned char *dct; /* [ptr] Dictionary */
+  size_t idx; /* [idx] Byte index */
+
+  if(!(dct=(unsigned char *)malloc(dct_sz))) return NULL;
+  for(idx=0;idx<dct_sz;idx++) dct[idx]=(unsigned char)(dct_prm[idx/4] >> (8*(idx%4)));
+  return dct;
+} /* !ccr_zst_dct_unpack() */
+
+static double /* O [s] Monotonic time, or negative if unavailable */
+ccr_zst_tm_get /* [fnc] Return monotonic time for timing chunks */
+(void)
+{
+#ifdef HAVE_CLOCK_GETTIME
+  struct timespec tms; /* [sct] Time */
+  if(!clock_gettime(CLOCK_MONOTONIC,&tms)) return (double)tms.tv_sec+1.0e-9*(double)tms.tv_nsec;
+#endif /* !HAVE_CLOCK_GETTIME */
+  return -1.0;
+} /* !ccr_zst_tm_get() */
+
+static void
+ccr_zst_u32_put /* [fnc] Store 32-bit value least significant byte first */
+(unsigned char *bfr, /* O [ptr] Destination */
+ unsigned int val) /* I [nbr] Value */
+{
+  int idx; /* [idx] Byte index */
+  for(idx=0;idx<4;idx++) bfr[idx]=(unsigned char)(val >> (8*idx));
+} /* !ccr_zst_u32_put() */
+
+#ifdef HAVE_ZSTD_ADVANCED_API
+/* Streaming mode
+   Single-pass compression needs an output buffer of ZSTD_compressBound() bytes, larger than the chunk itself, and single-pass decompression needs the content size recorded in the frame header
+   Streaming instead bounds extra memory by Zstandard's window-sized internal buffers, grows output buffers only as data are produced, and decodes frames written without a content size (e.g., by other streaming writers)
+   Helpers return (size_t)-1, i.e., ZSTD_error_GENERIC, when an output buffer cannot grow, so callers test all failures with ZSTD_isError() */
+static size_t /* O [B] Compressed size, or Zstandard error code */
+ccr_zst_cmp_stm /* [fnc] Compress buffer as a stream into output buffer that grows as needed */
+(ZSTD_CCtx *cctx, /* I/O [ptr] Compression context with parameters and dictionary already set */
+ const void *bfr_in, /* I [ptr] Input buffer */
+ size_t bfr_sz_in, /* I [B] Size of input buffer */
+ void **bfr_out, /* I/O [ptr] Output buffer, may be reallocated */
+ size_t *bfr_sz_out, /* I/O [B] Size of output buffer */
+ size_t bfr_sz_max) /* I [B] Size output buffer need never exceed */
+{
+  ZSTD_inBuffer in; /* [sct] Input position */
+  ZSTD_outBuffer out; /* [sct] Output position */
+  size_t rcd; /* [B] Bytes left to flush, or error code */
+  size_t sz_new; /* [B] Size of grown output buffer */
+  void *bfr_new; /* [ptr] Grown output buffer */
+
+  in.src=bfr_in;
+  in.size=bfr_sz_in;
+  in.pos=0;
+  out.dst=*bfr_out;
+  out.size=*bfr_sz_out;
+  out.pos=0;
+  /* Frame header records content size, so single-pass readers can still size their buffers */
+  (void)ZSTD_CCtx_setPledgedSrcSize(cctx,bfr_sz_in);
+  for(;;){
+    rcd=ZSTD_compressStream2(cctx,&out,&in,ZSTD_e_end);
+    if(ZSTD_isError(rcd) || rcd == 0) break;
+    if(out.pos < out.size) continue;
+    /* Output buffer is full, so grow it by half */
+    sz_new=out.size+out.size/2+CCR_FLT_STM_BFR_SZ;
+    if(sz_new > bfr_sz_max) sz_new=bfr_sz_max;
+    if(sz_new <= out.size) return (size_t)-1;
+    if(!(bfr_new=realloc(out.dst,sz_new))) return (size_t)-1;
+    *bfr_out=out.dst=bfr_new;
+    *bfr_sz_out=out.size=sz_new;
+  } /* !rcd */
+  if(ZSTD_isError(rcd)) return rcd;
+  return out.pos;
+} /* !ccr_zst_cmp_stm() */
+
+static size_t /* O [B] Decompressed size, or Zstandard error code */
+ccr_zst_dcmp_stm /* [fnc] Decompress buffer as a stream into output buffer that grows as needed */
+(ZSTD_DCtx *dctx, /* I/O [ptr] Decompression context with parameters and dictionary already set */
+ const void *bfr_in, /* I [ptr] Input buffer */
+ size_t bfr_sz_in, /* I [B] Size of input buffer */
+ void **bfr_out, /* I/O [ptr] Output buffer, may be reallocated */
+ size_t *bfr_sz_out) /* I/O [B] Size of output buffer */
+{
+  ZSTD_inBuffer in; /* [sct] Input position */
+  ZSTD_outBuffer out; /* [sct] Output position */
+  size_t rcd=0; /* [B] Hint of input still needed to finish frame, or error code */
+  size_t sz_new; /* [B] Size of grown output buffer */
+  void *bfr_new; /* [ptr] Grown output buffer */
+
+  in.src=bfr_in;
+  in.size=bfr_sz_in;
+  in.pos=0;
+  out.dst=*bfr_out;
+  out.size=*bfr_sz_out;
+  out.pos=0;
+  for(;;){
+    if(out.pos == out.size){
+      /* Output buffer is full, so double it */
+      sz_new=2*out.size+CCR_FLT_STM_BFR_SZ;
+      if(sz_new <= out.size) return (size_t)-1;
+      if(!(bfr_new=realloc(out.dst,sz_new))) return (size_t)-1;
+      *bfr_out=out.dst=bfr_new;
+      *bfr_sz_out=out.size=sz_new;
+    } /* !out.pos */
+    /* Frames follow one another, and skippable frames produce no output */
+    rcd=ZSTD_decompressStream(dctx,&out,&in);
+    if(ZSTD_isError(rcd)) return rcd;
+    if(in.pos == in.size && out.pos < out.size) break;
+  } /* !in.pos */
+  /* Input ended mid-frame */
+  if(rcd != 0) return (size_t)-1;
+  return out.pos;
+} /* !ccr_zst_dcmp_stm() */
+#endif /* !HAVE_ZSTD_ADVANCED_API */
+
+#ifdef HAVE_PTHREAD_H
+static ZSTD_CDict * /* O [ptr] Digested compression dictionary, or NULL on failure */
+ccr_zst_cdct_get /* [fnc] Return calling thread's compression dictionary, digesting it if needed */
+(ccr_zst_ctx_sct *ctx, /* I/O [ptr] Calling thread's context cache */
+ const unsigned int *dct_prm, /* I [ptr] Packed dictionary from filter parameters */
+ size_t dct_sz, /* I [B] Dictionary size */
+ int cmp_lvl) /* I [enm] Compression level */
+{
+  void *dct; /* [ptr] Unpacked dictionary */
+
+  if(ccr_zst_dct_sync(ctx,dct_prm,dct_sz)) return NULL;
+  if(ctx->cdct && ctx->cdct_lvl == cmp_lvl) return ctx->cdct;
+  if(ctx->cdct) (void)ZSTD_freeCDict(ctx->cdct);
+  ctx->cdct=NULL;
+  if(!(dct=ccr_zst_dct_unpack(dct_prm,dct_sz))) return NULL;
+  ctx->cdct=ZSTD_createCDict(dct,dct_sz,cmp_lvl);
+  ctx->cdct_lvl=cmp_lvl;
+  free(dct);
+  return ctx->cdct;
+} /* !ccr_zst_cdct_get() */
+
+static ZSTD_DDict * /* O [ptr] Digested decompression dictionary, or NULL on failure */
+ccr_zst_ddct_get /* [fnc] Return calling thread's decompression dictionary, digesting it if needed */
+(ccr_zst_ctx_sct *ctx, /* I/O [ptr] Calling thread's context cache */
+ const unsigned int *dct_prm, /* I [ptr] Packed dictionary from filter parameters */
+ size_t dct_sz) /* I [B] Dictionary size */
+{
+  void *dct; /* [ptr] Unpacked dictionary */
+
+  if(ccr_zst_dct_sync(ctx,dct_prm,dct_sz)) return NULL;
+  if(ctx->ddct) return ctx->ddct;
+  if(!(dct=ccr_zst_dct_unpack(dct_prm,dct_sz))) return NULL;
+  ctx->ddct=ZSTD_createDDict(dct,dct_sz);
+  free(dct);
+  return ctx->ddct;
+} /* !ccr_zst_ddct_get() */
+
+/* Adaptive compression level
+   Users give a target write throughput rather than a level, since model output rates change during a run and a fixed level either stalls the model or wastes disk
+   Each thread times its own compression and steps the level down (into negative levels) when slower than the target, and up when comfortably faster
+   State lives in the thread's context cache, so variables that share a target and starting level on one thread share one controller */
+static int /* O [enm] Next faster level */
+ccr_zst_adp_lvl_dcr /* [fnc] Step adaptive level down */
+(int lvl) /* I [enm] Current level */
+{
+  /* Level 0 means ZSTD_CLEVEL_DEFAULT so it is skipped, negative levels step geometrically since each gains less */
+  if(lvl > 1) return lvl-1;
+  if(lvl == 1) return -1;
+  return 2*lvl;
+} /* !ccr_zst_adp_lvl_dcr() */
+
+static int /* O [enm] Next slower level */
+ccr_zst_adp_lvl_ncr /* [fnc] Step adaptive level up */
+(int lvl) /* I [enm] Current level */
+{
+  if(lvl < -1) return lvl/2;
+  if(lvl == -1) return 1;
+  return lvl+1;
+} /* !ccr_zst_adp_lvl_ncr() */
+
+static int /* O [enm] Level to compress next chunk with */
+ccr_zst_adp_lvl_get /* [fnc] Return adaptive level for calling thread's next chunk */
+(ccr_zst_ctx_sct *ctx, /* I/O [ptr] Calling thread's context cache */
+ unsigned int tpt_trg, /* I [MB/s] Target throughput */
+ int lvl_srt) /* I [enm] Starting level */
+{
+  /* Restart controller when thread switches to a variable with other settings */
+  if(ctx->adp_tpt_trg != tpt_trg || ctx->adp_lvl_srt != lvl_srt){
+    ctx->adp_tpt_trg=tpt_trg;
+    ctx->adp_lvl_srt=lvl_srt;
+    ctx->adp_lvl=lvl_srt;
+    ctx->adp_byt=0.0;
+    ctx->adp_tm=0.0;
+  } /* !adp_tpt_trg */
+  return ctx->adp_lvl;
+} /* !ccr_zst_adp_lvl_get() */
+
+static void
+ccr_zst_adp_lvl_upd /* [fnc] Update adaptive level with time taken by one chunk */
+(ccr_zst_ctx_sct *ctx, /* I/O [ptr] Calling thread's context cache */
+ double byt, /* I [B] Bytes compressed */
+ double tm, /* I [s] Time taken */
+ int lvl_min, /* I [enm] Lowest level library supports */
+ int lvl_max) /* I [enm] Highest level library supports */
+{
+  double tpt; /* [MB/s] Measured throughput */
+  int lvl; /* [enm] Candidate level */
+
+  ctx->adp_byt+=byt;
+  ctx->adp_tm+=tm;
+  if(ctx->adp_tm < CCR_FLT_ADP_TM_MIN) return;
+  tpt=ctx->adp_byt/ctx->adp_tm/1.0e6;
+  lvl=ctx->adp_lvl;
+  if(tpt < ctx->adp_tpt_trg) lvl=ccr_zst_adp_lvl_dcr(lvl);
+  else if(tpt > CCR_FLT_ADP_HYS*ctx->adp_tpt_trg) lvl=ccr_zst_adp_lvl_ncr(lvl);
+  /* Stay within limits adaptive mode can usefully reach */
+  if(lvl < CCR_FLT_ADP_LVL_MIN) lvl=CCR_FLT_ADP_LVL_MIN;
+  if(lvl > CCR_FLT_ADP_LVL_MAX) lvl=CCR_FLT_ADP_LVL_MAX;
+  if(lvl < lvl_min) lvl=lvl_min;
+  if(lvl > lvl_max) lvl=lvl_max;
+  if(CCR_FLT_DBG_INFO && lvl != ctx->adp_lvl) (void)fprintf(stderr,"INFO: ccr_zst_adp_lvl_upd() reports throughput = %g MB/s, target = %u MB/s, changing level from %d to %d\n",tpt,ctx->adp_tpt_trg,ctx->adp_lvl,lvl);
+  ctx->adp_lvl=lvl;
+  ctx->adp_byt=0.0;
+  ctx->adp_tm=0.0;
+} /* !ccr_zst_adp_lvl_upd() */
+
+#if defined(__GNUC__) || defined(__clang__)
+static void ccr_zst_fin(void) __attribute__((destructor));
+#endif /* !__GNUC__ */
+static void
+ccr_zst_fin /* [fnc] Release context caches of all threads when plugin is unloaded */
+(void)
+{
+  /* Purpose: Delete ccr_zst_key, then free the context caches of all threads
+     Deleting the key first keeps threads that outlive the plugin from calling ccr_zst_ctx_dtr() after its code is unmapped */
+  ccr_zst_ctx_sct *ctx; /* [ptr] Cache being freed */
+
+  if(!ccr_zst_key_ok) return;
+  (void)pthread_key_delete(ccr_zst_key);
+  ccr_zst_key_ok=0;
+  (void)pthread_mutex_lock(&ccr_zst_mtx);
+  while((ctx=ccr_zst_lst)){
+    ccr_zst_lst=ctx->nxt;
+    ccr_zst_ctx_free(ctx);
+  } /* !ctx */
+  (void)pthread_mutex_unlock(&ccr_zst_mtx);
+} /* !ccr_zst_fin() */
+#endif /* !HAVE_PTHREAD_H */
+
 /* Function definitions */
 H5PL_type_t /* O [enm] Plugin type */
 H5PLget_plugin_type /* [fnc] Provide plug-in type provided by this shared library */
@@ -114,21 +503,55 @@ H5Z_filter_zstandard /* [fnc] HDF5 Zstandard Filter */
   const char fnc_nm[]="H5Z_filter_zstandard()"; /* [sng] Function name */
 
   size_t rvl; /* O [B] Return value = number of bytes resulting after forward/reverse filter applied */
+  size_t bfr_sz_alc; /* [B] Size allocated for output buffer */
   
   void *bfr_in=NULL; /* [ptr] Pointer to input buffer (before forward/reverse filter) */
   void *bfr_out=NULL; /* [ptr] Pointer to output buffer (after forward/reverse filter) */
+  void *dct=NULL; /* [ptr] Unpacked dictionary, when no cached digest is available */
+
+  const unsigned int *dct_prm=NULL; /* [ptr] Packed dictionary in filter parameters */
+  size_t dct_sz=0; /* [B] Dictionary size, 0 for no dictionary */
+  size_t prm_nbr=cd_nelmts; /* [nbr] Number of scalar parameters, i.e., those before dictionary */
+  int wnd_log=0; /* [nbr] Base-2 logarithm of window size (ZSTD_c_windowLog), 0 for level default */
+
+  ZSTD_CCtx *cctx_tmp=NULL; /* [ptr] Compression context owned by this call, if thread has no cache */
+  ZSTD_DCtx *dctx_tmp=NULL; /* [ptr] Decompression context owned by this call, if thread has no cache */
+#ifdef HAVE_PTHREAD_H
+  ccr_zst_ctx_sct *ctx=ccr_zst_ctx_get(); /* [ptr] Calling thread's context cache */
+#endif /* !HAVE_PTHREAD_H */
 
   /* Save original input buffer */
   bfr_in=*bfr_inout;
   
-  /* 20200915 fxm compress/decompress in streaming mode to handle larger buffers? */
+  /* Files written before DCT_SZ existed store no dictionary
+     Dictionary trails scalar parameters, so files with fewer scalars than CCR_FLT_PRM_NBR still locate it */
+  if(cd_nelmts > CCR_FLT_PRM_PSN_DCT_SZ) dct_sz=cd_values[CCR_FLT_PRM_PSN_DCT_SZ];
+  if(dct_sz > 0){
+    if(dct_sz > CCR_FLT_DCT_SZ_MAX || cd_nelmts < CCR_FLT_PRM_PSN_DCT_SZ+1+(dct_sz+3)/4){
+      (void)fprintf(stderr,"ERROR: \"%s\" filter function %s reports dictionary size = %lu B does not fit %lu filter parameters\n",CCR_FLT_NAME,fnc_nm,(unsigned long)dct_sz,(unsigned long)cd_nelmts);
+      goto error;
+    } /* !dct_sz */
+    prm_nbr=cd_nelmts-(dct_sz+3)/4;
+    dct_prm=cd_values+prm_nbr;
+  } /* !dct_sz */
+
+  /* Readers need WND_LOG too, since frames with windows beyond ZSTD_WINDOWLOG_LIMIT_DEFAULT require a larger ZSTD_d_windowLogMax */
+  if(prm_nbr > CCR_FLT_PRM_PSN_WND_LOG) wnd_log=(int)cd_values[CCR_FLT_PRM_PSN_WND_LOG];
 
   if(flags & H5Z_FLAG_REVERSE){
 
     size_t dcmp_sz; /* [B] Actual decompressed size of source frame content, if known, otherwise error code */
     size_t dcmp_sz_max; /* [B] Decompressed size of source frame content, if known, otherwise error code */
+    int stm_flg=0; /* [flg] Frame lacks content size, so decompress as a stream */
 #ifdef HAVE_ZSTD_GETFRAMECONTENTSIZE
     dcmp_sz_max=ZSTD_getFrameContentSize(*bfr_inout,bfr_sz_in);
+# ifdef HAVE_ZSTD_ADVANCED_API
+    /* Streaming writers may not know, and so omit, content size, so start with a guess and grow it */
+    if(dcmp_sz_max == ZSTD_CONTENTSIZE_UNKNOWN){
+      stm_flg=1;
+      dcmp_sz_max=bfr_sz_in < CCR_FLT_STM_BFR_SZ/4 ? CCR_FLT_STM_BFR_SZ : 4*bfr_sz_in;
+    } /* !ZSTD_CONTENTSIZE_UNKNOWN */
+# endif /* !HAVE_ZSTD_ADVANCED_API */
 #else  /* !HAVE_ZSTD_GETFRAMECONTENTSIZE */
     /* 20200920: Zstandard 1.3.1 distributed with Ubuntu Xenial 16.04 LTS lacks ZSTD_getFrameContentSize() */
     dcmp_sz_max=ZSTD_getDecompressedSize(*bfr_inout,bfr_sz_in);
@@ -143,14 +566,54 @@ H5Z_filter_zstandard /* [fnc] HDF5 Zstandard Filter */
       goto error;
     } /* !bfr_out */
 
-    /* Decompress the input buffer */
-    dcmp_sz=ZSTD_decompress(bfr_out,dcmp_sz_max,bfr_in,bfr_sz_in);
+    /* Decompress the input buffer, re-using this thread's context and dictionary when possible */
+    ZSTD_DCtx *dctx=NULL; /* [ptr] Decompression context */
+    ZSTD_DDict *ddct=NULL; /* [ptr] Digested decompression dictionary */
+#ifdef HAVE_PTHREAD_H
+    if(ctx && !ctx->dctx) ctx->dctx=ZSTD_createDCtx();
+    if(ctx) dctx=ctx->dctx;
+    if(ctx && dct_sz > 0) ddct=ccr_zst_ddct_get(ctx,dct_prm,dct_sz);
+#endif /* !HAVE_PTHREAD_H */
+    /* Streams need a context */
+    if(!dctx && stm_flg) dctx=dctx_tmp=ZSTD_createDCtx();
+    if(stm_flg && !dctx){
+      (void)fprintf(stderr,"ERROR: \"%s\" filter function %s reports failure to create decompression context\n",CCR_FLT_NAME,fnc_nm);
+      goto error;
+    } /* !dctx */
+    if(dct_sz > 0){
+      /* Dictionaries need a context, and an undigested dictionary if none is cached */
+      if(!dctx) dctx=dctx_tmp=ZSTD_createDCtx();
+      if(!ddct) dct=ccr_zst_dct_unpack(dct_prm,dct_sz);
+      if(!dctx || (!ddct && !dct)){
+	(void)fprintf(stderr,"ERROR: \"%s\" filter function %s reports failure to allocate dictionary of dct_sz = %lu B\n",CCR_FLT_NAME,fnc_nm,(unsigned long)dct_sz);
+	goto error;
+      } /* !dctx */
+    } /* !dct_sz */
+    if(dctx){
+#ifdef HAVE_ZSTD_CTX_RESET
+      (void)ZSTD_DCtx_reset(dctx,ZSTD_reset_session_and_parameters);
+#endif /* !HAVE_ZSTD_CTX_RESET */
+#ifdef HAVE_ZSTD_ADVANCED_API
+      if(wnd_log > 0) (void)ZSTD_DCtx_setParameter(dctx,ZSTD_d_windowLogMax,wnd_log);
+      if(stm_flg){
+	if(ddct) (void)ZSTD_DCtx_refDDict(dctx,ddct);
+	else if(dct) (void)ZSTD_DCtx_loadDictionary(dctx,dct,dct_sz);
+	dcmp_sz=ccr_zst_dcmp_stm(dctx,bfr_in,bfr_sz_in,&bfr_out,&dcmp_sz_max);
+      }else
+#endif /* !HAVE_ZSTD_ADVANCED_API */
+      if(ddct) dcmp_sz=ZSTD_decompress_usingDDict(dctx,bfr_out,dcmp_sz_max,bfr_in,bfr_sz_in,ddct);
+      else if(dct) dcmp_sz=ZSTD_decompress_usingDict(dctx,bfr_out,dcmp_sz_max,bfr_in,bfr_sz_in,dct,dct_sz);
+      else dcmp_sz=ZSTD_decompressDCtx(dctx,bfr_out,dcmp_sz_max,bfr_in,bfr_sz_in);
+    }else{
+      dcmp_sz=ZSTD_decompress(bfr_out,dcmp_sz_max,bfr_in,bfr_sz_in);
+    } /* !dctx */
     if(ZSTD_isError(dcmp_sz)){
       (void)fprintf(stderr,"ERROR: \"%s\" filter function %s reports error return code = %lu from ZSTD_decompress()\n",CCR_FLT_NAME,fnc_nm,dcmp_sz);
       goto error;
     } /* !dcmp_sz */
     /* Return number of bytes in compressed buffer */
     rvl=dcmp_sz;
+    bfr_sz_alc=dcmp_sz_max;
     
   }else{ /* !flags */
     
@@ -181,6 +644,23 @@ H5Z_filter_zstandard /* [fnc] HDF5 Zstandard Filter */
 
     /* NB: <zstd.h> sets ZSTD_CLEVEL_DEFAULT == 3 */
     if(cd_nelmts > 0) cmp_lvl=(int)cd_values[CCR_FLT_PRM_PSN_CMP_LVL]; else cmp_lvl=ZSTD_CLEVEL_DEFAULT;
+
+    /* Files written before WRK_NBR existed store only CMP_LVL, and compress on calling thread */
+    int wrk_nbr; /* [nbr] Number of worker threads (ZSTD_c_nbWorkers), 0 compresses on calling thread */
+    if(prm_nbr > CCR_FLT_PRM_PSN_WRK_NBR) wrk_nbr=(int)cd_values[CCR_FLT_PRM_PSN_WRK_NBR]; else wrk_nbr=0;
+
+    /* Files written before LDM_FLG and STG existed use level defaults */
+    int ldm_flg; /* [flg] Enable long-distance matching (ZSTD_c_enableLongDistanceMatching) */
+    int stg; /* [enm] Strategy (ZSTD_c_strategy), 0 for level default */
+    if(prm_nbr > CCR_FLT_PRM_PSN_LDM_FLG) ldm_flg=(int)cd_values[CCR_FLT_PRM_PSN_LDM_FLG]; else ldm_flg=0;
+    if(prm_nbr > CCR_FLT_PRM_PSN_STG) stg=(int)cd_values[CCR_FLT_PRM_PSN_STG]; else stg=0;
+
+    /* Files written before TPT_TRG existed use fixed CMP_LVL */
+    unsigned int tpt_trg; /* [MB/s] Target compression throughput, 0 for fixed level */
+    if(prm_nbr > CCR_FLT_PRM_PSN_TPT_TRG) tpt_trg=cd_values[CCR_FLT_PRM_PSN_TPT_TRG]; else tpt_trg=0;
+
+    /* Worker threads, window, long-distance matching, and strategy all need advanced API */
+    const int adv_flg=(wrk_nbr > 0 || wnd_log > 0 || ldm_flg || stg > 0); /* [flg] Advanced parameters requested */
     if(cmp_lvl < cmp_lvl_min){
       (void)fprintf(stderr,"WARNING: \"%s\" filter function %s must adjust actual compression level from user-requested value of %d to minimum Zstandard-supported compression level = %d\n",CCR_FLT_NAME,fnc_nm,cmp_lvl,cmp_lvl_min);
       (void)fprintf(stderr,"%s\n",CCR_FLT_HELP);
@@ -192,7 +672,17 @@ H5Z_filter_zstandard /* [fnc] HDF5 Zstandard Filter */
       cmp_lvl=cmp_lvl_max;
     } /* !cmp_lvl */
     
-    if(CCR_FLT_DBG_INFO) (void)fprintf(stderr,"INFO: %s reports cmp_lvl = %d, cmp_lvl_min = %d, cmp_lvl_max = %d\n",fnc_nm,cmp_lvl,cmp_lvl_min,cmp_lvl_max);
+    /* Adaptive mode starts from CMP_LVL
+       Threads without a context cache, or hosts without a monotonic clock, keep CMP_LVL */
+    double tm_srt=-1.0; /* [s] Time compression started, negative if not timed */
+    if(tpt_trg > 0){
+      if(cmp_lvl == 0) cmp_lvl=ZSTD_CLEVEL_DEFAULT;
+#ifdef HAVE_PTHREAD_H
+      if(ctx) cmp_lvl=ccr_zst_adp_lvl_get(ctx,tpt_trg,cmp_lvl);
+#endif /* !HAVE_PTHREAD_H */
+    } /* !tpt_trg */
+
+    if(CCR_FLT_DBG_INFO) (void)fprintf(stderr,"INFO: %s reports cmp_lvl = %d, cmp_lvl_min = %d, cmp_lvl_max = %d, wrk_nbr = %d, wnd_log = %d, ldm_flg = %d, stg = %d, tpt_trg = %u\n",fnc_nm,cmp_lvl,cmp_lvl_min,cmp_lvl_max,wrk_nbr,wnd_log,ldm_flg,stg,tpt_trg);
     
     size_t cmp_sz; /* [B] Compressed size written into output buffer (or error code) */
     size_t cmp_sz_max; /* [B] Maximum compressed size in worst case single-pass scenario */
@@ -202,32 +692,142 @@ H5Z_filter_zstandard /* [fnc] HDF5 Zstandard Filter */
       goto error;
     } /* !cmp_sz_max */
 
-    if(!(bfr_out=malloc(cmp_sz_max))){
-      (void)fprintf(stderr,"ERROR: \"%s\" filter function %s reports failure to malloc cmp_sz_max = %lu B\n",CCR_FLT_NAME,fnc_nm,cmp_sz_max);
+    /* Adaptive mode appends a skippable frame that records level used */
+    if(tpt_trg > 0) cmp_sz_max+=CCR_FLT_ADP_FRM_SZ;
+
+    /* Large chunks compress as a stream, so output buffer starts near typical compressed size rather than cmp_sz_max */
+    int stm_flg=0; /* [flg] Compress as a stream */
+#ifdef HAVE_ZSTD_ADVANCED_API
+    stm_flg=(bfr_sz_in >= CCR_FLT_STM_SZ_MIN);
+#endif /* !HAVE_ZSTD_ADVANCED_API */
+
+    /* Compress the input buffer, re-using this thread's context and dictionary when possible */
+    ZSTD_CCtx *cctx=NULL; /* [ptr] Compression context */
+    ZSTD_CDict *cdct=NULL; /* [ptr] Digested compression dictionary */
+#ifdef HAVE_PTHREAD_H
+    if(ctx && !ctx->cctx) ctx->cctx=ZSTD_createCCtx();
+    if(ctx) cctx=ctx->cctx;
+    if(ctx && dct_sz > 0) cdct=ccr_zst_cdct_get(ctx,dct_prm,dct_sz,cmp_lvl);
+#endif /* !HAVE_PTHREAD_H */
+    /* Advanced parameters, dictionaries, and streams need a context, so one-shot API cannot use them */
+    if(!cctx && (adv_flg || dct_sz > 0 || stm_flg)) cctx=cctx_tmp=ZSTD_createCCtx();
+    if(!cctx) stm_flg=0;
+    if(dct_sz > 0){
+      if(!cdct) dct=ccr_zst_dct_unpack(dct_prm,dct_sz);
+      if(!cctx || (!cdct && !dct)){
+	(void)fprintf(stderr,"ERROR: \"%s\" filter function %s reports failure to allocate dictionary of dct_sz = %lu B\n",CCR_FLT_NAME,fnc_nm,(unsigned long)dct_sz);
+	goto error;
+      } /* !cctx */
+    } /* !dct_sz */
+
+    size_t bfr_sz_out_crr=cmp_sz_max; /* [B] Current size of output buffer */
+    if(stm_flg && bfr_sz_in/4+CCR_FLT_STM_BFR_SZ < cmp_sz_max) bfr_sz_out_crr=bfr_sz_in/4+CCR_FLT_STM_BFR_SZ;
+    if(!(bfr_out=malloc(bfr_sz_out_crr))){
+      (void)fprintf(stderr,"ERROR: \"%s\" filter function %s reports failure to malloc bfr_sz_out_crr = %lu B\n",CCR_FLT_NAME,fnc_nm,(unsigned long)bfr_sz_out_crr);
       goto error;
     } /* !bfr_out */
-    
-    /* Compress the input buffer */
-    cmp_sz=ZSTD_compress(bfr_out,cmp_sz_max,bfr_in,bfr_sz_in,cmp_lvl);
+
+    if(tpt_trg > 0) tm_srt=ccr_zst_tm_get();
+    if(cctx){
+#ifdef HAVE_ZSTD_CTX_RESET
+      /* Drop any parameters and dictionary left by previous chunk */
+      (void)ZSTD_CCtx_reset(cctx,ZSTD_reset_session_and_parameters);
+#endif /* !HAVE_ZSTD_CTX_RESET */
+#ifdef HAVE_ZSTD_ADVANCED_API
+      if(adv_flg || stm_flg){
+	size_t prm_rcd; /* [enm] Return code from setting a parameter */
+	(void)ZSTD_CCtx_setParameter(cctx,ZSTD_c_compressionLevel,cmp_lvl);
+	/* Libraries built without ZSTD_MULTITHREAD reject workers, so chunk is compressed on calling thread */
+	if(wrk_nbr > 0){
+	  prm_rcd=ZSTD_CCtx_setParameter(cctx,ZSTD_c_nbWorkers,wrk_nbr);
+	  if(CCR_FLT_DBG_INFO && ZSTD_isError(prm_rcd)) (void)fprintf(stderr,"INFO: %s reports Zstandard library does not support wrk_nbr = %d worker threads, compressing on calling thread\n",fnc_nm,wrk_nbr);
+	} /* !wrk_nbr */
+	/* Rejected (out-of-range) window or strategy leaves level default in place */
+	if(wnd_log > 0){
+	  prm_rcd=ZSTD_CCtx_setParameter(cctx,ZSTD_c_windowLog,wnd_log);
+	  if(CCR_FLT_DBG_INFO && ZSTD_isError(prm_rcd)) (void)fprintf(stderr,"INFO: %s reports Zstandard library rejects wnd_log = %d, using level default\n",fnc_nm,wnd_log);
+	} /* !wnd_log */
+	if(ldm_flg) (void)ZSTD_CCtx_setParameter(cctx,ZSTD_c_enableLongDistanceMatching,1);
+	if(stg > 0){
+	  prm_rcd=ZSTD_CCtx_setParameter(cctx,ZSTD_c_strategy,stg);
+	  if(CCR_FLT_DBG_INFO && ZSTD_isError(prm_rcd)) (void)fprintf(stderr,"INFO: %s reports Zstandard library rejects stg = %d, using level default\n",fnc_nm,stg);
+	} /* !stg */
+	if(cdct) (void)ZSTD_CCtx_refCDict(cctx,cdct);
+	else if(dct) (void)ZSTD_CCtx_loadDictionary(cctx,dct,dct_sz);
+	if(stm_flg) cmp_sz=ccr_zst_cmp_stm(cctx,bfr_in,bfr_sz_in,&bfr_out,&bfr_sz_out_crr,cmp_sz_max);
+	else cmp_sz=ZSTD_compress2(cctx,bfr_out,bfr_sz_out_crr,bfr_in,bfr_sz_in);
+      }else
+#endif /* !HAVE_ZSTD_ADVANCED_API */
+      if(cdct) cmp_sz=ZSTD_compress_usingCDict(cctx,bfr_out,bfr_sz_out_crr,bfr_in,bfr_sz_in,cdct);
+      else if(dct) cmp_sz=ZSTD_compress_usingDict(cctx,bfr_out,bfr_sz_out_crr,bfr_in,bfr_sz_in,dct,dct_sz,cmp_lvl);
+      else cmp_sz=ZSTD_compressCCtx(cctx,bfr_out,bfr_sz_out_crr,bfr_in,bfr_sz_in,cmp_lvl);
+    }else{
+      cmp_sz=ZSTD_compress(bfr_out,bfr_sz_out_crr,bfr_in,bfr_sz_in,cmp_lvl);
+    } /* !cctx */
     if(ZSTD_isError(cmp_sz)){
       (void)fprintf(stderr,"ERROR: \"%s\" filter function %s reports error return code = %lu from ZSTD_compress()\n",CCR_FLT_NAME,fnc_nm,cmp_sz);
       goto error;
     } /* !cmp_sz */
+
+    if(tpt_trg > 0){
+      /* Record level and measured throughput in a skippable frame after data frame
+         Zstandard decoders, including those of other filters, skip it, and reading chunks directly (e.g., with H5Dread_chunk()) reveals level used for each chunk */
+      unsigned int tpt_msr=0; /* [MB/s] Measured throughput, 0 if not timed */
+      double tm_end; /* [s] Time compression ended */
+      unsigned char *frm; /* [ptr] Skippable frame */
+      if(tm_srt >= 0.0 && (tm_end=ccr_zst_tm_get()) > tm_srt){
+	tpt_msr=(unsigned int)(bfr_sz_in/(tm_end-tm_srt)/1.0e6);
+#ifdef HAVE_PTHREAD_H
+	if(ctx) ccr_zst_adp_lvl_upd(ctx,(double)bfr_sz_in,tm_end-tm_srt,cmp_lvl_min,cmp_lvl_max);
+#endif /* !HAVE_PTHREAD_H */
+      } /* !tm_srt */
+      /* Streams may fill output buffer exactly */
+      if(bfr_sz_out_crr < cmp_sz+CCR_FLT_ADP_FRM_SZ){
+	void *bfr_new; /* [ptr] Grown output buffer */
+	if(!(bfr_new=realloc(bfr_out,cmp_sz+CCR_FLT_ADP_FRM_SZ))){
+	  (void)fprintf(stderr,"ERROR: \"%s\" filter function %s reports failure to realloc output buffer\n",CCR_FLT_NAME,fnc_nm);
+	  goto error;
+	} /* !bfr_new */
+	bfr_out=bfr_new;
+	bfr_sz_out_crr=cmp_sz+CCR_FLT_ADP_FRM_SZ;
+      } /* !bfr_sz_out_crr */
+      frm=(unsigned char *)bfr_out+cmp_sz;
+      ccr_zst_u32_put(frm,CCR_FLT_ADP_MGC);
+      ccr_zst_u32_put(frm+4,CCR_FLT_ADP_FRM_SZ-8);
+      ccr_zst_u32_put(frm+8,(unsigned int)cmp_lvl);
+      ccr_zst_u32_put(frm+12,tpt_msr);
+      cmp_sz+=CCR_FLT_ADP_FRM_SZ;
+    } /* !tpt_trg */
     
     /* Return number of bytes in compressed buffer */
     rvl=cmp_sz;
+    bfr_sz_alc=bfr_sz_out_crr;
     
   } /* !flags */
   
+  if(dct) free(dct);
+  if(cctx_tmp) (void)ZSTD_freeCCtx(cctx_tmp);
+  if(dctx_tmp) (void)ZSTD_freeDCtx(dctx_tmp);
+  /* Trim worst-case allocation to data size, so HDF5 chunk cache holds no slack. Original buffer stays valid if realloc() fails */
+  if(rvl > 0 && rvl < bfr_sz_alc){
+    void *bfr_fit; /* [ptr] Shrunk output buffer */
+    if((bfr_fit=realloc(bfr_out,rvl))){
+      bfr_out=bfr_fit;
+      bfr_sz_alc=rvl;
+    } /* !bfr_fit */
+  } /* !rvl */
   free(*bfr_inout);
   *bfr_inout=bfr_out;
-  *bfr_sz_out=rvl;
+  *bfr_sz_out=bfr_sz_alc;
   bfr_out=NULL;
   return rvl;
   
  error:
   /* Compression filter failed, so free any allocated output buffer and return with error code */
   if(bfr_out) free(bfr_out);
+  if(dct) free(dct);
+  if(cctx_tmp) (void)ZSTD_freeCCtx(cctx_tmp);
+  if(dctx_tmp) (void)ZSTD_freeDCtx(dctx_tmp);
   return 0;
 
 } /* !H5Z_filter_zstandard() */
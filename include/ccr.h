@@ -12,24 +12,120 @@
 /** The filter ID for BZIP2 compression. */
 #define BZIP2_ID 307
 
+/** Number of parameters used internally by filter and returned by nc_inq_var_bzip2_multistream() and nc_inq_var_bzip2_sized() */
+#define BZIP2_FLT_PRM_NBR 2 /* H5Zbzip2.c: level, chunk format */
+
 /** The filter ID for LZ4 compression. */
 #define LZ4_ID 32004
 
+/** Number of parameters used internally by filter and returned by nc_inq_var_lz4() */
+#define LZ4_FLT_PRM_NBR 3 /* H5Zlz4.c: PARAM_HC_LEVEL + 1 */
+
+/** Maximum size in bytes of an LZ4 block. */
+#define LZ4_MAX_BLOCK_SIZE 2113929216 /* H5Zlz4.c: MAX_BLOCK_SIZE */
+
+/** Maximum LZ4HC compression level. */
+#define LZ4HC_MAX_LEVEL 12 /* H5Zlz4.c: MAX_HC_LEVEL */
+
 /** The filter ID for BitGroom quantization. */
 #define BITGROOM_ID 32022
 
 /** Number of parameters used internally by filter and returned by nc_inq_var_bitgroom() */
 #define BITGROOM_FLT_PRM_NBR 5 /* H5Zbitgroom.c: CCR_FLT_PRM_NBR */
 
+/** Number of parameters with an absolute error, see nc_def_var_bitgroom_abs() */
+#define BITGROOM_ABS_FLT_PRM_NBR 7 /* H5Zbitgroom.c: CCR_FLT_PRM_NBR_ABS */
+
 /** The filter ID for Granular BitRound quantization. */
 #define GRANULARBR_ID 32023
 
 /** Number of parameters used internally by filter and returned by nc_inq_var_granularbr() */
 #define GRANULARBR_FLT_PRM_NBR 5 /* H5Zgranularbr.c: CCR_FLT_PRM_NBR */
 
+/** Number of parameters with an absolute error, see nc_def_var_granularbr_abs() */
+#define GRANULARBR_ABS_FLT_PRM_NBR 7 /* H5Zgranularbr.c: CCR_FLT_PRM_NBR_ABS */
+
+/** ccr_quantize() method: BitGroom. */
+#define CCR_QUANTIZE_BITGROOM 1
+
+/** ccr_quantize() method: Granular BitRound. */
+#define CCR_QUANTIZE_GRANULARBR 2
+
+/** ccr_quantize() method: BitRound. */
+#define CCR_QUANTIZE_BITROUND 3
+
+/* Filters from BITROUND_ID through XORDELTA_ID take their IDs from
+ * the range (32768 and up) the HDF Group reserves for unregistered
+ * filters. Request registered IDs before public release. */
+
+/** The filter ID for BitRound quantization. */
+#define BITROUND_ID 32768
+
+/** Number of parameters used internally by filter and returned by nc_inq_var_bitround() */
+#define BITROUND_FLT_PRM_NBR 5 /* H5Zbitround.c: CCR_FLT_PRM_NBR */
+
+/** Number of parameters with automatic NSB, see nc_def_var_bitround_auto() */
+#define BITROUND_AUTO_FLT_PRM_NBR 6 /* H5Zbitround.c: CCR_FLT_PRM_NBR_AUTO */
+
+/** The filter ID for Float16 storage. */
+#define FLOAT16_ID 32769
+
+/** Number of parameters used internally by filter and returned by nc_inq_var_float16() */
+#define FLOAT16_FLT_PRM_NBR 5 /* H5Zfloat16.c: CCR_FLT_PRM_NBR */
+
+/** Float16 storage format: IEEE 754 half precision (binary16). */
+#define FLOAT16_IEEE 0 /* H5Zfloat16.c: CCR_FLT_FMT_IEEE */
+
+/** Float16 storage format: bfloat16. */
+#define FLOAT16_BFLOAT16 1 /* H5Zfloat16.c: CCR_FLT_FMT_BF16 */
+
+/** The filter ID for Linear Packing. */
+#define LINEARPACK_ID 32770
+
+/** Number of parameters used internally by filter and returned by nc_inq_var_linearpack() */
+#define LINEARPACK_FLT_PRM_NBR 6 /* H5Zlinearpack.c: CCR_FLT_PRM_NBR */
+
+/** The filter ID for Fill Mask. */
+#define FILLMASK_ID 32771
+
+/** Number of parameters used internally by filter */
+#define FILLMASK_FLT_PRM_NBR 4 /* H5Zfillmask.c: CCR_FLT_PRM_NBR */
+
+/** The filter ID for Byte Shuffle. */
+#define BYTESHUFFLE_ID 32772
+
+/** Number of parameters used internally by filter */
+#define BYTESHUFFLE_FLT_PRM_NBR 1 /* H5Zbyteshuffle.c: CCR_FLT_PRM_NBR */
+
+/** The filter ID for Bitshuffle. */
+#define BITSHUFFLE_ID 32773
+
+/** Number of parameters used internally by filter */
+#define BITSHUFFLE_FLT_PRM_NBR 2 /* H5Zbitshuffle.c: CCR_FLT_PRM_NBR */
+
+/** The filter ID for BitPack. */
+#define BITPACK_ID 32774
+
+/** Number of parameters used internally by filter */
+#define BITPACK_FLT_PRM_NBR 2 /* H5Zbitpack.c: CCR_FLT_PRM_NBR */
+
+/** The filter ID for XOR Delta. */
+#define XORDELTA_ID 32775
+
+/** Number of parameters used internally by filter */
+#define XORDELTA_FLT_PRM_NBR 2 /* H5Zxordelta.c: CCR_FLT_PRM_NBR */
+
 /** The filter ID for Zstandard compression. */
 #define ZSTANDARD_ID 32015
 
+/** Maximum number of scalar parameters used by the Zstandard filter,
+ * the dictionary (if any) follows them as the last parameters. Files
+ * written by earlier versions store fewer scalars. */
+#define ZSTANDARD_FLT_PRM_NBR 7 /* H5Zzstandard.c: CCR_FLT_PRM_NBR */
+
+/** Maximum size in bytes of a Zstandard dictionary. */
+#define ZSTANDARD_DICT_MAX_SIZE 32768 /* H5Zzstandard.c: CCR_FLT_DCT_SZ_MAX */
+
 /* This macro prints an error message with line number and name of
  * test program, and the netCDF error string. */
 #define NC_ERR(stat) do {						\
@@ -47,12 +143,55 @@ extern "C" {
     /* Library prototypes... */
     int nc_def_var_bzip2(int ncid, int varid, int level);
     int nc_inq_var_bzip2(int ncid, int varid, int *bzip2p, int *levelp);
+    int nc_def_var_bzip2_multistream(int ncid, int varid, int level);
+    int nc_inq_var_bzip2_multistream(int ncid, int varid, int *multistreamp, int *levelp);
+    int nc_def_var_bzip2_sized(int ncid, int varid, int level);
+    int nc_inq_var_bzip2_sized(int ncid, int varid, int *sizedp, int *levelp);
+    int nc_def_var_lz4(int ncid, int varid, int block_size, int acceleration);
+    int nc_inq_var_lz4(int ncid, int varid, int *lz4p, int *block_sizep, int *accelerationp);
+    int nc_def_var_lz4hc(int ncid, int varid, int block_size, int level);
+    int nc_inq_var_lz4hc(int ncid, int varid, int *lz4hcp, int *block_sizep, int *levelp);
     int nc_def_var_bitgroom(int ncid, int varid, int nsd);
     int nc_inq_var_bitgroom(int ncid, int varid, int *bitgroomp, int *nsdp);
+    int nc_def_var_bitgroom_abs(int ncid, int varid, double abs_err);
+    int nc_inq_var_bitgroom_abs(int ncid, int varid, int *bitgroom_absp, double *abs_errp);
     int nc_def_var_zstandard(int ncid, int varid, int level);
     int nc_inq_var_zstandard(int ncid, int varid, int *zstandardp, int *levelp);
+    int nc_def_var_zstandard_workers(int ncid, int varid, int level, int workers);
+    int nc_inq_var_zstandard_workers(int ncid, int varid, int *zstandardp, int *levelp, int *workersp);
+    int nc_def_var_zstandard_dict(int ncid, int varid, int level, const void *dict, size_t dict_size);
+    int nc_inq_var_zstandard_dict(int ncid, int varid, int *zstandard_dictp, size_t *dict_sizep, void *dict);
+    int ccr_train_zstandard_dict(int ncid, int nvars, const int *varids, size_t dict_capacity,
+                                 void *dict, size_t *dict_sizep);
+    int nc_def_var_zstandard_ldm(int ncid, int varid, int level, int window_log, int ldm, int strategy);
+    int nc_inq_var_zstandard_ldm(int ncid, int varid, int *zstandardp, int *levelp,
+                                 int *window_logp, int *ldmp, int *strategyp);
+    int nc_def_var_zstandard_adaptive(int ncid, int varid, int level, int throughput);
+    int nc_inq_var_zstandard_adaptive(int ncid, int varid, int *zstandard_adaptivep, int *levelp,
+                                      int *throughputp);
     int nc_def_var_granularbr(int ncid, int varid, int nsd);
     int nc_inq_var_granularbr(int ncid, int varid, int *granularbrp, int *nsdp);
+    int nc_def_var_granularbr_abs(int ncid, int varid, double abs_err);
+    int nc_inq_var_granularbr_abs(int ncid, int varid, int *granularbr_absp, double *abs_errp);
+    int nc_def_var_bitround(int ncid, int varid, int nsb);
+    int nc_inq_var_bitround(int ncid, int varid, int *bitroundp, int *nsbp);
+    int nc_def_var_bitround_auto(int ncid, int varid, double info_level);
+    int nc_inq_var_bitround_auto(int ncid, int varid, int *bitround_autop, double *info_levelp);
+    int nc_def_var_float16(int ncid, int varid, int format);
+    int nc_inq_var_float16(int ncid, int varid, int *float16p, int *formatp);
+    int nc_def_var_linearpack(int ncid, int varid, double max_abs_err);
+    int nc_inq_var_linearpack(int ncid, int varid, int *linearpackp, double *max_abs_errp);
+    int nc_def_var_fillmask(int ncid, int varid);
+    int nc_inq_var_fillmask(int ncid, int varid, int *fillmaskp);
+    int nc_def_var_byteshuffle(int ncid, int varid);
+    int nc_inq_var_byteshuffle(int ncid, int varid, int *byteshufflep);
+    int nc_def_var_bitshuffle(int ncid, int varid, int block_size);
+    int nc_inq_var_bitshuffle(int ncid, int varid, int *bitshufflep, int *block_sizep);
+    int nc_def_var_bitpack(int ncid, int varid, int nsb);
+    int nc_inq_var_bitpack(int ncid, int varid, int *bitpackp, int *nsbp);
+    int nc_def_var_xordelta(int ncid, int varid);
+    int nc_inq_var_xordelta(int ncid, int varid, int *xordeltap);
+    int ccr_quantize(int method, int nsd, nc_type type, void *buf, size_t n, const void *fill);
 
 #if defined(__cplusplus)
 }
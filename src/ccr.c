@@ -21,13 +21,47 @@
  * https://www.sourceware.org/bzip2/ and
  * https://en.wikipedia.org/wiki/Bzip2.
  *
+ * In multi-stream mode, each chunk is split into independent streams
+ * that are compressed and decompressed in parallel. In sized mode,
+ * each chunk records its uncompressed size, so it decompresses
+ * straight into a buffer of that size.
+ *
  * In C:
  * - nc_def_var_bzip2()
  * - nc_inq_var_bzip2()
+ * - nc_def_var_bzip2_multistream()
+ * - nc_inq_var_bzip2_multistream()
+ * - nc_def_var_bzip2_sized()
+ * - nc_inq_var_bzip2_sized()
  *
  * In Fortran:
  * - nf90_def_var_bzip2()
  * - nf90_inq_var_bzip2()
+ * - nf90_def_var_bzip2_multistream()
+ * - nf90_inq_var_bzip2_multistream()
+ * - nf90_def_var_bzip2_sized()
+ * - nf90_inq_var_bzip2_sized()
+ *
+ * LZ4
+ *
+ * LZ4 is a lossless compression algorithm with very fast
+ * decompression, several GB/s per core, at moderate compression
+ * ratios. An acceleration factor trades ratio for compression
+ * speed. The LZ4HC encoder compresses better at lower speed, and its
+ * output decompresses as fast as LZ4's. For more information see
+ * https://lz4.github.io/lz4/.
+ *
+ * In C:
+ * - nc_def_var_lz4()
+ * - nc_inq_var_lz4()
+ * - nc_def_var_lz4hc()
+ * - nc_inq_var_lz4hc()
+ *
+ * In Fortran:
+ * - nf90_def_var_lz4()
+ * - nf90_inq_var_lz4()
+ * - nf90_def_var_lz4hc()
+ * - nf90_inq_var_lz4hc()
  *
  * BitGroom
  *
@@ -46,13 +80,22 @@
  * http://www.geosci-model-dev.net/9/3199/2016
  * For more info see http://nco.sf.net/nco.html#bg.
  *
+ * BitGroom can instead quantize to an absolute error, keeping only
+ * the mantissa bits worth more than the error. Values near zero then
+ * keep fewer bits than large values, which helps fields that mix
+ * tiny and large magnitudes.
+ *
  * In C:
  * - nc_def_var_bitgroom()
  * - nc_inq_var_bitgroom()
+ * - nc_def_var_bitgroom_abs()
+ * - nc_inq_var_bitgroom_abs()
  *
  * In Fortran:
  * - nf90_def_var_bitgroom()
  * - nf90_inq_var_bitgroom()
+ * - nf90_def_var_bitgroom_abs()
+ * - nf90_inq_var_bitgroom_abs()
  *
  * Granular BitRound
  *
@@ -79,13 +122,178 @@
  * which with the simple mantissas yields better compression ratios.
  * For more info see http://nco.sf.net/nco.html#gbg.
  *
+ * Like BitGroom, GBR can instead quantize to an absolute error.
+ *
  * In C:
  * - nc_def_var_granularbr()
  * - nc_inq_var_granularbr()
+ * - nc_def_var_granularbr_abs()
+ * - nc_inq_var_granularbr_abs()
  *
  * In Fortran:
  * - nf90_def_var_granularbr()
  * - nf90_inq_var_granularbr()
+ * - nf90_def_var_granularbr_abs()
+ * - nf90_inq_var_granularbr_abs()
+ *
+ * BitRound
+ *
+ * The BitRound filter quantizes the mantissa of floating point values
+ * (integers are unaffected) to the requested Number of Significant
+ * Bits (NSB), also called "keepbits". BitRound rounds each value to
+ * the nearest representable value with NSB explicit mantissa bits by
+ * adding half of the last retained bit and then zeroing the remaining
+ * bits. One mask serves every value, so BitRound is the fastest CCR
+ * quantizer per element. Choose NSB from the information content of
+ * the data, e.g., as described in Klöwer, M., M. Razinger,
+ * J. J. Dominguez, P. D. Düben, and T. N. Palmer (2021), Compressing
+ * atmospheric data into its real information content, Nat. Comput.
+ * Sci., 1, 713-724, doi:10.1038/s43588-021-00156-2. Alternatively,
+ * let the filter apply that method to each chunk it writes, and give
+ * only the fraction of real information to retain.
+ *
+ * In C:
+ * - nc_def_var_bitround()
+ * - nc_inq_var_bitround()
+ * - nc_def_var_bitround_auto()
+ * - nc_inq_var_bitround_auto()
+ *
+ * In Fortran:
+ * - nf90_def_var_bitround()
+ * - nf90_inq_var_bitround()
+ * - nf90_def_var_bitround_auto()
+ * - nf90_inq_var_bitround_auto()
+ *
+ * In-Memory Quantization
+ *
+ * The BitGroom, Granular BitRound, and BitRound code is also
+ * available for buffers in memory, so data may be quantized where
+ * they are produced, before they are gathered, sent, or written.
+ *
+ * In C:
+ * - ccr_quantize()
+ *
+ * Float16
+ *
+ * The Float16 filter stores single-precision values as 16-bit IEEE
+ * half-precision (binary16) or bfloat16 values, rounded to nearest,
+ * and expands them to single precision when data are read. Half
+ * precision keeps about three significant digits within magnitudes
+ * of 65504, and bfloat16 keeps two to three digits over the full
+ * single-precision range. Fill values are preserved exactly. Storing
+ * half the bytes also halves the work of the lossless compressor
+ * that follows.
+ *
+ * In C:
+ * - nc_def_var_float16()
+ * - nc_inq_var_float16()
+ *
+ * In Fortran:
+ * - nf90_def_var_float16()
+ * - nf90_inq_var_float16()
+ *
+ * Linear Packing
+ *
+ * The Linear Packing filter stores floating point values as 8, 16, or
+ * 32-bit integers, the narrowest width that keeps every value within
+ * a requested maximum absolute error. Each chunk records its minimum
+ * as offset and twice the error bound as step, so values are
+ * unpacked as offset + code * step. Unlike the quantization filters,
+ * which bound relative error, packing bounds absolute error, which
+ * suits fields such as temperature and pressure whose precision is
+ * known in physical units. Fill values are preserved exactly. Chunks
+ * that contain infinities or NaNs, or that would need more than 32
+ * bits, are stored unpacked.
+ *
+ * In C:
+ * - nc_def_var_linearpack()
+ * - nc_inq_var_linearpack()
+ *
+ * In Fortran:
+ * - nf90_def_var_linearpack()
+ * - nf90_inq_var_linearpack()
+ *
+ * Fill Mask
+ *
+ * The Fill Mask filter stores chunks that are entirely _FillValue,
+ * such as land points of an ocean field, as a short header, and
+ * chunks that are mostly _FillValue as a bitmap of valid values plus
+ * the valid values. The filter is lossless and applies to integer
+ * and floating point values.
+ *
+ * In C:
+ * - nc_def_var_fillmask()
+ * - nc_inq_var_fillmask()
+ *
+ * In Fortran:
+ * - nf90_def_var_fillmask()
+ * - nf90_inq_var_fillmask()
+ *
+ * Byte Shuffle
+ *
+ * The Byte Shuffle filter gathers the first byte of every value,
+ * then the second byte, and so on, which helps the lossless
+ * compressor that follows. Chunks have the layout of the HDF5 shuffle
+ * filter, but are shuffled with SSE2, AVX2, or AVX-512 instructions
+ * where the CPU has them.
+ *
+ * In C:
+ * - nc_def_var_byteshuffle()
+ * - nc_inq_var_byteshuffle()
+ *
+ * In Fortran:
+ * - nf90_def_var_byteshuffle()
+ * - nf90_inq_var_byteshuffle()
+ *
+ * Bitshuffle
+ *
+ * The Bitshuffle filter gathers each bit of every value into bit
+ * planes, so the trailing mantissa bits that quantization zeroes
+ * become long runs of zeros for the lossless compressor that
+ * follows. Chunks are transposed in blocks of a few kB, with SSE2,
+ * AVX2, or AVX-512 instructions where the CPU has them.
+ *
+ * In C:
+ * - nc_def_var_bitshuffle()
+ * - nc_inq_var_bitshuffle()
+ *
+ * In Fortran:
+ * - nf90_def_var_bitshuffle()
+ * - nf90_inq_var_bitshuffle()
+ *
+ * BitPack
+ *
+ * The BitPack filter drops the trailing mantissa bits that
+ * quantization zeroes, and packs the bits that remain into a dense
+ * bit stream. Chunks shrink by the fraction of bits dropped without
+ * any entropy coding, which suits output that must be written
+ * quickly. Values whose dropped bits are not zero, such as the
+ * _FillValue, are stored in full, so the filter is lossless.
+ *
+ * In C:
+ * - nc_def_var_bitpack()
+ * - nc_inq_var_bitpack()
+ *
+ * In Fortran:
+ * - nf90_def_var_bitpack()
+ * - nf90_inq_var_bitpack()
+ *
+ * XOR Delta
+ *
+ * The XOR Delta filter stores each floating-point value as its XOR
+ * with the value before it, in a bit stream that omits the leading
+ * and trailing zeros of each XOR. Neighbors in smooth fields share
+ * their sign, exponent, and leading mantissa bits, so full-precision
+ * data shrink without loss, and much faster than with a general
+ * purpose compressor.
+ *
+ * In C:
+ * - nc_def_var_xordelta()
+ * - nc_inq_var_xordelta()
+ *
+ * In Fortran:
+ * - nf90_def_var_xordelta()
+ * - nf90_inq_var_xordelta()
  *
  * Zstandard
  *
@@ -101,10 +309,28 @@
  * In C:
  * - nc_def_var_zstandard()
  * - nc_inq_var_zstandard()
+ * - nc_def_var_zstandard_workers()
+ * - nc_inq_var_zstandard_workers()
+ * - nc_def_var_zstandard_dict()
+ * - nc_inq_var_zstandard_dict()
+ * - ccr_train_zstandard_dict()
+ * - nc_def_var_zstandard_ldm()
+ * - nc_inq_var_zstandard_ldm()
+ * - nc_def_var_zstandard_adaptive()
+ * - nc_inq_var_zstandard_adaptive()
  *
  * In Fortran:
  * - nf90_def_var_zstandard()
  * - nf90_inq_var_zstandard()
+ * - nf90_def_var_zstandard_workers()
+ * - nf90_inq_var_zstandard_workers()
+ * - nf90_def_var_zstandard_dict()
+ * - nf90_inq_var_zstandard_dict()
+ * - nf90_train_zstandard_dict()
+ * - nf90_def_var_zstandard_ldm()
+ * - nf90_inq_var_zstandard_ldm()
+ * - nf90_def_var_zstandard_adaptive()
+ * - nf90_inq_var_zstandard_adaptive()
  *
  * @image html NetCDF_Filters.png
  *
@@ -114,12 +340,40 @@
 #include "ccr.h"
 #include <hdf5.h>
 #include <H5DSpublic.h>
+#include <float.h>
 #include <stdlib.h>
+#include <string.h>
+#ifdef HAVE_ZDICT
+#include <zdict.h>
+#endif /* HAVE_ZDICT */
 
 #define MAX_BITGROOM_NSD_FLOAT 7
 #define MAX_BITGROOM_NSD_DOUBLE 15
 #define MAX_GRANULARBR_NSD_FLOAT 7
 #define MAX_GRANULARBR_NSD_DOUBLE 15
+#define MAX_BITROUND_NSB_FLOAT 23
+#define MAX_BITROUND_NSB_DOUBLE 52
+
+/* Pointer union for floating point and bitmask types, as in the
+ * quantization kernels. */
+typedef union {
+  float *fp;
+  double *dp;
+  unsigned int *ui32p;
+  unsigned long long *ui64p;
+  void *vp;
+} ptr_unn;
+
+/* Quantization kernels, built from the same sources as the HDF5
+ * plugins: hdf5_plugins/BITGROOM/src/ccr_bgr.c,
+ * hdf5_plugins/GRANULARBR/src/ccr_gbr.c, and
+ * hdf5_plugins/BITROUND/src/ccr_btr.c. */
+void ccr_bgr(const int nsd, const int type, const size_t sz, const int has_mss_val,
+             ptr_unn mss_val, ptr_unn op1);
+void ccr_gbr(const int nsd, const int type, const size_t sz, const int has_mss_val,
+             ptr_unn mss_val, ptr_unn op1);
+void ccr_btr(const int nsb, const int type, const size_t sz, const int has_mss_val,
+             ptr_unn mss_val, ptr_unn op1);
 
 /**
  * Turn on bzip2 compression for a variable.
@@ -155,25 +409,31 @@ nc_def_var_bzip2(int ncid, int varid, int level)
 }
 
 /**
- * Learn whether bzip2 compression is on for a variable, and, if so,
- * the level setting.
+ * Learn whether bzip2 is on for a variable, and, if so, its filter
+ * parameters.
+ *
+ * Other HDF5 bzip2 filters store only the level, so parameters not
+ * stored in the file are left untouched in prm. Callers zero prm
+ * first so those read as single-stream.
  *
  * @param ncid File ID.
  * @param varid Variable ID.
  * @param bzip2p Pointer that gets a 0 if bzip2 is not in use for this
  * var, and a 1 if it is. Ignored if NULL.
- * @param levelp Pointer that gets the level setting (from 1 to 9), if
- * bzip2 is in use. Ignored if NULL.
+ * @param prm Array of BZIP2_FLT_PRM_NBR elements that gets the filter
+ * parameters, if bzip2 is in use.
  *
  * @return 0 for success, error code otherwise.
  * @author Ed Hartnett
  */
-int
-nc_inq_var_bzip2(int ncid, int varid, int *bzip2p, int *levelp)
+static int
+ccr_inq_var_bzip2_prm(int ncid, int varid, int *bzip2p, unsigned int *prm)
 {
-    unsigned int level;
-    size_t nparams;
     int bzip2 = 0; /* Is bzip2 in use? */
+#ifndef HAVE_MULTIFILTERS
+    unsigned int id;
+#endif /* HAVE_MULTIFILTERS */
+    size_t nparams;
     int ret;
 
 #ifdef HAVE_MULTIFILTERS
@@ -204,42 +464,21 @@ nc_inq_var_bzip2(int ncid, int varid, int *bzip2p, int *levelp)
     
 	/* Check each filter to see if it is Bzip2. */
 	for (f = 0; f < nfilters; f++)
-	{
 	    if (filterids[f] == BZIP2_ID)
 		bzip2++;
 
-	    /* If Bzip2 is in use, check parameter. */
-	    if (bzip2)
-	    {
-	    
-		if ((ret = nc_inq_var_filter_info(ncid, varid, filterids[f], &nparams, &level)))
-		    return ret;
-
-		/* For Bzip2, there is one parameter. */
-		if (nparams != 1)
-		    return NC_EFILTER;
-
-		/* Tell the caller, if they want to know. */
-		if (levelp)
-		    *levelp = (int)level;
-
-		/* Exit loop to report parameters (neglect remaining filters) */
-		break;
-	    }
-	}
-
 	/* Free resources. */
 	free(filterids);
 
-	if (bzip2p)
-	    *bzip2p = bzip2;
+	/* Count the parameters before reading them. */
+	if (bzip2)
+	    if ((ret = nc_inq_var_filter_info(ncid, varid, BZIP2_ID, &nparams, NULL)))
+		return ret;
     }
 #else
     {
-	unsigned int id;
-	
 	/* Get filter information. */
-	ret = nc_inq_var_filter(ncid, varid, &id, &nparams, &level);
+	ret = nc_inq_var_filter(ncid, varid, &id, &nparams, NULL);
 	if (ret == NC_ENOFILTER)
 	{
 	    /* No filter means no bzip2. */
@@ -253,270 +492,2097 @@ nc_inq_var_bzip2(int ncid, int varid, int *bzip2p, int *levelp)
 	/* Is bzip2 in use? */
 	if (id == BZIP2_ID)
 	    bzip2++;
+    }
+#endif /* HAVE_MULTIFILTERS */
 
-	/* Does caller want to know if bzip2 is in use? */
-	if (bzip2p)
-	    *bzip2p = bzip2;
-
-	/* If bzip2 is in use, check parameter. */
-	if (bzip2)
-	{
-	    /* For bzip2, there is one parameter. */
-	    if (nparams != 1)
-		return NC_EFILTER;
+    /* Does caller want to know if bzip2 is in use? */
+    if (bzip2p)
+	*bzip2p = bzip2;
+    if (!bzip2)
+	return 0;
 
-	    /* Tell the caller, if they want to know. */
-	    if (levelp)
-		*levelp = level;
-	}
-    }
-#endif
+    /* For bzip2, there is the level, and optionally the chunk format. */
+    if (nparams < 1 || nparams > BZIP2_FLT_PRM_NBR)
+	return NC_EFILTER;
+#ifdef HAVE_MULTIFILTERS
+    if ((ret = nc_inq_var_filter_info(ncid, varid, BZIP2_ID, &nparams, prm)))
+	return ret;
+#else
+    if ((ret = nc_inq_var_filter(ncid, varid, &id, &nparams, prm)))
+	return ret;
+#endif /* HAVE_MULTIFILTERS */
 
     return 0;
 }
 
-/* /\** */
-/*  * Turn on lz4 compression for a variable. */
-/*  * */
-/*  * @param ncid File ID. */
-/*  * @param varid Variable ID. */
-/*  * @param level From 1 to 9. Set the block size to 100k, 200k ... 900k */
-/*  * when compressing. (lz4 default level is 9). */
-/*  * */
-/*  * @return 0 for success, error code otherwise. */
-/*  * @author Ed Hartnett */
-/*  *\/ */
-/* int */
-/* nc_def_var_lz4(int ncid, int varid, int level) */
-/* { */
-/*     unsigned int cd_value = level; */
-/*     int ret; */
-
-/*     /\* Level must be between 1 and 9. *\/ */
-/*     if (level < 1 || level > 9) */
-/*         return NC_EINVAL; */
-
-/*     if (!H5Zfilter_avail(LZ4_ID)) */
-/*     { */
-/*         printf ("lz4 filter not available.\n"); */
-/*         return NC_EFILTER; */
-/*     } */
-
-/*     /\* Set up the lz4 filter for this var. *\/ */
-/*     if ((ret = nc_def_var_filter(ncid, varid, LZ4_ID, 1, &cd_value))) */
-/*         return ret; */
-
-/*     return 0; */
-/* } */
-
-/* /\** */
-/*  * Learn whether lz4 compression is on for a variable, and, if so, */
-/*  * the level setting. */
-/*  * */
-/*  * @param ncid File ID. */
-/*  * @param varid Variable ID. */
-/*  * @param lz4p Pointer that gets a 0 if lz4 is not in use for this */
-/*  * var, and a 1 if it is. Ignored if NULL. */
-/*  * @param levelp Pointer that gets the level setting (from 1 to 9), if */
-/*  * bzlip2 is in use. Ignored if NULL. */
-/*  * */
-/*  * @return 0 for success, error code otherwise. */
-/*  * @author Ed Hartnett */
-/*  *\/ */
-/* int */
-/* nc_inq_var_lz4(int ncid, int varid, int *lz4p, int *levelp) */
-/* { */
-/*     unsigned int level; */
-/*     unsigned int id; */
-/*     size_t nparams; */
-/*     int lz4 = 0; /\* Is lz4 in use? *\/ */
-/*     int ret; */
-
-/*     /\* Get filter information. *\/ */
-/*     ret = nc_inq_var_filter(ncid, varid, &id, &nparams, &level); */
-/*     if (ret == NC_ENOFILTER) */
-/*     { */
-/* 	if (lz4p) */
-/* 	    *lz4p = 0; */
-/* 	return 0; */
-/*     } */
-/*     else if (ret) */
-/* 	return ret; */
-
-/*     /\* Is lz4 in use? *\/ */
-/*     if (id == LZ4_ID) */
-/*         lz4++; */
-
-/*     /\* Does caller want to know if lz4 is in use? *\/ */
-/*     if (lz4p) */
-/*         *lz4p = lz4; */
-
-/*     /\* If lz4 is in use, check parameter. *\/ */
-/*     if (lz4) */
-/*     { */
-/*         /\* For lz4, there is one parameter. *\/ */
-/*         if (nparams != 1) */
-/*             return NC_EFILTER; */
-
-/*         /\* Tell the caller, if they want to know. *\/ */
-/*         if (levelp) */
-/*             *levelp = level; */
-/*     } */
-
-/*     return 0; */
-/* } */
-
 /**
- * Turn on BitGroom quantization for a variable.
- *
- * The BitGroom filter quantizes the data by setting unneeded bits
- * alternately to 1/0, so that they may compress well. The BitGroom
- * filter itself is lossy (data are irretrievably altered), and it
- * improves the compression ratio provided by a subsequent lossless 
- * compression filter. Call the nc_def_var_bitgroom() function before
- * the function that turns on the lossless compression filter
- * (nc_def_var_deflate(), for example). 
+ * Learn whether bzip2 compression is on for a variable, and, if so,
+ * the level setting.
  *
- * A notable feature of BitGroom is that the data it processes remain 
- * in IEEE754 format after quantization. Therefore the BitGroom filter 
- * does nothing when data are read. However, the Bitgroom filter must 
- * still be installed on machines that need to read bitgroomed data.
+ * Multi-stream and sized bzip2 (see nc_def_var_bzip2_multistream()
+ * and nc_def_var_bzip2_sized()) are also bzip2.
  *
- * The BitGroom filter only quantizes variables of type NC_FLOAT or
- * NC_DOUBLE. Attempts to set the BitGroom filter for other variable
- * types through the C/Fortran API return an error (NC_EINVAL). The
- * filter does not quantize values equal to the value of the
- * _FillValue attribute, if any. The main difference between the
- * BitGroom algorithm as implemented in the CCR and in NCO is that the
- * NCO version will not quantize the values of "coordinate-like"
- * variables (e.g., latitude, longitude, time) as defined in the NCO
- * manual, whereas the CCR version will quantize any floating-point
- * variable.
+ * @param ncid File ID.
+ * @param varid Variable ID.
+ * @param bzip2p Pointer that gets a 0 if bzip2 is not in use for this
+ * var, and a 1 if it is. Ignored if NULL.
+ * @param levelp Pointer that gets the level setting (from 1 to 9), if
+ * bzip2 is in use. Ignored if NULL.
  *
- * @note Internally, the filter requires CCR_FLT_PRM_NBR (=5) elements
- * for cd_value. However, the user needs to provide only the first
- * element, NSD, since the other elements can be and are derived from
- * the dcpl (data_class, datum_size), and extra queries of the
- * variable (has_mss_val, mss_val). Hence, the netCDF API exposes to
- * the user and requires setting only the minimal number (1) of filter
- * parameters.
+ * @return 0 for success, error code otherwise.
+ * @author Ed Hartnett
+ */
+int
+nc_inq_var_bzip2(int ncid, int varid, int *bzip2p, int *levelp)
+{
+    unsigned int prm[BZIP2_FLT_PRM_NBR] = {0};
+    int bzip2 = 0; /* Is bzip2 in use? */
+    int ret;
+
+    if ((ret = ccr_inq_var_bzip2_prm(ncid, varid, &bzip2, prm)))
+        return ret;
 
+    /* Does caller want to know if bzip2 is in use? */
+    if (bzip2p)
+        *bzip2p = bzip2;
+
+    /* Tell the caller, if they want to know. */
+    if (bzip2 && levelp)
+        *levelp = (int)prm[0];
+
+    return 0;
+}
+
+/**
+ * Turn on multi-stream bzip2 compression for a variable.
+ *
+ * bzip2 compresses only a few MB/s per core. In multi-stream mode
+ * the filter splits each chunk into independent bzip2 streams of
+ * level * 100k bytes, preceded by an index of their sizes, and
+ * compresses and decompresses them in parallel when the CCR_THR_NBR
+ * environment variable is set. Chunks smaller than two streams gain
+ * nothing. The ratio is that of plain bzip2 at the same level, since
+ * bzip2 already works in blocks of that size.
+ *
+ * Only this filter reads the multi-stream format, so use
+ * nc_def_var_bzip2() for files read by other bzip2 filters.
+ *
  * @param ncid File ID.
  * @param varid Variable ID.
- * @param nsd Number of significant digits to retain. Allowed single- and
- * double-precision NSDs are 1-7 and 1-15, respectively. (Default is 3).
+ * @param level From 1 to 9. Sets the bzip2 block size, and the size
+ * of each stream, to 100k, 200k ... 900k.
  *
  * @return 0 for success, error code otherwise.
  * @author Charlie Zender
  */
 int
-nc_def_var_bitgroom(int ncid, int varid, int nsd)
+nc_def_var_bzip2_multistream(int ncid, int varid, int level)
 {
-  unsigned int cd_value[BITGROOM_FLT_PRM_NBR];
-  int ret;
-  nc_type var_typ;
-  
-  /* BitGroom only quantizes floating-point values */
-  if ((ret = nc_inq_vartype(ncid, varid, &var_typ)))
-    return ret;
+    unsigned int cd_value[BZIP2_FLT_PRM_NBR];
+    int ret;
 
-  if (var_typ != NC_FLOAT && var_typ != NC_DOUBLE)
-  {
-      /* printf ("BitGroom filter can only be defined for floating-point variables.\n"); */
-      return NC_EINVAL;
-  }
-  
-  /* NSD must be between 1 and 7 for NC_FLOAT, 1 and 15 for
-   * NC_DOUBLE. */
-  if (nsd < 1 || nsd > (var_typ == NC_FLOAT ? MAX_BITGROOM_NSD_FLOAT : MAX_BITGROOM_NSD_DOUBLE))
-    return NC_EINVAL;
+    /* Level must be between 1 and 9. */
+    if (level < 1 || level > 9)
+        return NC_EINVAL;
 
-  if (!H5Zfilter_avail(BITGROOM_ID))
-  {
-      printf ("BitGroom filter not available.\n");
-      return NC_EFILTER;
-  }
+    if (!H5Zfilter_avail(BZIP2_ID))
+    {
+        printf ("bzip2 filter not available.\n");
+        return NC_EFILTER;
+    }
 
-  /* User-provided NSD is first element of filter parameter array */
-  cd_value[0] = nsd;
+    /* Second parameter 1 selects the multi-stream chunk format. */
+    cd_value[0] = level;
+    cd_value[1] = 1;
 
-  /* Set up the BitGroom filter for this var. */
-  if ((ret = nc_def_var_filter(ncid, varid, BITGROOM_ID, BITGROOM_FLT_PRM_NBR, cd_value)))
-    return ret;
+    /* Set up the bzip2 filter for this var. */
+    if ((ret = nc_def_var_filter(ncid, varid, BZIP2_ID, BZIP2_FLT_PRM_NBR, cd_value)))
+        return ret;
 
-  return 0;
+    return 0;
 }
 
 /**
- * Learn whether BitGroom quantization is on for a variable, and, if so,
- * the NSD setting.
+ * Learn whether multi-stream bzip2 compression is on for a variable,
+ * and, if so, the level setting.
  *
  * @param ncid File ID.
  * @param varid Variable ID.
- * @param bitgroomp Pointer that gets a 0 if BitGroom is not in use for this
- * var, and a 1 if it is. Ignored if NULL.
- * @param nsdp Pointer that gets the NSD setting (from 1 to 15), if
- * BitGroom is in use. Ignored if NULL.
+ * @param multistreamp Pointer that gets a 0 if multi-stream bzip2 is
+ * not in use for this var, and a 1 if it is. Ignored if NULL.
+ * @param levelp Pointer that gets the level setting (from 1 to 9), if
+ * multi-stream bzip2 is in use. Ignored if NULL.
  *
  * @return 0 for success, error code otherwise.
  * @author Charlie Zender
  */
 int
-nc_inq_var_bitgroom(int ncid, int varid, int *bitgroomp, int *nsdp)
+nc_inq_var_bzip2_multistream(int ncid, int varid, int *multistreamp, int *levelp)
 {
-  unsigned int nsd[BITGROOM_FLT_PRM_NBR];
-  size_t nparams;
-  int bitgroom = 0; /* Is BitGroom in use? */
-  int ret;
-  
-#ifdef HAVE_MULTIFILTERS
-    {
-	size_t nfilters;
-	unsigned int *filterids;
-	int f;
-	
-	/* Get filter information. */
-	if ((ret = nc_inq_var_filter_ids(ncid, varid, &nfilters, NULL)))
-	    return ret;
-	
-	/* If there are no filters, we're done. */
-	if (nfilters == 0)
-	{
-	    if (bitgroomp)
-		*bitgroomp = 0;
-	    return 0;
-	}
-
-	/* Allocate storage for filter IDs. */
-	if (!(filterids = malloc(nfilters * sizeof(unsigned int))))
-	    return NC_ENOMEM;
+    unsigned int prm[BZIP2_FLT_PRM_NBR] = {0};
+    int bzip2 = 0; /* Is bzip2 in use? */
+    int multistream;
+    int ret;
 
-	/* Get the filter IDs. */
-	if ((ret = nc_inq_var_filter_ids(ncid, varid, &nfilters, filterids)))
-	    return ret;
-    
-	/* Check each filter to see if it is BitGroom. */
-	for (f = 0; f < nfilters; f++)
-	{
-	    if (filterids[f] == BITGROOM_ID)
-		bitgroom++;
+    if ((ret = ccr_inq_var_bzip2_prm(ncid, varid, &bzip2, prm)))
+        return ret;
+    multistream = bzip2 && prm[1] == 1;
 
-	    /* If BitGroom is in use, check parameter. */
-	    if (bitgroom)
-	    {
-	    
-		if ((ret = nc_inq_var_filter_info(ncid, varid, filterids[f], &nparams, nsd)))
-		    return ret;
+    /* Does caller want to know if multi-stream bzip2 is in use? */
+    if (multistreamp)
+        *multistreamp = multistream;
 
-		/* BitGroom has BITGROOM_FLT_PRM_NBR == 5 internal parameters.
-		   We expose only the first (NSD) through this API because a variable's properties 
-		   uniquely determine the remainder and exposing them to users, well, invites disaster */
-		if (nparams != BITGROOM_FLT_PRM_NBR)
-		  return NC_EFILTER;
+    /* Tell the caller, if they want to know. */
+    if (multistream && levelp)
+        *levelp = (int)prm[0];
 
-		/* Tell the caller, if they want to know. */
-		if (nsdp)
-		    *nsdp = (int)nsd[0];
+    return 0;
+}
+
+/**
+ * Turn on sized bzip2 compression for a variable.
+ *
+ * A bzip2 stream does not record how large it decompresses, so the
+ * filter reading a plain bzip2 chunk must guess an output size and
+ * grow it, copying what it has decompressed, until the data
+ * fit. Sized chunks hold a short versioned header with the
+ * uncompressed size ahead of an ordinary bzip2 stream, and
+ * decompress into a buffer allocated once at that size. Compression
+ * is unchanged, and the header adds 8 bytes per chunk.
+ *
+ * Only this filter reads the sized format, so use nc_def_var_bzip2()
+ * for files read by other bzip2 filters.
+ *
+ * @param ncid File ID.
+ * @param varid Variable ID.
+ * @param level From 1 to 9. Set the block size to 100k, 200k ... 900k
+ * when compressing. (bzip2 default level is 9).
+ *
+ * @return 0 for success, error code otherwise.
+ * @author Charlie Zender
+ */
+int
+nc_def_var_bzip2_sized(int ncid, int varid, int level)
+{
+    unsigned int cd_value[BZIP2_FLT_PRM_NBR];
+    int ret;
+
+    /* Level must be between 1 and 9. */
+    if (level < 1 || level > 9)
+        return NC_EINVAL;
+
+    if (!H5Zfilter_avail(BZIP2_ID))
+    {
+        printf ("bzip2 filter not available.\n");
+        return NC_EFILTER;
+    }
+
+    /* Second parameter 2 selects the sized chunk format. */
+    cd_value[0] = level;
+    cd_value[1] = 2;
+
+    /* Set up the bzip2 filter for this var. */
+    if ((ret = nc_def_var_filter(ncid, varid, BZIP2_ID, BZIP2_FLT_PRM_NBR, cd_value)))
+        return ret;
+
+    return 0;
+}
+
+/**
+ * Learn whether sized bzip2 compression is on for a variable, and,
+ * if so, the level setting.
+ *
+ * @param ncid File ID.
+ * @param varid Variable ID.
+ * @param sizedp Pointer that gets a 0 if sized bzip2 is not in use
+ * for this var, and a 1 if it is. Ignored if NULL.
+ * @param levelp Pointer that gets the level setting (from 1 to 9), if
+ * sized bzip2 is in use. Ignored if NULL.
+ *
+ * @return 0 for success, error code otherwise.
+ * @author Charlie Zender
+ */
+int
+nc_inq_var_bzip2_sized(int ncid, int varid, int *sizedp, int *levelp)
+{
+    unsigned int prm[BZIP2_FLT_PRM_NBR] = {0};
+    int bzip2 = 0; /* Is bzip2 in use? */
+    int sized;
+    int ret;
+
+    if ((ret = ccr_inq_var_bzip2_prm(ncid, varid, &bzip2, prm)))
+        return ret;
+    sized = bzip2 && prm[1] == 2;
+
+    /* Does caller want to know if sized bzip2 is in use? */
+    if (sizedp)
+        *sizedp = sized;
+
+    /* Tell the caller, if they want to know. */
+    if (sized && levelp)
+        *levelp = (int)prm[0];
+
+    return 0;
+}
+
+/**
+ * Turn on LZ4 compression for a variable.
+ *
+ * LZ4 trades compression ratio for speed: it decompresses at several
+ * GB/s per core, faster than any other CCR compressor, which suits
+ * data read often and interactively. The filter splits each chunk
+ * into blocks of block_size bytes and compresses them independently.
+ * Blocks that do not shrink are stored as is. When the CCR_THR_NBR
+ * environment variable is set, blocks are compressed and
+ * decompressed on that many threads, with identical results.
+ *
+ * Files are readable by other HDF5 LZ4 filters (filter ID 32004),
+ * which ignore the acceleration.
+ *
+ * @param ncid File ID.
+ * @param varid Variable ID.
+ * @param block_size Size in bytes of the blocks each chunk is split
+ * into, from 1 to LZ4_MAX_BLOCK_SIZE, or 0 for the default of 256
+ * kB.
+ * @param acceleration 1 for the default speed and ratio. Larger
+ * values compress faster and less, by about 3% per unit. Values above
+ * 65537 act as 65537. Decompression speed is unaffected.
+ *
+ * @return 0 for success, error code otherwise.
+ * @author Charlie Zender
+ */
+int
+nc_def_var_lz4(int ncid, int varid, int block_size, int acceleration)
+{
+    unsigned int cd_value[LZ4_FLT_PRM_NBR];
+    int ret;
+
+    /* Block size must be between 0 (default) and LZ4_MAX_BLOCK_SIZE. */
+    if (block_size < 0 || block_size > LZ4_MAX_BLOCK_SIZE)
+        return NC_EINVAL;
+
+    /* Acceleration must be positive. */
+    if (acceleration < 1)
+        return NC_EINVAL;
+
+    if (!H5Zfilter_avail(LZ4_ID))
+    {
+        printf ("lz4 filter not available.\n");
+        return NC_EFILTER;
+    }
+
+    /* Block size, acceleration, and no LZ4HC level. */
+    cd_value[0] = block_size;
+    cd_value[1] = acceleration;
+    cd_value[2] = 0;
+
+    /* Set up the lz4 filter for this var. */
+    if ((ret = nc_def_var_filter(ncid, varid, LZ4_ID, LZ4_FLT_PRM_NBR, cd_value)))
+        return ret;
+
+    return 0;
+}
+
+/**
+ * Learn whether LZ4 is on for a variable, and, if so, its filter
+ * parameters.
+ *
+ * Other HDF5 LZ4 filters store only the block size, if that, so
+ * parameters not stored in the file are left untouched in
+ * prm. Callers zero prm first so those read as defaults.
+ *
+ * @param ncid File ID.
+ * @param varid Variable ID.
+ * @param lz4p Pointer that gets a 0 if LZ4 is not in use for this
+ * var, and a 1 if it is. Ignored if NULL.
+ * @param prm Array of LZ4_FLT_PRM_NBR elements that gets the filter
+ * parameters, if LZ4 is in use.
+ *
+ * @return 0 for success, error code otherwise.
+ * @author Charlie Zender
+ */
+static int
+ccr_inq_var_lz4_prm(int ncid, int varid, int *lz4p, unsigned int *prm)
+{
+    int lz4 = 0; /* Is lz4 in use? */
+#ifndef HAVE_MULTIFILTERS
+    unsigned int id;
+#endif /* HAVE_MULTIFILTERS */
+    size_t nparams;
+    int ret;
+
+#ifdef HAVE_MULTIFILTERS
+    {
+	size_t nfilters;
+	unsigned int *filterids;
+	int f;
+	
+	/* Get filter information. */
+	if ((ret = nc_inq_var_filter_ids(ncid, varid, &nfilters, NULL)))
+	    return ret;
+	
+	/* If there are no filters, we're done. */
+	if (nfilters == 0)
+	{
+	    if (lz4p)
+		*lz4p = 0;
+	    return 0;
+	}
+
+	/* Allocate storage for filter IDs. */
+	if (!(filterids = malloc(nfilters * sizeof(unsigned int))))
+	    return NC_ENOMEM;
+
+	/* Get the filter IDs. */
+	if ((ret = nc_inq_var_filter_ids(ncid, varid, &nfilters, filterids)))
+	{
+	    free(filterids);
+	    return ret;
+	}
+    
+	/* Check each filter to see if it is lz4. */
+	for (f = 0; f < nfilters; f++)
+	    if (filterids[f] == LZ4_ID)
+		lz4++;
+
+	/* Free resources. */
+	free(filterids);
+
+	/* Count the parameters before reading them. */
+	if (lz4)
+	    if ((ret = nc_inq_var_filter_info(ncid, varid, LZ4_ID, &nparams, NULL)))
+		return ret;
+    }
+#else
+    {
+	/* Get filter information. */
+	ret = nc_inq_var_filter(ncid, varid, &id, &nparams, NULL);
+	if (ret == NC_ENOFILTER)
+	{
+	    if (lz4p)
+		*lz4p = 0;
+	    return 0;
+	}
+	else if (ret)
+	    return ret;
+
+	/* Is lz4 in use? */
+	if (id == LZ4_ID)
+	    lz4++;
+    }
+#endif /* HAVE_MULTIFILTERS */
+
+    /* Does caller want to know if lz4 is in use? */
+    if (lz4p)
+	*lz4p = lz4;
+    if (!lz4)
+	return 0;
+
+    /* LZ4 has up to LZ4_FLT_PRM_NBR parameters. */
+    if (nparams > LZ4_FLT_PRM_NBR)
+	return NC_EFILTER;
+    if (nparams == 0)
+	return 0;
+#ifdef HAVE_MULTIFILTERS
+    if ((ret = nc_inq_var_filter_info(ncid, varid, LZ4_ID, &nparams, prm)))
+	return ret;
+#else
+    if ((ret = nc_inq_var_filter(ncid, varid, &id, &nparams, prm)))
+	return ret;
+#endif /* HAVE_MULTIFILTERS */
+
+    return 0;
+}
+
+/**
+ * Learn whether LZ4 compression is on for a variable, and, if so,
+ * the block size and acceleration. LZ4HC counts as LZ4.
+ *
+ * @param ncid File ID.
+ * @param varid Variable ID.
+ * @param lz4p Pointer that gets a 0 if LZ4 is not in use for this
+ * var, and a 1 if it is. Ignored if NULL.
+ * @param block_sizep Pointer that gets the block size in bytes (0 for
+ * one block per chunk), if LZ4 is in use. Ignored if NULL.
+ * @param accelerationp Pointer that gets the acceleration (1 if the
+ * file does not record one), if LZ4 is in use. Ignored if NULL.
+ *
+ * @return 0 for success, error code otherwise.
+ * @author Charlie Zender
+ */
+int
+nc_inq_var_lz4(int ncid, int varid, int *lz4p, int *block_sizep, int *accelerationp)
+{
+    unsigned int prm[LZ4_FLT_PRM_NBR] = {0};
+    int lz4 = 0; /* Is lz4 in use? */
+    int ret;
+
+    if ((ret = ccr_inq_var_lz4_prm(ncid, varid, &lz4, prm)))
+        return ret;
+
+    /* Does caller want to know if lz4 is in use? */
+    if (lz4p)
+        *lz4p = lz4;
+
+    /* Tell the caller, if they want to know. */
+    if (lz4 && block_sizep)
+        *block_sizep = (int)prm[0];
+    if (lz4 && accelerationp)
+        *accelerationp = prm[1] ? (int)prm[1] : 1;
+
+    return 0;
+}
+
+/**
+ * Turn on LZ4 compression for a variable, using the LZ4HC (high
+ * compression) encoder.
+ *
+ * LZ4HC searches much harder for matches than LZ4, so it compresses
+ * several times more slowly, and better. It writes ordinary LZ4
+ * blocks, so data decompress at full LZ4 speed with any HDF5 LZ4
+ * filter. Use it for data written once and read many times.
+ *
+ * If the LZ4 filter was built without LZ4HC, it writes with LZ4.
+ *
+ * @param ncid File ID.
+ * @param varid Variable ID.
+ * @param block_size Size in bytes of the blocks each chunk is split
+ * into, from 1 to LZ4_MAX_BLOCK_SIZE, or 0 for the default of 256
+ * kB.
+ * @param level From 1 to LZ4HC_MAX_LEVEL (12). LZ4HC's default is 9.
+ *
+ * @return 0 for success, error code otherwise.
+ * @author Charlie Zender
+ */
+int
+nc_def_var_lz4hc(int ncid, int varid, int block_size, int level)
+{
+    unsigned int cd_value[LZ4_FLT_PRM_NBR];
+    int ret;
+
+    /* Block size must be between 0 (default) and LZ4_MAX_BLOCK_SIZE. */
+    if (block_size < 0 || block_size > LZ4_MAX_BLOCK_SIZE)
+        return NC_EINVAL;
+
+    /* Level must be between 1 and 12. */
+    if (level < 1 || level > LZ4HC_MAX_LEVEL)
+        return NC_EINVAL;
+
+    if (!H5Zfilter_avail(LZ4_ID))
+    {
+        printf ("lz4 filter not available.\n");
+        return NC_EFILTER;
+    }
+
+    /* Block size, default acceleration (unused by LZ4HC), and level. */
+    cd_value[0] = block_size;
+    cd_value[1] = 1;
+    cd_value[2] = level;
+
+    /* Set up the lz4 filter for this var. */
+    if ((ret = nc_def_var_filter(ncid, varid, LZ4_ID, LZ4_FLT_PRM_NBR, cd_value)))
+        return ret;
+
+    return 0;
+}
+
+/**
+ * Learn whether LZ4 compression with LZ4HC is on for a variable,
+ * and, if so, the block size and LZ4HC level.
+ *
+ * @param ncid File ID.
+ * @param varid Variable ID.
+ * @param lz4hcp Pointer that gets a 0 if LZ4HC is not in use for this
+ * var, and a 1 if it is. Ignored if NULL.
+ * @param block_sizep Pointer that gets the block size in bytes (0 for
+ * one block per chunk), if LZ4HC is in use. Ignored if NULL.
+ * @param levelp Pointer that gets the LZ4HC level (from 1 to 12), if
+ * LZ4HC is in use. Ignored if NULL.
+ *
+ * @return 0 for success, error code otherwise.
+ * @author Charlie Zender
+ */
+int
+nc_inq_var_lz4hc(int ncid, int varid, int *lz4hcp, int *block_sizep, int *levelp)
+{
+    unsigned int prm[LZ4_FLT_PRM_NBR] = {0};
+    int lz4 = 0; /* Is lz4 in use? */
+    int ret;
+
+    if ((ret = ccr_inq_var_lz4_prm(ncid, varid, &lz4, prm)))
+        return ret;
+
+    /* LZ4 without an LZ4HC level does not count. */
+    if (!prm[2])
+        lz4 = 0;
+
+    /* Does caller want to know if LZ4HC is in use? */
+    if (lz4hcp)
+        *lz4hcp = lz4;
+
+    /* Tell the caller, if they want to know. */
+    if (lz4 && block_sizep)
+        *block_sizep = (int)prm[0];
+    if (lz4 && levelp)
+        *levelp = (int)prm[2];
+
+    return 0;
+}
+
+/**
+ * Turn on BitGroom quantization for a variable.
+ *
+ * The BitGroom filter quantizes the data by setting unneeded bits
+ * alternately to 1/0, so that they may compress well. The BitGroom
+ * filter itself is lossy (data are irretrievably altered), and it
+ * improves the compression ratio provided by a subsequent lossless 
+ * compression filter. Call the nc_def_var_bitgroom() function before
+ * the function that turns on the lossless compression filter
+ * (nc_def_var_deflate(), for example). 
+ *
+ * A notable feature of BitGroom is that the data it processes remain 
+ * in IEEE754 format after quantization. Therefore the BitGroom filter 
+ * does nothing when data are read. However, the Bitgroom filter must 
+ * still be installed on machines that need to read bitgroomed data.
+ *
+ * The BitGroom filter only quantizes variables of type NC_FLOAT or
+ * NC_DOUBLE. Attempts to set the BitGroom filter for other variable
+ * types through the C/Fortran API return an error (NC_EINVAL). The
+ * filter does not quantize values equal to the value of the
+ * _FillValue attribute, if any. The main difference between the
+ * BitGroom algorithm as implemented in the CCR and in NCO is that the
+ * NCO version will not quantize the values of "coordinate-like"
+ * variables (e.g., latitude, longitude, time) as defined in the NCO
+ * manual, whereas the CCR version will quantize any floating-point
+ * variable.
+ *
+ * @note Internally, the filter requires CCR_FLT_PRM_NBR (=5) elements
+ * for cd_value. However, the user needs to provide only the first
+ * element, NSD, since the other elements can be and are derived from
+ * the dcpl (data_class, datum_size), and extra queries of the
+ * variable (has_mss_val, mss_val). Hence, the netCDF API exposes to
+ * the user and requires setting only the minimal number (1) of filter
+ * parameters.
+
+ * @param ncid File ID.
+ * @param varid Variable ID.
+ * @param nsd Number of significant digits to retain. Allowed single- and
+ * double-precision NSDs are 1-7 and 1-15, respectively. (Default is 3).
+ *
+ * @return 0 for success, error code otherwise.
+ * @author Charlie Zender
+ */
+int
+nc_def_var_bitgroom(int ncid, int varid, int nsd)
+{
+  unsigned int cd_value[BITGROOM_FLT_PRM_NBR] = {0};
+  int ret;
+  nc_type var_typ;
+  
+  /* BitGroom only quantizes floating-point values */
+  if ((ret = nc_inq_vartype(ncid, varid, &var_typ)))
+    return ret;
+
+  if (var_typ != NC_FLOAT && var_typ != NC_DOUBLE)
+  {
+      /* printf ("BitGroom filter can only be defined for floating-point variables.\n"); */
+      return NC_EINVAL;
+  }
+  
+  /* NSD must be between 1 and 7 for NC_FLOAT, 1 and 15 for
+   * NC_DOUBLE. */
+  if (nsd < 1 || nsd > (var_typ == NC_FLOAT ? MAX_BITGROOM_NSD_FLOAT : MAX_BITGROOM_NSD_DOUBLE))
+    return NC_EINVAL;
+
+  if (!H5Zfilter_avail(BITGROOM_ID))
+  {
+      printf ("BitGroom filter not available.\n");
+      return NC_EFILTER;
+  }
+
+  /* User-provided NSD is first element of filter parameter array */
+  cd_value[0] = nsd;
+
+  /* Set up the BitGroom filter for this var. */
+  if ((ret = nc_def_var_filter(ncid, varid, BITGROOM_ID, BITGROOM_FLT_PRM_NBR, cd_value)))
+    return ret;
+
+  return 0;
+}
+
+/**
+ * Learn whether BitGroom is on for a variable, and, if so, its
+ * internal filter parameters.
+ *
+ * @param ncid File ID.
+ * @param varid Variable ID.
+ * @param bitgroomp Pointer that gets a 0 if BitGroom is not in use
+ * for this var, and a 1 if it is. Ignored if NULL.
+ * @param prm Array of BITGROOM_ABS_FLT_PRM_NBR elements that gets the
+ * filter parameters, if BitGroom is in use. Elements a file does not
+ * store are left unchanged.
+ *
+ * @return 0 for success, error code otherwise.
+ * @author Charlie Zender
+ */
+static int
+ccr_inq_var_bitgroom_prm(int ncid, int varid, int *bitgroomp, unsigned int *prm)
+{
+  size_t nparams;
+  int bitgroom = 0; /* Is BitGroom in use? */
+  int ret;
+  
+#ifdef HAVE_MULTIFILTERS
+    {
+	size_t nfilters;
+	unsigned int *filterids;
+	int f;
+	
+	/* Get filter information. */
+	if ((ret = nc_inq_var_filter_ids(ncid, varid, &nfilters, NULL)))
+	    return ret;
+	
+	/* If there are no filters, we're done. */
+	if (nfilters == 0)
+	{
+	    if (bitgroomp)
+		*bitgroomp = 0;
+	    return 0;
+	}
+
+	/* Allocate storage for filter IDs. */
+	if (!(filterids = malloc(nfilters * sizeof(unsigned int))))
+	    return NC_ENOMEM;
+
+	/* Get the filter IDs. */
+	if ((ret = nc_inq_var_filter_ids(ncid, varid, &nfilters, filterids)))
+	    return ret;
+    
+	/* Check each filter to see if it is BitGroom. */
+	for (f = 0; f < nfilters; f++)
+	{
+	    if (filterids[f] == BITGROOM_ID)
+		bitgroom++;
+
+	    /* If BitGroom is in use, check parameter. */
+	    if (bitgroom)
+	    {
+	    
+		/* Count the parameters before reading them. */
+		if ((ret = nc_inq_var_filter_info(ncid, varid, filterids[f], &nparams, NULL)))
+		{
+		    free(filterids);
+		    return ret;
+		}
+
+		/* BitGroom has BITGROOM_FLT_PRM_NBR == 5 internal parameters,
+		   or BITGROOM_ABS_FLT_PRM_NBR == 7 in absolute error mode. */
+		if (nparams != BITGROOM_FLT_PRM_NBR && nparams != BITGROOM_ABS_FLT_PRM_NBR)
+		{
+		    free(filterids);
+		    return NC_EFILTER;
+		}
+		if ((ret = nc_inq_var_filter_info(ncid, varid, filterids[f], &nparams, prm)))
+		{
+		    free(filterids);
+		    return ret;
+		}
+
+		/* Exit loop to report parameters (neglect remaining filters) */
+		break;
+
+	    }
+	}
+
+	/* Free resources. */
+	free(filterids);
+
+	/* Does caller want to know if BitGroom is in use? */
+	if (bitgroomp)
+	    *bitgroomp = bitgroom;
+    }
+#else
+    {
+	unsigned int id;
+
+	/* Get filter information. */
+	ret = nc_inq_var_filter(ncid, varid, &id, &nparams, NULL);
+	if (ret == NC_ENOFILTER)
+	  {
+	    if (bitgroomp)
+	      *bitgroomp = 0;
+	    return 0;
+	  }
+	else if (ret)
+	  return ret;
+  
+	/* Is BitGroom in use? */
+	if (id == BITGROOM_ID)
+	  bitgroom++;
+  
+	/* Does caller want to know if BitGroom is in use? */
+	if (bitgroomp)
+	  *bitgroomp = bitgroom;
+  
+	/* If BitGroom is in use, check parameter. */
+	if (bitgroom)
+	  {
+	    /* BitGroom has BITGROOM_FLT_PRM_NBR == 5 internal parameters,
+	       or BITGROOM_ABS_FLT_PRM_NBR == 7 in absolute error mode. */
+	    if (nparams != BITGROOM_FLT_PRM_NBR && nparams != BITGROOM_ABS_FLT_PRM_NBR)
+	      return NC_EFILTER;
+	    if ((ret = nc_inq_var_filter(ncid, varid, &id, &nparams, prm)))
+	      return ret;
+	  }
+    }
+#endif /* HAVE_MULTIFILTERS */
+  return 0;
+}
+
+/**
+ * Learn whether BitGroom quantization is on for a variable, and, if so,
+ * the NSD setting.
+ *
+ * @param ncid File ID.
+ * @param varid Variable ID.
+ * @param bitgroomp Pointer that gets a 0 if BitGroom is not in use for this
+ * var, and a 1 if it is. Ignored if NULL.
+ * @param nsdp Pointer that gets the NSD setting (from 1 to 15), if
+ * BitGroom is in use, or 0 if BitGroom quantizes to an absolute error
+ * (see nc_inq_var_bitgroom_abs()). Ignored if NULL.
+ *
+ * @return 0 for success, error code otherwise.
+ * @author Charlie Zender
+ */
+int
+nc_inq_var_bitgroom(int ncid, int varid, int *bitgroomp, int *nsdp)
+{
+  unsigned int prm[BITGROOM_ABS_FLT_PRM_NBR] = {0};
+  int bitgroom = 0; /* Is BitGroom in use? */
+  int ret;
+
+  if ((ret = ccr_inq_var_bitgroom_prm(ncid, varid, &bitgroom, prm)))
+    return ret;
+
+  /* Does caller want to know if BitGroom is in use? */
+  if (bitgroomp)
+    *bitgroomp = bitgroom;
+
+  /* BitGroom has BITGROOM_FLT_PRM_NBR == 5 internal parameters.
+     We expose only the first (NSD) through this API because a variable's properties 
+     uniquely determine the remainder and exposing them to users, well, invites disaster */
+  if (bitgroom && nsdp)
+    *nsdp = (int)prm[0];
+
+  return 0;
+}
+
+/**
+ * Turn on BitGroom quantization to an absolute error for a variable.
+ *
+ * NSD quantization keeps the same number of significant digits in
+ * every value, so values near zero keep mantissa bits that resolve
+ * differences far below the precision of the data. This mode instead
+ * keeps only the mantissa bits worth more than the requested absolute
+ * error, so small values keep fewer bits than large values, and every
+ * quantized value differs from the original by at most abs_err.
+ * BitGroom alternately shaves and sets the unneeded bits, so errors
+ * average out. Fields that mix tiny and large magnitudes, such as specific
+ * humidity or aerosol optical depth, compress much better this way.
+ *
+ * As in NSD mode, the filter does not quantize values equal to the
+ * _FillValue, and leaves zeros, subnormals, infinities, and NaNs
+ * untouched. The BitGroom filter only quantizes variables of type
+ * NC_FLOAT or NC_DOUBLE. Attempts to set it for other variable types
+ * through the C/Fortran API return an error (NC_EINVAL).
+ *
+ * @note Internally, the filter stores an NSD of 0 in the first
+ * element of cd_value, and abs_err in the sixth and seventh.
+ *
+ * @param ncid File ID.
+ * @param varid Variable ID.
+ * @param abs_err Maximum absolute error, in the units of the
+ * variable. Must be positive.
+ *
+ * @return 0 for success, error code otherwise.
+ * @author Charlie Zender
+ */
+int
+nc_def_var_bitgroom_abs(int ncid, int varid, double abs_err)
+{
+  unsigned int cd_value[BITGROOM_ABS_FLT_PRM_NBR] = {0};
+  int ret;
+  nc_type var_typ;
+  
+  /* BitGroom only quantizes floating-point values */
+  if ((ret = nc_inq_vartype(ncid, varid, &var_typ)))
+    return ret;
+
+  if (var_typ != NC_FLOAT && var_typ != NC_DOUBLE)
+    return NC_EINVAL;
+
+  /* Absolute error must be positive and finite. Negated test also
+   * rejects NaN. */
+  if (!(abs_err > 0.0 && abs_err <= DBL_MAX))
+    return NC_EINVAL;
+
+  if (!H5Zfilter_avail(BITGROOM_ID))
+  {
+      printf ("BitGroom filter not available.\n");
+      return NC_EFILTER;
+  }
+
+  /* NSD of 0 selects absolute error, which fills sixth and seventh elements */
+  cd_value[0] = 0;
+  memcpy(cd_value + 5, &abs_err, sizeof(double));
+
+  /* Set up the BitGroom filter for this var. */
+  if ((ret = nc_def_var_filter(ncid, varid, BITGROOM_ID, BITGROOM_ABS_FLT_PRM_NBR, cd_value)))
+    return ret;
+
+  return 0;
+}
+
+/**
+ * Learn whether BitGroom quantization to an absolute error is on for a
+ * variable, and, if so, the absolute error.
+ *
+ * @param ncid File ID.
+ * @param varid Variable ID.
+ * @param bitgroom_absp Pointer that gets a 1 if BitGroom quantizes this
+ * var to an absolute error, and a 0 otherwise, including when
+ * BitGroom uses NSD. Ignored if NULL.
+ * @param abs_errp Pointer that gets the absolute error, if BitGroom
+ * quantizes to an absolute error. Ignored if NULL.
+ *
+ * @return 0 for success, error code otherwise.
+ * @author Charlie Zender
+ */
+int
+nc_inq_var_bitgroom_abs(int ncid, int varid, int *bitgroom_absp, double *abs_errp)
+{
+  unsigned int prm[BITGROOM_ABS_FLT_PRM_NBR] = {0};
+  int bitgroom = 0; /* Is BitGroom in use? */
+  int ret;
+
+  if ((ret = ccr_inq_var_bitgroom_prm(ncid, varid, &bitgroom, prm)))
+    return ret;
+
+  /* Absolute error mode is BitGroom with NSD of 0 */
+  if (bitgroom && prm[0] != 0)
+    bitgroom = 0;
+
+  /* Does caller want to know if absolute error mode is in use? */
+  if (bitgroom_absp)
+    *bitgroom_absp = bitgroom;
+
+  /* Tell the caller, if they want to know. */
+  if (bitgroom && abs_errp)
+    memcpy(abs_errp, prm + 5, sizeof(double));
+
+  return 0;
+}
+
+/**
+ * Turn on Granular BitRound quantization for a variable.
+ *
+ * The Granular BitRound (GBR) filter quantizes the data by setting
+ * unneeded bits to 0, so that they may compress well. GBR is in all
+ * external respects similar to BitGroom. The following paragraph
+ * describes the differences between GBR and BitGroom, and the rest
+ * this preamble, and the postamble are identical to the BitGroom docs.
+ * The filter itself is lossy (data are irretrievably altered), and it
+ * improves the compression ratio provided by a subsequent lossless 
+ * compression filter. Call the nc_def_var_granularbr() function before
+ * the function that turns on the lossless compression filter
+ * (nc_def_var_deflate(), for example). 
+ *
+ * Granular BitRound is a second generation quantization filter that
+ * incorporates aspects of the BitGroom, DigitRound, and BitRound algorithms.
+ * GBR determines the quantization mask for each value independently using
+ * the basse-10 logarithm method discussed in the DigitRound paper. 
+ * GBR computes exact log10() of every number, in contrast to DigitRound
+ * which uses a lookup table for speed. This makes GBR slower than DR.
+ * However, GBR-quantized values will use the same mask regardless of the
+ * sign of the input value, where DR might produce slightly different masks.
+ * Another difference is that GBR uses the BitRound rounding method, rather
+ * than reconstructing the scalar quantization at bin center.
+ * Similar to BitGroom, GBR ignores the value zero, and the _FillValue.
+ * GBR quantizes a few more bits than BitGroom from the raw number yet
+ * still maintains the precision guarantee, thus the quantization error 
+ * of GBR is larger than BitGroom. GBR improver compression rations 
+ * by ~20% relative to BitGroom for typical climate data with NSD = 3.
+ *
+ * A notable feature of GranularBR is that the data it processes remain 
+ * in IEEE754 format after quantization. Therefore the GranularBR filter 
+ * does nothing when data are read. However, the Bitgroom filter must 
+ * still be installed on machines that need to read bitgroomed data.
+ *
+ * The GranularBR filter only quantizes variables of type NC_FLOAT or
+ * NC_DOUBLE. Attempts to set the GranularBR filter for other variable
+ * types through the C/Fortran API return an error (NC_EINVAL). The
+ * filter does not quantize values equal to the value of the
+ * _FillValue attribute, if any. The main difference between the
+ * GranularBR algorithm as implemented in the CCR and in NCO is that the
+ * NCO version will not quantize the values of "coordinate-like"
+ * variables (e.g., latitude, longitude, time) as defined in the NCO
+ * manual, whereas the CCR version will quantize any floating-point
+ * variable.
+ *
+ * @note Internally, the filter requires CCR_FLT_PRM_NBR (=5) elements
+ * for cd_value. However, the user needs to provide only the first
+ * element, NSD, since the other elements can be and are derived from
+ * the dcpl (data_class, datum_size), and extra queries of the
+ * variable (has_mss_val, mss_val). Hence, the netCDF API exposes to
+ * the user and requires setting only the minimal number (1) of filter
+ * parameters.
+
+ * @param ncid File ID.
+ * @param varid Variable ID.
+ * @param nsd Number of significant digits to retain. Allowed single- and
+ * double-precision NSDs are 1-7 and 1-15, respectively. (Default is 3).
+ *
+ * @return 0 for success, error code otherwise.
+ * @author Charlie Zender
+ */
+int
+nc_def_var_granularbr(int ncid, int varid, int nsd)
+{
+  unsigned int cd_value[GRANULARBR_FLT_PRM_NBR] = {0};
+  int ret;
+  nc_type var_typ;
+  
+  /* Granular BitRound only quantizes floating-point values */
+  if ((ret = nc_inq_vartype(ncid, varid, &var_typ)))
+    return ret;
+
+  if (var_typ != NC_FLOAT && var_typ != NC_DOUBLE)
+  {
+      /* printf ("Granular BitRound filter can only be defined for floating-point variables.\n"); */
+      return NC_EINVAL;
+  }
+  
+  /* NSD must be between 1 and 7 for NC_FLOAT, 1 and 15 for
+   * NC_DOUBLE. */
+  if (nsd < 1 || nsd > (var_typ == NC_FLOAT ? MAX_GRANULARBR_NSD_FLOAT : MAX_GRANULARBR_NSD_DOUBLE))
+    return NC_EINVAL;
+
+  if (!H5Zfilter_avail(GRANULARBR_ID))
+  {
+      printf ("Granular BitRound filter not available.\n");
+      return NC_EFILTER;
+  }
+
+  /* User-provided NSD is first element of filter parameter array */
+  cd_value[0] = nsd;
+
+  /* Set up the Granular BitRound filter for this var. */
+  if ((ret = nc_def_var_filter(ncid, varid, GRANULARBR_ID, GRANULARBR_FLT_PRM_NBR, cd_value)))
+    return ret;
+
+  return 0;
+}
+
+/**
+ * Learn whether Granular BitRound is on for a variable, and, if so, its
+ * internal filter parameters.
+ *
+ * @param ncid File ID.
+ * @param varid Variable ID.
+ * @param granularbrp Pointer that gets a 0 if Granular BitRound is not in use
+ * for this var, and a 1 if it is. Ignored if NULL.
+ * @param prm Array of GRANULARBR_ABS_FLT_PRM_NBR elements that gets the
+ * filter parameters, if Granular BitRound is in use. Elements a file does not
+ * store are left unchanged.
+ *
+ * @return 0 for success, error code otherwise.
+ * @author Charlie Zender
+ */
+static int
+ccr_inq_var_granularbr_prm(int ncid, int varid, int *granularbrp, unsigned int *prm)
+{
+  size_t nparams;
+  int granularbr = 0; /* Is Granular BitRound in use? */
+  int ret;
+  
+#ifdef HAVE_MULTIFILTERS
+    {
+	size_t nfilters;
+	unsigned int *filterids;
+	int f;
+	
+	/* Get filter information. */
+	if ((ret = nc_inq_var_filter_ids(ncid, varid, &nfilters, NULL)))
+	    return ret;
+	
+	/* If there are no filters, we're done. */
+	if (nfilters == 0)
+	{
+	    if (granularbrp)
+		*granularbrp = 0;
+	    return 0;
+	}
+
+	/* Allocate storage for filter IDs. */
+	if (!(filterids = malloc(nfilters * sizeof(unsigned int))))
+	    return NC_ENOMEM;
+
+	/* Get the filter IDs. */
+	if ((ret = nc_inq_var_filter_ids(ncid, varid, &nfilters, filterids)))
+	    return ret;
+    
+	/* Check each filter to see if it is Granular BitRound. */
+	for (f = 0; f < nfilters; f++)
+	{
+	    if (filterids[f] == GRANULARBR_ID)
+		granularbr++;
+
+	    /* If Granular BitRound is in use, check parameter. */
+	    if (granularbr)
+	    {
+	    
+		/* Count the parameters before reading them. */
+		if ((ret = nc_inq_var_filter_info(ncid, varid, filterids[f], &nparams, NULL)))
+		{
+		    free(filterids);
+		    return ret;
+		}
+
+		/* Granular BitRound has GRANULARBR_FLT_PRM_NBR == 5 internal parameters,
+		   or GRANULARBR_ABS_FLT_PRM_NBR == 7 in absolute error mode. */
+		if (nparams != GRANULARBR_FLT_PRM_NBR && nparams != GRANULARBR_ABS_FLT_PRM_NBR)
+		{
+		    free(filterids);
+		    return NC_EFILTER;
+		}
+		if ((ret = nc_inq_var_filter_info(ncid, varid, filterids[f], &nparams, prm)))
+		{
+		    free(filterids);
+		    return ret;
+		}
+
+		/* Exit loop to report parameters (neglect remaining filters) */
+		break;
+
+	    }
+	}
+
+	/* Free resources. */
+	free(filterids);
+
+	/* Does caller want to know if Granular BitRound is in use? */
+	if (granularbrp)
+	    *granularbrp = granularbr;
+    }
+#else
+    {
+	unsigned int id;
+
+	/* Get filter information. */
+	ret = nc_inq_var_filter(ncid, varid, &id, &nparams, NULL);
+	if (ret == NC_ENOFILTER)
+	  {
+	    if (granularbrp)
+	      *granularbrp = 0;
+	    return 0;
+	  }
+	else if (ret)
+	  return ret;
+  
+	/* Is Granular BitRound in use? */
+	if (id == GRANULARBR_ID)
+	  granularbr++;
+  
+	/* Does caller want to know if Granular BitRound is in use? */
+	if (granularbrp)
+	  *granularbrp = granularbr;
+  
+	/* If Granular BitRound is in use, check parameter. */
+	if (granularbr)
+	  {
+	    /* Granular BitRound has GRANULARBR_FLT_PRM_NBR == 5 internal parameters,
+	       or GRANULARBR_ABS_FLT_PRM_NBR == 7 in absolute error mode. */
+	    if (nparams != GRANULARBR_FLT_PRM_NBR && nparams != GRANULARBR_ABS_FLT_PRM_NBR)
+	      return NC_EFILTER;
+	    if ((ret = nc_inq_var_filter(ncid, varid, &id, &nparams, prm)))
+	      return ret;
+	  }
+    }
+#endif /* HAVE_MULTIFILTERS */
+  return 0;
+}
+
+/**
+ * Learn whether Granular BitRound quantization is on for a variable, and, if so,
+ * the NSD setting.
+ *
+ * @param ncid File ID.
+ * @param varid Variable ID.
+ * @param granularbrp Pointer that gets a 0 if Granular BitRound is not in use for this
+ * var, and a 1 if it is. Ignored if NULL.
+ * @param nsdp Pointer that gets the NSD setting (from 1 to 15), if
+ * Granular BitRound is in use, or 0 if Granular BitRound quantizes
+ * to an absolute error (see nc_inq_var_granularbr_abs()). Ignored if
+ * NULL.
+ *
+ * @return 0 for success, error code otherwise.
+ * @author Charlie Zender
+ */
+int
+nc_inq_var_granularbr(int ncid, int varid, int *granularbrp, int *nsdp)
+{
+  unsigned int prm[GRANULARBR_ABS_FLT_PRM_NBR] = {0};
+  int granularbr = 0; /* Is Granular BitRound in use? */
+  int ret;
+
+  if ((ret = ccr_inq_var_granularbr_prm(ncid, varid, &granularbr, prm)))
+    return ret;
+
+  /* Does caller want to know if Granular BitRound is in use? */
+  if (granularbrp)
+    *granularbrp = granularbr;
+
+  /* Granular BitRound has GRANULARBR_FLT_PRM_NBR == 5 internal parameters.
+     We expose only the first (NSD) through this API because a variable's properties 
+     uniquely determine the remainder and exposing them to users, well, invites disaster */
+  if (granularbr && nsdp)
+    *nsdp = (int)prm[0];
+
+  return 0;
+}
+
+/**
+ * Turn on Granular BitRound quantization to an absolute error for a variable.
+ *
+ * NSD quantization keeps the same number of significant digits in
+ * every value, so values near zero keep mantissa bits that resolve
+ * differences far below the precision of the data. This mode instead
+ * keeps only the mantissa bits worth more than the requested absolute
+ * error, so small values keep fewer bits than large values, and every
+ * quantized value differs from the original by at most abs_err.
+ * Granular BitRound rounds to the nearest retained value, so it
+ * keeps one fewer bit than BitGroom for the same error. Fields that mix tiny and large magnitudes, such as specific
+ * humidity or aerosol optical depth, compress much better this way.
+ *
+ * As in NSD mode, the filter does not quantize values equal to the
+ * _FillValue, and leaves zeros, subnormals, infinities, and NaNs
+ * untouched. The Granular BitRound filter only quantizes variables of type
+ * NC_FLOAT or NC_DOUBLE. Attempts to set it for other variable types
+ * through the C/Fortran API return an error (NC_EINVAL).
+ *
+ * @note Internally, the filter stores an NSD of 0 in the first
+ * element of cd_value, and abs_err in the sixth and seventh.
+ *
+ * @param ncid File ID.
+ * @param varid Variable ID.
+ * @param abs_err Maximum absolute error, in the units of the
+ * variable. Must be positive.
+ *
+ * @return 0 for success, error code otherwise.
+ * @author Charlie Zender
+ */
+int
+nc_def_var_granularbr_abs(int ncid, int varid, double abs_err)
+{
+  unsigned int cd_value[GRANULARBR_ABS_FLT_PRM_NBR] = {0};
+  int ret;
+  nc_type var_typ;
+  
+  /* Granular BitRound only quantizes floating-point values */
+  if ((ret = nc_inq_vartype(ncid, varid, &var_typ)))
+    return ret;
+
+  if (var_typ != NC_FLOAT && var_typ != NC_DOUBLE)
+    return NC_EINVAL;
+
+  /* Absolute error must be positive and finite. Negated test also
+   * rejects NaN. */
+  if (!(abs_err > 0.0 && abs_err <= DBL_MAX))
+    return NC_EINVAL;
+
+  if (!H5Zfilter_avail(GRANULARBR_ID))
+  {
+      printf ("Granular BitRound filter not available.\n");
+      return NC_EFILTER;
+  }
+
+  /* NSD of 0 selects absolute error, which fills sixth and seventh elements */
+  cd_value[0] = 0;
+  memcpy(cd_value + 5, &abs_err, sizeof(double));
+
+  /* Set up the Granular BitRound filter for this var. */
+  if ((ret = nc_def_var_filter(ncid, varid, GRANULARBR_ID, GRANULARBR_ABS_FLT_PRM_NBR, cd_value)))
+    return ret;
+
+  return 0;
+}
+
+/**
+ * Learn whether Granular BitRound quantization to an absolute error is on for a
+ * variable, and, if so, the absolute error.
+ *
+ * @param ncid File ID.
+ * @param varid Variable ID.
+ * @param granularbr_absp Pointer that gets a 1 if Granular BitRound quantizes this
+ * var to an absolute error, and a 0 otherwise, including when
+ * Granular BitRound uses NSD. Ignored if NULL.
+ * @param abs_errp Pointer that gets the absolute error, if Granular BitRound
+ * quantizes to an absolute error. Ignored if NULL.
+ *
+ * @return 0 for success, error code otherwise.
+ * @author Charlie Zender
+ */
+int
+nc_inq_var_granularbr_abs(int ncid, int varid, int *granularbr_absp, double *abs_errp)
+{
+  unsigned int prm[GRANULARBR_ABS_FLT_PRM_NBR] = {0};
+  int granularbr = 0; /* Is Granular BitRound in use? */
+  int ret;
+
+  if ((ret = ccr_inq_var_granularbr_prm(ncid, varid, &granularbr, prm)))
+    return ret;
+
+  /* Absolute error mode is Granular BitRound with NSD of 0 */
+  if (granularbr && prm[0] != 0)
+    granularbr = 0;
+
+  /* Does caller want to know if absolute error mode is in use? */
+  if (granularbr_absp)
+    *granularbr_absp = granularbr;
+
+  /* Tell the caller, if they want to know. */
+  if (granularbr && abs_errp)
+    memcpy(abs_errp, prm + 5, sizeof(double));
+
+  return 0;
+}
+
+/**
+ * Turn on BitRound quantization for a variable.
+ *
+ * The BitRound filter quantizes the data by rounding each value to
+ * the nearest value that has only NSB explicit mantissa bits, and
+ * setting the remaining (unneeded) mantissa bits to 0, so that they
+ * may compress well. The filter itself is lossy (data are
+ * irretrievably altered), and it improves the compression ratio
+ * provided by a subsequent lossless compression filter. Call the
+ * nc_def_var_bitround() function before the function that turns on
+ * the lossless compression filter (nc_def_var_deflate(), for
+ * example).
+ *
+ * BitRound applies one mask to every value, whereas BitGroom and
+ * Granular BitRound derive their masks from a number of decimal
+ * digits. This makes BitRound the cheapest quantizer per element,
+ * which suits high-rate output. The maximum relative error is half
+ * of the last retained bit, i.e., 2^-(NSB+1). Rounding can carry into
+ * the exponent, so values within half a retained bit of the largest
+ * finite value may round to infinity.
+ *
+ * The data remain in IEEE754 format after quantization. Therefore
+ * the BitRound filter does nothing when data are read. However, the
+ * BitRound filter must still be installed on machines that need to
+ * read BitRounded data.
+ *
+ * The BitRound filter only quantizes variables of type NC_FLOAT or
+ * NC_DOUBLE. Attempts to set the BitRound filter for other variable
+ * types through the C/Fortran API return an error (NC_EINVAL). The
+ * filter does not quantize values equal to the value of the
+ * _FillValue attribute, if any.
+ *
+ * @note Internally, the filter requires CCR_FLT_PRM_NBR (=5) elements
+ * for cd_value. However, the user needs to provide only the first
+ * element, NSB, since the other elements can be and are derived from
+ * the dcpl (data_class, datum_size), and extra queries of the
+ * variable (has_mss_val, mss_val). nc_def_var_bitround_auto() adds a
+ * sixth element, the information level. Hence, the netCDF API
+ * exposes to the user and requires setting only the minimal number
+ * (1) of filter parameters.
+ *
+ * @param ncid File ID.
+ * @param varid Variable ID.
+ * @param nsb Number of explicit mantissa bits to retain. Allowed
+ * single- and double-precision NSBs are 1-23 and 1-52,
+ * respectively. NSBs of 23 (float) and 52 (double) leave data
+ * unchanged.
+ *
+ * @return 0 for success, error code otherwise.
+ * @author Charlie Zender
+ */
+int
+nc_def_var_bitround(int ncid, int varid, int nsb)
+{
+  unsigned int cd_value[BITROUND_FLT_PRM_NBR] = {0};
+  int ret;
+  nc_type var_typ;
+  
+  /* BitRound only quantizes floating-point values */
+  if ((ret = nc_inq_vartype(ncid, varid, &var_typ)))
+    return ret;
+
+  if (var_typ != NC_FLOAT && var_typ != NC_DOUBLE)
+    return NC_EINVAL;
+  
+  /* NSB must be between 1 and 23 for NC_FLOAT, 1 and 52 for
+   * NC_DOUBLE. */
+  if (nsb < 1 || nsb > (var_typ == NC_FLOAT ? MAX_BITROUND_NSB_FLOAT : MAX_BITROUND_NSB_DOUBLE))
+    return NC_EINVAL;
+
+  if (!H5Zfilter_avail(BITROUND_ID))
+  {
+      printf ("BitRound filter not available.\n");
+      return NC_EFILTER;
+  }
+
+  /* User-provided NSB is first element of filter parameter array */
+  cd_value[0] = nsb;
+
+  /* Set up the BitRound filter for this var. */
+  if ((ret = nc_def_var_filter(ncid, varid, BITROUND_ID, BITROUND_FLT_PRM_NBR, cd_value)))
+    return ret;
+
+  return 0;
+}
+
+/**
+ * Learn whether BitRound is on for a variable, and, if so, its
+ * internal filter parameters.
+ *
+ * @param ncid File ID.
+ * @param varid Variable ID.
+ * @param bitroundp Pointer that gets a 0 if BitRound is not in use
+ * for this var, and a 1 if it is. Ignored if NULL.
+ * @param prm Array of BITROUND_AUTO_FLT_PRM_NBR elements that gets the
+ * filter parameters, if BitRound is in use. Elements a file does not
+ * store are left unchanged.
+ *
+ * @return 0 for success, error code otherwise.
+ * @author Charlie Zender
+ */
+static int
+ccr_inq_var_bitround_prm(int ncid, int varid, int *bitroundp, unsigned int *prm)
+{
+  size_t nparams;
+  int bitround = 0; /* Is BitRound in use? */
+  int ret;
+  
+#ifdef HAVE_MULTIFILTERS
+    {
+	size_t nfilters;
+	unsigned int *filterids;
+	int f;
+	
+	/* Get filter information. */
+	if ((ret = nc_inq_var_filter_ids(ncid, varid, &nfilters, NULL)))
+	    return ret;
+	
+	/* If there are no filters, we're done. */
+	if (nfilters == 0)
+	{
+	    if (bitroundp)
+		*bitroundp = 0;
+	    return 0;
+	}
+
+	/* Allocate storage for filter IDs. */
+	if (!(filterids = malloc(nfilters * sizeof(unsigned int))))
+	    return NC_ENOMEM;
+
+	/* Get the filter IDs. */
+	if ((ret = nc_inq_var_filter_ids(ncid, varid, &nfilters, filterids)))
+	{
+	    free(filterids);
+	    return ret;
+	}
+    
+	/* Check each filter to see if it is BitRound. */
+	for (f = 0; f < nfilters; f++)
+	{
+	    if (filterids[f] == BITROUND_ID)
+		bitround++;
+
+	    /* If BitRound is in use, check parameter. */
+	    if (bitround)
+	    {
+	    
+		/* Count the parameters before reading them. */
+		if ((ret = nc_inq_var_filter_info(ncid, varid, filterids[f], &nparams, NULL)))
+		{
+		    free(filterids);
+		    return ret;
+		}
+
+		/* BitRound has BITROUND_FLT_PRM_NBR == 5 internal parameters,
+		   and BITROUND_AUTO_FLT_PRM_NBR == 6 with automatic NSB. */
+		if (nparams != BITROUND_FLT_PRM_NBR && nparams != BITROUND_AUTO_FLT_PRM_NBR)
+		{
+		    free(filterids);
+		    return NC_EFILTER;
+		}
+		if ((ret = nc_inq_var_filter_info(ncid, varid, filterids[f], &nparams, prm)))
+		{
+		    free(filterids);
+		    return ret;
+		}
+
+		/* Exit loop to report parameters (neglect remaining filters) */
+		break;
+
+	    }
+	}
+
+	/* Free resources. */
+	free(filterids);
+
+	/* Does caller want to know if BitRound is in use? */
+	if (bitroundp)
+	    *bitroundp = bitround;
+    }
+#else
+    {
+	unsigned int id;
+
+	/* Get filter information. */
+	ret = nc_inq_var_filter(ncid, varid, &id, &nparams, NULL);
+	if (ret == NC_ENOFILTER)
+	  {
+	    if (bitroundp)
+	      *bitroundp = 0;
+	    return 0;
+	  }
+	else if (ret)
+	  return ret;
+  
+	/* Is BitRound in use? */
+	if (id == BITROUND_ID)
+	  bitround++;
+  
+	/* Does caller want to know if BitRound is in use? */
+	if (bitroundp)
+	  *bitroundp = bitround;
+  
+	/* If BitRound is in use, check parameter. */
+	if (bitround)
+	  {
+	    /* BitRound has BITROUND_FLT_PRM_NBR == 5 internal parameters,
+	       and BITROUND_AUTO_FLT_PRM_NBR == 6 with automatic NSB. */
+	    if (nparams != BITROUND_FLT_PRM_NBR && nparams != BITROUND_AUTO_FLT_PRM_NBR)
+	      return NC_EFILTER;
+	    if ((ret = nc_inq_var_filter(ncid, varid, &id, &nparams, prm)))
+	      return ret;
+	  }
+    }
+#endif /* HAVE_MULTIFILTERS */
+  return 0;
+}
+
+/**
+ * Learn whether BitRound quantization is on for a variable, and, if
+ * so, the NSB setting.
+ *
+ * @param ncid File ID.
+ * @param varid Variable ID.
+ * @param bitroundp Pointer that gets a 0 if BitRound is not in use for this
+ * var, and a 1 if it is. Ignored if NULL.
+ * @param nsbp Pointer that gets the NSB setting (from 1 to 52), if
+ * BitRound is in use. Gets 0 if BitRound chooses NSB automatically,
+ * see nc_inq_var_bitround_auto(). Ignored if NULL.
+ *
+ * @return 0 for success, error code otherwise.
+ * @author Charlie Zender
+ */
+int
+nc_inq_var_bitround(int ncid, int varid, int *bitroundp, int *nsbp)
+{
+  unsigned int prm[BITROUND_AUTO_FLT_PRM_NBR] = {0};
+  int bitround = 0; /* Is BitRound in use? */
+  int ret;
+
+  if ((ret = ccr_inq_var_bitround_prm(ncid, varid, &bitround, prm)))
+    return ret;
+
+  /* Does caller want to know if BitRound is in use? */
+  if (bitroundp)
+    *bitroundp = bitround;
+
+  /* BitRound has BITROUND_FLT_PRM_NBR == 5 internal parameters.
+     We expose only the first (NSB) through this API because a variable's properties 
+     uniquely determine the remainder and exposing them to users, well, invites disaster */
+  if (bitround && nsbp)
+    *nsbp = (int)prm[0];
+
+  return 0;
+}
+
+/**
+ * Turn on BitRound quantization for a variable, with NSB chosen
+ * automatically from the information content of the data.
+ *
+ * Rather than a fixed NSB, the filter estimates the real information
+ * in each bit of each chunk it writes, and retains the fewest bits
+ * that hold the requested fraction (info_level) of that
+ * information. The estimate follows Klöwer et al. (2021), Nat.
+ * Comput. Sci., 1, 713-724: the information in a bit position is the
+ * mutual information between that bit in neighboring values along
+ * the fastest-varying dimension. Information indistinguishable, at
+ * 99% confidence, from that of random bits is treated as noise and
+ * discarded.
+ *
+ * Each chunk gets its own NSB, so smooth regions keep fewer bits
+ * than rough ones. The NSB is not stored because readers do not need
+ * it: as with nc_def_var_bitround(), data remain in IEEE754 format
+ * and the filter does nothing when data are read. Chunks whose bits
+ * vary but carry no real information (noise) retain one bit. Constant
+ * chunks, and chunks of fewer than about one thousand values, which
+ * are too small to estimate information reliably, are not
+ * quantized. Choose chunk sizes accordingly.
+ *
+ * Call this function instead of nc_def_var_bitround(), and before
+ * the function that turns on the lossless compression filter.
+ * Missing values are excluded from the estimate and are not
+ * quantized. Only variables of type NC_FLOAT or NC_DOUBLE may use
+ * BitRound; other types return NC_EINVAL.
+ *
+ * @param ncid File ID.
+ * @param varid Variable ID.
+ * @param info_level Fraction of the real information to retain,
+ * greater than 0 and at most 1. The filter stores it in parts per
+ * million. Typical values are 0.99 to 0.9999.
+ *
+ * @return 0 for success, error code otherwise.
+ * @author Charlie Zender
+ */
+int
+nc_def_var_bitround_auto(int ncid, int varid, double info_level)
+{
+  unsigned int cd_value[BITROUND_AUTO_FLT_PRM_NBR] = {0};
+  double inf_ppm; /* [ppm] Information level */
+  int ret;
+  nc_type var_typ;
+  
+  /* BitRound only quantizes floating-point values */
+  if ((ret = nc_inq_vartype(ncid, varid, &var_typ)))
+    return ret;
+
+  if (var_typ != NC_FLOAT && var_typ != NC_DOUBLE)
+    return NC_EINVAL;
+
+  /* Information level must be in (0,1], and survive conversion to
+   * parts per million. Negated test also rejects NaN. */
+  inf_ppm = info_level * 1.0e6 + 0.5;
+  if (!(info_level > 0.0 && info_level <= 1.0) || inf_ppm < 1.0)
+    return NC_EINVAL;
+
+  if (!H5Zfilter_avail(BITROUND_ID))
+  {
+      printf ("BitRound filter not available.\n");
+      return NC_EFILTER;
+  }
+
+  /* NSB of 0 requests automatic NSB at the stored information level */
+  cd_value[0] = 0;
+  cd_value[5] = (unsigned int)inf_ppm;
+
+  /* Set up the BitRound filter for this var. */
+  if ((ret = nc_def_var_filter(ncid, varid, BITROUND_ID, BITROUND_AUTO_FLT_PRM_NBR, cd_value)))
+    return ret;
+
+  return 0;
+}
+
+/**
+ * Learn whether BitRound quantization with automatic NSB is on for a
+ * variable, and, if so, the information level.
+ *
+ * @param ncid File ID.
+ * @param varid Variable ID.
+ * @param bitround_autop Pointer that gets a 1 if BitRound with
+ * automatic NSB is in use for this var, and a 0 otherwise, including
+ * when BitRound uses a fixed NSB. Ignored if NULL.
+ * @param info_levelp Pointer that gets the fraction of real
+ * information retained (greater than 0, at most 1), if BitRound
+ * with automatic NSB is in use. Ignored if NULL.
+ *
+ * @return 0 for success, error code otherwise.
+ * @author Charlie Zender
+ */
+int
+nc_inq_var_bitround_auto(int ncid, int varid, int *bitround_autop, double *info_levelp)
+{
+  unsigned int prm[BITROUND_AUTO_FLT_PRM_NBR] = {0};
+  int bitround = 0; /* Is BitRound in use? */
+  int ret;
+
+  if ((ret = ccr_inq_var_bitround_prm(ncid, varid, &bitround, prm)))
+    return ret;
+
+  /* Automatic NSB is BitRound with NSB of 0 */
+  if (bitround && prm[0] != 0)
+    bitround = 0;
+
+  /* Does caller want to know if automatic BitRound is in use? */
+  if (bitround_autop)
+    *bitround_autop = bitround;
+
+  /* Tell the caller, if they want to know. */
+  if (bitround && info_levelp)
+    *info_levelp = prm[5] / 1.0e6;
+
+  return 0;
+}
+
+/**
+ * Quantize a buffer of floating point values in memory.
+ *
+ * This applies the same BitGroom, Granular BitRound, or BitRound
+ * code that the quantization filters apply to each chunk they write,
+ * without a netCDF or HDF5 file. Quantize data once where they are
+ * produced, e.g., in model memory before an MPI gather or a network
+ * transfer. The quantized values are identical to those the filter
+ * with the same method and precision would write.
+ *
+ * Values equal to the fill value are not quantized. Large buffers
+ * are quantized by multiple threads when the CCR_THR_NBR environment
+ * variable is set, as in the filters.
+ *
+ * @param method Quantization method: CCR_QUANTIZE_BITGROOM,
+ * CCR_QUANTIZE_GRANULARBR, or CCR_QUANTIZE_BITROUND.
+ * @param nsd Number of significant digits (between 1 and 7 for
+ * NC_FLOAT, 1 and 15 for NC_DOUBLE) for BitGroom and Granular
+ * BitRound, or number of significant bits (between 1 and 23 for
+ * NC_FLOAT, 1 and 52 for NC_DOUBLE) for BitRound.
+ * @param type Type of values in buf, NC_FLOAT or NC_DOUBLE.
+ * @param buf Buffer of n values, quantized in place.
+ * @param n Number of values in buf.
+ * @param fill Pointer to the fill value, of the same type as the
+ * values in buf. If NULL, the default fill value for type is used.
+ *
+ * @return 0 for success, NC_EINVAL for an invalid method, precision,
+ * type, or buffer.
+ * @author Charlie Zender
+ */
+int
+ccr_quantize(int method, int nsd, nc_type type, void *buf, size_t n, const void *fill)
+{
+  ptr_unn mss_val;
+  ptr_unn op1;
+  int has_mss_val = fill ? 1 : 0;
+  int nsd_max;
+
+  /* Quantization only applies to floating-point values. */
+  if (type != NC_FLOAT && type != NC_DOUBLE)
+    return NC_EINVAL;
+  if (!buf && n)
+    return NC_EINVAL;
+
+  switch (method)
+  {
+  case CCR_QUANTIZE_BITGROOM:
+    nsd_max = type == NC_FLOAT ? MAX_BITGROOM_NSD_FLOAT : MAX_BITGROOM_NSD_DOUBLE;
+    break;
+  case CCR_QUANTIZE_GRANULARBR:
+    nsd_max = type == NC_FLOAT ? MAX_GRANULARBR_NSD_FLOAT : MAX_GRANULARBR_NSD_DOUBLE;
+    break;
+  case CCR_QUANTIZE_BITROUND:
+    nsd_max = type == NC_FLOAT ? MAX_BITROUND_NSB_FLOAT : MAX_BITROUND_NSB_DOUBLE;
+    break;
+  default:
+    return NC_EINVAL;
+  }
+  if (nsd < 1 || nsd > nsd_max)
+    return NC_EINVAL;
+
+  if (!n)
+    return 0;
+
+  /* Kernels only read the fill value. */
+  mss_val.vp = (void *)fill;
+  op1.vp = buf;
+
+  switch (method)
+  {
+  case CCR_QUANTIZE_BITGROOM:
+    ccr_bgr(nsd, type, n, has_mss_val, mss_val, op1);
+    break;
+  case CCR_QUANTIZE_GRANULARBR:
+    ccr_gbr(nsd, type, n, has_mss_val, mss_val, op1);
+    break;
+  case CCR_QUANTIZE_BITROUND:
+    ccr_btr(nsd, type, n, has_mss_val, mss_val, op1);
+    break;
+  }
+
+  return 0;
+}
+
+/**
+ * Turn on the Float16 filter for a variable.
+ *
+ * The Float16 filter stores each NC_FLOAT value in 16 bits, as
+ * either an IEEE 754 half-precision (binary16) or a bfloat16 value,
+ * and expands the values back to NC_FLOAT when data are read. Values
+ * are rounded to the nearest 16-bit value, ties to even. This halves
+ * the data passed to a subsequent lossless compressor, and the work
+ * that compressor must do to decompress them.
+ *
+ * Half precision keeps 10 explicit mantissa bits, i.e., about three
+ * significant digits, and represents magnitudes from about 6.0e-8 to
+ * 65504. Larger magnitudes become infinite, and magnitudes below
+ * 6.1e-5 lose precision. bfloat16 keeps only 7 explicit mantissa
+ * bits, i.e., two to three significant digits, but has the full range
+ * of NC_FLOAT. Choose bfloat16 for fields whose magnitudes exceed the
+ * half-precision range.
+ *
+ * Values equal to the value of the _FillValue attribute, or to the
+ * default fill value if there is no such attribute, are read back
+ * exactly. NaNs are read back as NaNs, without their payloads.
+ *
+ * Unlike the quantization filters, the Float16 filter changes the
+ * stored representation, so it must be installed on machines that
+ * read the data. Call nc_def_var_float16() before the function that
+ * turns on the lossless compression filter (nc_def_var_zstandard(),
+ * for example).
+ *
+ * The Float16 filter only applies to variables of type NC_FLOAT.
+ * Attempts to set it for other variable types through the C/Fortran
+ * API return an error (NC_EINVAL).
+ *
+ * @note Internally, the filter requires FLOAT16_FLT_PRM_NBR (=5)
+ * elements for cd_value, laid out as for the quantization filters.
+ * However, the user needs to provide only the first element, the
+ * storage format, since the filter derives the others from the
+ * variable.
+ *
+ * @param ncid File ID.
+ * @param varid Variable ID.
+ * @param format Storage format, FLOAT16_IEEE for IEEE half precision
+ * or FLOAT16_BFLOAT16 for bfloat16.
+ *
+ * @return 0 for success, error code otherwise.
+ * @author Charlie Zender
+ */
+int
+nc_def_var_float16(int ncid, int varid, int format)
+{
+  unsigned int cd_value[FLOAT16_FLT_PRM_NBR];
+  int ret;
+  nc_type var_typ;
+  
+  /* Only NC_FLOAT has a 16-bit form */
+  if ((ret = nc_inq_vartype(ncid, varid, &var_typ)))
+    return ret;
+
+  if (var_typ != NC_FLOAT)
+    return NC_EINVAL;
+  
+  if (format != FLOAT16_IEEE && format != FLOAT16_BFLOAT16)
+    return NC_EINVAL;
+
+  if (!H5Zfilter_avail(FLOAT16_ID))
+  {
+      printf ("Float16 filter not available.\n");
+      return NC_EFILTER;
+  }
+
+  /* User-provided format is first element of filter parameter array */
+  cd_value[0] = format;
+
+  /* Set up the Float16 filter for this var. */
+  if ((ret = nc_def_var_filter(ncid, varid, FLOAT16_ID, FLOAT16_FLT_PRM_NBR, cd_value)))
+    return ret;
+
+  return 0;
+}
+
+/**
+ * Learn whether the Float16 filter is on for a variable, and, if so, the
+ * storage format.
+ *
+ * @param ncid File ID.
+ * @param varid Variable ID.
+ * @param float16p Pointer that gets a 0 if Float16 is not in use for this
+ * var, and a 1 if it is. Ignored if NULL.
+ * @param formatp Pointer that gets the storage format (FLOAT16_IEEE or
+ * FLOAT16_BFLOAT16), if Float16 is in use. Ignored if NULL.
+ *
+ * @return 0 for success, error code otherwise.
+ * @author Charlie Zender
+ */
+int
+nc_inq_var_float16(int ncid, int varid, int *float16p, int *formatp)
+{
+  unsigned int format[FLOAT16_FLT_PRM_NBR];
+  size_t nparams;
+  int float16 = 0; /* Is Float16 in use? */
+  int ret;
+  
+#ifdef HAVE_MULTIFILTERS
+    {
+	size_t nfilters;
+	unsigned int *filterids;
+	int f;
+	
+	/* Get filter information. */
+	if ((ret = nc_inq_var_filter_ids(ncid, varid, &nfilters, NULL)))
+	    return ret;
+	
+	/* If there are no filters, we're done. */
+	if (nfilters == 0)
+	{
+	    if (float16p)
+		*float16p = 0;
+	    return 0;
+	}
+
+	/* Allocate storage for filter IDs. */
+	if (!(filterids = malloc(nfilters * sizeof(unsigned int))))
+	    return NC_ENOMEM;
+
+	/* Get the filter IDs. */
+	if ((ret = nc_inq_var_filter_ids(ncid, varid, &nfilters, filterids)))
+	{
+	    free(filterids);
+	    return ret;
+	}
+    
+	/* Check each filter to see if it is Float16. */
+	for (f = 0; f < nfilters; f++)
+	{
+	    if (filterids[f] == FLOAT16_ID)
+		float16++;
+
+	    /* If Float16 is in use, check parameter. */
+	    if (float16)
+	    {
+	    
+		/* Count the parameters before reading them. */
+		if ((ret = nc_inq_var_filter_info(ncid, varid, filterids[f], &nparams, NULL)))
+		{
+		    free(filterids);
+		    return ret;
+		}
+
+		/* Float16 has FLOAT16_FLT_PRM_NBR == 5 internal parameters.
+		   We expose only the first (format) through this API because a variable's properties 
+		   uniquely determine the remainder and exposing them to users, well, invites disaster */
+		if (nparams != FLOAT16_FLT_PRM_NBR)
+		{
+		    free(filterids);
+		    return NC_EFILTER;
+		}
+		if ((ret = nc_inq_var_filter_info(ncid, varid, filterids[f], &nparams, format)))
+		{
+		    free(filterids);
+		    return ret;
+		}
+
+		/* Tell the caller, if they want to know. */
+		if (formatp)
+		    *formatp = (int)format[0];
+
+		/* Exit loop to report parameters (neglect remaining filters) */
+		break;
+
+	    }
+	}
+
+	/* Free resources. */
+	free(filterids);
+
+	/* Does caller want to know if Float16 is in use? */
+	if (float16p)
+	    *float16p = float16;
+    }
+#else
+    {
+	unsigned int id;
+
+	/* Get filter information. */
+	ret = nc_inq_var_filter(ncid, varid, &id, &nparams, NULL);
+	if (ret == NC_ENOFILTER)
+	  {
+	    if (float16p)
+	      *float16p = 0;
+	    return 0;
+	  }
+	else if (ret)
+	  return ret;
+  
+	/* Is Float16 in use? */
+	if (id == FLOAT16_ID)
+	  float16++;
+  
+	/* Does caller want to know if Float16 is in use? */
+	if (float16p)
+	  *float16p = float16;
+  
+	/* If Float16 is in use, check parameter. */
+	if (float16)
+	  {
+	    /* Float16 has FLOAT16_FLT_PRM_NBR == 5 internal parameters.
+	       We expose only the first (format) through this API because a variable's properties 
+	       uniquely determine the remainder and exposing them to users, well, invites disaster */
+	    if (nparams != FLOAT16_FLT_PRM_NBR)
+	      return NC_EFILTER;
+	    if ((ret = nc_inq_var_filter(ncid, varid, &id, &nparams, format)))
+	      return ret;
+      
+	    /* Tell the caller, if they want to know. */
+	    if (formatp)
+	      *formatp =(int)format[0];
+	  }
+    }
+#endif /* HAVE_MULTIFILTERS */
+  return 0;
+}
+
+/**
+ * Turn on Linear Packing for a variable.
+ *
+ * Linear Packing maps each value to the nearest of evenly spaced
+ * levels between the chunk minimum and maximum, two error bounds
+ * apart, and stores the level as an 8, 16, or 32-bit integer. Read
+ * values then differ from written values by at most max_abs_err
+ * (plus rounding to the precision of the variable). The filter
+ * chooses the width for each chunk, so a chunk with a small range
+ * takes fewer bytes than one with a large range.
+ *
+ * The Linear Packing filter only applies to variables of type
+ * NC_FLOAT or NC_DOUBLE. Attempts to set it for other variable types
+ * through the C/Fortran API return an error (NC_EINVAL).
+ *
+ * @note Internally, the filter requires LINEARPACK_FLT_PRM_NBR (=6)
+ * elements for cd_value. The double-precision error bound occupies
+ * the first two, and the filter derives the others from the
+ * variable.
+ *
+ * @param ncid File ID.
+ * @param varid Variable ID.
+ * @param max_abs_err Maximum absolute error of packed values, in the
+ * units of the variable. Must be positive.
+ *
+ * @return 0 for success, error code otherwise.
+ * @author Charlie Zender
+ */
+int
+nc_def_var_linearpack(int ncid, int varid, double max_abs_err)
+{
+  unsigned int cd_value[LINEARPACK_FLT_PRM_NBR] = {0};
+  int ret;
+  nc_type var_typ;
+  
+  /* Only floating point types are packed */
+  if ((ret = nc_inq_vartype(ncid, varid, &var_typ)))
+    return ret;
+
+  if (var_typ != NC_FLOAT && var_typ != NC_DOUBLE)
+    return NC_EINVAL;
+  
+  /* Error bound must be positive and finite. Negated test also
+   * rejects NaN. */
+  if (!(max_abs_err > 0.0 && max_abs_err <= DBL_MAX))
+    return NC_EINVAL;
+
+  if (!H5Zfilter_avail(LINEARPACK_ID))
+  {
+      printf ("Linear Packing filter not available.\n");
+      return NC_EFILTER;
+  }
+
+  /* User-provided error bound fills first two elements of filter parameter array */
+  memcpy(cd_value, &max_abs_err, sizeof(double));
+
+  /* Set up the Linear Packing filter for this var. */
+  if ((ret = nc_def_var_filter(ncid, varid, LINEARPACK_ID, LINEARPACK_FLT_PRM_NBR, cd_value)))
+    return ret;
+
+  return 0;
+}
+
+/**
+ * Learn whether the Linear Packing filter is on for a variable, and,
+ * if so, the maximum absolute error.
+ *
+ * @param ncid File ID.
+ * @param varid Variable ID.
+ * @param linearpackp Pointer that gets a 0 if Linear Packing is not in
+ * use for this var, and a 1 if it is. Ignored if NULL.
+ * @param max_abs_errp Pointer that gets the maximum absolute error, if
+ * Linear Packing is in use. Ignored if NULL.
+ *
+ * @return 0 for success, error code otherwise.
+ * @author Charlie Zender
+ */
+int
+nc_inq_var_linearpack(int ncid, int varid, int *linearpackp, double *max_abs_errp)
+{
+  unsigned int prm[LINEARPACK_FLT_PRM_NBR];
+  size_t nparams;
+  int linearpack = 0; /* Is Linear Packing in use? */
+  int ret;
+  
+#ifdef HAVE_MULTIFILTERS
+    {
+	size_t nfilters;
+	unsigned int *filterids;
+	int f;
+	
+	/* Get filter information. */
+	if ((ret = nc_inq_var_filter_ids(ncid, varid, &nfilters, NULL)))
+	    return ret;
+	
+	/* If there are no filters, we're done. */
+	if (nfilters == 0)
+	{
+	    if (linearpackp)
+		*linearpackp = 0;
+	    return 0;
+	}
+
+	/* Allocate storage for filter IDs. */
+	if (!(filterids = malloc(nfilters * sizeof(unsigned int))))
+	    return NC_ENOMEM;
+
+	/* Get the filter IDs. */
+	if ((ret = nc_inq_var_filter_ids(ncid, varid, &nfilters, filterids)))
+	{
+	    free(filterids);
+	    return ret;
+	}
+    
+	/* Check each filter to see if it is Linear Packing. */
+	for (f = 0; f < nfilters; f++)
+	{
+	    if (filterids[f] == LINEARPACK_ID)
+		linearpack++;
+
+	    /* If Linear Packing is in use, check parameter. */
+	    if (linearpack)
+	    {
+	    
+		/* Count the parameters before reading them. */
+		if ((ret = nc_inq_var_filter_info(ncid, varid, filterids[f], &nparams, NULL)))
+		{
+		    free(filterids);
+		    return ret;
+		}
+
+		/* Linear Packing has LINEARPACK_FLT_PRM_NBR == 6 internal parameters.
+		   We expose only the first two (error bound) through this API because a variable's properties 
+		   uniquely determine the remainder and exposing them to users, well, invites disaster */
+		if (nparams != LINEARPACK_FLT_PRM_NBR)
+		{
+		    free(filterids);
+		    return NC_EFILTER;
+		}
+		if ((ret = nc_inq_var_filter_info(ncid, varid, filterids[f], &nparams, prm)))
+		{
+		    free(filterids);
+		    return ret;
+		}
+
+		/* Tell the caller, if they want to know. */
+		if (max_abs_errp)
+		    memcpy(max_abs_errp, prm, sizeof(double));
 
 		/* Exit loop to report parameters (neglect remaining filters) */
 		break;
@@ -527,430 +2593,1681 @@ nc_inq_var_bitgroom(int ncid, int varid, int *bitgroomp, int *nsdp)
 	/* Free resources. */
 	free(filterids);
 
-	/* Does caller want to know if BitGroom is in use? */
-	if (bitgroomp)
-	    *bitgroomp = bitgroom;
+	/* Does caller want to know if Linear Packing is in use? */
+	if (linearpackp)
+	    *linearpackp = linearpack;
+    }
+#else
+    {
+	unsigned int id;
+
+	/* Get filter information. */
+	ret = nc_inq_var_filter(ncid, varid, &id, &nparams, NULL);
+	if (ret == NC_ENOFILTER)
+	  {
+	    if (linearpackp)
+	      *linearpackp = 0;
+	    return 0;
+	  }
+	else if (ret)
+	  return ret;
+  
+	/* Is Linear Packing in use? */
+	if (id == LINEARPACK_ID)
+	  linearpack++;
+  
+	/* Does caller want to know if Linear Packing is in use? */
+	if (linearpackp)
+	  *linearpackp = linearpack;
+  
+	/* If Linear Packing is in use, check parameter. */
+	if (linearpack)
+	  {
+	    /* Linear Packing has LINEARPACK_FLT_PRM_NBR == 6 internal parameters.
+	       We expose only the first two (error bound) through this API because a variable's properties 
+	       uniquely determine the remainder and exposing them to users, well, invites disaster */
+	    if (nparams != LINEARPACK_FLT_PRM_NBR)
+	      return NC_EFILTER;
+	    if ((ret = nc_inq_var_filter(ncid, varid, &id, &nparams, prm)))
+	      return ret;
+      
+	    /* Tell the caller, if they want to know. */
+	    if (max_abs_errp)
+	      memcpy(max_abs_errp, prm, sizeof(double));
+	  }
+    }
+#endif /* HAVE_MULTIFILTERS */
+  return 0;
+}
+
+/**
+ * Turn on the Fill Mask filter for a variable.
+ *
+ * Land- or ocean-masked fields have chunks that are entirely or
+ * mostly _FillValue. The Fill Mask filter finds the fill values in
+ * each chunk with one vectorized sweep, and stores a chunk of only
+ * fill values as a 16-byte header. A partly filled chunk is stored
+ * as a bitmap of valid values followed by the valid values, so the
+ * lossless compressor that follows does less work on fill
+ * values. Chunks that masking would not shrink are stored
+ * unchanged. The filter is lossless.
+ *
+ * The filter masks values equal to the value of the _FillValue
+ * attribute, or to the default fill value of the type if there is no
+ * such attribute. Call nc_def_var_fillmask() after any quantization
+ * filter and before the function that turns on the lossless
+ * compression filter (nc_def_var_zstandard(), for example).
+ *
+ * The Fill Mask filter applies to variables of every integer type,
+ * NC_FLOAT, and NC_DOUBLE. Attempts to set it for NC_CHAR,
+ * NC_STRING, or user-defined types through the C/Fortran API return
+ * an error (NC_EINVAL).
+ *
+ * @note Internally, the filter requires FILLMASK_FLT_PRM_NBR (=4)
+ * elements for cd_value. The filter derives all of them from the
+ * variable, so the user provides none.
+ *
+ * @param ncid File ID.
+ * @param varid Variable ID.
+ *
+ * @return 0 for success, error code otherwise.
+ * @author Charlie Zender
+ */
+int
+nc_def_var_fillmask(int ncid, int varid)
+{
+  unsigned int cd_value[FILLMASK_FLT_PRM_NBR] = {0};
+  int ret;
+  nc_type var_typ;
+  
+  /* Only fixed-size numeric types are masked */
+  if ((ret = nc_inq_vartype(ncid, varid, &var_typ)))
+    return ret;
+
+  if (var_typ == NC_CHAR || var_typ < NC_BYTE || var_typ > NC_UINT64)
+    return NC_EINVAL;
+  
+  if (!H5Zfilter_avail(FILLMASK_ID))
+  {
+      printf ("Fill Mask filter not available.\n");
+      return NC_EFILTER;
+  }
+
+  /* Set up the Fill Mask filter for this var. */
+  if ((ret = nc_def_var_filter(ncid, varid, FILLMASK_ID, FILLMASK_FLT_PRM_NBR, cd_value)))
+    return ret;
+
+  return 0;
+}
+
+/**
+ * Learn whether the Fill Mask filter is on for a variable.
+ *
+ * @param ncid File ID.
+ * @param varid Variable ID.
+ * @param fillmaskp Pointer that gets a 0 if Fill Mask is not in use
+ * for this var, and a 1 if it is. Ignored if NULL.
+ *
+ * @return 0 for success, error code otherwise.
+ * @author Charlie Zender
+ */
+int
+nc_inq_var_fillmask(int ncid, int varid, int *fillmaskp)
+{
+  int fillmask = 0; /* Is Fill Mask in use? */
+  int ret;
+  
+#ifdef HAVE_MULTIFILTERS
+    {
+	size_t nfilters;
+	unsigned int *filterids;
+	int f;
+	
+	/* Get filter information. */
+	if ((ret = nc_inq_var_filter_ids(ncid, varid, &nfilters, NULL)))
+	    return ret;
+	
+	/* If there are no filters, we're done. */
+	if (nfilters == 0)
+	{
+	    if (fillmaskp)
+		*fillmaskp = 0;
+	    return 0;
+	}
+
+	/* Allocate storage for filter IDs. */
+	if (!(filterids = malloc(nfilters * sizeof(unsigned int))))
+	    return NC_ENOMEM;
+
+	/* Get the filter IDs. */
+	if ((ret = nc_inq_var_filter_ids(ncid, varid, &nfilters, filterids)))
+	{
+	    free(filterids);
+	    return ret;
+	}
+    
+	/* Check each filter to see if it is Fill Mask. */
+	for (f = 0; f < nfilters; f++)
+	    if (filterids[f] == FILLMASK_ID)
+		fillmask++;
+
+	/* Free resources. */
+	free(filterids);
+    }
+#else
+    {
+	unsigned int id;
+
+	/* Get filter information. Fill Mask exposes no parameters. */
+	ret = nc_inq_var_filter(ncid, varid, &id, NULL, NULL);
+	if (ret == NC_ENOFILTER)
+	  {
+	    if (fillmaskp)
+	      *fillmaskp = 0;
+	    return 0;
+	  }
+	else if (ret)
+	  return ret;
+  
+	/* Is Fill Mask in use? */
+	if (id == FILLMASK_ID)
+	  fillmask++;
+    }
+#endif /* HAVE_MULTIFILTERS */
+
+  /* Does caller want to know if Fill Mask is in use? */
+  if (fillmaskp)
+    *fillmaskp = fillmask ? 1 : 0;
+
+  return 0;
+}
+
+/**
+ * Turn on the Byte Shuffle filter for a variable.
+ *
+ * Shuffling stores the first byte of every value in a chunk, then
+ * the second byte of every value, and so on. Neighboring values
+ * usually share their high bytes, so the compressor that follows
+ * finds long runs. The HDF5 shuffle filter (turned on by
+ * nc_def_var_deflate()) does this one byte at a time, which can cost
+ * a noticeable fraction of the time of a fast compressor. The Byte
+ * Shuffle filter writes the same bytes, transposing values of 2, 4,
+ * and 8 bytes with SSE2, AVX2, or AVX-512 instructions chosen at run
+ * time. The filter is lossless.
+ *
+ * Call nc_def_var_byteshuffle() after any quantization filter and
+ * before the function that turns on the lossless compression filter
+ * (nc_def_var_zstandard(), for example), and do not also turn on the
+ * HDF5 shuffle filter.
+ *
+ * The Byte Shuffle filter applies to variables of every integer
+ * type, NC_FLOAT, and NC_DOUBLE. Attempts to set it for NC_CHAR,
+ * NC_STRING, or user-defined types through the C/Fortran API return
+ * an error (NC_EINVAL).
+ *
+ * @note Internally, the filter requires BYTESHUFFLE_FLT_PRM_NBR (=1)
+ * elements for cd_value, the size of the type, which the filter sets
+ * from the variable.
+ *
+ * @param ncid File ID.
+ * @param varid Variable ID.
+ *
+ * @return 0 for success, error code otherwise.
+ * @author Charlie Zender
+ */
+int
+nc_def_var_byteshuffle(int ncid, int varid)
+{
+  unsigned int cd_value[BYTESHUFFLE_FLT_PRM_NBR] = {0};
+  int ret;
+  nc_type var_typ;
+  
+  /* Only fixed-size numeric types are shuffled */
+  if ((ret = nc_inq_vartype(ncid, varid, &var_typ)))
+    return ret;
+
+  if (var_typ == NC_CHAR || var_typ < NC_BYTE || var_typ > NC_UINT64)
+    return NC_EINVAL;
+  
+  if (!H5Zfilter_avail(BYTESHUFFLE_ID))
+  {
+      printf ("Byte Shuffle filter not available.\n");
+      return NC_EFILTER;
+  }
+
+  /* Set up the Byte Shuffle filter for this var. */
+  if ((ret = nc_def_var_filter(ncid, varid, BYTESHUFFLE_ID, BYTESHUFFLE_FLT_PRM_NBR, cd_value)))
+    return ret;
+
+  return 0;
+}
+
+/**
+ * Learn whether the Byte Shuffle filter is on for a variable.
+ *
+ * @param ncid File ID.
+ * @param varid Variable ID.
+ * @param byteshufflep Pointer that gets a 0 if Byte Shuffle is not in
+ * use for this var, and a 1 if it is. Ignored if NULL.
+ *
+ * @return 0 for success, error code otherwise.
+ * @author Charlie Zender
+ */
+int
+nc_inq_var_byteshuffle(int ncid, int varid, int *byteshufflep)
+{
+  int byteshuffle = 0; /* Is Byte Shuffle in use? */
+  int ret;
+  
+#ifdef HAVE_MULTIFILTERS
+    {
+	size_t nfilters;
+	unsigned int *filterids;
+	int f;
+	
+	/* Get filter information. */
+	if ((ret = nc_inq_var_filter_ids(ncid, varid, &nfilters, NULL)))
+	    return ret;
+	
+	/* If there are no filters, we're done. */
+	if (nfilters == 0)
+	{
+	    if (byteshufflep)
+		*byteshufflep = 0;
+	    return 0;
+	}
+
+	/* Allocate storage for filter IDs. */
+	if (!(filterids = malloc(nfilters * sizeof(unsigned int))))
+	    return NC_ENOMEM;
+
+	/* Get the filter IDs. */
+	if ((ret = nc_inq_var_filter_ids(ncid, varid, &nfilters, filterids)))
+	{
+	    free(filterids);
+	    return ret;
+	}
+    
+	/* Check each filter to see if it is Byte Shuffle. */
+	for (f = 0; f < nfilters; f++)
+	    if (filterids[f] == BYTESHUFFLE_ID)
+		byteshuffle++;
+
+	/* Free resources. */
+	free(filterids);
+    }
+#else
+    {
+	unsigned int id;
+
+	/* Get filter information. Byte Shuffle exposes no parameters. */
+	ret = nc_inq_var_filter(ncid, varid, &id, NULL, NULL);
+	if (ret == NC_ENOFILTER)
+	  {
+	    if (byteshufflep)
+	      *byteshufflep = 0;
+	    return 0;
+	  }
+	else if (ret)
+	  return ret;
+  
+	/* Is Byte Shuffle in use? */
+	if (id == BYTESHUFFLE_ID)
+	  byteshuffle++;
+    }
+#endif /* HAVE_MULTIFILTERS */
+
+  /* Does caller want to know if Byte Shuffle is in use? */
+  if (byteshufflep)
+    *byteshufflep = byteshuffle ? 1 : 0;
+
+  return 0;
+}
+
+/**
+ * Turn on the Bitshuffle filter for a variable.
+ *
+ * Bitshuffle stores bit 0 of every value in a block, then bit 1 of
+ * every value, and so on. Quantization (nc_def_var_bitround(),
+ * nc_def_var_granularbr()) zeroes the same trailing mantissa bits of
+ * every value, and Bitshuffle turns those bits into whole planes of
+ * zeros, which the compressor that follows stores in almost no
+ * space. Byte shuffling cannot do this when the zeroed bits do not
+ * fill whole bytes. Each chunk is transposed in blocks that fit in
+ * the L1 cache, with SSE2, AVX2, or AVX-512 instructions chosen at
+ * run time. The filter is lossless.
+ *
+ * Call nc_def_var_bitshuffle() after any quantization filter and
+ * before the function that turns on the lossless compression filter
+ * (nc_def_var_zstandard(), for example). Do not also turn on a byte
+ * shuffle.
+ *
+ * The Bitshuffle filter applies to variables of every integer type,
+ * NC_FLOAT, and NC_DOUBLE. Attempts to set it for NC_CHAR, NC_STRING,
+ * or user-defined types through the C/Fortran API return an error
+ * (NC_EINVAL).
+ *
+ * @note Internally, the filter requires BITSHUFFLE_FLT_PRM_NBR (=2)
+ * elements for cd_value, the size of the type, which the filter sets
+ * from the variable, and the block size.
+ *
+ * @param ncid File ID.
+ * @param varid Variable ID.
+ * @param block_size Number of values transposed together, a multiple
+ * of 8, or 0 for the default of 8 kB of values (at least 128
+ * values).
+ *
+ * @return 0 for success, error code otherwise.
+ * @author Charlie Zender
+ */
+int
+nc_def_var_bitshuffle(int ncid, int varid, int block_size)
+{
+  unsigned int cd_value[BITSHUFFLE_FLT_PRM_NBR];
+  int ret;
+  nc_type var_typ;
+  
+  /* Only fixed-size numeric types are bitshuffled */
+  if ((ret = nc_inq_vartype(ncid, varid, &var_typ)))
+    return ret;
+
+  if (var_typ == NC_CHAR || var_typ < NC_BYTE || var_typ > NC_UINT64)
+    return NC_EINVAL;
+  
+  /* Bit planes of a block must fill whole bytes */
+  if (block_size < 0 || block_size % 8)
+    return NC_EINVAL;
+
+  if (!H5Zfilter_avail(BITSHUFFLE_ID))
+  {
+      printf ("Bitshuffle filter not available.\n");
+      return NC_EFILTER;
+  }
+
+  /* The filter sets the datum size, user-provided block size is second element of filter parameter array */
+  cd_value[0] = 0;
+  cd_value[1] = block_size;
+
+  /* Set up the Bitshuffle filter for this var. */
+  if ((ret = nc_def_var_filter(ncid, varid, BITSHUFFLE_ID, BITSHUFFLE_FLT_PRM_NBR, cd_value)))
+    return ret;
+
+  return 0;
+}
+
+/**
+ * Learn whether the Bitshuffle filter is on for a variable, and, if
+ * so, the block size.
+ *
+ * @param ncid File ID.
+ * @param varid Variable ID.
+ * @param bitshufflep Pointer that gets a 0 if Bitshuffle is not in
+ * use for this var, and a 1 if it is. Ignored if NULL.
+ * @param block_sizep Pointer that gets the block size in values (0
+ * for the default), if Bitshuffle is in use. Ignored if NULL.
+ *
+ * @return 0 for success, error code otherwise.
+ * @author Charlie Zender
+ */
+int
+nc_inq_var_bitshuffle(int ncid, int varid, int *bitshufflep, int *block_sizep)
+{
+  unsigned int prm[BITSHUFFLE_FLT_PRM_NBR];
+  size_t nparams;
+  int bitshuffle = 0; /* Is Bitshuffle in use? */
+  int ret;
+  
+#ifdef HAVE_MULTIFILTERS
+    {
+	size_t nfilters;
+	unsigned int *filterids;
+	int f;
+	
+	/* Get filter information. */
+	if ((ret = nc_inq_var_filter_ids(ncid, varid, &nfilters, NULL)))
+	    return ret;
+	
+	/* If there are no filters, we're done. */
+	if (nfilters == 0)
+	{
+	    if (bitshufflep)
+		*bitshufflep = 0;
+	    return 0;
+	}
+
+	/* Allocate storage for filter IDs. */
+	if (!(filterids = malloc(nfilters * sizeof(unsigned int))))
+	    return NC_ENOMEM;
+
+	/* Get the filter IDs. */
+	if ((ret = nc_inq_var_filter_ids(ncid, varid, &nfilters, filterids)))
+	{
+	    free(filterids);
+	    return ret;
+	}
+    
+	/* Check each filter to see if it is Bitshuffle. */
+	for (f = 0; f < nfilters; f++)
+	{
+	    if (filterids[f] != BITSHUFFLE_ID)
+		continue;
+	    bitshuffle++;
+
+	    /* Bitshuffle is in use, check parameters. */
+	    if ((ret = nc_inq_var_filter_info(ncid, varid, filterids[f], &nparams, prm)))
+	    {
+		free(filterids);
+		return ret;
+	    }
+	    if (nparams != BITSHUFFLE_FLT_PRM_NBR)
+	    {
+		free(filterids);
+		return NC_EFILTER;
+	    }
+
+	    /* Tell the caller, if they want to know. */
+	    if (block_sizep)
+		*block_sizep = (int)prm[1];
+	    break;
+	}
+
+	/* Free resources. */
+	free(filterids);
+    }
+#else
+    {
+	unsigned int id;
+
+	/* Get filter information. */
+	ret = nc_inq_var_filter(ncid, varid, &id, &nparams, NULL);
+	if (ret == NC_ENOFILTER)
+	  {
+	    if (bitshufflep)
+	      *bitshufflep = 0;
+	    return 0;
+	  }
+	else if (ret)
+	  return ret;
+  
+	/* Is Bitshuffle in use? */
+	if (id == BITSHUFFLE_ID)
+	  {
+	    bitshuffle++;
+
+	    /* Bitshuffle has BITSHUFFLE_FLT_PRM_NBR == 2 parameters, the datum size and block size */
+	    if (nparams != BITSHUFFLE_FLT_PRM_NBR)
+	      return NC_EFILTER;
+	    if ((ret = nc_inq_var_filter(ncid, varid, &id, &nparams, prm)))
+	      return ret;
+
+	    /* Tell the caller, if they want to know. */
+	    if (block_sizep)
+	      *block_sizep = (int)prm[1];
+	  }
+    }
+#endif /* HAVE_MULTIFILTERS */
+
+  /* Does caller want to know if Bitshuffle is in use? */
+  if (bitshufflep)
+    *bitshufflep = bitshuffle ? 1 : 0;
+
+  return 0;
+}
+
+/**
+ * Turn on the BitPack filter for a variable.
+ *
+ * A quantizer (nc_def_var_bitround(), nc_def_var_granularbr()) zeroes
+ * the trailing mantissa bits of each value, but those bits still
+ * reach the lossless compressor. BitPack drops them, and stores the
+ * sign, exponent, and retained mantissa bits of each value in a
+ * dense bit stream, which it expands again when data are read. The
+ * chunk shrinks by the fraction of bits dropped, e.g., by half for
+ * single-precision values with 7 retained bits, at speeds near those
+ * of memory copies. No entropy coder is involved, so BitPack suits
+ * checkpoint and other write-heavy output for which even fast
+ * Zstandard levels are too slow. A compressor may still follow.
+ *
+ * Call nc_def_var_bitpack() after the quantization filter. An NSB of
+ * 0 adopts the NSB of a preceding BitRound filter, if any, and
+ * otherwise chooses, for each chunk, the number of trailing bits to
+ * drop that stores the chunk in the fewest bytes. This suits Granular
+ * BitRound, which zeroes a different number of bits in each value.
+ * Values with non-zero bits among those dropped, e.g., the
+ * _FillValue, which quantizers leave unchanged, are stored in full,
+ * so the filter is lossless.
+ *
+ * The BitPack filter only packs variables of type NC_FLOAT or
+ * NC_DOUBLE. Attempts to set the BitPack filter for other variable
+ * types through the C/Fortran API return an error (NC_EINVAL).
+ *
+ * @note Internally, the filter requires BITPACK_FLT_PRM_NBR (=2)
+ * elements for cd_value, the NSB, and the size of the type, which the
+ * filter sets from the variable.
+ *
+ * @param ncid File ID.
+ * @param varid Variable ID.
+ * @param nsb Number of explicit mantissa bits retained by the
+ * quantizer, 1-23 for NC_FLOAT and 1-52 for NC_DOUBLE, or 0 to take
+ * it from a preceding BitRound filter or from the data.
+ *
+ * @return 0 for success, error code otherwise.
+ * @author Charlie Zender
+ */
+int
+nc_def_var_bitpack(int ncid, int varid, int nsb)
+{
+  unsigned int cd_value[BITPACK_FLT_PRM_NBR];
+  int ret;
+  nc_type var_typ;
+  
+  /* BitPack only packs floating-point values */
+  if ((ret = nc_inq_vartype(ncid, varid, &var_typ)))
+    return ret;
+
+  if (var_typ != NC_FLOAT && var_typ != NC_DOUBLE)
+    return NC_EINVAL;
+  
+  /* NSB must be 0 (automatic), or between 1 and 23 for NC_FLOAT, 1
+   * and 52 for NC_DOUBLE. */
+  if (nsb < 0 || nsb > (var_typ == NC_FLOAT ? MAX_BITROUND_NSB_FLOAT : MAX_BITROUND_NSB_DOUBLE))
+    return NC_EINVAL;
+
+  if (!H5Zfilter_avail(BITPACK_ID))
+  {
+      printf ("BitPack filter not available.\n");
+      return NC_EFILTER;
+  }
+
+  /* User-provided NSB is first element of filter parameter array, the filter sets the datum size */
+  cd_value[0] = nsb;
+  cd_value[1] = 0;
+
+  /* Set up the BitPack filter for this var. */
+  if ((ret = nc_def_var_filter(ncid, varid, BITPACK_ID, BITPACK_FLT_PRM_NBR, cd_value)))
+    return ret;
+
+  return 0;
+}
+
+/**
+ * Learn whether the BitPack filter is on for a variable, and, if so,
+ * its NSB.
+ *
+ * @param ncid File ID.
+ * @param varid Variable ID.
+ * @param bitpackp Pointer that gets a 0 if BitPack is not in use for
+ * this var, and a 1 if it is. Ignored if NULL.
+ * @param nsbp Pointer that gets the NSB, if BitPack is in use. Once
+ * the variable has been created, this is the NSB adopted from a
+ * preceding BitRound filter, if any, and 0 when each chunk chooses
+ * its own. Ignored if NULL.
+ *
+ * @return 0 for success, error code otherwise.
+ * @author Charlie Zender
+ */
+int
+nc_inq_var_bitpack(int ncid, int varid, int *bitpackp, int *nsbp)
+{
+  unsigned int prm[BITPACK_FLT_PRM_NBR];
+  size_t nparams;
+  int bitpack = 0; /* Is BitPack in use? */
+  int ret;
+  
+#ifdef HAVE_MULTIFILTERS
+    {
+	size_t nfilters;
+	unsigned int *filterids;
+	int f;
+	
+	/* Get filter information. */
+	if ((ret = nc_inq_var_filter_ids(ncid, varid, &nfilters, NULL)))
+	    return ret;
+	
+	/* If there are no filters, we're done. */
+	if (nfilters == 0)
+	{
+	    if (bitpackp)
+		*bitpackp = 0;
+	    return 0;
+	}
+
+	/* Allocate storage for filter IDs. */
+	if (!(filterids = malloc(nfilters * sizeof(unsigned int))))
+	    return NC_ENOMEM;
+
+	/* Get the filter IDs. */
+	if ((ret = nc_inq_var_filter_ids(ncid, varid, &nfilters, filterids)))
+	{
+	    free(filterids);
+	    return ret;
+	}
+    
+	/* Check each filter to see if it is BitPack. */
+	for (f = 0; f < nfilters; f++)
+	{
+	    if (filterids[f] != BITPACK_ID)
+		continue;
+	    bitpack++;
+
+	    /* BitPack is in use, check parameters. */
+	    if ((ret = nc_inq_var_filter_info(ncid, varid, filterids[f], &nparams, prm)))
+	    {
+		free(filterids);
+		return ret;
+	    }
+	    if (nparams != BITPACK_FLT_PRM_NBR)
+	    {
+		free(filterids);
+		return NC_EFILTER;
+	    }
+
+	    /* Tell the caller, if they want to know. */
+	    if (nsbp)
+		*nsbp = (int)prm[0];
+	    break;
+	}
+
+	/* Free resources. */
+	free(filterids);
+    }
+#else
+    {
+	unsigned int id;
+
+	/* Get filter information. */
+	ret = nc_inq_var_filter(ncid, varid, &id, &nparams, NULL);
+	if (ret == NC_ENOFILTER)
+	  {
+	    if (bitpackp)
+	      *bitpackp = 0;
+	    return 0;
+	  }
+	else if (ret)
+	  return ret;
+  
+	/* Is BitPack in use? */
+	if (id == BITPACK_ID)
+	  {
+	    bitpack++;
+
+	    /* BitPack has BITPACK_FLT_PRM_NBR == 2 parameters, the NSB and datum size */
+	    if (nparams != BITPACK_FLT_PRM_NBR)
+	      return NC_EFILTER;
+	    if ((ret = nc_inq_var_filter(ncid, varid, &id, &nparams, prm)))
+	      return ret;
+
+	    /* Tell the caller, if they want to know. */
+	    if (nsbp)
+	      *nsbp = (int)prm[0];
+	  }
+    }
+#endif /* HAVE_MULTIFILTERS */
+
+  /* Does caller want to know if BitPack is in use? */
+  if (bitpackp)
+    *bitpackp = bitpack ? 1 : 0;
+
+  return 0;
+}
+
+/**
+ * Turn on the XOR Delta filter for a variable.
+ *
+ * XOR Delta predicts each value by the value before it along the
+ * fastest-varying dimension, and the first value of each row of a
+ * chunk by the first value of the row before. It stores the XOR of
+ * value and prediction as two flag bits, the position of the
+ * leading or trailing zeros when they are worth noting, and the bits
+ * in between, after the Chimp method for time series (Liakos et al.,
+ * 2022). Neighboring values of smooth fields XOR to a few bits, so
+ * variables that must keep full precision shrink by a quarter to a
+ * half, and write several times faster than with shuffle and
+ * DEFLATE. The filter is lossless, and chunks that would grow are
+ * stored unchanged.
+ *
+ * XOR Delta needs no compressor after it. Call nc_def_var_xordelta()
+ * instead of nc_def_var_deflate() or nc_def_var_byteshuffle(), or
+ * before nc_def_var_zstandard() to let Zstandard look for longer
+ * repeats. How the ratio compares with that of shuffle and DEFLATE
+ * depends on the data, so try both on representative fields.
+ *
+ * The XOR Delta filter only codes variables of type NC_FLOAT or
+ * NC_DOUBLE. Attempts to set the XOR Delta filter for other variable
+ * types through the C/Fortran API return an error (NC_EINVAL).
+ *
+ * @note Internally, the filter requires XORDELTA_FLT_PRM_NBR (=2)
+ * elements for cd_value, the size of the type, and the number of
+ * values per row, i.e., the chunk size of the fastest-varying
+ * dimension, which the filter sets from the variable.
+ *
+ * @param ncid File ID.
+ * @param varid Variable ID.
+ *
+ * @return 0 for success, error code otherwise.
+ * @author Charlie Zender
+ */
+int
+nc_def_var_xordelta(int ncid, int varid)
+{
+  unsigned int cd_value[XORDELTA_FLT_PRM_NBR] = {0, 0};
+  int ret;
+  nc_type var_typ;
+  
+  /* XOR Delta only codes floating-point values */
+  if ((ret = nc_inq_vartype(ncid, varid, &var_typ)))
+    return ret;
+
+  if (var_typ != NC_FLOAT && var_typ != NC_DOUBLE)
+    return NC_EINVAL;
+  
+  if (!H5Zfilter_avail(XORDELTA_ID))
+  {
+      printf ("XOR Delta filter not available.\n");
+      return NC_EFILTER;
+  }
+
+  /* Set up the XOR Delta filter for this var. */
+  if ((ret = nc_def_var_filter(ncid, varid, XORDELTA_ID, XORDELTA_FLT_PRM_NBR, cd_value)))
+    return ret;
+
+  return 0;
+}
+
+/**
+ * Learn whether the XOR Delta filter is on for a variable.
+ *
+ * @param ncid File ID.
+ * @param varid Variable ID.
+ * @param xordeltap Pointer that gets a 0 if XOR Delta is not in use
+ * for this var, and a 1 if it is. Ignored if NULL.
+ *
+ * @return 0 for success, error code otherwise.
+ * @author Charlie Zender
+ */
+int
+nc_inq_var_xordelta(int ncid, int varid, int *xordeltap)
+{
+  int xordelta = 0; /* Is XOR Delta in use? */
+  int ret;
+  
+#ifdef HAVE_MULTIFILTERS
+    {
+	size_t nfilters;
+	unsigned int *filterids;
+	int f;
+	
+	/* Get filter information. */
+	if ((ret = nc_inq_var_filter_ids(ncid, varid, &nfilters, NULL)))
+	    return ret;
+	
+	/* If there are no filters, we're done. */
+	if (nfilters == 0)
+	{
+	    if (xordeltap)
+		*xordeltap = 0;
+	    return 0;
+	}
+
+	/* Allocate storage for filter IDs. */
+	if (!(filterids = malloc(nfilters * sizeof(unsigned int))))
+	    return NC_ENOMEM;
+
+	/* Get the filter IDs. */
+	if ((ret = nc_inq_var_filter_ids(ncid, varid, &nfilters, filterids)))
+	{
+	    free(filterids);
+	    return ret;
+	}
+    
+	/* Check each filter to see if it is XOR Delta. */
+	for (f = 0; f < nfilters; f++)
+	    if (filterids[f] == XORDELTA_ID)
+		xordelta++;
+
+	/* Free resources. */
+	free(filterids);
+    }
+#else
+    {
+	unsigned int id;
+
+	/* Get filter information. XOR Delta exposes no parameters. */
+	ret = nc_inq_var_filter(ncid, varid, &id, NULL, NULL);
+	if (ret == NC_ENOFILTER)
+	  {
+	    if (xordeltap)
+	      *xordeltap = 0;
+	    return 0;
+	  }
+	else if (ret)
+	  return ret;
+  
+	/* Is XOR Delta in use? */
+	if (id == XORDELTA_ID)
+	  xordelta++;
+    }
+#endif /* HAVE_MULTIFILTERS */
+
+  /* Does caller want to know if XOR Delta is in use? */
+  if (xordeltap)
+    *xordeltap = xordelta ? 1 : 0;
+
+  return 0;
+}
+
+/**
+ * Turn on Zstandard compression for a variable.
+ *
+ * @param ncid File ID.
+ * @param varid Variable ID.
+ * @param level From -131072 to 22 (depends on Zstandard version). 
+ * when compressing. Regular compression levels are from 1 up to 19.
+ * Use levels >= 20, labeled `--ultra`, cautiously: they require more memory. 
+ * Negative compression levels that extend the range of speed vs. ratio preferences.
+ * The lower the level, the faster the speed (at the cost of compression).
+ *
+ * @return 0 for success, error code otherwise.
+ * @author Charlie Zender
+ */
+int
+nc_def_var_zstandard(int ncid, int varid, int level)
+{
+    unsigned int cd_value = level;
+    int ret;
+
+    /* Level must be between -131072 and 22 on Zstandard v. 1.4.5 (~202009)
+       Earlier versions have fewer levels (especially fewer negative levels) */
+    if (level < -131072 || level > 22)
+        return NC_EINVAL;
+
+    if (!H5Zfilter_avail(ZSTANDARD_ID))
+    {
+        printf ("Zstandard filter not available.\n");
+        return NC_EFILTER;
+    }
+
+    /* Set up the Zstandard filter for this var. */
+    if ((ret = nc_def_var_filter(ncid, varid, ZSTANDARD_ID, 1, &cd_value)))
+        return ret;
+
+    return 0;
+}
+
+/**
+ * Learn whether Zstandard is on for a variable, and, if so, its
+ * filter parameters and dictionary.
+ *
+ * Files written before the filter had optional parameters store only
+ * the level, and later ones may store fewer scalar parameters than
+ * this version, so parameters not stored in the file are left
+ * untouched in prm. Callers zero prm first so those read as defaults.
+ *
+ * @param ncid File ID.
+ * @param varid Variable ID.
+ * @param zstandardp Pointer that gets a 0 if Zstandard is not in use
+ * for this var, and a 1 if it is. Ignored if NULL.
+ * @param prm Array of ZSTANDARD_FLT_PRM_NBR elements that gets the
+ * scalar filter parameters, if Zstandard is in use.
+ * @param dict Pointer to memory that gets the dictionary, if
+ * Zstandard with a dictionary is in use. Must hold prm[2] bytes.
+ * Ignored if NULL.
+ *
+ * @return 0 for success, error code otherwise.
+ * @author Charlie Zender
+ */
+static int
+ccr_inq_var_zstandard_prm(int ncid, int varid, int *zstandardp, unsigned int *prm, void *dict)
+{
+    unsigned int *params; /* All filter parameters, scalars then packed dictionary */
+    int zstandard = 0; /* Is Zstandard in use? */
+#ifndef HAVE_MULTIFILTERS
+    unsigned int id;
+#endif /* HAVE_MULTIFILTERS */
+    size_t nparams, nscalars;
+    size_t p;
+    int ret;
+
+#ifdef HAVE_MULTIFILTERS
+    {
+	size_t nfilters;
+	unsigned int *filterids;
+	int f;
+	
+	/* Get filter information. */
+	if ((ret = nc_inq_var_filter_ids(ncid, varid, &nfilters, NULL)))
+	    return ret;
+	
+	/* If there are no filters, we're done. */
+	if (nfilters == 0)
+	{
+	    if (zstandardp)
+		*zstandardp = 0;
+	    return 0;
+	}
+
+	/* Allocate storage for filter IDs. */
+	if (!(filterids = malloc(nfilters * sizeof(unsigned int))))
+	    return NC_ENOMEM;
+
+	/* Get the filter IDs. */
+	if ((ret = nc_inq_var_filter_ids(ncid, varid, &nfilters, filterids)))
+	    return ret;
+    
+	/* Check each filter to see if it is Zstandard. */
+	for (f = 0; f < nfilters; f++)
+	    if (filterids[f] == ZSTANDARD_ID)
+		zstandard++;
+
+	/* Free resources. */
+	free(filterids);
+
+	/* Count the parameters, so they can be read into enough memory. */
+	if (zstandard)
+	    if ((ret = nc_inq_var_filter_info(ncid, varid, ZSTANDARD_ID, &nparams, NULL)))
+		return ret;
     }
 #else
     {
-	unsigned int id;
-
 	/* Get filter information. */
-	ret = nc_inq_var_filter(ncid, varid, &id, &nparams, nsd);
+	ret = nc_inq_var_filter(ncid, varid, &id, &nparams, NULL);
 	if (ret == NC_ENOFILTER)
-	  {
-	    if (bitgroomp)
-	      *bitgroomp = 0;
+	{
+	    if (zstandardp)
+		*zstandardp = 0;
 	    return 0;
-	  }
+	}
 	else if (ret)
-	  return ret;
-  
-	/* Is BitGroom in use? */
-	if (id == BITGROOM_ID)
-	  bitgroom++;
-  
-	/* Does caller want to know if BitGroom is in use? */
-	if (bitgroomp)
-	  *bitgroomp = bitgroom;
-  
-	/* If BitGroom is in use, check parameter. */
-	if (bitgroom)
-	  {
-	    /* BitGroom has BITGROOM_FLT_PRM_NBR == 5 internal parameters.
-	       We expose only the first (NSD) through this API because a variable's properties 
-	       uniquely determine the remainder and exposing them to users, well, invites disaster */
-	    if (nparams != BITGROOM_FLT_PRM_NBR)
-	      return NC_EFILTER;
-      
-	    /* Tell the caller, if they want to know. */
-	    if (nsdp)
-	      *nsdp =(int)nsd[0];
-	  }
+	    return ret;
+	
+	/* Is Zstandard in use? */
+	if (id == ZSTANDARD_ID)
+	    zstandard++;
     }
 #endif /* HAVE_MULTIFILTERS */
-  return 0;
+
+    /* Does caller want to know if Zstandard is in use? */
+    if (zstandardp)
+	*zstandardp = zstandard;
+    if (!zstandard)
+	return 0;
+
+    /* Zstandard has from 1 to ZSTANDARD_FLT_PRM_NBR scalar
+     * parameters, followed by the dictionary, if any. */
+    if (nparams < 1)
+	return NC_EFILTER;
+    if (!(params = malloc(nparams * sizeof(unsigned int))))
+	return NC_ENOMEM;
+#ifdef HAVE_MULTIFILTERS
+    ret = nc_inq_var_filter_info(ncid, varid, ZSTANDARD_ID, &nparams, params);
+#else
+    ret = nc_inq_var_filter(ncid, varid, &id, &nparams, params);
+#endif /* HAVE_MULTIFILTERS */
+    if (ret)
+    {
+	free(params);
+	return ret;
+    }
+
+    /* The dictionary, if any, occupies the last parameters, packed
+     * four bytes per parameter, least significant byte first. The
+     * scalar parameters precede it. */
+    nscalars = nparams;
+    if (nparams > 2 && params[2] > 0)
+    {
+	size_t dict_size = params[2];
+
+	if (dict_size > ZSTANDARD_DICT_MAX_SIZE || nparams < 3 + (dict_size + 3) / 4)
+	{
+	    free(params);
+	    return NC_EFILTER;
+	}
+	nscalars = nparams - (dict_size + 3) / 4;
+	if (dict)
+	    for (p = 0; p < dict_size; p++)
+		((unsigned char *)dict)[p] = (unsigned char)(params[nscalars + p / 4] >> (8 * (p % 4)));
+    }
+    for (p = 0; p < nscalars && p < ZSTANDARD_FLT_PRM_NBR; p++)
+	prm[p] = params[p];
+
+    /* Free resources. */
+    free(params);
+
+    return 0;
 }
 
 /**
- * Turn on Granular BitRound quantization for a variable.
+ * Learn whether Zstandard compression is on for a variable, and, if so,
+ * the level setting.
  *
- * The Granular BitRound (GBR) filter quantizes the data by setting
- * unneeded bits to 0, so that they may compress well. GBR is in all
- * external respects similar to BitGroom. The following paragraph
- * describes the differences between GBR and BitGroom, and the rest
- * this preamble, and the postamble are identical to the BitGroom docs.
- * The filter itself is lossy (data are irretrievably altered), and it
- * improves the compression ratio provided by a subsequent lossless 
- * compression filter. Call the nc_def_var_granularbr() function before
- * the function that turns on the lossless compression filter
- * (nc_def_var_deflate(), for example). 
+ * @param ncid File ID.
+ * @param varid Variable ID.
+ * @param zstandardp Pointer that gets a 0 if Zstandard is not in use for this
+ * var, and a 1 if it is. Ignored if NULL.
+ * @param levelp Pointer that gets the level setting (from -131072 to 22), if
+ * Zstandard is in use. Ignored if NULL.
  *
- * Granular BitRound is a second generation quantization filter that
- * incorporates aspects of the BitGroom, DigitRound, and BitRound algorithms.
- * GBR determines the quantization mask for each value independently using
- * the basse-10 logarithm method discussed in the DigitRound paper. 
- * GBR computes exact log10() of every number, in contrast to DigitRound
- * which uses a lookup table for speed. This makes GBR slower than DR.
- * However, GBR-quantized values will use the same mask regardless of the
- * sign of the input value, where DR might produce slightly different masks.
- * Another difference is that GBR uses the BitRound rounding method, rather
- * than reconstructing the scalar quantization at bin center.
- * Similar to BitGroom, GBR ignores the value zero, and the _FillValue.
- * GBR quantizes a few more bits than BitGroom from the raw number yet
- * still maintains the precision guarantee, thus the quantization error 
- * of GBR is larger than BitGroom. GBR improver compression rations 
- * by ~20% relative to BitGroom for typical climate data with NSD = 3.
+ * @return 0 for success, error code otherwise.
+ * @author Charlie Zender
+ */
+int
+nc_inq_var_zstandard(int ncid, int varid, int *zstandardp, int *levelp)
+{
+    unsigned int prm[ZSTANDARD_FLT_PRM_NBR] = {0};
+    int zstandard = 0; /* Is Zstandard in use? */
+    int ret;
+
+    if ((ret = ccr_inq_var_zstandard_prm(ncid, varid, &zstandard, prm, NULL)))
+        return ret;
+
+    /* Does caller want to know if Zstandard is in use? */
+    if (zstandardp)
+        *zstandardp = zstandard;
+
+    /* Tell the caller, if they want to know. */
+    if (zstandard && levelp)
+        *levelp = (int)prm[0];
+
+    return 0;
+}
+
+/**
+ * Turn on Zstandard compression for a variable, with each chunk
+ * compressed by several worker threads.
  *
- * A notable feature of GranularBR is that the data it processes remain 
- * in IEEE754 format after quantization. Therefore the GranularBR filter 
- * does nothing when data are read. However, the Bitgroom filter must 
- * still be installed on machines that need to read bitgroomed data.
+ * The Zstandard library splits each chunk into jobs that its worker
+ * threads compress in parallel, and writes a single frame that any
+ * Zstandard filter decompresses as usual. Parallelism pays off for
+ * large chunks (several MB) at high levels (10 to 19), where
+ * compression is otherwise bound by a single core. Small chunks are
+ * compressed in one job regardless of workers. Output may differ
+ * slightly from, but is no less valid than, single-threaded output.
  *
- * The GranularBR filter only quantizes variables of type NC_FLOAT or
- * NC_DOUBLE. Attempts to set the GranularBR filter for other variable
- * types through the C/Fortran API return an error (NC_EINVAL). The
- * filter does not quantize values equal to the value of the
- * _FillValue attribute, if any. The main difference between the
- * GranularBR algorithm as implemented in the CCR and in NCO is that the
- * NCO version will not quantize the values of "coordinate-like"
- * variables (e.g., latitude, longitude, time) as defined in the NCO
- * manual, whereas the CCR version will quantize any floating-point
- * variable.
+ * Workers are only used if the Zstandard library that writes the
+ * file was built with multithreading support (as most packaged
+ * versions are). Otherwise, the filter compresses on the calling
+ * thread.
  *
- * @note Internally, the filter requires CCR_FLT_PRM_NBR (=5) elements
- * for cd_value. However, the user needs to provide only the first
- * element, NSD, since the other elements can be and are derived from
- * the dcpl (data_class, datum_size), and extra queries of the
- * variable (has_mss_val, mss_val). Hence, the netCDF API exposes to
- * the user and requires setting only the minimal number (1) of filter
- * parameters.
+ * @param ncid File ID.
+ * @param varid Variable ID.
+ * @param level Compression level, as for nc_def_var_zstandard().
+ * @param workers Number of worker threads, from 0 to 256. 0 compresses
+ * on the calling thread, exactly as nc_def_var_zstandard() does.
+ *
+ * @return 0 for success, error code otherwise.
+ * @author Charlie Zender
+ */
+int
+nc_def_var_zstandard_workers(int ncid, int varid, int level, int workers)
+{
+    unsigned int cd_value[2];
+    int ret;
 
+    /* Level must be between -131072 and 22, see nc_def_var_zstandard() */
+    if (level < -131072 || level > 22)
+        return NC_EINVAL;
+
+    /* Zstandard supports at most 256 workers (ZSTDMT_NBWORKERS_MAX on 64-bit hosts) */
+    if (workers < 0 || workers > 256)
+        return NC_EINVAL;
+
+    if (!H5Zfilter_avail(ZSTANDARD_ID))
+    {
+        printf ("Zstandard filter not available.\n");
+        return NC_EFILTER;
+    }
+
+    cd_value[0] = level;
+    cd_value[1] = workers;
+
+    /* Set up the Zstandard filter for this var. */
+    if ((ret = nc_def_var_filter(ncid, varid, ZSTANDARD_ID, 2, cd_value)))
+        return ret;
+
+    return 0;
+}
+
+/**
+ * Learn whether Zstandard compression is on for a variable, and, if so,
+ * the level and number of worker threads.
+ *
  * @param ncid File ID.
  * @param varid Variable ID.
- * @param nsd Number of significant digits to retain. Allowed single- and
- * double-precision NSDs are 1-7 and 1-15, respectively. (Default is 3).
+ * @param zstandardp Pointer that gets a 0 if Zstandard is not in use for this
+ * var, and a 1 if it is. Ignored if NULL.
+ * @param levelp Pointer that gets the level setting (from -131072 to 22), if
+ * Zstandard is in use. Ignored if NULL.
+ * @param workersp Pointer that gets the number of worker threads, if
+ * Zstandard is in use. Gets 0 for variables compressed on the calling
+ * thread, including those set with nc_def_var_zstandard(). Ignored if NULL.
  *
  * @return 0 for success, error code otherwise.
  * @author Charlie Zender
  */
 int
-nc_def_var_granularbr(int ncid, int varid, int nsd)
+nc_inq_var_zstandard_workers(int ncid, int varid, int *zstandardp, int *levelp, int *workersp)
 {
-  unsigned int cd_value[GRANULARBR_FLT_PRM_NBR];
-  int ret;
-  nc_type var_typ;
-  
-  /* Granular BitRound only quantizes floating-point values */
-  if ((ret = nc_inq_vartype(ncid, varid, &var_typ)))
+    unsigned int prm[ZSTANDARD_FLT_PRM_NBR] = {0};
+    int zstandard = 0; /* Is Zstandard in use? */
+    int ret;
+
+    if ((ret = ccr_inq_var_zstandard_prm(ncid, varid, &zstandard, prm, NULL)))
+        return ret;
+
+    /* Does caller want to know if Zstandard is in use? */
+    if (zstandardp)
+        *zstandardp = zstandard;
+
+    /* Tell the caller, if they want to know. */
+    if (zstandard && levelp)
+        *levelp = (int)prm[0];
+    if (zstandard && workersp)
+        *workersp = (int)prm[1];
+
+    return 0;
+}
+
+/**
+ * Turn on Zstandard compression with a dictionary for a variable.
+ *
+ * Dictionaries prime the compressor with content typical of a
+ * variable, so chunks of a few kB, too small for Zstandard to learn
+ * much from on their own, compress better and decompress faster. The
+ * dictionary is stored with the filter parameters of the variable, so
+ * the file is self-contained and any reader with the CCR Zstandard
+ * filter can decompress it. Each thread that reads or writes the
+ * variable digests the dictionary once and re-uses it for every chunk.
+ *
+ * Dictionaries are best trained from sample chunks with
+ * ccr_train_zstandard_dict(), but any bytes typical of the data (a
+ * "raw content" dictionary) work too.
+ *
+ * @param ncid File ID.
+ * @param varid Variable ID.
+ * @param level Compression level, as for nc_def_var_zstandard().
+ * @param dict Pointer to the dictionary.
+ * @param dict_size Size of the dictionary in bytes, from 1 to
+ * ZSTANDARD_DICT_MAX_SIZE.
+ *
+ * @return 0 for success, error code otherwise.
+ * @author Charlie Zender
+ */
+int
+nc_def_var_zstandard_dict(int ncid, int varid, int level, const void *dict, size_t dict_size)
+{
+    unsigned int *cd_value;
+    size_t nparams;
+    size_t p;
+    int ret;
+
+    /* Level must be between -131072 and 22, see nc_def_var_zstandard() */
+    if (level < -131072 || level > 22)
+        return NC_EINVAL;
+
+    /* The dictionary must fit the HDF5 filter pipeline message */
+    if (!dict || dict_size < 1 || dict_size > ZSTANDARD_DICT_MAX_SIZE)
+        return NC_EINVAL;
+
+    if (!H5Zfilter_avail(ZSTANDARD_ID))
+    {
+        printf ("Zstandard filter not available.\n");
+        return NC_EFILTER;
+    }
+
+    /* Level, dictionary size, other scalars at their defaults (0),
+     * then dictionary packed four bytes per parameter, least
+     * significant byte first, so the file reads the same on hosts of
+     * either endianness. */
+    nparams = ZSTANDARD_FLT_PRM_NBR + (dict_size + 3) / 4;
+    if (!(cd_value = calloc(nparams, sizeof(unsigned int))))
+        return NC_ENOMEM;
+    cd_value[0] = level;
+    cd_value[2] = dict_size;
+    for (p = 0; p < dict_size; p++)
+        cd_value[ZSTANDARD_FLT_PRM_NBR + p / 4] |= (unsigned int)((const unsigned char *)dict)[p] << (8 * (p % 4));
+
+    /* Set up the Zstandard filter for this var. */
+    ret = nc_def_var_filter(ncid, varid, ZSTANDARD_ID, nparams, cd_value);
+    free(cd_value);
+
     return ret;
+}
 
-  if (var_typ != NC_FLOAT && var_typ != NC_DOUBLE)
-  {
-      /* printf ("Granular BitRound filter can only be defined for floating-point variables.\n"); */
-      return NC_EINVAL;
-  }
-  
-  /* NSD must be between 1 and 7 for NC_FLOAT, 1 and 15 for
-   * NC_DOUBLE. */
-  if (nsd < 1 || nsd > (var_typ == NC_FLOAT ? MAX_GRANULARBR_NSD_FLOAT : MAX_GRANULARBR_NSD_DOUBLE))
-    return NC_EINVAL;
+/**
+ * Learn whether Zstandard compression with a dictionary is on for a
+ * variable, and, if so, the dictionary.
+ *
+ * @param ncid File ID.
+ * @param varid Variable ID.
+ * @param zstandard_dictp Pointer that gets a 1 if Zstandard with a
+ * dictionary is in use for this var, and a 0 otherwise, including
+ * when Zstandard is in use without a dictionary. Ignored if NULL.
+ * @param dict_sizep Pointer that gets the size of the dictionary in
+ * bytes, if Zstandard with a dictionary is in use. Ignored if NULL.
+ * @param dict Pointer to memory that gets the dictionary, if
+ * Zstandard with a dictionary is in use. Must hold the number of
+ * bytes returned in dict_sizep, at most ZSTANDARD_DICT_MAX_SIZE.
+ * Ignored if NULL.
+ *
+ * @return 0 for success, error code otherwise.
+ * @author Charlie Zender
+ */
+int
+nc_inq_var_zstandard_dict(int ncid, int varid, int *zstandard_dictp, size_t *dict_sizep, void *dict)
+{
+    unsigned int prm[ZSTANDARD_FLT_PRM_NBR] = {0};
+    int zstandard = 0; /* Is Zstandard in use? */
+    int ret;
+
+    if ((ret = ccr_inq_var_zstandard_prm(ncid, varid, &zstandard, prm, dict)))
+        return ret;
 
-  if (!H5Zfilter_avail(GRANULARBR_ID))
-  {
-      printf ("Granular BitRound filter not available.\n");
-      return NC_EFILTER;
-  }
+    /* Zstandard with a dictionary has a non-zero dictionary size */
+    if (zstandard && !prm[2])
+        zstandard = 0;
 
-  /* User-provided NSD is first element of filter parameter array */
-  cd_value[0] = nsd;
+    /* Does caller want to know if a dictionary is in use? */
+    if (zstandard_dictp)
+        *zstandard_dictp = zstandard;
 
-  /* Set up the Granular BitRound filter for this var. */
-  if ((ret = nc_def_var_filter(ncid, varid, GRANULARBR_ID, GRANULARBR_FLT_PRM_NBR, cd_value)))
-    return ret;
+    /* Tell the caller, if they want to know. */
+    if (zstandard && dict_sizep)
+        *dict_sizep = prm[2];
 
-  return 0;
+    return 0;
 }
 
 /**
- * Learn whether Granular BitRound quantization is on for a variable, and, if so,
- * the NSD setting.
+ * Turn on Zstandard compression with long-distance matching, window,
+ * and strategy control for a variable.
+ *
+ * Each compression level implies a window (the distance back in which
+ * Zstandard finds repeats) and a search strategy. Long-distance
+ * matching finds repeats far beyond the usual window at little CPU
+ * cost, e.g., the repeating vertical-level structure of large 3D
+ * chunks. It often improves ratio more cheaply than raising the level.
+ * Windows larger than the chunk have no effect, since Zstandard
+ * shrinks the window to the chunk size.
+ *
+ * Readers need no settings: the filter raises the decompression
+ * window limit (ZSTD_d_windowLogMax) to match. Other Zstandard
+ * decoders may need the equivalent of --long=window_log for windows
+ * above 2^27 bytes.
  *
  * @param ncid File ID.
  * @param varid Variable ID.
- * @param granularbrp Pointer that gets a 0 if Granular BitRound is not in use for this
- * var, and a 1 if it is. Ignored if NULL.
- * @param nsdp Pointer that gets the NSD setting (from 1 to 15), if
- * Granular BitRound is in use. Ignored if NULL.
+ * @param level Compression level, as for nc_def_var_zstandard().
+ * @param window_log Base-2 logarithm of the window size in bytes,
+ * from 10 to 31, or 0 for the level's default. Long-distance matching
+ * defaults to 27 (128 MiB).
+ * @param ldm Non-zero to enable long-distance matching, 0 otherwise.
+ * @param strategy Zstandard strategy, from 1 (ZSTD_fast) to 9
+ * (ZSTD_btultra2), or 0 for the level's default.
  *
  * @return 0 for success, error code otherwise.
  * @author Charlie Zender
  */
 int
-nc_inq_var_granularbr(int ncid, int varid, int *granularbrp, int *nsdp)
+nc_def_var_zstandard_ldm(int ncid, int varid, int level, int window_log, int ldm, int strategy)
 {
-  unsigned int nsd[GRANULARBR_FLT_PRM_NBR];
-  size_t nparams;
-  int granularbr = 0; /* Is Granular BitRound in use? */
-  int ret;
-  
-#ifdef HAVE_MULTIFILTERS
-    {
-	size_t nfilters;
-	unsigned int *filterids;
-	int f;
-	
-	/* Get filter information. */
-	if ((ret = nc_inq_var_filter_ids(ncid, varid, &nfilters, NULL)))
-	    return ret;
-	
-	/* If there are no filters, we're done. */
-	if (nfilters == 0)
-	{
-	    if (granularbrp)
-		*granularbrp = 0;
-	    return 0;
-	}
+    unsigned int cd_value[ZSTANDARD_FLT_PRM_NBR] = {0};
+    int ret;
 
-	/* Allocate storage for filter IDs. */
-	if (!(filterids = malloc(nfilters * sizeof(unsigned int))))
-	    return NC_ENOMEM;
+    /* Level must be between -131072 and 22, see nc_def_var_zstandard() */
+    if (level < -131072 || level > 22)
+        return NC_EINVAL;
 
-	/* Get the filter IDs. */
-	if ((ret = nc_inq_var_filter_ids(ncid, varid, &nfilters, filterids)))
-	    return ret;
-    
-	/* Check each filter to see if it is Granular BitRound. */
-	for (f = 0; f < nfilters; f++)
-	{
-	    if (filterids[f] == GRANULARBR_ID)
-		granularbr++;
+    /* Window (ZSTD_WINDOWLOG_MIN to ZSTD_WINDOWLOG_MAX_64) and strategy
+     * (ZSTD_fast to ZSTD_btultra2) must be valid, or 0 for default */
+    if (window_log && (window_log < 10 || window_log > 31))
+        return NC_EINVAL;
+    if (strategy < 0 || strategy > 9)
+        return NC_EINVAL;
 
-	    /* If Granular BitRound is in use, check parameter. */
-	    if (granularbr)
-	    {
-	    
-		if ((ret = nc_inq_var_filter_info(ncid, varid, filterids[f], &nparams, nsd)))
-		    return ret;
+    if (!H5Zfilter_avail(ZSTANDARD_ID))
+    {
+        printf ("Zstandard filter not available.\n");
+        return NC_EFILTER;
+    }
 
-		/* Granular BitRound has GRANULARBR_FLT_PRM_NBR == 5 internal parameters.
-		   We expose only the first (NSD) through this API because a variable's properties 
-		   uniquely determine the remainder and exposing them to users, well, invites disaster */
-		if (nparams != GRANULARBR_FLT_PRM_NBR)
-		  return NC_EFILTER;
+    /* Level, no workers, no dictionary, window, LDM, strategy, fixed level */
+    cd_value[0] = level;
+    cd_value[3] = window_log;
+    cd_value[4] = ldm ? 1 : 0;
+    cd_value[5] = strategy;
 
-		/* Tell the caller, if they want to know. */
-		if (nsdp)
-		    *nsdp = (int)nsd[0];
+    /* Set up the Zstandard filter for this var. */
+    if ((ret = nc_def_var_filter(ncid, varid, ZSTANDARD_ID, ZSTANDARD_FLT_PRM_NBR, cd_value)))
+        return ret;
 
-		/* Exit loop to report parameters (neglect remaining filters) */
-		break;
+    return 0;
+}
 
-	    }
-	}
+/**
+ * Learn whether Zstandard compression is on for a variable, and, if so,
+ * the level, window, long-distance matching, and strategy settings.
+ *
+ * @param ncid File ID.
+ * @param varid Variable ID.
+ * @param zstandardp Pointer that gets a 0 if Zstandard is not in use for this
+ * var, and a 1 if it is. Ignored if NULL.
+ * @param levelp Pointer that gets the level setting (from -131072 to 22), if
+ * Zstandard is in use. Ignored if NULL.
+ * @param window_logp Pointer that gets the base-2 logarithm of the
+ * window size, or 0 for the level's default, if Zstandard is in use.
+ * Ignored if NULL.
+ * @param ldmp Pointer that gets 1 if long-distance matching is
+ * enabled, and 0 otherwise, if Zstandard is in use. Ignored if NULL.
+ * @param strategyp Pointer that gets the strategy, or 0 for the
+ * level's default, if Zstandard is in use. Ignored if NULL.
+ *
+ * @return 0 for success, error code otherwise.
+ * @author Charlie Zender
+ */
+int
+nc_inq_var_zstandard_ldm(int ncid, int varid, int *zstandardp, int *levelp,
+                         int *window_logp, int *ldmp, int *strategyp)
+{
+    unsigned int prm[ZSTANDARD_FLT_PRM_NBR] = {0};
+    int zstandard = 0; /* Is Zstandard in use? */
+    int ret;
 
-	/* Free resources. */
-	free(filterids);
+    if ((ret = ccr_inq_var_zstandard_prm(ncid, varid, &zstandard, prm, NULL)))
+        return ret;
 
-	/* Does caller want to know if Granular BitRound is in use? */
-	if (granularbrp)
-	    *granularbrp = granularbr;
-    }
-#else
-    {
-	unsigned int id;
+    /* Does caller want to know if Zstandard is in use? */
+    if (zstandardp)
+        *zstandardp = zstandard;
 
-	/* Get filter information. */
-	ret = nc_inq_var_filter(ncid, varid, &id, &nparams, nsd);
-	if (ret == NC_ENOFILTER)
-	  {
-	    if (granularbrp)
-	      *granularbrp = 0;
-	    return 0;
-	  }
-	else if (ret)
-	  return ret;
-  
-	/* Is Granular BitRound in use? */
-	if (id == GRANULARBR_ID)
-	  granularbr++;
-  
-	/* Does caller want to know if Granular BitRound is in use? */
-	if (granularbrp)
-	  *granularbrp = granularbr;
-  
-	/* If Granular BitRound is in use, check parameter. */
-	if (granularbr)
-	  {
-	    /* Granular BitRound has GRANULARBR_FLT_PRM_NBR == 5 internal parameters.
-	       We expose only the first (NSD) through this API because a variable's properties 
-	       uniquely determine the remainder and exposing them to users, well, invites disaster */
-	    if (nparams != GRANULARBR_FLT_PRM_NBR)
-	      return NC_EFILTER;
-      
-	    /* Tell the caller, if they want to know. */
-	    if (nsdp)
-	      *nsdp =(int)nsd[0];
-	  }
-    }
-#endif /* HAVE_MULTIFILTERS */
-  return 0;
+    /* Tell the caller, if they want to know. */
+    if (zstandard && levelp)
+        *levelp = (int)prm[0];
+    if (zstandard && window_logp)
+        *window_logp = (int)prm[3];
+    if (zstandard && ldmp)
+        *ldmp = (int)prm[4];
+    if (zstandard && strategyp)
+        *strategyp = (int)prm[5];
+
+    return 0;
 }
 
 /**
- * Turn on Zstandard compression for a variable.
+ * Turn on Zstandard compression with an adaptive level for a variable.
+ *
+ * Instead of a fixed level, the filter is given a target write
+ * throughput. It times its own compression of each chunk, and steps
+ * the level down (as far as -64) when slower than the target, or up
+ * (as far as 19) when comfortably faster. Each writing thread keeps
+ * its own controller, which starts from level for each variable.
+ *
+ * The level and measured throughput of each chunk are recorded in a
+ * Zstandard skippable frame after the compressed data, which all
+ * Zstandard decoders ignore. Readers need no settings.
+ *
+ * Filters built without POSIX threads or clock_gettime() compress at
+ * the starting level.
  *
  * @param ncid File ID.
  * @param varid Variable ID.
- * @param level From -131072 to 22 (depends on Zstandard version). 
- * when compressing. Regular compression levels are from 1 up to 19.
- * Use levels >= 20, labeled `--ultra`, cautiously: they require more memory. 
- * Negative compression levels that extend the range of speed vs. ratio preferences.
- * The lower the level, the faster the speed (at the cost of compression).
+ * @param level Starting compression level, as for
+ * nc_def_var_zstandard().
+ * @param throughput Target compression throughput in MB/s, must be
+ * positive.
  *
  * @return 0 for success, error code otherwise.
  * @author Charlie Zender
  */
 int
-nc_def_var_zstandard(int ncid, int varid, int level)
+nc_def_var_zstandard_adaptive(int ncid, int varid, int level, int throughput)
 {
-    unsigned int cd_value = level;
+    unsigned int cd_value[ZSTANDARD_FLT_PRM_NBR] = {0};
     int ret;
 
-    /* Level must be between -131072 and 22 on Zstandard v. 1.4.5 (~202009)
-       Earlier versions have fewer levels (especially fewer negative levels) */
+    /* Level must be between -131072 and 22, see nc_def_var_zstandard() */
     if (level < -131072 || level > 22)
         return NC_EINVAL;
 
+    /* Throughput must be positive, 0 means fixed level */
+    if (throughput < 1)
+        return NC_EINVAL;
+
     if (!H5Zfilter_avail(ZSTANDARD_ID))
     {
         printf ("Zstandard filter not available.\n");
         return NC_EFILTER;
     }
 
+    /* Starting level, target throughput, other scalars at their
+     * defaults (0) */
+    cd_value[0] = level;
+    cd_value[6] = throughput;
+
     /* Set up the Zstandard filter for this var. */
-    if ((ret = nc_def_var_filter(ncid, varid, ZSTANDARD_ID, 1, &cd_value)))
+    if ((ret = nc_def_var_filter(ncid, varid, ZSTANDARD_ID, ZSTANDARD_FLT_PRM_NBR, cd_value)))
         return ret;
 
     return 0;
 }
 
 /**
- * Learn whether Zstandard compression is on for a variable, and, if so,
- * the level setting.
+ * Learn whether Zstandard compression with an adaptive level is on for
+ * a variable, and, if so, the starting level and target throughput.
  *
  * @param ncid File ID.
  * @param varid Variable ID.
- * @param zstandardp Pointer that gets a 0 if Zstandard is not in use for this
- * var, and a 1 if it is. Ignored if NULL.
- * @param levelp Pointer that gets the level setting (from -131072 to 22), if
- * Zstandard is in use. Ignored if NULL.
+ * @param zstandard_adaptivep Pointer that gets a 0 if Zstandard with
+ * an adaptive level is not in use for this var, and a 1 if it
+ * is. Ignored if NULL.
+ * @param levelp Pointer that gets the starting level, if Zstandard
+ * with an adaptive level is in use. Ignored if NULL.
+ * @param throughputp Pointer that gets the target throughput in MB/s,
+ * if Zstandard with an adaptive level is in use. Ignored if NULL.
  *
  * @return 0 for success, error code otherwise.
  * @author Charlie Zender
  */
 int
-nc_inq_var_zstandard(int ncid, int varid, int *zstandardp, int *levelp)
+nc_inq_var_zstandard_adaptive(int ncid, int varid, int *zstandard_adaptivep, int *levelp,
+                              int *throughputp)
 {
+    unsigned int prm[ZSTANDARD_FLT_PRM_NBR] = {0};
     int zstandard = 0; /* Is Zstandard in use? */
-    unsigned int level;
-    size_t nparams;
     int ret;
 
-#ifdef HAVE_MULTIFILTERS
+    if ((ret = ccr_inq_var_zstandard_prm(ncid, varid, &zstandard, prm, NULL)))
+        return ret;
+
+    /* Zstandard with a fixed level does not count. */
+    if (!prm[6])
+        zstandard = 0;
+
+    /* Does caller want to know if adaptive Zstandard is in use? */
+    if (zstandard_adaptivep)
+        *zstandard_adaptivep = zstandard;
+
+    /* Tell the caller, if they want to know. */
+    if (zstandard && levelp)
+        *levelp = (int)prm[0];
+    if (zstandard && throughputp)
+        *throughputp = (int)prm[6];
+
+    return 0;
+}
+
+/**
+ * Train a Zstandard dictionary from sample chunks of one or more
+ * variables.
+ *
+ * Each sample is one chunk, read in the chunk shape of its
+ * variable, so the dictionary learns from the same units the filter
+ * compresses. Chunks are sampled evenly through each variable, up to
+ * about one hundred times the dictionary capacity in all, the amount
+ * Zstandard recommends. Train from variables with the chunking, type,
+ * and kind of content the dictionary will compress, e.g., the 2D
+ * fields of one model history file to compress those of the next.
+ * Samples should be representative and number at least a few dozen.
+ * Contiguous variables are sampled as a single chunk.
+ *
+ * Pass the dictionary to nc_def_var_zstandard_dict().
+ *
+ * @param ncid File ID.
+ * @param nvars Number of variables to sample.
+ * @param varids Array of nvars variable IDs. Variables must be of an
+ * atomic type other than NC_STRING.
+ * @param dict_capacity Size of the memory at dict, in bytes, from 256
+ * to ZSTANDARD_DICT_MAX_SIZE. Dictionaries of 4 to 16 kB suit chunks
+ * of a few kB.
+ * @param dict Pointer to memory that gets the dictionary.
+ * @param dict_sizep Pointer that gets the size of the dictionary, in
+ * bytes, at most dict_capacity.
+ *
+ * @return 0 for success, NC_EFILTER if Zstandard cannot train a
+ * dictionary from the samples (e.g., too few), NC_ENOTBUILT if CCR
+ * was built without the Zstandard dictionary builder, error code
+ * otherwise.
+ * @author Charlie Zender
+ */
+int
+ccr_train_zstandard_dict(int ncid, int nvars, const int *varids, size_t dict_capacity,
+                         void *dict, size_t *dict_sizep)
+{
+#ifdef HAVE_ZDICT
+    unsigned char *samples = NULL; /* Sample chunks, end to end */
+    size_t *sample_sizes = NULL; /* Size of each sample chunk */
+    size_t nsamples = 0, nsamples_max = 0; /* Number of samples */
+    size_t samples_size = 0, samples_size_max; /* Bytes of samples */
+    size_t var_samples_size_max; /* Bytes of samples from each variable */
+    size_t dict_size;
+    int v;
+    int ret = 0;
+
+    if (nvars < 1 || !varids || !dict || !dict_sizep)
+        return NC_EINVAL;
+    if (dict_capacity < 256 || dict_capacity > ZSTANDARD_DICT_MAX_SIZE)
+        return NC_EINVAL;
+
+    /* Zstandard recommends samples of about 100 times the dictionary
+     * size, spread here evenly over the variables. */
+    samples_size_max = 100 * dict_capacity;
+    if (!(var_samples_size_max = samples_size_max / nvars))
+        var_samples_size_max = 1;
+
+    for (v = 0; v < nvars; v++)
     {
-	size_t nfilters;
-	unsigned int *filterids;
-	int f;
-	
-	/* Get filter information. */
-	if ((ret = nc_inq_var_filter_ids(ncid, varid, &nfilters, NULL)))
-	    return ret;
-	
-	/* If there are no filters, we're done. */
-	if (nfilters == 0)
-	{
-	    if (zstandardp)
-		*zstandardp = 0;
-	    return 0;
-	}
+        size_t dimlen[NC_MAX_VAR_DIMS], chunksizes[NC_MAX_VAR_DIMS];
+        size_t start[NC_MAX_VAR_DIMS], count[NC_MAX_VAR_DIMS];
+        size_t nchunks_dim[NC_MAX_VAR_DIMS];
+        int dimids[NC_MAX_VAR_DIMS];
+        size_t nchunks = 1, chunk_size, stride, c;
+        size_t type_size;
+        nc_type xtype;
+        int storage;
+        int ndims, d;
 
-	/* Allocate storage for filter IDs. */
-	if (!(filterids = malloc(nfilters * sizeof(unsigned int))))
-	    return NC_ENOMEM;
+        if ((ret = nc_inq_vartype(ncid, varids[v], &xtype)))
+            goto exit;
+        if (xtype > NC_MAX_ATOMIC_TYPE || xtype == NC_STRING)
+        {
+            ret = NC_EINVAL;
+            goto exit;
+        }
+        if ((ret = nc_inq_type(ncid, xtype, NULL, &type_size)))
+            goto exit;
+        if ((ret = nc_inq_varndims(ncid, varids[v], &ndims)))
+            goto exit;
+        if ((ret = nc_inq_vardimid(ncid, varids[v], dimids)))
+            goto exit;
+        if ((ret = nc_inq_var_chunking(ncid, varids[v], &storage, chunksizes)))
+            goto exit;
 
-	/* Get the filter IDs. */
-	if ((ret = nc_inq_var_filter_ids(ncid, varid, &nfilters, filterids)))
-	    return ret;
-    
-	/* Check each filter to see if it is Zstandard. */
-	for (f = 0; f < nfilters; f++)
-	{
-	    if (filterids[f] == ZSTANDARD_ID)
-		zstandard++;
+        /* Count the chunks along each dimension. */
+        chunk_size = type_size;
+        for (d = 0; d < ndims; d++)
+        {
+            if ((ret = nc_inq_dimlen(ncid, dimids[d], &dimlen[d])))
+                goto exit;
+            if (storage != NC_CHUNKED)
+                chunksizes[d] = dimlen[d];
+            nchunks_dim[d] = chunksizes[d] ? (dimlen[d] + chunksizes[d] - 1) / chunksizes[d] : 0;
+            nchunks *= nchunks_dim[d];
+            chunk_size *= chunksizes[d];
+        }
+        if (!nchunks || !chunk_size)
+            continue;
 
-	    /* If Zstandard is in use, check parameter. */
-	    if (zstandard)
-	    {
-	    
-		if ((ret = nc_inq_var_filter_info(ncid, varid, filterids[f], &nparams, &level)))
-		    return ret;
+        /* Sample every stride-th chunk, so this variable contributes
+         * at most its share of the samples. */
+        stride = (nchunks * chunk_size + var_samples_size_max - 1) / var_samples_size_max;
+        if (stride < 1)
+            stride = 1;
 
-		/* For Zstandard, there is one parameter. */
-		if (nparams != 1)
-		    return NC_EFILTER;
+        for (c = 0; c < nchunks; c += stride)
+        {
+            size_t idx = c;
+            size_t size = type_size;
 
-		/* Tell the caller, if they want to know. */
-		if (levelp)
-		    *levelp = (int)level;
+            /* Find the start and (at edges, partial) count of chunk c. */
+            for (d = ndims - 1; d >= 0; d--)
+            {
+                start[d] = (idx % nchunks_dim[d]) * chunksizes[d];
+                idx /= nchunks_dim[d];
+                count[d] = dimlen[d] - start[d] < chunksizes[d] ? dimlen[d] - start[d] : chunksizes[d];
+                size *= count[d];
+            }
 
-		/* Exit loop to report parameters (neglect remaining filters) */
-		break;
+            /* Grow sample storage as needed. */
+            if (nsamples == nsamples_max)
+            {
+                size_t *tmp;
 
-	    }
-	}
+                nsamples_max = nsamples_max ? 2 * nsamples_max : 64;
+                if (!(tmp = realloc(sample_sizes, nsamples_max * sizeof(size_t))))
+                {
+                    ret = NC_ENOMEM;
+                    goto exit;
+                }
+                sample_sizes = tmp;
+            }
+            {
+                unsigned char *tmp;
 
-	/* Free resources. */
-	free(filterids);
+                if (!(tmp = realloc(samples, samples_size + size)))
+                {
+                    ret = NC_ENOMEM;
+                    goto exit;
+                }
+                samples = tmp;
+            }
 
-	if (zstandardp)
-	    *zstandardp = zstandard;
+            /* Read the chunk, as the filter will see it. */
+            if ((ret = nc_get_vara(ncid, varids[v], start, count, samples + samples_size)))
+                goto exit;
+            sample_sizes[nsamples++] = size;
+            samples_size += size;
+        }
     }
-#else
+
+    /* Train the dictionary. */
+    if (!nsamples)
     {
-	unsigned int id;
-	
-	/* Get filter information. */
-	ret = nc_inq_var_filter(ncid, varid, &id, &nparams, &level);
-	if (ret == NC_ENOFILTER)
-	{
-	    if (zstandardp)
-		*zstandardp = 0;
-	    return 0;
-	}
-	else if (ret)
-	    return ret;
-	
-	/* Is Zstandard in use? */
-	if (id == ZSTANDARD_ID)
-	    zstandard++;
-	
-	/* Does caller want to know if Zstandard is in use? */
-	if (zstandardp)
-	    *zstandardp = zstandard;
-	
-	/* If Zstandard is in use, check parameter. */
-	if (zstandard)
-	{
-	    /* For Zstandard, there is one parameter. */
-	    if (nparams != 1)
-		return NC_EFILTER;
-	    
-	    /* Tell the caller, if they want to know. */
-	    if (levelp)
-		*levelp = level;
-	}
+        ret = NC_EFILTER;
+        goto exit;
     }
-#endif /* HAVE_MULTIFILTERS */
-    return 0;
+    dict_size = ZDICT_trainFromBuffer(dict, dict_capacity, samples, sample_sizes, (unsigned)nsamples);
+    if (ZDICT_isError(dict_size))
+    {
+        ret = NC_EFILTER;
+        goto exit;
+    }
+    *dict_sizep = dict_size;
+
+exit:
+    /* Free resources. */
+    free(samples);
+    free(sample_sizes);
+    return ret;
+#else
+    return NC_ENOTBUILT;
+#endif /* HAVE_ZDICT */
 }
@@ -0,0 +1,233 @@
+/* This is part of the CCR package. Copyright 2026.
+
+   Test BitPack.
+
+   agent 10/17/26
+*/
+
+#include "config.h"
+#include "ccr.h"
+#include "ccr_test.h"
+#include <hdf5.h>
+#include <H5DSpublic.h>
+#include <netcdf.h>
+#include <string.h>
+
+#define FILE_NAME "tst_bitpack.nc"
+#define TEST "tst_bitpack"
+#define STR_LEN 255
+#define X_NAME "X"
+#define Y_NAME "Y"
+#define NDIM2 2
+#define VAR_NAME "Bad_Moon_Rising"
+#define VAR_NAME2 "Green_River"
+#define VAR_NAME3 "Lodi"
+#define NX 60
+#define NY 120
+#define NSB 7
+#define FILL_VALUE -999.25f
+
+/* Err is used to keep track of errors within each set of tests,
+ * total_err is the number of errors in the entire test program, which
+ * generally cosists of several sets of tests. */
+static int total_err = 0, err = 0;
+
+int
+main()
+{
+    printf("\n*** Checking BitPack filter.\n");
+    printf("*** Checking BitPack...");
+    {
+        int ncid;
+        int dimid[NDIM2];
+        int varid, varid2, varid3;
+        size_t chunksizes[NDIM2] = {NX / 2, NY / 2 - 1};
+        float data_out[NX][NY];
+        double data_out2[NX][NY];
+        float fill_value = FILL_VALUE;
+        unsigned int u;
+        int x, y;
+        int bitpack, nsb;
+
+        /* Create some data to write, with the trailing mantissa bits
+         * a quantizer would zero already zeroed. The first variable
+         * also has fill values, which keep all their bits. The chunks
+         * do not divide the rows evenly, so chunks have lengths that
+         * are not a multiple of the packing group. */
+        for (x = 0; x < NX; x++)
+        {
+            for (y = 0; y < NY; y++)
+            {
+                data_out[x][y] = 273.15f + (x * NY + y) / 7.0f;
+                memcpy(&u, &data_out[x][y], sizeof(u));
+                u &= ~((1u << (23 - NSB)) - 1u);
+                memcpy(&data_out[x][y], &u, sizeof(u));
+                if ((x + y) % 17 == 0)
+                    data_out[x][y] = FILL_VALUE;
+                data_out2[x][y] = (x * NY + y) / 4.0;
+            }
+        }
+
+        /* Create file. */
+        if (nc_create(FILE_NAME, NC_NETCDF4, &ncid)) ERR;
+
+        /* Create dims. */
+        if (nc_def_dim(ncid, X_NAME, NX, &dimid[0])) ERR;
+        if (nc_def_dim(ncid, Y_NAME, NY, &dimid[1])) ERR;
+
+        /* Create the variables. */
+        if (nc_def_var(ncid, VAR_NAME, NC_FLOAT, NDIM2, dimid, &varid)) ERR;
+        if (nc_def_var(ncid, VAR_NAME2, NC_DOUBLE, NDIM2, dimid, &varid2)) ERR;
+        if (nc_def_var(ncid, VAR_NAME3, NC_SHORT, NDIM2, dimid, &varid3)) ERR;
+        if (nc_def_var_chunking(ncid, varid, NC_CHUNKED, chunksizes)) ERR;
+        if (nc_def_var_chunking(ncid, varid2, NC_CHUNKED, chunksizes)) ERR;
+        if (nc_put_att_float(ncid, varid, "_FillValue", NC_FLOAT, 1, &fill_value)) ERR;
+
+        /* Check setting. */
+        if (nc_inq_var_bitpack(ncid, varid, &bitpack, &nsb)) ERR;
+        if (bitpack) ERR;
+
+        /* NSB must suit the type, and only floating-point values
+         * are packed. */
+        if (nc_def_var_bitpack(ncid, varid, -1) != NC_EINVAL) ERR;
+        if (nc_def_var_bitpack(ncid, varid, 24) != NC_EINVAL) ERR;
+        if (nc_def_var_bitpack(ncid, varid2, 53) != NC_EINVAL) ERR;
+        if (nc_def_var_bitpack(ncid, varid3, 0) != NC_EINVAL) ERR;
+
+        /* Set up BitPack with the NSB of the data, and with NSB
+         * chosen by the filter. */
+        if (nc_def_var_bitpack(ncid, varid, NSB)) ERR;
+        if (nc_def_var_bitpack(ncid, varid2, 0)) ERR;
+
+        /* Check setting. */
+        if (nc_inq_var_bitpack(ncid, varid, &bitpack, &nsb)) ERR;
+        if (!bitpack || nsb != NSB) ERR;
+        bitpack = 0;
+        if (nc_inq_var_bitpack(ncid, varid2, &bitpack, &nsb)) ERR;
+        if (!bitpack || nsb) ERR;
+        if (nc_inq_var_bitpack(ncid, varid2, NULL, NULL)) ERR;
+
+        /* Write the data. */
+        if (nc_put_var_float(ncid, varid, (float *)data_out)) ERR;
+        if (nc_put_var_double(ncid, varid2, (double *)data_out2)) ERR;
+
+        /* Close the file. */
+        if (nc_close(ncid)) ERR;
+
+        {
+            float data_in[NX][NY];
+            double data_in2[NX][NY];
+
+            /* Now reopen the file and check. */
+            if (nc_open(FILE_NAME, NC_NETCDF4, &ncid)) ERR;
+
+            /* Check settings. */
+            if (nc_inq_var_bitpack(ncid, varid, &bitpack, &nsb)) ERR;
+            if (!bitpack || nsb != NSB) ERR;
+            if (nc_inq_var_bitpack(ncid, varid2, &bitpack, &nsb)) ERR;
+            if (!bitpack || nsb) ERR;
+            if (nc_inq_var_bitpack(ncid, varid3, &bitpack, &nsb)) ERR;
+            if (bitpack) ERR;
+
+            /* Read the data. */
+            if (nc_get_var_float(ncid, varid, (float *)data_in)) ERR;
+            if (nc_get_var_double(ncid, varid2, (double *)data_in2)) ERR;
+
+            /* Check the data. BitPack is lossless, including for
+             * fill values. */
+            for (x = 0; x < NX; x++)
+            {
+                for (y = 0; y < NY; y++)
+                {
+                    if (data_in[x][y] != data_out[x][y]) ERR;
+                    if (data_in2[x][y] != data_out2[x][y]) ERR;
+                }
+            }
+
+            /* Close the file. */
+            if (nc_close(ncid)) ERR;
+        }
+    }
+    SUMMARIZE_ERR;
+#ifdef BUILD_BITROUND
+    printf("*** Checking BitPack after BitRound...");
+    {
+        int ncid;
+        int dimid[NDIM2];
+        int varid, varid2;
+        size_t chunksizes[NDIM2] = {NX / 2, NY / 2};
+        float data_out[NX][NY];
+        float data_in[NX][NY], data_in2[NX][NY];
+        int x, y;
+        int bitpack, nsb;
+
+        for (x = 0; x < NX; x++)
+            for (y = 0; y < NY; y++)
+                data_out[x][y] = 273.15f + (x * NY + y) / 7.0f;
+
+        /* Quantize both variables with BitRound, and pack the second,
+         * which adopts the NSB of BitRound. */
+        if (nc_create(FILE_NAME, NC_NETCDF4|NC_CLOBBER, &ncid)) ERR;
+        if (nc_def_dim(ncid, X_NAME, NX, &dimid[0])) ERR;
+        if (nc_def_dim(ncid, Y_NAME, NY, &dimid[1])) ERR;
+        if (nc_def_var(ncid, VAR_NAME, NC_FLOAT, NDIM2, dimid, &varid)) ERR;
+        if (nc_def_var(ncid, VAR_NAME2, NC_FLOAT, NDIM2, dimid, &varid2)) ERR;
+        if (nc_def_var_chunking(ncid, varid, NC_CHUNKED, chunksizes)) ERR;
+        if (nc_def_var_chunking(ncid, varid2, NC_CHUNKED, chunksizes)) ERR;
+        if (nc_def_var_bitround(ncid, varid, NSB)) ERR;
+        if (nc_def_var_bitround(ncid, varid2, NSB)) ERR;
+        if (nc_def_var_bitpack(ncid, varid2, 0)) ERR;
+        if (nc_put_var_float(ncid, varid, (float *)data_out)) ERR;
+        if (nc_put_var_float(ncid, varid2, (float *)data_out)) ERR;
+        if (nc_close(ncid)) ERR;
+
+        /* Packed values equal values that are only quantized. */
+        if (nc_open(FILE_NAME, NC_NETCDF4, &ncid)) ERR;
+        if (nc_inq_var_bitpack(ncid, varid2, &bitpack, &nsb)) ERR;
+        if (!bitpack || nsb != NSB) ERR;
+        if (nc_get_var_float(ncid, varid, (float *)data_in)) ERR;
+        if (nc_get_var_float(ncid, varid2, (float *)data_in2)) ERR;
+        for (x = 0; x < NX; x++)
+            for (y = 0; y < NY; y++)
+                if (data_in2[x][y] != data_in[x][y]) ERR;
+        if (nc_close(ncid)) ERR;
+    }
+    SUMMARIZE_ERR;
+#endif /* BUILD_BITROUND */
+#define NTYPES 2
+    printf("*** Checking BitPack handling of text...");
+    {
+        int ncid;
+        int dimid[NDIM2];
+        int varid;
+        int bitpack;
+        char file_name[STR_LEN + 1];
+        int xtype[NTYPES] = {NC_CHAR, NC_STRING};
+        int t;
+
+        for (t = 0; t < NTYPES; t++)
+        {
+            sprintf(file_name, "%s_bitpack_type_%d.nc", TEST, xtype[t]);
+
+            /* Create file. */
+            if (nc_create(file_name, NC_NETCDF4, &ncid)) ERR;
+            if (nc_def_dim(ncid, X_NAME, NX, &dimid[0])) ERR;
+            if (nc_def_dim(ncid, Y_NAME, NY, &dimid[1])) ERR;
+            if (nc_def_var(ncid, VAR_NAME, xtype[t], NDIM2, dimid, &varid)) ERR;
+
+            /* BitPack returns NC_EINVAL because this is text. */
+            if (nc_def_var_bitpack(ncid, varid, 0) != NC_EINVAL) ERR;
+            if (nc_close(ncid)) ERR;
+
+            /* Check file. */
+            {
+                if (nc_open(file_name, NC_NETCDF4, &ncid)) ERR;
+                if (nc_inq_var_bitpack(ncid, varid, &bitpack, NULL)) ERR;
+                if (bitpack) ERR;
+                if (nc_close(ncid)) ERR;
+            }
+        }
+    }
+    SUMMARIZE_ERR;
+    FINAL_RESULTS;
+}
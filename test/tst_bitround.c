@@ -0,0 +1,555 @@
+/* This is part of the CCR package. Copyright 2026.
+
+   Test BitRound quantization.
+
+   agent 10/17/26
+*/
+
+#include "config.h"
+#include <math.h> /* Define fabs(), ldexp(), sin() */
+#include <string.h> /* Define memcmp() */
+#include "ccr.h"
+#include "ccr_test.h"
+#include <hdf5.h>
+#include <H5DSpublic.h>
+#include <netcdf.h>
+
+#define FILE_NAME "tst_bitround.nc"
+#define TEST "tst_bitround"
+#define STR_LEN 255
+#define X_NAME "X"
+#define Y_NAME "Y"
+#define NDIM2 2
+#define VAR_NAME "Proud_Mary"
+#define VAR_NAME2 "Green_River"
+#define NX 60
+#define NY 120
+
+#define NFILE 2
+
+#define NX_BIG 100
+#define NY_BIG 100
+
+#define DIM_LEN_5 5
+#define NDIM1 1
+
+/* Err is used to keep track of errors within each set of tests,
+ * total_err is the number of errors in the entire test program, which
+ * generally cosists of several sets of tests. */
+static int total_err = 0, err = 0;
+
+/* This struct allows us to treat float as uint32_t
+ * types. */
+union FU {
+    float f;
+    uint32_t u;
+};
+
+/* This struct allows us to treat double points as uint64_t
+ * types. */
+union DU {
+    double d;
+    uint64_t u;
+};
+
+int
+main()
+{
+    printf("\n*** Checking BitRound filter.\n");
+    printf("*** Checking BitRound quantization...");
+    {
+        int ncid;
+        int dimid[NDIM2];
+        int varid, varid2;
+        float data_out[NX][NY];
+        int x, y;
+        int nsb_in;
+        int nsb_out=10;
+        int bitround;
+
+        /* Create some data to write. */
+        for (x = 0; x < NX; x++)
+            for (y = 0; y < NY; y++)
+                data_out[x][y] = x * NY + y;
+
+        /* Create file. */
+        if (nc_create(FILE_NAME, NC_NETCDF4, &ncid)) ERR;
+
+        /* Create dims. */
+        if (nc_def_dim(ncid, X_NAME, NX, &dimid[0])) ERR;
+        if (nc_def_dim(ncid, Y_NAME, NY, &dimid[1])) ERR;
+
+        /* Create the variables. */
+        if (nc_def_var(ncid, VAR_NAME, NC_FLOAT, NDIM2, dimid, &varid)) ERR;
+        if (nc_def_var(ncid, VAR_NAME2, NC_DOUBLE, NDIM2, dimid, &varid2)) ERR;
+
+        /* These won't work. */
+        if (nc_def_var_bitround(ncid, varid, -9) != NC_EINVAL) ERR;
+        if (nc_def_var_bitround(ncid, varid, 0) != NC_EINVAL) ERR;
+        if (nc_def_var_bitround(ncid, varid, 24) != NC_EINVAL) ERR;
+        if (nc_def_var_bitround(ncid, varid2, 53) != NC_EINVAL) ERR;
+
+        /* Check setting. */
+        if (nc_inq_var_bitround(ncid, varid, &bitround, &nsb_in)) ERR;
+        if (bitround) ERR;
+        if (nc_inq_var_bitround(ncid, varid2, &bitround, &nsb_in)) ERR;
+        if (bitround) ERR;
+
+        /* Set up quantization. */
+        if (nc_def_var_bitround(ncid, varid, nsb_out)) ERR;
+        if (nc_def_var_bitround(ncid, varid2, nsb_out)) ERR;
+
+        /* Check setting. */
+        if (nc_inq_var_bitround(ncid, varid, &bitround, &nsb_in)) ERR;
+        if (!bitround || nsb_in != nsb_out) ERR;
+        nsb_in = 0;
+        bitround = 1;
+        if (nc_inq_var_bitround(ncid, varid, NULL, &nsb_in)) ERR;
+        if (nc_inq_var_bitround(ncid, varid, &bitround, NULL)) ERR;
+        if (!bitround || nsb_in != nsb_out) ERR;
+        if (nc_inq_var_bitround(ncid, varid, NULL, NULL)) ERR;
+
+        /* Check varid2. */
+        if (nc_inq_var_bitround(ncid, varid2, &bitround, &nsb_in)) ERR;
+        if (!bitround || nsb_in != nsb_out) ERR;
+
+        /* Write the data. */
+        if (nc_put_var(ncid, varid, data_out)) ERR;
+        if (nc_put_var_float(ncid, varid2, (float *)data_out)) ERR;
+
+        /* Close the file. */
+        if (nc_close(ncid)) ERR;
+
+        {
+            float data_in[NX][NY];
+            float data_in2[NX][NY];
+
+            /* Now reopen the file and check. */
+            if (nc_open(FILE_NAME, NC_NETCDF4, &ncid)) ERR;
+
+            /* Check settings. */
+            if (nc_inq_var_bitround(ncid, varid, &bitround, &nsb_in)) ERR;
+            if (!bitround || nsb_in != nsb_out) ERR;
+            if (nc_inq_var_bitround(ncid, varid2, &bitround, &nsb_in)) ERR;
+            if (!bitround || nsb_in != nsb_out) ERR;
+
+            /* Read the data. */
+            if (nc_get_var(ncid, varid, data_in)) ERR;
+            if (nc_get_var_float(ncid, varid2, (float *)data_in2)) ERR;
+
+            /* Check the data. BitRound error is at most half the last
+             * retained bit. */
+            for (x = 0; x < NX; x++)
+            {
+                for (y = 0; y < NY; y++)
+                {
+                    if (fabs(data_in[x][y] - data_out[x][y]) > ldexp(fabs(data_out[x][y]), -(nsb_out + 1))) ERR;
+                    if (fabs(data_in2[x][y] - data_out[x][y]) > ldexp(fabs(data_out[x][y]), -(nsb_out + 1))) ERR;
+                }
+            }
+
+            /* Close the file. */
+            if (nc_close(ncid)) ERR;
+        }
+    }
+    SUMMARIZE_ERR;
+    printf("*** Checking BitRound size of quantization...");
+    {
+        int ncid;
+        int dimid[NDIM2];
+        int varid;
+        float *data_out;
+        float *data_in;
+        int x, f;
+        int nsb_in, bitround;
+        int nsb_out=10;
+
+        if (!(data_out = malloc(NX_BIG * NY_BIG * sizeof(float)))) ERR;
+        if (!(data_in = malloc(NX_BIG * NY_BIG * sizeof(float)))) ERR;
+
+        /* Create some data to write. */
+        for (x = 0; x < NX_BIG * NY_BIG; x++)
+            data_out[x] = x * NY_BIG + x % NX_BIG;
+
+        for (f = 0; f < NFILE; f++)
+        {
+            char file_name[STR_LEN + 1];
+
+            sprintf(file_name, "%s_%s.nc", TEST, (f ? "bitround" : "unquantized"));
+
+            /* Create file. */
+            if (nc_create(file_name, NC_NETCDF4, &ncid)) ERR;
+            if (nc_def_dim(ncid, X_NAME, NX_BIG, &dimid[0])) ERR;
+            if (nc_def_dim(ncid, Y_NAME, NY_BIG, &dimid[1])) ERR;
+            if (nc_def_var(ncid, VAR_NAME, NC_FLOAT, NDIM2, dimid, &varid)) ERR;
+            if (f)
+                if (nc_def_var_bitround(ncid, varid, nsb_out)) ERR;
+            if (nc_put_var(ncid, varid, data_out)) ERR;
+            if (nc_close(ncid)) ERR;
+
+            /* Check file. */
+            {
+                if (nc_open(file_name, NC_NETCDF4, &ncid)) ERR;
+                if (nc_inq_var_bitround(ncid, varid, &bitround, &nsb_in)) ERR;
+                if (f)
+                {
+                    if (!bitround || nsb_in != nsb_out) ERR;
+                }
+                else
+                {
+                    if (bitround) ERR;
+                }
+                if (nc_get_var(ncid, varid, data_in)) ERR;
+                for (x = 0; x < NX_BIG * NY_BIG; x++)
+                {
+                    if (f)
+                    {
+                        if (fabs(data_in[x] - data_out[x]) > ldexp(fabs(data_out[x]), -(nsb_out + 1))) ERR;
+                    }
+                    else
+                    {
+                        if (data_in[x] != data_out[x]) ERR;
+                    }
+                }
+                if (nc_close(ncid)) ERR;
+            }
+        } /* next file */
+
+        free(data_out);
+        free(data_in);
+    }
+    SUMMARIZE_ERR;
+#define NTYPES 9
+    printf("*** Checking BitRound handling of non-floats...");
+    {
+        int ncid;
+        int dimid[NDIM2];
+        int varid;
+        int nsb_in, bitround;
+        int nsb_out=10;
+        char file_name[STR_LEN + 1];
+        int xtype[NTYPES] = {NC_CHAR, NC_SHORT, NC_INT, NC_BYTE, NC_UBYTE, NC_USHORT, NC_UINT, NC_INT64, NC_UINT64};
+        int t;
+
+        for (t = 0; t < NTYPES; t++)
+        {
+            sprintf(file_name, "%s_bitround_type_%d.nc", TEST, xtype[t]);
+
+            /* Create file. */
+            if (nc_create(file_name, NC_NETCDF4, &ncid)) ERR;
+            if (nc_def_dim(ncid, X_NAME, NX_BIG, &dimid[0])) ERR;
+            if (nc_def_dim(ncid, Y_NAME, NY_BIG, &dimid[1])) ERR;
+            if (nc_def_var(ncid, VAR_NAME, xtype[t], NDIM2, dimid, &varid)) ERR;
+
+            /* BitRound filter returns NC_EINVAL because this is not an
+             * NC_FLOAT or NC_DOULBE. */
+            if (nc_def_var_bitround(ncid, varid, nsb_out) != NC_EINVAL) ERR;
+            if (nc_close(ncid)) ERR;
+
+            /* Check file. */
+            {
+                if (nc_open(file_name, NC_NETCDF4, &ncid)) ERR;
+                if (nc_inq_var_bitround(ncid, varid, &bitround, &nsb_in)) ERR;
+                if (bitround) ERR;
+                if (nc_close(ncid)) ERR;
+            }
+        }
+    }
+    SUMMARIZE_ERR;
+    printf("*** Checking BitRound values...");
+    {
+        int ncid;
+        int dimid;
+        int varid, varid2;
+        float float_data[DIM_LEN_5] = {1.11111111, 1.0, 9.99999999, 12345.67, .1234567};
+        double double_data[DIM_LEN_5] = {1.1111111, 1.0, 9.999999999, 1234567890.12345, 123456789012345.0};
+        int nsb_out = 10;
+
+        /* Create file. */
+        if (nc_create(FILE_NAME, NC_NETCDF4, &ncid)) ERR;
+
+        /* Create dims. */
+        if (nc_def_dim(ncid, X_NAME, DIM_LEN_5, &dimid)) ERR;
+
+        /* Create the variables. */
+        if (nc_def_var(ncid, VAR_NAME, NC_FLOAT, NDIM1, &dimid, &varid)) ERR;
+        if (nc_def_var(ncid, VAR_NAME2, NC_DOUBLE, NDIM1, &dimid, &varid2)) ERR;
+
+        /* Set up quantization. */
+        if (nc_def_var_bitround(ncid, varid, nsb_out)) ERR;
+        if (nc_def_var_bitround(ncid, varid2, nsb_out)) ERR;
+
+        /* Write the data. */
+        if (nc_put_var_float(ncid, varid, float_data)) ERR;
+        if (nc_put_var_double(ncid, varid2, double_data)) ERR;
+
+        /* Close the file. */
+        if (nc_close(ncid)) ERR;
+
+        {
+            float float_data_in[DIM_LEN_5];
+            double double_data_in[DIM_LEN_5];
+	    int x;
+
+            /* Now reopen the file and check. */
+            if (nc_open(FILE_NAME, NC_NETCDF4, &ncid)) ERR;
+
+            /* Read the data. */
+            if (nc_get_var_float(ncid, varid, float_data_in)) ERR;
+            if (nc_get_var_double(ncid, varid2, double_data_in)) ERR;
+
+	    union FU fin;
+	    union FU xpect[DIM_LEN_5];
+	    union DU dfin;
+	    union DU double_xpect[DIM_LEN_5];
+	    xpect[0].u = 0x3f8e4000;
+	    xpect[1].u = 0x3f800000;
+	    xpect[2].u = 0x41200000;
+	    xpect[3].u = 0x4640e000;
+	    xpect[4].u = 0x3dfce000;
+	    double_xpect[0].u = 0x3ff1c80000000000;
+	    double_xpect[1].u = 0x3ff0000000000000;
+	    double_xpect[2].u = 0x4024000000000000;
+	    double_xpect[3].u = 0x41d2640000000000;
+	    double_xpect[4].u = 0x42dc140000000000;
+
+	    for (x = 0; x < DIM_LEN_5; x++)
+	    {
+		fin.f = float_data_in[x];
+		dfin.d = double_data_in[x];
+		if (fin.u != xpect[x].u)
+		    ERR;
+		if (dfin.u != double_xpect[x].u)
+		    ERR;
+	    }
+
+            /* Close the file. */
+            if (nc_close(ncid)) ERR;
+        }
+    }
+    SUMMARIZE_ERR;
+    printf("*** Checking BitRound values with some default fill values...");
+    {
+        int ncid;
+        int dimid;
+        int varid, varid2;
+        float float_data[DIM_LEN_5] = {1.11111111, NC_FILL_FLOAT, 9.99999999, 12345.67, NC_FILL_FLOAT};
+        double double_data[DIM_LEN_5] = {1.1111111, NC_FILL_DOUBLE, 9.999999999, 1234567890.12345, NC_FILL_DOUBLE};
+        int nsb_out = 10;
+
+        /* Create file. */
+        if (nc_create(FILE_NAME, NC_NETCDF4, &ncid)) ERR;
+
+        /* Create dims. */
+        if (nc_def_dim(ncid, X_NAME, DIM_LEN_5, &dimid)) ERR;
+
+        /* Create the variables. */
+        if (nc_def_var(ncid, VAR_NAME, NC_FLOAT, NDIM1, &dimid, &varid)) ERR;
+        if (nc_def_var(ncid, VAR_NAME2, NC_DOUBLE, NDIM1, &dimid, &varid2)) ERR;
+
+        /* Set up quantization. */
+        if (nc_def_var_bitround(ncid, varid, nsb_out)) ERR;
+        if (nc_def_var_bitround(ncid, varid2, nsb_out)) ERR;
+
+        /* Write the data. */
+        if (nc_put_var_float(ncid, varid, float_data)) ERR;
+        if (nc_put_var_double(ncid, varid2, double_data)) ERR;
+
+        /* Close the file. */
+        if (nc_close(ncid)) ERR;
+
+        {
+            float float_data_in[DIM_LEN_5];
+            double double_data_in[DIM_LEN_5];
+	    int x;
+
+            /* Now reopen the file and check. */
+            if (nc_open(FILE_NAME, NC_NETCDF4, &ncid)) ERR;
+
+            /* Read the data. */
+            if (nc_get_var_float(ncid, varid, float_data_in)) ERR;
+            if (nc_get_var_double(ncid, varid2, double_data_in)) ERR;
+
+	    union FU fin;
+	    union FU xpect[DIM_LEN_5];
+	    union DU dfin;
+	    union DU double_xpect[DIM_LEN_5];
+	    xpect[0].u = 0x3f8e4000;
+	    xpect[1].u = 0x7cf00000;
+	    xpect[2].u = 0x41200000;
+	    xpect[3].u = 0x4640e000;
+	    xpect[4].u = 0x7cf00000;
+	    double_xpect[0].u = 0x3ff1c80000000000;
+	    double_xpect[1].u = 0x479e000000000000;
+	    double_xpect[2].u = 0x4024000000000000;
+	    double_xpect[3].u = 0x41d2640000000000;
+	    double_xpect[4].u = 0x479e000000000000;
+
+	    for (x = 0; x < DIM_LEN_5; x++)
+	    {
+		fin.f = float_data_in[x];
+		dfin.d = double_data_in[x];
+		if (fin.u != xpect[x].u)
+		    ERR;
+		if (dfin.u != double_xpect[x].u)
+		    ERR;
+	    }
+
+            /* Close the file. */
+            if (nc_close(ncid)) ERR;
+        }
+    }
+    SUMMARIZE_ERR;
+    printf("*** Checking BitRound values with some custom fill values...");
+    {
+	#define CUSTOM_FILL_FLOAT 99.99999
+	#define CUSTOM_FILL_DOUBLE -99999.99999
+        int ncid;
+        int dimid;
+        int varid, varid2;
+        float float_data[DIM_LEN_5] = {1.11111111, CUSTOM_FILL_FLOAT, 9.99999999, 12345.67, CUSTOM_FILL_FLOAT};
+        double double_data[DIM_LEN_5] = {1.1111111, CUSTOM_FILL_DOUBLE, 9.999999999, 1234567890.12345, CUSTOM_FILL_DOUBLE};
+        int nsb_out = 10;
+	float custom_fill_float = CUSTOM_FILL_FLOAT;
+	double custom_fill_double = CUSTOM_FILL_DOUBLE;
+
+        /* Create file. */
+        if (nc_create(FILE_NAME, NC_NETCDF4, &ncid)) ERR;
+
+        /* Create dims. */
+        if (nc_def_dim(ncid, X_NAME, DIM_LEN_5, &dimid)) ERR;
+
+        /* Create the variables. */
+        if (nc_def_var(ncid, VAR_NAME, NC_FLOAT, NDIM1, &dimid, &varid)) ERR;
+	if (nc_put_att_float(ncid, varid, _FillValue, NC_FLOAT, 1, &custom_fill_float)) ERR;
+        if (nc_def_var(ncid, VAR_NAME2, NC_DOUBLE, NDIM1, &dimid, &varid2)) ERR;
+	if (nc_put_att_double(ncid, varid2, _FillValue, NC_DOUBLE, 1, &custom_fill_double)) ERR;
+
+        /* Set up quantization. */
+        if (nc_def_var_bitround(ncid, varid, nsb_out)) ERR;
+        if (nc_def_var_bitround(ncid, varid2, nsb_out)) ERR;
+
+        /* Write the data. */
+        if (nc_put_var_float(ncid, varid, float_data)) ERR;
+        if (nc_put_var_double(ncid, varid2, double_data)) ERR;
+
+        /* Close the file. */
+        if (nc_close(ncid)) ERR;
+
+        {
+            float float_data_in[DIM_LEN_5];
+            double double_data_in[DIM_LEN_5];
+	    int x;
+
+            /* Now reopen the file and check. */
+            if (nc_open(FILE_NAME, NC_NETCDF4, &ncid)) ERR;
+
+            /* Read the data. */
+            if (nc_get_var_float(ncid, varid, float_data_in)) ERR;
+            if (nc_get_var_double(ncid, varid2, double_data_in)) ERR;
+
+	    union FU fin;
+	    union FU xpect[DIM_LEN_5];
+	    union DU dfin;
+	    union DU double_xpect[DIM_LEN_5];
+	    xpect[0].u = 0x3f8e4000;
+	    xpect[1].u = 0x42c7ffff;
+	    xpect[2].u = 0x41200000;
+	    xpect[3].u = 0x4640e000;
+	    xpect[4].u = 0x42c7ffff;
+	    double_xpect[0].u = 0x3ff1c80000000000;
+	    double_xpect[1].u = 0xc0f869fffff583a5;
+	    double_xpect[2].u = 0x4024000000000000;
+	    double_xpect[3].u = 0x41d2640000000000;
+	    double_xpect[4].u = 0xc0f869fffff583a5;
+
+	    for (x = 0; x < DIM_LEN_5; x++)
+	    {
+		fin.f = float_data_in[x];
+		dfin.d = double_data_in[x];
+		if (fin.u != xpect[x].u)
+		    ERR;
+		if (dfin.u != double_xpect[x].u)
+		    ERR;
+	    }
+
+            /* Close the file. */
+            if (nc_close(ncid)) ERR;
+        }
+    }
+    SUMMARIZE_ERR;
+    printf("*** Checking BitRound with automatic NSB...");
+    {
+        int ncid;
+        int dimid[NDIM2];
+        int varid, varid2, varid3;
+        float *data_out;
+        float *data_in;
+        int x;
+        int nsb_in, bitround, bitround_auto;
+        double info_level_in;
+        double info_level_out = 0.99;
+
+        if (!(data_out = malloc(NX_BIG * NY_BIG * sizeof(float)))) ERR;
+        if (!(data_in = malloc(NX_BIG * NY_BIG * sizeof(float)))) ERR;
+
+        /* Create some smooth data to write. */
+        for (x = 0; x < NX_BIG * NY_BIG; x++)
+            data_out[x] = 273.15 + 50.0 * sin(x * 1.0e-3);
+
+        /* Create file. */
+        if (nc_create(FILE_NAME, NC_NETCDF4, &ncid)) ERR;
+        if (nc_def_dim(ncid, X_NAME, NX_BIG, &dimid[0])) ERR;
+        if (nc_def_dim(ncid, Y_NAME, NY_BIG, &dimid[1])) ERR;
+        if (nc_def_var(ncid, VAR_NAME, NC_FLOAT, NDIM2, dimid, &varid)) ERR;
+        if (nc_def_var(ncid, VAR_NAME2, NC_DOUBLE, NDIM2, dimid, &varid2)) ERR;
+        if (nc_def_var(ncid, "Born_on_the_Bayou", NC_INT, NDIM2, dimid, &varid3)) ERR;
+
+        /* These won't work. */
+        if (nc_def_var_bitround_auto(ncid, varid, 0.0) != NC_EINVAL) ERR;
+        if (nc_def_var_bitround_auto(ncid, varid, -0.5) != NC_EINVAL) ERR;
+        if (nc_def_var_bitround_auto(ncid, varid, 1.5) != NC_EINVAL) ERR;
+        if (nc_def_var_bitround_auto(ncid, varid, 1.0e-7) != NC_EINVAL) ERR;
+        if (nc_def_var_bitround_auto(ncid, varid3, info_level_out) != NC_EINVAL) ERR;
+
+        /* Check setting. */
+        if (nc_inq_var_bitround_auto(ncid, varid, &bitround_auto, &info_level_in)) ERR;
+        if (bitround_auto) ERR;
+
+        /* Set up quantization, automatic for varid, fixed for varid2. */
+        if (nc_def_var_bitround_auto(ncid, varid, info_level_out)) ERR;
+        if (nc_def_var_bitround(ncid, varid2, 10)) ERR;
+
+        /* Check setting. */
+        if (nc_inq_var_bitround_auto(ncid, varid, &bitround_auto, &info_level_in)) ERR;
+        if (!bitround_auto || info_level_in != info_level_out) ERR;
+        if (nc_inq_var_bitround_auto(ncid, varid, NULL, NULL)) ERR;
+        if (nc_inq_var_bitround(ncid, varid, &bitround, &nsb_in)) ERR;
+        if (!bitround || nsb_in != 0) ERR;
+        if (nc_inq_var_bitround_auto(ncid, varid2, &bitround_auto, &info_level_in)) ERR;
+        if (bitround_auto) ERR;
+
+        /* Write the data. */
+        if (nc_put_var_float(ncid, varid, data_out)) ERR;
+        if (nc_close(ncid)) ERR;
+
+        /* Check file. */
+        {
+            if (nc_open(FILE_NAME, NC_NETCDF4, &ncid)) ERR;
+            if (nc_inq_var_bitround_auto(ncid, varid, &bitround_auto, &info_level_in)) ERR;
+            if (!bitround_auto || info_level_in != info_level_out) ERR;
+            if (nc_get_var_float(ncid, varid, data_in)) ERR;
+
+            /* Data are quantized, yet keep at least one bit. */
+            if (!memcmp(data_in, data_out, NX_BIG * NY_BIG * sizeof(float))) ERR;
+            for (x = 0; x < NX_BIG * NY_BIG; x++)
+                if (fabs(data_in[x] - data_out[x]) > ldexp(fabs(data_out[x]), -2)) ERR;
+            if (nc_close(ncid)) ERR;
+        }
+
+        free(data_out);
+        free(data_in);
+    }
+    SUMMARIZE_ERR;
+    FINAL_RESULTS;
+}
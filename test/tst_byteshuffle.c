@@ -0,0 +1,175 @@
+/* This is part of the CCR package. Copyright 2026.
+
+   Test Byte Shuffle.
+
+   agent 10/17/26
+*/
+
+#include "config.h"
+#include "ccr.h"
+#include "ccr_test.h"
+#include <hdf5.h>
+#include <H5DSpublic.h>
+#include <netcdf.h>
+
+#define FILE_NAME "tst_byteshuffle.nc"
+#define TEST "tst_byteshuffle"
+#define STR_LEN 255
+#define X_NAME "X"
+#define Y_NAME "Y"
+#define NDIM2 2
+#define VAR_NAME "Bad_Moon_Rising"
+#define VAR_NAME2 "Green_River"
+#define VAR_NAME3 "Born_on_the_Bayou"
+#define NX 60
+#define NY 120
+
+/* Err is used to keep track of errors within each set of tests,
+ * total_err is the number of errors in the entire test program, which
+ * generally cosists of several sets of tests. */
+static int total_err = 0, err = 0;
+
+int
+main()
+{
+    printf("\n*** Checking Byte Shuffle filter.\n");
+    printf("*** Checking Byte Shuffle...");
+    {
+        int ncid;
+        int dimid[NDIM2];
+        int varid, varid2, varid3;
+        size_t chunksizes[NDIM2] = {NX / 2, NY / 2 - 1};
+        float data_out[NX][NY];
+        double data_out2[NX][NY];
+        short data_out3[NX][NY];
+        int x, y;
+        int byteshuffle;
+
+        /* Create some data to write. The chunks do not divide the
+         * rows evenly, so edge chunks have lengths that are not a
+         * multiple of the vector width. */
+        for (x = 0; x < NX; x++)
+        {
+            for (y = 0; y < NY; y++)
+            {
+                data_out[x][y] = 273.15f + (x * NY + y) / 7.0f;
+                data_out2[x][y] = (x * NY + y) / 3.0;
+                data_out3[x][y] = (short)(x * NY - y);
+            }
+        }
+
+        /* Create file. */
+        if (nc_create(FILE_NAME, NC_NETCDF4, &ncid)) ERR;
+
+        /* Create dims. */
+        if (nc_def_dim(ncid, X_NAME, NX, &dimid[0])) ERR;
+        if (nc_def_dim(ncid, Y_NAME, NY, &dimid[1])) ERR;
+
+        /* Create the variables. */
+        if (nc_def_var(ncid, VAR_NAME, NC_FLOAT, NDIM2, dimid, &varid)) ERR;
+        if (nc_def_var(ncid, VAR_NAME2, NC_DOUBLE, NDIM2, dimid, &varid2)) ERR;
+        if (nc_def_var(ncid, VAR_NAME3, NC_SHORT, NDIM2, dimid, &varid3)) ERR;
+        if (nc_def_var_chunking(ncid, varid, NC_CHUNKED, chunksizes)) ERR;
+        if (nc_def_var_chunking(ncid, varid2, NC_CHUNKED, chunksizes)) ERR;
+        if (nc_def_var_chunking(ncid, varid3, NC_CHUNKED, chunksizes)) ERR;
+
+        /* Check setting. */
+        if (nc_inq_var_byteshuffle(ncid, varid, &byteshuffle)) ERR;
+        if (byteshuffle) ERR;
+
+        /* Set up Byte Shuffle, followed by a compressor on two of
+         * the variables. */
+        if (nc_def_var_byteshuffle(ncid, varid)) ERR;
+        if (nc_def_var_deflate(ncid, varid, 0, 1, 1)) ERR;
+        if (nc_def_var_byteshuffle(ncid, varid2)) ERR;
+        if (nc_def_var_byteshuffle(ncid, varid3)) ERR;
+        if (nc_def_var_deflate(ncid, varid3, 0, 1, 1)) ERR;
+
+        /* Check setting. */
+        if (nc_inq_var_byteshuffle(ncid, varid, &byteshuffle)) ERR;
+        if (!byteshuffle) ERR;
+        byteshuffle = 0;
+        if (nc_inq_var_byteshuffle(ncid, varid2, &byteshuffle)) ERR;
+        if (!byteshuffle) ERR;
+        if (nc_inq_var_byteshuffle(ncid, varid3, NULL)) ERR;
+
+        /* Write the data. */
+        if (nc_put_var_float(ncid, varid, (float *)data_out)) ERR;
+        if (nc_put_var_double(ncid, varid2, (double *)data_out2)) ERR;
+        if (nc_put_var_short(ncid, varid3, (short *)data_out3)) ERR;
+
+        /* Close the file. */
+        if (nc_close(ncid)) ERR;
+
+        {
+            float data_in[NX][NY];
+            double data_in2[NX][NY];
+            short data_in3[NX][NY];
+
+            /* Now reopen the file and check. */
+            if (nc_open(FILE_NAME, NC_NETCDF4, &ncid)) ERR;
+
+            /* Check settings. */
+            if (nc_inq_var_byteshuffle(ncid, varid, &byteshuffle)) ERR;
+            if (!byteshuffle) ERR;
+            if (nc_inq_var_byteshuffle(ncid, varid3, &byteshuffle)) ERR;
+            if (!byteshuffle) ERR;
+
+            /* Read the data. */
+            if (nc_get_var_float(ncid, varid, (float *)data_in)) ERR;
+            if (nc_get_var_double(ncid, varid2, (double *)data_in2)) ERR;
+            if (nc_get_var_short(ncid, varid3, (short *)data_in3)) ERR;
+
+            /* Check the data. Byte Shuffle is lossless. */
+            for (x = 0; x < NX; x++)
+            {
+                for (y = 0; y < NY; y++)
+                {
+                    if (data_in[x][y] != data_out[x][y]) ERR;
+                    if (data_in2[x][y] != data_out2[x][y]) ERR;
+                    if (data_in3[x][y] != data_out3[x][y]) ERR;
+                }
+            }
+
+            /* Close the file. */
+            if (nc_close(ncid)) ERR;
+        }
+    }
+    SUMMARIZE_ERR;
+#define NTYPES 2
+    printf("*** Checking Byte Shuffle handling of text...");
+    {
+        int ncid;
+        int dimid[NDIM2];
+        int varid;
+        int byteshuffle;
+        char file_name[STR_LEN + 1];
+        int xtype[NTYPES] = {NC_CHAR, NC_STRING};
+        int t;
+
+        for (t = 0; t < NTYPES; t++)
+        {
+            sprintf(file_name, "%s_byteshuffle_type_%d.nc", TEST, xtype[t]);
+
+            /* Create file. */
+            if (nc_create(file_name, NC_NETCDF4, &ncid)) ERR;
+            if (nc_def_dim(ncid, X_NAME, NX, &dimid[0])) ERR;
+            if (nc_def_dim(ncid, Y_NAME, NY, &dimid[1])) ERR;
+            if (nc_def_var(ncid, VAR_NAME, xtype[t], NDIM2, dimid, &varid)) ERR;
+
+            /* Byte Shuffle returns NC_EINVAL because this is text. */
+            if (nc_def_var_byteshuffle(ncid, varid) != NC_EINVAL) ERR;
+            if (nc_close(ncid)) ERR;
+
+            /* Check file. */
+            {
+                if (nc_open(file_name, NC_NETCDF4, &ncid)) ERR;
+                if (nc_inq_var_byteshuffle(ncid, varid, &byteshuffle)) ERR;
+                if (byteshuffle) ERR;
+                if (nc_close(ncid)) ERR;
+            }
+        }
+    }
+    SUMMARIZE_ERR;
+    FINAL_RESULTS;
+}
@@ -31,6 +31,8 @@
 #define NY 120
 #define DEFLATE_LEVEL 3
 #define SIMPLE_VAR_NAME "data"
+#define NX_BIG 600
+#define NY_BIG 500
 
 /* Err is used to keep track of errors within each set of tests,
  * total_err is the number of errors in the entire test program, which
@@ -116,6 +118,129 @@ main()
         }
     }
     SUMMARIZE_ERR;
+    printf("*** Checking multi-stream bzip2 filter...");
+    {
+        int ncid;
+        int dimid[NDIM2];
+        int varid;
+        size_t chunksizes[NDIM2] = {NX_BIG, NY_BIG};
+        int *data_out;
+        int x, y;
+        int level_in, bzip2, multistream;
+
+        /* Create some data to write. At level 1 the chunk of 1.2 MB
+         * is split into 12 streams. */
+        if (!(data_out = malloc(NX_BIG * NY_BIG * sizeof(int)))) ERR;
+        for (x = 0; x < NX_BIG; x++)
+            for (y = 0; y < NY_BIG; y++)
+                data_out[x * NY_BIG + y] = x * NY_BIG + y / 3;
+
+        /* Create file. */
+        if (nc_create(FILE_NAME, NC_NETCDF4, &ncid)) ERR;
+        if (nc_def_dim(ncid, X_NAME, NX_BIG, &dimid[0])) ERR;
+        if (nc_def_dim(ncid, Y_NAME, NY_BIG, &dimid[1])) ERR;
+        if (nc_def_var(ncid, VAR_NAME, NC_INT, NDIM2, dimid, &varid)) ERR;
+        if (nc_def_var_chunking(ncid, varid, NC_CHUNKED, chunksizes)) ERR;
+
+        /* These won't work. */
+        if (nc_def_var_bzip2_multistream(ncid, varid, 0) != NC_EINVAL) ERR;
+        if (nc_def_var_bzip2_multistream(ncid, varid, 10) != NC_EINVAL) ERR;
+
+        /* Check setting. */
+        if (nc_inq_var_bzip2_multistream(ncid, varid, &multistream, &level_in)) ERR;
+        if (multistream) ERR;
+
+        /* Set up compression. */
+        if (nc_def_var_bzip2_multistream(ncid, varid, 1)) ERR;
+
+        /* Check setting. Multi-stream bzip2 is also bzip2. */
+        if (nc_inq_var_bzip2_multistream(ncid, varid, &multistream, &level_in)) ERR;
+        if (!multistream || level_in != 1) ERR;
+        if (nc_inq_var_bzip2(ncid, varid, &bzip2, &level_in)) ERR;
+        if (!bzip2 || level_in != 1) ERR;
+        if (nc_inq_var_bzip2_multistream(ncid, varid, NULL, NULL)) ERR;
+
+        /* Write the data. */
+        if (nc_put_var(ncid, varid, data_out)) ERR;
+        if (nc_close(ncid)) ERR;
+
+        {
+            int *data_in;
+
+            if (!(data_in = malloc(NX_BIG * NY_BIG * sizeof(int)))) ERR;
+
+            /* Now reopen the file and check. */
+            if (nc_open(FILE_NAME, NC_NETCDF4, &ncid)) ERR;
+            if (nc_inq_var_bzip2_multistream(ncid, varid, &multistream, &level_in)) ERR;
+            if (!multistream || level_in != 1) ERR;
+            if (nc_get_var(ncid, varid, data_in)) ERR;
+            for (x = 0; x < NX_BIG * NY_BIG; x++)
+                if (data_in[x] != data_out[x]) ERR;
+            if (nc_close(ncid)) ERR;
+            free(data_in);
+        }
+        free(data_out);
+    }
+    SUMMARIZE_ERR;
+    printf("*** Checking sized bzip2 filter...");
+    {
+        int ncid;
+        int dimid[NDIM2];
+        int varid;
+        float data_out[NX][NY];
+        int x, y;
+        int level_in, bzip2, sized, multistream;
+
+        /* Create some data to write. */
+        for (x = 0; x < NX; x++)
+            for (y = 0; y < NY; y++)
+                data_out[x][y] = 273.15f + (x * NY + y) / 16;
+
+        /* Create file. */
+        if (nc_create(FILE_NAME, NC_NETCDF4, &ncid)) ERR;
+        if (nc_def_dim(ncid, X_NAME, NX, &dimid[0])) ERR;
+        if (nc_def_dim(ncid, Y_NAME, NY, &dimid[1])) ERR;
+        if (nc_def_var(ncid, VAR_NAME, NC_FLOAT, NDIM2, dimid, &varid)) ERR;
+
+        /* These won't work. */
+        if (nc_def_var_bzip2_sized(ncid, varid, 0) != NC_EINVAL) ERR;
+        if (nc_def_var_bzip2_sized(ncid, varid, 10) != NC_EINVAL) ERR;
+
+        /* Check setting. */
+        if (nc_inq_var_bzip2_sized(ncid, varid, &sized, &level_in)) ERR;
+        if (sized) ERR;
+
+        /* Set up compression. */
+        if (nc_def_var_bzip2_sized(ncid, varid, 9)) ERR;
+
+        /* Check setting. Sized bzip2 is bzip2, but not multi-stream. */
+        if (nc_inq_var_bzip2_sized(ncid, varid, &sized, &level_in)) ERR;
+        if (!sized || level_in != 9) ERR;
+        if (nc_inq_var_bzip2(ncid, varid, &bzip2, &level_in)) ERR;
+        if (!bzip2 || level_in != 9) ERR;
+        if (nc_inq_var_bzip2_multistream(ncid, varid, &multistream, NULL)) ERR;
+        if (multistream) ERR;
+        if (nc_inq_var_bzip2_sized(ncid, varid, NULL, NULL)) ERR;
+
+        /* Write the data. */
+        if (nc_put_var(ncid, varid, data_out)) ERR;
+        if (nc_close(ncid)) ERR;
+
+        {
+            float data_in[NX][NY];
+
+            /* Now reopen the file and check. */
+            if (nc_open(FILE_NAME, NC_NETCDF4, &ncid)) ERR;
+            if (nc_inq_var_bzip2_sized(ncid, varid, &sized, &level_in)) ERR;
+            if (!sized || level_in != 9) ERR;
+            if (nc_get_var(ncid, varid, data_in)) ERR;
+            for (x = 0; x < NX; x++)
+                for (y = 0; y < NY; y++)
+                    if (data_in[x][y] != data_out[x][y]) ERR;
+            if (nc_close(ncid)) ERR;
+        }
+    }
+    SUMMARIZE_ERR;
 #ifdef BUILD_BITGROOM    
 #ifdef HAVE_MULTIFILTERS
     printf("*** Checking bzip2 filter with bitgroom...");
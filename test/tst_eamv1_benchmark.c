@@ -22,6 +22,7 @@
    https://e3sm.org/data/get-e3sm-data/released-e3sm-data/v1-1-deg-data-cmip6/
 
    This program requires the BITGROOM, BZIP2, and the ZSTD filters.
+   If the BITROUND filter was built, it is benchmarked too.
 
    Ed Hartnett 12/15/20
 */
@@ -42,13 +43,18 @@
 #define TEST "tst_eamv1_benchmark"
 #define COMPRESSION_LEVEL 1
 #define NSD 3
+#define NSB 10 /* BitRound keepbits comparable to NSD */
 #define STR_LEN 255
 
 #define NDIM2 2
 #define NDIM3 3
 
 #define MILLION 1000000
+#ifdef BUILD_BITROUND
+#define NFILE3 8
+#else
 #define NFILE3 7
+#endif
 #define MAX_COMPRESSION_STR 64
 
 #define LEV_SIZE 72
@@ -247,6 +253,12 @@ main()
 		level = COMPRESSION_LEVEL;
 		nsd = NSD;
 		break;
+	    case 7:
+		/* For BitRound the nsd column reports NSB. */
+		strcpy(compression, "bitround_zstd");
+		level = COMPRESSION_LEVEL;
+		nsd = NSB;
+		break;
 	    }
 
 	    /* Determine output filename. */
@@ -295,6 +307,12 @@ main()
 		    if (nc_def_var_bitgroom(ncid, varid_2d[v], nsd)) ERR;
 		    if (nc_def_var_bzip2(ncid, varid_2d[v], level)) ERR;
 		    break;
+#ifdef BUILD_BITROUND
+		case 7:
+		    if (nc_def_var_bitround(ncid, varid_2d[v], nsd)) ERR;
+		    if (nc_def_var_zstandard(ncid, varid_2d[v], level)) ERR;
+		    break;
+#endif
 		}
 
 		/* Get the varid for this var in the input file. */
@@ -336,6 +354,12 @@ main()
 		    if (nc_def_var_bitgroom(ncid, varid_3d[v], nsd)) ERR;
 		    if (nc_def_var_bzip2(ncid, varid_3d[v], level)) ERR;
 		    break;
+#ifdef BUILD_BITROUND
+		case 7:
+		    if (nc_def_var_bitround(ncid, varid_3d[v], nsd)) ERR;
+		    if (nc_def_var_zstandard(ncid, varid_3d[v], level)) ERR;
+		    break;
+#endif
 		}
 
 		/* Get the varid for this var in the input file. */
@@ -0,0 +1,178 @@
+/* This is part of the CCR package. Copyright 2026.
+
+   Test Fill Mask.
+
+   agent 10/17/26
+*/
+
+#include "config.h"
+#include "ccr.h"
+#include "ccr_test.h"
+#include <hdf5.h>
+#include <H5DSpublic.h>
+#include <netcdf.h>
+
+#define FILE_NAME "tst_fillmask.nc"
+#define TEST "tst_fillmask"
+#define STR_LEN 255
+#define X_NAME "X"
+#define Y_NAME "Y"
+#define NDIM2 2
+#define VAR_NAME "Who_Stop_the_Rain"
+#define VAR_NAME2 "Up_Around_the_Bend"
+#define VAR_NAME3 "Lookin_Out_My_Back_Door"
+#define NX 60
+#define NY 120
+#define CUSTOM_FILL_FLOAT -999.0f
+
+/* Err is used to keep track of errors within each set of tests,
+ * total_err is the number of errors in the entire test program, which
+ * generally cosists of several sets of tests. */
+static int total_err = 0, err = 0;
+
+int
+main()
+{
+    printf("\n*** Checking Fill Mask filter.\n");
+    printf("*** Checking Fill Mask...");
+    {
+        int ncid;
+        int dimid[NDIM2];
+        int varid, varid2, varid3;
+        size_t chunksizes[NDIM2] = {NX / 2, NY / 2};
+        float data_out[NX][NY];
+        double data_out2[NX][NY];
+        short data_out3[NX][NY];
+        float custom_fill_float = CUSTOM_FILL_FLOAT;
+        int x, y;
+        int fillmask;
+
+        /* Create some data to write. Land covers the first half of
+         * the rows, and the ocean in the other half has a few
+         * islands, so two chunks of each variable are all fill
+         * values. The first variable has a custom fill value, the
+         * others use the default fill value. */
+        for (x = 0; x < NX; x++)
+        {
+            for (y = 0; y < NY; y++)
+            {
+                int land = x < NX / 2 || (x * y) % 9 == 1;
+                data_out[x][y] = land ? CUSTOM_FILL_FLOAT : 273.15f + (x * NY + y) / 7.0f;
+                data_out2[x][y] = land ? NC_FILL_DOUBLE : (x * NY + y) / 3.0;
+                data_out3[x][y] = land ? NC_FILL_SHORT : (short)(x * NY + y);
+            }
+        }
+
+        /* Create file. */
+        if (nc_create(FILE_NAME, NC_NETCDF4, &ncid)) ERR;
+
+        /* Create dims. */
+        if (nc_def_dim(ncid, X_NAME, NX, &dimid[0])) ERR;
+        if (nc_def_dim(ncid, Y_NAME, NY, &dimid[1])) ERR;
+
+        /* Create the variables. */
+        if (nc_def_var(ncid, VAR_NAME, NC_FLOAT, NDIM2, dimid, &varid)) ERR;
+        if (nc_def_var(ncid, VAR_NAME2, NC_DOUBLE, NDIM2, dimid, &varid2)) ERR;
+        if (nc_def_var(ncid, VAR_NAME3, NC_SHORT, NDIM2, dimid, &varid3)) ERR;
+        if (nc_put_att_float(ncid, varid, _FillValue, NC_FLOAT, 1, &custom_fill_float)) ERR;
+        if (nc_def_var_chunking(ncid, varid, NC_CHUNKED, chunksizes)) ERR;
+        if (nc_def_var_chunking(ncid, varid2, NC_CHUNKED, chunksizes)) ERR;
+        if (nc_def_var_chunking(ncid, varid3, NC_CHUNKED, chunksizes)) ERR;
+
+        /* Check setting. */
+        if (nc_inq_var_fillmask(ncid, varid, &fillmask)) ERR;
+        if (fillmask) ERR;
+
+        /* Set up Fill Mask. */
+        if (nc_def_var_fillmask(ncid, varid)) ERR;
+        if (nc_def_var_fillmask(ncid, varid2)) ERR;
+        if (nc_def_var_fillmask(ncid, varid3)) ERR;
+
+        /* Check setting. */
+        if (nc_inq_var_fillmask(ncid, varid, &fillmask)) ERR;
+        if (!fillmask) ERR;
+        fillmask = 0;
+        if (nc_inq_var_fillmask(ncid, varid2, &fillmask)) ERR;
+        if (!fillmask) ERR;
+        if (nc_inq_var_fillmask(ncid, varid3, NULL)) ERR;
+
+        /* Write the data. */
+        if (nc_put_var_float(ncid, varid, (float *)data_out)) ERR;
+        if (nc_put_var_double(ncid, varid2, (double *)data_out2)) ERR;
+        if (nc_put_var_short(ncid, varid3, (short *)data_out3)) ERR;
+
+        /* Close the file. */
+        if (nc_close(ncid)) ERR;
+
+        {
+            float data_in[NX][NY];
+            double data_in2[NX][NY];
+            short data_in3[NX][NY];
+
+            /* Now reopen the file and check. */
+            if (nc_open(FILE_NAME, NC_NETCDF4, &ncid)) ERR;
+
+            /* Check settings. */
+            if (nc_inq_var_fillmask(ncid, varid, &fillmask)) ERR;
+            if (!fillmask) ERR;
+            if (nc_inq_var_fillmask(ncid, varid3, &fillmask)) ERR;
+            if (!fillmask) ERR;
+
+            /* Read the data. */
+            if (nc_get_var_float(ncid, varid, (float *)data_in)) ERR;
+            if (nc_get_var_double(ncid, varid2, (double *)data_in2)) ERR;
+            if (nc_get_var_short(ncid, varid3, (short *)data_in3)) ERR;
+
+            /* Check the data. Fill Mask is lossless. */
+            for (x = 0; x < NX; x++)
+            {
+                for (y = 0; y < NY; y++)
+                {
+                    if (data_in[x][y] != data_out[x][y]) ERR;
+                    if (data_in2[x][y] != data_out2[x][y]) ERR;
+                    if (data_in3[x][y] != data_out3[x][y]) ERR;
+                }
+            }
+
+            /* Close the file. */
+            if (nc_close(ncid)) ERR;
+        }
+    }
+    SUMMARIZE_ERR;
+#define NTYPES 2
+    printf("*** Checking Fill Mask handling of text...");
+    {
+        int ncid;
+        int dimid[NDIM2];
+        int varid;
+        int fillmask;
+        char file_name[STR_LEN + 1];
+        int xtype[NTYPES] = {NC_CHAR, NC_STRING};
+        int t;
+
+        for (t = 0; t < NTYPES; t++)
+        {
+            sprintf(file_name, "%s_fillmask_type_%d.nc", TEST, xtype[t]);
+
+            /* Create file. */
+            if (nc_create(file_name, NC_NETCDF4, &ncid)) ERR;
+            if (nc_def_dim(ncid, X_NAME, NX, &dimid[0])) ERR;
+            if (nc_def_dim(ncid, Y_NAME, NY, &dimid[1])) ERR;
+            if (nc_def_var(ncid, VAR_NAME, xtype[t], NDIM2, dimid, &varid)) ERR;
+
+            /* Fill Mask returns NC_EINVAL because this is text. */
+            if (nc_def_var_fillmask(ncid, varid) != NC_EINVAL) ERR;
+            if (nc_close(ncid)) ERR;
+
+            /* Check file. */
+            {
+                if (nc_open(file_name, NC_NETCDF4, &ncid)) ERR;
+                if (nc_inq_var_fillmask(ncid, varid, &fillmask)) ERR;
+                if (fillmask) ERR;
+                if (nc_close(ncid)) ERR;
+            }
+        }
+    }
+    SUMMARIZE_ERR;
+    FINAL_RESULTS;
+}
@@ -0,0 +1,252 @@
+/* This is part of the CCR package. Copyright 2026.
+
+   Test Float16 storage.
+
+   agent 10/17/26
+*/
+
+#include "config.h"
+#include <math.h> /* Define fabs(), ldexp() */
+#include "ccr.h"
+#include "ccr_test.h"
+#include <hdf5.h>
+#include <H5DSpublic.h>
+#include <netcdf.h>
+
+#define FILE_NAME "tst_float16.nc"
+#define TEST "tst_float16"
+#define STR_LEN 255
+#define X_NAME "X"
+#define Y_NAME "Y"
+#define NDIM2 2
+#define VAR_NAME "Proud_Mary"
+#define VAR_NAME2 "Green_River"
+#define NX 60
+#define NY 120
+
+#define DIM_LEN_5 5
+#define NDIM1 1
+
+/* Err is used to keep track of errors within each set of tests,
+ * total_err is the number of errors in the entire test program, which
+ * generally cosists of several sets of tests. */
+static int total_err = 0, err = 0;
+
+/* This struct allows us to treat float as uint32_t
+ * types. */
+union FU {
+    float f;
+    uint32_t u;
+};
+
+int
+main()
+{
+    printf("\n*** Checking Float16 filter.\n");
+    printf("*** Checking Float16 storage...");
+    {
+        int ncid;
+        int dimid[NDIM2];
+        int varid, varid2, varid3;
+        float data_out[NX][NY];
+        int x, y;
+        int format_in;
+        int float16;
+
+        /* Create some data to write. Integers below 2048 are exact in
+         * half precision, and even integers below 512 in bfloat16. */
+        for (x = 0; x < NX; x++)
+            for (y = 0; y < NY; y++)
+                data_out[x][y] = (x * NY + y) % 256 * 2;
+
+        /* Create file. */
+        if (nc_create(FILE_NAME, NC_NETCDF4, &ncid)) ERR;
+
+        /* Create dims. */
+        if (nc_def_dim(ncid, X_NAME, NX, &dimid[0])) ERR;
+        if (nc_def_dim(ncid, Y_NAME, NY, &dimid[1])) ERR;
+
+        /* Create the variables. */
+        if (nc_def_var(ncid, VAR_NAME, NC_FLOAT, NDIM2, dimid, &varid)) ERR;
+        if (nc_def_var(ncid, VAR_NAME2, NC_FLOAT, NDIM2, dimid, &varid2)) ERR;
+        if (nc_def_var(ncid, "Lodi", NC_DOUBLE, NDIM2, dimid, &varid3)) ERR;
+
+        /* These won't work. */
+        if (nc_def_var_float16(ncid, varid, -1) != NC_EINVAL) ERR;
+        if (nc_def_var_float16(ncid, varid, 2) != NC_EINVAL) ERR;
+        if (nc_def_var_float16(ncid, varid3, FLOAT16_IEEE) != NC_EINVAL) ERR;
+
+        /* Check setting. */
+        if (nc_inq_var_float16(ncid, varid, &float16, &format_in)) ERR;
+        if (float16) ERR;
+
+        /* Set up Float16 storage. */
+        if (nc_def_var_float16(ncid, varid, FLOAT16_IEEE)) ERR;
+        if (nc_def_var_float16(ncid, varid2, FLOAT16_BFLOAT16)) ERR;
+
+        /* Check setting. */
+        if (nc_inq_var_float16(ncid, varid, &float16, &format_in)) ERR;
+        if (!float16 || format_in != FLOAT16_IEEE) ERR;
+        format_in = -1;
+        float16 = 0;
+        if (nc_inq_var_float16(ncid, varid2, NULL, &format_in)) ERR;
+        if (nc_inq_var_float16(ncid, varid2, &float16, NULL)) ERR;
+        if (!float16 || format_in != FLOAT16_BFLOAT16) ERR;
+        if (nc_inq_var_float16(ncid, varid, NULL, NULL)) ERR;
+        if (nc_inq_var_float16(ncid, varid3, &float16, &format_in)) ERR;
+        if (float16) ERR;
+
+        /* Write the data. */
+        if (nc_put_var_float(ncid, varid, (float *)data_out)) ERR;
+        if (nc_put_var_float(ncid, varid2, (float *)data_out)) ERR;
+
+        /* Close the file. */
+        if (nc_close(ncid)) ERR;
+
+        {
+            float data_in[NX][NY];
+            float data_in2[NX][NY];
+
+            /* Now reopen the file and check. */
+            if (nc_open(FILE_NAME, NC_NETCDF4, &ncid)) ERR;
+
+            /* Check settings. */
+            if (nc_inq_var_float16(ncid, varid, &float16, &format_in)) ERR;
+            if (!float16 || format_in != FLOAT16_IEEE) ERR;
+            if (nc_inq_var_float16(ncid, varid2, &float16, &format_in)) ERR;
+            if (!float16 || format_in != FLOAT16_BFLOAT16) ERR;
+
+            /* Read the data. */
+            if (nc_get_var_float(ncid, varid, (float *)data_in)) ERR;
+            if (nc_get_var_float(ncid, varid2, (float *)data_in2)) ERR;
+
+            /* Check the data. These values are exact in both formats. */
+            for (x = 0; x < NX; x++)
+            {
+                for (y = 0; y < NY; y++)
+                {
+                    if (data_in[x][y] != data_out[x][y]) ERR;
+                    if (data_in2[x][y] != data_out[x][y]) ERR;
+                }
+            }
+
+            /* Close the file. */
+            if (nc_close(ncid)) ERR;
+        }
+    }
+    SUMMARIZE_ERR;
+#define NTYPES 10
+    printf("*** Checking Float16 handling of non-floats...");
+    {
+        int ncid;
+        int dimid[NDIM2];
+        int varid;
+        int format_in, float16;
+        char file_name[STR_LEN + 1];
+        int xtype[NTYPES] = {NC_CHAR, NC_SHORT, NC_INT, NC_BYTE, NC_UBYTE, NC_USHORT, NC_UINT, NC_INT64, NC_UINT64, NC_DOUBLE};
+        int t;
+
+        for (t = 0; t < NTYPES; t++)
+        {
+            sprintf(file_name, "%s_float16_type_%d.nc", TEST, xtype[t]);
+
+            /* Create file. */
+            if (nc_create(file_name, NC_NETCDF4, &ncid)) ERR;
+            if (nc_def_dim(ncid, X_NAME, NX, &dimid[0])) ERR;
+            if (nc_def_dim(ncid, Y_NAME, NY, &dimid[1])) ERR;
+            if (nc_def_var(ncid, VAR_NAME, xtype[t], NDIM2, dimid, &varid)) ERR;
+
+            /* Float16 filter returns NC_EINVAL because this is not an
+             * NC_FLOAT. */
+            if (nc_def_var_float16(ncid, varid, FLOAT16_IEEE) != NC_EINVAL) ERR;
+            if (nc_close(ncid)) ERR;
+
+            /* Check file. */
+            {
+                if (nc_open(file_name, NC_NETCDF4, &ncid)) ERR;
+                if (nc_inq_var_float16(ncid, varid, &float16, &format_in)) ERR;
+                if (float16) ERR;
+                if (nc_close(ncid)) ERR;
+            }
+        }
+    }
+    SUMMARIZE_ERR;
+    printf("*** Checking Float16 values with default and custom fill values...");
+    {
+#define CUSTOM_FILL_FLOAT 99.99999
+        int ncid;
+        int dimid;
+        int varid, varid2;
+        float float_data[DIM_LEN_5] = {1.11111111, NC_FILL_FLOAT, 9.99999999, 12345.67, .1234567};
+        float float_data2[DIM_LEN_5] = {1.11111111, CUSTOM_FILL_FLOAT, 9.99999999, 1234567.8, .1234567};
+        float custom_fill_float = CUSTOM_FILL_FLOAT;
+
+        /* Create file. */
+        if (nc_create(FILE_NAME, NC_NETCDF4, &ncid)) ERR;
+
+        /* Create dims. */
+        if (nc_def_dim(ncid, X_NAME, DIM_LEN_5, &dimid)) ERR;
+
+        /* Create the variables. */
+        if (nc_def_var(ncid, VAR_NAME, NC_FLOAT, NDIM1, &dimid, &varid)) ERR;
+        if (nc_def_var(ncid, VAR_NAME2, NC_FLOAT, NDIM1, &dimid, &varid2)) ERR;
+        if (nc_put_att_float(ncid, varid2, _FillValue, NC_FLOAT, 1, &custom_fill_float)) ERR;
+
+        /* Set up Float16 storage. */
+        if (nc_def_var_float16(ncid, varid, FLOAT16_IEEE)) ERR;
+        if (nc_def_var_float16(ncid, varid2, FLOAT16_BFLOAT16)) ERR;
+
+        /* Write the data. */
+        if (nc_put_var_float(ncid, varid, float_data)) ERR;
+        if (nc_put_var_float(ncid, varid2, float_data2)) ERR;
+
+        /* Close the file. */
+        if (nc_close(ncid)) ERR;
+
+        {
+            float float_data_in[DIM_LEN_5];
+            float float_data_in2[DIM_LEN_5];
+            union FU fin;
+            union FU xpect[DIM_LEN_5];
+            union FU xpect2[DIM_LEN_5];
+            int x;
+
+            /* Now reopen the file and check. */
+            if (nc_open(FILE_NAME, NC_NETCDF4, &ncid)) ERR;
+
+            /* Read the data. */
+            if (nc_get_var_float(ncid, varid, float_data_in)) ERR;
+            if (nc_get_var_float(ncid, varid2, float_data_in2)) ERR;
+
+            /* Half precision: 10 explicit mantissa bits, fill value
+             * exact although it overflows half precision. */
+            xpect[0].u = 0x3f8e4000;
+            xpect[1].u = 0x7cf00000;
+            xpect[2].u = 0x41200000;
+            xpect[3].u = 0x4640e000;
+            xpect[4].u = 0x3dfce000;
+            /* bfloat16: 7 explicit mantissa bits, custom fill value
+             * exact although it needs all 23. */
+            xpect2[0].u = 0x3f8e0000;
+            xpect2[1].u = 0x42c7ffff;
+            xpect2[2].u = 0x41200000;
+            xpect2[3].u = 0x49970000;
+            xpect2[4].u = 0x3dfd0000;
+
+            for (x = 0; x < DIM_LEN_5; x++)
+            {
+                fin.f = float_data_in[x];
+                if (fin.u != xpect[x].u)
+                    ERR;
+                fin.f = float_data_in2[x];
+                if (fin.u != xpect2[x].u)
+                    ERR;
+            }
+
+            /* Close the file. */
+            if (nc_close(ncid)) ERR;
+        }
+    }
+    SUMMARIZE_ERR;
+    FINAL_RESULTS;
+}
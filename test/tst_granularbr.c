@@ -735,5 +735,113 @@ main()
         }
     }
     SUMMARIZE_ERR;
+    printf("*** Checking Granular BitRound quantization to an absolute error...");
+    {
+#define ABS_ERR 0.01
+#define ABS_ERR2 1.0e-6
+        int ncid;
+        int dimid[NDIM2];
+        int varid, varid2, varid3;
+        float data_out[NX][NY];
+        double data_out2[NX][NY];
+        int x, y;
+        double abs_err_in;
+        int granularbr_abs, granularbr, nsd_in;
+
+        /* Create some data to write, with magnitudes from 1e-5 to 1e3. */
+        for (x = 0; x < NX; x++)
+        {
+            for (y = 0; y < NY; y++)
+            {
+                data_out[x][y] = powf(10.0f, -5.0f + (x * NY + y) * 8.0f / (NX * NY));
+                data_out2[x][y] = (y % 2 ? -1.0 : 1.0) * pow(10.0, -5.0 + (x * NY + y) * 8.0 / (NX * NY));
+            }
+        }
+
+        /* Create file. */
+        if (nc_create(FILE_NAME, NC_NETCDF4, &ncid)) ERR;
+
+        /* Create dims. */
+        if (nc_def_dim(ncid, X_NAME, NX, &dimid[0])) ERR;
+        if (nc_def_dim(ncid, Y_NAME, NY, &dimid[1])) ERR;
+
+        /* Create the variables. */
+        if (nc_def_var(ncid, VAR_NAME, NC_FLOAT, NDIM2, dimid, &varid)) ERR;
+        if (nc_def_var(ncid, VAR_NAME2, NC_DOUBLE, NDIM2, dimid, &varid2)) ERR;
+        if (nc_def_var(ncid, "Lodi", NC_DOUBLE, NDIM2, dimid, &varid3)) ERR;
+
+        /* These won't work. */
+        if (nc_def_var_granularbr_abs(ncid, varid, 0.0) != NC_EINVAL) ERR;
+        if (nc_def_var_granularbr_abs(ncid, varid, -ABS_ERR) != NC_EINVAL) ERR;
+        if (nc_def_var_granularbr_abs(ncid, varid, NAN) != NC_EINVAL) ERR;
+        if (nc_def_var_granularbr_abs(ncid, varid, INFINITY) != NC_EINVAL) ERR;
+
+        /* Check setting. */
+        if (nc_inq_var_granularbr_abs(ncid, varid, &granularbr_abs, &abs_err_in)) ERR;
+        if (granularbr_abs) ERR;
+
+        /* Set up quantization. NSD mode is not absolute error mode. */
+        if (nc_def_var_granularbr_abs(ncid, varid, ABS_ERR)) ERR;
+        if (nc_def_var_granularbr_abs(ncid, varid2, ABS_ERR2)) ERR;
+        if (nc_def_var_granularbr(ncid, varid3, 3)) ERR;
+
+        /* Check setting. */
+        if (nc_inq_var_granularbr_abs(ncid, varid, &granularbr_abs, &abs_err_in)) ERR;
+        if (!granularbr_abs || abs_err_in != ABS_ERR) ERR;
+        abs_err_in = 0.0;
+        granularbr_abs = 0;
+        if (nc_inq_var_granularbr_abs(ncid, varid2, NULL, &abs_err_in)) ERR;
+        if (nc_inq_var_granularbr_abs(ncid, varid2, &granularbr_abs, NULL)) ERR;
+        if (!granularbr_abs || abs_err_in != ABS_ERR2) ERR;
+        if (nc_inq_var_granularbr_abs(ncid, varid, NULL, NULL)) ERR;
+        if (nc_inq_var_granularbr_abs(ncid, varid3, &granularbr_abs, &abs_err_in)) ERR;
+        if (granularbr_abs) ERR;
+
+        /* Granular BitRound is in use, with NSD of 0. */
+        if (nc_inq_var_granularbr(ncid, varid, &granularbr, &nsd_in)) ERR;
+        if (!granularbr || nsd_in != 0) ERR;
+
+        /* Write the data. */
+        if (nc_put_var_float(ncid, varid, (float *)data_out)) ERR;
+        if (nc_put_var_double(ncid, varid2, (double *)data_out2)) ERR;
+
+        /* Close the file. */
+        if (nc_close(ncid)) ERR;
+
+        {
+            float data_in[NX][NY];
+            double data_in2[NX][NY];
+
+            /* Now reopen the file and check. */
+            if (nc_open(FILE_NAME, NC_NETCDF4, &ncid)) ERR;
+
+            /* Check settings. */
+            if (nc_inq_var_granularbr_abs(ncid, varid, &granularbr_abs, &abs_err_in)) ERR;
+            if (!granularbr_abs || abs_err_in != ABS_ERR) ERR;
+            if (nc_inq_var_granularbr_abs(ncid, varid2, &granularbr_abs, &abs_err_in)) ERR;
+            if (!granularbr_abs || abs_err_in != ABS_ERR2) ERR;
+
+            /* Read the data. */
+            if (nc_get_var_float(ncid, varid, (float *)data_in)) ERR;
+            if (nc_get_var_double(ncid, varid2, (double *)data_in2)) ERR;
+
+            /* Check the data. Every value is within the absolute error. */
+            for (x = 0; x < NX; x++)
+            {
+                for (y = 0; y < NY; y++)
+                {
+                    if (fabs(data_in[x][y] - data_out[x][y]) > ABS_ERR) ERR;
+                    if (fabs(data_in2[x][y] - data_out2[x][y]) > ABS_ERR2) ERR;
+                }
+            }
+
+            /* Values much smaller than the error keep no mantissa bits. */
+            if (data_in[0][0] != ldexpf(1.0f, ilogbf(data_out[0][0]))) ERR;
+
+            /* Close the file. */
+            if (nc_close(ncid)) ERR;
+        }
+    }
+    SUMMARIZE_ERR;
     FINAL_RESULTS;
 }
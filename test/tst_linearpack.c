@@ -0,0 +1,241 @@
+/* This is part of the CCR package. Copyright 2026.
+
+   Test Linear Packing.
+
+   agent 10/17/26
+*/
+
+#include "config.h"
+#include <math.h> /* Define fabs() */
+#include "ccr.h"
+#include "ccr_test.h"
+#include <hdf5.h>
+#include <H5DSpublic.h>
+#include <netcdf.h>
+
+#define FILE_NAME "tst_linearpack.nc"
+#define TEST "tst_linearpack"
+#define STR_LEN 255
+#define X_NAME "X"
+#define Y_NAME "Y"
+#define NDIM2 2
+#define VAR_NAME "Proud_Mary"
+#define VAR_NAME2 "Green_River"
+#define NX 60
+#define NY 120
+#define MAX_ABS_ERR 0.01
+#define MAX_ABS_ERR2 1.0e-6
+
+#define DIM_LEN_5 5
+#define NDIM1 1
+
+/* Err is used to keep track of errors within each set of tests,
+ * total_err is the number of errors in the entire test program, which
+ * generally cosists of several sets of tests. */
+static int total_err = 0, err = 0;
+
+int
+main()
+{
+    printf("\n*** Checking Linear Packing filter.\n");
+    printf("*** Checking Linear Packing...");
+    {
+        int ncid;
+        int dimid[NDIM2];
+        int varid, varid2, varid3;
+        float data_out[NX][NY];
+        double data_out2[NX][NY];
+        int x, y;
+        double max_abs_err_in;
+        int linearpack;
+
+        /* Create some data to write. */
+        for (x = 0; x < NX; x++)
+        {
+            for (y = 0; y < NY; y++)
+            {
+                data_out[x][y] = 273.15f + (x * NY + y) / 7.0f;
+                data_out2[x][y] = (x * NY + y) / 3.0;
+            }
+        }
+
+        /* Create file. */
+        if (nc_create(FILE_NAME, NC_NETCDF4, &ncid)) ERR;
+
+        /* Create dims. */
+        if (nc_def_dim(ncid, X_NAME, NX, &dimid[0])) ERR;
+        if (nc_def_dim(ncid, Y_NAME, NY, &dimid[1])) ERR;
+
+        /* Create the variables. */
+        if (nc_def_var(ncid, VAR_NAME, NC_FLOAT, NDIM2, dimid, &varid)) ERR;
+        if (nc_def_var(ncid, VAR_NAME2, NC_DOUBLE, NDIM2, dimid, &varid2)) ERR;
+        if (nc_def_var(ncid, "Lodi", NC_DOUBLE, NDIM2, dimid, &varid3)) ERR;
+
+        /* These won't work. */
+        if (nc_def_var_linearpack(ncid, varid, 0.0) != NC_EINVAL) ERR;
+        if (nc_def_var_linearpack(ncid, varid, -MAX_ABS_ERR) != NC_EINVAL) ERR;
+        if (nc_def_var_linearpack(ncid, varid, NAN) != NC_EINVAL) ERR;
+        if (nc_def_var_linearpack(ncid, varid, INFINITY) != NC_EINVAL) ERR;
+
+        /* Check setting. */
+        if (nc_inq_var_linearpack(ncid, varid, &linearpack, &max_abs_err_in)) ERR;
+        if (linearpack) ERR;
+
+        /* Set up Linear Packing. */
+        if (nc_def_var_linearpack(ncid, varid, MAX_ABS_ERR)) ERR;
+        if (nc_def_var_linearpack(ncid, varid2, MAX_ABS_ERR2)) ERR;
+
+        /* Check setting. */
+        if (nc_inq_var_linearpack(ncid, varid, &linearpack, &max_abs_err_in)) ERR;
+        if (!linearpack || max_abs_err_in != MAX_ABS_ERR) ERR;
+        max_abs_err_in = 0.0;
+        linearpack = 0;
+        if (nc_inq_var_linearpack(ncid, varid2, NULL, &max_abs_err_in)) ERR;
+        if (nc_inq_var_linearpack(ncid, varid2, &linearpack, NULL)) ERR;
+        if (!linearpack || max_abs_err_in != MAX_ABS_ERR2) ERR;
+        if (nc_inq_var_linearpack(ncid, varid, NULL, NULL)) ERR;
+        if (nc_inq_var_linearpack(ncid, varid3, &linearpack, &max_abs_err_in)) ERR;
+        if (linearpack) ERR;
+
+        /* Write the data. */
+        if (nc_put_var_float(ncid, varid, (float *)data_out)) ERR;
+        if (nc_put_var_double(ncid, varid2, (double *)data_out2)) ERR;
+
+        /* Close the file. */
+        if (nc_close(ncid)) ERR;
+
+        {
+            float data_in[NX][NY];
+            double data_in2[NX][NY];
+
+            /* Now reopen the file and check. */
+            if (nc_open(FILE_NAME, NC_NETCDF4, &ncid)) ERR;
+
+            /* Check settings. */
+            if (nc_inq_var_linearpack(ncid, varid, &linearpack, &max_abs_err_in)) ERR;
+            if (!linearpack || max_abs_err_in != MAX_ABS_ERR) ERR;
+            if (nc_inq_var_linearpack(ncid, varid2, &linearpack, &max_abs_err_in)) ERR;
+            if (!linearpack || max_abs_err_in != MAX_ABS_ERR2) ERR;
+
+            /* Read the data. */
+            if (nc_get_var_float(ncid, varid, (float *)data_in)) ERR;
+            if (nc_get_var_double(ncid, varid2, (double *)data_in2)) ERR;
+
+            /* Check the data. Unpacked values may also round by half
+             * an ULP. */
+            for (x = 0; x < NX; x++)
+            {
+                for (y = 0; y < NY; y++)
+                {
+                    if (fabs(data_in[x][y] - data_out[x][y]) > MAX_ABS_ERR + ldexp(fabs(data_out[x][y]), -24)) ERR;
+                    if (fabs(data_in2[x][y] - data_out2[x][y]) > MAX_ABS_ERR2 + ldexp(fabs(data_out2[x][y]), -52)) ERR;
+                }
+            }
+
+            /* Close the file. */
+            if (nc_close(ncid)) ERR;
+        }
+    }
+    SUMMARIZE_ERR;
+#define NTYPES 9
+    printf("*** Checking Linear Packing handling of non-floats...");
+    {
+        int ncid;
+        int dimid[NDIM2];
+        int varid;
+        int linearpack;
+        double max_abs_err_in;
+        char file_name[STR_LEN + 1];
+        int xtype[NTYPES] = {NC_CHAR, NC_SHORT, NC_INT, NC_BYTE, NC_UBYTE, NC_USHORT, NC_UINT, NC_INT64, NC_UINT64};
+        int t;
+
+        for (t = 0; t < NTYPES; t++)
+        {
+            sprintf(file_name, "%s_linearpack_type_%d.nc", TEST, xtype[t]);
+
+            /* Create file. */
+            if (nc_create(file_name, NC_NETCDF4, &ncid)) ERR;
+            if (nc_def_dim(ncid, X_NAME, NX, &dimid[0])) ERR;
+            if (nc_def_dim(ncid, Y_NAME, NY, &dimid[1])) ERR;
+            if (nc_def_var(ncid, VAR_NAME, xtype[t], NDIM2, dimid, &varid)) ERR;
+
+            /* Linear Packing returns NC_EINVAL because this is not an
+             * NC_FLOAT or NC_DOUBLE. */
+            if (nc_def_var_linearpack(ncid, varid, MAX_ABS_ERR) != NC_EINVAL) ERR;
+            if (nc_close(ncid)) ERR;
+
+            /* Check file. */
+            {
+                if (nc_open(file_name, NC_NETCDF4, &ncid)) ERR;
+                if (nc_inq_var_linearpack(ncid, varid, &linearpack, &max_abs_err_in)) ERR;
+                if (linearpack) ERR;
+                if (nc_close(ncid)) ERR;
+            }
+        }
+    }
+    SUMMARIZE_ERR;
+    printf("*** Checking Linear Packing values with default and custom fill values...");
+    {
+#define CUSTOM_FILL_FLOAT 99.99999
+        int ncid;
+        int dimid;
+        int varid, varid2;
+        float float_data[DIM_LEN_5] = {1.11111111, NC_FILL_FLOAT, 9.99999999, 12345.67, .1234567};
+        float float_data2[DIM_LEN_5] = {1.11111111, CUSTOM_FILL_FLOAT, 9.99999999, 1234.5678, .1234567};
+        float custom_fill_float = CUSTOM_FILL_FLOAT;
+
+        /* Create file. */
+        if (nc_create(FILE_NAME, NC_NETCDF4, &ncid)) ERR;
+
+        /* Create dims. */
+        if (nc_def_dim(ncid, X_NAME, DIM_LEN_5, &dimid)) ERR;
+
+        /* Create the variables. */
+        if (nc_def_var(ncid, VAR_NAME, NC_FLOAT, NDIM1, &dimid, &varid)) ERR;
+        if (nc_def_var(ncid, VAR_NAME2, NC_FLOAT, NDIM1, &dimid, &varid2)) ERR;
+        if (nc_put_att_float(ncid, varid2, _FillValue, NC_FLOAT, 1, &custom_fill_float)) ERR;
+
+        /* Set up Linear Packing. */
+        if (nc_def_var_linearpack(ncid, varid, MAX_ABS_ERR)) ERR;
+        if (nc_def_var_linearpack(ncid, varid2, MAX_ABS_ERR)) ERR;
+
+        /* Write the data. */
+        if (nc_put_var_float(ncid, varid, float_data)) ERR;
+        if (nc_put_var_float(ncid, varid2, float_data2)) ERR;
+
+        /* Close the file. */
+        if (nc_close(ncid)) ERR;
+
+        {
+            float float_data_in[DIM_LEN_5];
+            float float_data_in2[DIM_LEN_5];
+            int x;
+
+            /* Now reopen the file and check. */
+            if (nc_open(FILE_NAME, NC_NETCDF4, &ncid)) ERR;
+
+            /* Read the data. */
+            if (nc_get_var_float(ncid, varid, float_data_in)) ERR;
+            if (nc_get_var_float(ncid, varid2, float_data_in2)) ERR;
+
+            /* Fill values are exact, other values are packed, and
+             * fill values do not widen the packed range. */
+            for (x = 0; x < DIM_LEN_5; x++)
+            {
+                if (x == 1)
+                {
+                    if (float_data_in[x] != NC_FILL_FLOAT) ERR;
+                    if (float_data_in2[x] != custom_fill_float) ERR;
+                    continue;
+                }
+                if (fabs(float_data_in[x] - float_data[x]) > MAX_ABS_ERR + ldexp(fabs(float_data[x]), -24)) ERR;
+                if (fabs(float_data_in2[x] - float_data2[x]) > MAX_ABS_ERR + ldexp(fabs(float_data2[x]), -24)) ERR;
+            }
+
+            /* Close the file. */
+            if (nc_close(ncid)) ERR;
+        }
+    }
+    SUMMARIZE_ERR;
+    FINAL_RESULTS;
+}
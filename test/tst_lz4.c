@@ -33,6 +33,9 @@
 
 #define NX_BIG 100
 #define NY_BIG 100
+#define BLOCK_SIZE 4096
+#define ACCELERATION 4
+#define HC_LEVEL 9
 
 /* Err is used to keep track of errors within each set of tests,
  * total_err is the number of errors in the entire test program, which
@@ -50,7 +53,7 @@ main()
         int varid;
         int data_out[NX][NY];
         int x, y;
-        int level_in, lz4;
+        int block_size_in, acceleration_in, lz4;
 
         /* Create some data to write. */
         for (x = 0; x < NX; x++)
@@ -68,26 +71,30 @@ main()
         if (nc_def_var(ncid, VAR_NAME, NC_INT, NDIM2, dimid, &varid)) ERR;
 
         /* These won't work. */
-        if (nc_def_var_lz4(ncid, varid, -9) != NC_EINVAL) ERR;
-        if (nc_def_var_lz4(ncid, varid, 0) != NC_EINVAL) ERR;
-        if (nc_def_var_lz4(ncid, varid, 10) != NC_EINVAL) ERR;
+        if (nc_def_var_lz4(ncid, varid, -1, 1) != NC_EINVAL) ERR;
+        if (nc_def_var_lz4(ncid, varid, 0, 0) != NC_EINVAL) ERR;
+        if (nc_def_var_lz4(ncid, varid, 0, -3) != NC_EINVAL) ERR;
 
         /* Check setting. */
-        if (nc_inq_var_lz4(ncid, varid, &lz4, &level_in)) ERR;
+        if (nc_inq_var_lz4(ncid, varid, &lz4, &block_size_in, &acceleration_in)) ERR;
         if (lz4) ERR;
 
         /* Set up compression. */
-        if (nc_def_var_lz4(ncid, varid, 3)) ERR;
+        if (nc_def_var_lz4(ncid, varid, BLOCK_SIZE, ACCELERATION)) ERR;
 
         /* Check setting. */
-        if (nc_inq_var_lz4(ncid, varid, &lz4, &level_in)) ERR;
-        if (!lz4 || level_in != 3) ERR;
-        level_in = 0;
-        lz4 = 1;
-        if (nc_inq_var_lz4(ncid, varid, NULL, &level_in)) ERR;
-        if (nc_inq_var_lz4(ncid, varid, &lz4, NULL)) ERR;
-        if (!lz4 || level_in != 3) ERR;
-        if (nc_inq_var_lz4(ncid, varid, NULL, NULL)) ERR;
+        if (nc_inq_var_lz4(ncid, varid, &lz4, &block_size_in, &acceleration_in)) ERR;
+        if (!lz4 || block_size_in != BLOCK_SIZE || acceleration_in != ACCELERATION) ERR;
+        block_size_in = 0;
+        lz4 = 0;
+        if (nc_inq_var_lz4(ncid, varid, NULL, &block_size_in, NULL)) ERR;
+        if (nc_inq_var_lz4(ncid, varid, &lz4, NULL, NULL)) ERR;
+        if (!lz4 || block_size_in != BLOCK_SIZE) ERR;
+        if (nc_inq_var_lz4(ncid, varid, NULL, NULL, NULL)) ERR;
+
+        /* This is not LZ4HC. */
+        if (nc_inq_var_lz4hc(ncid, varid, &lz4, NULL, NULL)) ERR;
+        if (lz4) ERR;
 
         /* Write the data. */
         if (nc_put_var(ncid, varid, data_out)) ERR;
@@ -102,8 +109,8 @@ main()
             if (nc_open(FILE_NAME, NC_NETCDF4, &ncid)) ERR;
 
             /* Check setting. */
-            if (nc_inq_var_lz4(ncid, varid, &lz4, &level_in)) ERR;
-            if (!lz4 || level_in != 3) ERR;
+            if (nc_inq_var_lz4(ncid, varid, &lz4, &block_size_in, &acceleration_in)) ERR;
+            if (!lz4 || block_size_in != BLOCK_SIZE || acceleration_in != ACCELERATION) ERR;
 
             /* Read the data. */
             if (nc_get_var(ncid, varid, data_in)) ERR;
@@ -118,6 +125,59 @@ main()
         }
     }
     SUMMARIZE_ERR;
+    printf("*** Checking LZ4HC compression...");
+    {
+        int ncid;
+        int dimid[NDIM2];
+        int varid;
+        int data_out[NX][NY];
+        int x, y;
+        int block_size_in, level_in, lz4hc, lz4;
+
+        /* Create some data to write. */
+        for (x = 0; x < NX; x++)
+            for (y = 0; y < NY; y++)
+                data_out[x][y] = x * NY + y;
+
+        /* Create file. */
+        if (nc_create(FILE_NAME, NC_NETCDF4, &ncid)) ERR;
+        if (nc_def_dim(ncid, X_NAME, NX, &dimid[0])) ERR;
+        if (nc_def_dim(ncid, Y_NAME, NY, &dimid[1])) ERR;
+        if (nc_def_var(ncid, VAR_NAME, NC_INT, NDIM2, dimid, &varid)) ERR;
+
+        /* These won't work. */
+        if (nc_def_var_lz4hc(ncid, varid, -1, HC_LEVEL) != NC_EINVAL) ERR;
+        if (nc_def_var_lz4hc(ncid, varid, 0, 0) != NC_EINVAL) ERR;
+        if (nc_def_var_lz4hc(ncid, varid, 0, LZ4HC_MAX_LEVEL + 1) != NC_EINVAL) ERR;
+
+        /* Set up compression. */
+        if (nc_def_var_lz4hc(ncid, varid, 0, HC_LEVEL)) ERR;
+
+        /* Check setting. LZ4HC is also LZ4. */
+        if (nc_inq_var_lz4hc(ncid, varid, &lz4hc, &block_size_in, &level_in)) ERR;
+        if (!lz4hc || block_size_in || level_in != HC_LEVEL) ERR;
+        if (nc_inq_var_lz4(ncid, varid, &lz4, NULL, NULL)) ERR;
+        if (!lz4) ERR;
+
+        /* Write the data. */
+        if (nc_put_var(ncid, varid, data_out)) ERR;
+        if (nc_close(ncid)) ERR;
+
+        {
+            int data_in[NX][NY];
+
+            /* Now reopen the file and check. */
+            if (nc_open(FILE_NAME, NC_NETCDF4, &ncid)) ERR;
+            if (nc_inq_var_lz4hc(ncid, varid, &lz4hc, &block_size_in, &level_in)) ERR;
+            if (!lz4hc || block_size_in || level_in != HC_LEVEL) ERR;
+            if (nc_get_var(ncid, varid, data_in)) ERR;
+            for (x = 0; x < NX; x++)
+               for (y = 0; y < NY; y++)
+                  if (data_in[x][y] != data_out[x][y]) ERR;
+            if (nc_close(ncid)) ERR;
+        }
+    }
+    SUMMARIZE_ERR;
     printf("*** Checking LZ4 size of compression...");
     {
         int ncid;
@@ -126,7 +186,7 @@ main()
         int *data_out;
         int *data_in;
         int x, y, f;
-        int level_in, lz4;
+        int block_size_in, acceleration_in, lz4;
 
         if (!(data_out = malloc(NX_BIG * NY_BIG * sizeof(int)))) ERR;
         if (!(data_in = malloc(NX_BIG * NY_BIG * sizeof(int)))) ERR;
@@ -152,17 +212,17 @@ main()
 	      ;
             if (nc_def_var(ncid, VAR_NAME, NC_INT, NDIM2, dimid, &varid)) ERR;
             if (f)
-                if (nc_def_var_lz4(ncid, varid, 3)) ERR;
+                if (nc_def_var_lz4(ncid, varid, 0, 1)) ERR;
             if (nc_put_var(ncid, varid, data_out)) ERR;
             if (nc_close(ncid)) ERR;
 
             /* Check file. */
             {
                 if (nc_open(file_name, NC_NETCDF4, &ncid)) ERR;
-                if (nc_inq_var_lz4(ncid, varid, &lz4, &level_in)) ERR;
+                if (nc_inq_var_lz4(ncid, varid, &lz4, &block_size_in, &acceleration_in)) ERR;
                 if (f)
                 {
-                    if (!lz4 || level_in != 3) ERR;
+                    if (!lz4 || block_size_in || acceleration_in != 1) ERR;
                 }
                 else
                 {
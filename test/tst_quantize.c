@@ -0,0 +1,250 @@
+/* This is part of the CCR package. Copyright 2026.
+
+   Test in-memory quantization with ccr_quantize().
+
+   agent 10/17/26
+*/
+
+#include "config.h"
+#include <math.h> /* Define fabs(), ldexp(), pow() */
+#include <string.h> /* Define memcmp() */
+#include "ccr.h"
+#include "ccr_test.h"
+#include <hdf5.h>
+#include <H5DSpublic.h>
+#include <netcdf.h>
+#ifdef HAVE_PTHREAD_H
+#include <pthread.h>
+#endif
+
+#define FILE_NAME "tst_quantize.nc"
+#define TEST "tst_quantize"
+#define X_NAME "X"
+#define NDIM1 1
+#define VAR_NAME "Have_You_Ever_Seen_the_Rain"
+#define VAR_NAME2 "Hey_Tonight"
+#define NX 1000
+#define NSD 3
+#define NSB 10
+#define CUSTOM_FILL_FLOAT -999.0f
+#define NMETHOD 3
+#define NTHR 8
+
+/* Err is used to keep track of errors within each set of tests,
+ * total_err is the number of errors in the entire test program, which
+ * generally cosists of several sets of tests. */
+static int total_err = 0, err = 0;
+
+/* Turn on the filter that matches a ccr_quantize() method. */
+static int
+def_var_quantize(int ncid, int varid, int method, int nsd)
+{
+    switch (method)
+    {
+    case CCR_QUANTIZE_BITGROOM:
+        return nc_def_var_bitgroom(ncid, varid, nsd);
+    case CCR_QUANTIZE_GRANULARBR:
+        return nc_def_var_granularbr(ncid, varid, nsd);
+    case CCR_QUANTIZE_BITROUND:
+        return nc_def_var_bitround(ncid, varid, nsd);
+    }
+    return NC_EINVAL;
+}
+
+#ifdef HAVE_PTHREAD_H
+/* What each thread of the threaded test quantizes, and its results. */
+typedef struct
+{
+    const float *data;
+    const double *data2;
+    int first; /* Method this thread quantizes with first */
+    float buf[NMETHOD][NX];
+    double buf2[NMETHOD][NX];
+    int nerr;
+} thr_arg_t;
+
+/* Quantize with every method, starting with a different method in
+ * different threads, so first calls of all methods race. */
+static void *
+quantize_thr(void *arg)
+{
+    thr_arg_t *ta = arg;
+    int method[NMETHOD] = {CCR_QUANTIZE_BITGROOM, CCR_QUANTIZE_GRANULARBR, CCR_QUANTIZE_BITROUND};
+    float custom_fill_float = CUSTOM_FILL_FLOAT;
+    int i;
+
+    for (i = 0; i < NMETHOD; i++)
+    {
+        int m = (ta->first + i) % NMETHOD;
+        int nsd = method[m] == CCR_QUANTIZE_BITROUND ? NSB : NSD;
+
+        memcpy(ta->buf[m], ta->data, sizeof(ta->buf[m]));
+        memcpy(ta->buf2[m], ta->data2, sizeof(ta->buf2[m]));
+        if (ccr_quantize(method[m], nsd, NC_FLOAT, ta->buf[m], NX, &custom_fill_float))
+            ta->nerr++;
+        if (ccr_quantize(method[m], nsd, NC_DOUBLE, ta->buf2[m], NX, NULL))
+            ta->nerr++;
+    }
+    return NULL;
+}
+#endif /* HAVE_PTHREAD_H */
+
+int
+main()
+{
+    float data_out[NX];
+    double data_out2[NX];
+    int x;
+
+    /* Create some data, with a few fill values. */
+    for (x = 0; x < NX; x++)
+    {
+        data_out[x] = x % 17 ? 273.15f + x / 7.0f : CUSTOM_FILL_FLOAT;
+        data_out2[x] = x % 13 ? 1.0e5 / (x + 1) : NC_FILL_DOUBLE;
+    }
+
+    printf("\n*** Checking in-memory quantization.\n");
+    printf("*** Checking ccr_quantize() rejects invalid arguments...");
+    {
+        float buf[NX];
+        int buf_int[NX];
+
+        memcpy(buf, data_out, sizeof(buf));
+        if (ccr_quantize(0, NSD, NC_FLOAT, buf, NX, NULL) != NC_EINVAL) ERR;
+        if (ccr_quantize(CCR_QUANTIZE_BITGROOM, 0, NC_FLOAT, buf, NX, NULL) != NC_EINVAL) ERR;
+        if (ccr_quantize(CCR_QUANTIZE_BITGROOM, 8, NC_FLOAT, buf, NX, NULL) != NC_EINVAL) ERR;
+        if (ccr_quantize(CCR_QUANTIZE_GRANULARBR, 16, NC_DOUBLE, data_out2, NX, NULL) != NC_EINVAL) ERR;
+        if (ccr_quantize(CCR_QUANTIZE_BITROUND, 24, NC_FLOAT, buf, NX, NULL) != NC_EINVAL) ERR;
+        if (ccr_quantize(CCR_QUANTIZE_BITROUND, NSB, NC_INT, buf_int, NX, NULL) != NC_EINVAL) ERR;
+        if (ccr_quantize(CCR_QUANTIZE_BITROUND, NSB, NC_FLOAT, NULL, NX, NULL) != NC_EINVAL) ERR;
+        if (ccr_quantize(CCR_QUANTIZE_BITROUND, NSB, NC_FLOAT, NULL, 0, NULL)) ERR;
+
+        /* Rejected calls leave the buffer alone. */
+        if (memcmp(buf, data_out, sizeof(buf))) ERR;
+    }
+    SUMMARIZE_ERR;
+#ifdef HAVE_PTHREAD_H
+    /* This must be the first quantization in the process, so that
+     * threads race to set up the kernels. */
+    printf("*** Checking ccr_quantize() from many threads at once...");
+    {
+        int method[NMETHOD] = {CCR_QUANTIZE_BITGROOM, CCR_QUANTIZE_GRANULARBR, CCR_QUANTIZE_BITROUND};
+        float custom_fill_float = CUSTOM_FILL_FLOAT;
+        pthread_t thr[NTHR];
+        thr_arg_t *thr_arg;
+        int m, t;
+
+        if (!(thr_arg = calloc(NTHR, sizeof(thr_arg_t)))) ERR;
+        for (t = 0; t < NTHR; t++)
+        {
+            thr_arg[t].data = data_out;
+            thr_arg[t].data2 = data_out2;
+            thr_arg[t].first = t % NMETHOD;
+            if (pthread_create(&thr[t], NULL, quantize_thr, &thr_arg[t])) ERR;
+        }
+        for (t = 0; t < NTHR; t++)
+            if (pthread_join(thr[t], NULL)) ERR;
+
+        /* Every thread got what one thread alone gets. */
+        for (m = 0; m < NMETHOD; m++)
+        {
+            int nsd = method[m] == CCR_QUANTIZE_BITROUND ? NSB : NSD;
+            float buf[NX];
+            double buf2[NX];
+
+            memcpy(buf, data_out, sizeof(buf));
+            memcpy(buf2, data_out2, sizeof(buf2));
+            if (ccr_quantize(method[m], nsd, NC_FLOAT, buf, NX, &custom_fill_float)) ERR;
+            if (ccr_quantize(method[m], nsd, NC_DOUBLE, buf2, NX, NULL)) ERR;
+            for (t = 0; t < NTHR; t++)
+            {
+                if (thr_arg[t].nerr) ERR;
+                if (memcmp(thr_arg[t].buf[m], buf, sizeof(buf))) ERR;
+                if (memcmp(thr_arg[t].buf2[m], buf2, sizeof(buf2))) ERR;
+            }
+        }
+        free(thr_arg);
+    }
+    SUMMARIZE_ERR;
+#endif /* HAVE_PTHREAD_H */
+    printf("*** Checking ccr_quantize() keeps precision and fill values...");
+    {
+        int method[NMETHOD] = {CCR_QUANTIZE_BITGROOM, CCR_QUANTIZE_GRANULARBR, CCR_QUANTIZE_BITROUND};
+        float custom_fill_float = CUSTOM_FILL_FLOAT;
+        int m;
+
+        for (m = 0; m < NMETHOD; m++)
+        {
+            int nsd = method[m] == CCR_QUANTIZE_BITROUND ? NSB : NSD;
+            /* Half a unit in the last retained place, relative. */
+            double rel_err = method[m] == CCR_QUANTIZE_BITROUND ? ldexp(1.0, -NSB - 1) : 0.5 * pow(10.0, 1 - NSD);
+            float buf[NX];
+            double buf2[NX];
+
+            memcpy(buf, data_out, sizeof(buf));
+            memcpy(buf2, data_out2, sizeof(buf2));
+            if (ccr_quantize(method[m], nsd, NC_FLOAT, buf, NX, &custom_fill_float)) ERR;
+            if (ccr_quantize(method[m], nsd, NC_DOUBLE, buf2, NX, NULL)) ERR;
+
+            /* Something was quantized, and nothing moved too far. */
+            if (!memcmp(buf, data_out, sizeof(buf))) ERR;
+            if (!memcmp(buf2, data_out2, sizeof(buf2))) ERR;
+            for (x = 0; x < NX; x++)
+            {
+                if (data_out[x] == CUSTOM_FILL_FLOAT)
+                {
+                    if (buf[x] != CUSTOM_FILL_FLOAT) ERR;
+                }
+                else if (fabs(buf[x] - data_out[x]) > rel_err * fabs(data_out[x])) ERR;
+                if (data_out2[x] == NC_FILL_DOUBLE)
+                {
+                    if (buf2[x] != NC_FILL_DOUBLE) ERR;
+                }
+                else if (fabs(buf2[x] - data_out2[x]) > rel_err * fabs(data_out2[x])) ERR;
+            }
+        }
+    }
+    SUMMARIZE_ERR;
+    printf("*** Checking ccr_quantize() matches the filters...");
+    {
+        int method[NMETHOD] = {CCR_QUANTIZE_BITGROOM, CCR_QUANTIZE_GRANULARBR, CCR_QUANTIZE_BITROUND};
+        float custom_fill_float = CUSTOM_FILL_FLOAT;
+        int m;
+
+        for (m = 0; m < NMETHOD; m++)
+        {
+            int nsd = method[m] == CCR_QUANTIZE_BITROUND ? NSB : NSD;
+            int ncid, dimid, varid, varid2;
+            float buf[NX], data_in[NX];
+            double buf2[NX], data_in2[NX];
+
+            /* Quantize in memory. */
+            memcpy(buf, data_out, sizeof(buf));
+            memcpy(buf2, data_out2, sizeof(buf2));
+            if (ccr_quantize(method[m], nsd, NC_FLOAT, buf, NX, &custom_fill_float)) ERR;
+            if (ccr_quantize(method[m], nsd, NC_DOUBLE, buf2, NX, NULL)) ERR;
+
+            /* Write the original data through the filter. */
+            if (nc_create(FILE_NAME, NC_NETCDF4|NC_CLOBBER, &ncid)) ERR;
+            if (nc_def_dim(ncid, X_NAME, NX, &dimid)) ERR;
+            if (nc_def_var(ncid, VAR_NAME, NC_FLOAT, NDIM1, &dimid, &varid)) ERR;
+            if (nc_def_var(ncid, VAR_NAME2, NC_DOUBLE, NDIM1, &dimid, &varid2)) ERR;
+            if (nc_put_att_float(ncid, varid, _FillValue, NC_FLOAT, 1, &custom_fill_float)) ERR;
+            if (def_var_quantize(ncid, varid, method[m], nsd)) ERR;
+            if (def_var_quantize(ncid, varid2, method[m], nsd)) ERR;
+            if (nc_put_var_float(ncid, varid, data_out)) ERR;
+            if (nc_put_var_double(ncid, varid2, data_out2)) ERR;
+            if (nc_close(ncid)) ERR;
+
+            /* The filter wrote the same bits. */
+            if (nc_open(FILE_NAME, NC_NOWRITE, &ncid)) ERR;
+            if (nc_get_var_float(ncid, varid, data_in)) ERR;
+            if (nc_get_var_double(ncid, varid2, data_in2)) ERR;
+            if (nc_close(ncid)) ERR;
+            if (memcmp(data_in, buf, sizeof(buf))) ERR;
+            if (memcmp(data_in2, buf2, sizeof(buf2))) ERR;
+        }
+    }
+    SUMMARIZE_ERR;
+    FINAL_RESULTS;
+}
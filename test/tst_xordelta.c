@@ -0,0 +1,197 @@
+/* This is part of the CCR package. Copyright 2026.
+
+   Test XOR Delta.
+
+   agent 10/17/26
+*/
+
+#include "config.h"
+#include "ccr.h"
+#include "ccr_test.h"
+#include <hdf5.h>
+#include <H5DSpublic.h>
+#include <netcdf.h>
+#include <math.h>
+
+#define FILE_NAME "tst_xordelta.nc"
+#define TEST "tst_xordelta"
+#define STR_LEN 255
+#define X_NAME "X"
+#define Y_NAME "Y"
+#define NDIM2 2
+#define VAR_NAME "Bad_Moon_Rising"
+#define VAR_NAME2 "Green_River"
+#define VAR_NAME3 "Proud_Mary"
+#define VAR_NAME4 "Lodi"
+#define NX 60
+#define NY 120
+#define FILL_VALUE -999.25f
+
+/* Err is used to keep track of errors within each set of tests,
+ * total_err is the number of errors in the entire test program, which
+ * generally cosists of several sets of tests. */
+static int total_err = 0, err = 0;
+
+int
+main()
+{
+    printf("\n*** Checking XOR Delta filter.\n");
+    printf("*** Checking XOR Delta...");
+    {
+        int ncid;
+        int dimid[NDIM2];
+        int varid, varid2, varid3, varid4;
+        size_t chunksizes[NDIM2] = {NX / 2, NY / 2 - 1};
+        float data_out[NX][NY];
+        double data_out2[NX][NY];
+        float data_out3[NX][NY];
+        float fill_value = FILL_VALUE;
+        int x, y;
+        int xordelta;
+
+        /* Create some data to write: smooth fields at full
+         * precision, with fill values, repeated values, and values
+         * of either sign in the first. The chunks do not divide the
+         * rows evenly, so edge chunks hold values past the end of
+         * each row. */
+        for (x = 0; x < NX; x++)
+        {
+            for (y = 0; y < NY; y++)
+            {
+                data_out[x][y] = 20.0f * cosf(x / 9.0f) + 3.0f * sinf(y / 17.0f);
+                if ((x + y) % 23 == 0)
+                    data_out[x][y] = FILL_VALUE;
+                if (y % 40 > 35)
+                    data_out[x][y] = data_out[x][y - 1];
+                data_out2[x][y] = 101325.0 - 37.0 * x + 1.0 / (1.0 + y);
+                data_out3[x][y] = 273.15f + (x * NY + y) / 7.0f;
+            }
+        }
+
+        /* Create file. */
+        if (nc_create(FILE_NAME, NC_NETCDF4, &ncid)) ERR;
+
+        /* Create dims. */
+        if (nc_def_dim(ncid, X_NAME, NX, &dimid[0])) ERR;
+        if (nc_def_dim(ncid, Y_NAME, NY, &dimid[1])) ERR;
+
+        /* Create the variables. */
+        if (nc_def_var(ncid, VAR_NAME, NC_FLOAT, NDIM2, dimid, &varid)) ERR;
+        if (nc_def_var(ncid, VAR_NAME2, NC_DOUBLE, NDIM2, dimid, &varid2)) ERR;
+        if (nc_def_var(ncid, VAR_NAME3, NC_FLOAT, NDIM2, dimid, &varid3)) ERR;
+        if (nc_def_var(ncid, VAR_NAME4, NC_SHORT, NDIM2, dimid, &varid4)) ERR;
+        if (nc_def_var_chunking(ncid, varid, NC_CHUNKED, chunksizes)) ERR;
+        if (nc_def_var_chunking(ncid, varid2, NC_CHUNKED, chunksizes)) ERR;
+        if (nc_def_var_chunking(ncid, varid3, NC_CHUNKED, chunksizes)) ERR;
+        if (nc_put_att_float(ncid, varid, _FillValue, NC_FLOAT, 1, &fill_value)) ERR;
+
+        /* Check setting. */
+        if (nc_inq_var_xordelta(ncid, varid, &xordelta)) ERR;
+        if (xordelta) ERR;
+
+        /* Set up XOR Delta, alone on two variables, and followed by
+         * a compressor on the third. Integers have no leading and
+         * trailing zeros to code. */
+        if (nc_def_var_xordelta(ncid, varid)) ERR;
+        if (nc_def_var_xordelta(ncid, varid2)) ERR;
+        if (nc_def_var_xordelta(ncid, varid3)) ERR;
+#if BUILD_ZSTD
+        if (nc_def_var_zstandard(ncid, varid3, 3)) ERR;
+#else
+        if (nc_def_var_deflate(ncid, varid3, 0, 1, 1)) ERR;
+#endif /* BUILD_ZSTD */
+        if (nc_def_var_xordelta(ncid, varid4) != NC_EINVAL) ERR;
+
+        /* Check setting. */
+        if (nc_inq_var_xordelta(ncid, varid, &xordelta)) ERR;
+        if (!xordelta) ERR;
+        xordelta = 0;
+        if (nc_inq_var_xordelta(ncid, varid2, &xordelta)) ERR;
+        if (!xordelta) ERR;
+        if (nc_inq_var_xordelta(ncid, varid3, NULL)) ERR;
+        if (nc_inq_var_xordelta(ncid, varid4, &xordelta)) ERR;
+        if (xordelta) ERR;
+
+        /* Write the data. */
+        if (nc_put_var_float(ncid, varid, (float *)data_out)) ERR;
+        if (nc_put_var_double(ncid, varid2, (double *)data_out2)) ERR;
+        if (nc_put_var_float(ncid, varid3, (float *)data_out3)) ERR;
+
+        /* Close the file. */
+        if (nc_close(ncid)) ERR;
+
+        {
+            float data_in[NX][NY];
+            double data_in2[NX][NY];
+            float data_in3[NX][NY];
+
+            /* Now reopen the file and check. */
+            if (nc_open(FILE_NAME, NC_NETCDF4, &ncid)) ERR;
+
+            /* Check settings. */
+            if (nc_inq_var_xordelta(ncid, varid, &xordelta)) ERR;
+            if (!xordelta) ERR;
+            xordelta = 0;
+            if (nc_inq_var_xordelta(ncid, varid3, &xordelta)) ERR;
+            if (!xordelta) ERR;
+            if (nc_inq_var_xordelta(ncid, varid4, &xordelta)) ERR;
+            if (xordelta) ERR;
+
+            /* Read the data. */
+            if (nc_get_var_float(ncid, varid, (float *)data_in)) ERR;
+            if (nc_get_var_double(ncid, varid2, (double *)data_in2)) ERR;
+            if (nc_get_var_float(ncid, varid3, (float *)data_in3)) ERR;
+
+            /* Check the data. XOR Delta is lossless. */
+            for (x = 0; x < NX; x++)
+            {
+                for (y = 0; y < NY; y++)
+                {
+                    if (data_in[x][y] != data_out[x][y]) ERR;
+                    if (data_in2[x][y] != data_out2[x][y]) ERR;
+                    if (data_in3[x][y] != data_out3[x][y]) ERR;
+                }
+            }
+
+            /* Close the file. */
+            if (nc_close(ncid)) ERR;
+        }
+    }
+    SUMMARIZE_ERR;
+#define NTYPES 2
+    printf("*** Checking XOR Delta handling of text...");
+    {
+        int ncid;
+        int dimid[NDIM2];
+        int varid;
+        int xordelta;
+        char file_name[STR_LEN + 1];
+        int xtype[NTYPES] = {NC_CHAR, NC_STRING};
+        int t;
+
+        for (t = 0; t < NTYPES; t++)
+        {
+            sprintf(file_name, "%s_xordelta_type_%d.nc", TEST, xtype[t]);
+
+            /* Create file. */
+            if (nc_create(file_name, NC_NETCDF4, &ncid)) ERR;
+            if (nc_def_dim(ncid, X_NAME, NX, &dimid[0])) ERR;
+            if (nc_def_dim(ncid, Y_NAME, NY, &dimid[1])) ERR;
+            if (nc_def_var(ncid, VAR_NAME, xtype[t], NDIM2, dimid, &varid)) ERR;
+
+            /* XOR Delta returns NC_EINVAL because this is text. */
+            if (nc_def_var_xordelta(ncid, varid) != NC_EINVAL) ERR;
+            if (nc_close(ncid)) ERR;
+
+            /* Check file. */
+            {
+                if (nc_open(file_name, NC_NETCDF4, &ncid)) ERR;
+                if (nc_inq_var_xordelta(ncid, varid, &xordelta)) ERR;
+                if (xordelta) ERR;
+                if (nc_close(ncid)) ERR;
+            }
+        }
+    }
+    SUMMARIZE_ERR;
+    FINAL_RESULTS;
+}
@@ -6,7 +6,8 @@
 */
 
 #include "config.h"
-#include <math.h> /* Define fabs(), powf(), round() */
+#include <math.h> /* Define fabs(), powf(), round(), sinf() */
+#include <string.h> /* Define memcmp(), memcpy() */
 #include "ccr.h"
 #include "ccr_test.h"
 #include <hdf5.h>
@@ -34,6 +35,13 @@
 
 #define NX_BIG 100
 #define NY_BIG 100
+#define WORKERS 2
+#define DICT_FILE_NAME "tst_zstandard_dict_train.nc"
+#define DICT_CAPACITY 4096
+#define WINDOW_LOG 24
+#define STRATEGY 7
+#define THROUGHPUT 100
+#define NX_HUGE 524288
 
 /* Err is used to keep track of errors within each set of tests,
  * total_err is the number of errors in the entire test program, which
@@ -175,6 +183,360 @@ main()
         free(data_in);
     }
     SUMMARIZE_ERR;
+    printf("*** Checking Zstandard compression with worker threads...");
+    {
+        int ncid;
+        int dimid[NDIM2];
+        int varid, varid2;
+        float *data_out;
+        float *data_in;
+        int x;
+        int level_in, zstandard, workers_in;
+
+        if (!(data_out = malloc(NX_BIG * NY_BIG * sizeof(float)))) ERR;
+        if (!(data_in = malloc(NX_BIG * NY_BIG * sizeof(float)))) ERR;
+
+        /* Create some data to write. */
+        for (x = 0; x < NX_BIG * NY_BIG; x++)
+            data_out[x] = x * NY_BIG + x % NX_BIG;
+
+        /* Create file. */
+        if (nc_create(FILE_NAME, NC_NETCDF4|NC_CLOBBER, &ncid)) ERR;
+        if (nc_def_dim(ncid, X_NAME, NX_BIG, &dimid[0])) ERR;
+        if (nc_def_dim(ncid, Y_NAME, NY_BIG, &dimid[1])) ERR;
+        if (nc_def_var(ncid, VAR_NAME, NC_FLOAT, NDIM2, dimid, &varid)) ERR;
+        if (nc_def_var(ncid, SIMPLE_VAR_NAME, NC_FLOAT, NDIM2, dimid, &varid2)) ERR;
+
+        /* These won't work. */
+        if (nc_def_var_zstandard_workers(ncid, varid, 23, WORKERS) != NC_EINVAL) ERR;
+        if (nc_def_var_zstandard_workers(ncid, varid, DEFLATE_LEVEL, -1) != NC_EINVAL) ERR;
+        if (nc_def_var_zstandard_workers(ncid, varid, DEFLATE_LEVEL, 257) != NC_EINVAL) ERR;
+
+        /* Check setting. */
+        if (nc_inq_var_zstandard_workers(ncid, varid, &zstandard, &level_in, &workers_in)) ERR;
+        if (zstandard) ERR;
+
+        /* Set up compression, with and without workers. */
+        if (nc_def_var_zstandard_workers(ncid, varid, DEFLATE_LEVEL, WORKERS)) ERR;
+        if (nc_def_var_zstandard(ncid, varid2, DEFLATE_LEVEL)) ERR;
+
+        /* Check settings. */
+        if (nc_inq_var_zstandard_workers(ncid, varid, &zstandard, &level_in, &workers_in)) ERR;
+        if (!zstandard || level_in != DEFLATE_LEVEL || workers_in != WORKERS) ERR;
+        if (nc_inq_var_zstandard(ncid, varid, &zstandard, &level_in)) ERR;
+        if (!zstandard || level_in != DEFLATE_LEVEL) ERR;
+        if (nc_inq_var_zstandard_workers(ncid, varid2, &zstandard, &level_in, &workers_in)) ERR;
+        if (!zstandard || level_in != DEFLATE_LEVEL || workers_in) ERR;
+        if (nc_inq_var_zstandard_workers(ncid, varid, NULL, NULL, NULL)) ERR;
+
+        /* Write the data. */
+        if (nc_put_var_float(ncid, varid, data_out)) ERR;
+        if (nc_put_var_float(ncid, varid2, data_out)) ERR;
+        if (nc_close(ncid)) ERR;
+
+        /* Check file. */
+        {
+            if (nc_open(FILE_NAME, NC_NOWRITE, &ncid)) ERR;
+            if (nc_inq_var_zstandard_workers(ncid, varid, &zstandard, &level_in, &workers_in)) ERR;
+            if (!zstandard || level_in != DEFLATE_LEVEL || workers_in != WORKERS) ERR;
+            if (nc_inq_var_zstandard_workers(ncid, varid2, &zstandard, &level_in, &workers_in)) ERR;
+            if (!zstandard || level_in != DEFLATE_LEVEL || workers_in) ERR;
+            if (nc_get_var_float(ncid, varid, data_in)) ERR;
+            for (x = 0; x < NX_BIG * NY_BIG; x++)
+                if (data_in[x] != data_out[x]) ERR;
+            if (nc_get_var_float(ncid, varid2, data_in)) ERR;
+            for (x = 0; x < NX_BIG * NY_BIG; x++)
+                if (data_in[x] != data_out[x]) ERR;
+            if (nc_close(ncid)) ERR;
+        }
+
+        free(data_out);
+        free(data_in);
+    }
+    SUMMARIZE_ERR;
+    printf("*** Checking Zstandard compression with a dictionary...");
+    {
+        int ncid;
+        int dimid[NDIM2];
+        int varid, varid2;
+        size_t chunksizes[NDIM2] = {2, NY};
+        float data_out[NX][NY];
+        unsigned char dict[DICT_CAPACITY], dict_in[DICT_CAPACITY];
+        size_t dict_size, dict_size_in;
+        int x, y;
+        int level_in, zstandard, zstandard_dict;
+
+        /* Create some smooth data to write, in small chunks. */
+        for (x = 0; x < NX; x++)
+            for (y = 0; y < NY; y++)
+                data_out[x][y] = 273.15f + 10.0f * sinf(x * 0.1f) * cosf(y * 0.05f);
+
+        /* Write a file to train from. */
+        if (nc_create(DICT_FILE_NAME, NC_NETCDF4|NC_CLOBBER, &ncid)) ERR;
+        if (nc_def_dim(ncid, X_NAME, NX, &dimid[0])) ERR;
+        if (nc_def_dim(ncid, Y_NAME, NY, &dimid[1])) ERR;
+        if (nc_def_var(ncid, VAR_NAME, NC_FLOAT, NDIM2, dimid, &varid)) ERR;
+        if (nc_def_var_chunking(ncid, varid, NC_CHUNKED, chunksizes)) ERR;
+        if (nc_put_var_float(ncid, varid, (float *)data_out)) ERR;
+        if (nc_close(ncid)) ERR;
+
+        /* Train a dictionary from its chunks. */
+        if (nc_open(DICT_FILE_NAME, NC_NOWRITE, &ncid)) ERR;
+#ifdef HAVE_ZDICT
+        if (ccr_train_zstandard_dict(ncid, 1, &varid, 100, dict, &dict_size) != NC_EINVAL) ERR;
+        if (ccr_train_zstandard_dict(ncid, 0, &varid, DICT_CAPACITY, dict, &dict_size) != NC_EINVAL) ERR;
+        if (ccr_train_zstandard_dict(ncid, 1, &varid, DICT_CAPACITY, dict, &dict_size)) ERR;
+        if (dict_size < 1 || dict_size > DICT_CAPACITY) ERR;
+#else
+        /* Without the dictionary builder, use raw content. */
+        if (ccr_train_zstandard_dict(ncid, 1, &varid, DICT_CAPACITY, dict, &dict_size) != NC_ENOTBUILT) ERR;
+        memcpy(dict, data_out, DICT_CAPACITY);
+        dict_size = DICT_CAPACITY;
+#endif /* HAVE_ZDICT */
+        if (nc_close(ncid)) ERR;
+
+        /* Create file. */
+        if (nc_create(FILE_NAME, NC_NETCDF4|NC_CLOBBER, &ncid)) ERR;
+        if (nc_def_dim(ncid, X_NAME, NX, &dimid[0])) ERR;
+        if (nc_def_dim(ncid, Y_NAME, NY, &dimid[1])) ERR;
+        if (nc_def_var(ncid, VAR_NAME, NC_FLOAT, NDIM2, dimid, &varid)) ERR;
+        if (nc_def_var(ncid, SIMPLE_VAR_NAME, NC_FLOAT, NDIM2, dimid, &varid2)) ERR;
+        if (nc_def_var_chunking(ncid, varid, NC_CHUNKED, chunksizes)) ERR;
+        if (nc_def_var_chunking(ncid, varid2, NC_CHUNKED, chunksizes)) ERR;
+
+        /* These won't work. */
+        if (nc_def_var_zstandard_dict(ncid, varid, 23, dict, dict_size) != NC_EINVAL) ERR;
+        if (nc_def_var_zstandard_dict(ncid, varid, DEFLATE_LEVEL, NULL, dict_size) != NC_EINVAL) ERR;
+        if (nc_def_var_zstandard_dict(ncid, varid, DEFLATE_LEVEL, dict, 0) != NC_EINVAL) ERR;
+        if (nc_def_var_zstandard_dict(ncid, varid, DEFLATE_LEVEL, dict, ZSTANDARD_DICT_MAX_SIZE + 1) != NC_EINVAL) ERR;
+
+        /* Check setting. */
+        if (nc_inq_var_zstandard_dict(ncid, varid, &zstandard_dict, &dict_size_in, dict_in)) ERR;
+        if (zstandard_dict) ERR;
+
+        /* Set up compression, with and without dictionary. */
+        if (nc_def_var_zstandard_dict(ncid, varid, DEFLATE_LEVEL, dict, dict_size)) ERR;
+        if (nc_def_var_zstandard(ncid, varid2, DEFLATE_LEVEL)) ERR;
+
+        /* Check settings. */
+        if (nc_inq_var_zstandard_dict(ncid, varid, &zstandard_dict, &dict_size_in, dict_in)) ERR;
+        if (!zstandard_dict || dict_size_in != dict_size || memcmp(dict_in, dict, dict_size)) ERR;
+        if (nc_inq_var_zstandard(ncid, varid, &zstandard, &level_in)) ERR;
+        if (!zstandard || level_in != DEFLATE_LEVEL) ERR;
+        if (nc_inq_var_zstandard_dict(ncid, varid2, &zstandard_dict, &dict_size_in, dict_in)) ERR;
+        if (zstandard_dict) ERR;
+        if (nc_inq_var_zstandard_dict(ncid, varid, NULL, NULL, NULL)) ERR;
+
+        /* Write the data. */
+        if (nc_put_var_float(ncid, varid, (float *)data_out)) ERR;
+        if (nc_put_var_float(ncid, varid2, (float *)data_out)) ERR;
+        if (nc_close(ncid)) ERR;
+
+        /* Check file. */
+        {
+            float data_in[NX][NY];
+
+            if (nc_open(FILE_NAME, NC_NOWRITE, &ncid)) ERR;
+            memset(dict_in, 0, sizeof(dict_in));
+            if (nc_inq_var_zstandard_dict(ncid, varid, &zstandard_dict, &dict_size_in, dict_in)) ERR;
+            if (!zstandard_dict || dict_size_in != dict_size || memcmp(dict_in, dict, dict_size)) ERR;
+            if (nc_get_var_float(ncid, varid, (float *)data_in)) ERR;
+            for (x = 0; x < NX; x++)
+                for (y = 0; y < NY; y++)
+                    if (data_in[x][y] != data_out[x][y]) ERR;
+            if (nc_get_var_float(ncid, varid2, (float *)data_in)) ERR;
+            for (x = 0; x < NX; x++)
+                for (y = 0; y < NY; y++)
+                    if (data_in[x][y] != data_out[x][y]) ERR;
+            if (nc_close(ncid)) ERR;
+        }
+    }
+    SUMMARIZE_ERR;
+    printf("*** Checking Zstandard compression with long-distance matching...");
+    {
+        int ncid;
+        int dimid[NDIM2];
+        int varid, varid2;
+        float *data_out;
+        float *data_in;
+        int x;
+        int level_in, zstandard, window_log_in, ldm_in, strategy_in, workers_in;
+        size_t dict_size_in;
+
+        if (!(data_out = malloc(NX_BIG * NY_BIG * sizeof(float)))) ERR;
+        if (!(data_in = malloc(NX_BIG * NY_BIG * sizeof(float)))) ERR;
+
+        /* Create some data to write, repeating every few rows. */
+        for (x = 0; x < NX_BIG * NY_BIG; x++)
+            data_out[x] = (x % (NY_BIG * 7)) / 3.0f;
+
+        /* Create file. */
+        if (nc_create(FILE_NAME, NC_NETCDF4|NC_CLOBBER, &ncid)) ERR;
+        if (nc_def_dim(ncid, X_NAME, NX_BIG, &dimid[0])) ERR;
+        if (nc_def_dim(ncid, Y_NAME, NY_BIG, &dimid[1])) ERR;
+        if (nc_def_var(ncid, VAR_NAME, NC_FLOAT, NDIM2, dimid, &varid)) ERR;
+        if (nc_def_var(ncid, SIMPLE_VAR_NAME, NC_FLOAT, NDIM2, dimid, &varid2)) ERR;
+
+        /* These won't work. */
+        if (nc_def_var_zstandard_ldm(ncid, varid, 23, WINDOW_LOG, 1, STRATEGY) != NC_EINVAL) ERR;
+        if (nc_def_var_zstandard_ldm(ncid, varid, DEFLATE_LEVEL, 9, 1, STRATEGY) != NC_EINVAL) ERR;
+        if (nc_def_var_zstandard_ldm(ncid, varid, DEFLATE_LEVEL, 32, 1, STRATEGY) != NC_EINVAL) ERR;
+        if (nc_def_var_zstandard_ldm(ncid, varid, DEFLATE_LEVEL, WINDOW_LOG, 1, -1) != NC_EINVAL) ERR;
+        if (nc_def_var_zstandard_ldm(ncid, varid, DEFLATE_LEVEL, WINDOW_LOG, 1, 10) != NC_EINVAL) ERR;
+
+        /* Check setting. */
+        if (nc_inq_var_zstandard_ldm(ncid, varid, &zstandard, &level_in, &window_log_in, &ldm_in, &strategy_in)) ERR;
+        if (zstandard) ERR;
+
+        /* Set up compression, with explicit and default window and
+         * strategy. */
+        if (nc_def_var_zstandard_ldm(ncid, varid, DEFLATE_LEVEL, WINDOW_LOG, 1, STRATEGY)) ERR;
+        if (nc_def_var_zstandard_ldm(ncid, varid2, DEFLATE_LEVEL, 0, 1, 0)) ERR;
+
+        /* Check settings. */
+        if (nc_inq_var_zstandard_ldm(ncid, varid, &zstandard, &level_in, &window_log_in, &ldm_in, &strategy_in)) ERR;
+        if (!zstandard || level_in != DEFLATE_LEVEL || window_log_in != WINDOW_LOG ||
+            ldm_in != 1 || strategy_in != STRATEGY) ERR;
+        if (nc_inq_var_zstandard_workers(ncid, varid, &zstandard, &level_in, &workers_in)) ERR;
+        if (!zstandard || level_in != DEFLATE_LEVEL || workers_in) ERR;
+        if (nc_inq_var_zstandard_dict(ncid, varid, &zstandard, &dict_size_in, NULL)) ERR;
+        if (zstandard) ERR;
+        if (nc_inq_var_zstandard_ldm(ncid, varid, NULL, NULL, NULL, NULL, NULL)) ERR;
+
+        /* Write the data. */
+        if (nc_put_var_float(ncid, varid, data_out)) ERR;
+        if (nc_put_var_float(ncid, varid2, data_out)) ERR;
+        if (nc_close(ncid)) ERR;
+
+        /* Check file. */
+        {
+            if (nc_open(FILE_NAME, NC_NOWRITE, &ncid)) ERR;
+            if (nc_inq_var_zstandard_ldm(ncid, varid, &zstandard, &level_in, &window_log_in, &ldm_in, &strategy_in)) ERR;
+            if (!zstandard || level_in != DEFLATE_LEVEL || window_log_in != WINDOW_LOG ||
+                ldm_in != 1 || strategy_in != STRATEGY) ERR;
+            if (nc_inq_var_zstandard_ldm(ncid, varid2, &zstandard, &level_in, &window_log_in, &ldm_in, &strategy_in)) ERR;
+            if (!zstandard || level_in != DEFLATE_LEVEL || window_log_in || ldm_in != 1 || strategy_in) ERR;
+            if (nc_get_var_float(ncid, varid, data_in)) ERR;
+            for (x = 0; x < NX_BIG * NY_BIG; x++)
+                if (data_in[x] != data_out[x]) ERR;
+            if (nc_get_var_float(ncid, varid2, data_in)) ERR;
+            for (x = 0; x < NX_BIG * NY_BIG; x++)
+                if (data_in[x] != data_out[x]) ERR;
+            if (nc_close(ncid)) ERR;
+        }
+
+        free(data_out);
+        free(data_in);
+    }
+    SUMMARIZE_ERR;
+    printf("*** Checking Zstandard compression with an adaptive level...");
+    {
+        int ncid;
+        int dimid[NDIM2];
+        int varid, varid2;
+        float *data_out;
+        float *data_in;
+        int x;
+        int level_in, zstandard, zstandard_adaptive, throughput_in;
+
+        if (!(data_out = malloc(NX_BIG * NY_BIG * sizeof(float)))) ERR;
+        if (!(data_in = malloc(NX_BIG * NY_BIG * sizeof(float)))) ERR;
+
+        /* Create some data to write. */
+        for (x = 0; x < NX_BIG * NY_BIG; x++)
+            data_out[x] = x * NY_BIG + x % NX_BIG;
+
+        /* Create file. */
+        if (nc_create(FILE_NAME, NC_NETCDF4|NC_CLOBBER, &ncid)) ERR;
+        if (nc_def_dim(ncid, X_NAME, NX_BIG, &dimid[0])) ERR;
+        if (nc_def_dim(ncid, Y_NAME, NY_BIG, &dimid[1])) ERR;
+        if (nc_def_var(ncid, VAR_NAME, NC_FLOAT, NDIM2, dimid, &varid)) ERR;
+        if (nc_def_var(ncid, SIMPLE_VAR_NAME, NC_FLOAT, NDIM2, dimid, &varid2)) ERR;
+
+        /* These won't work. */
+        if (nc_def_var_zstandard_adaptive(ncid, varid, 23, THROUGHPUT) != NC_EINVAL) ERR;
+        if (nc_def_var_zstandard_adaptive(ncid, varid, DEFLATE_LEVEL, 0) != NC_EINVAL) ERR;
+
+        /* Check setting. */
+        if (nc_inq_var_zstandard_adaptive(ncid, varid, &zstandard_adaptive, &level_in, &throughput_in)) ERR;
+        if (zstandard_adaptive) ERR;
+
+        /* Set up compression, with adaptive and fixed level. */
+        if (nc_def_var_zstandard_adaptive(ncid, varid, DEFLATE_LEVEL, THROUGHPUT)) ERR;
+        if (nc_def_var_zstandard(ncid, varid2, DEFLATE_LEVEL)) ERR;
+
+        /* Check settings. */
+        if (nc_inq_var_zstandard_adaptive(ncid, varid, &zstandard_adaptive, &level_in, &throughput_in)) ERR;
+        if (!zstandard_adaptive || level_in != DEFLATE_LEVEL || throughput_in != THROUGHPUT) ERR;
+        if (nc_inq_var_zstandard(ncid, varid, &zstandard, &level_in)) ERR;
+        if (!zstandard || level_in != DEFLATE_LEVEL) ERR;
+        if (nc_inq_var_zstandard_adaptive(ncid, varid2, &zstandard_adaptive, &level_in, &throughput_in)) ERR;
+        if (zstandard_adaptive) ERR;
+        if (nc_inq_var_zstandard_adaptive(ncid, varid, NULL, NULL, NULL)) ERR;
+
+        /* Write the data. */
+        if (nc_put_var_float(ncid, varid, data_out)) ERR;
+        if (nc_put_var_float(ncid, varid2, data_out)) ERR;
+        if (nc_close(ncid)) ERR;
+
+        /* Check file. Whatever levels were chosen, data are intact. */
+        {
+            if (nc_open(FILE_NAME, NC_NOWRITE, &ncid)) ERR;
+            if (nc_inq_var_zstandard_adaptive(ncid, varid, &zstandard_adaptive, &level_in, &throughput_in)) ERR;
+            if (!zstandard_adaptive || level_in != DEFLATE_LEVEL || throughput_in != THROUGHPUT) ERR;
+            if (nc_get_var_float(ncid, varid, data_in)) ERR;
+            for (x = 0; x < NX_BIG * NY_BIG; x++)
+                if (data_in[x] != data_out[x]) ERR;
+            if (nc_get_var_float(ncid, varid2, data_in)) ERR;
+            for (x = 0; x < NX_BIG * NY_BIG; x++)
+                if (data_in[x] != data_out[x]) ERR;
+            if (nc_close(ncid)) ERR;
+        }
+
+        free(data_out);
+        free(data_in);
+    }
+    SUMMARIZE_ERR;
+    printf("*** Checking Zstandard compression of large chunks...");
+    {
+        int ncid;
+        int dimid;
+        int varid;
+        size_t chunksize = NX_HUGE;
+        float *data_out;
+        float *data_in;
+        int x;
+
+        /* Chunks of 1 MiB or more are compressed as a stream. */
+        if (!(data_out = malloc(NX_HUGE * sizeof(float)))) ERR;
+        if (!(data_in = malloc(NX_HUGE * sizeof(float)))) ERR;
+
+        /* Create some data to write. */
+        for (x = 0; x < NX_HUGE; x++)
+            data_out[x] = 273.15f + (x % 1000) / 7.0f;
+
+        /* Create file. */
+        if (nc_create(FILE_NAME, NC_NETCDF4|NC_CLOBBER, &ncid)) ERR;
+        if (nc_def_dim(ncid, X_NAME, NX_HUGE, &dimid)) ERR;
+        if (nc_def_var(ncid, VAR_NAME, NC_FLOAT, 1, &dimid, &varid)) ERR;
+        if (nc_def_var_chunking(ncid, varid, NC_CHUNKED, &chunksize)) ERR;
+        if (nc_def_var_zstandard(ncid, varid, DEFLATE_LEVEL)) ERR;
+        if (nc_put_var_float(ncid, varid, data_out)) ERR;
+        if (nc_close(ncid)) ERR;
+
+        /* Check file. */
+        {
+            if (nc_open(FILE_NAME, NC_NOWRITE, &ncid)) ERR;
+            if (nc_get_var_float(ncid, varid, data_in)) ERR;
+            for (x = 0; x < NX_HUGE; x++)
+                if (data_in[x] != data_out[x]) ERR;
+            if (nc_close(ncid)) ERR;
+        }
+
+        free(data_out);
+        free(data_in);
+    }
+    SUMMARIZE_ERR;
 #ifdef BUILD_BITGROOM
 #ifdef HAVE_MULTIFILTERS
     printf("*** Checking Zstandard size of compression with bitgroom...");
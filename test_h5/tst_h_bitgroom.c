@@ -10,6 +10,8 @@
 #include "ccr_test.h"
 #include <hdf5.h>
 #include <H5DSpublic.h>
+#include <math.h>
+#include <string.h>
 
 /* Err is used to keep track of errors within each set of tests,
  * total_err is the number of errors in the entire test program, which
@@ -19,11 +21,76 @@ static int total_err = 0, err = 0;
 #define FILE_NAME "tst_h_bitgroom.h5"
 #define STR_LEN 255
 #define MAX_LEN 1024
+#define NBIG 1000003 /* Spans many multithreading slices */
+#define NVAL 1027 /* Odd, and not a multiple of any SIMD width */
 
 size_t H5Z_filter_bitgroom(unsigned int flags, size_t cd_nelmts,
                       const unsigned int cd_values[], size_t nbytes,
                       size_t *buf_size, void **buf);
 
+/* Kernel selection in ccr_bgr.c, exported for this test. */
+#define KNL_NBR 3
+int ccr_bgr_knl_set(const char *knl_nm);
+void ccr_bgr_cpu_dispatch(void);
+
+/* Reference BitGroom, written as the original two-pass loops, used to
+ * check the SIMD kernels selected at run time. */
+static void
+bgr_ref_flt(size_t sz, float mss_val, unsigned int msk_zro, float *fp)
+{
+    unsigned int *u32p = (unsigned int *)fp;
+    size_t idx;
+
+    for (idx = 0; idx < sz; idx += 2)
+        if (fp[idx] != mss_val)
+            u32p[idx] &= msk_zro;
+    for (idx = 1; idx < sz; idx += 2)
+        if (fp[idx] != mss_val && u32p[idx] != 0U)
+            u32p[idx] |= ~msk_zro;
+}
+
+static void
+bgr_ref_dbl(size_t sz, double mss_val, unsigned long long msk_zro, double *dp)
+{
+    unsigned long long *u64p = (unsigned long long *)dp;
+    size_t idx;
+
+    for (idx = 0; idx < sz; idx += 2)
+        if (dp[idx] != mss_val)
+            u64p[idx] &= msk_zro;
+    for (idx = 1; idx < sz; idx += 2)
+        if (dp[idx] != mss_val && u64p[idx] != 0ULL)
+            u64p[idx] |= ~msk_zro;
+}
+
+/* BitGroom to absolute error, written per value with frexp(): keep
+ * explicit bits down to the one worth the largest power of two not
+ * exceeding abs_err, shave even-indexed and set odd-indexed values. */
+static void
+bgr_abs_ref_flt(double abs_err, size_t sz, float mss_val, float *fp)
+{
+    unsigned int *u32p = (unsigned int *)fp;
+    unsigned int msk_zro;
+    int qnt_pwr, xpn, bit_nbr;
+    size_t idx;
+
+    (void)frexp(abs_err, &qnt_pwr);
+    qnt_pwr--;
+    for (idx = 0; idx < sz; idx++)
+        if (fp[idx] != mss_val && fp[idx] != 0.0f && isnormal(fp[idx]))
+        {
+            (void)frexp(fp[idx], &xpn);
+            bit_nbr = xpn - 1 - qnt_pwr;
+            if (bit_nbr >= 23)
+                continue;
+            msk_zro = ~0U << (23 - (bit_nbr < 0 ? 0 : bit_nbr));
+            if (idx % 2 == 0)
+                u32p[idx] &= msk_zro;
+            else
+                u32p[idx] |= ~msk_zro;
+        }
+}
+
 int
 main()
 {
@@ -154,5 +221,243 @@ main()
             ERR;
     }
     SUMMARIZE_ERR;
+    printf("*** Checking every BitGroom kernel against reference implementation...");
+    {
+        /* With NSD=3, BitGroom keeps ceil(3*log2(10))+1 = 11 explicit
+         * bits, so float zeroes 23-11=12 bits and double zeroes
+         * 52-11=41 bits. */
+        const unsigned int msk_flt = ~0U << 12;
+        const unsigned long long msk_dbl = ~0ULL << 41;
+        const float mss_val_flt = -999.0f;
+        const double mss_val_dbl = -999.0;
+        const char *knl_nm[KNL_NBR] = {"scalar", "AVX2", "AVX-512"};
+        unsigned int cd_values[BITGROOM_FLT_PRM_NBR] = {3, 0, 1, 0, 0};
+        float *fp, *fp_in, *fp_ref, *fp_knl;
+        double *dp, *dp_in, *dp_ref, *dp_knl;
+        size_t nbytes;
+        void *buf;
+        int i, k, sz, knl_nbr = 0;
+
+        if (!(fp_in = malloc(NVAL * sizeof(float)))) ERR;
+        if (!(fp_ref = malloc(NVAL * sizeof(float)))) ERR;
+        if (!(fp_knl = malloc(NVAL * sizeof(float)))) ERR;
+        if (!(dp_in = malloc(NVAL * sizeof(double)))) ERR;
+        if (!(dp_ref = malloc(NVAL * sizeof(double)))) ERR;
+        if (!(dp_knl = malloc(NVAL * sizeof(double)))) ERR;
+
+        /* Run each kernel this CPU supports, not just the one
+         * dispatch prefers, so all are checked on one host. */
+        for (k = 0; k < KNL_NBR; k++)
+        {
+            if (!ccr_bgr_knl_set(knl_nm[k]))
+                continue;
+            knl_nbr++;
+
+            /* Try lengths that exercise every remainder after the
+             * vector loops. */
+            for (sz = NVAL - 16; sz <= NVAL; sz++)
+            {
+                /* Single precision, with fill values, zeros, and
+                 * negative zeros. */
+                for (i = 0; i < sz; i++)
+                    fp_in[i] = fp_ref[i] = (i % 7 == 0) ? mss_val_flt : (i % 11 == 0) ? 0.0f :
+                        (i % 13 == 0) ? -0.0f : (i - NVAL / 2) * 3.14159f;
+                nbytes = sz * sizeof(float);
+                if (!(fp = malloc(nbytes))) ERR;
+                memcpy(fp, fp_in, nbytes);
+                cd_values[1] = sizeof(float);
+                memcpy(&cd_values[3], &mss_val_flt, sizeof(float));
+                buf = fp;
+                if (H5Z_filter_bitgroom(0, BITGROOM_FLT_PRM_NBR, cd_values, nbytes,
+                                        &nbytes, &buf) != sz * sizeof(float)) ERR;
+                bgr_ref_flt(sz, mss_val_flt, msk_flt, fp_ref);
+                if (memcmp(fp, fp_ref, sz * sizeof(float))) ERR;
+                /* The first kernel run is the scalar one. */
+                if (k == 0)
+                    memcpy(fp_knl, fp, sz * sizeof(float));
+                else if (memcmp(fp, fp_knl, sz * sizeof(float))) ERR;
+                free(fp);
+
+                /* Double precision. */
+                for (i = 0; i < sz; i++)
+                    dp_in[i] = dp_ref[i] = (i % 7 == 0) ? mss_val_dbl : (i % 11 == 0) ? 0.0 :
+                        (i % 13 == 0) ? -0.0 : (i - NVAL / 2) * 3.14159;
+                nbytes = sz * sizeof(double);
+                if (!(dp = malloc(nbytes))) ERR;
+                memcpy(dp, dp_in, nbytes);
+                cd_values[1] = sizeof(double);
+                memcpy(&cd_values[3], &mss_val_dbl, sizeof(double));
+                buf = dp;
+                if (H5Z_filter_bitgroom(0, BITGROOM_FLT_PRM_NBR, cd_values, nbytes,
+                                        &nbytes, &buf) != sz * sizeof(double)) ERR;
+                bgr_ref_dbl(sz, mss_val_dbl, msk_dbl, dp_ref);
+                if (memcmp(dp, dp_ref, sz * sizeof(double))) ERR;
+                if (k == 0)
+                    memcpy(dp_knl, dp, sz * sizeof(double));
+                else if (memcmp(dp, dp_knl, sz * sizeof(double))) ERR;
+                free(dp);
+            }
+        }
+        if (!knl_nbr) ERR;
+        ccr_bgr_cpu_dispatch();
+        free(fp_in);
+        free(fp_ref);
+        free(fp_knl);
+        free(dp_in);
+        free(dp_ref);
+        free(dp_knl);
+    }
+    SUMMARIZE_ERR;
+    printf("*** Checking BitGroom to absolute error...");
+    {
+        const double abs_err[] = {1.0e-30, 1.0e-3, 0.75, 1.0, 1.0e5};
+        const float mss_val_flt = -999.0f;
+        unsigned int cd_values[BITGROOM_ABS_FLT_PRM_NBR] = {0, sizeof(float), 1, 0, 0, 0, 0};
+        float *fp, *fp_ref;
+        double *dp, val;
+        size_t nbytes;
+        void *buf;
+        int e, i;
+
+        if (!(fp = malloc(NVAL * sizeof(float)))) ERR;
+        if (!(fp_ref = malloc(NVAL * sizeof(float)))) ERR;
+        if (!(dp = malloc(NVAL * sizeof(double)))) ERR;
+        memcpy(&cd_values[3], &mss_val_flt, sizeof(float));
+
+        for (e = 0; e < (int)(sizeof(abs_err) / sizeof(abs_err[0])); e++)
+        {
+            /* Magnitudes from 1e-20 to 1e20, with fill values,
+             * zeros, subnormals, and infinities. */
+            for (i = 0; i < NVAL; i++)
+                fp[i] = fp_ref[i] = (i % 7 == 0) ? mss_val_flt : (i % 11 == 0) ? 0.0f :
+                    (i % 13 == 0) ? ldexpf(i, -140) : (i % 17 == 0) ? -INFINITY :
+                    sin(i) * pow(10.0, i % 41 - 20);
+            cd_values[1] = sizeof(float);
+            memcpy(&cd_values[5], &abs_err[e], sizeof(double));
+            nbytes = NVAL * sizeof(float);
+            buf = fp;
+            if (H5Z_filter_bitgroom(0, BITGROOM_ABS_FLT_PRM_NBR, cd_values, nbytes,
+                                    &nbytes, &buf) != NVAL * sizeof(float)) ERR;
+            bgr_abs_ref_flt(abs_err[e], NVAL, mss_val_flt, fp_ref);
+            if (memcmp(fp, fp_ref, NVAL * sizeof(float))) ERR;
+            for (i = 0; i < NVAL; i++)
+                if (!isinf(fp[i]) && fabs(fp[i] - fp_ref[i]) > abs_err[e]) ERR;
+
+            /* Double precision stays within error bound. */
+            for (i = 0; i < NVAL; i++)
+                dp[i] = (i % 11 == 0) ? 0.0 : sin(i) * pow(10.0, i % 601 - 300);
+            cd_values[1] = sizeof(double);
+            cd_values[2] = 0;
+            nbytes = NVAL * sizeof(double);
+            buf = dp;
+            if (H5Z_filter_bitgroom(0, BITGROOM_ABS_FLT_PRM_NBR, cd_values, nbytes,
+                                    &nbytes, &buf) != NVAL * sizeof(double)) ERR;
+            for (i = 0; i < NVAL; i++)
+            {
+                val = (i % 11 == 0) ? 0.0 : sin(i) * pow(10.0, i % 601 - 300);
+                if (fabs(dp[i] - val) > abs_err[e]) ERR;
+            }
+            cd_values[2] = 1;
+        }
+
+        /* Small values keep fewer bits than large ones. */
+        fp[0] = 0.00123f;
+        fp[1] = 0.00123f;
+        fp[2] = 1000.123f;
+        cd_values[1] = sizeof(float);
+        memcpy(&cd_values[5], &abs_err[1], sizeof(double));
+        nbytes = 3 * sizeof(float);
+        buf = fp;
+        if (H5Z_filter_bitgroom(0, BITGROOM_ABS_FLT_PRM_NBR, cd_values, nbytes,
+                                &nbytes, &buf) != 3 * sizeof(float)) ERR;
+        if (fp[0] != 0.0009765625f || fp[1] >= 0.001953125f) ERR;
+        if (fp[2] == 1000.0f || fabsf(fp[2] - 1000.123f) > 1.0e-3f) ERR;
+
+        /* Absolute error must be positive, and present. */
+        memset(&cd_values[5], 0, sizeof(double));
+        nbytes = 3 * sizeof(float);
+        if (H5Z_filter_bitgroom(0, BITGROOM_ABS_FLT_PRM_NBR, cd_values, nbytes,
+                                &nbytes, &buf)) ERR;
+        if (H5Z_filter_bitgroom(0, 5, cd_values, nbytes, &nbytes, &buf)) ERR;
+        free(fp);
+        free(fp_ref);
+        free(dp);
+    }
+    SUMMARIZE_ERR;
+    printf("*** Checking threaded BitGroom matches single-threaded...");
+    {
+        /* Large enough for many slices, odd so the last slice is short. */
+        const float mss_val_flt = -999.0f;
+        unsigned int cd_values[BITGROOM_FLT_PRM_NBR + 1] = {3, sizeof(float), 1, 0, 0, 0};
+        float *fp, *fp_thr;
+        size_t nbytes;
+        void *buf;
+        int i;
+
+        if (!(fp = malloc(NBIG * sizeof(float)))) ERR;
+        if (!(fp_thr = malloc(NBIG * sizeof(float)))) ERR;
+        for (i = 0; i < NBIG; i++)
+            fp[i] = fp_thr[i] = (i % 17 == 0) ? mss_val_flt : 273.15f + 50.0f * sinf(i * 1.0e-3f);
+        memcpy(&cd_values[3], &mss_val_flt, sizeof(float));
+
+        if (setenv("CCR_THR_NBR", "1", 1)) ERR;
+        nbytes = NBIG * sizeof(float);
+        buf = fp;
+        if (H5Z_filter_bitgroom(0, BITGROOM_FLT_PRM_NBR, cd_values, nbytes, &nbytes, &buf) != NBIG * sizeof(float)) ERR;
+        if (setenv("CCR_THR_NBR", "4", 1)) ERR;
+        nbytes = NBIG * sizeof(float);
+        buf = fp_thr;
+        if (H5Z_filter_bitgroom(0, BITGROOM_FLT_PRM_NBR, cd_values, nbytes, &nbytes, &buf) != NBIG * sizeof(float)) ERR;
+        if (unsetenv("CCR_THR_NBR")) ERR;
+        if (memcmp(fp, fp_thr, NBIG * sizeof(float))) ERR;
+        free(fp);
+        free(fp_thr);
+    }
+    SUMMARIZE_ERR;
+    printf("*** Checking BitGroom stores seven parameters only for absolute error...");
+    {
+        /* Readers that predate absolute error mode accept only five
+         * parameters, so NSD mode must not store the other two. */
+        const double abs_err = 1.0e-3;
+        hid_t fileid, datasetid, spaceid, plistid, dcplid;
+        hsize_t dimsize[2] = {NX, NY};
+        hsize_t chunksize[2] = {NX / 2, NY / 2};
+        unsigned int cd_values[BITGROOM_ABS_FLT_PRM_NBR] = {0, 0, 0, 0, 0, 0, 0};
+        unsigned int cd_values_in[BITGROOM_ABS_FLT_PRM_NBR + 1];
+        size_t cd_nelmts;
+        unsigned int flags;
+        int a;
+
+        if (!H5Zfilter_avail(BITGROOM_ID)) ERR;
+        if ((fileid = H5Fcreate(FILE_NAME, H5F_ACC_TRUNC, H5P_DEFAULT, H5P_DEFAULT)) < 0) ERR;
+        if ((spaceid = H5Screate_simple(2, dimsize, NULL)) < 0) ERR;
+        for (a = 0; a < 2; a++)
+        {
+            size_t prm_nbr = a ? BITGROOM_ABS_FLT_PRM_NBR : BITGROOM_FLT_PRM_NBR;
+
+            cd_values[0] = a ? 0 : 3;
+            if (a)
+                memcpy(&cd_values[5], &abs_err, sizeof(double));
+            if ((plistid = H5Pcreate(H5P_DATASET_CREATE)) < 0) ERR;
+            if (H5Pset_chunk(plistid, 2, chunksize) < 0) ERR;
+            if (H5Pset_filter(plistid, (H5Z_filter_t)BITGROOM_ID, H5Z_FLAG_MANDATORY,
+                              prm_nbr, cd_values) < 0) ERR;
+            if ((datasetid = H5Dcreate2(fileid, a ? "abs" : "nsd", H5T_IEEE_F32LE, spaceid,
+                                        H5P_DEFAULT, plistid, H5P_DEFAULT)) < 0) ERR;
+            if ((dcplid = H5Dget_create_plist(datasetid)) < 0) ERR;
+            cd_nelmts = BITGROOM_ABS_FLT_PRM_NBR + 1;
+            if (H5Pget_filter_by_id2(dcplid, (H5Z_filter_t)BITGROOM_ID, &flags, &cd_nelmts,
+                                     cd_values_in, 0, NULL, NULL) < 0) ERR;
+            if (cd_nelmts != prm_nbr) ERR;
+            if (cd_values_in[0] != cd_values[0] || cd_values_in[1] != sizeof(float)) ERR;
+            if (a && memcmp(&cd_values_in[5], &abs_err, sizeof(double))) ERR;
+            if (H5Pclose(dcplid) < 0 ||
+                H5Dclose(datasetid) < 0 ||
+                H5Pclose(plistid) < 0) ERR;
+        }
+        if (H5Sclose(spaceid) < 0 ||
+            H5Fclose(fileid) < 0) ERR;
+    }
+    SUMMARIZE_ERR;
     FINAL_RESULTS;
 }
@@ -0,0 +1,292 @@
+/*
+ * This is a test in the Community Codec Repository.
+ *
+ * This test checks the BitPack filter stores the retained bits of
+ * every value in its bit stream, for single and double precision,
+ * every number of dropped bits, and lengths across whole and partial
+ * groups, stores values with non-zero dropped bits in full, and
+ * restores every value exactly. Words and exception values are
+ * little-endian on every host.
+ */
+
+#include "config.h"
+#include "ccr_test.h"
+#include "tst_h_utils.h"
+#include <hdf5.h>
+#include <string.h>
+
+/* Err is used to keep track of errors within each set of tests,
+ * total_err is the number of errors in the entire test program, which
+ * generally cosists of several sets of tests. */
+static int total_err = 0, err = 0;
+
+#define FILE_NAME "tst_h_bitpack.h5"
+#define NVAL 1027 /* Four whole groups and three values */
+#define NX 60
+#define NY 120
+#define HDR_SZ 24 /* H5Zbitpack.c: CCR_BPK_HDR_SZ */
+#define GRP_NBR 256 /* H5Zbitpack.c: CCR_BPK_GRP_NBR */
+#define GRP_BYT 32 /* H5Zbitpack.c: CCR_BPK_GRP_BYT */
+#define NSB 9 /* Explicit mantissa bits BitRound keeps */
+#define FILL_VALUE -999.99f /* Uses all its mantissa bits */
+
+size_t H5Z_filter_bitpack(unsigned int flags, size_t cd_nelmts,
+                          const unsigned int cd_values[], size_t nbytes,
+                          size_t *buf_size, void **buf);
+
+/* Read a value or word of datum_size bytes. */
+static unsigned long long
+bpk_get(const unsigned char *p, size_t datum_size)
+{
+    unsigned int u32;
+    unsigned long long u64;
+
+    if (datum_size == 4)
+    {
+        memcpy(&u32, p, 4);
+        return u32;
+    }
+    memcpy(&u64, p, 8);
+    return u64;
+}
+
+/* Read a stored, little-endian, word or value of datum_size bytes. */
+static unsigned long long
+bpk_get_le(const unsigned char *p, size_t datum_size)
+{
+    unsigned long long val = 0;
+    size_t b;
+
+    for (b = datum_size; b > 0; b--)
+        val = val << 8 | p[b - 1];
+    return val;
+}
+
+/* Return 0 if buf, of size pck_sz, holds the nbytes of ref packed
+ * with drp dropped bits, as documented in H5Zbitpack.c. */
+static int
+bpk_cmp(const unsigned char *buf, size_t pck_sz, const unsigned char *ref,
+        size_t datum_size, int drp, size_t nbytes)
+{
+    size_t elm_nbr = nbytes / datum_size, tail = nbytes % datum_size;
+    size_t wrd_bit = 8 * datum_size, w = wrd_bit - drp;
+    size_t lan_nbr = GRP_BYT / datum_size, grp_nbr = elm_nbr / GRP_NBR;
+    size_t pck_end = HDR_SZ + grp_nbr * GRP_BYT * w +
+        ((elm_nbr - grp_nbr * GRP_NBR) * w + wrd_bit - 1) / wrd_bit * datum_size;
+    size_t xcp_nbr = 0, xcp_idx = 0, i, b, bit, off;
+    unsigned long long val, wrd, xcp_cnt = 0;
+
+    if (memcmp(buf, "CBP", 3) || buf[4] != datum_size || buf[5] != drp || buf[6] != 1)
+        return 1;
+    for (b = 0; b < 8; b++)
+        xcp_cnt = xcp_cnt << 8 | buf[16 + b];
+    for (i = 0; i < elm_nbr; i++)
+        if (drp && bpk_get(ref + i * datum_size, datum_size) << (64 - drp))
+            xcp_nbr++;
+    if (xcp_cnt != xcp_nbr || pck_sz != pck_end + xcp_nbr * (4 + datum_size) + tail)
+        return 1;
+    for (i = 0; i < elm_nbr; i++)
+    {
+        val = bpk_get(ref + i * datum_size, datum_size) >> drp;
+        for (b = 0; b < w; b++)
+        {
+            /* Value i of a group is value i / lanes of lane i % lanes,
+             * left over values form one stream. */
+            if (i < grp_nbr * GRP_NBR)
+            {
+                bit = i % GRP_NBR / lan_nbr * w + b;
+                off = HDR_SZ + i / GRP_NBR * GRP_BYT * w +
+                    (bit / wrd_bit * lan_nbr + i % GRP_NBR % lan_nbr) * datum_size;
+            }
+            else
+            {
+                bit = (i - grp_nbr * GRP_NBR) * w + b;
+                off = HDR_SZ + grp_nbr * GRP_BYT * w + bit / wrd_bit * datum_size;
+            }
+            wrd = bpk_get_le(buf + off, datum_size);
+            if ((wrd >> (bit % wrd_bit) & 1) != (val >> b & 1))
+                return 1;
+        }
+        /* Exceptions follow the streams, indices then values. */
+        if (drp && bpk_get(ref + i * datum_size, datum_size) << (64 - drp))
+        {
+            const unsigned char *p = buf + pck_end + 4 * xcp_idx;
+            if (((size_t)p[0] << 24 | (size_t)p[1] << 16 | (size_t)p[2] << 8 | p[3]) != i)
+                return 1;
+            if (bpk_get_le(buf + pck_end + 4 * xcp_nbr + xcp_idx * datum_size, datum_size) !=
+                bpk_get(ref + i * datum_size, datum_size))
+                return 1;
+            xcp_idx++;
+        }
+    }
+    return memcmp(buf + pck_sz - tail, ref + elm_nbr * datum_size, tail);
+}
+
+int
+main()
+{
+    printf("\n*** Checking BitPack filter.\n");
+    printf("*** Checking BitPack layout for every number of dropped bits...");
+    {
+        /* The vector kernels pack whole groups and the scalar code
+         * the values left over, so check every bit against the
+         * definition, for lengths within, at, and past group ends,
+         * with and without bytes left over. Most values have their
+         * dropped bits zeroed, the rest are exceptions. */
+        size_t datum_size[2] = {4, 8};
+        unsigned int cd_values[BITPACK_FLT_PRM_NBR];
+        unsigned char *buf, *ref;
+        unsigned long long val;
+        size_t nbytes, pck_sz, i;
+        int d, drp, sz, lft;
+
+        for (d = 0; d < 2; d++)
+        {
+            int mnt = datum_size[d] == 4 ? 23 : 52;
+            cd_values[1] = datum_size[d];
+            for (drp = 0; drp <= mnt; drp++)
+            {
+                /* No kept bits asks the filter to choose. */
+                cd_values[0] = mnt - drp;
+                for (sz = NVAL - 300; sz <= NVAL; sz += 37)
+                {
+                    for (lft = 0; lft < 2; lft++)
+                    {
+                        nbytes = sz * datum_size[d] + (lft ? datum_size[d] - 1 : 0);
+                        if (!(buf = malloc(nbytes))) ERR;
+                        if (!(ref = malloc(nbytes))) ERR;
+                        for (i = 0; i < nbytes; i++)
+                            ref[i] = (unsigned char)(i * 7 + i / 251 + drp);
+                        for (i = 0; i < (size_t)sz; i++)
+                        {
+                            if (i % 13 == 5)
+                                continue;
+                            val = bpk_get(ref + i * datum_size[d], datum_size[d]);
+                            val = drp ? val >> drp << drp : val;
+                            if (datum_size[d] == 4)
+                            {
+                                unsigned int u32 = (unsigned int)val;
+                                memcpy(ref + i * 4, &u32, 4);
+                            }
+                            else
+                                memcpy(ref + i * 8, &val, 8);
+                        }
+                        memcpy(buf, ref, nbytes);
+                        if (!(pck_sz = tst_h_enc(H5Z_filter_bitpack, BITPACK_FLT_PRM_NBR, cd_values, (void **)&buf, nbytes))) ERR;
+                        if (drp < mnt && buf[5] != drp) ERR;
+                        if (bpk_cmp(buf, pck_sz, ref, datum_size[d], buf[5], nbytes)) ERR;
+                        if (tst_h_dec(H5Z_filter_bitpack, BITPACK_FLT_PRM_NBR, cd_values, (void **)&buf, pck_sz) != nbytes) ERR;
+                        if (memcmp(buf, ref, nbytes)) ERR;
+                        free(buf);
+                        free(ref);
+                    }
+                }
+            }
+        }
+    }
+    SUMMARIZE_ERR;
+    printf("*** Checking BitPack chooses dropped bits of quantized values with fill values...");
+    {
+        unsigned int cd_values[BITPACK_FLT_PRM_NBR] = {0, sizeof(float)};
+        float *fp;
+        unsigned char *buf;
+        unsigned int u;
+        size_t nbytes = NVAL * sizeof(float), pck_sz;
+        int i, fill_nbr = 0;
+
+        /* Quantize as BitRound does, leaving fill values intact. */
+        if (!(fp = malloc(nbytes))) ERR;
+        for (i = 0; i < NVAL; i++)
+        {
+            fp[i] = 273.15f + 0.37f * i - 0.011f * (i % 97) * (i % 89);
+            memcpy(&u, &fp[i], sizeof(u));
+            u &= ~((1u << (23 - NSB)) - 1);
+            memcpy(&fp[i], &u, sizeof(u));
+            if (i % 50 == 0)
+            {
+                fp[i] = FILL_VALUE;
+                fill_nbr++;
+            }
+        }
+        if (!(buf = malloc(nbytes))) ERR;
+        memcpy(buf, fp, nbytes);
+
+        /* Every value keeps its sign, exponent, and NSB bits, and
+         * fill values are exceptions. */
+        if (!(pck_sz = tst_h_enc(H5Z_filter_bitpack, BITPACK_FLT_PRM_NBR, cd_values, (void **)&buf, nbytes))) ERR;
+        if (buf[5] != 23 - NSB) ERR;
+        if (bpk_cmp(buf, pck_sz, (unsigned char *)fp, sizeof(float), 23 - NSB, nbytes)) ERR;
+        if (pck_sz != HDR_SZ + (NVAL * (9 + NSB) + 31) / 32 * 4 + (size_t)fill_nbr * 8) ERR;
+        if (tst_h_dec(H5Z_filter_bitpack, BITPACK_FLT_PRM_NBR, cd_values, (void **)&buf, pck_sz) != nbytes) ERR;
+        if (memcmp(buf, fp, nbytes)) ERR;
+
+        /* A chunk of zeros keeps one bit per value. */
+        memset(buf, 0, nbytes);
+        if (!(pck_sz = tst_h_enc(H5Z_filter_bitpack, BITPACK_FLT_PRM_NBR, cd_values, (void **)&buf, nbytes))) ERR;
+        if (pck_sz != HDR_SZ + (NVAL + 31) / 32 * 4) ERR;
+        if (tst_h_dec(H5Z_filter_bitpack, BITPACK_FLT_PRM_NBR, cd_values, (void **)&buf, pck_sz) != nbytes) ERR;
+        for (i = 0; i < (int)nbytes; i++)
+            if (buf[i]) ERR;
+        free(buf);
+        free(fp);
+    }
+    SUMMARIZE_ERR;
+    printf("*** Checking BitPack rejects invalid parameters and chunks...");
+    {
+        unsigned int cd_values[BITPACK_FLT_PRM_NBR] = {0, 2};
+        size_t buf_size = NVAL, pck_sz;
+        unsigned char *buf;
+        void *vbuf;
+
+        if (!(buf = calloc(NVAL, 4))) ERR;
+        vbuf = buf;
+        if (H5Z_filter_bitpack(0, BITPACK_FLT_PRM_NBR, cd_values, NVAL, &buf_size, &vbuf)) ERR;
+        cd_values[1] = 4;
+        if (H5Z_filter_bitpack(0, 1, cd_values, NVAL, &buf_size, &vbuf)) ERR;
+
+        /* Chunks without a header, of another datum size, or of the
+         * wrong length, are not unpacked. */
+        if (tst_h_dec(H5Z_filter_bitpack, BITPACK_FLT_PRM_NBR, cd_values, &vbuf, NVAL)) ERR;
+        if (!(pck_sz = tst_h_enc(H5Z_filter_bitpack, BITPACK_FLT_PRM_NBR, cd_values, &vbuf, NVAL * 4))) ERR;
+        if (tst_h_corrupt(H5Z_filter_bitpack, BITPACK_FLT_PRM_NBR, cd_values, &vbuf, pck_sz, HDR_SZ, 3)) ERR;
+        cd_values[1] = 8;
+        if (tst_h_dec(H5Z_filter_bitpack, BITPACK_FLT_PRM_NBR, cd_values, &vbuf, pck_sz)) ERR;
+        free(vbuf);
+    }
+    SUMMARIZE_ERR;
+    printf("*** Checking BitPack through an HDF5 dataset of quantized values...");
+    {
+        hsize_t dimsize[2] = {NX, NY};
+        hsize_t chunksize[2] = {NX / 2, NY / 2};
+        unsigned int cd_values[BITPACK_FLT_PRM_NBR] = {0, 0};
+        size_t cd_nelmts = BITPACK_FLT_PRM_NBR;
+        float data_out[NX][NY], data_in[NX][NY];
+        hsize_t storage_size;
+        unsigned int u;
+        int x, y;
+
+        /* Quantize as BitRound does, so the trailing mantissa bits
+         * of every value are zero. */
+        for (x = 0; x < NX; x++)
+            for (y = 0; y < NY; y++)
+            {
+                data_out[x][y] = 273.15f + 0.37f * x - 0.011f * y * y / NY;
+                memcpy(&u, &data_out[x][y], sizeof(u));
+                u &= ~((1u << (23 - NSB)) - 1);
+                memcpy(&data_out[x][y], &u, sizeof(u));
+            }
+
+        /* Users set no parameters, and no compressor follows. */
+        if (tst_h_dset_rt(FILE_NAME, BITPACK_ID, &cd_nelmts, cd_values, 0, H5T_NATIVE_FLOAT,
+                          NULL, dimsize, chunksize, data_out, data_in, &storage_size)) ERR;
+        if (cd_values[1] != sizeof(float)) ERR;
+
+        /* Each value takes 9 + NSB of its 32 bits, plus headers. */
+        if (storage_size > NX * NY * (9 + NSB) / 8 + 4 * (HDR_SZ + 8)) ERR;
+        for (x = 0; x < NX; x++)
+            for (y = 0; y < NY; y++)
+                if (data_in[x][y] != data_out[x][y]) ERR;
+    }
+    SUMMARIZE_ERR;
+    FINAL_RESULTS;
+}
@@ -0,0 +1,280 @@
+/*
+ * This is a test in the Community Codec Repository.
+ *
+ * This test checks the BitRound filter rounds to the nearest value
+ * with the requested number of explicit mantissa bits.
+ */
+
+#include "config.h"
+#include "ccr_test.h"
+#include <hdf5.h>
+#include <math.h>
+#include <string.h>
+
+/* Err is used to keep track of errors within each set of tests,
+ * total_err is the number of errors in the entire test program, which
+ * generally cosists of several sets of tests. */
+static int total_err = 0, err = 0;
+
+#define NBIG 1000003 /* Spans many multithreading slices */
+#define NVAL 4099
+#define NAUTO 65536 /* Enough pairs to estimate information reliably */
+#define NSMALL 100 /* Too few pairs to estimate information */
+#define MSS_VAL -999.0
+#define FILE_NAME "tst_h_bitround.h5"
+#define NX 60
+#define NY 120
+
+size_t H5Z_filter_bitround(unsigned int flags, size_t cd_nelmts,
+                           const unsigned int cd_values[], size_t nbytes,
+                           size_t *buf_size, void **buf);
+
+/* Normal values spanning most of the exponent range, plus fill
+ * values, zeros, and negative zeros. */
+static double
+btr_tst_val(int i, int is_flt)
+{
+    const int xpn_max = is_flt ? 30 : 300;
+
+    switch (i % 8)
+    {
+    case 0:
+        return MSS_VAL;
+    case 1:
+        return (i % 3) ? 0.0 : -0.0;
+    default:
+        return sin(i) * pow(10.0, i % (2 * xpn_max) - xpn_max);
+    }
+}
+
+/* Run BitRound with automatic NSB on nval floats at information
+ * level inf_lvl [ppm], and return the most explicit mantissa bits
+ * retained by any value. */
+static int
+btr_auto_flt(float *fp, size_t nval, unsigned int inf_lvl)
+{
+    const float mss_val_flt = MSS_VAL;
+    unsigned int cd_values[BITROUND_AUTO_FLT_PRM_NBR] = {0, sizeof(float), 1, 0, 0, 0};
+    unsigned int *u32p = (unsigned int *)fp;
+    size_t nbytes = nval * sizeof(float);
+    void *buf = fp;
+    size_t i;
+    int nsb, nsb_max = 0;
+
+    memcpy(&cd_values[3], &mss_val_flt, sizeof(float));
+    cd_values[5] = inf_lvl;
+    if (H5Z_filter_bitround(0, BITROUND_AUTO_FLT_PRM_NBR, cd_values, nbytes,
+                            &nbytes, &buf) != nval * sizeof(float)) return -1;
+    for (i = 0; i < nval; i++)
+    {
+        if (fp[i] == mss_val_flt)
+            continue;
+        for (nsb = 23; nsb > 0 && !(u32p[i] & (1U << (23 - nsb))); nsb--)
+            ;
+        if (nsb > nsb_max)
+            nsb_max = nsb;
+    }
+    return nsb_max;
+}
+
+int
+main()
+{
+    printf("\n*** Checking BitRound filter.\n");
+    printf("*** Checking BitRound rounds to nearest retained bit...");
+    {
+        const float mss_val_flt = MSS_VAL;
+        const double mss_val_dbl = MSS_VAL;
+        unsigned int cd_values[BITROUND_FLT_PRM_NBR + 1] = {0, 0, 1, 0, 0, 0};
+        unsigned int *u32p;
+        unsigned long long *u64p;
+        float *fp;
+        double *dp;
+        double val;
+        size_t nbytes;
+        void *buf;
+        int i, nsb;
+
+        if (!(fp = malloc(NVAL * sizeof(float)))) ERR;
+        if (!(dp = malloc(NVAL * sizeof(double)))) ERR;
+        u32p = (unsigned int *)fp;
+        u64p = (unsigned long long *)dp;
+
+        /* Single precision. NSB = 23 keeps every bit. */
+        for (nsb = 1; nsb <= 23; nsb++)
+        {
+            for (i = 0; i < NVAL; i++)
+                fp[i] = btr_tst_val(i, 1);
+            cd_values[0] = nsb;
+            cd_values[1] = sizeof(float);
+            memcpy(&cd_values[3], &mss_val_flt, sizeof(float));
+            nbytes = NVAL * sizeof(float);
+            buf = fp;
+            if (H5Z_filter_bitround(0, BITROUND_FLT_PRM_NBR, cd_values, nbytes,
+                                    &nbytes, &buf) != NVAL * sizeof(float)) ERR;
+            for (i = 0; i < NVAL; i++)
+            {
+                val = (float)btr_tst_val(i, 1);
+                if (val == MSS_VAL || val == 0.0)
+                {
+                    if (memcmp(&fp[i], &(float){val}, sizeof(float))) ERR;
+                    continue;
+                }
+                if (u32p[i] & ~(~0U << (23 - nsb))) ERR;
+                if (fabs(fp[i] - val) > ldexp(fabs(val), -(nsb + 1))) ERR;
+            }
+        }
+
+        /* Double precision. NSB = 52 keeps every bit. */
+        for (nsb = 1; nsb <= 52; nsb++)
+        {
+            for (i = 0; i < NVAL; i++)
+                dp[i] = btr_tst_val(i, 0);
+            cd_values[0] = nsb;
+            cd_values[1] = sizeof(double);
+            memcpy(&cd_values[3], &mss_val_dbl, sizeof(double));
+            nbytes = NVAL * sizeof(double);
+            buf = dp;
+            if (H5Z_filter_bitround(0, BITROUND_FLT_PRM_NBR, cd_values, nbytes,
+                                    &nbytes, &buf) != NVAL * sizeof(double)) ERR;
+            for (i = 0; i < NVAL; i++)
+            {
+                val = btr_tst_val(i, 0);
+                if (val == MSS_VAL || val == 0.0)
+                {
+                    if (memcmp(&dp[i], &val, sizeof(double))) ERR;
+                    continue;
+                }
+                if (u64p[i] & ~(~0ULL << (52 - nsb))) ERR;
+                if (fabs(dp[i] - val) > ldexp(fabs(val), -(nsb + 1))) ERR;
+            }
+        }
+        free(fp);
+        free(dp);
+    }
+    SUMMARIZE_ERR;
+    printf("*** Checking threaded BitRound matches single-threaded...");
+    {
+        /* Large enough for many slices, odd so the last slice is short. */
+        const double mss_val_dbl = MSS_VAL;
+        unsigned int cd_values[BITROUND_FLT_PRM_NBR + 1] = {7, sizeof(double), 1, 0, 0, 0};
+        double *dp, *dp_thr;
+        size_t nbytes;
+        void *buf;
+        int i;
+
+        if (!(dp = malloc(NBIG * sizeof(double)))) ERR;
+        if (!(dp_thr = malloc(NBIG * sizeof(double)))) ERR;
+        for (i = 0; i < NBIG; i++)
+            dp[i] = dp_thr[i] = (i % 17 == 0) ? mss_val_dbl : 273.15 + 50.0 * sin(i * 1.0e-3);
+        memcpy(&cd_values[3], &mss_val_dbl, sizeof(double));
+
+        if (setenv("CCR_THR_NBR", "1", 1)) ERR;
+        nbytes = NBIG * sizeof(double);
+        buf = dp;
+        if (H5Z_filter_bitround(0, BITROUND_FLT_PRM_NBR, cd_values, nbytes, &nbytes, &buf) != NBIG * sizeof(double)) ERR;
+        if (setenv("CCR_THR_NBR", "4", 1)) ERR;
+        nbytes = NBIG * sizeof(double);
+        buf = dp_thr;
+        if (H5Z_filter_bitround(0, BITROUND_FLT_PRM_NBR, cd_values, nbytes, &nbytes, &buf) != NBIG * sizeof(double)) ERR;
+        if (unsetenv("CCR_THR_NBR")) ERR;
+        if (memcmp(dp, dp_thr, NBIG * sizeof(double))) ERR;
+        free(dp);
+        free(dp_thr);
+    }
+    SUMMARIZE_ERR;
+    printf("*** Checking BitRound chooses NSB from information content...");
+    {
+        const unsigned int inf_lvl[] = {900000, 990000, 999900};
+        float *fp, *fp_in;
+        int i, l, nsb, nsb_prv = 0;
+
+        if (!(fp = malloc(NAUTO * sizeof(float)))) ERR;
+        if (!(fp_in = malloc(NAUTO * sizeof(float)))) ERR;
+        for (i = 0; i < NAUTO; i++)
+            fp_in[i] = (i % 17 == 0) ? MSS_VAL : 273.15 + 50.0 * sin(i * 1.0e-3);
+
+        /* Smooth data keep more bits at higher information levels,
+         * yet fewer than all of them, and round to nearest. */
+        for (l = 0; l < sizeof(inf_lvl) / sizeof(inf_lvl[0]); l++)
+        {
+            memcpy(fp, fp_in, NAUTO * sizeof(float));
+            if ((nsb = btr_auto_flt(fp, NAUTO, inf_lvl[l])) < 1 || nsb >= 23) ERR;
+            if (nsb < nsb_prv) ERR;
+            nsb_prv = nsb;
+            for (i = 0; i < NAUTO; i++)
+            {
+                if (fp_in[i] == MSS_VAL)
+                {
+                    if (fp[i] != fp_in[i]) ERR;
+                    continue;
+                }
+                if (fabs(fp[i] - fp_in[i]) > ldexp(fabs(fp_in[i]), -(nsb + 1))) ERR;
+            }
+        }
+        if (nsb_prv <= btr_auto_flt(memcpy(fp, fp_in, NAUTO * sizeof(float)), NAUTO, 500000)) ERR;
+
+        /* Noise has no real information, so keeps one bit. */
+        for (i = 0; i < NAUTO; i++)
+            fp[i] = 1.0 + rand() / (RAND_MAX + 1.0);
+        if (btr_auto_flt(fp, NAUTO, 999900) != 1) ERR;
+
+        /* Constant data, and too few values, are not quantized. */
+        for (i = 0; i < NAUTO; i++)
+            fp[i] = fp_in[1];
+        if (btr_auto_flt(fp, NAUTO, 990000) < 0) ERR;
+        for (i = 0; i < NAUTO; i++)
+            if (fp[i] != fp_in[1]) ERR;
+        memcpy(fp, fp_in, NSMALL * sizeof(float));
+        if (btr_auto_flt(fp, NSMALL, 990000) < 0) ERR;
+        if (memcmp(fp, fp_in, NSMALL * sizeof(float))) ERR;
+        free(fp);
+        free(fp_in);
+    }
+    SUMMARIZE_ERR;
+    printf("*** Checking BitRound stores a sixth parameter only for automatic NSB...");
+    {
+        /* Readers that predate automatic NSB accept only five
+         * parameters, so fixed NSB must not store the sixth. */
+        hid_t fileid, datasetid, spaceid, plistid, dcplid;
+        hsize_t dimsize[2] = {NX, NY};
+        hsize_t chunksize[2] = {NX / 2, NY / 2};
+        unsigned int cd_values[BITROUND_AUTO_FLT_PRM_NBR] = {10, 0, 0, 0, 0, 0};
+        unsigned int cd_values_in[BITROUND_AUTO_FLT_PRM_NBR + 1];
+        size_t cd_nelmts;
+        unsigned int flags;
+        int a;
+
+        /* Loads the plugin, as nc_def_var_bitround() does. */
+        if (!H5Zfilter_avail(BITROUND_ID)) ERR;
+        if ((fileid = H5Fcreate(FILE_NAME, H5F_ACC_TRUNC, H5P_DEFAULT, H5P_DEFAULT)) < 0) ERR;
+        if ((spaceid = H5Screate_simple(2, dimsize, NULL)) < 0) ERR;
+        for (a = 0; a < 2; a++)
+        {
+            size_t prm_nbr = a ? BITROUND_AUTO_FLT_PRM_NBR : BITROUND_FLT_PRM_NBR;
+
+            cd_values[0] = a ? 0 : 10;
+            cd_values[5] = a ? 990000 : 0;
+            if ((plistid = H5Pcreate(H5P_DATASET_CREATE)) < 0) ERR;
+            if (H5Pset_chunk(plistid, 2, chunksize) < 0) ERR;
+            if (H5Pset_filter(plistid, (H5Z_filter_t)BITROUND_ID, H5Z_FLAG_MANDATORY,
+                              prm_nbr, cd_values) < 0) ERR;
+            if ((datasetid = H5Dcreate2(fileid, a ? "auto" : "fixed", H5T_IEEE_F32LE, spaceid,
+                                        H5P_DEFAULT, plistid, H5P_DEFAULT)) < 0) ERR;
+            if ((dcplid = H5Dget_create_plist(datasetid)) < 0) ERR;
+            cd_nelmts = BITROUND_AUTO_FLT_PRM_NBR + 1;
+            if (H5Pget_filter_by_id2(dcplid, (H5Z_filter_t)BITROUND_ID, &flags, &cd_nelmts,
+                                     cd_values_in, 0, NULL, NULL) < 0) ERR;
+            if (cd_nelmts != prm_nbr) ERR;
+            if (cd_values_in[0] != cd_values[0] || cd_values_in[1] != sizeof(float)) ERR;
+            if (a && cd_values_in[5] != 990000) ERR;
+            if (H5Pclose(dcplid) < 0 ||
+                H5Dclose(datasetid) < 0 ||
+                H5Pclose(plistid) < 0) ERR;
+        }
+        if (H5Sclose(spaceid) < 0 ||
+            H5Fclose(fileid) < 0) ERR;
+    }
+    SUMMARIZE_ERR;
+    FINAL_RESULTS;
+}
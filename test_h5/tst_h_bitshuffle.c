@@ -0,0 +1,221 @@
+/*
+ * This is a test in the Community Codec Repository.
+ *
+ * This test checks the Bitshuffle filter stores every bit of every
+ * value in its bit plane, block by block, for every datum size,
+ * block size, and remainder length, restores every value exactly,
+ * and turns the zeroed bits of quantized values into planes of zeros.
+ */
+
+#include "config.h"
+#include "ccr_test.h"
+#include "tst_h_utils.h"
+#include <hdf5.h>
+#include <string.h>
+
+/* Err is used to keep track of errors within each set of tests,
+ * total_err is the number of errors in the entire test program, which
+ * generally cosists of several sets of tests. */
+static int total_err = 0, err = 0;
+
+#define FILE_NAME "tst_h_bitshuffle.h5"
+#define NVAL 1027 /* Odd, and not a multiple of any SIMD width */
+#define NX 60
+#define NY 120
+#define BLK_BYT_DFL 8192 /* H5Zbitshuffle.c: CCR_BSH_BLK_BYT_DFL */
+#define BLK_NBR_MIN 128 /* H5Zbitshuffle.c: CCR_BSH_BLK_NBR_MIN */
+#define NSB_ZRO 14 /* Trailing mantissa bits zeroed, as BitRound keeping 9 bits */
+
+size_t H5Z_filter_bitshuffle(unsigned int flags, size_t cd_nelmts,
+                             const unsigned int cd_values[], size_t nbytes,
+                             size_t *buf_size, void **buf);
+
+/* Return 0 if buf holds ref bitshuffled as documented in
+ * H5Zbitshuffle.c. */
+static int
+bsh_cmp(const unsigned char *buf, const unsigned char *ref, size_t datum_size,
+        size_t block_size, size_t nbytes)
+{
+    size_t elm_nbr = nbytes / datum_size;
+    size_t blk_srt, blk_nbr, i, b, k, pln_sz;
+
+    if (!block_size)
+    {
+        block_size = BLK_BYT_DFL / datum_size;
+        block_size -= block_size % 8;
+        if (block_size < BLK_NBR_MIN)
+            block_size = BLK_NBR_MIN;
+    }
+    for (blk_srt = 0; elm_nbr - blk_srt >= 8; blk_srt += blk_nbr)
+    {
+        blk_nbr = elm_nbr - blk_srt < block_size ? (elm_nbr - blk_srt) / 8 * 8 : block_size;
+        pln_sz = blk_nbr / 8;
+        for (i = 0; i < blk_nbr; i++)
+            for (b = 0; b < datum_size; b++)
+                for (k = 0; k < 8; k++)
+                {
+                    int bit_ref = (ref[(blk_srt + i) * datum_size + b] >> k) & 1;
+                    int bit = (buf[blk_srt * datum_size + (8 * b + k) * pln_sz + i / 8] >> (i % 8)) & 1;
+                    if (bit != bit_ref)
+                        return 1;
+                }
+    }
+    /* Values that do not fill a group of 8, and trailing bytes,
+     * stay where they are. */
+    return memcmp(buf + blk_srt * datum_size, ref + blk_srt * datum_size,
+                  nbytes - blk_srt * datum_size);
+}
+
+int
+main()
+{
+    printf("\n*** Checking Bitshuffle filter.\n");
+    printf("*** Checking Bitshuffle layout for every datum size and remainder length...");
+    {
+        /* The vector kernels handle whole vector widths and the
+         * scalar kernel the rest, so check every bit against the
+         * definition, for chunks ending at every group of 8 values
+         * within the widest vector, in default and short blocks, with
+         * and without values and bytes left over. */
+        size_t datum_size[6] = {1, 2, 3, 4, 8, 16};
+        size_t block_size[3] = {0, 64, 136};
+        unsigned int cd_values[BITSHUFFLE_FLT_PRM_NBR];
+        unsigned char *buf, *ref;
+        size_t nbytes, i;
+        int d, s, sz, lft;
+
+        for (d = 0; d < 6; d++)
+        {
+            for (s = 0; s < 3; s++)
+            {
+                cd_values[0] = datum_size[d];
+                cd_values[1] = block_size[s];
+                for (sz = NVAL - 130; sz <= NVAL; sz++)
+                {
+                    for (lft = 0; lft < 2; lft++)
+                    {
+                        nbytes = sz * datum_size[d] + (lft ? datum_size[d] - 1 : 0);
+                        if (!(buf = malloc(nbytes))) ERR;
+                        if (!(ref = malloc(nbytes))) ERR;
+                        for (i = 0; i < nbytes; i++)
+                            ref[i] = (unsigned char)(i * 7 + i / 251);
+                        memcpy(buf, ref, nbytes);
+                        if (tst_h_enc(H5Z_filter_bitshuffle, BITSHUFFLE_FLT_PRM_NBR, cd_values, (void **)&buf, nbytes) != nbytes) ERR;
+                        if (bsh_cmp(buf, ref, datum_size[d], block_size[s], nbytes)) ERR;
+                        if (tst_h_dec(H5Z_filter_bitshuffle, BITSHUFFLE_FLT_PRM_NBR, cd_values, (void **)&buf, nbytes) != nbytes) ERR;
+                        if (memcmp(buf, ref, nbytes)) ERR;
+                        free(buf);
+                        free(ref);
+                    }
+                }
+            }
+        }
+    }
+    SUMMARIZE_ERR;
+    printf("*** Checking Bitshuffle leaves chunks of fewer than 8 values unchanged...");
+    {
+        unsigned int cd_values[BITSHUFFLE_FLT_PRM_NBR] = {4, 0};
+        unsigned char *buf;
+        size_t i;
+
+        if (!(buf = malloc(NVAL))) ERR;
+        for (i = 0; i < NVAL; i++)
+            buf[i] = (unsigned char)i;
+        if (tst_h_enc(H5Z_filter_bitshuffle, BITSHUFFLE_FLT_PRM_NBR, cd_values, (void **)&buf, 28) != 28) ERR;
+        cd_values[0] = 1;
+        if (tst_h_enc(H5Z_filter_bitshuffle, BITSHUFFLE_FLT_PRM_NBR, cd_values, (void **)&buf, 7) != 7) ERR;
+        cd_values[0] = 8;
+        if (tst_h_dec(H5Z_filter_bitshuffle, BITSHUFFLE_FLT_PRM_NBR, cd_values, (void **)&buf, 60) != 60) ERR;
+        for (i = 0; i < NVAL; i++)
+            if (buf[i] != (unsigned char)i) ERR;
+        free(buf);
+    }
+    SUMMARIZE_ERR;
+    printf("*** Checking Bitshuffle rejects invalid parameters...");
+    {
+        unsigned int cd_values[BITSHUFFLE_FLT_PRM_NBR] = {0, 0};
+        size_t buf_size = NVAL;
+        void *buf;
+
+        if (!(buf = malloc(NVAL))) ERR;
+        if (H5Z_filter_bitshuffle(0, BITSHUFFLE_FLT_PRM_NBR, cd_values, NVAL, &buf_size, &buf)) ERR;
+        cd_values[0] = 4;
+        cd_values[1] = 12;
+        if (H5Z_filter_bitshuffle(0, BITSHUFFLE_FLT_PRM_NBR, cd_values, NVAL, &buf_size, &buf)) ERR;
+        cd_values[1] = 0;
+        if (H5Z_filter_bitshuffle(0, 1, cd_values, NVAL, &buf_size, &buf)) ERR;
+        free(buf);
+    }
+    SUMMARIZE_ERR;
+    printf("*** Checking Bitshuffle turns zeroed mantissa bits into zero planes...");
+    {
+        unsigned int cd_values[BITSHUFFLE_FLT_PRM_NBR] = {sizeof(float), 0};
+        float *fp;
+        unsigned char *pln;
+        unsigned int u;
+        size_t pln_sz;
+        int block_size = BLK_BYT_DFL / sizeof(float);
+        int i, k;
+
+        /* Two whole blocks, so every plane is block_size / 8 bytes. */
+        if (!(fp = malloc(2 * block_size * sizeof(float)))) ERR;
+        for (i = 0; i < 2 * block_size; i++)
+        {
+            fp[i] = 273.15f + 0.37f * i - 0.011f * (i % 97) * (i % 89);
+            memcpy(&u, &fp[i], sizeof(u));
+            u &= ~((1u << NSB_ZRO) - 1);
+            memcpy(&fp[i], &u, sizeof(u));
+        }
+        if (tst_h_enc(H5Z_filter_bitshuffle, BITSHUFFLE_FLT_PRM_NBR, cd_values, (void **)&fp, 2 * block_size * sizeof(float)) != 2 * block_size * sizeof(float)) ERR;
+        pln_sz = block_size / 8;
+        for (i = 0; i < 2; i++)
+        {
+            /* Planes of the zeroed bits are zero, the next is not. */
+            pln = (unsigned char *)fp + i * block_size * sizeof(float);
+            for (k = 0; k < NSB_ZRO * pln_sz; k++)
+                if (pln[k]) ERR;
+            for (k = NSB_ZRO * pln_sz; k < (NSB_ZRO + 1) * pln_sz; k++)
+                if (pln[k])
+                    break;
+            if (k == (NSB_ZRO + 1) * pln_sz) ERR;
+        }
+        free(fp);
+    }
+    SUMMARIZE_ERR;
+    printf("*** Checking Bitshuffle through an HDF5 dataset of quantized values...");
+    {
+        hsize_t dimsize[2] = {NX, NY};
+        hsize_t chunksize[2] = {NX / 2, NY / 2 - 1};
+        unsigned int cd_values[BITSHUFFLE_FLT_PRM_NBR] = {0, 0};
+        size_t cd_nelmts = BITSHUFFLE_FLT_PRM_NBR;
+        float data_out[NX][NY], data_in[NX][NY];
+        hsize_t storage_size;
+        unsigned int u;
+        int x, y;
+
+        /* Quantize as BitRound does, so the trailing mantissa bits
+         * of every value are zero. */
+        for (x = 0; x < NX; x++)
+            for (y = 0; y < NY; y++)
+            {
+                data_out[x][y] = 273.15f + 0.37f * x - 0.011f * y * y / NY;
+                memcpy(&u, &data_out[x][y], sizeof(u));
+                u &= ~((1u << NSB_ZRO) - 1);
+                memcpy(&data_out[x][y], &u, sizeof(u));
+            }
+
+        /* Users set no parameters. Bitshuffle is followed by
+         * deflate. */
+        if (tst_h_dset_rt(FILE_NAME, BITSHUFFLE_ID, &cd_nelmts, cd_values, 1, H5T_NATIVE_FLOAT,
+                          NULL, dimsize, chunksize, data_out, data_in, &storage_size)) ERR;
+        if (cd_values[0] != sizeof(float)) ERR;
+
+        /* Planes of zeroed bits cost deflate almost nothing. */
+        if (storage_size >= NX * NY * sizeof(float) / 2) ERR;
+        for (x = 0; x < NX; x++)
+            for (y = 0; y < NY; y++)
+                if (data_in[x][y] != data_out[x][y]) ERR;
+    }
+    SUMMARIZE_ERR;
+    FINAL_RESULTS;
+}
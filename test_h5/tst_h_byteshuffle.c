@@ -0,0 +1,145 @@
+/*
+ * This is a test in the Community Codec Repository.
+ *
+ * This test checks the Byte Shuffle filter lays out chunks exactly as
+ * the HDF5 shuffle filter does, for every datum size and remainder
+ * length, and restores every value exactly.
+ */
+
+#include "config.h"
+#include "ccr_test.h"
+#include "tst_h_utils.h"
+#include <hdf5.h>
+#include <string.h>
+
+/* Err is used to keep track of errors within each set of tests,
+ * total_err is the number of errors in the entire test program, which
+ * generally cosists of several sets of tests. */
+static int total_err = 0, err = 0;
+
+#define FILE_NAME "tst_h_byteshuffle.h5"
+#define NVAL 1027 /* Odd, and not a multiple of any SIMD width */
+#define NX 60
+#define NY 120
+
+size_t H5Z_filter_byteshuffle(unsigned int flags, size_t cd_nelmts,
+                              const unsigned int cd_values[], size_t nbytes,
+                              size_t *buf_size, void **buf);
+
+int
+main()
+{
+    printf("\n*** Checking Byte Shuffle filter.\n");
+    printf("*** Checking Byte Shuffle layout for every datum size and remainder length...");
+    {
+        /* The vector kernels handle whole blocks and the scalar
+         * kernel the rest, so check every byte against the HDF5
+         * shuffle layout, for chunks ending at every offset within
+         * the widest block, with and without trailing bytes that do
+         * not make a whole value. */
+        size_t datum_size[6] = {2, 3, 4, 8, 12, 16};
+        unsigned int cd_values[BYTESHUFFLE_FLT_PRM_NBR];
+        unsigned char *buf, *ref;
+        size_t elm_nbr, nbytes, i, b;
+        int d, sz, lft;
+
+        for (d = 0; d < 6; d++)
+        {
+            cd_values[0] = datum_size[d];
+            for (sz = NVAL - 130; sz <= NVAL; sz++)
+            {
+                for (lft = 0; lft < 2; lft++)
+                {
+                    elm_nbr = sz;
+                    nbytes = elm_nbr * datum_size[d] + (lft ? datum_size[d] - 1 : 0);
+                    if (!(buf = malloc(nbytes))) ERR;
+                    if (!(ref = malloc(nbytes))) ERR;
+                    for (i = 0; i < nbytes; i++)
+                        ref[i] = (unsigned char)(i * 7 + i / 251);
+                    memcpy(buf, ref, nbytes);
+                    if (tst_h_enc(H5Z_filter_byteshuffle, BYTESHUFFLE_FLT_PRM_NBR, cd_values, (void **)&buf, nbytes) != nbytes) ERR;
+                    for (i = 0; i < elm_nbr; i++)
+                        for (b = 0; b < datum_size[d]; b++)
+                            if (buf[b * elm_nbr + i] != ref[i * datum_size[d] + b]) ERR;
+                    /* Trailing bytes stay where they are. */
+                    if (memcmp(buf + elm_nbr * datum_size[d], ref + elm_nbr * datum_size[d],
+                               nbytes - elm_nbr * datum_size[d])) ERR;
+                    if (tst_h_dec(H5Z_filter_byteshuffle, BYTESHUFFLE_FLT_PRM_NBR, cd_values, (void **)&buf, nbytes) != nbytes) ERR;
+                    if (memcmp(buf, ref, nbytes)) ERR;
+                    free(buf);
+                    free(ref);
+                }
+            }
+        }
+    }
+    SUMMARIZE_ERR;
+    printf("*** Checking Byte Shuffle leaves chunks it cannot transpose unchanged...");
+    {
+        unsigned int cd_values[BYTESHUFFLE_FLT_PRM_NBR] = {1};
+        unsigned char *buf;
+        size_t i;
+
+        /* Single bytes. */
+        if (!(buf = malloc(NVAL))) ERR;
+        for (i = 0; i < NVAL; i++)
+            buf[i] = (unsigned char)i;
+        if (tst_h_enc(H5Z_filter_byteshuffle, BYTESHUFFLE_FLT_PRM_NBR, cd_values, (void **)&buf, NVAL) != NVAL) ERR;
+        for (i = 0; i < NVAL; i++)
+            if (buf[i] != (unsigned char)i) ERR;
+
+        /* A single value, and part of one. */
+        cd_values[0] = 8;
+        if (tst_h_enc(H5Z_filter_byteshuffle, BYTESHUFFLE_FLT_PRM_NBR, cd_values, (void **)&buf, 8) != 8) ERR;
+        if (tst_h_enc(H5Z_filter_byteshuffle, BYTESHUFFLE_FLT_PRM_NBR, cd_values, (void **)&buf, 5) != 5) ERR;
+        if (tst_h_dec(H5Z_filter_byteshuffle, BYTESHUFFLE_FLT_PRM_NBR, cd_values, (void **)&buf, 8) != 8) ERR;
+        for (i = 0; i < 8; i++)
+            if (buf[i] != (unsigned char)i) ERR;
+        free(buf);
+    }
+    SUMMARIZE_ERR;
+    printf("*** Checking Byte Shuffle rejects invalid parameters...");
+    {
+        unsigned int cd_values[BYTESHUFFLE_FLT_PRM_NBR] = {0};
+        size_t buf_size = NVAL;
+        void *buf;
+
+        if (!(buf = malloc(NVAL))) ERR;
+        if (H5Z_filter_byteshuffle(0, BYTESHUFFLE_FLT_PRM_NBR, cd_values, NVAL, &buf_size, &buf)) ERR;
+        cd_values[0] = 4;
+        if (H5Z_filter_byteshuffle(0, 0, cd_values, NVAL, &buf_size, &buf)) ERR;
+        free(buf);
+    }
+    SUMMARIZE_ERR;
+    printf("*** Checking Byte Shuffle through an HDF5 dataset...");
+    {
+        hsize_t dimsize[2] = {NX, NY};
+        hsize_t chunksize[2] = {NX / 2, NY / 2 - 1};
+        unsigned int cd_values[BYTESHUFFLE_FLT_PRM_NBR] = {0};
+        size_t cd_nelmts = BYTESHUFFLE_FLT_PRM_NBR;
+        float data_out[NX][NY], data_in[NX][NY];
+        hsize_t storage_size, storage_size2;
+        int x, y;
+
+        for (x = 0; x < NX; x++)
+            for (y = 0; y < NY; y++)
+                data_out[x][y] = 273.15f + 0.01f * (x * NY + y);
+
+        /* Users set no parameters. Write the same data with Byte
+         * Shuffle and with HDF5 shuffle, each followed by deflate. */
+        if (tst_h_dset_rt(FILE_NAME, BYTESHUFFLE_ID, &cd_nelmts, cd_values, 1, H5T_NATIVE_FLOAT,
+                          NULL, dimsize, chunksize, data_out, data_in, &storage_size)) ERR;
+        if (cd_values[0] != sizeof(float)) ERR;
+        for (x = 0; x < NX; x++)
+            for (y = 0; y < NY; y++)
+                if (data_in[x][y] != data_out[x][y]) ERR;
+        cd_nelmts = 0;
+        if (tst_h_dset_rt(FILE_NAME, H5Z_FILTER_SHUFFLE, &cd_nelmts, cd_values, 1, H5T_NATIVE_FLOAT,
+                          NULL, dimsize, chunksize, data_out, data_in, &storage_size2)) ERR;
+
+        /* Deflate sees the same bytes, so stores the same sizes. */
+        if (storage_size != storage_size2) ERR;
+        if (storage_size >= NX * NY * sizeof(float)) ERR;
+    }
+    SUMMARIZE_ERR;
+    FINAL_RESULTS;
+}
@@ -11,6 +11,8 @@
 #include "ccr_test.h"
 #include <hdf5.h>
 #include <H5DSpublic.h>
+#include <stdlib.h>
+#include <string.h>
 
 /* Err is used to keep track of errors within each set of tests,
  * total_err is the number of errors in the entire test program, which
@@ -21,6 +23,7 @@ static int total_err = 0, err = 0;
 #define STR_LEN 255
 #define MAX_LEN 1024
 #define H5Z_FILTER_BZIP2 307
+#define NBIG 600011 /* Spans several level 1 streams */
 
 size_t H5Z_filter_bzip2(unsigned int flags, size_t cd_nelmts,
                         const unsigned int cd_values[], size_t nbytes,
@@ -150,5 +153,96 @@ main()
          ERR;
    }
    SUMMARIZE_ERR;
+   printf("*** Checking multi-stream bzip2 matches on any number of threads...");
+   {
+      /* Level 1 streams hold 100000 bytes, so the chunk has 25. */
+      const unsigned int cd_values[2] = {1, 1};
+      const unsigned int cd_values_bad[2] = {1, 3};
+      int *data;
+      void *buf, *buf_thr;
+      size_t nbytes, nbytes_thr, buf_size;
+      int i;
+
+      if (!(data = malloc(NBIG * sizeof(int)))) ERR;
+      for (i = 0; i < NBIG; i++)
+         data[i] = (i % 1000 < 500) ? i / 7 : (i * 2654435761u) >> 7;
+
+      /* Compress on the calling thread, then on several. */
+      if (setenv("CCR_THR_NBR", "1", 1)) ERR;
+      if (!(buf = malloc(NBIG * sizeof(int)))) ERR;
+      memcpy(buf, data, NBIG * sizeof(int));
+      buf_size = NBIG * sizeof(int);
+      if (!(nbytes = H5Z_filter_bzip2(0, 2, cd_values, NBIG * sizeof(int), &buf_size, &buf))) ERR;
+      if (setenv("CCR_THR_NBR", "4", 1)) ERR;
+      if (!(buf_thr = malloc(NBIG * sizeof(int)))) ERR;
+      memcpy(buf_thr, data, NBIG * sizeof(int));
+      buf_size = NBIG * sizeof(int);
+      if (!(nbytes_thr = H5Z_filter_bzip2(0, 2, cd_values, NBIG * sizeof(int), &buf_size, &buf_thr))) ERR;
+
+      /* The chunk does not depend on the number of threads. */
+      if (nbytes_thr != nbytes || memcmp(buf, buf_thr, nbytes)) ERR;
+
+      /* Unknown formats, and truncated or single-stream reads, fail. */
+      if (H5Z_filter_bzip2(H5Z_FLAG_REVERSE, 2, cd_values_bad, nbytes, &buf_size, &buf)) ERR;
+      if (H5Z_filter_bzip2(H5Z_FLAG_REVERSE, 2, cd_values, nbytes - 9, &buf_size, &buf)) ERR;
+      if (H5Z_filter_bzip2(H5Z_FLAG_REVERSE, 1, cd_values, nbytes, &buf_size, &buf)) ERR;
+
+      /* Decompress on several threads. */
+      if (H5Z_filter_bzip2(H5Z_FLAG_REVERSE, 2, cd_values, nbytes_thr, &buf_size,
+                           &buf_thr) != NBIG * sizeof(int)) ERR;
+      if (memcmp(buf_thr, data, NBIG * sizeof(int))) ERR;
+      if (unsetenv("CCR_THR_NBR")) ERR;
+      free(buf);
+      free(buf_thr);
+      free(data);
+   }
+   SUMMARIZE_ERR;
+   printf("*** Checking sized bzip2 chunks decompress to their stored size...");
+   {
+      const unsigned int cd_values[2] = {9, 2};
+      const unsigned int cd_values_old[2] = {9, 0};
+      int *data;
+      char *buf, *buf_old;
+      size_t nbytes, nbytes_old, buf_size;
+      int i;
+
+      if (!(data = malloc(NBIG * sizeof(int)))) ERR;
+      for (i = 0; i < NBIG; i++)
+         data[i] = (i % 1000 < 500) ? i / 7 : (i * 2654435761u) >> 7;
+
+      /* A sized chunk is the old stream behind an 8 byte header. */
+      if (!(buf = malloc(NBIG * sizeof(int)))) ERR;
+      memcpy(buf, data, NBIG * sizeof(int));
+      buf_size = NBIG * sizeof(int);
+      if (!(nbytes = H5Z_filter_bzip2(0, 2, cd_values, NBIG * sizeof(int), &buf_size,
+                                      (void **)&buf))) ERR;
+      if (!(buf_old = malloc(NBIG * sizeof(int)))) ERR;
+      memcpy(buf_old, data, NBIG * sizeof(int));
+      buf_size = NBIG * sizeof(int);
+      if (!(nbytes_old = H5Z_filter_bzip2(0, 2, cd_values_old, NBIG * sizeof(int), &buf_size,
+                                          (void **)&buf_old))) ERR;
+      if (nbytes != nbytes_old + 8 || memcmp(buf, "CBZ\1", 4)) ERR;
+      if (memcmp(buf + 8, buf_old, nbytes_old)) ERR;
+
+      /* Truncated chunks, and unknown versions, fail. */
+      if (H5Z_filter_bzip2(H5Z_FLAG_REVERSE, 2, cd_values, nbytes - 9, &buf_size,
+                           (void **)&buf)) ERR;
+      buf[3] = 2;
+      if (H5Z_filter_bzip2(H5Z_FLAG_REVERSE, 2, cd_values, nbytes, &buf_size, (void **)&buf)) ERR;
+      buf[3] = 1;
+
+      /* Both formats decompress, the sized one into an exact buffer. */
+      if (H5Z_filter_bzip2(H5Z_FLAG_REVERSE, 2, cd_values, nbytes, &buf_size,
+                           (void **)&buf) != NBIG * sizeof(int)) ERR;
+      if (buf_size != NBIG * sizeof(int)) ERR;
+      if (memcmp(buf, data, NBIG * sizeof(int))) ERR;
+      if (H5Z_filter_bzip2(H5Z_FLAG_REVERSE, 2, cd_values_old, nbytes_old, &buf_size,
+                           (void **)&buf_old) != NBIG * sizeof(int)) ERR;
+      if (memcmp(buf_old, data, NBIG * sizeof(int))) ERR;
+      free(buf);
+      free(buf_old);
+      free(data);
+   }
+   SUMMARIZE_ERR;
    FINAL_RESULTS;
 }
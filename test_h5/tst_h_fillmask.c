@@ -0,0 +1,305 @@
+/*
+ * This is a test in the Community Codec Repository.
+ *
+ * This test checks the Fill Mask filter stores chunks of only fill
+ * values as a header, stores partly filled chunks as a validity
+ * bitmap plus valid values, stores other chunks unchanged, and
+ * restores every value exactly.
+ */
+
+#include "config.h"
+#include "ccr_test.h"
+#include "tst_h_utils.h"
+#include <hdf5.h>
+#include <math.h>
+#include <string.h>
+
+/* Err is used to keep track of errors within each set of tests,
+ * total_err is the number of errors in the entire test program, which
+ * generally cosists of several sets of tests. */
+static int total_err = 0, err = 0;
+
+#define FILE_NAME "tst_h_fillmask.h5"
+#define NVAL 1027 /* Odd, and not a multiple of any SIMD width */
+#define NX 60
+#define NY 120
+#define HDR_SZ 16 /* H5Zfillmask.c: CCR_FMK_HDR_SZ */
+#define MOD_RAW 0 /* H5Zfillmask.c: CCR_FMK_MOD_RAW */
+#define MOD_FLL 1 /* H5Zfillmask.c: CCR_FMK_MOD_FLL */
+#define MOD_MSK 2 /* H5Zfillmask.c: CCR_FMK_MOD_MSK */
+#define MSS_VAL -999.0
+
+size_t H5Z_filter_fillmask(unsigned int flags, size_t cd_nelmts,
+                           const unsigned int cd_values[], size_t nbytes,
+                           size_t *buf_size, void **buf);
+
+/* Fill in filter parameters as ccr_set_local_fillmask() would. */
+static void
+fmk_prm_set(unsigned int *cd_values, size_t datum_size, const void *mss_val)
+{
+    memset(cd_values, 0, FILLMASK_FLT_PRM_NBR * sizeof(unsigned int));
+    cd_values[0] = datum_size;
+    cd_values[1] = 1;
+    memcpy(&cd_values[2], mss_val, datum_size);
+}
+
+/* Set value i of a buffer of datum_size values: fill value where
+ * is_fll, otherwise a value that differs from the fill value. */
+static void
+fmk_val_set(unsigned char *buf, size_t datum_size, int i, int is_fll, const void *mss_val)
+{
+    unsigned char val[8];
+
+    memcpy(val, mss_val, datum_size);
+    if (!is_fll)
+        val[0] ^= (unsigned char)(1 + i % 255);
+    memcpy(buf + i * datum_size, val, datum_size);
+}
+
+int
+main()
+{
+    printf("\n*** Checking Fill Mask filter.\n");
+    printf("*** Checking Fill Mask stores chunks of only fill values as a header...");
+    {
+        unsigned int cd_values[FILLMASK_FLT_PRM_NBR];
+        size_t nbytes_enc;
+        double *dp;
+        float *fp;
+        short *sp;
+        signed char *bp;
+        float mss_val_flt = MSS_VAL;
+        double mss_val_dbl = MSS_VAL;
+        short mss_val_sht = -32767;
+        signed char mss_val_byt = -127;
+        int i;
+
+        if (!(fp = malloc(NVAL * sizeof(float)))) ERR;
+        for (i = 0; i < NVAL; i++)
+            fp[i] = mss_val_flt;
+        fmk_prm_set(cd_values, sizeof(float), &mss_val_flt);
+        if (!(nbytes_enc = tst_h_enc(H5Z_filter_fillmask, FILLMASK_FLT_PRM_NBR, cd_values, (void **)&fp, NVAL * sizeof(float)))) ERR;
+        if (((unsigned char *)fp)[1] != MOD_FLL) ERR;
+        if (nbytes_enc != HDR_SZ) ERR;
+        if (tst_h_dec(H5Z_filter_fillmask, FILLMASK_FLT_PRM_NBR, cd_values, (void **)&fp, nbytes_enc) != NVAL * sizeof(float)) ERR;
+        for (i = 0; i < NVAL; i++)
+            if (fp[i] != mss_val_flt) ERR;
+        free(fp);
+
+        if (!(dp = malloc(NVAL * sizeof(double)))) ERR;
+        for (i = 0; i < NVAL; i++)
+            dp[i] = mss_val_dbl;
+        fmk_prm_set(cd_values, sizeof(double), &mss_val_dbl);
+        if (!(nbytes_enc = tst_h_enc(H5Z_filter_fillmask, FILLMASK_FLT_PRM_NBR, cd_values, (void **)&dp, NVAL * sizeof(double)))) ERR;
+        if (((unsigned char *)dp)[1] != MOD_FLL) ERR;
+        if (nbytes_enc != HDR_SZ) ERR;
+        if (tst_h_dec(H5Z_filter_fillmask, FILLMASK_FLT_PRM_NBR, cd_values, (void **)&dp, nbytes_enc) != NVAL * sizeof(double)) ERR;
+        for (i = 0; i < NVAL; i++)
+            if (dp[i] != mss_val_dbl) ERR;
+        free(dp);
+
+        if (!(sp = malloc(NVAL * sizeof(short)))) ERR;
+        for (i = 0; i < NVAL; i++)
+            sp[i] = mss_val_sht;
+        fmk_prm_set(cd_values, sizeof(short), &mss_val_sht);
+        if (!(nbytes_enc = tst_h_enc(H5Z_filter_fillmask, FILLMASK_FLT_PRM_NBR, cd_values, (void **)&sp, NVAL * sizeof(short)))) ERR;
+        if (((unsigned char *)sp)[1] != MOD_FLL) ERR;
+        if (tst_h_dec(H5Z_filter_fillmask, FILLMASK_FLT_PRM_NBR, cd_values, (void **)&sp, nbytes_enc) != NVAL * sizeof(short)) ERR;
+        for (i = 0; i < NVAL; i++)
+            if (sp[i] != mss_val_sht) ERR;
+        free(sp);
+
+        if (!(bp = malloc(NVAL))) ERR;
+        memset(bp, mss_val_byt, NVAL);
+        fmk_prm_set(cd_values, 1, &mss_val_byt);
+        if (!(nbytes_enc = tst_h_enc(H5Z_filter_fillmask, FILLMASK_FLT_PRM_NBR, cd_values, (void **)&bp, NVAL))) ERR;
+        if (((unsigned char *)bp)[1] != MOD_FLL) ERR;
+        if (tst_h_dec(H5Z_filter_fillmask, FILLMASK_FLT_PRM_NBR, cd_values, (void **)&bp, nbytes_enc) != NVAL) ERR;
+        for (i = 0; i < NVAL; i++)
+            if (bp[i] != mss_val_byt) ERR;
+        free(bp);
+    }
+    SUMMARIZE_ERR;
+    printf("*** Checking Fill Mask bitmaps for every datum size and remainder length...");
+    {
+        /* The vector kernel handles whole steps and the scalar kernel
+         * the remainder, so check every bit of the bitmap against
+         * the definition, for chunks ending at every offset within
+         * the widest step. */
+        unsigned int cd_values[FILLMASK_FLT_PRM_NBR];
+        size_t datum_size[4] = {1, 2, 4, 8};
+        double mss_val = MSS_VAL;
+        unsigned char *buf, *ref, *msk;
+        size_t nbytes_enc, vld_nbr;
+        int d, i, sz;
+
+        for (d = 0; d < 4; d++)
+        {
+            for (sz = NVAL - 40; sz <= NVAL; sz++)
+            {
+                if (!(buf = malloc(sz * datum_size[d]))) ERR;
+                if (!(ref = malloc(sz * datum_size[d]))) ERR;
+
+                /* Land covers most of this ocean field, with a coast
+                 * and scattered lakes. */
+                for (vld_nbr = 0, i = 0; i < sz; i++)
+                {
+                    int is_fll = i < sz / 3 || (i % 7 != 0 && i % 11 != 3);
+                    fmk_val_set(buf, datum_size[d], i, is_fll, &mss_val);
+                    if (!is_fll)
+                        vld_nbr++;
+                }
+                memcpy(ref, buf, sz * datum_size[d]);
+                fmk_prm_set(cd_values, datum_size[d], &mss_val);
+                if (!(nbytes_enc = tst_h_enc(H5Z_filter_fillmask, FILLMASK_FLT_PRM_NBR, cd_values, (void **)&buf, sz * datum_size[d]))) ERR;
+                if (((unsigned char *)buf)[1] != MOD_MSK) ERR;
+                if (nbytes_enc != HDR_SZ + (sz + 7) / 8 + vld_nbr * datum_size[d]) ERR;
+                if (buf[2] != datum_size[d]) ERR;
+                if (memcmp(buf + 8, &mss_val, datum_size[d])) ERR;
+                msk = buf + HDR_SZ;
+                for (i = 0; i < sz; i++)
+                {
+                    int is_fll = !memcmp(ref + i * datum_size[d], &mss_val, datum_size[d]);
+                    if (((msk[i / 8] >> (i % 8)) & 1) != !is_fll) ERR;
+                }
+                /* Bitmap padding is zero. */
+                if (sz % 8 && msk[sz / 8] >> (sz % 8)) ERR;
+                if (tst_h_dec(H5Z_filter_fillmask, FILLMASK_FLT_PRM_NBR, cd_values, (void **)&buf, nbytes_enc) != sz * datum_size[d]) ERR;
+                if (memcmp(buf, ref, sz * datum_size[d])) ERR;
+                free(buf);
+                free(ref);
+            }
+        }
+    }
+    SUMMARIZE_ERR;
+    printf("*** Checking Fill Mask stores chunks that masking would not shrink unchanged...");
+    {
+        unsigned int cd_values[FILLMASK_FLT_PRM_NBR];
+        float mss_val_flt = MSS_VAL;
+        size_t nbytes_enc;
+        float *fp;
+        int i;
+
+        /* No fill values at all. */
+        if (!(fp = malloc(NVAL * sizeof(float)))) ERR;
+        for (i = 0; i < NVAL; i++)
+            fp[i] = i * 0.5f;
+        fmk_prm_set(cd_values, sizeof(float), &mss_val_flt);
+        if (!(nbytes_enc = tst_h_enc(H5Z_filter_fillmask, FILLMASK_FLT_PRM_NBR, cd_values, (void **)&fp, NVAL * sizeof(float)))) ERR;
+        if (((unsigned char *)fp)[1] != MOD_RAW) ERR;
+        if (nbytes_enc != HDR_SZ + NVAL * sizeof(float)) ERR;
+        if (tst_h_dec(H5Z_filter_fillmask, FILLMASK_FLT_PRM_NBR, cd_values, (void **)&fp, nbytes_enc) != NVAL * sizeof(float)) ERR;
+        for (i = 0; i < NVAL; i++)
+            if (fp[i] != i * 0.5f) ERR;
+
+        /* One fill value in 64 saves less than the bitmap costs. */
+        for (i = 0; i < NVAL; i++)
+            fp[i] = (i % 64 == 0) ? mss_val_flt : i * 0.5f;
+        if (!(nbytes_enc = tst_h_enc(H5Z_filter_fillmask, FILLMASK_FLT_PRM_NBR, cd_values, (void **)&fp, NVAL * sizeof(float)))) ERR;
+        if (((unsigned char *)fp)[1] != MOD_RAW) ERR;
+        if (tst_h_dec(H5Z_filter_fillmask, FILLMASK_FLT_PRM_NBR, cd_values, (void **)&fp, nbytes_enc) != NVAL * sizeof(float)) ERR;
+        for (i = 0; i < NVAL; i++)
+            if (fp[i] != ((i % 64 == 0) ? mss_val_flt : i * 0.5f)) ERR;
+        free(fp);
+    }
+    SUMMARIZE_ERR;
+    printf("*** Checking Fill Mask compares values bitwise...");
+    {
+        unsigned int cd_values[FILLMASK_FLT_PRM_NBR];
+        size_t nbytes_enc;
+        float mss_val_flt = NAN;
+        float *fp;
+        int i;
+
+        /* A NaN fill value matches itself, and NaNs with other
+         * payloads, zeros, and negative zeros are kept. */
+        if (!(fp = malloc(NVAL * sizeof(float)))) ERR;
+        for (i = 0; i < NVAL; i++)
+            fp[i] = mss_val_flt;
+        fp[10] = -0.0f;
+        fp[11] = 0.0f;
+        fp[12] = -mss_val_flt;
+        fmk_prm_set(cd_values, sizeof(float), &mss_val_flt);
+        if (!(nbytes_enc = tst_h_enc(H5Z_filter_fillmask, FILLMASK_FLT_PRM_NBR, cd_values, (void **)&fp, NVAL * sizeof(float)))) ERR;
+        if (((unsigned char *)fp)[1] != MOD_MSK) ERR;
+        if (nbytes_enc != HDR_SZ + (NVAL + 7) / 8 + 3 * sizeof(float)) ERR;
+        if (tst_h_dec(H5Z_filter_fillmask, FILLMASK_FLT_PRM_NBR, cd_values, (void **)&fp, nbytes_enc) != NVAL * sizeof(float)) ERR;
+        for (i = 0; i < NVAL; i++)
+        {
+            float val = (i == 10) ? -0.0f : (i == 11) ? 0.0f : (i == 12) ? -mss_val_flt : mss_val_flt;
+            if (memcmp(&fp[i], &val, sizeof(float))) ERR;
+        }
+        free(fp);
+    }
+    SUMMARIZE_ERR;
+    printf("*** Checking Fill Mask rejects invalid parameters and chunks...");
+    {
+        unsigned int cd_values[FILLMASK_FLT_PRM_NBR];
+        double mss_val = MSS_VAL;
+        size_t buf_size, nbytes_enc;
+        double *dp;
+        void *buf;
+        int i;
+
+        if (!(dp = malloc(NVAL * sizeof(double)))) ERR;
+        for (i = 0; i < NVAL; i++)
+            dp[i] = i % 3 ? mss_val : i;
+        buf = dp;
+        buf_size = NVAL * sizeof(double);
+
+        /* Only 1, 2, 4, and 8 byte values, in whole numbers. */
+        fmk_prm_set(cd_values, 3, &mss_val);
+        if (H5Z_filter_fillmask(0, FILLMASK_FLT_PRM_NBR, cd_values, buf_size, &buf_size, &buf)) ERR;
+        fmk_prm_set(cd_values, sizeof(double), &mss_val);
+        if (H5Z_filter_fillmask(0, FILLMASK_FLT_PRM_NBR, cd_values, buf_size - 1, &buf_size, &buf)) ERR;
+        if (H5Z_filter_fillmask(0, 2, cd_values, buf_size, &buf_size, &buf)) ERR;
+
+        /* Truncated or unknown chunks are errors, not garbage. */
+        if (!(nbytes_enc = tst_h_enc(H5Z_filter_fillmask, FILLMASK_FLT_PRM_NBR, cd_values, &buf, NVAL * sizeof(double)))) ERR;
+        if (((unsigned char *)buf)[1] != MOD_MSK) ERR;
+        if (tst_h_corrupt(H5Z_filter_fillmask, FILLMASK_FLT_PRM_NBR, cd_values, &buf, nbytes_enc, HDR_SZ, 1)) ERR;
+        if (tst_h_corrupt(H5Z_filter_fillmask, FILLMASK_FLT_PRM_NBR, cd_values, &buf, nbytes_enc, HDR_SZ, 0)) ERR;
+        free(buf);
+    }
+    SUMMARIZE_ERR;
+    printf("*** Checking Fill Mask through an HDF5 dataset...");
+    {
+        hsize_t dimsize[2] = {NX, NY};
+        hsize_t chunksize[2] = {NX / 2, NY / 2};
+        unsigned int cd_values[FILLMASK_FLT_PRM_NBR] = {0};
+        size_t cd_nelmts = FILLMASK_FLT_PRM_NBR;
+        float data_out[NX][NY], data_in[NX][NY];
+        float fill_value = MSS_VAL;
+        hsize_t storage_size;
+        size_t vld_nbr = 0;
+        int x, y;
+
+        /* Land covers the first half of the rows, and the ocean in
+         * the other half has a few islands. The first two chunks are
+         * all land. */
+        for (x = 0; x < NX; x++)
+            for (y = 0; y < NY; y++)
+            {
+                data_out[x][y] = (x < NX / 2 || (x * y) % 9 == 1) ? fill_value : 280.0f + 0.01f * (x * NY + y);
+                if (data_out[x][y] != fill_value)
+                    vld_nbr++;
+            }
+
+        /* Users set no parameters. */
+        if (tst_h_dset_rt(FILE_NAME, FILLMASK_ID, &cd_nelmts, cd_values, 0, H5T_NATIVE_FLOAT,
+                          &fill_value, dimsize, chunksize, data_out, data_in, &storage_size)) ERR;
+
+        /* The dataset fill value is the one masked. */
+        if (cd_values[0] != sizeof(float) || cd_values[1] != 1) ERR;
+        if (memcmp(&cd_values[2], &fill_value, sizeof(float))) ERR;
+
+        /* Two chunks hold only a header, and two hold a header,
+         * bitmap, and valid values. */
+        if (storage_size != 4 * HDR_SZ + 2 * (NX / 2) * (NY / 2) / 8 + vld_nbr * sizeof(float)) ERR;
+        for (x = 0; x < NX; x++)
+            for (y = 0; y < NY; y++)
+                if (data_in[x][y] != data_out[x][y]) ERR;
+    }
+    SUMMARIZE_ERR;
+    FINAL_RESULTS;
+}
@@ -0,0 +1,227 @@
+/*
+ * This is a test in the Community Codec Repository.
+ *
+ * This test checks the Float16 filter rounds float32 values to the
+ * nearest half-precision or bfloat16 value, preserves fill values,
+ * and expands the values on read.
+ */
+
+#include "config.h"
+#include "ccr_test.h"
+#include <hdf5.h>
+#include <math.h>
+#include <string.h>
+
+/* Err is used to keep track of errors within each set of tests,
+ * total_err is the number of errors in the entire test program, which
+ * generally cosists of several sets of tests. */
+static int total_err = 0, err = 0;
+
+#define FILE_NAME "tst_h_float16.h5"
+#define VAR_NAME "data"
+#define NVAL 4099
+#define NX 60
+#define NY 120
+#define MSS_VAL -999.0f
+
+size_t H5Z_filter_float16(unsigned int flags, size_t cd_nelmts,
+                          const unsigned int cd_values[], size_t nbytes,
+                          size_t *buf_size, void **buf);
+
+/* Encode and decode nval floats in place with the Float16 filter. The
+ * buffer must come from malloc(), since decoding grows it. Return the
+ * number of bytes encoded, or 0 on error. */
+static size_t
+f16_rnd_trp(float **fpp, size_t nval, int format, int has_mss_val, float mss_val)
+{
+    unsigned int cd_values[FLOAT16_FLT_PRM_NBR] = {0, sizeof(float), 0, 0, 0};
+    size_t buf_size = nval * sizeof(float);
+    size_t nbytes_enc;
+    void *buf = *fpp;
+
+    cd_values[0] = format;
+    cd_values[2] = has_mss_val;
+    memcpy(&cd_values[3], &mss_val, sizeof(float));
+    nbytes_enc = H5Z_filter_float16(0, FLOAT16_FLT_PRM_NBR, cd_values, nval * sizeof(float), &buf_size, &buf);
+    /* Shrink allocation as HDF5 might, so that decoding must grow it. */
+    buf_size = nbytes_enc;
+    if (H5Z_filter_float16(H5Z_FLAG_REVERSE, FLOAT16_FLT_PRM_NBR, cd_values, nbytes_enc,
+                           &buf_size, &buf) != nval * sizeof(float)) return 0;
+    *fpp = buf;
+    return nbytes_enc;
+}
+
+int
+main()
+{
+    printf("\n*** Checking Float16 filter.\n");
+    printf("*** Checking Float16 rounds to nearest half-precision value...");
+    {
+        float *fp;
+        double val;
+        int i;
+
+        if (!(fp = malloc(NVAL * sizeof(float)))) ERR;
+
+        /* Values spanning the normal half-precision range round with
+         * relative error at most 2^-11. */
+        for (i = 0; i < NVAL; i++)
+            fp[i] = sin(i) * pow(10.0, i % 9 - 4);
+        if (f16_rnd_trp(&fp, NVAL, FLOAT16_IEEE, 0, 0.0f) != NVAL * 2) ERR;
+        for (i = 0; i < NVAL; i++)
+        {
+            val = (float)(sin(i) * pow(10.0, i % 9 - 4));
+            if (fabs(val) < ldexp(1.0, -14))
+            {
+                /* Subnormal step is 2^-24. */
+                if (fabs(fp[i] - val) > ldexp(1.0, -25)) ERR;
+            }
+            else if (fabs(fp[i] - val) > ldexp(fabs(val), -11)) ERR;
+        }
+
+        /* Ties round to even, extremes overflow or underflow. */
+        fp[0] = 1.0f + ldexpf(1.0f, -11);
+        fp[1] = 1.0f + 3.0f * ldexpf(1.0f, -11);
+        fp[2] = 65504.0f;
+        fp[3] = 65520.0f;
+        fp[4] = -1.0e6f;
+        fp[5] = ldexpf(1.0f, -25);
+        fp[6] = ldexpf(1.5f, -25);
+        fp[7] = ldexpf(1.0f, -24);
+        fp[8] = -0.0f;
+        fp[9] = NAN;
+        if (f16_rnd_trp(&fp, 10, FLOAT16_IEEE, 0, 0.0f) != 20) ERR;
+        if (fp[0] != 1.0f) ERR;
+        if (fp[1] != 1.0f + ldexpf(1.0f, -9)) ERR;
+        if (fp[2] != 65504.0f) ERR;
+        if (!isinf(fp[3]) || fp[3] < 0) ERR;
+        if (!isinf(fp[4]) || fp[4] > 0) ERR;
+        if (fp[5] != 0.0f) ERR;
+        if (fp[6] != ldexpf(1.0f, -24)) ERR;
+        if (fp[7] != ldexpf(1.0f, -24)) ERR;
+        if (fp[8] != 0.0f || !signbit(fp[8])) ERR;
+        if (!isnan(fp[9])) ERR;
+        free(fp);
+    }
+    SUMMARIZE_ERR;
+    printf("*** Checking Float16 rounds to nearest bfloat16 value...");
+    {
+        float *fp;
+        double val;
+        int i;
+
+        if (!(fp = malloc(NVAL * sizeof(float)))) ERR;
+
+        /* bfloat16 covers the float32 range with relative error at
+         * most 2^-8. */
+        for (i = 0; i < NVAL; i++)
+            fp[i] = sin(i) * pow(10.0, i % 61 - 30);
+        if (f16_rnd_trp(&fp, NVAL, FLOAT16_BFLOAT16, 0, 0.0f) != NVAL * 2) ERR;
+        for (i = 0; i < NVAL; i++)
+        {
+            val = (float)(sin(i) * pow(10.0, i % 61 - 30));
+            if (fabs(fp[i] - val) > ldexp(fabs(val), -8)) ERR;
+        }
+
+        fp[0] = 1.0f + ldexpf(1.0f, -8);
+        fp[1] = 1.0f + 3.0f * ldexpf(1.0f, -8);
+        fp[2] = 1.0e6f;
+        fp[3] = NAN;
+        if (f16_rnd_trp(&fp, 4, FLOAT16_BFLOAT16, 0, 0.0f) != 8) ERR;
+        if (fp[0] != 1.0f) ERR;
+        if (fp[1] != 1.0f + ldexpf(1.0f, -6)) ERR;
+        if (fp[2] != 999424.0f) ERR;
+        if (!isnan(fp[3])) ERR;
+        free(fp);
+    }
+    SUMMARIZE_ERR;
+    printf("*** Checking Float16 preserves fill values...");
+    {
+        float *fp;
+        int f, i;
+
+        if (!(fp = malloc(NVAL * sizeof(float)))) ERR;
+        for (f = 0; f < 2; f++)
+        {
+            /* Default fill value overflows half precision, custom fill
+             * value is not representable in either format. */
+            for (i = 0; i < NVAL; i++)
+                fp[i] = (i % 7 == 0) ? NC_FILL_FLOAT : (i % 7 == 1) ? MSS_VAL - 0.1f : 1.0f / i;
+            if (!f16_rnd_trp(&fp, NVAL, f ? FLOAT16_BFLOAT16 : FLOAT16_IEEE, 0, 0.0f)) ERR;
+            for (i = 0; i < NVAL; i += 7)
+                if (fp[i] != NC_FILL_FLOAT) ERR;
+
+            for (i = 0; i < NVAL; i++)
+                fp[i] = (i % 7 == 0) ? NC_FILL_FLOAT : (i % 7 == 1) ? MSS_VAL - 0.1f : 1.0f / i;
+            if (!f16_rnd_trp(&fp, NVAL, f ? FLOAT16_BFLOAT16 : FLOAT16_IEEE, 1, MSS_VAL - 0.1f)) ERR;
+            for (i = 1; i < NVAL; i += 7)
+                if (fp[i] != MSS_VAL - 0.1f) ERR;
+        }
+        free(fp);
+    }
+    SUMMARIZE_ERR;
+    printf("*** Checking Float16 rejects invalid parameters...");
+    {
+        unsigned int cd_values[FLOAT16_FLT_PRM_NBR] = {FLOAT16_IEEE, sizeof(double), 0, 0, 0};
+        double dp[4] = {1.0, 2.0, 3.0, 4.0};
+        size_t buf_size = sizeof(dp);
+        void *buf = dp;
+
+        if (H5Z_filter_float16(0, FLOAT16_FLT_PRM_NBR, cd_values, sizeof(dp), &buf_size, &buf)) ERR;
+        cd_values[0] = 2;
+        cd_values[1] = sizeof(float);
+        if (H5Z_filter_float16(0, FLOAT16_FLT_PRM_NBR, cd_values, sizeof(dp), &buf_size, &buf)) ERR;
+        if (H5Z_filter_float16(0, 1, cd_values, sizeof(dp), &buf_size, &buf)) ERR;
+    }
+    SUMMARIZE_ERR;
+    printf("*** Checking Float16 through an HDF5 dataset...");
+    {
+        hid_t fileid, datasetid, spaceid, plistid;
+        hsize_t dimsize[2] = {NX, NY};
+        hsize_t chunksize[2] = {NX / 2, NY / 2};
+        const unsigned int cd_values[FLOAT16_FLT_PRM_NBR] = {FLOAT16_IEEE, 0, 0, 0, 0};
+        float data_out[NX][NY], data_in[NX][NY];
+        float fill_value = MSS_VAL;
+        hsize_t storage_size;
+        int x, y;
+
+        /* Integers below 2048 are exact in half precision. */
+        for (x = 0; x < NX; x++)
+            for (y = 0; y < NY; y++)
+                data_out[x][y] = (x + y) % 5 ? (x * NY + y) % 2048 : MSS_VAL;
+
+        /* Loads the plugin, as nc_def_var_float16() does. */
+        if (!H5Zfilter_avail(FLOAT16_ID)) ERR;
+
+        if ((fileid = H5Fcreate(FILE_NAME, H5F_ACC_TRUNC, H5P_DEFAULT, H5P_DEFAULT)) < 0) ERR;
+        if ((spaceid = H5Screate_simple(2, dimsize, NULL)) < 0) ERR;
+        if ((plistid = H5Pcreate(H5P_DATASET_CREATE)) < 0) ERR;
+        if (H5Pset_chunk(plistid, 2, chunksize) < 0) ERR;
+        if (H5Pset_fill_value(plistid, H5T_NATIVE_FLOAT, &fill_value) < 0) ERR;
+        if (H5Pset_filter(plistid, (H5Z_filter_t)FLOAT16_ID, H5Z_FLAG_MANDATORY,
+                          (size_t)FLOAT16_FLT_PRM_NBR, cd_values) < 0) ERR;
+        if ((datasetid = H5Dcreate2(fileid, VAR_NAME, H5T_IEEE_F32LE, spaceid,
+                                    H5P_DEFAULT, plistid, H5P_DEFAULT)) < 0) ERR;
+        if (H5Dwrite(datasetid, H5T_NATIVE_FLOAT, H5S_ALL, H5S_ALL, H5P_DEFAULT, data_out) < 0) ERR;
+
+        /* Each chunk is stored in half the bytes. */
+        storage_size = H5Dget_storage_size(datasetid);
+        if (storage_size != NX * NY * 2) ERR;
+
+        if (H5Dclose(datasetid) < 0 ||
+            H5Pclose(plistid) < 0 ||
+            H5Sclose(spaceid) < 0 ||
+            H5Fclose(fileid) < 0) ERR;
+
+        if ((fileid = H5Fopen(FILE_NAME, H5F_ACC_RDONLY, H5P_DEFAULT)) < 0) ERR;
+        if ((datasetid = H5Dopen2(fileid, VAR_NAME, H5P_DEFAULT)) < 0) ERR;
+        if (H5Dread(datasetid, H5T_NATIVE_FLOAT, H5S_ALL, H5S_ALL, H5P_DEFAULT, data_in) < 0) ERR;
+        for (x = 0; x < NX; x++)
+            for (y = 0; y < NY; y++)
+                if (data_in[x][y] != data_out[x][y]) ERR;
+        if (H5Dclose(datasetid) < 0 ||
+            H5Fclose(fileid) < 0) ERR;
+    }
+    SUMMARIZE_ERR;
+    FINAL_RESULTS;
+}
@@ -0,0 +1,372 @@
+/*
+ * This is a test in the Community Codec Repository.
+ *
+ * This test checks the Granular BitRound filter against the
+ * per-value DGG19 formula it replaces.
+ */
+
+#include "config.h"
+#include "ccr_test.h"
+#include <hdf5.h>
+#include <math.h>
+#include <string.h>
+
+/* Err is used to keep track of errors within each set of tests,
+ * total_err is the number of errors in the entire test program, which
+ * generally cosists of several sets of tests. */
+static int total_err = 0, err = 0;
+
+#define NBIG 1000003 /* Spans many multithreading slices */
+#define NVAL 4099 /* Odd, and not a multiple of any SIMD width */
+#define MSS_VAL -999.0
+#define FILE_NAME "tst_h_granularbr.h5"
+#define NX 60
+#define NY 120
+
+size_t H5Z_filter_granularbr(unsigned int flags, size_t cd_nelmts,
+                             const unsigned int cd_values[], size_t nbytes,
+                             size_t *buf_size, void **buf);
+
+/* Number of bits Granular BitRound keeps, computed per value with
+ * frexp() and log10() exactly as the original filter did. */
+static unsigned short
+gbr_ref_prc(int nsd, double val)
+{
+    const double bit_per_dgt = M_LN10 / M_LN2;
+    const double dgt_per_bit = M_LN2 / M_LN10;
+    double mnt, mnt_fabs, mnt_log10_fabs;
+    int xpn_bs2, dgt_nbr, qnt_pwr;
+    unsigned short prc;
+
+    mnt = frexp(val, &xpn_bs2);
+    mnt_fabs = fabs(mnt);
+    mnt_log10_fabs = log10(mnt_fabs);
+    dgt_nbr = (int)floor(xpn_bs2 * dgt_per_bit + mnt_log10_fabs) + 1;
+    qnt_pwr = (int)floor(bit_per_dgt * (dgt_nbr - nsd));
+    prc = mnt_fabs == 0.0 ? 0 : abs((int)floor(xpn_bs2 - bit_per_dgt * mnt_log10_fabs) - qnt_pwr);
+    prc--;
+    return prc;
+}
+
+static void
+gbr_ref_flt(int nsd, size_t sz, float mss_val, float *fp)
+{
+    unsigned int *u32p = (unsigned int *)fp;
+    unsigned int msk_zro;
+    size_t idx;
+
+    for (idx = 0; idx < sz; idx++)
+        if (fp[idx] != mss_val && u32p[idx] != 0U)
+        {
+            msk_zro = ~0U;
+            msk_zro <<= 23 - gbr_ref_prc(nsd, fp[idx]);
+            u32p[idx] += ~msk_zro & (msk_zro >> 1);
+            u32p[idx] &= msk_zro;
+        }
+}
+
+static void
+gbr_ref_dbl(int nsd, size_t sz, double mss_val, double *dp)
+{
+    unsigned long long *u64p = (unsigned long long *)dp;
+    unsigned long long msk_zro;
+    size_t idx;
+
+    for (idx = 0; idx < sz; idx++)
+        if (dp[idx] != mss_val && u64p[idx] != 0ULL)
+        {
+            msk_zro = ~0ULL;
+            msk_zro <<= 52 - gbr_ref_prc(nsd, dp[idx]);
+            u64p[idx] += ~msk_zro & (msk_zro >> 1);
+            u64p[idx] &= msk_zro;
+        }
+}
+
+/* Granular BitRound to absolute error, written per value with
+ * frexp(): keep explicit bits down to the one worth twice the largest
+ * power of two not exceeding abs_err. */
+static void
+gbr_abs_ref_flt(double abs_err, size_t sz, float mss_val, float *fp)
+{
+    unsigned int *u32p = (unsigned int *)fp;
+    unsigned int msk_zro;
+    int qnt_pwr, xpn, bit_nbr;
+    size_t idx;
+
+    (void)frexp(abs_err, &qnt_pwr);
+    qnt_pwr--;
+    for (idx = 0; idx < sz; idx++)
+        if (fp[idx] != mss_val && fp[idx] != 0.0f && isnormal(fp[idx]))
+        {
+            (void)frexp(fp[idx], &xpn);
+            bit_nbr = xpn - 1 - qnt_pwr - 1;
+            if (bit_nbr >= 23)
+                continue;
+            msk_zro = ~0U << (23 - (bit_nbr < 0 ? 0 : bit_nbr));
+            u32p[idx] += ~msk_zro & (msk_zro >> 1);
+            u32p[idx] &= msk_zro;
+        }
+}
+
+static void
+gbr_abs_ref_dbl(double abs_err, size_t sz, double mss_val, double *dp)
+{
+    unsigned long long *u64p = (unsigned long long *)dp;
+    unsigned long long msk_zro;
+    int qnt_pwr, xpn, bit_nbr;
+    size_t idx;
+
+    (void)frexp(abs_err, &qnt_pwr);
+    qnt_pwr--;
+    for (idx = 0; idx < sz; idx++)
+        if (dp[idx] != mss_val && dp[idx] != 0.0 && isnormal(dp[idx]))
+        {
+            (void)frexp(dp[idx], &xpn);
+            bit_nbr = xpn - 1 - qnt_pwr - 1;
+            if (bit_nbr >= 52)
+                continue;
+            msk_zro = ~0ULL << (52 - (bit_nbr < 0 ? 0 : bit_nbr));
+            u64p[idx] += ~msk_zro & (msk_zro >> 1);
+            u64p[idx] &= msk_zro;
+        }
+}
+
+/* Values spanning the whole exponent range, with powers of ten and
+ * two (where digit count and exponent step), their neighbors, fill
+ * values, zeros, negative zeros, and subnormals. */
+static double
+gbr_tst_val(int i, int is_flt)
+{
+    const int xpn_max = is_flt ? 38 : 307;
+    double val;
+
+    switch (i % 8)
+    {
+    case 0:
+        return MSS_VAL;
+    case 1:
+        return (i % 3) ? 0.0 : -0.0;
+    case 2:
+        val = pow(10.0, i % (2 * xpn_max) - xpn_max);
+        return is_flt ? nextafterf((float)val, (i & 8) ? 0.0f : 1.0e38f) : nextafter(val, (i & 8) ? 0.0 : 1.0e308);
+    case 3:
+        return ldexp((i & 8) ? 1.0 : -1.0, i % (2 * xpn_max * 3) - xpn_max * 3);
+    case 4:
+        return is_flt ? ldexp(i, -149 + i % 16) : ldexp(i, -1074 + i % 40);
+    default:
+        return sin(i) * pow(10.0, i % (2 * xpn_max) - xpn_max);
+    }
+}
+
+int
+main()
+{
+    printf("\n*** Checking Granular BitRound filter.\n");
+    printf("*** Checking Granular BitRound kernels against per-value formula...");
+    {
+        const float mss_val_flt = MSS_VAL;
+        const double mss_val_dbl = MSS_VAL;
+        unsigned int cd_values[GRANULARBR_FLT_PRM_NBR + 1] = {0, 0, 1, 0, 0, 0};
+        float *fp, *fp_ref;
+        double *dp, *dp_ref;
+        size_t nbytes;
+        void *buf;
+        int i, nsd, sz;
+
+        if (!(fp = malloc(NVAL * sizeof(float)))) ERR;
+        if (!(fp_ref = malloc(NVAL * sizeof(float)))) ERR;
+        if (!(dp = malloc(NVAL * sizeof(double)))) ERR;
+        if (!(dp_ref = malloc(NVAL * sizeof(double)))) ERR;
+
+        /* Try lengths that exercise every remainder after the vector loops. */
+        for (sz = NVAL - 16; sz <= NVAL; sz++)
+        {
+            /* Single precision. */
+            for (nsd = 1; nsd <= 7; nsd++)
+            {
+                for (i = 0; i < sz; i++)
+                    fp[i] = fp_ref[i] = gbr_tst_val(i, 1);
+                cd_values[0] = nsd;
+                cd_values[1] = sizeof(float);
+                memcpy(&cd_values[3], &mss_val_flt, sizeof(float));
+                nbytes = sz * sizeof(float);
+                buf = fp;
+                if (H5Z_filter_granularbr(0, GRANULARBR_FLT_PRM_NBR, cd_values, nbytes,
+                                          &nbytes, &buf) != sz * sizeof(float)) ERR;
+                gbr_ref_flt(nsd, sz, mss_val_flt, fp_ref);
+                if (memcmp(fp, fp_ref, sz * sizeof(float))) ERR;
+            }
+
+            /* Double precision. */
+            for (nsd = 1; nsd <= 15; nsd++)
+            {
+                for (i = 0; i < sz; i++)
+                    dp[i] = dp_ref[i] = gbr_tst_val(i, 0);
+                cd_values[0] = nsd;
+                cd_values[1] = sizeof(double);
+                memcpy(&cd_values[3], &mss_val_dbl, sizeof(double));
+                nbytes = sz * sizeof(double);
+                buf = dp;
+                if (H5Z_filter_granularbr(0, GRANULARBR_FLT_PRM_NBR, cd_values, nbytes,
+                                          &nbytes, &buf) != sz * sizeof(double)) ERR;
+                gbr_ref_dbl(nsd, sz, mss_val_dbl, dp_ref);
+                if (memcmp(dp, dp_ref, sz * sizeof(double))) ERR;
+            }
+        }
+        free(fp);
+        free(fp_ref);
+        free(dp);
+        free(dp_ref);
+    }
+    SUMMARIZE_ERR;
+    printf("*** Checking Granular BitRound to absolute error...");
+    {
+        const double abs_err[] = {1.0e-30, 1.0e-3, 0.75, 1.0, 1.0e5};
+        const float mss_val_flt = MSS_VAL;
+        const double mss_val_dbl = MSS_VAL;
+        unsigned int cd_values[GRANULARBR_ABS_FLT_PRM_NBR] = {0, 0, 1, 0, 0, 0, 0};
+        float *fp, *fp_ref;
+        double *dp, *dp_ref;
+        size_t nbytes;
+        void *buf;
+        int e, i;
+
+        if (!(fp = malloc(NVAL * sizeof(float)))) ERR;
+        if (!(fp_ref = malloc(NVAL * sizeof(float)))) ERR;
+        if (!(dp = malloc(NVAL * sizeof(double)))) ERR;
+        if (!(dp_ref = malloc(NVAL * sizeof(double)))) ERR;
+
+        for (e = 0; e < (int)(sizeof(abs_err) / sizeof(abs_err[0])); e++)
+        {
+            memcpy(&cd_values[5], &abs_err[e], sizeof(double));
+
+            /* Single precision matches reference and error bound. */
+            for (i = 0; i < NVAL; i++)
+                fp[i] = fp_ref[i] = gbr_tst_val(i, 1);
+            cd_values[1] = sizeof(float);
+            memcpy(&cd_values[3], &mss_val_flt, sizeof(float));
+            nbytes = NVAL * sizeof(float);
+            buf = fp;
+            if (H5Z_filter_granularbr(0, GRANULARBR_ABS_FLT_PRM_NBR, cd_values, nbytes,
+                                      &nbytes, &buf) != NVAL * sizeof(float)) ERR;
+            gbr_abs_ref_flt(abs_err[e], NVAL, mss_val_flt, fp_ref);
+            if (memcmp(fp, fp_ref, NVAL * sizeof(float))) ERR;
+            for (i = 0; i < NVAL; i++)
+                if (fabs(fp[i] - (float)gbr_tst_val(i, 1)) > abs_err[e]) ERR;
+
+            /* Double precision. */
+            for (i = 0; i < NVAL; i++)
+                dp[i] = dp_ref[i] = gbr_tst_val(i, 0);
+            cd_values[1] = sizeof(double);
+            memcpy(&cd_values[3], &mss_val_dbl, sizeof(double));
+            nbytes = NVAL * sizeof(double);
+            buf = dp;
+            if (H5Z_filter_granularbr(0, GRANULARBR_ABS_FLT_PRM_NBR, cd_values, nbytes,
+                                      &nbytes, &buf) != NVAL * sizeof(double)) ERR;
+            gbr_abs_ref_dbl(abs_err[e], NVAL, mss_val_dbl, dp_ref);
+            if (memcmp(dp, dp_ref, NVAL * sizeof(double))) ERR;
+            for (i = 0; i < NVAL; i++)
+                if (fabs(dp[i] - gbr_tst_val(i, 0)) > abs_err[e]) ERR;
+        }
+
+        /* Small values keep fewer bits than large ones. */
+        fp[0] = 1000.123f;
+        fp[1] = 0.00123f;
+        cd_values[1] = sizeof(float);
+        memcpy(&cd_values[5], &abs_err[1], sizeof(double));
+        nbytes = 2 * sizeof(float);
+        buf = fp;
+        if (H5Z_filter_granularbr(0, GRANULARBR_ABS_FLT_PRM_NBR, cd_values, nbytes,
+                                  &nbytes, &buf) != 2 * sizeof(float)) ERR;
+        if (fp[0] == 1000.0f || fabsf(fp[0] - 1000.123f) > 1.0e-3f) ERR;
+        if (fp[1] != 0.0009765625f) ERR;
+
+        /* Absolute error must be positive, and present. */
+        memset(&cd_values[5], 0, sizeof(double));
+        nbytes = 2 * sizeof(float);
+        if (H5Z_filter_granularbr(0, GRANULARBR_ABS_FLT_PRM_NBR, cd_values, nbytes,
+                                  &nbytes, &buf)) ERR;
+        if (H5Z_filter_granularbr(0, 5, cd_values, nbytes, &nbytes, &buf)) ERR;
+        free(fp);
+        free(fp_ref);
+        free(dp);
+        free(dp_ref);
+    }
+    SUMMARIZE_ERR;
+    printf("*** Checking threaded Granular BitRound matches single-threaded...");
+    {
+        /* Large enough for many slices, odd so the last slice is short. */
+        const float mss_val_flt = -999.0f;
+        unsigned int cd_values[GRANULARBR_FLT_PRM_NBR + 1] = {3, sizeof(float), 1, 0, 0, 0};
+        float *fp, *fp_thr;
+        size_t nbytes;
+        void *buf;
+        int i;
+
+        if (!(fp = malloc(NBIG * sizeof(float)))) ERR;
+        if (!(fp_thr = malloc(NBIG * sizeof(float)))) ERR;
+        for (i = 0; i < NBIG; i++)
+            fp[i] = fp_thr[i] = (i % 17 == 0) ? mss_val_flt : 273.15f + 50.0f * sinf(i * 1.0e-3f);
+        memcpy(&cd_values[3], &mss_val_flt, sizeof(float));
+
+        if (setenv("CCR_THR_NBR", "1", 1)) ERR;
+        nbytes = NBIG * sizeof(float);
+        buf = fp;
+        if (H5Z_filter_granularbr(0, GRANULARBR_FLT_PRM_NBR, cd_values, nbytes, &nbytes, &buf) != NBIG * sizeof(float)) ERR;
+        if (setenv("CCR_THR_NBR", "4", 1)) ERR;
+        nbytes = NBIG * sizeof(float);
+        buf = fp_thr;
+        if (H5Z_filter_granularbr(0, GRANULARBR_FLT_PRM_NBR, cd_values, nbytes, &nbytes, &buf) != NBIG * sizeof(float)) ERR;
+        if (unsetenv("CCR_THR_NBR")) ERR;
+        if (memcmp(fp, fp_thr, NBIG * sizeof(float))) ERR;
+        free(fp);
+        free(fp_thr);
+    }
+    SUMMARIZE_ERR;
+    printf("*** Checking Granular BitRound stores seven parameters only for absolute error...");
+    {
+        /* Readers that predate absolute error mode accept only five
+         * parameters, so NSD mode must not store the other two. */
+        const double abs_err = 1.0e-3;
+        hid_t fileid, datasetid, spaceid, plistid, dcplid;
+        hsize_t dimsize[2] = {NX, NY};
+        hsize_t chunksize[2] = {NX / 2, NY / 2};
+        unsigned int cd_values[GRANULARBR_ABS_FLT_PRM_NBR] = {0, 0, 0, 0, 0, 0, 0};
+        unsigned int cd_values_in[GRANULARBR_ABS_FLT_PRM_NBR + 1];
+        size_t cd_nelmts;
+        unsigned int flags;
+        int a;
+
+        if (!H5Zfilter_avail(GRANULARBR_ID)) ERR;
+        if ((fileid = H5Fcreate(FILE_NAME, H5F_ACC_TRUNC, H5P_DEFAULT, H5P_DEFAULT)) < 0) ERR;
+        if ((spaceid = H5Screate_simple(2, dimsize, NULL)) < 0) ERR;
+        for (a = 0; a < 2; a++)
+        {
+            size_t prm_nbr = a ? GRANULARBR_ABS_FLT_PRM_NBR : GRANULARBR_FLT_PRM_NBR;
+
+            cd_values[0] = a ? 0 : 3;
+            if (a)
+                memcpy(&cd_values[5], &abs_err, sizeof(double));
+            if ((plistid = H5Pcreate(H5P_DATASET_CREATE)) < 0) ERR;
+            if (H5Pset_chunk(plistid, 2, chunksize) < 0) ERR;
+            if (H5Pset_filter(plistid, (H5Z_filter_t)GRANULARBR_ID, H5Z_FLAG_MANDATORY,
+                              prm_nbr, cd_values) < 0) ERR;
+            if ((datasetid = H5Dcreate2(fileid, a ? "abs" : "nsd", H5T_IEEE_F32LE, spaceid,
+                                        H5P_DEFAULT, plistid, H5P_DEFAULT)) < 0) ERR;
+            if ((dcplid = H5Dget_create_plist(datasetid)) < 0) ERR;
+            cd_nelmts = GRANULARBR_ABS_FLT_PRM_NBR + 1;
+            if (H5Pget_filter_by_id2(dcplid, (H5Z_filter_t)GRANULARBR_ID, &flags, &cd_nelmts,
+                                     cd_values_in, 0, NULL, NULL) < 0) ERR;
+            if (cd_nelmts != prm_nbr) ERR;
+            if (cd_values_in[0] != cd_values[0] || cd_values_in[1] != sizeof(float)) ERR;
+            if (a && memcmp(&cd_values_in[5], &abs_err, sizeof(double))) ERR;
+            if (H5Pclose(dcplid) < 0 ||
+                H5Dclose(datasetid) < 0 ||
+                H5Pclose(plistid) < 0) ERR;
+        }
+        if (H5Sclose(spaceid) < 0 ||
+            H5Fclose(fileid) < 0) ERR;
+    }
+    SUMMARIZE_ERR;
+    FINAL_RESULTS;
+}
@@ -0,0 +1,302 @@
+/*
+ * This is a test in the Community Codec Repository.
+ *
+ * This test checks the Linear Packing filter keeps values within the
+ * requested absolute error, picks the narrowest integer width for
+ * each chunk, preserves fill values, and stores unpackable chunks
+ * unchanged.
+ */
+
+#include "config.h"
+#include "ccr_test.h"
+#include "tst_h_utils.h"
+#include <hdf5.h>
+#include <math.h>
+#include <string.h>
+
+/* Err is used to keep track of errors within each set of tests,
+ * total_err is the number of errors in the entire test program, which
+ * generally cosists of several sets of tests. */
+static int total_err = 0, err = 0;
+
+#define FILE_NAME "tst_h_linearpack.h5"
+#define NVAL 1027 /* Odd, and not a multiple of any SIMD width */
+#define NX 60
+#define NY 120
+#define HDR_SZ 24 /* H5Zlinearpack.c: CCR_LPK_HDR_SZ */
+#define MSS_VAL -999.0
+
+size_t H5Z_filter_linearpack(unsigned int flags, size_t cd_nelmts,
+                             const unsigned int cd_values[], size_t nbytes,
+                             size_t *buf_size, void **buf);
+
+/* Fill in filter parameters as ccr_set_local_linearpack() would. */
+static void
+lpk_prm_set(unsigned int *cd_values, double err_max, size_t datum_size,
+            int has_mss_val, double mss_val)
+{
+    float mss_val_flt = (float)mss_val;
+
+    memset(cd_values, 0, LINEARPACK_FLT_PRM_NBR * sizeof(unsigned int));
+    memcpy(&cd_values[0], &err_max, sizeof(double));
+    cd_values[2] = datum_size;
+    cd_values[3] = has_mss_val;
+    if (datum_size == sizeof(float))
+        memcpy(&cd_values[4], &mss_val_flt, sizeof(float));
+    else
+        memcpy(&cd_values[4], &mss_val, sizeof(double));
+}
+
+int
+main()
+{
+    printf("\n*** Checking Linear Packing filter.\n");
+    printf("*** Checking Linear Packing error bound and widths...");
+    {
+        /* Temperatures from 200 K to 320 K packed to 0.5 K fit 8
+         * bits, to 0.001 K fit 16 bits, and to 1e-5 K need 32 bits. */
+        double err_max[3] = {0.5, 0.001, 1.0e-5};
+        int wdt_xpc[3] = {8, 16, 32};
+        unsigned int cd_values[LINEARPACK_FLT_PRM_NBR];
+        size_t nbytes_enc;
+        double *dp;
+        float *fp;
+        int e, i;
+
+        for (e = 0; e < 3; e++)
+        {
+            /* Double precision. */
+            if (!(dp = malloc(NVAL * sizeof(double)))) ERR;
+            for (i = 0; i < NVAL; i++)
+                dp[i] = 260.0 + 60.0 * sin(i * 0.01);
+            dp[0] = 200.0;
+            dp[1] = 320.0;
+            lpk_prm_set(cd_values, err_max[e], sizeof(double), 0, 0.0);
+            if (!(nbytes_enc = tst_h_enc(H5Z_filter_linearpack, LINEARPACK_FLT_PRM_NBR, cd_values, (void **)&dp, NVAL * sizeof(double)))) ERR;
+            if (((unsigned char *)dp)[1] != wdt_xpc[e]) ERR;
+            if (nbytes_enc != HDR_SZ + NVAL * wdt_xpc[e] / 8) ERR;
+            if (tst_h_dec(H5Z_filter_linearpack, LINEARPACK_FLT_PRM_NBR, cd_values, (void **)&dp, nbytes_enc) != NVAL * sizeof(double)) ERR;
+            for (i = 2; i < NVAL; i++)
+                if (fabs(dp[i] - (260.0 + 60.0 * sin(i * 0.01))) > err_max[e] * (1.0 + 1.0e-9)) ERR;
+            if (fabs(dp[0] - 200.0) > err_max[e] || fabs(dp[1] - 320.0) > err_max[e]) ERR;
+            free(dp);
+
+            /* Single precision, where 32-bit codes save nothing, so
+             * such chunks are stored unpacked. */
+            if (!(fp = malloc(NVAL * sizeof(float)))) ERR;
+            for (i = 0; i < NVAL; i++)
+                fp[i] = 260.0 + 60.0 * sin(i * 0.01);
+            fp[0] = 200.0f;
+            fp[1] = 320.0f;
+            lpk_prm_set(cd_values, err_max[e], sizeof(float), 0, 0.0);
+            if (!(nbytes_enc = tst_h_enc(H5Z_filter_linearpack, LINEARPACK_FLT_PRM_NBR, cd_values, (void **)&fp, NVAL * sizeof(float)))) ERR;
+            if (((unsigned char *)fp)[1] != (e < 2 ? wdt_xpc[e] : 255)) ERR;
+            if (tst_h_dec(H5Z_filter_linearpack, LINEARPACK_FLT_PRM_NBR, cd_values, (void **)&fp, nbytes_enc) != NVAL * sizeof(float)) ERR;
+            for (i = 2; i < NVAL; i++)
+            {
+                double val = (float)(260.0 + 60.0 * sin(i * 0.01));
+                /* Single-precision result may round by half an ulp. */
+                if (fabs(fp[i] - val) > err_max[e] + ldexp(val, -24)) ERR;
+                if (e == 2 && fp[i] != val) ERR;
+            }
+            free(fp);
+        }
+    }
+    SUMMARIZE_ERR;
+    printf("*** Checking Linear Packing preserves fill values...");
+    {
+        unsigned int cd_values[LINEARPACK_FLT_PRM_NBR];
+        size_t nbytes_enc;
+        double *dp;
+        float *fp;
+        int f, i;
+
+        for (f = 0; f < 2; f++)
+        {
+            /* Default and custom fill values, far outside data range. */
+            double mss_val = f ? MSS_VAL : NC_FILL_DOUBLE;
+            float mss_val_flt = f ? (float)MSS_VAL : NC_FILL_FLOAT;
+
+            if (!(dp = malloc(NVAL * sizeof(double)))) ERR;
+            for (i = 0; i < NVAL; i++)
+                dp[i] = (i % 7 == 0) ? mss_val : 1000.0 + i;
+            lpk_prm_set(cd_values, 0.5, sizeof(double), f, mss_val);
+            if (!(nbytes_enc = tst_h_enc(H5Z_filter_linearpack, LINEARPACK_FLT_PRM_NBR, cd_values, (void **)&dp, NVAL * sizeof(double)))) ERR;
+            if (((unsigned char *)dp)[1] != 16) ERR;
+            if (tst_h_dec(H5Z_filter_linearpack, LINEARPACK_FLT_PRM_NBR, cd_values, (void **)&dp, nbytes_enc) != NVAL * sizeof(double)) ERR;
+            for (i = 0; i < NVAL; i++)
+                if (i % 7 == 0 ? dp[i] != mss_val : fabs(dp[i] - (1000.0 + i)) > 0.5) ERR;
+            free(dp);
+
+            if (!(fp = malloc(NVAL * sizeof(float)))) ERR;
+            for (i = 0; i < NVAL; i++)
+                fp[i] = (i % 7 == 0) ? mss_val_flt : 1000.0f + i;
+            lpk_prm_set(cd_values, 0.5, sizeof(float), f, mss_val);
+            if (!(nbytes_enc = tst_h_enc(H5Z_filter_linearpack, LINEARPACK_FLT_PRM_NBR, cd_values, (void **)&fp, NVAL * sizeof(float)))) ERR;
+            if (((unsigned char *)fp)[1] != 16) ERR;
+            if (tst_h_dec(H5Z_filter_linearpack, LINEARPACK_FLT_PRM_NBR, cd_values, (void **)&fp, nbytes_enc) != NVAL * sizeof(float)) ERR;
+            for (i = 0; i < NVAL; i++)
+                if (i % 7 == 0 ? fp[i] != mss_val_flt : fabs(fp[i] - (1000.0f + i)) > 0.5f) ERR;
+            free(fp);
+        }
+
+        /* A chunk of only fill values stores just its header. */
+        if (!(fp = malloc(NVAL * sizeof(float)))) ERR;
+        for (i = 0; i < NVAL; i++)
+            fp[i] = (float)MSS_VAL;
+        lpk_prm_set(cd_values, 0.5, sizeof(float), 1, MSS_VAL);
+        if (!(nbytes_enc = tst_h_enc(H5Z_filter_linearpack, LINEARPACK_FLT_PRM_NBR, cd_values, (void **)&fp, NVAL * sizeof(float)))) ERR;
+        if (((unsigned char *)fp)[1] != 0) ERR;
+        if (nbytes_enc != HDR_SZ) ERR;
+        if (tst_h_dec(H5Z_filter_linearpack, LINEARPACK_FLT_PRM_NBR, cd_values, (void **)&fp, nbytes_enc) != NVAL * sizeof(float)) ERR;
+        for (i = 0; i < NVAL; i++)
+            if (fp[i] != (float)MSS_VAL) ERR;
+        free(fp);
+    }
+    SUMMARIZE_ERR;
+    printf("*** Checking Linear Packing stores unpackable chunks unchanged...");
+    {
+        unsigned int cd_values[LINEARPACK_FLT_PRM_NBR];
+        size_t nbytes_enc;
+        double *dp, *dp_ref;
+        int i, t;
+
+        for (t = 0; t < 3; t++)
+        {
+            if (!(dp = malloc(NVAL * sizeof(double)))) ERR;
+            if (!(dp_ref = malloc(NVAL * sizeof(double)))) ERR;
+            for (i = 0; i < NVAL; i++)
+                dp[i] = i * 0.25;
+            /* NaN, infinity, or a range too wide for 32-bit codes. */
+            dp[NVAL / 2] = (t == 0) ? NAN : (t == 1) ? -INFINITY : 1.0e12;
+            memcpy(dp_ref, dp, NVAL * sizeof(double));
+            lpk_prm_set(cd_values, 0.01, sizeof(double), 0, 0.0);
+            if (!(nbytes_enc = tst_h_enc(H5Z_filter_linearpack, LINEARPACK_FLT_PRM_NBR, cd_values, (void **)&dp, NVAL * sizeof(double)))) ERR;
+            if (((unsigned char *)dp)[1] != 255) ERR;
+            if (nbytes_enc != HDR_SZ + NVAL * sizeof(double)) ERR;
+            if (tst_h_dec(H5Z_filter_linearpack, LINEARPACK_FLT_PRM_NBR, cd_values, (void **)&dp, nbytes_enc) != NVAL * sizeof(double)) ERR;
+            if (memcmp(dp, dp_ref, NVAL * sizeof(double))) ERR;
+            free(dp);
+            free(dp_ref);
+        }
+    }
+    SUMMARIZE_ERR;
+    printf("*** Checking Linear Packing kernels agree for every remainder length...");
+    {
+        /* Packing and unpacking are exact functions of their inputs,
+         * so repacking unpacked values reproduces the same codes. The
+         * scalar kernels handle remainders after the vector loops,
+         * and both must agree with each other for this to hold. */
+        unsigned int cd_values[LINEARPACK_FLT_PRM_NBR];
+        size_t nbytes_enc, nbytes_enc2;
+        unsigned char *enc;
+        float *fp;
+        int i, sz;
+
+        for (sz = NVAL - 16; sz <= NVAL; sz++)
+        {
+            if (!(fp = malloc(sz * sizeof(float)))) ERR;
+            for (i = 0; i < sz; i++)
+                fp[i] = (i % 5 == 0) ? (float)MSS_VAL : (float)(i % 97) * 0.37f - 11.0f;
+            lpk_prm_set(cd_values, 0.01, sizeof(float), 1, MSS_VAL);
+            if (!(nbytes_enc = tst_h_enc(H5Z_filter_linearpack, LINEARPACK_FLT_PRM_NBR, cd_values, (void **)&fp, sz * sizeof(float)))) ERR;
+            if (((unsigned char *)fp)[1] != 16) ERR;
+
+            /* Check each code against the packing formula. */
+            {
+                double ofs = -11.0, stp = 0.02;
+                unsigned short cd;
+
+                for (i = 0; i < sz; i++)
+                {
+                    memcpy(&cd, (unsigned char *)fp + HDR_SZ + 2 * i, 2);
+                    if (i % 5 == 0)
+                    {
+                        if (cd != 0xFFFF) ERR;
+                    }
+                    else if (cd != (unsigned short)(((double)((float)(i % 97) * 0.37f - 11.0f) - ofs) * (1.0 / stp) + 0.5)) ERR;
+                }
+            }
+
+            if (!(enc = malloc(nbytes_enc))) ERR;
+            memcpy(enc, fp, nbytes_enc);
+            if (tst_h_dec(H5Z_filter_linearpack, LINEARPACK_FLT_PRM_NBR, cd_values, (void **)&fp, nbytes_enc) != sz * sizeof(float)) ERR;
+            for (i = 0; i < sz; i++)
+                if (i % 5 && fabs(fp[i] - ((float)(i % 97) * 0.37f - 11.0f)) > 0.01 + 1.0e-6) ERR;
+            if (!(nbytes_enc2 = tst_h_enc(H5Z_filter_linearpack, LINEARPACK_FLT_PRM_NBR, cd_values, (void **)&fp, sz * sizeof(float)))) ERR;
+            if (((unsigned char *)fp)[1] != 16) ERR;
+            if (nbytes_enc2 != nbytes_enc || memcmp(fp, enc, nbytes_enc)) ERR;
+            free(enc);
+            free(fp);
+        }
+    }
+    SUMMARIZE_ERR;
+    printf("*** Checking Linear Packing rejects invalid parameters and chunks...");
+    {
+        unsigned int cd_values[LINEARPACK_FLT_PRM_NBR];
+        size_t buf_size, nbytes_enc;
+        double *dp;
+        void *buf;
+        int i;
+
+        if (!(dp = malloc(NVAL * sizeof(double)))) ERR;
+        for (i = 0; i < NVAL; i++)
+            dp[i] = i;
+        buf = dp;
+        buf_size = NVAL * sizeof(double);
+
+        /* Error bound must be positive. */
+        lpk_prm_set(cd_values, 0.0, sizeof(double), 0, 0.0);
+        if (H5Z_filter_linearpack(0, LINEARPACK_FLT_PRM_NBR, cd_values, buf_size, &buf_size, &buf)) ERR;
+        lpk_prm_set(cd_values, -1.0, sizeof(double), 0, 0.0);
+        if (H5Z_filter_linearpack(0, LINEARPACK_FLT_PRM_NBR, cd_values, buf_size, &buf_size, &buf)) ERR;
+
+        /* Only float and double. */
+        lpk_prm_set(cd_values, 0.5, 2, 0, 0.0);
+        if (H5Z_filter_linearpack(0, LINEARPACK_FLT_PRM_NBR, cd_values, buf_size, &buf_size, &buf)) ERR;
+        lpk_prm_set(cd_values, 0.5, sizeof(double), 0, 0.0);
+        if (H5Z_filter_linearpack(0, 2, cd_values, buf_size, &buf_size, &buf)) ERR;
+
+        /* Truncated or unknown chunks are errors, not garbage. */
+        if (!(nbytes_enc = tst_h_enc(H5Z_filter_linearpack, LINEARPACK_FLT_PRM_NBR, cd_values, &buf, NVAL * sizeof(double)))) ERR;
+        if (((unsigned char *)buf)[1] != 16) ERR;
+        if (tst_h_corrupt(H5Z_filter_linearpack, LINEARPACK_FLT_PRM_NBR, cd_values, &buf, nbytes_enc, HDR_SZ, 0)) ERR;
+        free(buf);
+    }
+    SUMMARIZE_ERR;
+    printf("*** Checking Linear Packing through an HDF5 dataset...");
+    {
+        hsize_t dimsize[2] = {NX, NY};
+        hsize_t chunksize[2] = {NX / 2, NY / 2};
+        unsigned int cd_values[LINEARPACK_FLT_PRM_NBR];
+        size_t cd_nelmts = LINEARPACK_FLT_PRM_NBR;
+        float data_out[NX][NY], data_in[NX][NY];
+        float fill_value = MSS_VAL;
+        hsize_t storage_size;
+        int x, y;
+
+        /* Pressure in hPa to 0.05 hPa needs 16 bits. */
+        for (x = 0; x < NX; x++)
+            for (y = 0; y < NY; y++)
+                data_out[x][y] = (x + y) % 5 ? 900.0f + 100.0f * sinf(x * 0.1f) * cosf(y * 0.05f) : fill_value;
+
+        /* Users set only the error bound. */
+        lpk_prm_set(cd_values, 0.05, 0, 0, 0.0);
+        if (tst_h_dset_rt(FILE_NAME, LINEARPACK_ID, &cd_nelmts, cd_values, 0, H5T_NATIVE_FLOAT,
+                          &fill_value, dimsize, chunksize, data_out, data_in, &storage_size)) ERR;
+
+        /* Each of four chunks holds a header and 16-bit codes. */
+        if (storage_size != NX * NY * 2 + 4 * HDR_SZ) ERR;
+        for (x = 0; x < NX; x++)
+            for (y = 0; y < NY; y++)
+            {
+                if ((x + y) % 5 == 0)
+                {
+                    if (data_in[x][y] != fill_value) ERR;
+                }
+                else if (fabs(data_in[x][y] - data_out[x][y]) > 0.05 + 1.0e-4) ERR;
+            }
+    }
+    SUMMARIZE_ERR;
+    FINAL_RESULTS;
+}
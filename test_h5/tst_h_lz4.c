@@ -11,10 +11,14 @@
 #include "ccr_test.h"
 #include <hdf5.h>
 #include <H5DSpublic.h>
+#include <stdlib.h>
+#include <string.h>
 
 #define FILE_NAME "tst_h_lz4.h5"
 #define STR_LEN 255
 #define MAX_LEN 1024
+#define NBIG 1000003 /* Spans many default-sized blocks */
+#define NCFG 3
 
 /* Err is used to keep track of errors within each set of tests,
  * total_err is the number of errors in the entire test program, which
@@ -47,7 +51,7 @@ main()
         int data_in[NX][NY], data_out[NX][NY];
         hsize_t fdims[NDIMS], fmaxdims[NDIMS];
         hsize_t chunksize[NDIMS], dimsize[NDIMS], maxdimsize[NDIMS];
-        const unsigned cd_values[1] = {3};          /* LZ4 default level is 3 */
+        const unsigned cd_values[1] = {0};          /* LZ4 default block size */
         int x, y;
         const H5Z_class2_t H5Z_LZ4[1] = {{
                 H5Z_CLASS_T_VERS,       /* H5Z_class_t version */
@@ -141,5 +145,49 @@ main()
             ERR;
     }
     SUMMARIZE_ERR;
+    printf("*** Checking threaded LZ4 matches single-threaded...");
+    {
+        /* Default blocks, small blocks with acceleration, and LZ4HC. */
+        const unsigned int cd_values[NCFG][3] = {{0, 0, 0}, {4099, 8, 0}, {0, 1, 9}};
+        int *data;
+        void *buf, *buf_thr;
+        size_t nbytes, nbytes_thr, buf_size;
+        int c, i;
+
+        if (!(data = malloc(NBIG * sizeof(int)))) ERR;
+        for (i = 0; i < NBIG; i++)
+            data[i] = (i % 1000 < 500) ? i / 7 : (i * 2654435761u) >> 7;
+
+        for (c = 0; c < NCFG; c++)
+        {
+            /* Compress on the calling thread, then on several. */
+            if (setenv("CCR_THR_NBR", "1", 1)) ERR;
+            if (!(buf = malloc(NBIG * sizeof(int)))) ERR;
+            memcpy(buf, data, NBIG * sizeof(int));
+            buf_size = NBIG * sizeof(int);
+            if (!(nbytes = H5Z_filter_lz4(0, 3, cd_values[c], NBIG * sizeof(int), &buf_size, &buf))) ERR;
+            if (setenv("CCR_THR_NBR", "4", 1)) ERR;
+            if (!(buf_thr = malloc(NBIG * sizeof(int)))) ERR;
+            memcpy(buf_thr, data, NBIG * sizeof(int));
+            buf_size = NBIG * sizeof(int);
+            if (!(nbytes_thr = H5Z_filter_lz4(0, 3, cd_values[c], NBIG * sizeof(int), &buf_size, &buf_thr))) ERR;
+
+            /* The chunk does not depend on the number of threads. */
+            if (nbytes_thr != nbytes || memcmp(buf, buf_thr, nbytes)) ERR;
+
+            /* Decompress on several threads. */
+            if (H5Z_filter_lz4(H5Z_FLAG_REVERSE, 3, cd_values[c], nbytes_thr, &buf_size,
+                               &buf_thr) != NBIG * sizeof(int)) ERR;
+            if (memcmp(buf_thr, data, NBIG * sizeof(int))) ERR;
+
+            /* A truncated chunk is an error, not a crash. */
+            if (H5Z_filter_lz4(H5Z_FLAG_REVERSE, 3, cd_values[c], nbytes - 9, &buf_size, &buf)) ERR;
+            free(buf);
+            free(buf_thr);
+        }
+        if (unsetenv("CCR_THR_NBR")) ERR;
+        free(data);
+    }
+    SUMMARIZE_ERR;
     FINAL_RESULTS;
 }
@@ -0,0 +1,111 @@
+/*
+ * This is part of the Community Codec Repository.
+ *
+ * Utility functions shared by the HDF5 filter tests. The tests call
+ * each filter function directly to check its chunk format, and
+ * through HDF5 to check it works as a plugin.
+ *
+ * agent 10/17/26
+ */
+
+#include "config.h"
+#include "tst_h_utils.h"
+
+#define VAR_NAME "data"
+#define BYT_BAD 99 /* Header byte no filter accepts */
+
+/** Run a filter forward on a malloc()'d buffer of nbytes, which the
+ * filter may replace. Return the size of the result, 0 on failure. */
+size_t
+tst_h_enc(H5Z_func_t flt, size_t cd_nelmts, const unsigned int *cd_values,
+          void **bufp, size_t nbytes)
+{
+    size_t buf_size = nbytes;
+
+    return flt(0, cd_nelmts, cd_values, nbytes, &buf_size, bufp);
+}
+
+/** Run a filter in reverse on a malloc()'d buffer of nbytes_enc,
+ * which the filter may replace. Return the size of the result, 0 on
+ * failure. */
+size_t
+tst_h_dec(H5Z_func_t flt, size_t cd_nelmts, const unsigned int *cd_values,
+          void **bufp, size_t nbytes_enc)
+{
+    size_t buf_size = nbytes_enc;
+
+    return flt(H5Z_FLAG_REVERSE, cd_nelmts, cd_values, nbytes_enc, &buf_size, bufp);
+}
+
+/** Return 0 if a filter, in reverse, rejects an encoded chunk cut
+ * short of its header, cut short by one byte, and with header byte
+ * byt_idx set to a bad value. The chunk is left unchanged. */
+int
+tst_h_corrupt(H5Z_func_t flt, size_t cd_nelmts, const unsigned int *cd_values,
+              void **bufp, size_t nbytes_enc, size_t hdr_sz, size_t byt_idx)
+{
+    unsigned char *hdr;
+    unsigned char byt;
+    size_t dec_sz;
+
+    if (tst_h_dec(flt, cd_nelmts, cd_values, bufp, hdr_sz - 1) ||
+        tst_h_dec(flt, cd_nelmts, cd_values, bufp, nbytes_enc - 1))
+        return 1;
+    hdr = *bufp;
+    byt = hdr[byt_idx];
+    hdr[byt_idx] = BYT_BAD;
+    dec_sz = tst_h_dec(flt, cd_nelmts, cd_values, bufp, nbytes_enc);
+    hdr = *bufp;
+    hdr[byt_idx] = byt;
+    return dec_sz ? 1 : 0;
+}
+
+/** Write data_out to a new file holding one chunked 2D dataset of
+ * type_id, run through filter id and, if deflate, then deflate, with
+ * fill_value unless it is NULL. Return the parameters the filter
+ * stored in cd_nelmts and cd_values, the storage size of the dataset,
+ * and its values read back in data_in. Return 0 on success. */
+int
+tst_h_dset_rt(const char *file_name, H5Z_filter_t id, size_t *cd_nelmts,
+              unsigned int *cd_values, int deflate, hid_t type_id,
+              const void *fill_value, const hsize_t *dims,
+              const hsize_t *chunks, const void *data_out, void *data_in,
+              hsize_t *storage_size)
+{
+    hid_t fileid, datasetid, spaceid, plistid;
+    unsigned int flags;
+
+    /* Loads the plugin, as the nc_def_var_*() functions do. */
+    if (!H5Zfilter_avail(id))
+        return 1;
+
+    if ((fileid = H5Fcreate(file_name, H5F_ACC_TRUNC, H5P_DEFAULT, H5P_DEFAULT)) < 0) return 1;
+    if ((spaceid = H5Screate_simple(2, dims, NULL)) < 0) return 1;
+    if ((plistid = H5Pcreate(H5P_DATASET_CREATE)) < 0) return 1;
+    if (H5Pset_chunk(plistid, 2, chunks) < 0) return 1;
+    if (fill_value && H5Pset_fill_value(plistid, type_id, fill_value) < 0) return 1;
+    if (H5Pset_filter(plistid, id, H5Z_FLAG_MANDATORY, *cd_nelmts, cd_values) < 0) return 1;
+    if (deflate && H5Pset_deflate(plistid, 1) < 0) return 1;
+    if ((datasetid = H5Dcreate2(fileid, VAR_NAME, type_id, spaceid,
+                                H5P_DEFAULT, plistid, H5P_DEFAULT)) < 0) return 1;
+    if (H5Dwrite(datasetid, type_id, H5S_ALL, H5S_ALL, H5P_DEFAULT, data_out) < 0) return 1;
+
+    /* The set_local callback may have filled in parameters. */
+    if (H5Pclose(plistid) < 0) return 1;
+    if ((plistid = H5Dget_create_plist(datasetid)) < 0) return 1;
+    if (H5Pget_filter_by_id2(plistid, id, &flags, cd_nelmts, cd_values,
+                             0, NULL, NULL) < 0) return 1;
+    *storage_size = H5Dget_storage_size(datasetid);
+
+    if (H5Dclose(datasetid) < 0 ||
+        H5Pclose(plistid) < 0 ||
+        H5Sclose(spaceid) < 0 ||
+        H5Fclose(fileid) < 0) return 1;
+
+    if ((fileid = H5Fopen(file_name, H5F_ACC_RDONLY, H5P_DEFAULT)) < 0) return 1;
+    if ((datasetid = H5Dopen2(fileid, VAR_NAME, H5P_DEFAULT)) < 0) return 1;
+    if (H5Dread(datasetid, type_id, H5S_ALL, H5S_ALL, H5P_DEFAULT, data_in) < 0) return 1;
+    if (H5Dclose(datasetid) < 0 ||
+        H5Fclose(fileid) < 0) return 1;
+    return 0;
+}
@@ -0,0 +1,30 @@
+/*
+ * This is part of the Community Codec Repository.
+ *
+ * Utility functions shared by the HDF5 filter tests.
+ *
+ * agent 10/17/26
+ */
+#ifndef _TST_H_UTILS_H
+#define _TST_H_UTILS_H
+
+#include <hdf5.h>
+
+/* Run a filter forward, or in reverse, on a malloc()'d buffer. */
+size_t tst_h_enc(H5Z_func_t flt, size_t cd_nelmts, const unsigned int *cd_values,
+                 void **bufp, size_t nbytes);
+size_t tst_h_dec(H5Z_func_t flt, size_t cd_nelmts, const unsigned int *cd_values,
+                 void **bufp, size_t nbytes_enc);
+
+/* Check a filter rejects truncated and corrupted chunks. */
+int tst_h_corrupt(H5Z_func_t flt, size_t cd_nelmts, const unsigned int *cd_values,
+                  void **bufp, size_t nbytes_enc, size_t hdr_sz, size_t byt_idx);
+
+/* Write and read back a 2D dataset through a filter. */
+int tst_h_dset_rt(const char *file_name, H5Z_filter_t id, size_t *cd_nelmts,
+                  unsigned int *cd_values, int deflate, hid_t type_id,
+                  const void *fill_value, const hsize_t *dims,
+                  const hsize_t *chunks, const void *data_out, void *data_in,
+                  hsize_t *storage_size);
+
+#endif /* _TST_H_UTILS_H */
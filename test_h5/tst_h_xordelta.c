@@ -0,0 +1,218 @@
+/*
+ * This is a test in the Community Codec Repository.
+ *
+ * This test checks the XOR Delta filter restores every value exactly,
+ * for single and double precision, rows of every length, and bytes
+ * left over, stores chunks it cannot shrink unchanged, rejects
+ * corrupt chunks, and takes its rows from the chunk shape.
+ */
+
+#include "config.h"
+#include "ccr_test.h"
+#include "tst_h_utils.h"
+#include <hdf5.h>
+#include <string.h>
+#include <math.h>
+
+/* Err is used to keep track of errors within each set of tests,
+ * total_err is the number of errors in the entire test program, which
+ * generally cosists of several sets of tests. */
+static int total_err = 0, err = 0;
+
+#define FILE_NAME "tst_h_xordelta.h5"
+#define NVAL 1027
+#define NX 60
+#define NY 120
+#define HDR_SZ 24 /* H5Zxordelta.c: CCR_XDL_HDR_SZ */
+#define MOD_RAW 1 /* H5Zxordelta.c: CCR_XDL_MOD_RAW */
+
+size_t H5Z_filter_xordelta(unsigned int flags, size_t cd_nelmts,
+                           const unsigned int cd_values[], size_t nbytes,
+                           size_t *buf_size, void **buf);
+
+/* Fill buf with elm_nbr smooth values of datum_size bytes. */
+static void
+xdl_fill(unsigned char *buf, size_t datum_size, size_t elm_nbr, int seed)
+{
+    size_t i;
+
+    for (i = 0; i < elm_nbr; i++)
+    {
+        double val = 273.15 + 20.0 * sin((i + seed) / 50.0) + i / 300.0;
+        if (datum_size == 4)
+        {
+            float f = (float)val;
+            memcpy(buf + i * 4, &f, 4);
+        }
+        else
+            memcpy(buf + i * 8, &val, 8);
+    }
+}
+
+int
+main()
+{
+    printf("\n*** Checking XOR Delta filter.\n");
+    printf("*** Checking XOR Delta round trips for rows of every length...");
+    {
+        /* Rows that divide the chunk, leave a partial last row, span
+         * the whole chunk, or hold one value each, with and without
+         * bytes left over. */
+        size_t datum_size[2] = {4, 8};
+        unsigned int row_nbr[6] = {0, 1, 7, 60, 1027, 5000};
+        unsigned int cd_values[XORDELTA_FLT_PRM_NBR];
+        unsigned char *buf, *ref;
+        size_t nbytes, xdl_sz, i;
+        int d, r, sz, lft;
+
+        for (d = 0; d < 2; d++)
+        {
+            for (r = 0; r < 6; r++)
+            {
+                cd_values[0] = datum_size[d];
+                cd_values[1] = row_nbr[r];
+                for (sz = 0; sz <= NVAL; sz += 79)
+                {
+                    for (lft = 0; lft < 2; lft++)
+                    {
+                        nbytes = sz * datum_size[d] + (lft ? datum_size[d] - 1 : 0);
+                        if (!(buf = malloc(nbytes + 1))) ERR;
+                        if (!(ref = malloc(nbytes + 1))) ERR;
+                        xdl_fill(ref, datum_size[d], sz, r);
+                        for (i = sz * datum_size[d]; i < nbytes; i++)
+                            ref[i] = (unsigned char)(i * 7 + 1);
+                        memcpy(buf, ref, nbytes);
+                        if (!(xdl_sz = tst_h_enc(H5Z_filter_xordelta, XORDELTA_FLT_PRM_NBR, cd_values, (void **)&buf, nbytes))) ERR;
+                        if (memcmp(buf, "CXD", 3) || buf[4] != datum_size[d]) ERR;
+                        if (xdl_sz > HDR_SZ + nbytes) ERR;
+                        if (tst_h_dec(H5Z_filter_xordelta, XORDELTA_FLT_PRM_NBR, cd_values, (void **)&buf, xdl_sz) != nbytes) ERR;
+                        if (memcmp(buf, ref, nbytes)) ERR;
+                        free(buf);
+                        free(ref);
+                    }
+                }
+            }
+        }
+    }
+    SUMMARIZE_ERR;
+    printf("*** Checking XOR Delta codes zeros, special values, and noise...");
+    {
+        unsigned int cd_values[XORDELTA_FLT_PRM_NBR] = {8, 0};
+        size_t nbytes = NVAL * sizeof(double), xdl_sz;
+        unsigned char *buf, *ref;
+        double *dp;
+        float *fp;
+        int i;
+
+        if (!(buf = malloc(nbytes))) ERR;
+        if (!(ref = malloc(nbytes))) ERR;
+
+        /* Every residual of a chunk of zeros is zero, and takes two
+         * bits. */
+        memset(buf, 0, nbytes);
+        if (!(xdl_sz = tst_h_enc(H5Z_filter_xordelta, XORDELTA_FLT_PRM_NBR, cd_values, (void **)&buf, nbytes))) ERR;
+        if (xdl_sz != HDR_SZ + (2 * NVAL + 7) / 8) ERR;
+        if (tst_h_dec(H5Z_filter_xordelta, XORDELTA_FLT_PRM_NBR, cd_values, (void **)&buf, xdl_sz) != nbytes) ERR;
+        for (i = 0; i < (int)nbytes; i++)
+            if (buf[i]) ERR;
+
+        /* NaN, infinities, negative zero, and subnormals keep their
+         * bits. */
+        fp = (float *)ref;
+        for (i = 0; i < NVAL; i++)
+        {
+            switch (i % 7)
+            {
+            case 0: fp[i] = NAN; break;
+            case 1: fp[i] = INFINITY; break;
+            case 2: fp[i] = -INFINITY; break;
+            case 3: fp[i] = -0.0f; break;
+            case 4: fp[i] = 1.0e-40f; break;
+            default: fp[i] = 1.5f * i;
+            }
+        }
+        memcpy(buf, ref, NVAL * sizeof(float));
+        cd_values[0] = 4;
+        if (!(xdl_sz = tst_h_enc(H5Z_filter_xordelta, XORDELTA_FLT_PRM_NBR, cd_values, (void **)&buf, NVAL * sizeof(float)))) ERR;
+        if (tst_h_dec(H5Z_filter_xordelta, XORDELTA_FLT_PRM_NBR, cd_values, (void **)&buf, xdl_sz) != NVAL * sizeof(float)) ERR;
+        if (memcmp(buf, ref, NVAL * sizeof(float))) ERR;
+
+        /* Noise does not shrink, so is stored unchanged after the
+         * header. */
+        dp = (double *)ref;
+        srand(42);
+        for (i = 0; i < (int)nbytes; i++)
+            ref[i] = (unsigned char)(rand() >> 7);
+        for (i = 0; i < NVAL; i++)
+            if (isnan(dp[i]))
+                dp[i] = i;
+        free(buf);
+        if (!(buf = malloc(nbytes))) ERR;
+        memcpy(buf, ref, nbytes);
+        cd_values[0] = 8;
+        if (!(xdl_sz = tst_h_enc(H5Z_filter_xordelta, XORDELTA_FLT_PRM_NBR, cd_values, (void **)&buf, nbytes))) ERR;
+        if (buf[5] != MOD_RAW) ERR;
+        if (xdl_sz != HDR_SZ + nbytes) ERR;
+        if (memcmp(buf + HDR_SZ, ref, nbytes)) ERR;
+        if (tst_h_dec(H5Z_filter_xordelta, XORDELTA_FLT_PRM_NBR, cd_values, (void **)&buf, xdl_sz) != nbytes) ERR;
+        if (memcmp(buf, ref, nbytes)) ERR;
+        free(buf);
+        free(ref);
+    }
+    SUMMARIZE_ERR;
+    printf("*** Checking XOR Delta rejects invalid parameters and chunks...");
+    {
+        unsigned int cd_values[XORDELTA_FLT_PRM_NBR] = {2, 0};
+        size_t nbytes = NVAL * sizeof(float), buf_size = nbytes, xdl_sz;
+        unsigned char *buf;
+        void *vbuf;
+
+        if (!(buf = malloc(nbytes))) ERR;
+        xdl_fill(buf, 4, NVAL, 0);
+        vbuf = buf;
+        if (H5Z_filter_xordelta(0, XORDELTA_FLT_PRM_NBR, cd_values, nbytes, &buf_size, &vbuf)) ERR;
+        cd_values[0] = 4;
+        if (H5Z_filter_xordelta(0, 1, cd_values, nbytes, &buf_size, &vbuf)) ERR;
+
+        /* Chunks without a header, of another version or datum
+         * size, or cut short, are not decoded. */
+        if (tst_h_dec(H5Z_filter_xordelta, XORDELTA_FLT_PRM_NBR, cd_values, &vbuf, nbytes)) ERR;
+        if (!(xdl_sz = tst_h_enc(H5Z_filter_xordelta, XORDELTA_FLT_PRM_NBR, cd_values, &vbuf, nbytes))) ERR;
+        if (xdl_sz >= HDR_SZ + nbytes) ERR;
+        if (tst_h_corrupt(H5Z_filter_xordelta, XORDELTA_FLT_PRM_NBR, cd_values, &vbuf, xdl_sz, HDR_SZ, 3)) ERR;
+        cd_values[0] = 8;
+        if (tst_h_dec(H5Z_filter_xordelta, XORDELTA_FLT_PRM_NBR, cd_values, &vbuf, xdl_sz)) ERR;
+        free(vbuf);
+    }
+    SUMMARIZE_ERR;
+    printf("*** Checking XOR Delta through an HDF5 dataset of a smooth field...");
+    {
+        hsize_t dimsize[2] = {NX, NY};
+        hsize_t chunksize[2] = {NX / 2, NY / 2};
+        unsigned int cd_values[XORDELTA_FLT_PRM_NBR] = {0, 0};
+        size_t cd_nelmts = XORDELTA_FLT_PRM_NBR;
+        double data_out[NX][NY], data_in[NX][NY];
+        hsize_t storage_size;
+        int x, y;
+
+        for (x = 0; x < NX; x++)
+            for (y = 0; y < NY; y++)
+                data_out[x][y] = 273.15 + x * y / 64.0 + 1.0 / (1.0 + x + y);
+
+        /* Users set no parameters, and no compressor follows. */
+        if (tst_h_dset_rt(FILE_NAME, XORDELTA_ID, &cd_nelmts, cd_values, 0, H5T_NATIVE_DOUBLE,
+                          NULL, dimsize, chunksize, data_out, data_in, &storage_size)) ERR;
+
+        /* Rows run along the fastest-varying chunk dimension. */
+        if (cd_nelmts != XORDELTA_FLT_PRM_NBR) ERR;
+        if (cd_values[0] != sizeof(double) || cd_values[1] != NY / 2) ERR;
+
+        /* Neighbors share their leading bits. */
+        if (storage_size >= NX * NY * sizeof(double)) ERR;
+        for (x = 0; x < NX; x++)
+            for (y = 0; y < NY; y++)
+                if (data_in[x][y] != data_out[x][y]) ERR;
+    }
+    SUMMARIZE_ERR;
+    FINAL_RESULTS;
+}
@@ -40,7 +40,7 @@ main (void)
     size_t nelmts = 1; /* number of elements in cd_values */
     unsigned int flags;
     unsigned filter_config;
-    const unsigned int cd_values[NPARAM] = {3};     /* lz4 default is 3 */
+    const unsigned int cd_values[NPARAM] = {0};     /* lz4 default block size */
     unsigned int values_out[NPARAM];
     int wdata[DIM0][DIM1], rdata[DIM0][DIM1];
     hsize_t f, i, j;